@@ -86,9 +86,11 @@ float4 PBRPixelShader(PixelInputType input) : SV_TARGET
 {
     float4 diffuseColor = diffuseTexture.Sample(SampleType, input.tex) * baseColor;
 
-    // Sample and transform normal from normal map
-    float3 normalMap = normalTexture.Sample(SampleType, input.tex).rgb;
-    normalMap = normalMap * 2.0 - 1.0; // [0,1] -> [-1,1]
+    // Sample and transform normal from normal map. Only X and Y are read, cooked
+    // normal maps are BC5 and have no Z, so it is rebuilt from the unit length.
+    float3 normalMap;
+    normalMap.xy = normalTexture.Sample(SampleType, input.tex).rg * 2.0 - 1.0; // [0,1] -> [-1,1]
+    normalMap.z = sqrt(saturate(1.0 - dot(normalMap.xy, normalMap.xy)));
     float3 N = normalize(mul(normalMap, input.tbn)); // TBN to world space
 
     float3 L = normalize(-lightDirection);
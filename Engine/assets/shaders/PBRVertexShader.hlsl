@@ -1,6 +1,7 @@
 // PBR Vertex Shader
 // Supports multiple texture types: diffuse, normal, metallic, roughness, emission, AO
 // Also supports GPU-driven rendering with per-instance world matrices
+// Compiled with COMPACT_VERTEX=1 for the 20 byte MeshTypes::CompactVertex layout
 
 cbuffer MatrixBuffer : register(b0)
 {
@@ -14,6 +15,31 @@ cbuffer MatrixBuffer : register(b0)
 // World matrices buffer for GPU-driven rendering
 StructuredBuffer<float4x4> worldMatrixBuffer : register(t1);
 
+#if COMPACT_VERTEX
+// Dequantization of the UNORM16 positions against the mesh bounds
+cbuffer VertexDecodeBuffer : register(b1)
+{
+    float4 positionOffset;
+    float4 positionScale;
+};
+
+struct VertexInputType
+{
+    float4 position : POSITION;     // R16G16B16A16_UNORM
+    float2 tex : TEXCOORD0;         // R16G16_FLOAT
+    float2 normal : NORMAL;         // R16G16_SNORM, octahedral
+    float4 tangentFrame : TANGENT;  // R8G8B8A8_SNORM quaternion, sign of w is the handedness
+    uint instanceID : SV_InstanceID;
+};
+
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-normal.z);
+    normal.xy += normal.xy >= 0.0f ? -t : t;
+    return normalize(normal);
+}
+#else
 struct VertexInputType
 {
     float4 position : POSITION;
@@ -23,6 +49,7 @@ struct VertexInputType
     float3 binormal : BINORMAL;
     uint instanceID : SV_InstanceID;
 };
+#endif
 
 struct PixelInputType
 {
@@ -36,6 +63,24 @@ struct PixelInputType
 PixelInputType PBRVertexShader(VertexInputType input)
 {
     PixelInputType output;
+
+#if COMPACT_VERTEX
+    // Unpack to the full vertex. Only the tangent is taken from the quaternion,
+    // the octahedral normal is more precise.
+    float4 position = float4(positionOffset.xyz + input.position.xyz * positionScale.xyz, 1.0f);
+    float3 normal = DecodeOctahedral(input.normal);
+
+    float4 q = normalize(input.tangentFrame);
+    float handedness = input.tangentFrame.w < 0.0f ? -1.0f : 1.0f;
+    float3 frameTangent = float3(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y));
+    float3 inputTangent = normalize(frameTangent - normal * dot(normal, frameTangent));
+    float3 inputBinormal = cross(normal, inputTangent) * handedness;
+#else
+    float4 position = input.position;
+    float3 normal = input.normal;
+    float3 inputTangent = input.tangent;
+    float3 inputBinormal = input.binormal;
+#endif
     
     // Choose world matrix based on rendering mode
     float4x4 finalWorldMatrix;
@@ -61,7 +106,7 @@ PixelInputType PBRVertexShader(VertexInputType input)
     }
     
     // Calculate the position of the vertex against the world, view, and projection matrices.
-    float4 worldPosition = mul(input.position, finalWorldMatrix);
+    float4 worldPosition = mul(position, finalWorldMatrix);
     output.position = mul(worldPosition, viewMatrix);
     output.position = mul(output.position, projectionMatrix);
     
@@ -69,15 +114,15 @@ PixelInputType PBRVertexShader(VertexInputType input)
     output.tex = input.tex;
     
     // Calculate the normal vector against the world matrix only.
-    output.normal = mul(input.normal, (float3x3)finalWorldMatrix);
+    output.normal = mul(normal, (float3x3)finalWorldMatrix);
     output.normal = normalize(output.normal);
     
     // Store the world position for the pixel shader.
     output.worldPos = worldPosition.xyz;
     
     // Calculate the tangent and bitangent vectors against the world matrix.
-    float3 tangent = mul(input.tangent, (float3x3)finalWorldMatrix);
-    float3 bitangent = mul(input.binormal, (float3x3)finalWorldMatrix);
+    float3 tangent = mul(inputTangent, (float3x3)finalWorldMatrix);
+    float3 bitangent = mul(inputBinormal, (float3x3)finalWorldMatrix);
     
     // Normalize the tangent and bitangent vectors.
     tangent = normalize(tangent);
@@ -9,6 +9,9 @@
 #include "../../Graphics/D3D11/D3D11Device.h"
 #include "../../Graphics/Rendering/Camera.h"
 #include "../../Graphics/Resource/Model.h"
+#include "../../Graphics/Resource/ModelLoader.h"
+#include "../../Graphics/Resource/ResourceCache.h"
+#include "../../Graphics/Resource/TextureStreamer.h"
 #include "../../Graphics/Rendering/Light.h"
 #include "../../Graphics/Resource/Environment/Zone.h"
 #include "../../Core/System/Timer.h"
@@ -16,6 +19,7 @@
 #include "../../Graphics/Scene/Management/ModelList.h"
 #include "../../Graphics/Math/Position.h"
 #include "../../Graphics/Math/Frustum.h"
+#include "../../Graphics/Math/FrustumCuller.h"
 #include "../../Graphics/Rendering/DisplayPlane.h"
 #include "../../Graphics/Rendering/GPUDrivenRenderer.h"
 #include "../../Graphics/Rendering/IndirectDrawBuffer.h"
@@ -30,6 +34,9 @@ Application::Application()
 	m_mainWindow = 0;
 	m_Camera = 0;
 	m_Model = 0;
+	m_ModelLoader = 0;
+	m_ModelReady = false;
+	m_TextureStreamer = 0;
 	m_Light = 0;
 	m_ShaderManager = 0;
 	m_Zone = 0;
@@ -113,78 +120,50 @@ bool Application::Initialize(int screenWidth, int screenHeight, HWND hwnd, MainW
 	LOG("Zone initialized successfully");
 
 
+	// Models load on the job system workers while the rest initializes, and
+	// are finished one frame at a time by m_ModelLoader->Update in Frame.
+	m_ModelLoader = new ModelLoader;
+
 	strcpy_s(modelFilename, "../Engine/assets/models/spaceship/low-poly/nave-modelo.fbx");
 	LOG("Attempting to load spaceship model for GPU-driven rendering: " + std::string(modelFilename));
 
-	// Create and initialize the model object.
+	// Create the model object and start loading it.
 	LOG("Creating model object");
 	m_Model = new Model;
-
-
-	result = m_Model->InitializeFBX(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), modelFilename);
-	if (!result)
+	if (AppConfig::COMPACT_MODEL_VERTICES)
 	{
-		LOG_ERROR("Could not initialize the FBX model object");
-		LOG_ERROR("Model file path: " + std::string(modelFilename));
-		MessageBox(hwnd, L"Could not initialize the FBX model object.", L"Error", MB_OK);
-		return false;
+		m_Model->SetVertexFormat(MeshTypes::VERTEX_FORMAT_COMPACT);
 	}
-	LOG("Spaceship FBX model initialized successfully");
+	m_Model->SetBuildMeshlets(AppConfig::MESHLET_CULLING);
 
-	// Create and initialize gizmo models
+	// Streams the finer mip levels of the model's textures by what is on screen.
+	// The cache decides which textures stream as it loads them, once per texture.
+	ResourceCache::GetInstance().SetTextureStreaming(AppConfig::TEXTURE_STREAMING_TAIL);
+	m_TextureStreamer = new TextureStreamer;
+	MipResidency::Settings streamingSettings;
+	streamingSettings.budgetBytes = AppConfig::TEXTURE_BUDGET_MB * 1024 * 1024;
+	m_TextureStreamer->Initialize(streamingSettings);
+
+	m_ModelLoad = m_ModelLoader->LoadFBX(m_Model, modelFilename);
+
+	// Create the gizmo models and start loading them alongside.
 	LOG("Creating gizmo models");
 	
 	// Position gizmo (arrow)
 	m_PositionGizmo = new Model;
-	strcpy_s(modelFilename, "../Engine/assets/models/Arrow.txt");
-	result = m_PositionGizmo->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), modelFilename, nullptr);
-	if (!result)
-	{
-		LOG_ERROR("Could not initialize position gizmo");
-		return false;
-	}
+	m_GizmoLoads[0] = m_ModelLoader->Load(m_PositionGizmo, "../Engine/assets/models/Arrow.txt");
 	
 	// Rotation gizmo (arc)
 	m_RotationGizmo = new Model;
-	strcpy_s(modelFilename, "../Engine/assets/models/Arc.txt");
-	result = m_RotationGizmo->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), modelFilename, nullptr);
-	if (!result)
-	{
-		LOG_ERROR("Could not initialize rotation gizmo");
-		return false;
-	}
+	m_GizmoLoads[1] = m_ModelLoader->Load(m_RotationGizmo, "../Engine/assets/models/Arc.txt");
 	
 	// Scale gizmo (line with cube)
 	m_ScaleGizmo = new Model;
-	strcpy_s(modelFilename, "../Engine/assets/models/ScaleHandle.txt");
-	result = m_ScaleGizmo->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), modelFilename, nullptr);
-	if (!result)
-	{
-		LOG_ERROR("Could not initialize scale gizmo");
-		return false;
-	}
-	
-	LOG("Gizmo models initialized successfully");
+	m_GizmoLoads[2] = m_ModelLoader->Load(m_ScaleGizmo, "../Engine/assets/models/ScaleHandle.txt");
 
-	// Create and initialize the light object.
+	// Create the light object. Its colors depend on the model's materials and are set once it has loaded.
 	LOG("Creating light object");
 	m_Light = new Light;
-
-	// If the model has FBX materials, we'll use those values
-	if (m_Model->HasFBXMaterial())
-	{
-		m_Light->SetAmbientColor(0.15f, 0.15f, 0.15f, 1.0f);
-		m_Light->SetDiffuseColor(1.0f, 1.0f, 1.0f, 1.0f);
-		m_Light->SetSpecularColor(1.0f, 1.0f, 1.0f, 1.0f);
-		m_Light->SetSpecularPower(32.0f);
-	}
-	else
-	{
-		m_Light->SetDiffuseColor(1.0f, 1.0f, 1.0f, 1.0f);
-		m_Light->SetSpecularColor(1.0f, 1.0f, 1.0f, 1.0f);
-		m_Light->SetSpecularPower(16.0f);
-	}
-
 	m_Light->SetDirection(0.0f, 0.0f, 1.0f);
 	LOG("Light initialized successfully");
 
@@ -385,6 +364,14 @@ bool Application::Initialize(int screenWidth, int screenHeight, HWND hwnd, MainW
 void Application::Shutdown()
 {
 	LOG("Application::Shutdown called");
+
+	// Wait for the workers to let go of the models before releasing them.
+	if (m_ModelLoader)
+	{
+		m_ModelLoader->Shutdown();
+		delete m_ModelLoader;
+		m_ModelLoader = 0;
+	}
 	
 	// Release the user interface object.
 	if (m_UserInterface)
@@ -430,6 +417,14 @@ void Application::Shutdown()
 		m_Light = 0;
 	}
 
+	// The streamer only refers to the model's textures, release it first.
+	if (m_TextureStreamer)
+	{
+		m_TextureStreamer->Shutdown();
+		delete m_TextureStreamer;
+		m_TextureStreamer = 0;
+	}
+
 	// Release the model object.
 	if (m_Model)
 	{
@@ -519,6 +514,36 @@ bool Application::Frame(InputManager* Input)
 	// Update the system stats.
 	m_Timer->Frame();
 
+	// Finish the models whose loading has progressed far enough.
+	m_ModelLoader->Update(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext());
+	if (m_ModelLoad.valid() && m_ModelLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		m_ModelReady = m_ModelLoad.get();
+		m_ModelLoad = ModelLoader::Handle();
+		if (m_ModelReady)
+		{
+			OnModelLoaded();
+		}
+		else
+		{
+			LOG_ERROR("Could not load the FBX model object, only the scene around it will be rendered");
+		}
+	}
+
+	static const char* GIZMO_NAMES[] = { "position", "rotation", "scale" };
+	for (int gizmo = 0; gizmo < 3; gizmo++)
+	{
+		std::shared_future<bool>& load = m_GizmoLoads[gizmo];
+		if (load.valid() && load.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			if (!load.get())
+			{
+				LOG_ERROR("Could not initialize " + std::string(GIZMO_NAMES[gizmo]) + " gizmo");
+			}
+			load = ModelLoader::Handle();
+		}
+	}
+
 	m_Fps = static_cast<int>(PerformanceProfiler::GetInstance().GetCurrentFPS());
 
 	// Check for F11 fullscreen toggle
@@ -736,12 +761,44 @@ bool Application::Frame(InputManager* Input)
 }
 
 
+void Application::OnModelLoaded()
+{
+	// If the model has FBX materials, we'll use those values
+	if (m_Model->HasFBXMaterial())
+	{
+		m_Light->SetAmbientColor(0.15f, 0.15f, 0.15f, 1.0f);
+		m_Light->SetDiffuseColor(1.0f, 1.0f, 1.0f, 1.0f);
+		m_Light->SetSpecularColor(1.0f, 1.0f, 1.0f, 1.0f);
+		m_Light->SetSpecularPower(32.0f);
+	}
+	else
+	{
+		m_Light->SetDiffuseColor(1.0f, 1.0f, 1.0f, 1.0f);
+		m_Light->SetSpecularColor(1.0f, 1.0f, 1.0f, 1.0f);
+		m_Light->SetSpecularPower(16.0f);
+	}
+
+	// The benchmark takes its LOD levels from the model.
+	if (m_BenchmarkSystem)
+	{
+		m_BenchmarkSystem->InitializeLODLevels(m_Model);
+	}
+
+	m_TextureStreamer->AddModel(m_Model);
+
+	// Every ship's world box is built from the model's oriented box, on the next frame.
+	const Model::MeshBounds& bounds = m_Model->GetBounds();
+	m_ModelList->SetLocalBounds(bounds.boxCenter, bounds.boxAxes, bounds.boxExtents);
+
+	LOG("Spaceship FBX model initialized successfully");
+	LOG(ResourceCache::FormatStats(ResourceCache::GetInstance().GetStats()));
+}
+
 bool Application::Render()
 {
 	XMMATRIX worldMatrix, viewMatrix, projectionMatrix, orthoMatrix;
 	float positionX, positionY, positionZ, radius;
 	int modelCount, i;
-	bool renderModel;
 	bool result;
 
 	// Clear the buffers to begin the scene.
@@ -755,8 +812,9 @@ bool Application::Render()
 	
 	XMFLOAT3 cameraPos = m_Camera->GetPosition();
 
-	// Get the number of models that will be rendered.
-	modelCount = m_ModelList->GetModelCount();
+	// Get the number of models that will be rendered. Until the model has
+	// loaded only the skybox and the user interface are drawn.
+	modelCount = m_ModelReady ? m_ModelList->GetModelCount() : 0;
 
 	// Initialize the count of models that have been rendered.
 	m_RenderCount = 0;
@@ -771,7 +829,7 @@ bool Application::Render()
 	m_Direct3D->TurnZBufferOff();
 
 	// GPU-Driven Rendering Path
-	if (m_enableGPUDrivenRendering && m_GPUDrivenRenderer)
+	if (m_enableGPUDrivenRendering && m_GPUDrivenRenderer && m_ModelReady)
 	{
 		// Additional safety check to ensure GPU-driven renderer is properly initialized
 		if (!m_GPUDrivenRenderer->AreComputeShadersInitialized())
@@ -807,15 +865,13 @@ bool Application::Render()
 			
 
 			
+			const ModelList::TransformArrays& transforms = m_ModelList->GetTransforms();
 			for (int i = 0; i < modelCount; i++)
 			{
-				float posX, posY, posZ, rotX, rotY, rotZ, scaleX, scaleY, scaleZ;
-				m_ModelList->GetTransformData(i, posX, posY, posZ, rotX, rotY, rotZ, scaleX, scaleY, scaleZ);
-				
 				ObjectData objData;
-				objData.position = XMFLOAT3(posX, posY, posZ);
-				objData.scale = XMFLOAT3(scaleX, scaleY, scaleZ);
-				objData.rotation = XMFLOAT3(rotX, rotY, rotZ);
+				objData.position = XMFLOAT3(transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i]);
+				objData.scale = XMFLOAT3(transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i]);
+				objData.rotation = XMFLOAT3(transforms.rotationX[i], transforms.rotationY[i], transforms.rotationZ[i]);
 				
 				// Use the actual model's bounding box for consistent frustum culling
 				const Model::AABB& bbox = m_Model->GetBoundingBox();
@@ -904,6 +960,14 @@ bool Application::Render()
 			}
 			fclose(testFile);
 			
+			// The GPU-driven path binds the full vertex layout only
+			if (m_Model->GetVertexQuantization())
+			{
+				LOG_ERROR("Application::Render - Model uses compact vertices, falling back to CPU-driven rendering");
+				m_enableGPUDrivenRendering = false;
+				return true; // Continue with CPU-driven rendering
+			}
+
 			// Perform GPU-driven rendering with additional safety checks
 			ID3D11Buffer* vertexBuffer = m_Model->GetVertexBuffer();
 			ID3D11Buffer* indexBuffer = m_Model->GetIndexBuffer();
@@ -992,7 +1056,7 @@ bool Application::Render()
 	}
 	
 	// CPU-Driven Rendering Path (fallback or primary)
-	if (!m_enableGPUDrivenRendering)
+	if (!m_enableGPUDrivenRendering || !m_ModelReady)
 	{
 		// Traditional CPU-Driven Rendering Path
 
@@ -1018,144 +1082,252 @@ bool Application::Render()
 		m_Direct3D->TurnZBufferOn();
 
 		// Go through all the models and render them only if they can be seen by the camera view.
-		int cpuVisibleCount = 0;
-		
-		// Start CPU frustum culling timing
+
+		// Pixels per unit of geometric error at distance 1, for LOD selection.
+		XMFLOAT4X4 projection;
+		XMStoreFloat4x4(&projection, projectionMatrix);
+		float lodProjectionScale = projection._22 * (float)m_screenHeight * 0.5f;
+		XMFLOAT3 cameraPosition = m_Camera->GetPosition();
+
+		// Model space bounding volumes, shared by every instance
+		const Model::MeshBounds& bounds = m_Model->GetBounds();
+
+		// World space frustum planes for meshlet culling, and its results for this frame
+		XMFLOAT4 frustumPlanes[6];
+		m_Frustum->GetPlanes(frustumPlanes);
+		std::vector<MeshletBuilder::DrawRange> drawRanges;
+		MeshletBuilder::CullStats meshletStats;
+
+		// The visible models request the texture levels they need this frame.
+		m_TextureStreamer->BeginFrame();
+
+		// Culling is a stage of its own: bring the world boxes of the ships that moved up to date, then
+		// cull every instance against its cached box in chunks on the job system. The draws below only
+		// read the list of visible instances.
 		auto cpuCullingStart = std::chrono::high_resolution_clock::now();
-		
-		for (i = 0; i < modelCount; i++)
+
+		m_ModelList->UpdateWorldBounds();
+		const ModelList::BoundsArrays& worldBounds = m_ModelList->GetWorldBounds();
+		m_cullVisibility.resize(FrustumCuller::GetMaskWordCount(modelCount));
+		m_Frustum->CheckAABBs(worldBounds.minX.data(), worldBounds.minY.data(), worldBounds.minZ.data(),
+			worldBounds.maxX.data(), worldBounds.maxY.data(), worldBounds.maxZ.data(), modelCount, m_cullVisibility.data(), m_visibleInstances);
+
+		// The culling time ends here, draw submission is not part of it.
+		auto cpuCullingEnd = std::chrono::high_resolution_clock::now();
+		auto cpuCullingDuration = std::chrono::duration_cast<std::chrono::microseconds>(cpuCullingEnd - cpuCullingStart);
+		PerformanceProfiler::GetInstance().SetCPUFrustumCullingTime(static_cast<double>(cpuCullingDuration.count()));
+		PerformanceProfiler::GetInstance().SetFrustumCullingObjects(static_cast<uint32_t>(modelCount), static_cast<uint32_t>(m_visibleInstances.size()));
+
+		const ModelList::TransformArrays& transforms = m_ModelList->GetTransforms();
+		for (uint32_t visibleIndex : m_visibleInstances)
 		{
+			i = (int)visibleIndex;
+
 			// Get the full transform data for this model
-			float posX, posY, posZ, rotX, rotY, rotZ, scaleX, scaleY, scaleZ;
-			m_ModelList->GetTransformData(i, posX, posY, posZ, rotX, rotY, rotZ, scaleX, scaleY, scaleZ);
+			float posX = transforms.positionX[i], posY = transforms.positionY[i], posZ = transforms.positionZ[i];
+			float rotX = transforms.rotationX[i], rotY = transforms.rotationY[i], rotZ = transforms.rotationZ[i];
+			float scaleX = transforms.scaleX[i], scaleY = transforms.scaleY[i], scaleZ = transforms.scaleZ[i];
 
-			// Get the model's bounding box
-			const Model::AABB& bbox = m_Model->GetBoundingBox();
+			// Create world matrix with position, rotation, and scale
+			XMMATRIX translationMatrix = XMMatrixTranslation(posX, posY, posZ);
+			XMMATRIX rotationMatrix = XMMatrixRotationRollPitchYaw(rotX, rotY, rotZ);
+			XMMATRIX scaleMatrix = XMMatrixScaling(scaleX, scaleY, scaleZ);
+			XMMATRIX modelWorldMatrix = XMMatrixMultiply(XMMatrixMultiply(scaleMatrix, rotationMatrix), translationMatrix);
 
-			// Transform the bounding box to world space (considering scale)
-			XMFLOAT3 worldMin, worldMax;
-			worldMin.x = bbox.min.x * scaleX + posX;
-			worldMin.y = bbox.min.y * scaleY + posY;
-			worldMin.z = bbox.min.z * scaleZ + posZ;
-			worldMax.x = bbox.max.x * scaleX + posX;
-			worldMax.y = bbox.max.y * scaleY + posY;
-			worldMax.z = bbox.max.z * scaleZ + posZ;
+			// The bounding sphere where the rotation puts it, for the LOD and texture levels
+			XMFLOAT3 worldCenter;
+			XMStoreFloat3(&worldCenter, XMVector3TransformCoord(XMVectorSet(bounds.center[0], bounds.center[1], bounds.center[2], 1.0f), modelWorldMatrix));
+			float worldScale = fmaxf(fabsf(scaleX), fmaxf(fabsf(scaleY), fabsf(scaleZ)));
 
-		
+			worldMatrix = modelWorldMatrix;
 
-			// Check if the model's AABB is in the view frustum
-			renderModel = m_Frustum->CheckAABB(worldMin, worldMax);
+			// Render the model's buffers.
+			m_Model->Render(m_Direct3D->GetDeviceContext());
+
+			// Check if this model is selected for visual feedback
+			bool isSelected = m_SelectionManager->IsModelSelected(i);
 			
-		
+			// Draw calls and triangles submitted for this model
+			int modelDrawCalls = 1;
+			int modelTriangles = m_Model->GetIndexCount() / 3;
 
-			// If it can be seen then render it, if not skip this model and check the next one
-			if (renderModel)
+			// Check if this is an FBX model with PBR materials first
+			if (m_Model->HasFBXMaterial())
 			{
-				cpuVisibleCount++;
-				// Create world matrix with position, rotation, and scale
-				XMMATRIX translationMatrix = XMMatrixTranslation(posX, posY, posZ);
-				XMMATRIX rotationMatrix = XMMatrixRotationRollPitchYaw(rotX, rotY, rotZ);
-				XMMATRIX scaleMatrix = XMMatrixScaling(scaleX, scaleY, scaleZ);
-				worldMatrix = XMMatrixMultiply(XMMatrixMultiply(scaleMatrix, rotationMatrix), translationMatrix);
-
-				// Render the model's buffers.
-				m_Model->Render(m_Direct3D->GetDeviceContext());
-
-				// Check if this model is selected for visual feedback
-				bool isSelected = m_SelectionManager->IsModelSelected(i);
-				
-				// Check if this is an FBX model with PBR materials first
-				if (m_Model->HasFBXMaterial())
+				// Pick the coarsest LOD whose error stays below a pixel at this distance.
+				float centerX = worldCenter.x - cameraPosition.x;
+				float centerY = worldCenter.y - cameraPosition.y;
+				float centerZ = worldCenter.z - cameraPosition.z;
+				float distance = sqrtf(centerX * centerX + centerY * centerY + centerZ * centerZ);
+				int lod = m_Model->SelectLOD(distance, worldScale, lodProjectionScale, AppConfig::LOD_MAX_SCREEN_ERROR);
+
+				// Projected diameter in pixels, which picks the texture levels to stream in.
+				float screenSize = distance > bounds.radius * worldScale ? 2.0f * bounds.radius * worldScale * lodProjectionScale / distance : (float)m_screenHeight;
+
+				// Meshlets are culled in model space. A plane moves there through the transposed world
+				// matrix; the backface cones only hold while the transform keeps the winding.
+				bool cullMeshlets = lod == 0 && m_Model->HasMeshlets();
+				float modelPlanes[6][4];
+				float modelCamera[3];
+				bool keepsWinding = false;
+				if (cullMeshlets)
 				{
-					XMFLOAT3 lightDir = m_Light->GetDirection();
-					XMFLOAT4 ambientColor = m_Light->GetAmbientColor();
-					XMFLOAT4 diffuseColor = m_Light->GetDiffuseColor();
-					XMFLOAT3 cameraPos = m_Camera->GetPosition();
-					
-					// Use PBR shader for FBX models with multiple textures
-					result = m_ShaderManager->RenderPBRShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-						m_Model->GetDiffuseTexture(), m_Model->GetNormalTexture(), m_Model->GetMetallicTexture(),
-						m_Model->GetRoughnessTexture(), m_Model->GetEmissionTexture(), m_Model->GetAOTexture(),
-						m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Model->GetBaseColor(),
-						m_Model->GetMetallic(), m_Model->GetRoughness(), m_Model->GetAO(), m_Model->GetEmissionStrength(), m_Camera->GetPosition(), false);
-					if (!result)
+					XMMATRIX planeTransform = XMMatrixTranspose(worldMatrix);
+					for (int plane = 0; plane < 6; plane++)
 					{
-						LOG_ERROR("Model render with PBRShader failed");
-						return false;
+						XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(modelPlanes[plane]), XMVector4Transform(XMLoadFloat4(&frustumPlanes[plane]), planeTransform));
 					}
+
+					XMVECTOR determinant;
+					XMMATRIX inverseWorldMatrix = XMMatrixInverse(&determinant, worldMatrix);
+					XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(modelCamera), XMVector3TransformCoord(XMLoadFloat3(&cameraPosition), inverseWorldMatrix));
+					keepsWinding = XMVectorGetX(determinant) > 0.0f;
 				}
-				else
+
+				// One draw per submesh with that submesh's material. Multi-material models also
+				// cull every submesh against the frustum on its own.
+				int submeshCount = m_Model->GetSubmeshCount(lod);
+				modelDrawCalls = 0;
+				modelTriangles = 0;
+
+				for (int submeshIndex = 0; submeshIndex < submeshCount; submeshIndex++)
 				{
-					// Get the texture from the model for non-FBX models
-					ID3D11ShaderResourceView* modelTexture = m_Model->GetTexture();
+					const Model::Submesh& submesh = m_Model->GetSubmesh(submeshIndex, lod);
+					int material = (int)submesh.materialIndex;
 
-					// Only render with the light shader if the model has a texture.
-					if (modelTexture)
+					if (submeshCount > 1)
 					{
-						// Use regular light shader for simple textured models
-						result = m_ShaderManager->RenderLightShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
-							modelTexture, m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(),
-							m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower());
-						if (!result)
+						// The submesh AABB becomes an oriented box in world space, the rows of the world matrix are its axes.
+						XMFLOAT3 submeshCenter, submeshHalfAxes[3];
+						XMStoreFloat3(&submeshCenter, XMVector3TransformCoord(XMVectorSet((submesh.boundsMin[0] + submesh.boundsMax[0]) * 0.5f,
+							(submesh.boundsMin[1] + submesh.boundsMax[1]) * 0.5f, (submesh.boundsMin[2] + submesh.boundsMax[2]) * 0.5f, 1.0f), worldMatrix));
+						for (int axis = 0; axis < 3; axis++)
 						{
-							LOG_ERROR("Model render with LightShader failed");
-							return false;
+							float halfSize = (submesh.boundsMax[axis] - submesh.boundsMin[axis]) * 0.5f;
+							XMStoreFloat3(&submeshHalfAxes[axis], XMVectorScale(worldMatrix.r[axis], halfSize));
 						}
+
+						if (!m_Frustum->CheckOBB(submeshCenter, submeshHalfAxes))
+						{
+							continue;
+						}
+					}
+
+					// The visible index ranges: the surviving meshlets, merged where they are neighbours, or the whole submesh.
+					drawRanges.clear();
+					if (cullMeshlets)
+					{
+						int meshletCount;
+						const Model::Meshlet* meshlets = m_Model->GetSubmeshMeshlets(submeshIndex, meshletCount);
+						MeshletBuilder::Cull(meshlets, (size_t)meshletCount, modelPlanes, keepsWinding ? modelCamera : nullptr, drawRanges, &meshletStats);
 					}
 					else
 					{
-						// If there is no texture, render the model with a solid color.
-						/*LOG_WARNING("Model has no texture, rendering with ColorShader.");*/
-						result = m_ShaderManager->RenderColorShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, XMFLOAT4(0.7f, 0.7f, 0.7f, 1.0f));
-						if (!result)
-						{
-							LOG_ERROR("Model render with ColorShader failed");
-							return false;
-						}
+						drawRanges.push_back({ submesh.indexOffset, submesh.indexCount });
+					}
+					if (drawRanges.empty())
+					{
+						continue;
 					}
-				}
 
-				// Track model draw call and triangles
-				PerformanceProfiler::GetInstance().IncrementDrawCalls();
-				PerformanceProfiler::GetInstance().AddTriangles(m_Model->GetIndexCount() / 3); // Convert indices to triangles
-				PerformanceProfiler::GetInstance().AddInstances(1); // Each model instance counts as 1
+					m_TextureStreamer->RequestMaterial(m_Model, material, screenSize);
+					result = m_ShaderManager->RenderPBRShader(m_Direct3D->GetDeviceContext(), (int)drawRanges[0].indexCount, worldMatrix, viewMatrix, projectionMatrix,
+						m_Model->GetDiffuseTexture(material), m_Model->GetNormalTexture(material), m_Model->GetMetallicTexture(material),
+						m_Model->GetRoughnessTexture(material), m_Model->GetEmissionTexture(material), m_Model->GetAOTexture(material),
+						m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Model->GetBaseColor(material),
+						m_Model->GetMetallic(material), m_Model->GetRoughness(material), m_Model->GetAO(material), m_Model->GetEmissionStrength(material),
+						m_Camera->GetPosition(), false, (int)drawRanges[0].indexOffset, m_Model->GetVertexQuantization());
+					if (!result)
+					{
+						LOG_ERROR("Model render with PBRShader failed");
+						return false;
+					}
+
+					// The shader and material stay bound for the other ranges.
+					for (size_t range = 1; range < drawRanges.size(); range++)
+					{
+						m_Direct3D->GetDeviceContext()->DrawIndexed(drawRanges[range].indexCount, drawRanges[range].indexOffset, 0);
+					}
+
+					for (const MeshletBuilder::DrawRange& range : drawRanges)
+					{
+						modelDrawCalls++;
+						modelTriangles += (int)range.indexCount / 3;
+					}
+				}
+			}
+			else
+			{
+				// Get the texture from the model for non-FBX models
+				ID3D11ShaderResourceView* modelTexture = m_Model->GetTexture();
 
-				// Render selection highlight if this model is selected
-				if (isSelected)
+				// Only render with the light shader if the model has a texture.
+				if (modelTexture)
+				{
+					// Use regular light shader for simple textured models
+					result = m_ShaderManager->RenderLightShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix,
+						modelTexture, m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(),
+						m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower());
+					if (!result)
+					{
+						LOG_ERROR("Model render with LightShader failed");
+						return false;
+					}
+				}
+				else
 				{
-					// Render a wireframe outline or different colored version
-					// For now, we'll render a simple colored version on top
-					m_Direct3D->TurnOffCulling();
-					m_Direct3D->TurnZBufferOff();
-					
-					// Render selection highlight with bright color
-					XMFLOAT4 selectionColor = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.3f); // Yellow with transparency
-					result = m_ShaderManager->RenderColorShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, selectionColor);
-					
-					m_Direct3D->TurnOnCulling();
-					m_Direct3D->TurnZBufferOn();
-					
+					// If there is no texture, render the model with a solid color.
+					/*LOG_WARNING("Model has no texture, rendering with ColorShader.");*/
+					result = m_ShaderManager->RenderColorShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, XMFLOAT4(0.7f, 0.7f, 0.7f, 1.0f));
 					if (!result)
 					{
-						LOG_ERROR("Selection highlight render failed");
+						LOG_ERROR("Model render with ColorShader failed");
+						return false;
 					}
+				}
+			}
 
-					// Track selection highlight draw call
-					PerformanceProfiler::GetInstance().IncrementDrawCalls();
+			// Track model draw calls and triangles
+			for (int d = 0; d < modelDrawCalls; d++)
+			{
+				PerformanceProfiler::GetInstance().IncrementDrawCalls();
+			}
+			PerformanceProfiler::GetInstance().AddTriangles(modelTriangles);
+			PerformanceProfiler::GetInstance().AddInstances(1); // Each model instance counts as 1
+
+			// Render selection highlight if this model is selected. The color
+			// shader reads full vertices, so compact models go without it.
+			if (isSelected && !m_Model->GetVertexQuantization())
+			{
+				// Render a wireframe outline or different colored version
+				// For now, we'll render a simple colored version on top
+				m_Direct3D->TurnOffCulling();
+				m_Direct3D->TurnZBufferOff();
+				
+				// Render selection highlight with bright color
+				XMFLOAT4 selectionColor = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.3f); // Yellow with transparency
+				result = m_ShaderManager->RenderColorShader(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, selectionColor);
+				
+				m_Direct3D->TurnOnCulling();
+				m_Direct3D->TurnZBufferOn();
+				
+				if (!result)
+				{
+					LOG_ERROR("Selection highlight render failed");
 				}
 
-				// Since this model was rendered then increase the count for this frame.
-				m_RenderCount++;
+				// Track selection highlight draw call
+				PerformanceProfiler::GetInstance().IncrementDrawCalls();
 			}
+
+			// Since this model was rendered then increase the count for this frame.
+			m_RenderCount++;
 		}
 		
-		// End CPU frustum culling timing
-		auto cpuCullingEnd = std::chrono::high_resolution_clock::now();
-		auto cpuCullingDuration = std::chrono::duration_cast<std::chrono::microseconds>(cpuCullingEnd - cpuCullingStart);
-		
-		// Update PerformanceProfiler with CPU frustum culling data
-		PerformanceProfiler::GetInstance().SetCPUFrustumCullingTime(static_cast<double>(cpuCullingDuration.count()));
-		PerformanceProfiler::GetInstance().SetFrustumCullingObjects(static_cast<uint32_t>(modelCount), static_cast<uint32_t>(cpuVisibleCount));
+		PerformanceProfiler::GetInstance().SetMeshletCulling(static_cast<uint32_t>(meshletStats.triangleCount), static_cast<uint32_t>(meshletStats.trianglesCulled));
+
+		// Load and evict texture levels for what was drawn. The new views are used from the next frame.
+		m_TextureStreamer->Update(m_Direct3D->GetDevice());
 		
 	
 
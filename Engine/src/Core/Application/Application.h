@@ -3,13 +3,17 @@
 
 #include <d3d11.h>
 #include <directxmath.h>
+#include <cstdint>
 #include <functional>
+#include <future>
+#include <vector>
 
 // Forward declarations
 class MainWindow;
 class D3D11Device;
 class Camera;
 class Model;
+class ModelLoader;
 class Light;
 class ShaderManager;
 class Zone;
@@ -26,6 +30,7 @@ class DisplayPlane;
 class GPUDrivenRenderer;
 class PerformanceProfiler;
 class RenderingBenchmark;
+class TextureStreamer;
 
 using namespace DirectX;
 
@@ -36,6 +41,11 @@ namespace AppConfig
     constexpr bool VSYNC_ENABLED = false;
     constexpr float SCREEN_DEPTH = 1000.0f;
     constexpr float SCREEN_NEAR = 0.1f;
+    constexpr float LOD_MAX_SCREEN_ERROR = 1.0f;  // Largest projected LOD error, in pixels
+    constexpr bool COMPACT_MODEL_VERTICES = false; // 20 byte quantized vertices, CPU-driven PBR path only
+    constexpr bool MESHLET_CULLING = false;        // Cull LOD 0 per meshlet (frustum and backface cone), CPU-driven PBR path only
+    constexpr unsigned int TEXTURE_STREAMING_TAIL = 64; // Texture levels up to this size stay resident, finer ones stream; 0 loads all
+    constexpr size_t TEXTURE_BUDGET_MB = 128;      // Streamed texture memory, requested by the CPU-driven path
 }
 
 class Application
@@ -76,14 +86,16 @@ public:
 	// Getters for benchmark system to access real rendering components
 	class Camera* GetCamera() { return m_Camera; }
 	class Frustum* GetFrustum() { return m_Frustum; }
-	class Model* GetModel() { return m_Model; }
+	class Model* GetModel() { return m_ModelReady ? m_Model : nullptr; }
 	class ModelList* GetModelList() { return m_ModelList; }
 	class ShaderManager* GetShaderManager() { return m_ShaderManager; }
 	class D3D11Device* GetDirect3D() { return m_Direct3D; }
 	class Light* GetLight() { return m_Light; }
+	int GetScreenHeight() const { return m_screenHeight; }
 
 private:
 	bool Render();
+	void OnModelLoaded();
 	bool UpdateFps();
 	bool UpdateRenderCountString(int renderCount);
 
@@ -99,9 +111,14 @@ private:
 
 	// Models and resources
 	Model* m_Model;
+	ModelLoader* m_ModelLoader;
+	std::shared_future<bool> m_ModelLoad;   // Valid until the model has finished loading
+	bool m_ModelReady;
+	TextureStreamer* m_TextureStreamer;
 	Model* m_PositionGizmo;
 	Model* m_RotationGizmo;
 	Model* m_ScaleGizmo;
+	std::shared_future<bool> m_GizmoLoads[3];   // Position, rotation, scale; valid until each has finished loading
 	Light* m_Light;
 	Zone* m_Zone;
 	Sprite* m_Cursor;
@@ -113,6 +130,11 @@ private:
 	Frustum* m_Frustum;
 	DisplayPlane* m_DisplayPlane;
 
+	// CPU culling, reused every frame: a visibility bit per instance and
+	// the visible instances in order, which the draws go through
+	std::vector<uint32_t> m_cullVisibility;
+	std::vector<uint32_t> m_visibleInstances;
+
 	// Application state
 	int m_screenWidth, m_screenHeight;
 	int m_Fps;
@@ -21,7 +21,7 @@ namespace EngineTypes
     {
         XMFLOAT3 min = {0.0f, 0.0f, 0.0f};
         XMFLOAT3 max = {0.0f, 0.0f, 0.0f};
-        float radius = 0.0f;  // For backward compatibility with sphere culling
+        float radius = 0.0f;  // Bounding sphere radius, see Model::GetBounds for its center
     };
 
     // Material information structure
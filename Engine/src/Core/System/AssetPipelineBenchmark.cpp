@@ -0,0 +1,3826 @@
+#include "AssetPipelineBenchmark.h"
+#include "Logger.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "../../Graphics/Resource/Mesh/MeshBuilder.h"
+#include "../../Graphics/Resource/Mesh/MeshWelder.h"
+#include "../../Graphics/Resource/Mesh/MeshOptimizer.h"
+#include "../../Graphics/Resource/Mesh/MeshSimplifier.h"
+#include "../../Graphics/Resource/Mesh/CookedMesh.h"
+#include "../../Graphics/Resource/Mesh/TextModelParser.h"
+#include "../../Graphics/Resource/Mesh/VertexCompressor.h"
+#include "../../Graphics/Resource/Mesh/TangentGenerator.h"
+#include "../../Graphics/Resource/Mesh/BoundsCalculator.h"
+#include "../../Graphics/Resource/Mesh/MeshletBuilder.h"
+#include "../../Graphics/Resource/TextureDirectoryIndex.h"
+#include "../../Graphics/Math/BoundsTransform.h"
+#include "../../Graphics/Math/FrustumCuller.h"
+#include "../../Graphics/Resource/Image/AtlasCooker.h"
+#include "../../Graphics/Resource/Image/AtlasPacker.h"
+#include "../../Graphics/Resource/Image/BlockCompressor.h"
+#include "../../Graphics/Resource/Image/DdsFile.h"
+#include "../../Graphics/Resource/Image/ImageDecoder.h"
+#include "../../Graphics/Resource/Image/KtxFile.h"
+#include "../../Graphics/Resource/Image/MipGenerator.h"
+#include "../../Graphics/Resource/Image/MipResidency.h"
+#include "../../Graphics/Resource/Image/TargaDecoder.h"
+#include "../../Graphics/Resource/Image/TextureCooker.h"
+#include "../../Graphics/Resource/Animation/AnimationSampler.h"
+#include "../../Graphics/Resource/Animation/CharacterAnimator.h"
+#include "../../Graphics/Resource/Animation/ClipCompressor.h"
+#include "../../Graphics/Resource/Animation/SkinWeightBuilder.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <thread>
+
+namespace
+{
+    // The per-face tangent code Model used before TangentGenerator, kept as the
+    // baseline: one flat frame per triangle of an unindexed list, scalar math.
+    void CalculateFlatTangents(MeshTypes::MeshVertex* vertices, size_t vertexCount)
+    {
+        for (size_t i = 0; i + 2 < vertexCount; i += 3)
+        {
+            MeshTypes::MeshVertex vertex1 = vertices[i];
+            MeshTypes::MeshVertex vertex2 = vertices[i + 1];
+            MeshTypes::MeshVertex vertex3 = vertices[i + 2];
+
+            float vector1[3] = { vertex2.x - vertex1.x, vertex2.y - vertex1.y, vertex2.z - vertex1.z };
+            float vector2[3] = { vertex3.x - vertex1.x, vertex3.y - vertex1.y, vertex3.z - vertex1.z };
+            float tuVector[2] = { vertex2.tu - vertex1.tu, vertex3.tu - vertex1.tu };
+            float tvVector[2] = { vertex2.tv - vertex1.tv, vertex3.tv - vertex1.tv };
+
+            float den = 1.0f / (tuVector[0] * tvVector[1] - tuVector[1] * tvVector[0]);
+
+            float tangent[3], binormal[3];
+            for (int k = 0; k < 3; k++)
+            {
+                tangent[k] = (tvVector[1] * vector1[k] - tvVector[0] * vector2[k]) * den;
+                binormal[k] = (tuVector[0] * vector2[k] - tuVector[1] * vector1[k]) * den;
+            }
+
+            float length = std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+            float binormalLength = std::sqrt(binormal[0] * binormal[0] + binormal[1] * binormal[1] + binormal[2] * binormal[2]);
+            for (int k = 0; k < 3; k++)
+            {
+                tangent[k] = tangent[k] / length;
+                binormal[k] = binormal[k] / binormalLength;
+            }
+
+            for (size_t v = i; v < i + 3; v++)
+            {
+                vertices[v].tx = tangent[0];
+                vertices[v].ty = tangent[1];
+                vertices[v].tz = tangent[2];
+                vertices[v].bx = binormal[0];
+                vertices[v].by = binormal[1];
+                vertices[v].bz = binormal[2];
+            }
+        }
+    }
+}
+
+namespace
+{
+    // Frustum planes (inside positive) looking from eye to target, a square
+    // field of view of 2 * halfFov from 0.1 to farDistance.
+    void MakeFrustumPlanes(const float eye[3], const float target[3], float halfFov, float farDistance, float planes[6][4])
+    {
+        float f[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+        float fLength = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+        for (float& c : f) c /= fLength;
+        float r[3] = { f[2], 0.0f, -f[0] };
+        float rLength = std::sqrt(r[0] * r[0] + r[2] * r[2]);
+        for (float& c : r) c /= rLength;
+        float u[3] = { f[1] * r[2] - f[2] * r[1], f[2] * r[0] - f[0] * r[2], f[0] * r[1] - f[1] * r[0] };
+
+        float s = std::sin(halfFov), c = std::cos(halfFov);
+        const float sides[4][3] =
+        {
+            { f[0] * s + r[0] * c, f[1] * s + r[1] * c, f[2] * s + r[2] * c },
+            { f[0] * s - r[0] * c, f[1] * s - r[1] * c, f[2] * s - r[2] * c },
+            { f[0] * s + u[0] * c, f[1] * s + u[1] * c, f[2] * s + u[2] * c },
+            { f[0] * s - u[0] * c, f[1] * s - u[1] * c, f[2] * s - u[2] * c }
+        };
+        for (int i = 0; i < 4; i++)
+        {
+            planes[i][0] = sides[i][0]; planes[i][1] = sides[i][1]; planes[i][2] = sides[i][2];
+            planes[i][3] = -(sides[i][0] * eye[0] + sides[i][1] * eye[1] + sides[i][2] * eye[2]);
+        }
+        float eyeDot = f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2];
+        planes[4][0] = f[0]; planes[4][1] = f[1]; planes[4][2] = f[2]; planes[4][3] = -(eyeDot + 0.1f);
+        planes[5][0] = -f[0]; planes[5][1] = -f[1]; planes[5][2] = -f[2]; planes[5][3] = eyeDot + farDistance;
+    }
+
+    // Writes rgba (top row first) as a TGA, bottom-up unless topDown is set.
+    // RLE packets stop at row ends.
+    bool WriteTarga(const std::string& filename, const std::vector<uint8_t>& rgba, int width, int height, int bitsPerPixel, bool rle, bool topDown)
+    {
+        int bytesPerPixel = bitsPerPixel / 8;
+        uint8_t header[18] = {};
+        header[2] = rle ? 10 : 2;
+        header[12] = (uint8_t)(width & 0xFF);
+        header[13] = (uint8_t)(width >> 8);
+        header[14] = (uint8_t)(height & 0xFF);
+        header[15] = (uint8_t)(height >> 8);
+        header[16] = (uint8_t)bitsPerPixel;
+        header[17] = (uint8_t)((bitsPerPixel == 32 ? 8 : 0) | (topDown ? 0x20 : 0));
+
+        std::vector<uint8_t> file(header, header + sizeof(header));
+        auto pixelAt = [&](int x, int row, uint8_t* out)
+        {
+            const uint8_t* source = &rgba[((size_t)(topDown ? row : height - 1 - row) * width + x) * 4];
+            out[0] = source[2];
+            out[1] = source[1];
+            out[2] = source[0];
+            out[3] = source[3];
+        };
+
+        uint8_t pixel[4], next[4];
+        for (int row = 0; row < height; row++)
+        {
+            for (int x = 0; x < width; )
+            {
+                pixelAt(x, row, pixel);
+                if (!rle)
+                {
+                    file.insert(file.end(), pixel, pixel + bytesPerPixel);
+                    x++;
+                    continue;
+                }
+
+                // A run of equal pixels, or raw pixels up to the next run.
+                int run = 1;
+                while (x + run < width && run < 128)
+                {
+                    pixelAt(x + run, row, next);
+                    if (std::memcmp(pixel, next, bytesPerPixel) != 0)
+                    {
+                        break;
+                    }
+                    run++;
+                }
+                if (run > 1)
+                {
+                    file.push_back((uint8_t)(0x80 | (run - 1)));
+                    file.insert(file.end(), pixel, pixel + bytesPerPixel);
+                    x += run;
+                    continue;
+                }
+
+                size_t countOffset = file.size();
+                file.push_back(0);
+                int count = 0;
+                while (x < width && count < 128)
+                {
+                    pixelAt(x, row, pixel);
+                    if (count > 0 && x + 1 < width)
+                    {
+                        pixelAt(x + 1, row, next);
+                        if (std::memcmp(pixel, next, bytesPerPixel) == 0)
+                        {
+                            break;
+                        }
+                    }
+                    file.insert(file.end(), pixel, pixel + bytesPerPixel);
+                    x++;
+                    count++;
+                }
+                file[countOffset] = (uint8_t)(count - 1);
+            }
+        }
+
+        std::ofstream stream(filename, std::ios::binary);
+        stream.write((const char*)file.data(), (std::streamsize)file.size());
+        return (bool)stream;
+    }
+
+    // The loader Texture used before TargaDecoder: read the whole file, then
+    // flip and swizzle into a second buffer. 32 bit uncompressed only.
+    bool LoadTargaBaseline(const std::string& filename, std::vector<uint8_t>& rgba, int& width, int& height)
+    {
+        FILE* filePtr = std::fopen(filename.c_str(), "rb");
+        if (!filePtr)
+        {
+            return false;
+        }
+
+        uint8_t header[18];
+        bool read = std::fread(header, sizeof(header), 1, filePtr) == 1;
+        width = header[12] | (header[13] << 8);
+        height = header[14] | (header[15] << 8);
+        if (!read || header[16] != 32)
+        {
+            std::fclose(filePtr);
+            return false;
+        }
+
+        size_t imageSize = (size_t)width * height * 4;
+        std::vector<uint8_t> targaImage(imageSize);
+        read = std::fread(targaImage.data(), 1, imageSize, filePtr) == imageSize;
+        std::fclose(filePtr);
+        if (!read)
+        {
+            return false;
+        }
+
+        rgba.resize(imageSize);
+        size_t index = 0;
+        size_t k = imageSize - (size_t)width * 4;
+        for (int j = 0; j < height; j++)
+        {
+            for (int i = 0; i < width; i++)
+            {
+                rgba[index + 0] = targaImage[k + 2];
+                rgba[index + 1] = targaImage[k + 1];
+                rgba[index + 2] = targaImage[k + 0];
+                rgba[index + 3] = targaImage[k + 3];
+                k += 4;
+                index += 4;
+            }
+            k -= (size_t)width * 8;
+        }
+
+        return true;
+    }
+
+    // Smooth gradients with a band of noise, shaped for the role: a tangent
+    // space normal map from a height field, a single mask channel, or color
+    // with an alpha ramp.
+    void GenerateRoleImage(int width, int height, ImageTypes::TextureRole role, bool withAlpha, std::vector<uint8_t>& rgba)
+    {
+        rgba.resize((size_t)width * height * 4);
+        uint32_t seed = 777;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                float u = (float)x / width;
+                float v = (float)y / height;
+                float noise = (y % 128) < 16 ? ((seed >> 24) / 255.0f - 0.5f) * 0.25f : 0.0f;
+                uint8_t* pixel = &rgba[((size_t)y * width + x) * 4];
+
+                if (role == ImageTypes::ROLE_NORMAL)
+                {
+                    // Derivatives of sin(u) * cos(v) ripples.
+                    float dx = 0.6f * std::cos(u * 18.0f) * std::cos(v * 12.0f) + noise;
+                    float dy = -0.6f * std::sin(u * 18.0f) * std::sin(v * 12.0f) + noise;
+                    float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+                    pixel[0] = (uint8_t)std::lround((-dx / length * 0.5f + 0.5f) * 255.0f);
+                    pixel[1] = (uint8_t)std::lround((-dy / length * 0.5f + 0.5f) * 255.0f);
+                    pixel[2] = (uint8_t)std::lround((1.0f / length * 0.5f + 0.5f) * 255.0f);
+                    pixel[3] = 255;
+                    continue;
+                }
+
+                float r = std::min(std::max(0.5f + 0.4f * std::sin(u * 9.0f + v * 3.0f) + noise, 0.0f), 1.0f);
+                float g = std::min(std::max(0.5f + 0.4f * std::cos(v * 7.0f) + noise, 0.0f), 1.0f);
+                float b = std::min(std::max(u * 0.7f + v * 0.2f + noise, 0.0f), 1.0f);
+                pixel[0] = (uint8_t)std::lround(r * 255.0f);
+                pixel[1] = (uint8_t)std::lround((role == ImageTypes::ROLE_MASK ? r : g) * 255.0f);
+                pixel[2] = (uint8_t)std::lround((role == ImageTypes::ROLE_MASK ? r : b) * 255.0f);
+                pixel[3] = withAlpha ? (uint8_t)std::lround(v * 255.0f) : 255;
+            }
+        }
+    }
+
+    // The level layout a cooked texture of that size and format has.
+    std::vector<ImageTypes::ImageLevel> GetLevelLayout(uint32_t width, uint32_t height, ImageTypes::PixelFormat format)
+    {
+        std::vector<ImageTypes::ImageLevel> levels;
+        size_t offset = 0;
+        for (;;)
+        {
+            ImageTypes::ImageLevel level;
+            level.width = width;
+            level.height = height;
+            level.rowPitch = BlockCompressor::GetRowPitch(format, width);
+            level.offset = offset;
+            level.size = BlockCompressor::GetLevelSize(format, width, height);
+            offset += level.size;
+            levels.push_back(level);
+            if (width == 1 && height == 1)
+            {
+                return levels;
+            }
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+    }
+
+    // A DDS without the DX10 extension, as older tools write it: BC1 as
+    // "DXT1", a cubemap through caps2.
+    bool WriteLegacyDds(const std::string& filename, const ImageTypes::Image& image)
+    {
+        uint32_t header[32] = {};
+        header[0] = 0x20534444;                 // "DDS "
+        header[1] = 124;
+        header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+        header[3] = image.height;
+        header[4] = image.width;
+        header[5] = (uint32_t)image.levels[0].size;
+        header[7] = (uint32_t)(image.levels.size() / image.layers);
+        header[19] = 32;                        // Pixel format
+        header[20] = 0x4;
+        header[21] = 0x31545844;                // "DXT1"
+        header[27] = 0x1000 | 0x8 | 0x400000;
+        header[28] = image.cubemap ? 0x200 | 0xFC00 : 0;
+
+        std::ofstream fout(filename, std::ios::binary | std::ios::trunc);
+        fout.write(reinterpret_cast<const char*>(header), sizeof(header));
+        fout.write(reinterpret_cast<const char*>(image.data.data()), (std::streamsize)image.data.size());
+        return (bool)fout;
+    }
+
+    // A KTX2 file as the Khronos tools lay it out: level index largest first,
+    // level data smallest first, each level's images layer by layer. The data
+    // format descriptor is left empty, the loader goes by vkFormat.
+    bool WriteKtx2(const std::string& filename, const ImageTypes::Image& image, uint32_t vkFormat, uint32_t supercompression)
+    {
+        uint32_t mipCount = (uint32_t)(image.levels.size() / image.layers);
+        uint32_t faces = image.cubemap ? 6 : 1;
+
+        std::vector<uint8_t> file(80 + (size_t)mipCount * 24 + 4, 0);
+        const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        const uint32_t fields[13] = { vkFormat, 1, image.width, image.height, 0, image.cubemap ? image.layers / 6 : image.layers, faces, mipCount,
+            supercompression, (uint32_t)(80 + mipCount * 24), 4, 0, 0 };
+        std::memcpy(file.data(), identifier, sizeof(identifier));
+        std::memcpy(file.data() + 12, fields, sizeof(fields));
+        uint32_t dfdSize = 4;
+        std::memcpy(file.data() + 80 + (size_t)mipCount * 24, &dfdSize, sizeof(dfdSize));
+
+        for (uint32_t mip = mipCount; mip-- > 0;)
+        {
+            file.resize((file.size() + 15) & ~(size_t)15);
+            uint64_t entry[3] = { file.size(), 0, 0 };
+            for (uint32_t layer = 0; layer < image.layers; layer++)
+            {
+                const ImageTypes::ImageLevel& level = image.levels[layer * mipCount + mip];
+                file.insert(file.end(), image.data.begin() + level.offset, image.data.begin() + level.offset + level.size);
+            }
+            entry[1] = entry[2] = file.size() - entry[0];
+            std::memcpy(file.data() + 80 + (size_t)mip * 24, entry, sizeof(entry));
+        }
+
+        std::ofstream fout(filename, std::ios::binary | std::ios::trunc);
+        fout.write(reinterpret_cast<const char*>(file.data()), (std::streamsize)file.size());
+        return (bool)fout;
+    }
+
+    // Bits go in least significant first, as deflate wants them.
+    struct DeflateWriter
+    {
+        std::vector<uint8_t>& out;
+        uint32_t buffer = 0;
+        int count = 0;
+
+        void Put(uint32_t bits, int length)
+        {
+            buffer |= bits << count;
+            count += length;
+            while (count >= 8)
+            {
+                out.push_back((uint8_t)buffer);
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+
+        // Huffman codes are stored most significant bit first.
+        void PutCode(uint32_t code, int length)
+        {
+            uint32_t reversed = 0;
+            for (int i = 0; i < length; i++)
+            {
+                reversed |= ((code >> i) & 1) << (length - 1 - i);
+            }
+            Put(reversed, length);
+        }
+
+        void Flush()
+        {
+            if (count > 0)
+            {
+                out.push_back((uint8_t)buffer);
+            }
+            buffer = 0;
+            count = 0;
+        }
+    };
+
+    // A zlib stream of one fixed Huffman block, greedy LZ77 matches from hash chains.
+    void CompressZlib(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+    {
+        static const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+            4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        const size_t window = 32768;
+        const int maxChain = 16;
+
+        out.push_back(0x78);
+        out.push_back(0x01);
+
+        DeflateWriter writer{ out };
+        writer.Put(1, 1);       // Final block
+        writer.Put(1, 2);       // Fixed codes
+
+        auto putLiteral = [&](uint32_t symbol)
+        {
+            if (symbol < 144) writer.PutCode(0x30 + symbol, 8);
+            else if (symbol < 256) writer.PutCode(0x190 + symbol - 144, 9);
+            else if (symbol < 280) writer.PutCode(symbol - 256, 7);
+            else writer.PutCode(0xC0 + symbol - 280, 8);
+        };
+
+        std::vector<int32_t> head(1 << 15, -1);
+        std::vector<int32_t> previous(data.size(), -1);
+        auto hashAt = [&](size_t i) { return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & 0x7FFF; };
+        auto insert = [&](size_t i)
+        {
+            if (i + 2 < data.size())
+            {
+                uint32_t hash = hashAt(i);
+                previous[i] = head[hash];
+                head[hash] = (int32_t)i;
+            }
+        };
+
+        for (size_t i = 0; i < data.size();)
+        {
+            size_t bestLength = 0, bestDistance = 0;
+            if (i + 2 < data.size())
+            {
+                int32_t candidate = head[hashAt(i)];
+                for (int chain = 0; chain < maxChain && candidate >= 0 && i - candidate <= window; chain++, candidate = previous[candidate])
+                {
+                    size_t length = 0;
+                    size_t limit = std::min<size_t>(258, data.size() - i);
+                    while (length < limit && data[candidate + length] == data[i + length])
+                    {
+                        length++;
+                    }
+                    if (length > bestLength)
+                    {
+                        bestLength = length;
+                        bestDistance = i - candidate;
+                    }
+                }
+            }
+
+            if (bestLength < 3)
+            {
+                putLiteral(data[i]);
+                insert(i++);
+                continue;
+            }
+
+            int lengthCode = 28;
+            while (LENGTH_BASE[lengthCode] > bestLength)
+            {
+                lengthCode--;
+            }
+            putLiteral(257 + lengthCode);
+            writer.Put((uint32_t)(bestLength - LENGTH_BASE[lengthCode]), LENGTH_EXTRA[lengthCode]);
+
+            int distanceCode = 29;
+            while (DISTANCE_BASE[distanceCode] > bestDistance)
+            {
+                distanceCode--;
+            }
+            writer.PutCode(distanceCode, 5);
+            writer.Put((uint32_t)(bestDistance - DISTANCE_BASE[distanceCode]), DISTANCE_EXTRA[distanceCode]);
+
+            for (size_t end = i + bestLength; i < end; i++)
+            {
+                insert(i);
+            }
+        }
+        putLiteral(256);
+        writer.Flush();
+
+        uint32_t a = 1, b = 0;
+        for (uint8_t value : data)
+        {
+            a = (a + value) % 65521;
+            b = (b + a) % 65521;
+        }
+        uint32_t adler = (b << 16) | a;
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back((uint8_t)(adler >> shift));
+        }
+    }
+
+    // Writes the first channels of rgba as an 8 bit gray (1), RGB (3) or RGBA
+    // (4) PNG. Rows cycle through the five filters and the data is split over
+    // several IDAT chunks, so the decoder sees all of them.
+    bool WritePng(const std::string& filename, const std::vector<uint8_t>& rgba, int width, int height, int channels)
+    {
+        static const uint8_t COLOR_TYPES[5] = { 0, 0, 0, 2, 6 };
+        size_t stride = (size_t)width * channels;
+
+        std::vector<uint8_t> rows((stride + 1) * height);
+        std::vector<uint8_t> row(stride), above(stride, 0);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                std::memcpy(&row[(size_t)x * channels], &rgba[((size_t)y * width + x) * 4], channels);
+            }
+
+            uint8_t filter = (uint8_t)(y % 5);
+            uint8_t* target = &rows[(stride + 1) * y];
+            target[0] = filter;
+            for (size_t i = 0; i < stride; i++)
+            {
+                int left = i >= (size_t)channels ? row[i - channels] : 0;
+                int up = above[i];
+                int upLeft = i >= (size_t)channels ? above[i - channels] : 0;
+                int predictor = 0;
+                switch (filter)
+                {
+                case 1: predictor = left; break;
+                case 2: predictor = up; break;
+                case 3: predictor = (left + up) / 2; break;
+                case 4:
+                {
+                    int estimate = left + up - upLeft;
+                    int distanceLeft = std::abs(estimate - left), distanceUp = std::abs(estimate - up), distanceUpLeft = std::abs(estimate - upLeft);
+                    predictor = distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft ? left : distanceUp <= distanceUpLeft ? up : upLeft;
+                    break;
+                }
+                }
+                target[1 + i] = (uint8_t)(row[i] - predictor);
+            }
+            row.swap(above);
+        }
+
+        std::vector<uint8_t> compressed;
+        CompressZlib(rows, compressed);
+
+        uint32_t crcTable[256];
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crcTable[n] = c;
+        }
+
+        std::vector<uint8_t> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        auto putChunk = [&](const char* type, const uint8_t* data, size_t size)
+        {
+            for (int shift = 24; shift >= 0; shift -= 8)
+            {
+                file.push_back((uint8_t)(size >> shift));
+            }
+            size_t start = file.size();
+            file.insert(file.end(), type, type + 4);
+            file.insert(file.end(), data, data + size);
+            uint32_t crc = 0xFFFFFFFFu;
+            for (size_t i = start; i < file.size(); i++)
+            {
+                crc = crcTable[(crc ^ file[i]) & 0xFF] ^ (crc >> 8);
+            }
+            crc ^= 0xFFFFFFFFu;
+            for (int shift = 24; shift >= 0; shift -= 8)
+            {
+                file.push_back((uint8_t)(crc >> shift));
+            }
+        };
+
+        uint8_t header[13] = { (uint8_t)(width >> 24), (uint8_t)(width >> 16), (uint8_t)(width >> 8), (uint8_t)width,
+            (uint8_t)(height >> 24), (uint8_t)(height >> 16), (uint8_t)(height >> 8), (uint8_t)height, 8, COLOR_TYPES[channels], 0, 0, 0 };
+        putChunk("IHDR", header, sizeof(header));
+        const size_t chunkSize = 65536;
+        for (size_t offset = 0; offset < compressed.size(); offset += chunkSize)
+        {
+            putChunk("IDAT", compressed.data() + offset, std::min(chunkSize, compressed.size() - offset));
+        }
+        putChunk("IEND", nullptr, 0);
+
+        std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+        stream.write((const char*)file.data(), (std::streamsize)file.size());
+        return (bool)stream;
+    }
+
+    // A baseline JPEG with the example tables of the standard (Annex K), gray
+    // or YCbCr with 2x2 subsampled chroma, optionally with restart markers.
+    bool WriteJpeg(const std::string& filename, const std::vector<uint8_t>& rgba, int width, int height, bool gray, bool subsample, int quality, int restartInterval)
+    {
+        static const uint8_t ZIGZAG[64] = { 0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+            35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+        static const uint8_t LUMA_QUANT[64] = { 16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55, 14, 13, 16, 24, 40, 57, 69, 56,
+            14, 17, 22, 29, 51, 87, 80, 62, 18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92, 49, 64, 78, 87, 103, 121, 120, 101,
+            72, 92, 95, 98, 112, 100, 103, 99 };
+        static const uint8_t CHROMA_QUANT[64] = { 17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99, 24, 26, 56, 99, 99, 99, 99, 99,
+            47, 66, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99 };
+        static const uint8_t DC_LUMA_BITS[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+        static const uint8_t DC_CHROMA_BITS[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+        static const uint8_t DC_VALUES[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+        static const uint8_t AC_LUMA_BITS[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+        static const uint8_t AC_LUMA_VALUES[162] = { 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+            0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16,
+            0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+            0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+            0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+            0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4,
+            0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+            0xF9, 0xFA };
+        static const uint8_t AC_CHROMA_BITS[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+        static const uint8_t AC_CHROMA_VALUES[162] = { 0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+            0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0, 0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34,
+            0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+            0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+            0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+            0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2,
+            0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+            0xF9, 0xFA };
+
+        struct HuffmanCodes
+        {
+            uint16_t code[256] = {};
+            uint8_t length[256] = {};
+        };
+        auto buildCodes = [](const uint8_t* bits, const uint8_t* values, HuffmanCodes& codes)
+        {
+            uint16_t code = 0;
+            int index = 0;
+            for (int length = 1; length <= 16; length++)
+            {
+                for (int i = 0; i < bits[length - 1]; i++, index++)
+                {
+                    codes.code[values[index]] = code++;
+                    codes.length[values[index]] = (uint8_t)length;
+                }
+                code <<= 1;
+            }
+        };
+        HuffmanCodes dcCodes[2], acCodes[2];
+        buildCodes(DC_LUMA_BITS, DC_VALUES, dcCodes[0]);
+        buildCodes(DC_CHROMA_BITS, DC_VALUES, dcCodes[1]);
+        buildCodes(AC_LUMA_BITS, AC_LUMA_VALUES, acCodes[0]);
+        buildCodes(AC_CHROMA_BITS, AC_CHROMA_VALUES, acCodes[1]);
+
+        // Quality scaling as the IJG encoder does it.
+        int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+        uint8_t quant[2][64];
+        for (int i = 0; i < 64; i++)
+        {
+            quant[0][i] = (uint8_t)std::min(std::max((LUMA_QUANT[i] * scale + 50) / 100, 1), 255);
+            quant[1][i] = (uint8_t)std::min(std::max((CHROMA_QUANT[i] * scale + 50) / 100, 1), 255);
+        }
+
+        // Full resolution planes, centered on zero.
+        int componentCount = gray ? 1 : 3;
+        std::vector<float> planes[3];
+        for (int c = 0; c < componentCount; c++)
+        {
+            planes[c].resize((size_t)width * height);
+        }
+        for (size_t i = 0; i < (size_t)width * height; i++)
+        {
+            float r = rgba[i * 4], g = rgba[i * 4 + 1], b = rgba[i * 4 + 2];
+            planes[0][i] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+            if (!gray)
+            {
+                planes[1][i] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+                planes[2][i] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+            }
+        }
+
+        float cosines[8][8];
+        for (int x = 0; x < 8; x++)
+        {
+            for (int u = 0; u < 8; u++)
+            {
+                cosines[x][u] = std::cos((2.0f * x + 1.0f) * u * 3.14159265f / 16.0f) * (u == 0 ? std::sqrt(0.125f) : 0.5f);
+            }
+        }
+
+        std::vector<uint8_t> file;
+        auto putMarker = [&](uint8_t marker, size_t length)
+        {
+            file.push_back(0xFF);
+            file.push_back(marker);
+            if (length > 0)
+            {
+                file.push_back((uint8_t)(length >> 8));
+                file.push_back((uint8_t)length);
+            }
+        };
+
+        putMarker(0xD8, 0);
+        putMarker(0xDB, 2 + 65 * (gray ? 1 : 2));
+        for (int t = 0; t < (gray ? 1 : 2); t++)
+        {
+            file.push_back((uint8_t)t);
+            for (int i = 0; i < 64; i++)
+            {
+                file.push_back(quant[t][ZIGZAG[i]]);
+            }
+        }
+
+        int lumaFactor = !gray && subsample ? 2 : 1;
+        putMarker(0xC0, 8 + 3 * componentCount);
+        file.push_back(8);
+        file.push_back((uint8_t)(height >> 8));
+        file.push_back((uint8_t)height);
+        file.push_back((uint8_t)(width >> 8));
+        file.push_back((uint8_t)width);
+        file.push_back((uint8_t)componentCount);
+        for (int c = 0; c < componentCount; c++)
+        {
+            file.push_back((uint8_t)(c + 1));
+            file.push_back((uint8_t)(c == 0 ? lumaFactor * 0x11 : 0x11));
+            file.push_back((uint8_t)(c == 0 ? 0 : 1));
+        }
+
+        struct Table { uint8_t id; const uint8_t* bits; const uint8_t* values; };
+        const Table tables[4] = { { 0x00, DC_LUMA_BITS, DC_VALUES }, { 0x10, AC_LUMA_BITS, AC_LUMA_VALUES },
+            { 0x01, DC_CHROMA_BITS, DC_VALUES }, { 0x11, AC_CHROMA_BITS, AC_CHROMA_VALUES } };
+        for (int t = 0; t < (gray ? 2 : 4); t++)
+        {
+            int count = 0;
+            for (int i = 0; i < 16; i++)
+            {
+                count += tables[t].bits[i];
+            }
+            putMarker(0xC4, 3 + 16 + count);
+            file.push_back(tables[t].id);
+            file.insert(file.end(), tables[t].bits, tables[t].bits + 16);
+            file.insert(file.end(), tables[t].values, tables[t].values + count);
+        }
+
+        if (restartInterval > 0)
+        {
+            putMarker(0xDD, 4);
+            file.push_back((uint8_t)(restartInterval >> 8));
+            file.push_back((uint8_t)restartInterval);
+        }
+
+        putMarker(0xDA, 6 + 2 * componentCount);
+        file.push_back((uint8_t)componentCount);
+        for (int c = 0; c < componentCount; c++)
+        {
+            file.push_back((uint8_t)(c + 1));
+            file.push_back((uint8_t)(c == 0 ? 0x00 : 0x11));
+        }
+        file.push_back(0);
+        file.push_back(63);
+        file.push_back(0);
+
+        // Entropy coded data, a zero byte after every 0xFF.
+        uint32_t bitBuffer = 0;
+        int bitCount = 0;
+        auto putBits = [&](uint32_t bits, int length)
+        {
+            bitBuffer = (bitBuffer << length) | (bits & ((1u << length) - 1));
+            bitCount += length;
+            while (bitCount >= 8)
+            {
+                uint8_t byte = (uint8_t)(bitBuffer >> (bitCount - 8));
+                file.push_back(byte);
+                if (byte == 0xFF)
+                {
+                    file.push_back(0);
+                }
+                bitCount -= 8;
+            }
+        };
+        auto flushBits = [&]()
+        {
+            if (bitCount > 0)
+            {
+                putBits(0x7F, 8 - bitCount);
+            }
+        };
+        auto magnitude = [](int value, int& bits)
+        {
+            int size = 0;
+            for (int absolute = std::abs(value); absolute > 0; absolute >>= 1)
+            {
+                size++;
+            }
+            bits = value < 0 ? value + (1 << size) - 1 : value;
+            return size;
+        };
+
+        int predictors[3] = {};
+        auto encodeBlock = [&](int c, int blockX, int blockY, int factor)
+        {
+            // Samples of the block, averaged over factor x factor pixels for subsampled chroma, edges repeated.
+            float samples[64];
+            for (int y = 0; y < 8; y++)
+            {
+                for (int x = 0; x < 8; x++)
+                {
+                    float sum = 0.0f;
+                    for (int dy = 0; dy < factor; dy++)
+                    {
+                        for (int dx = 0; dx < factor; dx++)
+                        {
+                            int px = std::min((blockX * 8 + x) * factor + dx, width - 1);
+                            int py = std::min((blockY * 8 + y) * factor + dy, height - 1);
+                            sum += planes[c][(size_t)py * width + px];
+                        }
+                    }
+                    samples[y * 8 + x] = sum / (float)(factor * factor);
+                }
+            }
+
+            int coefficients[64];
+            for (int v = 0; v < 8; v++)
+            {
+                for (int u = 0; u < 8; u++)
+                {
+                    float sum = 0.0f;
+                    for (int y = 0; y < 8; y++)
+                    {
+                        for (int x = 0; x < 8; x++)
+                        {
+                            sum += samples[y * 8 + x] * cosines[x][u] * cosines[y][v];
+                        }
+                    }
+                    int table = c == 0 ? 0 : 1;
+                    coefficients[v * 8 + u] = (int)std::lround(sum / quant[table][v * 8 + u]);
+                }
+            }
+
+            const HuffmanCodes& dc = dcCodes[c == 0 ? 0 : 1];
+            const HuffmanCodes& ac = acCodes[c == 0 ? 0 : 1];
+            int bits;
+            int size = magnitude(coefficients[0] - predictors[c], bits);
+            predictors[c] = coefficients[0];
+            putBits(dc.code[size], dc.length[size]);
+            putBits(bits, size);
+
+            int run = 0;
+            for (int k = 1; k < 64; k++)
+            {
+                int value = coefficients[ZIGZAG[k]];
+                if (value == 0)
+                {
+                    run++;
+                    continue;
+                }
+                while (run > 15)
+                {
+                    putBits(ac.code[0xF0], ac.length[0xF0]);
+                    run -= 16;
+                }
+                size = magnitude(value, bits);
+                putBits(ac.code[(run << 4) | size], ac.length[(run << 4) | size]);
+                putBits(bits, size);
+                run = 0;
+            }
+            if (run > 0)
+            {
+                putBits(ac.code[0], ac.length[0]);
+            }
+        };
+
+        int mcuSize = 8 * lumaFactor;
+        int mcusWide = (width + mcuSize - 1) / mcuSize;
+        int mcusHigh = (height + mcuSize - 1) / mcuSize;
+        int mcuIndex = 0, restartIndex = 0;
+        for (int mcuY = 0; mcuY < mcusHigh; mcuY++)
+        {
+            for (int mcuX = 0; mcuX < mcusWide; mcuX++, mcuIndex++)
+            {
+                if (restartInterval > 0 && mcuIndex > 0 && mcuIndex % restartInterval == 0)
+                {
+                    flushBits();
+                    putMarker((uint8_t)(0xD0 + (restartIndex++ & 7)), 0);
+                    predictors[0] = predictors[1] = predictors[2] = 0;
+                }
+                for (int y = 0; y < lumaFactor; y++)
+                {
+                    for (int x = 0; x < lumaFactor; x++)
+                    {
+                        encodeBlock(0, mcuX * lumaFactor + x, mcuY * lumaFactor + y, 1);
+                    }
+                }
+                for (int c = 1; c < componentCount; c++)
+                {
+                    encodeBlock(c, mcuX, mcuY, lumaFactor);
+                }
+            }
+        }
+        flushBits();
+        putMarker(0xD9, 0);
+
+        std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+        stream.write((const char*)file.data(), (std::streamsize)file.size());
+        return (bool)stream;
+    }
+}
+
+AssetPipelineBenchmark::AssetPipelineBenchmark()
+{
+}
+
+AssetPipelineBenchmark::~AssetPipelineBenchmark()
+{
+}
+
+bool AssetPipelineBenchmark::RunAll()
+{
+    bool allPassed = true;
+
+    m_Results.clear();
+
+    LOG("=== Asset Pipeline Benchmark ===");
+
+    // Roughly the size of X Bot.fbx after triangulation (~50k triangles).
+    m_Results.push_back(RunWeldBenchmark(256, 96));
+    m_Results.push_back(RunMeshOptimizerBenchmark(256, 96));
+    m_Results.push_back(RunMeshBuilderBenchmark(256, 4, 24, 8));
+    m_Results.push_back(RunMeshSimplifierBenchmark(256, 96));
+    m_Results.push_back(RunVertexCompressionBenchmark(256, 96));
+    m_Results.push_back(RunTangentGenerationBenchmark(1024, 512));
+    m_Results.push_back(RunBoundsBenchmark(256, 96));
+    m_Results.push_back(RunMeshletBenchmark(256, 96));
+    m_Results.push_back(RunCookedMeshBenchmark(256, 96));
+    m_Results.push_back(RunTextModelParseBenchmark(250000));
+    m_Results.push_back(RunAsyncLoadBenchmark(6, 192, 64));
+    m_Results.push_back(RunTextureIndexBenchmark(400, 64));
+    m_Results.push_back(RunSkinningBenchmark(64, 48, 128, 64));
+    m_Results.push_back(RunClipCompressionBenchmark(500, 64, 4.0f));
+    m_Results.push_back(RunTargaDecodeBenchmark(2048, 2048));
+    m_Results.push_back(RunTextureCookBenchmark(1024, 1024));
+    m_Results.push_back(RunMipGenerationBenchmark(2048, 2048));
+    m_Results.push_back(RunTextureStreamingBenchmark(16, 400, 600));
+    m_Results.push_back(RunTextureContainerBenchmark(512, 2));
+    m_Results.push_back(RunAtlasPackBenchmark(300));
+    m_Results.push_back(RunImageDecodeBenchmark(4, 1024));
+    m_Results.push_back(RunFrustumCullBenchmark(100000));
+    m_Results.push_back(RunWorldBoundsBenchmark(100000, 1000));
+    m_Results.push_back(RunParallelCullBenchmark(100000));
+
+    for (const AssetBenchmarkResult& result : m_Results)
+    {
+        LogResult(result);
+        allPassed &= result.passed;
+    }
+
+    LOG("=== Asset Pipeline Benchmark " + std::string(allPassed ? "PASSED" : "FAILED") + " ===");
+    return allPassed;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunWeldBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Vertex welding (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    MeshWelder::Settings settings;
+
+    // Build a polygon-vertex soup the same way the FBX importer does, with
+    // jitter below the weld epsilon so the tolerance path is exercised.
+    std::vector<MeshTypes::MeshVertex> soup;
+    GenerateTorusSoup(segmentsU, segmentsV, settings.positionEpsilon * 0.25f, soup);
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    MeshWelder::Stats stats;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool welded = MeshWelder::Weld(soup.data(), soup.size(), nullptr, 0, settings, vertices, indices, nullptr, &stats);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // The UV seam duplicates one row and one column of the parametric grid.
+    size_t expectedVertices = (size_t)(segmentsU + 1) * (size_t)(segmentsV + 1);
+
+    bool indicesValid = welded && indices.size() == soup.size();
+    for (size_t i = 0; indicesValid && i < indices.size(); i++)
+    {
+        const MeshTypes::MeshVertex& original = soup[i];
+        const MeshTypes::MeshVertex& weldedVertex = vertices[indices[i]];
+        indicesValid = std::fabs(original.x - weldedVertex.x) <= settings.positionEpsilon &&
+            std::fabs(original.y - weldedVertex.y) <= settings.positionEpsilon &&
+            std::fabs(original.z - weldedVertex.z) <= settings.positionEpsilon &&
+            std::fabs(original.tu - weldedVertex.tu) <= settings.uvEpsilon &&
+            std::fabs(original.tv - weldedVertex.tv) <= settings.uvEpsilon;
+    }
+
+    result.passed = indicesValid && vertices.size() == expectedVertices;
+    result.details = MeshWelder::FormatStats(stats) + ", expected " + std::to_string(expectedVertices) + " vertices" +
+        ", " + std::to_string((double)soup.size() / (result.timeMs * 1000.0)) + " M input vertices/s";
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunMeshOptimizerBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Mesh optimization (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, vertices, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // Worst case input order, as produced by exporters that do not care about the cache.
+    ShuffleTriangles(indices, 12345u);
+
+    // Every triangle as its corner attributes, rotated so the smallest corner
+    // comes first (keeps winding), so the triangle set can be compared after
+    // the indices and vertex order have both changed.
+    typedef std::array<float, 15> TriangleKey;
+    auto collectTriangles = [](const std::vector<MeshTypes::MeshVertex>& vertexData, const std::vector<MeshTypes::IndexType>& indexData)
+    {
+        std::vector<TriangleKey> triangles(indexData.size() / 3);
+        for (size_t t = 0; t < triangles.size(); t++)
+        {
+            std::array<std::array<float, 5>, 3> corners;
+            for (int k = 0; k < 3; k++)
+            {
+                const MeshTypes::MeshVertex& v = vertexData[indexData[t * 3 + k]];
+                corners[k] = { v.x, v.y, v.z, v.tu, v.tv };
+            }
+            int first = (int)(std::min_element(corners.begin(), corners.end()) - corners.begin());
+            for (int k = 0; k < 3; k++)
+            {
+                std::copy(corners[(first + k) % 3].begin(), corners[(first + k) % 3].end(), triangles[t].begin() + k * 5);
+            }
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+
+    std::vector<TriangleKey> trianglesBefore = collectTriangles(vertices, indices);
+
+    MeshOptimizer::Settings settings;
+    MeshOptimizer::Stats stats;
+    size_t vertexCount = vertices.size();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool optimized = MeshOptimizer::Optimize(vertices.data(), vertexCount, indices.data(), indices.size(), settings, &stats);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    vertices.resize(vertexCount);
+
+    // The vertex buffer must be in order of first use after the fetch pass.
+    bool fetchOrdered = true;
+    MeshTypes::IndexType nextVertex = 0;
+    for (size_t i = 0; i < indices.size() && fetchOrdered; i++)
+    {
+        if (indices[i] == nextVertex)
+        {
+            nextVertex++;
+        }
+        fetchOrdered = indices[i] < nextVertex;
+    }
+
+    bool trianglesPreserved = optimized && collectTriangles(vertices, indices) == trianglesBefore;
+
+    result.passed = trianglesPreserved && fetchOrdered && stats.after.acmr < stats.before.acmr;
+    result.details = MeshOptimizer::FormatStats(stats) +
+        (trianglesPreserved ? "" : ", triangle set changed") + (fetchOrdered ? "" : ", vertex order does not follow first use");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunMeshBuilderBenchmark(int nodeCount, int materialCount, int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Multi-mesh assembly (" + std::to_string(nodeCount) + " nodes, " + std::to_string(materialCount) + " materials)";
+
+    // One small soup per scene node, assigned to the materials round robin.
+    std::vector<MeshTypes::MeshVertex> nodeSoup;
+    GenerateTorusSoup(segmentsU, segmentsV, 0.0f, nodeSoup);
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    std::vector<MeshTypes::Submesh> submeshes;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    MeshBuilder builder;
+    builder.Reserve(nodeSoup.size() * (size_t)nodeCount);
+    for (int node = 0; node < nodeCount; node++)
+    {
+        unsigned int material = (unsigned int)(node % materialCount);
+        for (size_t v = 0; v + 2 < nodeSoup.size(); v += 3)
+        {
+            MeshTypes::IndexType triangle[3];
+            for (int k = 0; k < 3; k++)
+            {
+                MeshTypes::MeshVertex vertex = nodeSoup[v + k];
+                vertex.x += (float)node * 3.0f;
+                vertex.bz = (float)material;  // Tag the material so ranges can be checked after reordering
+                triangle[k] = builder.AddVertex(vertex);
+            }
+            builder.AddTriangle(material, triangle[0], triangle[1], triangle[2]);
+        }
+    }
+    builder.Build(vertices, indices, submeshes);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Submesh ranges must be contiguous, cover every index and only reference their own material.
+    auto rangesValid = [&](const std::vector<MeshTypes::MeshVertex>& vertexData, const std::vector<MeshTypes::IndexType>& indexData)
+    {
+        uint32_t nextIndex = 0;
+        for (size_t s = 0; s < submeshes.size(); s++)
+        {
+            const MeshTypes::Submesh& submesh = submeshes[s];
+            if (submesh.indexOffset != nextIndex)
+            {
+                return false;
+            }
+            for (uint32_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i++)
+            {
+                const MeshTypes::MeshVertex& vertex = vertexData[indexData[i]];
+                if (vertex.bz != (float)submesh.materialIndex ||
+                    indexData[i] < submesh.vertexOffset || indexData[i] >= submesh.vertexOffset + submesh.vertexCount ||
+                    vertex.x < submesh.boundsMin[0] || vertex.x > submesh.boundsMax[0])
+                {
+                    return false;
+                }
+            }
+            nextIndex += submesh.indexCount;
+        }
+        return nextIndex == indexData.size();
+    };
+
+    bool built = submeshes.size() == (size_t)std::min(nodeCount, materialCount) &&
+        vertices.size() == nodeSoup.size() * (size_t)nodeCount && rangesValid(vertices, indices);
+
+    // The optimizer may only reorder triangles within each submesh.
+    MeshOptimizer::Settings settings;
+    MeshOptimizer::Stats stats;
+    size_t vertexCount = vertices.size();
+    bool optimized = MeshOptimizer::Optimize(vertices.data(), vertexCount, indices.data(), indices.size(), settings, &stats, submeshes.data(), submeshes.size());
+    vertices.resize(vertexCount);
+    MeshBuilder::UpdateSubmeshBounds(vertices.data(), indices.data(), submeshes.data(), submeshes.size());
+    bool rangesKept = optimized && rangesValid(vertices, indices);
+
+    result.passed = built && rangesKept;
+    result.details = std::to_string(vertices.size()) + " vertices, " + std::to_string(indices.size() / 3) + " triangles in " +
+        std::to_string(submeshes.size()) + " submeshes" + (built ? "" : ", invalid submesh table") +
+        (rangesKept ? "" : ", optimizer moved triangles across submeshes");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunMeshSimplifierBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "LOD generation (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, vertices, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // Two submeshes, so the seam between them is an open border in each.
+    std::vector<MeshTypes::Submesh> submeshes(2);
+    submeshes[0].indexCount = (uint32_t)(indices.size() / 6) * 3;
+    submeshes[1].indexOffset = submeshes[0].indexCount;
+    submeshes[1].indexCount = (uint32_t)indices.size() - submeshes[0].indexCount;
+    submeshes[1].materialIndex = 1;
+    MeshBuilder::UpdateSubmeshBounds(vertices.data(), indices.data(), submeshes.data(), submeshes.size());
+
+    // Positions on the seam, taken from the edges of submesh 0 without a twin.
+    auto borderPositions = [&](const MeshTypes::Submesh& submesh)
+    {
+        std::vector<std::array<float, 3>> edges;
+        for (uint32_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                const MeshTypes::MeshVertex& a = vertices[indices[i + k]];
+                const MeshTypes::MeshVertex& b = vertices[indices[i + (k + 1) % 3]];
+                edges.push_back({ a.x, a.y, a.z });
+                edges.push_back({ b.x, b.y, b.z });
+            }
+        }
+
+        std::vector<std::array<float, 3>> border;
+        std::vector<std::pair<std::array<float, 3>, std::array<float, 3>>> directed;
+        for (size_t e = 0; e < edges.size(); e += 2)
+        {
+            directed.push_back({ edges[e], edges[e + 1] });
+        }
+        std::sort(directed.begin(), directed.end());
+        for (const auto& edge : directed)
+        {
+            if (!std::binary_search(directed.begin(), directed.end(), std::make_pair(edge.second, edge.first)))
+            {
+                border.push_back(edge.first);
+                border.push_back(edge.second);
+            }
+        }
+        std::sort(border.begin(), border.end());
+        border.erase(std::unique(border.begin(), border.end()), border.end());
+        return border;
+    };
+
+    std::vector<std::array<float, 3>> borderBefore = borderPositions(submeshes[0]);
+
+    MeshSimplifier::Settings settings;
+    MeshSimplifier::Stats stats;
+    std::vector<MeshTypes::LodLevel> lods;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool generated = MeshSimplifier::GenerateLods(vertices.data(), vertices.size(), indices, submeshes, lods, settings, &stats);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Every level must be clearly smaller, no more accurate than the last and reference valid ranges.
+    bool chainValid = generated && lods.size() >= 3;
+    for (size_t l = 0; l < lods.size() && chainValid; l++)
+    {
+        const MeshTypes::LodLevel& lod = lods[l];
+        chainValid = lod.indexCount % 3 == 0 && lod.submeshCount == 2 &&
+            (size_t)lod.indexOffset + lod.indexCount <= indices.size() && (size_t)lod.submeshOffset + lod.submeshCount <= submeshes.size();
+        if (chainValid && l > 0)
+        {
+            chainValid = (float)lod.indexCount <= (float)lods[l - 1].indexCount * 0.9f && lod.error >= lods[l - 1].error;
+        }
+
+        uint32_t nextIndex = lod.indexOffset;
+        for (uint32_t s = lod.submeshOffset; s < lod.submeshOffset + lod.submeshCount && chainValid; s++)
+        {
+            chainValid = submeshes[s].indexOffset == nextIndex;
+            nextIndex += submeshes[s].indexCount;
+        }
+        chainValid = chainValid && nextIndex == lod.indexOffset + lod.indexCount;
+    }
+
+    bool indicesValid = std::all_of(indices.begin(), indices.end(), [&](MeshTypes::IndexType index) { return index < vertices.size(); });
+
+    // The seam between the submeshes must survive every level unchanged.
+    bool borderLocked = chainValid;
+    for (size_t l = 1; l < lods.size() && borderLocked; l++)
+    {
+        borderLocked = borderPositions(submeshes[lods[l].submeshOffset]) == borderBefore;
+    }
+
+    result.passed = chainValid && indicesValid && borderLocked;
+    result.details = MeshSimplifier::FormatStats(stats) + (chainValid ? "" : ", invalid LOD chain") +
+        (indicesValid ? "" : ", index out of range") + (borderLocked ? "" : ", submesh border moved");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunVertexCompressionBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Vertex compression (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, vertices, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // Mirrored UVs on half the mesh, the handedness has to survive the encoding.
+    for (size_t i = 0; i < vertices.size(); i += 2)
+    {
+        vertices[i].bx = -vertices[i].bx;
+        vertices[i].by = -vertices[i].by;
+        vertices[i].bz = -vertices[i].bz;
+    }
+
+    std::vector<MeshTypes::CompactVertex> compact;
+    MeshTypes::VertexQuantization quantization;
+    VertexCompressor::Stats stats;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool compressed = VertexCompressor::Compress(vertices.data(), vertices.size(), compact, quantization, &stats);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Half a quantization step per axis, half a half-float ulp at 1.0, and what 8 bit quaternions resolve.
+    float extent = std::max(quantization.positionScale[0], std::max(quantization.positionScale[1], quantization.positionScale[2]));
+    bool withinBounds = compressed && sizeof(MeshTypes::CompactVertex) == 20 &&
+        stats.maxPositionError <= extent / 65535.0f &&
+        stats.maxUVError <= 1.0f / 2048.0f &&
+        stats.maxNormalError < 0.01f &&
+        stats.maxTangentError < 2.0f &&
+        stats.handednessErrors == 0;
+
+    // Half floats round trip exactly and round to nearest.
+    bool halfExact = VertexCompressor::HalfToFloat(VertexCompressor::FloatToHalf(0.5f)) == 0.5f &&
+        VertexCompressor::HalfToFloat(VertexCompressor::FloatToHalf(-2.0f)) == -2.0f &&
+        VertexCompressor::HalfToFloat(VertexCompressor::FloatToHalf(1.0e-6f)) > 0.0f &&
+        VertexCompressor::FloatToHalf(1.0f + 1.0f / 4096.0f) == VertexCompressor::FloatToHalf(1.0f) &&
+        VertexCompressor::HalfToFloat(VertexCompressor::FloatToHalf(100000.0f)) == 65504.0f;
+
+    result.passed = withinBounds && halfExact;
+    result.details = VertexCompressor::FormatStats(stats) + (withinBounds ? "" : ", error above the format's resolution") +
+        (halfExact ? "" : ", half float conversion wrong");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTangentGenerationBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Tangent generation (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    std::vector<MeshTypes::MeshVertex> soup;
+    std::vector<MeshTypes::MeshVertex> reference;
+    std::vector<MeshTypes::IndexType> indices;
+    GenerateTorusSoup(segmentsU, segmentsV, 0.0f, soup);
+    if (!MeshWelder::Weld(soup.data(), soup.size(), nullptr, 0, MeshWelder::Settings(), reference, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // Baseline: the old per-face code on the unindexed mesh it required.
+    auto start = std::chrono::high_resolution_clock::now();
+    CalculateFlatTangents(soup.data(), soup.size());
+    auto end = std::chrono::high_resolution_clock::now();
+    double flatMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    TangentGenerator::Settings settings;
+    TangentGenerator::Stats stats;
+    TangentGenerator::Stats singleThreadStats;
+
+    std::vector<MeshTypes::MeshVertex> singleThreaded = reference;
+    settings.multithreaded = false;
+    bool generated = TangentGenerator::Generate(singleThreaded.data(), singleThreaded.size(), indices.data(), indices.size(), settings, &singleThreadStats);
+
+    std::vector<MeshTypes::MeshVertex> vertices = reference;
+    settings.multithreaded = true;
+    start = std::chrono::high_resolution_clock::now();
+    generated &= TangentGenerator::Generate(vertices.data(), vertices.size(), indices.data(), indices.size(), settings, &stats);
+    end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Against the analytic frame of the torus, which GenerateTorusSoup filled in.
+    auto maxAngle = [](const std::vector<MeshTypes::MeshVertex>& generated, const std::vector<MeshTypes::MeshVertex>& expected, float tangentSign)
+    {
+        float worst = 0.0f;
+        for (size_t i = 0; i < generated.size(); i++)
+        {
+            const MeshTypes::MeshVertex& a = generated[i];
+            const MeshTypes::MeshVertex& b = expected[i];
+            float tangentDot = (a.tx * b.tx + a.ty * b.ty + a.tz * b.tz) * tangentSign;
+            float bitangentDot = a.bx * b.bx + a.by * b.by + a.bz * b.bz;
+            float orthogonal = std::fabs(a.tx * a.nx + a.ty * a.ny + a.tz * a.nz) + std::fabs(a.tx * a.bx + a.ty * a.by + a.tz * a.bz);
+            if (!(tangentDot == tangentDot) || !(bitangentDot == bitangentDot) || orthogonal > 1.0e-4f)
+            {
+                return 180.0f;
+            }
+            worst = std::max(worst, std::acos(std::min(1.0f, std::min(tangentDot, bitangentDot))) * 57.2957795f);
+        }
+        return worst;
+    };
+
+    float maxError = maxAngle(vertices, reference, 1.0f);
+    bool deterministic = std::memcmp(vertices.data(), singleThreaded.data(), vertices.size() * sizeof(MeshTypes::MeshVertex)) == 0;
+
+    // Mirrored U: the tangent flips, the bitangent keeps its side through the handedness.
+    std::vector<MeshTypes::MeshVertex> mirrored = reference;
+    for (MeshTypes::MeshVertex& vertex : mirrored)
+    {
+        vertex.tu = 1.0f - vertex.tu;
+    }
+    generated &= TangentGenerator::Generate(mirrored.data(), mirrored.size(), indices.data(), indices.size(), settings);
+    float mirroredError = maxAngle(mirrored, reference, -1.0f);
+
+    // Collapsed UVs on the top of a small torus must not produce NaNs, and
+    // vertices no triangle uses still get a valid frame.
+    std::vector<MeshTypes::MeshVertex> collapsed;
+    std::vector<MeshTypes::IndexType> collapsedIndices;
+    generated &= GenerateIndexedTorus(32, 16, collapsed, collapsedIndices);
+    for (MeshTypes::MeshVertex& vertex : collapsed)
+    {
+        if (vertex.y > 0.2f)
+        {
+            vertex.tu = 0.0f;
+            vertex.tv = 0.0f;
+        }
+    }
+    collapsed.push_back(reference[0]);
+    TangentGenerator::Stats degenerateStats;
+    generated &= TangentGenerator::Generate(collapsed.data(), collapsed.size(), collapsedIndices.data(), collapsedIndices.size(), settings, &degenerateStats);
+    bool finite = degenerateStats.degenerateTriangles > 0 && degenerateStats.fallbackVertices > 0;
+    for (const MeshTypes::MeshVertex& vertex : collapsed)
+    {
+        float length = vertex.tx * vertex.tx + vertex.ty * vertex.ty + vertex.tz * vertex.tz;
+        finite &= std::fabs(length - 1.0f) < 1.0e-4f && vertex.bx == vertex.bx && vertex.by == vertex.by && vertex.bz == vertex.bz;
+    }
+
+    bool accurate = maxError < 1.0f && mirroredError < 1.0f;
+    result.passed = generated && accurate && deterministic && finite;
+
+    result.details = TangentGenerator::FormatStats(stats) + ", flat per-face " + std::to_string(flatMs) + " ms (" +
+        std::to_string(soup.size()) + " vertices), single thread " + std::to_string(singleThreadStats.generateTimeMs) +
+        " ms, max frame error " + std::to_string(maxError) + " deg (mirrored " + std::to_string(mirroredError) + " deg)" + (accurate ? "" : ", frames off the analytic torus") +
+        (deterministic ? "" : ", threaded result differs") + (finite ? "" : ", degenerate UVs not handled");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunBoundsBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Bounding volumes (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    std::vector<MeshTypes::MeshVertex> torus;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, torus, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // A long hull turned away from the axes: the AABB gets loose, the oriented box should not.
+    // Its own box is 2 * 4.05 by 2 * 0.175 by 2 * 1.35.
+    std::vector<MeshTypes::MeshVertex> hull = torus;
+    const float yaw = 0.5f, roll = 0.35f;
+    for (MeshTypes::MeshVertex& vertex : hull)
+    {
+        float x = vertex.x * 3.0f, y = vertex.y * 0.5f, z = vertex.z;
+        float x1 = x * std::cos(yaw) + z * std::sin(yaw);
+        float z1 = -x * std::sin(yaw) + z * std::cos(yaw);
+        vertex.x = x1 * std::cos(roll) - y * std::sin(roll) + 10.0f;
+        vertex.y = x1 * std::sin(roll) + y * std::cos(roll) - 4.0f;
+        vertex.z = z1 + 2.0f;
+    }
+    const float hullVolume = (2.0f * 4.05f) * (2.0f * 0.175f) * (2.0f * 1.35f);
+
+    // A cone, where the sphere around the AABB center is far from minimal (1.414 vs 1.25).
+    std::vector<MeshTypes::MeshVertex> cone(segmentsU * 4 + 1);
+    for (int i = 0; i < segmentsU * 4; i++)
+    {
+        float angle = 6.28318530718f * (float)i / (float)(segmentsU * 4);
+        cone[i] = {};
+        cone[i].x = std::cos(angle);
+        cone[i].z = std::sin(angle);
+    }
+    cone.back() = {};
+    cone.back().y = 2.0f;
+
+    BoundsCalculator::Settings settings;
+    BoundsCalculator::Stats torusStats, hullStats, coneStats;
+    MeshTypes::MeshBounds torusBounds, hullBounds, coneBounds;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool computed = BoundsCalculator::Compute(torus.data(), torus.size(), torusBounds, settings, &torusStats);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    computed &= BoundsCalculator::Compute(hull.data(), hull.size(), hullBounds, settings, &hullStats);
+    computed &= BoundsCalculator::Compute(cone.data(), cone.size(), coneBounds, settings, &coneStats);
+
+    // Every vertex must be inside every volume.
+    auto containsAll = [](const std::vector<MeshTypes::MeshVertex>& vertices, const MeshTypes::MeshBounds& bounds)
+    {
+        return std::all_of(vertices.begin(), vertices.end(), [&](const MeshTypes::MeshVertex& vertex)
+        {
+            return BoundsCalculator::Contains(bounds, vertex.x, vertex.y, vertex.z, 1.0e-4f);
+        });
+    };
+    bool contained = computed && containsAll(torus, torusBounds) && containsAll(hull, hullBounds) && containsAll(cone, coneBounds);
+
+    // Never looser than before, and close to the known optimum where there is one.
+    bool tight = computed &&
+        torusStats.sphereRadius <= torusStats.aabbCenterRadius * 1.0001f && torusStats.boxVolume <= torusStats.aabbVolume &&
+        hullStats.boxVolume <= hullVolume * 1.1f && hullStats.sphereRadius <= 4.05f * 1.02f &&
+        coneStats.sphereRadius <= 1.25f * 1.02f;
+
+    result.passed = contained && tight;
+    result.details = BoundsCalculator::FormatStats(torusStats) + "\n    Rotated hull: " + BoundsCalculator::FormatStats(hullStats) +
+        "\n    Cone: " + BoundsCalculator::FormatStats(coneStats) + (contained ? "" : ", vertex outside the bounds") + (tight ? "" : ", bounds too loose");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunMeshletBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Meshlet build and culling (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, vertices, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // Same input as an FBX import: cache optimized, two materials.
+    std::vector<MeshTypes::Submesh> submeshes(2);
+    submeshes[0].indexCount = (uint32_t)(indices.size() / 6) * 3;
+    submeshes[1].indexOffset = submeshes[0].indexCount;
+    submeshes[1].indexCount = (uint32_t)indices.size() - submeshes[0].indexCount;
+    submeshes[1].materialIndex = 1;
+
+    size_t vertexCount = vertices.size();
+    MeshOptimizer::Optimize(vertices.data(), vertexCount, indices.data(), indices.size(), MeshOptimizer::Settings(), nullptr, submeshes.data(), submeshes.size());
+    vertices.resize(vertexCount);
+
+    typedef std::array<MeshTypes::IndexType, 3> Triangle;
+    auto collectTriangles = [&](const MeshTypes::Submesh& submesh)
+    {
+        std::vector<Triangle> triangles(submesh.indexCount / 3);
+        std::memcpy(triangles.data(), indices.data() + submesh.indexOffset, triangles.size() * sizeof(Triangle));
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+    std::vector<Triangle> trianglesBefore[2] = { collectTriangles(submeshes[0]), collectTriangles(submeshes[1]) };
+
+    MeshletBuilder::Settings settings;
+    MeshletBuilder::Stats stats;
+    std::vector<MeshTypes::Meshlet> meshlets;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool built = MeshletBuilder::Build(vertices.data(), vertices.size(), indices.data(), submeshes.data(), submeshes.size(), settings, meshlets, &stats);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Same triangles per submesh, and the meshlets tile every submesh in order.
+    bool valid = built && collectTriangles(submeshes[0]) == trianglesBefore[0] && collectTriangles(submeshes[1]) == trianglesBefore[1];
+    uint32_t expectedOffset = 0;
+    uint32_t expectedSubmesh = 0;
+    for (const MeshTypes::Meshlet& meshlet : meshlets)
+    {
+        if (expectedSubmesh < submeshes.size() && expectedOffset == submeshes[expectedSubmesh].indexOffset + submeshes[expectedSubmesh].indexCount)
+        {
+            expectedSubmesh++;
+        }
+        valid &= meshlet.indexOffset == expectedOffset && meshlet.submeshIndex == expectedSubmesh &&
+            meshlet.triangleCount <= settings.maxTriangles && meshlet.vertexCount <= settings.maxVertices;
+        expectedOffset += meshlet.triangleCount * 3;
+
+        // Every corner inside the sphere
+        for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.triangleCount * 3; i++)
+        {
+            const MeshTypes::MeshVertex& vertex = vertices[indices[i]];
+            float dx = vertex.x - meshlet.center[0], dy = vertex.y - meshlet.center[1], dz = vertex.z - meshlet.center[2];
+            valid &= std::sqrt(dx * dx + dy * dy + dz * dz) <= meshlet.radius + 1.0e-5f;
+        }
+    }
+    valid &= expectedOffset == (uint32_t)indices.size();
+
+    // Cone culled meshlets must not contain a single triangle facing the camera.
+    auto coneCullIsConservative = [&](const float eye[3])
+    {
+        for (const MeshTypes::Meshlet& meshlet : meshlets)
+        {
+            float toApex[3] = { meshlet.coneApex[0] - eye[0], meshlet.coneApex[1] - eye[1], meshlet.coneApex[2] - eye[2] };
+            float length = std::sqrt(toApex[0] * toApex[0] + toApex[1] * toApex[1] + toApex[2] * toApex[2]);
+            if (meshlet.coneCutoff >= 1.0f || toApex[0] * meshlet.coneAxis[0] + toApex[1] * meshlet.coneAxis[1] + toApex[2] * meshlet.coneAxis[2] < meshlet.coneCutoff * length)
+            {
+                continue;
+            }
+            for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.triangleCount * 3; i += 3)
+            {
+                const MeshTypes::MeshVertex& a = vertices[indices[i]];
+                const MeshTypes::MeshVertex& b = vertices[indices[i + 1]];
+                const MeshTypes::MeshVertex& c = vertices[indices[i + 2]];
+                float e1[3] = { b.x - a.x, b.y - a.y, b.z - a.z }, e2[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+                float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                if (n[0] * (a.nx + b.nx + c.nx) + n[1] * (a.ny + b.ny + c.ny) + n[2] * (a.nz + b.nz + c.nz) < 0.0f)
+                {
+                    n[0] = -n[0]; n[1] = -n[1]; n[2] = -n[2];
+                }
+                if (n[0] * (eye[0] - a.x) + n[1] * (eye[1] - a.y) + n[2] * (eye[2] - a.z) > 1.0e-6f)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    // An overview with the whole torus in view and a close-up of one side.
+    const float target[3] = { 0.0f, 0.0f, 0.0f };
+    const float overviewEye[3] = { 0.0f, 2.5f, -4.0f };
+    const float closeEye[3] = { 0.0f, 0.3f, -1.9f };
+    const float closeTarget[3] = { 0.0f, 0.0f, -1.0f };
+
+    float planes[6][4];
+    std::vector<MeshletBuilder::DrawRange> ranges;
+    MeshletBuilder::CullStats overview, closeUp;
+
+    MakeFrustumPlanes(overviewEye, target, 0.6f, 100.0f, planes);
+    MeshletBuilder::Cull(meshlets.data(), meshlets.size(), planes, overviewEye, ranges, &overview);
+    size_t overviewRanges = ranges.size();
+
+    ranges.clear();
+    MakeFrustumPlanes(closeEye, closeTarget, 0.5f, 100.0f, planes);
+    MeshletBuilder::Cull(meshlets.data(), meshlets.size(), planes, closeEye, ranges, &closeUp);
+
+    bool conservative = coneCullIsConservative(overviewEye) && coneCullIsConservative(closeEye);
+    bool effective = overview.coneCulled > 0 && closeUp.frustumCulled > 0;
+
+    result.passed = valid && conservative && effective;
+    result.details = MeshletBuilder::FormatStats(stats) + "\n    Overview: " + MeshletBuilder::FormatStats(overview) + ", " + std::to_string(overviewRanges) + " draw ranges" +
+        "\n    Close-up: " + MeshletBuilder::FormatStats(closeUp) +
+        (valid ? "" : ", invalid meshlets") + (conservative ? "" : ", front facing triangles culled") + (effective ? "" : ", nothing culled");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunCookedMeshBenchmark(int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Cooked mesh load (" + std::to_string(segmentsU * segmentsV * 2) + " triangles)";
+
+    CookedMesh::MeshData mesh;
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, vertices, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    mesh.vertices = vertices.data();
+    mesh.vertexCount = vertices.size();
+    mesh.indices = indices.data();
+    mesh.indexCount = indices.size();
+    BoundsCalculator::Compute(vertices.data(), vertices.size(), mesh.bounds, BoundsCalculator::Settings());
+
+    // Two draw ranges with a material each.
+    MeshTypes::Submesh submeshes[2] = {};
+    submeshes[0].indexCount = (uint32_t)(indices.size() / 6) * 3;
+    submeshes[1].indexOffset = submeshes[0].indexCount;
+    submeshes[1].indexCount = (uint32_t)indices.size() - submeshes[0].indexCount;
+    submeshes[1].materialIndex = 1;
+    MeshBuilder::UpdateSubmeshBounds(vertices.data(), indices.data(), submeshes, 2);
+    mesh.submeshes = submeshes;
+    mesh.submeshCount = 2;
+
+    mesh.hasMaterial = true;
+    mesh.materials.resize(2);
+    mesh.materials[0].texturePaths[CookedMesh::TEXTURE_DIFFUSE] = "../Engine/assets/textures/benchmark_diffuse.png";
+    mesh.materials[1].texturePaths[CookedMesh::TEXTURE_NORMAL] = "../Engine/assets/textures/benchmark_normal.png";
+    mesh.materials[1].metallic = 1.0f;
+
+    CookedMesh::SourceInfo source;
+    source.size = 1234;
+    source.timestamp = 5678;
+
+    std::error_code error;
+    std::string filename = (std::filesystem::temp_directory_path(error) / "asset_benchmark.mesh").string();
+    if (!CookedMesh::Write(filename, mesh, source))
+    {
+        result.details = "Failed to write " + filename;
+        return result;
+    }
+
+    // Best of several opens, the first one may include the page cache warming up.
+    CookedMesh cooked;
+    const int iterations = 10;
+    double bestMs = 0.0;
+    bool opened = true;
+    for (int i = 0; i < iterations && opened; i++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        opened = cooked.Open(filename);
+        auto end = std::chrono::high_resolution_clock::now();
+        double timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+        bestMs = (i == 0) ? timeMs : std::min(bestMs, timeMs);
+        if (opened && i + 1 < iterations)
+        {
+            cooked.Close();
+        }
+    }
+    result.timeMs = bestMs;
+
+    bool dataMatches = opened &&
+        cooked.GetVertexCount() == vertices.size() && cooked.GetIndexCount() == indices.size() &&
+        std::memcmp(cooked.GetVertices(), vertices.data(), vertices.size() * sizeof(MeshTypes::MeshVertex)) == 0 &&
+        std::memcmp(cooked.GetIndices(), indices.data(), indices.size() * sizeof(MeshTypes::IndexType)) == 0 &&
+        cooked.GetSubmeshCount() == 2 && std::memcmp(cooked.GetSubmeshes(), submeshes, sizeof(submeshes)) == 0 &&
+        std::memcmp(&cooked.GetBounds(), &mesh.bounds, sizeof(mesh.bounds)) == 0 &&
+        cooked.GetLodCount() == 1 && cooked.GetLods()[0].indexCount == indices.size() && cooked.GetLods()[0].submeshCount == 2 &&
+        cooked.HasMaterial() && cooked.GetMaterials().size() == 2 &&
+        cooked.GetMaterials()[0].texturePaths[CookedMesh::TEXTURE_DIFFUSE] == mesh.materials[0].texturePaths[CookedMesh::TEXTURE_DIFFUSE] &&
+        cooked.GetMaterials()[1].texturePaths[CookedMesh::TEXTURE_NORMAL] == mesh.materials[1].texturePaths[CookedMesh::TEXTURE_NORMAL] &&
+        cooked.GetMaterials()[1].metallic == 1.0f;
+
+    CookedMesh::SourceInfo changedSource = source;
+    changedSource.timestamp++;
+    bool staleDetected = opened && cooked.IsUpToDate(source) && !cooked.IsUpToDate(changedSource);
+    bool hashValid = opened && cooked.VerifyContentHash();
+    size_t fileSize = cooked.GetFileSize();
+
+    cooked.Close();
+    std::filesystem::remove(filename, error);
+
+    result.passed = dataMatches && staleDetected && hashValid && result.timeMs < 1.0;
+    result.details = std::to_string(fileSize / 1024) + " KB mapped" +
+        (dataMatches ? "" : ", data mismatch") + (staleDetected ? "" : ", stale source not detected") +
+        (hashValid ? "" : ", content hash mismatch") + (result.timeMs < 1.0 ? "" : ", load slower than 1 ms");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTextModelParseBenchmark(int vertexCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Text model parse (" + std::to_string(vertexCount) + " vertices)";
+
+    // Write a model in the legacy format, mixing the number styles seen in the assets.
+    std::error_code error;
+    std::string filename = (std::filesystem::temp_directory_path(error) / "asset_benchmark_model.txt").string();
+    FILE* file = std::fopen(filename.c_str(), "w");
+    if (!file)
+    {
+        result.details = "Failed to write " + filename;
+        return result;
+    }
+
+    std::fprintf(file, "Vertex Count: %d\n\nData:\n\n", vertexCount);
+    uint32_t seed = 7;
+    for (int i = 0; i < vertexCount; i++)
+    {
+        for (int k = 0; k < (int)TextModelParser::FLOATS_PER_VERTEX; k++)
+        {
+            seed = seed * 747796405u + 2891336453u;
+            float value = ((float)(seed >> 8) / 16777216.0f) * 2.0f - 1.0f;
+            std::fprintf(file, (k % 2 == 0) ? "%.9g" : "%f", value);
+            std::fputc(k + 1 == (int)TextModelParser::FLOATS_PER_VERTEX ? '\n' : ' ', file);
+        }
+    }
+    std::fclose(file);
+
+    // Reference values from the stream based loader this parser replaced.
+    std::vector<float> expected((size_t)vertexCount * TextModelParser::FLOATS_PER_VERTEX);
+    auto legacyStart = std::chrono::high_resolution_clock::now();
+    {
+        std::ifstream fin(filename);
+        char input;
+        int count;
+        fin.get(input);
+        while (input != ':')
+        {
+            fin.get(input);
+        }
+        fin >> count;
+        fin.get(input);
+        while (input != ':')
+        {
+            fin.get(input);
+        }
+        for (float& value : expected)
+        {
+            fin >> value;
+        }
+    }
+    auto legacyEnd = std::chrono::high_resolution_clock::now();
+    double legacyMs = std::chrono::duration<double, std::milli>(legacyEnd - legacyStart).count();
+
+    std::vector<float> parsed(expected.size());
+    TextModelParser parser;
+    TextModelParser::Stats stats;
+    bool parsedOk = parser.Open(filename) && parser.GetVertexCount() == (size_t)vertexCount &&
+        parser.Parse(parsed.data(), TextModelParser::FLOATS_PER_VERTEX, &stats);
+    parser.Close();
+    std::filesystem::remove(filename, error);
+
+    result.timeMs = stats.parseTimeMs;
+
+    bool identical = parsedOk && std::memcmp(parsed.data(), expected.data(), parsed.size() * sizeof(float)) == 0;
+    result.passed = identical;
+    result.details = TextModelParser::FormatStats(stats) + ", ifstream " + std::to_string(legacyMs) + " ms" +
+        (identical ? ", bit identical" : ", output differs from ifstream");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunAsyncLoadBenchmark(int modelCount, int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Async model loading (" + std::to_string(modelCount) + " models, " + std::to_string(segmentsU * segmentsV * 2) + " triangles each)";
+
+    // The worker stage of an FBX import: weld, optimize, tangents and bounds.
+    // Every model gets its own jitter so the results differ.
+    struct LoadedMesh
+    {
+        std::vector<MeshTypes::MeshVertex> vertices;
+        std::vector<MeshTypes::IndexType> indices;
+        MeshTypes::MeshBounds bounds = {};
+    };
+
+    auto loadModel = [this, segmentsU, segmentsV](int model, LoadedMesh& mesh)
+    {
+        MeshWelder::Settings weldSettings;
+        std::vector<MeshTypes::MeshVertex> soup;
+        GenerateTorusSoup(segmentsU, segmentsV, weldSettings.positionEpsilon * 0.05f * (float)(model + 1), soup);
+
+        bool loaded = MeshWelder::Weld(soup.data(), soup.size(), nullptr, 0, weldSettings, mesh.vertices, mesh.indices);
+        size_t vertexCount = mesh.vertices.size();
+        loaded = loaded && MeshOptimizer::Optimize(mesh.vertices.data(), vertexCount, mesh.indices.data(), mesh.indices.size(), MeshOptimizer::Settings());
+        mesh.vertices.resize(vertexCount);
+        loaded = loaded && TangentGenerator::Generate(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size(), TangentGenerator::Settings());
+        loaded = loaded && BoundsCalculator::Compute(mesh.vertices.data(), mesh.vertices.size(), mesh.bounds, BoundsCalculator::Settings());
+        return loaded;
+    };
+
+    // One after the other on this thread, as Application::Initialize used to.
+    std::vector<LoadedMesh> serial(modelCount);
+    bool serialLoaded = true;
+    auto serialStart = std::chrono::high_resolution_clock::now();
+    for (int model = 0; model < modelCount; model++)
+    {
+        serialLoaded &= loadModel(model, serial[model]);
+    }
+    auto serialEnd = std::chrono::high_resolution_clock::now();
+    double serialMs = std::chrono::duration<double, std::milli>(serialEnd - serialStart).count();
+
+    // All at once on the workers, the way ModelLoader submits them. This
+    // thread stays free and only polls, like a frame loop would.
+    std::vector<LoadedMesh> submitted(modelCount);
+    std::vector<std::future<bool>> loads;
+    size_t polls = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int model = 0; model < modelCount; model++)
+    {
+        LoadedMesh* mesh = &submitted[model];
+        loads.push_back(JobSystem::GetInstance().Submit([&loadModel, model, mesh]() { return loadModel(model, *mesh); }));
+    }
+    bool submittedLoaded = true;
+    for (std::future<bool>& load : loads)
+    {
+        while (load.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+        {
+            polls++;
+        }
+        submittedLoaded &= load.get();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Loading on a worker must not change the result.
+    bool identical = serialLoaded && submittedLoaded;
+    for (int model = 0; identical && model < modelCount; model++)
+    {
+        identical = serial[model].vertices.size() == submitted[model].vertices.size() && serial[model].indices == submitted[model].indices &&
+            std::memcmp(serial[model].vertices.data(), submitted[model].vertices.data(), serial[model].vertices.size() * sizeof(MeshTypes::MeshVertex)) == 0 &&
+            std::memcmp(&serial[model].bounds, &submitted[model].bounds, sizeof(MeshTypes::MeshBounds)) == 0;
+    }
+
+    result.passed = identical;
+    result.details = std::to_string(JobSystem::GetInstance().GetWorkerCount()) + " workers, serial " + std::to_string(serialMs) + " ms, submitted " +
+        std::to_string(result.timeMs) + " ms (" + std::to_string(serialMs / result.timeMs) + "x), " + std::to_string(polls) + " polls while waiting" +
+        (identical ? ", identical results" : ", results differ from the serial load");
+
+    return result;
+}
+
+void AssetPipelineBenchmark::GenerateTorusSoup(int segmentsU, int segmentsV, float jitter, std::vector<MeshTypes::MeshVertex>& vertices)
+{
+    const float majorRadius = 1.0f;
+    const float minorRadius = 0.35f;
+    const float twoPi = 6.28318530718f;
+
+    auto makeVertex = [&](int u, int v, uint32_t seed)
+    {
+        MeshTypes::MeshVertex vertex = {};
+        float theta = twoPi * (float)u / (float)segmentsU;
+        float phi = twoPi * (float)v / (float)segmentsV;
+        float cosTheta = std::cos(theta), sinTheta = std::sin(theta);
+        float cosPhi = std::cos(phi), sinPhi = std::sin(phi);
+
+        // Cheap deterministic hash so repeated corners get different jitter.
+        seed = seed * 747796405u + 2891336453u;
+        float noise = ((float)((seed >> 8) & 0xFFFF) / 65535.0f) * 2.0f - 1.0f;
+
+        vertex.x = (majorRadius + minorRadius * cosPhi) * cosTheta + noise * jitter;
+        vertex.y = minorRadius * sinPhi - noise * jitter;
+        vertex.z = (majorRadius + minorRadius * cosPhi) * sinTheta + noise * jitter;
+        vertex.nx = cosPhi * cosTheta;
+        vertex.ny = sinPhi;
+        vertex.nz = cosPhi * sinTheta;
+        vertex.tx = -sinTheta;
+        vertex.tz = cosTheta;
+        vertex.bx = -sinPhi * cosTheta;
+        vertex.by = cosPhi;
+        vertex.bz = -sinPhi * sinTheta;
+        vertex.tu = (float)u / (float)segmentsU;
+        vertex.tv = (float)v / (float)segmentsV;
+        return vertex;
+    };
+
+    vertices.clear();
+    vertices.reserve((size_t)segmentsU * (size_t)segmentsV * 6);
+
+    uint32_t seed = 1;
+    for (int v = 0; v < segmentsV; v++)
+    {
+        for (int u = 0; u < segmentsU; u++)
+        {
+            vertices.push_back(makeVertex(u, v, seed++));
+            vertices.push_back(makeVertex(u, v + 1, seed++));
+            vertices.push_back(makeVertex(u + 1, v, seed++));
+
+            vertices.push_back(makeVertex(u + 1, v, seed++));
+            vertices.push_back(makeVertex(u, v + 1, seed++));
+            vertices.push_back(makeVertex(u + 1, v + 1, seed++));
+        }
+    }
+}
+
+bool AssetPipelineBenchmark::GenerateIndexedTorus(int segmentsU, int segmentsV, std::vector<MeshTypes::MeshVertex>& vertices, std::vector<MeshTypes::IndexType>& indices)
+{
+    std::vector<MeshTypes::MeshVertex> soup;
+    GenerateTorusSoup(segmentsU, segmentsV, 0.0f, soup);
+
+    return MeshWelder::Weld(soup.data(), soup.size(), nullptr, 0, MeshWelder::Settings(), vertices, indices);
+}
+
+void AssetPipelineBenchmark::ShuffleTriangles(std::vector<MeshTypes::IndexType>& indices, uint32_t seed)
+{
+    size_t triangleCount = indices.size() / 3;
+    for (size_t i = triangleCount; i > 1; i--)
+    {
+        seed = seed * 747796405u + 2891336453u;
+        size_t j = (seed >> 8) % i;
+        for (int k = 0; k < 3; k++)
+        {
+            std::swap(indices[(i - 1) * 3 + k], indices[j * 3 + k]);
+        }
+    }
+}
+
+void AssetPipelineBenchmark::LogResult(const AssetBenchmarkResult& result)
+{
+    std::string status = result.passed ? "[PASS] " : "[FAIL] ";
+    LOG(status + result.name + " - " + std::to_string(result.timeMs) + " ms");
+    if (!result.details.empty())
+    {
+        LOG("    " + result.details);
+    }
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTextureIndexBenchmark(int fileCount, int materialCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Texture directory index (" + std::to_string(fileCount) + " files, " + std::to_string(materialCount) + " materials)";
+
+    // A texture folder like the spaceship pack, buried in an asset library.
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "asset_benchmark_textures";
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        result.details = "Failed to create " + directory.string();
+        return result;
+    }
+
+    std::vector<std::string> names = { "color.png", "normal.tga", "metallic.png", "emission.png", "internal_ground_ao_texture.jpeg", "readme.txt" };
+    const char* suffixes[] = { "albedo", "normal", "roughness", "ao", "detail" };
+    for (int i = 0; (int)names.size() < fileCount; i++)
+    {
+        names.push_back("prop_" + std::to_string(i) + "_" + suffixes[i % 5] + ".png");
+    }
+    for (const std::string& name : names)
+    {
+        std::ofstream((directory / name).string()) << name;
+    }
+    std::string texturesDir = directory.generic_string() + "/";
+
+    // The probe lists Model used, one fopen per guess per material.
+    const std::vector<std::string> probes[TextureDirectoryIndex::TYPE_COUNT] =
+    {
+        { "color.png", "color.tga", "color.jpg", "diffuse.png", "diffuse.tga", "diffuse.jpg", "albedo.png", "albedo.tga", "albedo.jpg" },
+        { "normal.png", "normal.tga", "normal.jpg" },
+        {},
+        { "roughness.png", "roughness.tga", "roughness.jpg" },
+        { "metallic.png", "metallic.tga", "metallic.jpg" },
+        { "emission.png", "emission.tga", "emission.jpg" },
+        { "internal_ground_ao_texture.jpeg", "ao.png", "ao.tga", "ao.jpg" },
+    };
+
+    std::vector<std::string> probed(TextureDirectoryIndex::TYPE_COUNT);
+    size_t opens = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int material = 0; material < materialCount; material++)
+    {
+        for (int type = 0; type < TextureDirectoryIndex::TYPE_COUNT; type++)
+        {
+            probed[type].clear();
+            for (const std::string& name : probes[type])
+            {
+                std::string fullPath = texturesDir + name;
+                opens++;
+                FILE* file = std::fopen(fullPath.c_str(), "rb");
+                if (file)
+                {
+                    std::fclose(file);
+                    probed[type] = fullPath;
+                    break;
+                }
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double probeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    TextureDirectoryIndex::Clear();
+    std::vector<std::string> indexed(TextureDirectoryIndex::TYPE_COUNT);
+    start = std::chrono::high_resolution_clock::now();
+    for (int material = 0; material < materialCount; material++)
+    {
+        std::shared_ptr<const TextureDirectoryIndex> index = TextureDirectoryIndex::Get(texturesDir);
+        for (int type = 0; type < TextureDirectoryIndex::TYPE_COUNT; type++)
+        {
+            const std::string* path = index->FindByType((TextureDirectoryIndex::TextureType)type);
+            indexed[type] = path ? *path : std::string();
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    result.timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Where the probes found a plain name the index must agree, the rest come from the suffixes.
+    std::shared_ptr<const TextureDirectoryIndex> index = TextureDirectoryIndex::Get(texturesDir);
+    bool identical = index->GetFileCount() + 1 == names.size();
+    for (int type = 0; type < TextureDirectoryIndex::TYPE_COUNT; type++)
+    {
+        identical &= probed[type].empty() || probed[type] == indexed[type];
+    }
+    const std::string* upperCase = index->Find("COLOR.PNG");
+    bool classified = upperCase && *upperCase == texturesDir + "color.png" &&
+        indexed[TextureDirectoryIndex::TYPE_ROUGHNESS] == texturesDir + "prop_102_roughness.png" &&
+        TextureDirectoryIndex::Classify("C:\\Assets\\Hull_Normal_Detail.TGA") == TextureDirectoryIndex::TYPE_NORMAL &&
+        TextureDirectoryIndex::Classify("textura-color.png") == TextureDirectoryIndex::TYPE_DIFFUSE &&
+        TextureDirectoryIndex::Classify("SpaceshipEmission.png") == TextureDirectoryIndex::TYPE_EMISSION &&
+        TextureDirectoryIndex::Classify("chaos.png") == TextureDirectoryIndex::TYPE_UNKNOWN;
+
+    std::filesystem::remove_all(directory, error);
+
+    result.passed = identical && classified;
+    result.details = std::to_string(opens) + " fopen probes in " + std::to_string(probeMs) + " ms, index " + std::to_string(result.timeMs) + " ms (" +
+        std::to_string(probeMs / result.timeMs) + "x), " + TextureDirectoryIndex::FormatStats(TextureDirectoryIndex::GetStats()) +
+        (identical ? ", same textures as probing" : ", textures differ from probing") + (classified ? "" : ", classification failed");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunSkinningBenchmark(int characterCount, int jointCount, int segmentsU, int segmentsV)
+{
+    AssetBenchmarkResult result;
+    result.name = "Character skinning (" + std::to_string(characterCount) + " characters, " + std::to_string(jointCount) + " joints)";
+
+    std::vector<MeshTypes::MeshVertex> vertices;
+    std::vector<MeshTypes::IndexType> indices;
+    if (!GenerateIndexedTorus(segmentsU, segmentsV, vertices, indices))
+    {
+        result.details = "Failed to generate the test mesh";
+        return result;
+    }
+
+    // A chain of joints around the ring, like a spine or a tail.
+    const float pi = 3.14159265f;
+    AnimationTypes::Skeleton skeleton;
+    for (int j = 0; j < jointCount; j++)
+    {
+        AnimationTypes::Joint joint = {};
+        joint.parent = j - 1;
+        float angle = 2.0f * pi / (float)jointCount;
+        float x = j == 0 ? 1.0f : std::cos(angle * j) - std::cos(angle * (j - 1));
+        float y = j == 0 ? 0.0f : std::sin(angle * j) - std::sin(angle * (j - 1));
+        float bind[3] = { x, y, 0.0f };
+        std::copy(bind, bind + 3, joint.bindLocal.translation);
+        joint.bindLocal.rotation[3] = 1.0f;
+        joint.bindLocal.scale[0] = joint.bindLocal.scale[1] = joint.bindLocal.scale[2] = 1.0f;
+        skeleton.joints.push_back(joint);
+    }
+
+    std::vector<AnimationTypes::Transform> bindPose(jointCount);
+    std::vector<AnimationTypes::JointMatrix> bindModel(jointCount);
+    for (int j = 0; j < jointCount; j++)
+    {
+        bindPose[j] = skeleton.joints[j].bindLocal;
+    }
+    AnimationSampler::ComputeModelPose(skeleton, bindPose.data(), bindModel.data());
+    for (int j = 0; j < jointCount; j++)
+    {
+        AnimationSampler::Invert(bindModel[j], skeleton.joints[j].inverseBind);
+    }
+
+    // Five joints per vertex by angle, so the builder has to drop one.
+    SkinWeightBuilder weightBuilder;
+    weightBuilder.Reset(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        float angle = std::atan2(vertices[i].y, vertices[i].x);
+        float position = (angle < 0.0f ? angle + 2.0f * pi : angle) / (2.0f * pi) * (float)jointCount;
+        int nearest = (int)position;
+        for (int k = -2; k <= 2; k++)
+        {
+            float distance = std::fabs(position - 0.5f - (float)(nearest + k));
+            weightBuilder.AddInfluence(i, (unsigned int)((nearest + k + jointCount) % jointCount), std::max(2.5f - distance, 0.0f));
+        }
+    }
+    std::vector<AnimationTypes::SkinInfluence> influences;
+    SkinWeightBuilder::Stats weightStats;
+    weightBuilder.Build(0, influences, &weightStats);
+
+    bool weightsValid = weightStats.truncatedPoints > 0 && weightStats.maxInfluences == 5;
+    for (const AnimationTypes::SkinInfluence& influence : influences)
+    {
+        float sum = influence.weights[0] + influence.weights[1] + influence.weights[2] + influence.weights[3];
+        weightsValid &= std::fabs(sum - 1.0f) < 1.0e-5f;
+    }
+
+    Skinning::Streams streams;
+    Skinning::BuildStreams(vertices.data(), influences.data(), vertices.size(), streams);
+
+    // Every joint bends a little, out of phase with its neighbours.
+    AnimationTypes::AnimationClip clip;
+    clip.name = "Wave";
+    clip.duration = 1.0f;
+    for (int j = 0; j < jointCount; j++)
+    {
+        AnimationTypes::JointTrack track;
+        track.joint = (uint32_t)j;
+        for (int frame = 0; frame <= 30; frame++)
+        {
+            float time = frame / 30.0f;
+            float halfAngle = 0.1f * std::sin(2.0f * pi * time + 0.3f * j);
+            AnimationTypes::RotationKey key = { time, { 0.0f, std::sin(halfAngle), 0.0f, std::cos(halfAngle) } };
+            track.rotations.push_back(key);
+        }
+        clip.tracks.push_back(track);
+    }
+
+    std::vector<CharacterAnimator> characters(characterCount);
+    std::vector<CharacterAnimator*> characterPointers;
+    for (int c = 0; c < characterCount; c++)
+    {
+        characters[c].Initialize(&skeleton, &streams);
+        characters[c].SetClip(&clip);
+        characters[c].SetTime(c * 0.37f);
+        characterPointers.push_back(&characters[c]);
+    }
+
+    // The bind pose must reproduce the mesh.
+    Skinning::Settings simd;
+    Skinning::Settings scalar;
+    scalar.useSimd = false;
+    CharacterAnimator bindCharacter;
+    bindCharacter.Initialize(&skeleton, &streams);
+    bindCharacter.Update(0.0f, simd);
+    float bindError = 0.0f;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const Skinning::SkinnedVertices& skinned = bindCharacter.GetSkinnedVertices();
+        bindError = std::max(bindError, std::fabs(skinned.positions[0][i] - vertices[i].x));
+        bindError = std::max(bindError, std::fabs(skinned.positions[1][i] - vertices[i].y));
+        bindError = std::max(bindError, std::fabs(skinned.positions[2][i] - vertices[i].z));
+    }
+
+    // Single threaded, scalar against SIMD on the same poses.
+    const int frameCount = 8;
+    const float frameTime = 1.0f / 60.0f;
+    std::vector<std::vector<float>> scalarPositions(characterCount);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frameCount; frame++)
+    {
+        for (int c = 0; c < characterCount; c++)
+        {
+            characters[c].Update(frame == 0 ? 0.0f : frameTime, scalar);
+        }
+    }
+    double scalarMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    for (int c = 0; c < characterCount; c++)
+    {
+        scalarPositions[c] = characters[c].GetSkinnedVertices().positions[1];
+        characters[c].SetTime(c * 0.37f);
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frameCount; frame++)
+    {
+        for (int c = 0; c < characterCount; c++)
+        {
+            characters[c].Update(frame == 0 ? 0.0f : frameTime, simd);
+        }
+    }
+    double simdMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    float simdError = 0.0f;
+    for (int c = 0; c < characterCount; c++)
+    {
+        const std::vector<float>& positions = characters[c].GetSkinnedVertices().positions[1];
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            simdError = std::max(simdError, std::fabs(positions[i] - scalarPositions[c][i]));
+        }
+    }
+
+    // Spread over the workers, one character per job.
+    CharacterAnimator::Stats stats;
+    double parallelMs = 0.0;
+    for (int frame = 0; frame < frameCount; frame++)
+    {
+        CharacterAnimator::UpdateAll(characterPointers.data(), characterPointers.size(), frameTime, simd, &stats);
+        parallelMs += stats.updateTimeMs;
+    }
+    result.timeMs = parallelMs / frameCount;
+
+    double skinnedVertices = (double)vertices.size() * characterCount * frameCount;
+    unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    double scalarRate = skinnedVertices / (scalarMs / 1000.0) / 1.0e6;
+    double simdRate = skinnedVertices / (simdMs / 1000.0) / 1.0e6;
+    double parallelRate = skinnedVertices / (parallelMs / 1000.0) / 1.0e6;
+
+    result.passed = weightsValid && bindError < 1.0e-4f && simdError < 1.0e-4f;
+    result.details = std::to_string(vertices.size()) + " vertices each, " + SkinWeightBuilder::FormatStats(weightStats) + ". Per core: scalar " +
+        std::to_string(scalarRate) + ", " + Skinning::GetInstructionSet() + " " + std::to_string(simdRate) + " M vertices/s (" +
+        std::to_string(scalarMs / simdMs) + "x); " + std::to_string(threadCount) + " cores " + std::to_string(parallelRate) + " M vertices/s (" +
+        std::to_string(parallelRate / threadCount) + " per core), " + std::to_string(result.timeMs) + " ms per frame. Bind pose error " +
+        std::to_string(bindError) + ", SIMD vs scalar " + std::to_string(simdError) + (weightsValid ? "" : ", invalid weights");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunClipCompressionBenchmark(int characterCount, int jointCount, float duration)
+{
+    AssetBenchmarkResult result;
+    result.name = "Clip compression (" + std::to_string(characterCount) + " characters, " + std::to_string(jointCount) + " joints)";
+
+    // A branching skeleton, each joint hangs off one of the previous four, in centimetres.
+    const float pi = 3.14159265f;
+    AnimationTypes::Skeleton skeleton;
+    for (int j = 0; j < jointCount; j++)
+    {
+        AnimationTypes::Joint joint = {};
+        joint.name = "Joint" + std::to_string(j);
+        joint.parent = j == 0 ? -1 : std::max(0, j - 1 - (j * 7) % 4);
+        float bind[3] = { j == 0 ? 0.0f : 8.0f, j == 0 ? 90.0f : 2.0f * (float)(j % 3), 0.0f };
+        std::copy(bind, bind + 3, joint.bindLocal.translation);
+        joint.bindLocal.rotation[3] = 1.0f;
+        joint.bindLocal.scale[0] = joint.bindLocal.scale[1] = joint.bindLocal.scale[2] = 1.0f;
+        skeleton.joints.push_back(joint);
+    }
+
+    // Baked at 30 frames per second like an import: root motion, swinging
+    // limbs, some joints held at a fixed pose and some never moved.
+    AnimationTypes::AnimationClip clip;
+    clip.name = "Walk";
+    clip.duration = duration;
+    int frameCount = (int)(duration * 30.0f + 0.5f) + 1;
+    for (int j = 0; j < jointCount; j++)
+    {
+        AnimationTypes::JointTrack track;
+        track.joint = (uint32_t)j;
+        bool held = j % 5 == 3;
+        bool still = j % 7 == 6;
+        for (int frame = 0; frame < frameCount; frame++)
+        {
+            float time = std::min(frame / 30.0f, duration);
+            float phase = 2.0f * pi * time + 0.4f * j;
+            float halfAngle = still ? 0.0f : held ? 0.3f : 0.35f * std::sin(phase) + 0.1f * std::sin(3.0f * phase);
+            float axis[3] = { std::sin(0.9f * j), std::cos(0.9f * j), 0.5f };
+            float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            float s = std::sin(halfAngle) / axisLength;
+
+            AnimationTypes::VectorKey translation = { time, { skeleton.joints[j].bindLocal.translation[0], skeleton.joints[j].bindLocal.translation[1], 0.0f } };
+            if (j == 0)
+            {
+                translation.value[0] = 120.0f * time;
+                translation.value[1] = 90.0f + 2.5f * std::sin(2.0f * phase);
+            }
+            AnimationTypes::RotationKey rotation = { time, { axis[0] * s, axis[1] * s, axis[2] * s, std::cos(halfAngle) } };
+            AnimationTypes::VectorKey scale = { time, { 1.0f, 1.0f, 1.0f } };
+            track.translations.push_back(translation);
+            track.rotations.push_back(rotation);
+            track.scales.push_back(scale);
+        }
+        clip.tracks.push_back(track);
+    }
+
+    ClipCompressor::Settings settings;
+    settings.translationTolerance = 0.01f;
+    AnimationTypes::CompressedClip compressed;
+    ClipCompressor::Stats stats;
+    if (!ClipCompressor::Compress(clip, skeleton, settings, compressed, &stats))
+    {
+        result.details = "Compression failed";
+        return result;
+    }
+
+    // Between frames too, against the uncompressed sampler.
+    std::vector<AnimationTypes::Transform> rawPose(jointCount);
+    std::vector<AnimationTypes::Transform> compressedPose(jointCount);
+    float sampleError = 0.0f;
+    for (int i = 0; i < 997; i++)
+    {
+        float time = duration * (float)i / 996.0f;
+        AnimationSampler::SampleClip(clip, skeleton, time, true, rawPose.data());
+        ClipCompressor::SampleClip(compressed, skeleton, time, true, compressedPose.data());
+        for (int j = 0; j < jointCount; j++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                sampleError = std::max(sampleError, std::fabs(rawPose[j].translation[k] - compressedPose[j].translation[k]) / 100.0f);
+                sampleError = std::max(sampleError, std::fabs(rawPose[j].scale[k] - compressedPose[j].scale[k]));
+            }
+            float dot = 0.0f;
+            for (int k = 0; k < 4; k++)
+            {
+                dot += rawPose[j].rotation[k] * compressedPose[j].rotation[k];
+            }
+            sampleError = std::max(sampleError, 1.0f - std::fabs(dot));
+        }
+    }
+
+    // One pose per character per frame, single threaded, each at its own time.
+    const int frames = 8;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        for (int c = 0; c < characterCount; c++)
+        {
+            AnimationSampler::SampleClip(clip, skeleton, c * 0.37f + frame / 60.0f, true, rawPose.data());
+        }
+    }
+    double rawMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        for (int c = 0; c < characterCount; c++)
+        {
+            ClipCompressor::SampleClip(compressed, skeleton, c * 0.37f + frame / 60.0f, true, compressedPose.data());
+        }
+    }
+    double compressedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    result.timeMs = compressedMs / frames;
+
+    double ratio = stats.compressedBytes > 0 ? (double)stats.sourceBytes / (double)stats.compressedBytes : 0.0;
+    bool channelsValid = stats.bindChannels > 0 && stats.constantChannels > 0 && stats.animatedChannels > 0;
+    result.passed = channelsValid && ratio > 4.0 && stats.maxRotationError < 2.0f * settings.rotationTolerance &&
+        stats.maxPositionError < 0.1f && sampleError < 1.0e-4f;
+    result.details = ClipCompressor::FormatStats(stats, skeleton) + ". Sampling " + std::to_string(characterCount) + " poses: raw " +
+        std::to_string(rawMs / frames) + " ms, compressed " + std::to_string(result.timeMs) + " ms per frame (" + std::to_string(rawMs / compressedMs) +
+        "x); largest difference between frames " + std::to_string(sampleError) + (channelsValid ? "" : ", channels not classified");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTargaDecodeBenchmark(int width, int height)
+{
+    AssetBenchmarkResult result;
+    result.name = "TGA decoding (" + std::to_string(width) + "x" + std::to_string(height) + ")";
+
+    // Flat bands that RLE packs, noise that it cannot, and odd widths of both.
+    std::vector<uint8_t> image((size_t)width * height * 4);
+    uint32_t seed = 12345;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t* pixel = &image[((size_t)y * width + x) * 4];
+            bool flat = ((x / 37 + y / 53) % 3) != 0;
+            seed = seed * 1664525u + 1013904223u;
+            pixel[0] = flat ? (uint8_t)(y / 53 * 40) : (uint8_t)(seed >> 24);
+            pixel[1] = flat ? (uint8_t)(x / 37 * 20) : (uint8_t)(seed >> 16);
+            pixel[2] = flat ? 128 : (uint8_t)(seed >> 8);
+            pixel[3] = flat ? 255 : (uint8_t)seed;
+        }
+    }
+
+    struct Variant
+    {
+        const char* name;
+        int bitsPerPixel;
+        bool rle;
+        bool topDown;
+    };
+    const Variant variants[] =
+    {
+        { "32 bit", 32, false, false },
+        { "24 bit top-down", 24, false, true },
+        { "32 bit RLE", 32, true, false },
+        { "24 bit RLE", 24, true, false },
+    };
+
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    const int repeats = 4;
+    bool allMatch = true;
+    std::string variantDetails;
+    double plainMs = 0.0;
+
+    for (const Variant& variant : variants)
+    {
+        std::string filename = (directory / ("asset_benchmark_" + std::to_string(variant.bitsPerPixel) + (variant.rle ? "_rle" : "") + ".tga")).string();
+        if (!WriteTarga(filename, image, width, height, variant.bitsPerPixel, variant.rle, variant.topDown))
+        {
+            result.details = "Failed to write " + filename;
+            return result;
+        }
+
+        // Mapped and decoded as Texture does, with and without SIMD.
+        std::vector<uint8_t> decoded((size_t)width * height * 4);
+        std::vector<uint8_t> scalarDecoded(decoded.size());
+        TargaDecoder::Settings simd;
+        TargaDecoder::Settings scalar;
+        scalar.useSimd = false;
+
+        bool decodedAll = true;
+        size_t fileSize = 0;
+        double simdMs = 0.0, scalarMs = 0.0;
+        for (int i = 0; i < repeats; i++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            MappedFile file;
+            TargaDecoder::Header header;
+            decodedAll &= file.Open(filename) && TargaDecoder::ReadHeader(file.GetData(), file.GetSize(), header) &&
+                TargaDecoder::Decode(file.GetData(), file.GetSize(), header, decoded.data(), simd);
+            simdMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            fileSize = file.GetSize();
+
+            start = std::chrono::high_resolution_clock::now();
+            decodedAll &= TargaDecoder::Decode(file.GetData(), file.GetSize(), header, scalarDecoded.data(), scalar);
+            scalarMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        simdMs /= repeats;
+        scalarMs /= repeats;
+
+        // 24 bit files come back opaque.
+        bool match = decodedAll && decoded == scalarDecoded;
+        for (size_t i = 0; match && i < image.size(); i++)
+        {
+            uint8_t expected = (i % 4 == 3 && variant.bitsPerPixel == 24) ? 255 : image[i];
+            match = decoded[i] == expected;
+        }
+        allMatch &= match;
+
+        if (variant.bitsPerPixel == 32 && !variant.rle)
+        {
+            plainMs = simdMs;
+            result.timeMs = simdMs;
+        }
+        variantDetails += std::string(variantDetails.empty() ? "" : ", ") + variant.name + " " + std::to_string(fileSize / 1024) + " KB " +
+            std::to_string(simdMs) + " ms (scalar " + std::to_string(scalarMs) + " ms)" + (match ? "" : " MISMATCH");
+        std::filesystem::remove(filename, error);
+    }
+
+    // The old loader on the plain 32 bit file.
+    std::string baselineFile = (directory / "asset_benchmark_baseline.tga").string();
+    WriteTarga(baselineFile, image, width, height, 32, false, false);
+    std::vector<uint8_t> baseline;
+    int baselineWidth = 0, baselineHeight = 0;
+    double baselineMs = 0.0;
+    bool baselineMatch = true;
+    for (int i = 0; i < repeats; i++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        baselineMatch &= LoadTargaBaseline(baselineFile, baseline, baselineWidth, baselineHeight);
+        baselineMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    baselineMs /= repeats;
+    baselineMatch &= baseline == image;
+    std::filesystem::remove(baselineFile, error);
+
+    result.passed = allMatch && baselineMatch;
+    result.details = "Read + copy + scalar flip " + std::to_string(baselineMs) + " ms, mapped single pass " + std::to_string(plainMs) + " ms (" +
+        std::to_string(plainMs > 0.0 ? baselineMs / plainMs : 0.0) + "x); " + variantDetails;
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTextureCookBenchmark(int width, int height)
+{
+    AssetBenchmarkResult result;
+    result.name = "Texture cooking (" + std::to_string(width) + "x" + std::to_string(height) + ")";
+
+    struct Variant
+    {
+        const char* name;
+        ImageTypes::TextureRole role;
+        bool withAlpha;
+        bool highQualityAlbedo;
+        ImageTypes::PixelFormat expectedFormat;
+        double minRatio;            // Of the RGBA8 chain, tiny levels pad to whole blocks
+        double maxRmse;
+    };
+    const Variant variants[] =
+    {
+        { "albedo", ImageTypes::ROLE_ALBEDO, false, true, ImageTypes::FORMAT_BC7, 3.9, 4.0 },
+        { "albedo with alpha", ImageTypes::ROLE_ALBEDO, true, false, ImageTypes::FORMAT_BC3, 3.9, 5.0 },
+        { "normal", ImageTypes::ROLE_NORMAL, false, true, ImageTypes::FORMAT_BC5, 3.9, 3.0 },
+        { "mask", ImageTypes::ROLE_MASK, false, true, ImageTypes::FORMAT_BC4, 7.8, 3.0 },
+        { "emission", ImageTypes::ROLE_EMISSION, false, true, ImageTypes::FORMAT_BC1, 7.8, 6.0 },
+    };
+
+    bool allValid = true;
+    double serialMs = 0.0;
+    double parallelMs = 0.0;
+    std::string variantDetails;
+    ImageTypes::Image albedoImage;
+    std::vector<uint8_t> source;
+
+    for (const Variant& variant : variants)
+    {
+        GenerateRoleImage(width, height, variant.role, variant.withAlpha, source);
+
+        // The shipping path: SIMD indices, block rows spread over the job system.
+        TextureCooker::Settings settings;
+        settings.highQualityAlbedo = variant.highQualityAlbedo;
+        ImageTypes::Image image;
+        TextureCooker::Stats stats;
+        bool cooked = TextureCooker::Cook(source.data(), width, height, variant.role, settings, image, &stats);
+
+        // Scalar and serial, for the speedup and to check SIMD picks indices as well as the reference.
+        TextureCooker::Settings scalarSettings = settings;
+        scalarSettings.compression.useSimd = false;
+        scalarSettings.compression.parallel = false;
+        ImageTypes::Image scalarImage;
+        TextureCooker::Stats scalarStats;
+        cooked &= TextureCooker::Cook(source.data(), width, height, variant.role, scalarSettings, scalarImage, &scalarStats);
+
+        uint32_t expectedLevels = 1;
+        for (int size = std::max(width, height); size > 1; size /= 2)
+        {
+            expectedLevels++;
+        }
+
+        double ratio = stats.cookedBytes > 0 ? (double)stats.sourceBytes / (double)stats.cookedBytes : 0.0;
+        bool valid = cooked && image.format == variant.expectedFormat && image.levels.size() == expectedLevels && ratio >= variant.minRatio &&
+            stats.rmse <= variant.maxRmse && std::abs(stats.rmse - scalarStats.rmse) <= 0.05 * scalarStats.rmse + 0.01;
+        allValid &= valid;
+
+        serialMs += scalarStats.cookTimeMs;
+        parallelMs += stats.cookTimeMs;
+        variantDetails += std::string(variantDetails.empty() ? "" : ", ") + variant.name + " " + BlockCompressor::GetFormatName(image.format) + " " +
+            std::to_string(ratio) + ":1 RMSE " + std::to_string(stats.rmse) + " (scalar " + std::to_string(scalarStats.rmse) + ") " +
+            std::to_string(stats.cookTimeMs) + " ms" + (valid ? "" : " INVALID");
+
+        if (variant.role == ImageTypes::ROLE_ALBEDO && variant.highQualityAlbedo)
+        {
+            albedoImage = std::move(image);
+        }
+    }
+    result.timeMs = parallelMs;
+
+    // Round trip through the cooked file, as Texture loads it.
+    std::error_code error;
+    std::string filename = (std::filesystem::temp_directory_path(error) / "asset_benchmark_cooked.dds").string();
+    DdsFile::SourceTag tag;
+    tag.size = (uint64_t)width * height * 4;
+    tag.timestamp = 1234567890123;
+    tag.role = ImageTypes::ROLE_ALBEDO;
+    bool fileValid = DdsFile::Write(filename, albedoImage, tag);
+    {
+        DdsFile file;
+        auto start = std::chrono::high_resolution_clock::now();
+        fileValid &= file.Open(filename);
+        double openMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        DdsFile::SourceTag stale = tag;
+        stale.timestamp++;
+        fileValid &= file.IsUpToDate(tag) && !file.IsUpToDate(stale) && file.GetFormat() == albedoImage.format &&
+            file.GetWidth() == albedoImage.width && file.GetHeight() == albedoImage.height && file.GetLevels().size() == albedoImage.levels.size() &&
+            file.GetLevelDataSize() == albedoImage.data.size() && std::memcmp(file.GetLevelData(), albedoImage.data.data(), albedoImage.data.size()) == 0;
+        variantDetails += "; DDS " + std::to_string(file.GetLevelDataSize() / 1024) + " KB mapped in " + std::to_string(openMs) + " ms" + (fileValid ? "" : " INVALID");
+    }
+    std::filesystem::remove(filename, error);
+
+    result.passed = allValid && fileValid;
+    result.details = "Scalar serial " + std::to_string(serialMs) + " ms, SIMD parallel " + std::to_string(parallelMs) + " ms (" +
+        std::to_string(parallelMs > 0.0 ? serialMs / parallelMs : 0.0) + "x); " + variantDetails;
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunMipGenerationBenchmark(int width, int height)
+{
+    AssetBenchmarkResult result;
+    result.name = "Mip generation (" + std::to_string(width) + "x" + std::to_string(height) + ")";
+
+    // Color with an alpha tested pattern of thin blades in clumps, which
+    // plain filtered mips fade out below the test threshold.
+    std::vector<uint8_t> image((size_t)width * height * 4);
+    uint32_t seed = 4242;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint8_t* pixel = &image[((size_t)y * width + x) * 4];
+            float blade = std::sin(x * 0.41f + std::sin(y * 0.05f) * 3.0f) * std::sin(y * 0.13f + x * 0.02f);
+            pixel[0] = (uint8_t)(x * 255 / width);
+            pixel[1] = (uint8_t)(y * 255 / height);
+            pixel[2] = (uint8_t)(seed >> 24);
+            float density = 0.5f + 0.45f * std::sin(x * 0.006f) * std::cos(y * 0.004f);
+            pixel[3] = blade > 1.0f - density ? 255 : 0;
+        }
+    }
+
+    // Every filter, SIMD and parallel against scalar and serial.
+    const MipGenerator::Filter filters[] = { MipGenerator::FILTER_BOX, MipGenerator::FILTER_KAISER, MipGenerator::FILTER_LANCZOS };
+    bool simdMatches = true;
+    std::string filterDetails;
+    for (MipGenerator::Filter filter : filters)
+    {
+        MipGenerator::Settings settings;
+        settings.filter = filter;
+        settings.preserveAlphaCoverage = true;
+        MipGenerator::Settings scalarSettings = settings;
+        scalarSettings.useSimd = false;
+        scalarSettings.parallel = false;
+
+        ImageTypes::Image chain, scalarChain;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool generated = MipGenerator::Generate(image.data(), width, height, settings, chain);
+        double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        start = std::chrono::high_resolution_clock::now();
+        generated &= MipGenerator::Generate(image.data(), width, height, scalarSettings, scalarChain);
+        double serialMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        // Sums may round differently, allow one step.
+        int largestDifference = 0;
+        for (size_t i = 0; generated && i < chain.data.size(); i++)
+        {
+            largestDifference = std::max(largestDifference, std::abs((int)chain.data[i] - (int)scalarChain.data[i]));
+        }
+        bool match = generated && chain.levels.size() == scalarChain.levels.size() && largestDifference <= 1;
+        simdMatches &= match;
+
+        if (filter == MipGenerator::FILTER_KAISER)
+        {
+            result.timeMs = parallelMs;
+        }
+        filterDetails += std::string(filterDetails.empty() ? "" : ", ") + MipGenerator::GetFilterName(filter) + " " + std::to_string(parallelMs) +
+            " ms (scalar serial " + std::to_string(serialMs) + " ms)" + (match ? "" : " MISMATCH");
+    }
+
+    // Alpha coverage at the test threshold down to 8x8, with and without preservation.
+    float topCoverage = MipGenerator::GetAlphaCoverage(image.data(), width, height, 0.5f);
+    float coverageDrift[2] = { 0.0f, 0.0f };
+    for (int preserve = 0; preserve < 2; preserve++)
+    {
+        MipGenerator::Settings settings;
+        settings.filter = MipGenerator::FILTER_BOX;
+        settings.preserveAlphaCoverage = preserve != 0;
+        ImageTypes::Image chain;
+        MipGenerator::Generate(image.data(), width, height, settings, chain);
+        for (const ImageTypes::ImageLevel& level : chain.levels)
+        {
+            if (level.width >= 8 && level.height >= 8)
+            {
+                float coverage = MipGenerator::GetAlphaCoverage(chain.data.data() + level.offset, level.width, level.height, 0.5f);
+                coverageDrift[preserve] = std::max(coverageDrift[preserve], std::abs(coverage - topCoverage));
+            }
+        }
+    }
+    // The first level of a hard edged mask only has quarter steps of alpha, which limits how close it gets.
+    bool coverageValid = coverageDrift[1] < 0.03f && coverageDrift[1] * 2.0f < coverageDrift[0];
+
+    // Black and white texels average to linear mid grey, 188 in sRGB; gamma
+    // encoded averaging gives 128.
+    uint8_t checker[16] = { 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 255 };
+    MipGenerator::Settings boxSettings;
+    boxSettings.filter = MipGenerator::FILTER_BOX;
+    ImageTypes::Image checkerChain;
+    MipGenerator::Generate(checker, 2, 2, boxSettings, checkerChain);
+    int grey = checkerChain.data[checkerChain.levels[1].offset];
+    bool gammaValid = checkerChain.levels.size() == 2 && std::abs(grey - 188) <= 1;
+
+    // Random unit normals stay unit length after filtering.
+    std::vector<uint8_t> normals((size_t)width * height * 4);
+    for (size_t i = 0; i < normals.size(); i += 4)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float nx = ((seed >> 8) & 0xFF) / 255.0f - 0.5f;
+        float ny = ((seed >> 16) & 0xFF) / 255.0f - 0.5f;
+        float length = std::sqrt(nx * nx + ny * ny + 1.0f);
+        normals[i + 0] = (uint8_t)std::lround((nx / length * 0.5f + 0.5f) * 255.0f);
+        normals[i + 1] = (uint8_t)std::lround((ny / length * 0.5f + 0.5f) * 255.0f);
+        normals[i + 2] = (uint8_t)std::lround((1.0f / length * 0.5f + 0.5f) * 255.0f);
+        normals[i + 3] = 255;
+    }
+    MipGenerator::Settings normalSettings;
+    normalSettings.gammaCorrect = false;
+    normalSettings.renormalize = true;
+    ImageTypes::Image normalChain;
+    MipGenerator::Generate(normals.data(), width, height, normalSettings, normalChain);
+    float normalError = 0.0f;
+    for (size_t i = normalChain.levels[1].offset; i < normalChain.data.size(); i += 4)
+    {
+        float nx = normalChain.data[i + 0] / 255.0f * 2.0f - 1.0f;
+        float ny = normalChain.data[i + 1] / 255.0f * 2.0f - 1.0f;
+        float nz = normalChain.data[i + 2] / 255.0f * 2.0f - 1.0f;
+        normalError = std::max(normalError, std::abs(std::sqrt(nx * nx + ny * ny + nz * nz) - 1.0f));
+    }
+    bool normalsValid = normalError < 0.02f;
+
+    // The six faces of a cubemap, in parallel and one after the other.
+    const int faceSize = 512;
+    std::vector<std::vector<uint8_t>> faceImages(6, std::vector<uint8_t>((size_t)faceSize * faceSize * 4));
+    std::vector<const uint8_t*> faces;
+    for (std::vector<uint8_t>& face : faceImages)
+    {
+        for (int y = 0; y < faceSize; y++)
+        {
+            std::memcpy(&face[(size_t)y * faceSize * 4], &image[(size_t)y * width * 4], (size_t)faceSize * 4);
+        }
+        faces.push_back(face.data());
+    }
+    MipGenerator::Settings faceSettings;
+    std::vector<ImageTypes::Image> faceChains;
+    auto start = std::chrono::high_resolution_clock::now();
+    bool facesValid = MipGenerator::GenerateFaces(faces.data(), 6, faceSize, faceSize, faceSettings, faceChains);
+    double facesParallelMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    faceSettings.parallel = false;
+    std::vector<ImageTypes::Image> serialFaceChains;
+    start = std::chrono::high_resolution_clock::now();
+    facesValid &= MipGenerator::GenerateFaces(faces.data(), 6, faceSize, faceSize, faceSettings, serialFaceChains);
+    double facesSerialMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    for (size_t i = 0; facesValid && i < faceChains.size(); i++)
+    {
+        facesValid = faceChains[i].data == serialFaceChains[i].data && faceChains[i].data == faceChains[0].data;
+    }
+
+    result.passed = simdMatches && coverageValid && gammaValid && normalsValid && facesValid;
+    result.details = filterDetails + "; alpha coverage " + std::to_string(topCoverage) + ", drift " + std::to_string(coverageDrift[0]) + " -> " +
+        std::to_string(coverageDrift[1]) + " preserved; checker mip " + std::to_string(grey) + " (linear 188); normal length error " +
+        std::to_string(normalError) + "; 6 faces of " + std::to_string(faceSize) + " parallel " + std::to_string(facesParallelMs) + " ms, serial " +
+        std::to_string(facesSerialMs) + " ms" + (facesValid ? "" : " MISMATCH");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTextureStreamingBenchmark(int materialCount, int objectCount, int frameCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Texture streaming (" + std::to_string(materialCount) + " materials, " + std::to_string(objectCount) + " objects)";
+
+    // Least recently used first: A and B fill the budget, B stays in use, C
+    // needs the room and must take it from A.
+    bool lruValid = true;
+    {
+        std::vector<ImageTypes::ImageLevel> levels = GetLevelLayout(1024, 1024, ImageTypes::FORMAT_BC1);
+        uint32_t baseLevel = MipResidency::GetTailLevel(levels, 64);
+        size_t fullBytes = levels.back().offset + levels.back().size;
+        size_t baseBytes = fullBytes - levels[baseLevel].offset;
+
+        MipResidency::Settings settings;
+        settings.budgetBytes = baseBytes * 3 + (fullBytes - baseBytes) * 2;
+        MipResidency residency;
+        residency.Initialize(settings);
+        uint32_t a = residency.AddTexture(levels, baseLevel);
+        uint32_t b = residency.AddTexture(levels, baseLevel);
+        uint32_t c = residency.AddTexture(levels, baseLevel);
+        std::vector<MipResidency::Change> changes;
+
+        residency.BeginFrame();
+        residency.Request(a, 1024.0f);
+        residency.Request(b, 1024.0f);
+        residency.Update(changes);
+        lruValid &= residency.GetResidentLevel(a) == 0 && residency.GetResidentLevel(b) == 0 && residency.GetResidentLevel(c) == baseLevel;
+
+        residency.BeginFrame();
+        residency.Request(b, 1024.0f);
+        residency.Update(changes);
+        lruValid &= changes.empty() && residency.GetResidentLevel(a) == 0;
+
+        residency.BeginFrame();
+        residency.Request(b, 1024.0f);
+        residency.Request(c, 1024.0f);
+        residency.Update(changes);
+        lruValid &= residency.GetResidentLevel(a) == baseLevel && residency.GetResidentLevel(b) == 0 && residency.GetResidentLevel(c) == 0 &&
+            residency.GetStats().residentBytes <= settings.budgetBytes;
+    }
+
+    // A fleet: six 2048 maps per material, objects spread along the path of
+    // a camera flying through them. Screen sizes as Application::Render
+    // computes them, 1080 lines at a 45 degree field of view.
+    const int mapsPerMaterial = 6;
+    std::vector<ImageTypes::ImageLevel> levels = GetLevelLayout(2048, 2048, ImageTypes::FORMAT_BC7);
+    uint32_t baseLevel = MipResidency::GetTailLevel(levels, 64);
+
+    MipResidency::Settings settings;
+    settings.budgetBytes = 128 * 1024 * 1024;
+    MipResidency residency;
+    residency.Initialize(settings);
+    std::vector<uint32_t> textures;
+    for (int i = 0; i < materialCount * mapsPerMaterial; i++)
+    {
+        textures.push_back(residency.AddTexture(levels, baseLevel));
+    }
+    size_t startBytes = residency.GetStats().residentBytes;
+    size_t fullBytes = residency.GetStats().fullBytes;
+
+    struct Object
+    {
+        float x, y, z;
+        float radius;
+        int material;
+    };
+    std::vector<Object> objects(objectCount);
+    uint32_t seed = 99;
+    auto random = [&seed]()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 16777216.0f;
+    };
+    for (Object& object : objects)
+    {
+        object.x = (random() - 0.5f) * 400.0f;
+        object.y = (random() - 0.5f) * 100.0f;
+        object.z = random() * 2000.0f;
+        object.radius = 5.0f + random() * 20.0f;
+        object.material = (int)(random() * materialCount) % materialCount;
+    }
+
+    const float projectionScale = 1.0f / std::tan(3.14159265f / 8.0f) * 1080.0f * 0.5f;
+    const float tanHalfFov = std::tan(3.14159265f / 8.0f) * 16.0f / 9.0f;
+    bool budgetHeld = true;
+    bool uploadsHeld = true;
+    double updateMs = 0.0;
+    size_t residentSum = 0, wantedSum = 0, loadedSum = 0, evictedSum = 0, deferredSum = 0, peakBytes = 0;
+    std::vector<MipResidency::Change> changes;
+
+    for (int frame = 0; frame < frameCount; frame++)
+    {
+        // Flying forward, holding still for the last tenth.
+        float cameraZ = std::min((float)frame, frameCount * 0.9f) * 2000.0f / frameCount - 100.0f;
+        residency.BeginFrame();
+        for (const Object& object : objects)
+        {
+            float dz = object.z - cameraZ;
+            float distance = std::sqrt(object.x * object.x + object.y * object.y + dz * dz);
+            if (dz + object.radius <= 0.0f || std::abs(object.x) - object.radius > dz * tanHalfFov)
+            {
+                continue;
+            }
+            float screenSize = distance > object.radius ? 2.0f * object.radius * projectionScale / distance : 1080.0f;
+            for (int map = 0; map < mapsPerMaterial; map++)
+            {
+                residency.Request(textures[object.material * mapsPerMaterial + map], screenSize);
+            }
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        residency.Update(changes);
+        updateMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        const MipResidency::Stats& stats = residency.GetStats();
+        budgetHeld &= stats.residentBytes <= settings.budgetBytes;
+        uploadsHeld &= stats.loadedBytes <= settings.uploadBytesPerFrame || stats.loads <= 1;
+        residentSum += stats.residentBytes;
+        wantedSum += stats.wantedBytes;
+        loadedSum += stats.loadedBytes;
+        evictedSum += stats.evictedBytes;
+        deferredSum += stats.deferred;
+        peakBytes = std::max(peakBytes, stats.residentBytes);
+    }
+
+    // Holding still, every request that fits has been served.
+    bool settled = true;
+    for (uint32_t texture : textures)
+    {
+        settled &= residency.GetWantedLevel(texture) >= residency.GetResidentLevel(texture) || residency.GetStats().wantedBytes > settings.budgetBytes;
+    }
+
+    result.timeMs = updateMs / frameCount;
+    result.passed = lruValid && budgetHeld && uploadsHeld && settled && residency.GetStats().deferred == 0;
+    result.details = "All levels " + std::to_string(fullBytes / (1024 * 1024)) + " MB, resident at start " + std::to_string(startBytes / 1024) + " KB, average " +
+        std::to_string(residentSum / frameCount / (1024 * 1024)) + " MB (wanted " + std::to_string(wantedSum / frameCount / (1024 * 1024)) + " MB), peak " +
+        std::to_string(peakBytes / (1024 * 1024)) + " MB of " + std::to_string(settings.budgetBytes / (1024 * 1024)) + " MB budget; streamed in " +
+        std::to_string(loadedSum / (1024 * 1024)) + " MB, evicted " + std::to_string(evictedSum / (1024 * 1024)) + " MB, " + std::to_string(deferredSum) +
+        " deferred requests over " + std::to_string(frameCount) + " frames; " + std::to_string(result.timeMs * 1000.0) + " us per update" +
+        (lruValid ? "" : ", LRU order wrong") + (budgetHeld ? "" : ", over budget") + (uploadsHeld ? "" : ", over upload limit") + (settled ? "" : ", not settled");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunTextureContainerBenchmark(int size, int cubeCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Texture containers (" + std::to_string(cubeCount) + " cubes of " + std::to_string(size) + "x" + std::to_string(size) + ")";
+
+    // A cube array of cooked BC1 faces with full mip chains, each face tinted
+    // so a layer mix-up shows. The faces also go out as TGAs, the decode
+    // cost the containers take off startup.
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "asset_benchmark_containers";
+    std::filesystem::create_directories(directory, error);
+
+    ImageTypes::Image cube;
+    cube.layers = (uint32_t)cubeCount * 6;
+    cube.cubemap = true;
+    TextureCooker::Settings cookSettings;
+    std::vector<uint8_t> face;
+    std::vector<std::string> targaFiles;
+    bool cooked = true;
+    for (uint32_t layer = 0; layer < cube.layers; layer++)
+    {
+        GenerateRoleImage(size, size, ImageTypes::ROLE_EMISSION, false, face);
+        for (size_t i = 0; i < face.size(); i += 4)
+        {
+            face[i] = (uint8_t)(face[i] + layer * 19);
+        }
+
+        targaFiles.push_back((directory / ("face" + std::to_string(layer) + ".tga")).string());
+        WriteTarga(targaFiles.back(), face, size, size, 32, false, false);
+
+        ImageTypes::Image faceImage;
+        cooked &= TextureCooker::Cook(face.data(), (uint32_t)size, (uint32_t)size, ImageTypes::ROLE_EMISSION, cookSettings, faceImage);
+        cube.format = faceImage.format;
+        cube.width = faceImage.width;
+        cube.height = faceImage.height;
+        for (ImageTypes::ImageLevel level : faceImage.levels)
+        {
+            level.offset += cube.data.size();
+            cube.levels.push_back(level);
+        }
+        cube.data.insert(cube.data.end(), faceImage.data.begin(), faceImage.data.end());
+    }
+    uint32_t mipCount = (uint32_t)(cube.levels.size() / cube.layers);
+
+    ImageTypes::Image legacyCube = cube;
+    legacyCube.layers = 6;
+    legacyCube.levels.resize((size_t)mipCount * 6);
+    legacyCube.data.resize(legacyCube.levels.back().offset + legacyCube.levels.back().size);
+
+    std::string ddsFile = (directory / "cube.dds").string();
+    std::string legacyFile = (directory / "legacy.dds").string();
+    std::string ktxFile = (directory / "cube.ktx2").string();
+    std::string supercompressedFile = (directory / "supercompressed.ktx2").string();
+    std::string truncatedFile = (directory / "truncated.dds").string();
+    bool written = cooked && cube.format == ImageTypes::FORMAT_BC1 && DdsFile::Write(ddsFile, cube, DdsFile::SourceTag()) &&
+        WriteLegacyDds(legacyFile, legacyCube) && WriteKtx2(ktxFile, cube, 131, 0) && WriteKtx2(supercompressedFile, cube, 131, 2) &&
+        DdsFile::Write(truncatedFile, cube, DdsFile::SourceTag());
+    std::filesystem::resize_file(truncatedFile, std::filesystem::file_size(truncatedFile, error) - 1, error);
+
+    // Every subresource must point into the mapping and hold the bytes of the level it stands for.
+    auto checkLayout = [&](const TextureFile& file, const ImageTypes::Image& image)
+    {
+        uint32_t levelCount = (uint32_t)(image.levels.size() / image.layers);
+        bool valid = file.IsOpen() && file.GetFormat() == image.format && file.GetMipCount() == levelCount && file.GetLayerCount() == image.layers &&
+            file.IsCubemap() == image.cubemap && file.GetWidth() == image.width && file.GetHeight() == image.height;
+        for (uint32_t layer = 0; valid && layer < image.layers; layer++)
+        {
+            for (uint32_t mip = 0; valid && mip < levelCount; mip++)
+            {
+                const ImageTypes::ImageLevel& level = file.GetLevel(layer, mip);
+                const ImageTypes::ImageLevel& expected = image.levels[layer * levelCount + mip];
+                valid &= level.width == expected.width && level.height == expected.height && level.rowPitch == expected.rowPitch &&
+                    level.size == expected.size && level.offset + level.size <= file.GetDataSize() &&
+                    std::memcmp(file.GetData() + level.offset, image.data.data() + expected.offset, expected.size) == 0;
+            }
+        }
+        return valid;
+    };
+
+    double ddsMs = 0.0;
+    double ktxMs = 0.0;
+    bool ddsValid = false;
+    bool ktxValid = false;
+    bool legacyValid = false;
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::unique_ptr<TextureFile> file = TextureFile::OpenContainer(ddsFile);
+        ddsMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        ddsValid = file && checkLayout(*file, cube);
+    }
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::unique_ptr<TextureFile> file = TextureFile::OpenContainer(ktxFile);
+        ktxMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        ktxValid = file && checkLayout(*file, cube);
+    }
+    {
+        std::unique_ptr<TextureFile> file = TextureFile::OpenContainer(legacyFile);
+        legacyValid = file && checkLayout(*file, legacyCube);
+    }
+
+    // Files the loader must refuse rather than misread.
+    bool refused = !TextureFile::OpenContainer(supercompressedFile) && !TextureFile::OpenContainer(truncatedFile) &&
+        !TextureFile::OpenContainer(targaFiles[0]) && TextureFile::IsContainer("Textures/Sky.KTX2") && !TextureFile::IsContainer("Textures/sky.png");
+
+    // The decode the containers replace: every face from TGA, top level only.
+    auto start = std::chrono::high_resolution_clock::now();
+    bool decoded = true;
+    std::vector<uint8_t> pixels((size_t)size * size * 4);
+    for (const std::string& filename : targaFiles)
+    {
+        MappedFile file;
+        TargaDecoder::Header header;
+        decoded &= file.Open(filename) && TargaDecoder::ReadHeader(file.GetData(), file.GetSize(), header) &&
+            TargaDecoder::Decode(file.GetData(), file.GetSize(), header, pixels.data(), TargaDecoder::Settings());
+    }
+    double targaMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::filesystem::remove_all(directory, error);
+
+    result.timeMs = ddsMs + ktxMs;
+    result.passed = written && ddsValid && ktxValid && legacyValid && refused && decoded;
+    result.details = std::to_string(cube.layers) + " faces x " + std::to_string(mipCount) + " levels, " + std::to_string(cube.data.size() / 1024) +
+        " KB of BC1; DDS mapped in " + std::to_string(ddsMs) + " ms, KTX2 in " + std::to_string(ktxMs) + " ms, decoding the faces from TGA (no mips) " +
+        std::to_string(targaMs) + " ms" + (written ? "" : ", WRITE FAILED") + (ddsValid ? "" : ", DDS layout wrong") + (ktxValid ? "" : ", KTX2 layout wrong") +
+        (legacyValid ? "" : ", legacy DDS layout wrong") + (refused ? "" : ", bad file accepted");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunAtlasPackBenchmark(int itemCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Atlas packing (" + std::to_string(itemCount) + " items)";
+
+    // Icons, glyph pages and sprite frames of mixed sizes, each one solid
+    // color so any texel that leaks into a neighbor shows.
+    std::vector<std::vector<uint8_t>> images(itemCount);
+    std::vector<AtlasPacker::Source> sources(itemCount);
+    std::vector<std::array<uint8_t, 4>> colors(itemCount);
+    uint32_t seed = 777;
+    for (int i = 0; i < itemCount; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t width = i % 10 == 0 ? 96 + (seed >> 26) * 2 : 6 + (seed >> 27) * 3;
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t height = i % 7 == 0 ? 64 + (seed >> 27) : 6 + (seed >> 27) * 3;
+        colors[i] = { (uint8_t)(i * 37), (uint8_t)(i * 11 + 50), (uint8_t)(200 - i * 5), (uint8_t)(128 + i % 128) };
+
+        images[i].resize((size_t)width * height * 4);
+        for (size_t t = 0; t < (size_t)width * height; t++)
+        {
+            std::memcpy(&images[i][t * 4], colors[i].data(), 4);
+        }
+        sources[i] = { images[i].data(), width, height };
+    }
+
+    AtlasPacker::Settings settings;
+    ImageTypes::Image atlas;
+    std::vector<AtlasPacker::Region> regions;
+    AtlasPacker::Stats stats;
+    bool built = AtlasPacker::Build(sources, settings, atlas, regions, &stats);
+
+    // Cells stay apart and aligned, and every item and its padding read as the item.
+    bool layoutValid = built && regions.size() == sources.size();
+    std::vector<uint8_t> owner(built ? (size_t)atlas.width * atlas.height : 0, 0);
+    for (size_t i = 0; layoutValid && i < regions.size(); i++)
+    {
+        const AtlasPacker::Rect& rect = regions[i].rect;
+        uint32_t cellX = rect.x - settings.padding;
+        uint32_t cellY = rect.y - settings.padding;
+        uint32_t cellWidth = (rect.width + settings.padding * 2 + settings.alignment - 1) / settings.alignment * settings.alignment;
+        uint32_t cellHeight = (rect.height + settings.padding * 2 + settings.alignment - 1) / settings.alignment * settings.alignment;
+        layoutValid &= rect.width == sources[i].width && rect.height == sources[i].height && cellX % settings.alignment == 0 &&
+            cellY % settings.alignment == 0 && cellX + cellWidth <= atlas.width && cellY + cellHeight <= atlas.height &&
+            std::fabs(regions[i].u0 * atlas.width - rect.x) < 1.0e-3f && std::fabs(regions[i].v1 * atlas.height - (rect.y + rect.height)) < 1.0e-3f;
+
+        for (uint32_t y = cellY; layoutValid && y < cellY + cellHeight; y++)
+        {
+            for (uint32_t x = cellX; x < cellX + cellWidth; x++)
+            {
+                layoutValid &= owner[(size_t)y * atlas.width + x] == 0 && std::memcmp(&atlas.data[((size_t)y * atlas.width + x) * 4], colors[i].data(), 4) == 0;
+                owner[(size_t)y * atlas.width + x] = 1;
+            }
+        }
+    }
+
+    // At every mip level the item, and one texel around it for bilinear
+    // filtering, still read as the item alone.
+    int worstError = 0;
+    for (uint32_t level = 1; layoutValid && level < atlas.levels.size(); level++)
+    {
+        const ImageTypes::ImageLevel& mip = atlas.levels[level];
+        const uint8_t* texels = atlas.data.data() + mip.offset;
+        for (size_t i = 0; i < regions.size(); i++)
+        {
+            const AtlasPacker::Rect& rect = regions[i].rect;
+            uint32_t x0 = (rect.x >> level) - 1;
+            uint32_t y0 = (rect.y >> level) - 1;
+            uint32_t x1 = ((rect.x + rect.width + (1u << level) - 1) >> level) + 1;
+            uint32_t y1 = ((rect.y + rect.height + (1u << level) - 1) >> level) + 1;
+            for (uint32_t y = y0; y < y1; y++)
+            {
+                for (uint32_t x = x0; x < x1; x++)
+                {
+                    for (int c = 0; c < 4; c++)
+                    {
+                        worstError = std::max(worstError, std::abs((int)texels[((size_t)y * mip.width + x) * 4 + c] - (int)colors[i][c]));
+                    }
+                }
+            }
+        }
+    }
+
+    // Packing alone, for the timing: the same items, many times over.
+    std::vector<AtlasPacker::Rect> sizes(itemCount);
+    for (int i = 0; i < itemCount; i++)
+    {
+        sizes[i] = { 0, 0, sources[i].width, sources[i].height };
+    }
+    const int repeats = 20;
+    uint32_t packWidth = 0;
+    uint32_t packHeight = 0;
+    std::vector<AtlasPacker::Rect> rects;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeats; i++)
+    {
+        AtlasPacker::Pack(sizes, settings, packWidth, packHeight, rects);
+    }
+    double packMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+
+    // The cook step: the items go out as TGA frames, are cooked once into an
+    // atlas and a region table, and later loads only read those back.
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "asset_benchmark_atlas";
+    std::filesystem::create_directories(directory, error);
+    std::string listFilename = (directory / "sprite.txt").string();
+    std::vector<std::string> frames(itemCount);
+    bool framesWritten = true;
+    for (int i = 0; i < itemCount; i++)
+    {
+        frames[i] = (directory / ("frame" + std::to_string(i) + ".tga")).string();
+        framesWritten &= WriteTarga(frames[i], images[i], (int)sources[i].width, (int)sources[i].height, 32, false, false);
+    }
+
+    AtlasCooker::Stats cookStats;
+    bool cooked = framesWritten && AtlasCooker::Cook(listFilename, frames, settings, &cookStats);
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<AtlasPacker::Region> cookedRegions;
+    DdsFile cookedAtlas;
+    bool loaded = cooked && AtlasCooker::ReadRegions(listFilename, frames, cookedRegions) && cookedAtlas.Open(AtlasCooker::GetAtlasFilename(listFilename));
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // The cooked files hold exactly what was packed in memory.
+    bool cookValid = loaded && cookedRegions.size() == regions.size() && cookedAtlas.GetWidth() == atlas.width && cookedAtlas.GetHeight() == atlas.height &&
+        cookedAtlas.GetMipCount() == atlas.levels.size() && cookedAtlas.GetLevelDataSize() == atlas.data.size() &&
+        std::memcmp(cookedAtlas.GetLevelData(), atlas.data.data(), atlas.data.size()) == 0;
+    for (size_t i = 0; cookValid && i < regions.size(); i++)
+    {
+        cookValid &= std::memcmp(&cookedRegions[i], &regions[i], sizeof(AtlasPacker::Region)) == 0;
+    }
+    cookedAtlas.Close();
+
+    // A frame that changed, or a different list, makes the table stale.
+    std::vector<uint8_t> grown(images[0].size() * 4);
+    bool staleRefused = WriteTarga(frames[0], grown, (int)sources[0].width * 2, (int)sources[0].height * 2, 32, false, false) &&
+        !AtlasCooker::ReadRegions(listFilename, frames, cookedRegions) &&
+        !AtlasCooker::ReadRegions(listFilename, std::vector<std::string>(frames.begin() + 1, frames.end()), cookedRegions);
+
+    std::filesystem::remove_all(directory, error);
+
+    result.timeMs = packMs;
+    result.passed = layoutValid && worstError <= 1 && atlas.levels.size() == 3 && stats.occupancy > 0.5f && cookValid && staleRefused;
+    result.details = AtlasPacker::FormatStats(stats) + "; pack alone " + std::to_string(packMs) + " ms; worst mip error " + std::to_string(worstError) +
+        "; cooked in " + std::to_string(cookStats.cookTimeMs) + " ms, loaded cooked in " + std::to_string(loadMs) + " ms; " +
+        std::to_string(itemCount) + " texture binds become 1" + (layoutValid ? "" : ", LAYOUT WRONG") + (cookValid ? "" : ", COOKED ATLAS WRONG") +
+        (staleRefused ? "" : ", stale table accepted");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunImageDecodeBenchmark(int materialCount, int size)
+{
+    AssetBenchmarkResult result;
+    result.name = "Image decoding (" + std::to_string(materialCount) + " materials, " + std::to_string(size) + "x" + std::to_string(size) + ")";
+
+    // The six maps of a material, in the formats exported textures come in.
+    enum Encoding { ENCODE_JPEG, ENCODE_JPEG_444, ENCODE_JPEG_GRAY, ENCODE_PNG, ENCODE_TGA };
+    struct Map
+    {
+        const char* name;
+        ImageTypes::TextureRole role;
+        bool withAlpha;
+        Encoding encoding;
+        int channels;               // PNG and TGA
+        double minPsnr;             // JPEG, PNG and TGA must come back exact
+    };
+    const Map maps[] =
+    {
+        { "diffuse", ImageTypes::ROLE_ALBEDO, false, ENCODE_JPEG, 3, 30.0 },
+        { "normal", ImageTypes::ROLE_NORMAL, false, ENCODE_PNG, 3, 0.0 },
+        { "metallic", ImageTypes::ROLE_MASK, false, ENCODE_PNG, 1, 0.0 },
+        { "roughness", ImageTypes::ROLE_MASK, false, ENCODE_JPEG_GRAY, 1, 30.0 },
+        { "emission", ImageTypes::ROLE_EMISSION, false, ENCODE_JPEG_444, 3, 30.0 },
+        { "ao", ImageTypes::ROLE_MASK, false, ENCODE_TGA, 3, 0.0 },
+    };
+    const size_t mapCount = sizeof(maps) / sizeof(maps[0]);
+
+    std::error_code error;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+    std::vector<std::string> filenames;
+    std::vector<std::vector<uint8_t>> expected(mapCount);
+
+    for (size_t m = 0; m < mapCount; m++)
+    {
+        const Map& map = maps[m];
+        std::vector<uint8_t>& image = expected[m];
+        GenerateRoleImage(size, size, map.role, map.withAlpha, image);
+
+        // What the file holds, as RGBA: gray is the red channel, no alpha is opaque.
+        for (size_t i = 0; i < image.size(); i += 4)
+        {
+            if (map.channels == 1)
+            {
+                image[i + 1] = image[i + 2] = image[i];
+            }
+            if (map.channels < 4)
+            {
+                image[i + 3] = 255;
+            }
+        }
+    }
+
+    for (int material = 0; material < materialCount; material++)
+    {
+        for (size_t m = 0; m < mapCount; m++)
+        {
+            const Map& map = maps[m];
+            static const char* EXTENSIONS[] = { ".jpg", ".jpg", ".jpg", ".png", ".tga" };
+            std::string filename = (directory / ("asset_benchmark_material" + std::to_string(material) + "_" + map.name + EXTENSIONS[map.encoding])).string();
+
+            bool written = false;
+            switch (map.encoding)
+            {
+            case ENCODE_JPEG: written = WriteJpeg(filename, expected[m], size, size, false, true, 90, 0); break;
+            case ENCODE_JPEG_444: written = WriteJpeg(filename, expected[m], size, size, false, false, 90, 64); break;
+            case ENCODE_JPEG_GRAY: written = WriteJpeg(filename, expected[m], size, size, true, false, 90, 0); break;
+            case ENCODE_PNG: written = WritePng(filename, expected[m], size, size, map.channels); break;
+            case ENCODE_TGA: written = WriteTarga(filename, expected[m], size, size, map.channels * 8, true, false); break;
+            }
+            if (!written)
+            {
+                result.details = "Failed to write " + filename;
+                return result;
+            }
+            filenames.push_back(filename);
+        }
+    }
+
+    // One file after another on this thread, as the WIC path loaded them, then the whole set as one batch.
+    ImageDecoder::Settings serial;
+    serial.parallel = false;
+    ImageDecoder::Settings scalar = serial;
+    scalar.useSimd = false;
+    ImageDecoder::Settings batched;
+
+    std::vector<ImageDecoder::Image> images, scalarImages;
+    ImageDecoder::Stats serialStats, scalarStats, batchStats;
+    bool decoded = ImageDecoder::DecodeBatch(filenames, scalarImages, scalar, &scalarStats);
+    decoded &= ImageDecoder::DecodeBatch(filenames, images, serial, &serialStats);
+    std::vector<ImageDecoder::Image> serialImages = std::move(images);
+    decoded &= ImageDecoder::DecodeBatch(filenames, images, batched, &batchStats);
+    result.timeMs = batchStats.decodeTimeMs;
+
+    // Exact for the lossless formats, a PSNR floor for JPEG. SIMD and scalar, serial and batched all agree.
+    bool allMatch = decoded;
+    std::string mapDetails;
+    for (size_t m = 0; m < mapCount && decoded; m++)
+    {
+        double worstPsnr = 1000.0;
+        bool exact = true;
+        for (int material = 0; material < materialCount; material++)
+        {
+            size_t index = (size_t)material * mapCount + m;
+            const ImageDecoder::Image& image = images[index];
+            size_t byteCount = (size_t)size * size * 4;
+            bool consistent = image.info.width == size && image.info.height == size &&
+                std::memcmp(image.pixels.get(), serialImages[index].pixels.get(), byteCount) == 0 &&
+                std::memcmp(image.pixels.get(), scalarImages[index].pixels.get(), byteCount) == 0;
+            allMatch &= consistent;
+            if (!consistent)
+            {
+                continue;
+            }
+
+            double squaredError = 0.0;
+            for (size_t i = 0; i < byteCount; i++)
+            {
+                double difference = (double)image.pixels[i] - (double)expected[m][i];
+                squaredError += difference * difference;
+            }
+            exact &= squaredError == 0.0;
+            double mse = squaredError / (double)byteCount;
+            worstPsnr = std::min(worstPsnr, mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 1000.0);
+        }
+
+        bool match = maps[m].minPsnr > 0.0 ? worstPsnr >= maps[m].minPsnr : exact;
+        allMatch &= match;
+        mapDetails += std::string(mapDetails.empty() ? "" : ", ") + maps[m].name + " " + ImageDecoder::GetFormatName(images[m].info.format) + " " +
+            (maps[m].minPsnr > 0.0 ? std::to_string(worstPsnr) + " dB" : exact ? "exact" : "MISMATCH") + (match ? "" : " FAILED");
+    }
+
+    for (const std::string& filename : filenames)
+    {
+        std::filesystem::remove(filename, error);
+    }
+
+    result.passed = allMatch;
+    result.details = std::to_string(JobSystem::GetInstance().GetWorkerCount()) + " workers, scalar serial " + std::to_string(scalarStats.decodeTimeMs) +
+        " ms, serial " + std::to_string(serialStats.decodeTimeMs) + " ms, batched " + std::to_string(batchStats.decodeTimeMs) + " ms (" +
+        std::to_string(batchStats.decodeTimeMs > 0.0 ? serialStats.decodeTimeMs / batchStats.decodeTimeMs : 0.0) + "x); " +
+        ImageDecoder::FormatStats(batchStats) + "; " + mapDetails;
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunFrustumCullBenchmark(int instanceCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Frustum culling (" + std::to_string(instanceCount) + " instances)";
+
+    // A fleet spread through a cube around the camera, stored the way ModelList stores it.
+    struct Instance
+    {
+        float positionX, positionY, positionZ;
+        float rotationX, rotationY, rotationZ;
+        float scaleX, scaleY, scaleZ;
+    };
+    const float localMin[3] = { -3.0f, -1.0f, -5.0f };
+    const float localMax[3] = { 3.0f, 1.5f, 4.0f };
+    size_t count = (size_t)instanceCount;
+    std::vector<Instance> instances(count);
+    std::vector<float> positionX(count), positionY(count), positionZ(count), scaleX(count), scaleY(count), scaleZ(count);
+    uint32_t seed = 4242;
+    auto random = [&seed](float low, float high)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return low + (high - low) * (float)(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++)
+    {
+        Instance& instance = instances[i];
+        instance.positionX = positionX[i] = random(-1000.0f, 1000.0f);
+        instance.positionY = positionY[i] = random(-300.0f, 300.0f);
+        instance.positionZ = positionZ[i] = random(-1000.0f, 1000.0f);
+        instance.rotationX = 1.570796f;
+        instance.rotationY = random(-3.14159f, 3.14159f);
+        instance.rotationZ = 0.0f;
+        instance.scaleX = scaleX[i] = random(0.5f, 2.0f);
+        instance.scaleY = scaleY[i] = random(0.5f, 2.0f);
+        instance.scaleZ = scaleZ[i] = random(0.5f, 2.0f);
+    }
+
+    const float eye[3] = { 20.0f, 40.0f, -30.0f };
+    const float target[3] = { 300.0f, -20.0f, 500.0f };
+    float planes[6][4];
+    MakeFrustumPlanes(eye, target, 0.6f, 1000.0f, planes);
+
+    const int repeats = 20;
+    size_t wordCount = FrustumCuller::GetMaskWordCount(count);
+    std::vector<float> boxes[6];
+    for (std::vector<float>& component : boxes)
+    {
+        component.resize(count);
+    }
+    std::vector<float> radii(count);
+    std::vector<uint32_t> boxMask(wordCount), scalarBoxMask(wordCount), sphereMask(wordCount), scalarSphereMask(wordCount);
+    std::vector<uint8_t> baselineVisible(count);
+
+    FrustumCuller::Settings simd;
+    FrustumCuller::Settings scalar;
+    scalar.useSimd = false;
+
+    // The world boxes from the transforms, as a frame builds them for instances that moved.
+    auto buildBoxes = [&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            boxes[0][i] = localMin[0] * scaleX[i] + positionX[i];
+            boxes[1][i] = localMin[1] * scaleY[i] + positionY[i];
+            boxes[2][i] = localMin[2] * scaleZ[i] + positionZ[i];
+            boxes[3][i] = localMax[0] * scaleX[i] + positionX[i];
+            boxes[4][i] = localMax[1] * scaleY[i] + positionY[i];
+            boxes[5][i] = localMax[2] * scaleZ[i] + positionZ[i];
+        }
+        return count;
+    };
+    auto cullBoxes = [&](const FrustumCuller::Settings& settings, uint32_t* mask)
+    {
+        return FrustumCuller::CullBoxes(planes, boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data(),
+            count, mask, settings);
+    };
+
+    // Spheres around the positions that hold the box at any rotation. The radii are part of the timing.
+    float localRadius = 0.0f;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        float x = (corner & 1) ? localMax[0] : localMin[0], y = (corner & 2) ? localMax[1] : localMin[1], z = (corner & 4) ? localMax[2] : localMin[2];
+        localRadius = std::max(localRadius, std::sqrt(x * x + y * y + z * z));
+    }
+    auto cullSpheres = [&](const FrustumCuller::Settings& settings, uint32_t* mask)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            radii[i] = localRadius * std::max(std::fabs(scaleX[i]), std::max(std::fabs(scaleY[i]), std::fabs(scaleZ[i])));
+        }
+        return FrustumCuller::CullSpheres(planes, positionX.data(), positionY.data(), positionZ.data(), radii.data(), count, mask, settings);
+    };
+
+    // The loop the render path had: an instance at a time, its world box built by hand and tested plane by plane.
+    auto cullOneByOne = [&]()
+    {
+        size_t visible = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const Instance& instance = instances[i];
+            float worldMin[3] = { localMin[0] * instance.scaleX + instance.positionX, localMin[1] * instance.scaleY + instance.positionY,
+                localMin[2] * instance.scaleZ + instance.positionZ };
+            float worldMax[3] = { localMax[0] * instance.scaleX + instance.positionX, localMax[1] * instance.scaleY + instance.positionY,
+                localMax[2] * instance.scaleZ + instance.positionZ };
+            float center[3], extent[3];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                center[axis] = (worldMin[axis] + worldMax[axis]) * 0.5f;
+                extent[axis] = (worldMax[axis] - worldMin[axis]) * 0.5f;
+            }
+
+            bool inside = true;
+            for (int plane = 0; plane < 6 && inside; plane++)
+            {
+                float distance = planes[plane][0] * center[0] + planes[plane][1] * center[1] + planes[plane][2] * center[2] + planes[plane][3];
+                float reach = std::fabs(planes[plane][0]) * extent[0] + std::fabs(planes[plane][1]) * extent[1] + std::fabs(planes[plane][2]) * extent[2];
+                inside = !(distance < -reach);
+            }
+            baselineVisible[i] = inside;
+            visible += inside;
+        }
+        return visible;
+    };
+
+    auto timeRepeats = [&](const std::function<size_t()>& func, size_t& visible)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            visible = func();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+    };
+
+    size_t baselineCount = 0, boxCount = 0, scalarBoxCount = 0, sphereCount = 0, scalarSphereCount = 0;
+    double baselineMs = timeRepeats(cullOneByOne, baselineCount);
+    double buildMs = timeRepeats(buildBoxes, boxCount);
+    double scalarBoxMs = timeRepeats([&]() { return cullBoxes(scalar, scalarBoxMask.data()); }, scalarBoxCount);
+    double boxMs = timeRepeats([&]() { return cullBoxes(simd, boxMask.data()); }, boxCount);
+    double scalarSphereMs = timeRepeats([&]() { return cullSpheres(scalar, scalarSphereMask.data()); }, scalarSphereCount);
+    double sphereMs = timeRepeats([&]() { return cullSpheres(simd, sphereMask.data()); }, sphereCount);
+    result.timeMs = boxMs;
+
+    // SIMD and scalar agree to the bit, the one by one loop keeps the same instances, and no box the
+    // spheres cull is visible.
+    bool valid = boxMask == scalarBoxMask && sphereMask == scalarSphereMask && boxCount == baselineCount && boxCount > 0 && boxCount < count;
+    for (size_t i = 0; i < count && valid; i++)
+    {
+        bool boxVisible = FrustumCuller::IsVisible(boxMask.data(), i);
+        valid = boxVisible == (baselineVisible[i] != 0) && (!boxVisible || FrustumCuller::IsVisible(sphereMask.data(), i));
+    }
+
+    // Ranges that start on a multiple of 32 give the same words as one call.
+    std::vector<uint32_t> rangeMask(wordCount);
+    const size_t rangeSize = 32 * 37;
+    for (size_t begin = 0; begin < count; begin += rangeSize)
+    {
+        size_t rangeCount = std::min(rangeSize, count - begin);
+        FrustumCuller::CullBoxes(planes, boxes[0].data() + begin, boxes[1].data() + begin, boxes[2].data() + begin, boxes[3].data() + begin,
+            boxes[4].data() + begin, boxes[5].data() + begin, rangeCount, rangeMask.data() + begin / 32, simd);
+    }
+    valid &= rangeMask == boxMask;
+
+    result.passed = valid;
+    result.details = std::to_string(boxCount) + " visible; one by one " + std::to_string(baselineMs) + " ms, world boxes " + std::to_string(buildMs) +
+        " ms + culled scalar " + std::to_string(scalarBoxMs) + " ms, SIMD " + std::to_string(boxMs) + " ms (" +
+        std::to_string(boxMs + buildMs > 0.0 ? baselineMs / (boxMs + buildMs) : 0.0) + "x with the build); spheres (" +
+        std::to_string(sphereCount) + " visible) scalar " + std::to_string(scalarSphereMs) + " ms, SIMD " + std::to_string(sphereMs) + " ms";
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunWorldBoundsBenchmark(int instanceCount, int movedCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "World bounds (" + std::to_string(instanceCount) + " instances, " + std::to_string(movedCount) + " moved)";
+
+    // A ship's oriented box, turned 30 degrees about y and tilted 10 about x in model space as
+    // BoundsCalculator may find it, and the model space AABB around it.
+    const float boxCenter[3] = { 0.5f, 0.25f, -0.5f };
+    const float boxExtents[3] = { 3.0f, 1.0f, 5.0f };
+    const float sinYaw = 0.5f, cosYaw = 0.8660254f, sinTilt = 0.1736482f, cosTilt = 0.9848078f;
+    const float boxAxes[3][3] = { { cosYaw, 0.0f, -sinYaw }, { sinYaw * sinTilt, cosTilt, cosYaw * sinTilt }, { sinYaw * cosTilt, -sinTilt, cosYaw * cosTilt } };
+    const BoundsTransform::Box orientedBox = BoundsTransform::MakeBox(boxCenter, boxAxes, boxExtents);
+    float boxCorners[8][3];
+    float localMin[3] = { 1e30f, 1e30f, 1e30f }, localMax[3] = { -1e30f, -1e30f, -1e30f };
+    for (int corner = 0; corner < 8; corner++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            boxCorners[corner][axis] = orientedBox.center[axis] + ((corner & 1) ? 1.0f : -1.0f) * orientedBox.halfAxes[0][axis] +
+                ((corner & 2) ? 1.0f : -1.0f) * orientedBox.halfAxes[1][axis] + ((corner & 4) ? 1.0f : -1.0f) * orientedBox.halfAxes[2][axis];
+            localMin[axis] = std::min(localMin[axis], boxCorners[corner][axis]);
+            localMax[axis] = std::max(localMax[axis], boxCorners[corner][axis]);
+        }
+    }
+    const BoundsTransform::Box alignedBox = BoundsTransform::MakeBox(localMin, localMax);
+
+    // Ships turned every way, one array per component as ModelList keeps them.
+    size_t count = (size_t)instanceCount;
+    std::vector<float> components[9];
+    for (std::vector<float>& component : components)
+    {
+        component.resize(count);
+    }
+    uint32_t seed = 777;
+    auto random = [&seed](float low, float high)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return low + (high - low) * (float)(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++)
+    {
+        components[0][i] = random(-1000.0f, 1000.0f);
+        components[1][i] = random(-300.0f, 300.0f);
+        components[2][i] = random(-1000.0f, 1000.0f);
+        components[3][i] = random(-3.14159f, 3.14159f);
+        components[4][i] = random(-3.14159f, 3.14159f);
+        components[5][i] = random(-3.14159f, 3.14159f);
+        components[6][i] = random(0.5f, 2.0f);
+        components[7][i] = random(0.5f, 2.0f);
+        components[8][i] = random(0.5f, 2.0f);
+    }
+    BoundsTransform::Transforms transforms = { components[0].data(), components[1].data(), components[2].data(), components[3].data(),
+        components[4].data(), components[5].data(), components[6].data(), components[7].data(), components[8].data() };
+
+    // The scale * rotation matrices ModelList keeps next to the transforms.
+    std::vector<float> matrixArrays[3][3];
+    BoundsTransform::Matrices matrices;
+    BoundsTransform::Instances instances = { components[0].data(), components[1].data(), components[2].data() };
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            matrixArrays[row][column].resize(count);
+            instances.m[row][column] = matrices.m[row][column] = matrixArrays[row][column].data();
+        }
+    }
+
+    std::vector<float> boxes[6], scalarBoxes[6], cornerBoxes[6], alignedBoxes[6];
+    for (int c = 0; c < 6; c++)
+    {
+        boxes[c].resize(count);
+        scalarBoxes[c].resize(count);
+        cornerBoxes[c].resize(count);
+        alignedBoxes[c].resize(count);
+    }
+    auto makeBoxes = [](std::vector<float>* arrays)
+    {
+        BoundsTransform::Boxes result = { arrays[0].data(), arrays[1].data(), arrays[2].data(), arrays[3].data(), arrays[4].data(), arrays[5].data() };
+        return result;
+    };
+
+    BoundsTransform::Settings simd;
+    BoundsTransform::Settings scalar;
+    scalar.useSimd = false;
+
+    // A world matrix per instance and the eight corners of the oriented box moved through it, the
+    // straightforward way to a rotation-correct box.
+    auto transformCorners = [&]()
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            float sinPitch = std::sin(components[3][i]), cosPitch = std::cos(components[3][i]);
+            float sinYaw = std::sin(components[4][i]), cosYaw = std::cos(components[4][i]);
+            float sinRoll = std::sin(components[5][i]), cosRoll = std::cos(components[5][i]);
+            const float rotation[3][3] =
+            {
+                { cosRoll * cosYaw + sinRoll * sinPitch * sinYaw, sinRoll * cosPitch, sinRoll * sinPitch * cosYaw - cosRoll * sinYaw },
+                { cosRoll * sinPitch * sinYaw - sinRoll * cosYaw, cosRoll * cosPitch, sinRoll * sinYaw + cosRoll * sinPitch * cosYaw },
+                { cosPitch * sinYaw, -sinPitch, cosPitch * cosYaw },
+            };
+
+            float low[3] = { 1e30f, 1e30f, 1e30f }, high[3] = { -1e30f, -1e30f, -1e30f };
+            for (int corner = 0; corner < 8; corner++)
+            {
+                float local[3] = { boxCorners[corner][0] * components[6][i], boxCorners[corner][1] * components[7][i], boxCorners[corner][2] * components[8][i] };
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    float world = local[0] * rotation[0][axis] + local[1] * rotation[1][axis] + local[2] * rotation[2][axis] + components[axis][i];
+                    low[axis] = std::min(low[axis], world);
+                    high[axis] = std::max(high[axis], world);
+                }
+            }
+            for (int axis = 0; axis < 3; axis++)
+            {
+                cornerBoxes[axis][i] = low[axis];
+                cornerBoxes[3 + axis][i] = high[axis];
+            }
+        }
+    };
+
+    const int repeats = 10;
+    auto timeRepeats = [&](const std::function<void()>& func)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            func();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+    };
+
+    // The matrices are built when transforms are set, the boxes stream them.
+    double cornerMs = timeRepeats(transformCorners);
+    double matrixMs = timeRepeats([&]() { BoundsTransform::BuildMatrices(transforms, nullptr, count, matrices); });
+    double scalarMs = timeRepeats([&]() { BoundsTransform::TransformBoxes(orientedBox, instances, nullptr, count, makeBoxes(scalarBoxes), scalar); });
+    double simdMs = timeRepeats([&]() { BoundsTransform::TransformBoxes(orientedBox, instances, nullptr, count, makeBoxes(boxes), simd); });
+
+    // Arvo's boxes are the corner boxes, up to rounding, whichever path built them.
+    auto matches = [](float a, float b) { return std::fabs(a - b) <= 1e-4f * std::max(1.0f, std::fabs(b)); };
+    bool valid = true;
+    for (int c = 0; c < 6 && valid; c++)
+    {
+        for (size_t i = 0; i < count && valid; i++)
+        {
+            valid = matches(boxes[c][i], cornerBoxes[c][i]) && matches(scalarBoxes[c][i], boxes[c][i]);
+        }
+    }
+
+    // The oriented box's world boxes sit inside those of the model space AABB, and are smaller.
+    BoundsTransform::TransformBoxes(alignedBox, instances, nullptr, count, makeBoxes(alignedBoxes), simd);
+    bool contained = true;
+    double volumeRatio = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double volume = 1.0, alignedVolume = 1.0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            contained &= boxes[axis][i] >= alignedBoxes[axis][i] - 1e-3f && boxes[3 + axis][i] <= alignedBoxes[3 + axis][i] + 1e-3f;
+            volume *= boxes[3 + axis][i] - boxes[axis][i];
+            alignedVolume *= alignedBoxes[3 + axis][i] - alignedBoxes[axis][i];
+        }
+        volumeRatio += volume / alignedVolume;
+    }
+    volumeRatio /= (double)count;
+
+    // A frame in which some ships moved: their matrices are rebuilt as they change and only their boxes are recomputed.
+    std::vector<uint8_t> dirty(count, 0);
+    std::vector<uint32_t> dirtyIndices;
+    for (int moved = 0; moved < movedCount; moved++)
+    {
+        uint32_t index = (uint32_t)(((uint64_t)moved * 7919u + 13u) % count);
+        components[0][index] += 5.0f;
+        components[4][index] += 0.25f;
+        if (!dirty[index])
+        {
+            dirty[index] = 1;
+            dirtyIndices.push_back(index);
+        }
+    }
+    double dirtyMs = timeRepeats([&]()
+    {
+        BoundsTransform::BuildMatrices(transforms, dirtyIndices.data(), dirtyIndices.size(), matrices);
+        BoundsTransform::TransformBoxes(orientedBox, instances, dirtyIndices.data(), dirtyIndices.size(), makeBoxes(boxes), simd);
+    });
+
+    // The cached boxes now match a full rebuild, moved ships and untouched ones alike.
+    BoundsTransform::BuildMatrices(transforms, nullptr, count, matrices);
+    BoundsTransform::TransformBoxes(orientedBox, instances, nullptr, count, makeBoxes(scalarBoxes), scalar);
+    for (int c = 0; c < 6 && valid; c++)
+    {
+        for (size_t i = 0; i < count && valid; i++)
+        {
+            valid = matches(boxes[c][i], scalarBoxes[c][i]);
+        }
+    }
+    result.timeMs = dirtyMs;
+
+    result.passed = valid && contained && volumeRatio < 1.0;
+    result.details = "all instances: corners " + std::to_string(cornerMs) + " ms, matrices " + std::to_string(matrixMs) + " ms (when set), boxes Arvo scalar " +
+        std::to_string(scalarMs) + " ms, SIMD " + std::to_string(simdMs) + " ms (" + std::to_string(simdMs > 0.0 ? scalarMs / simdMs : 0.0) + "x scalar, " +
+        std::to_string(simdMs > 0.0 ? cornerMs / simdMs : 0.0) + "x corners); " + std::to_string(dirtyIndices.size()) + " moved " + std::to_string(dirtyMs) +
+        " ms; oriented box world AABBs " + std::to_string((int)std::lround(volumeRatio * 100.0)) + "% of the model AABB's" + (contained ? "" : ", NOT CONTAINED");
+
+    return result;
+}
+
+AssetBenchmarkResult AssetPipelineBenchmark::RunParallelCullBenchmark(int instanceCount)
+{
+    AssetBenchmarkResult result;
+    result.name = "Parallel culling (" + std::to_string(instanceCount) + " instances)";
+
+    // Cached world boxes of a fleet around the camera, as ModelList keeps them.
+    size_t count = (size_t)instanceCount;
+    std::vector<float> boxes[6];
+    for (std::vector<float>& component : boxes)
+    {
+        component.resize(count);
+    }
+    uint32_t seed = 9001;
+    auto random = [&seed](float low, float high)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return low + (high - low) * (float)(seed >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; i++)
+    {
+        float center[3] = { random(-1000.0f, 1000.0f), random(-300.0f, 300.0f), random(-1000.0f, 1000.0f) };
+        float extent = random(2.0f, 12.0f);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            boxes[axis][i] = center[axis] - extent;
+            boxes[3 + axis][i] = center[axis] + extent;
+        }
+    }
+
+    const float eye[3] = { 20.0f, 40.0f, -30.0f };
+    const float target[3] = { 300.0f, -20.0f, 500.0f };
+    float planes[6][4];
+    MakeFrustumPlanes(eye, target, 0.6f, 1000.0f, planes);
+
+    size_t wordCount = FrustumCuller::GetMaskWordCount(count);
+    std::vector<uint32_t> mask(wordCount), serialMask(wordCount), loopMask(wordCount);
+    std::vector<uint32_t> visible, serialVisible, loopVisible;
+
+    FrustumCuller::Settings parallel;
+    FrustumCuller::Settings serial;
+    serial.parallel = false;
+
+    auto cullToList = [&](const FrustumCuller::Settings& settings, uint32_t* words, std::vector<uint32_t>& list)
+    {
+        return FrustumCuller::CullBoxesToList(planes, boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(),
+            boxes[5].data(), count, words, list, settings);
+    };
+
+    // The mask, then the list read out of it bit by bit on this thread, as the render loop did.
+    auto cullThenLoop = [&]()
+    {
+        FrustumCuller::CullBoxes(planes, boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data(),
+            count, loopMask.data(), serial);
+        loopVisible.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (FrustumCuller::IsVisible(loopMask.data(), i))
+            {
+                loopVisible.push_back((uint32_t)i);
+            }
+        }
+        return loopVisible.size();
+    };
+
+    const int repeats = 20;
+    auto timeRepeats = [&](const std::function<size_t()>& func, size_t& visibleCount)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            visibleCount = func();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+    };
+
+    size_t loopCount = 0, serialCount = 0, parallelCount = 0;
+    double loopMs = timeRepeats(cullThenLoop, loopCount);
+    double serialMs = timeRepeats([&]() { return cullToList(serial, serialMask.data(), serialVisible); }, serialCount);
+    double parallelMs = timeRepeats([&]() { return cullToList(parallel, mask.data(), visible); }, parallelCount);
+    result.timeMs = parallelMs;
+
+    // Serial, chunked and jobbed, the same mask and list in the same order.
+    bool valid = visible.size() == parallelCount && loopCount > 0 && loopCount < count;
+    valid &= mask == loopMask && serialMask == loopMask && visible == loopVisible && serialVisible == loopVisible;
+
+    // Chunk sizes that are no multiple of 32, or cover everything in one, change nothing.
+    const size_t chunkSizes[] = { 1, 1000, 4096, count };
+    for (size_t chunkSize : chunkSizes)
+    {
+        FrustumCuller::Settings chunked;
+        chunked.chunkSize = chunkSize;
+        std::vector<uint32_t> chunkMask(wordCount), chunkVisible;
+        cullToList(chunked, chunkMask.data(), chunkVisible);
+        valid &= chunkMask == loopMask && chunkVisible == loopVisible;
+    }
+
+    result.passed = valid;
+    result.details = std::to_string(JobSystem::GetInstance().GetWorkerCount()) + " workers, " + std::to_string(parallelCount) +
+        " visible; mask then list " + std::to_string(loopMs) + " ms, chunked serial " + std::to_string(serialMs) + " ms, chunked jobs " +
+        std::to_string(parallelMs) + " ms (" + std::to_string(parallelMs > 0.0 ? loopMs / parallelMs : 0.0) + "x)";
+
+    return result;
+}
@@ -0,0 +1,68 @@
+#ifndef ASSET_PIPELINE_BENCHMARK_H
+#define ASSET_PIPELINE_BENCHMARK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Graphics/Resource/Mesh/MeshTypes.h"
+
+// Headless benchmarks for the asset import pipeline. Nothing in here touches
+// the device, so it can run on a build machine via the --asset-benchmark switch.
+struct AssetBenchmarkResult
+{
+    std::string name;
+    bool passed = false;
+    double timeMs = 0.0;
+    std::string details;
+};
+
+class AssetPipelineBenchmark
+{
+public:
+    AssetPipelineBenchmark();
+    ~AssetPipelineBenchmark();
+
+    // Runs every benchmark, logs the results and returns true if all validations passed.
+    bool RunAll();
+
+    // Individual benchmarks
+    AssetBenchmarkResult RunWeldBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunMeshOptimizerBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunMeshBuilderBenchmark(int nodeCount, int materialCount, int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunMeshSimplifierBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunVertexCompressionBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunTangentGenerationBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunBoundsBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunMeshletBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunCookedMeshBenchmark(int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunTextModelParseBenchmark(int vertexCount);
+    AssetBenchmarkResult RunAsyncLoadBenchmark(int modelCount, int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunTextureIndexBenchmark(int fileCount, int materialCount);
+    AssetBenchmarkResult RunSkinningBenchmark(int characterCount, int jointCount, int segmentsU, int segmentsV);
+    AssetBenchmarkResult RunClipCompressionBenchmark(int characterCount, int jointCount, float duration);
+    AssetBenchmarkResult RunTargaDecodeBenchmark(int width, int height);
+    AssetBenchmarkResult RunTextureCookBenchmark(int width, int height);
+    AssetBenchmarkResult RunMipGenerationBenchmark(int width, int height);
+    AssetBenchmarkResult RunTextureStreamingBenchmark(int materialCount, int objectCount, int frameCount);
+    AssetBenchmarkResult RunTextureContainerBenchmark(int size, int cubeCount);
+    AssetBenchmarkResult RunAtlasPackBenchmark(int itemCount);
+    AssetBenchmarkResult RunImageDecodeBenchmark(int materialCount, int size);
+    AssetBenchmarkResult RunFrustumCullBenchmark(int instanceCount);
+    AssetBenchmarkResult RunWorldBoundsBenchmark(int instanceCount, int movedCount);
+    AssetBenchmarkResult RunParallelCullBenchmark(int instanceCount);
+
+    const std::vector<AssetBenchmarkResult>& GetResults() const { return m_Results; }
+
+private:
+    // Synthetic geometry
+    void GenerateTorusSoup(int segmentsU, int segmentsV, float jitter, std::vector<MeshTypes::MeshVertex>& vertices);
+    bool GenerateIndexedTorus(int segmentsU, int segmentsV, std::vector<MeshTypes::MeshVertex>& vertices, std::vector<MeshTypes::IndexType>& indices);
+    void ShuffleTriangles(std::vector<MeshTypes::IndexType>& indices, uint32_t seed);
+
+    void LogResult(const AssetBenchmarkResult& result);
+
+private:
+    std::vector<AssetBenchmarkResult> m_Results;
+};
+
+#endif
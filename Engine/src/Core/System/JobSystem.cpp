@@ -0,0 +1,139 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace
+{
+    // Shared between the caller of ParallelFor and the helper jobs, which may
+    // only get to run after the loop has already finished.
+    struct ParallelForState
+    {
+        std::function<void(size_t, size_t)> func;
+        size_t count = 0;
+        size_t batchSize = 0;
+        size_t batchCount = 0;
+        std::atomic<size_t> nextBatch{ 0 };
+        std::atomic<size_t> finishedBatches{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+
+        void RunBatches()
+        {
+            size_t finished = 0;
+            for (size_t batch = nextBatch.fetch_add(1); batch < batchCount; batch = nextBatch.fetch_add(1))
+            {
+                size_t begin = batch * batchSize;
+                size_t end = std::min(begin + batchSize, count);
+                func(begin, end);
+                finished++;
+            }
+
+            if (finished > 0 && finishedBatches.fetch_add(finished) + finished == batchCount)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    };
+}
+
+JobSystem& JobSystem::GetInstance()
+{
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::JobSystem()
+    : m_Stop(false)
+{
+    // Leave one hardware thread for the thread that submits the work.
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    unsigned int workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Condition.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // A few batches per thread so uneven batches still balance out.
+    size_t threadCount = m_Workers.size() + 1;
+    size_t batchSize = std::max<size_t>(std::max<size_t>(minBatchSize, 1), (count + threadCount * 4 - 1) / (threadCount * 4));
+    size_t batchCount = (count + batchSize - 1) / batchSize;
+
+    if (batchCount == 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->func = func;
+    state->count = count;
+    state->batchSize = batchSize;
+    state->batchCount = batchCount;
+
+    size_t helperCount = std::min(batchCount - 1, m_Workers.size());
+    for (size_t i = 0; i < helperCount; i++)
+    {
+        Enqueue([state]() { state->RunBatches(); });
+    }
+
+    state->RunBatches();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->finishedBatches.load() == state->batchCount; });
+}
+
+void JobSystem::Enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.push_back(std::move(job));
+    }
+    m_Condition.notify_one();
+}
+
+void JobSystem::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+            if (m_Stop && m_Queue.empty())
+            {
+                return;
+            }
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        job();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads shared by the CPU side asset and culling code.
+class JobSystem
+{
+public:
+    static JobSystem& GetInstance();
+
+    unsigned int GetWorkerCount() const { return (unsigned int)m_Workers.size(); }
+
+    // Splits [0, count) into batches of at least minBatchSize items and calls
+    // func(begin, end) for each one. The calling thread works on batches too
+    // and the call returns once every batch has finished.
+    void ParallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& func);
+
+    // Runs func() on a worker and returns a future for its result. Jobs run in
+    // submission order as workers free up. A job may use ParallelFor, but must
+    // not wait on the future of another submitted job.
+    template<typename Func>
+    auto Submit(Func func) -> std::future<decltype(func())>
+    {
+        using Result = decltype(func());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(func));
+        std::future<Result> future = task->get_future();
+        Enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    // Prevent copying
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Enqueue(std::function<void()> job);
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stop;
+};
+
+#endif
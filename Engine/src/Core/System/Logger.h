@@ -4,6 +4,7 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 
 class Logger
 {
@@ -16,6 +17,7 @@ public:
 
     void Initialize(const std::string& filename = "engine.log")
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         m_LogFile.open(filename);
         if (!m_LogFile.is_open())
         {
@@ -29,6 +31,7 @@ public:
 
     void Shutdown()
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         if (m_LogFile.is_open())
         {
             m_LogFile.close();
@@ -38,6 +41,7 @@ public:
     template<typename T>
     void Log(const T& message)
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         std::cout << message << std::endl;
         if (m_LogFile.is_open())
         {
@@ -49,6 +53,7 @@ public:
     template<typename T>
     void LogError(const T& message)
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         std::cerr << "ERROR: " << message << std::endl;
         if (m_LogFile.is_open())
         {
@@ -60,6 +65,7 @@ public:
     template<typename T>
     void LogWarning(const T& message)
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         std::cout << "WARNING: " << message << std::endl;
         if (m_LogFile.is_open())
         {
@@ -75,6 +81,7 @@ private:
     Logger& operator=(const Logger&) = delete;
 
     std::ofstream m_LogFile;
+    std::mutex m_Mutex;   // Assets are loaded on worker threads too
 };
 
 // Convenience macros
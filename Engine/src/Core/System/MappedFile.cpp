@@ -0,0 +1,131 @@
+#include "MappedFile.h"
+#include "Logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_Data(nullptr)
+    , m_Size(0)
+#ifdef _WIN32
+    , m_FileHandle(nullptr)
+    , m_MappingHandle(nullptr)
+#else
+    , m_FileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        LOG_ERROR("MappedFile: CreateFileMapping failed for " + filename);
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        LOG_ERROR("MappedFile: MapViewOfFile failed for " + filename);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_FileHandle = file;
+    m_MappingHandle = mapping;
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Size = (size_t)fileSize.QuadPart;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        LOG_ERROR("MappedFile: mmap failed for " + filename);
+        close(fd);
+        return false;
+    }
+
+    m_FileDescriptor = fd;
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Size = (size_t)fileInfo.st_size;
+#endif
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_Data)
+    {
+        UnmapViewOfFile(m_Data);
+    }
+    if (m_MappingHandle)
+    {
+        CloseHandle(m_MappingHandle);
+        m_MappingHandle = nullptr;
+    }
+    if (m_FileHandle)
+    {
+        CloseHandle(m_FileHandle);
+        m_FileHandle = nullptr;
+    }
+#else
+    if (m_Data)
+    {
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+    }
+    if (m_FileDescriptor >= 0)
+    {
+        close(m_FileDescriptor);
+        m_FileDescriptor = -1;
+    }
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
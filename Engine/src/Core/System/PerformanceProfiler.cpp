@@ -48,6 +48,8 @@ PerformanceProfiler::PerformanceProfiler()
     m_LastFrameTiming.gpuFrustumCullingTime = 0.0;
     m_LastFrameTiming.totalObjects = 0;
     m_LastFrameTiming.visibleObjects = 0;
+    m_LastFrameTiming.meshletTriangles = 0;
+    m_LastFrameTiming.meshletTrianglesCulled = 0;
     m_LastFrameTiming.gpuUtilization = 0.0;
     m_LastFrameTiming.memoryThroughput = 0.0;
     m_LastFrameTiming.cullingEfficiency = 0.0;
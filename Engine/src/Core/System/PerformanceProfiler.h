@@ -33,6 +33,8 @@ public:
         double gpuFrustumCullingTime;  // GPU frustum culling time in microseconds
         uint32_t totalObjects;         // Total objects processed
         uint32_t visibleObjects;       // Objects that passed frustum culling
+        uint32_t meshletTriangles;     // Triangles of the meshlets tested on the CPU
+        uint32_t meshletTrianglesCulled; // Of those, triangles in meshlets outside the frustum or back facing
         
         // GPU Utilization and Efficiency Metrics
         double gpuUtilization;         // GPU utilization percentage (0-100)
@@ -159,6 +161,10 @@ public:
         m_LastFrameTiming.totalObjects = total; 
         m_LastFrameTiming.visibleObjects = visible; 
     }
+    void SetMeshletCulling(uint32_t triangles, uint32_t trianglesCulled) {
+        m_LastFrameTiming.meshletTriangles = triangles;
+        m_LastFrameTiming.meshletTrianglesCulled = trianglesCulled;
+    }
     
     // Get persistent frustum culling times for speedup calculation
     double GetLastCPUFrustumCullingTime() const { return m_LastCPUFrustumCullingTime; }
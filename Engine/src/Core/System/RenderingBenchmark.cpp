@@ -4,7 +4,12 @@
 #include "../Application/Application.h"
 #include "../../Graphics/Rendering/Camera.h"
 #include "../../Graphics/Math/Frustum.h"
+#include "../../Graphics/Math/BoundsTransform.h"
+#include "../../Graphics/Math/FrustumCuller.h"
 #include "../../Graphics/Resource/Model.h"
+#include "../../Graphics/Resource/ResourceCache.h"
+#include "../../Graphics/Resource/Texture.h"
+#include "../../Graphics/Resource/Image/ImageDecoder.h"
 #include "../../Graphics/Scene/Management/ModelList.h"
 #include "../../Graphics/Shaders/Management/ShaderManager.h"
 #include "../../Graphics/D3D11/D3D11Device.h"
@@ -15,9 +20,12 @@
 #include <sstream>
 #include <random>
 #include <map>
+#include <cctype>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <d3dcompiler.h>
+#include <filesystem>
 #include <fstream>
 #include <thread>
 
@@ -30,6 +38,7 @@ RenderingBenchmark::RenderingBenchmark()
     , m_Status("Not initialized")
     , m_FrameByFrameBenchmarkRunning(false)
     , m_CurrentFrameIndex(0)
+    , m_LODProjectionScale(1.0f)
     , m_CameraPosition(0.0f, 0.0f, -300.0f)
     , m_CameraTarget(0.0f, 0.0f, 0.0f)
     , m_CameraRotation(0.0f)
@@ -79,13 +88,11 @@ bool RenderingBenchmark::Initialize(ID3D11Device* device, ID3D11DeviceContext* c
         return false;
     }
 
-    // Initialize LOD levels - using full model index count for all LODs
-    // In a real implementation, you would have different LOD meshes with different index counts
-    m_LODLevels.resize(4);
-    m_LODLevels[0] = { 50.0f, 61260, 0, 0, 0 };   // High detail (close)
-    m_LODLevels[1] = { 150.0f, 61260, 0, 0, 0 };  // Medium detail
-    m_LODLevels[2] = { 300.0f, 61260, 0, 0, 0 };  // Low detail
-    m_LODLevels[3] = { 1000.0f, 61260, 0, 0, 0 }; // Very low detail (far)
+    // Initialize LOD levels from the model's simplified levels. Every level is used up to the
+    // distance at which the next one's error projects to AppConfig::LOD_MAX_SCREEN_ERROR pixels.
+    int screenHeight = application && application->GetScreenHeight() > 0 ? application->GetScreenHeight() : 1080;
+    m_LODProjectionScale = 1.0f / tanf(XM_PIDIV4 * 0.5f) * (float)screenHeight * 0.5f;
+    InitializeLODLevels(application ? application->GetModel() : nullptr);
 
     // Create dummy buffers for benchmarking
     if (!CreateDummyBuffers())
@@ -99,6 +106,24 @@ bool RenderingBenchmark::Initialize(ID3D11Device* device, ID3D11DeviceContext* c
     return true;
 }
 
+void RenderingBenchmark::InitializeLODLevels(Model* model)
+{
+    m_LODLevels.clear();
+
+    if (model)
+    {
+        for (int lod = 0; lod < model->GetLODCount(); lod++)
+        {
+            float maxDistance = 1000.0f;
+            if (lod + 1 < model->GetLODCount())
+            {
+                maxDistance = model->GetLOD(lod + 1).error * m_LODProjectionScale / AppConfig::LOD_MAX_SCREEN_ERROR;
+            }
+            m_LODLevels.push_back({ maxDistance, (int)model->GetLOD(lod).indexCount, (int)model->GetLOD(lod).indexOffset, 0, 0 });
+        }
+    }
+}
+
 BenchmarkResult RenderingBenchmark::RunBenchmark(const BenchmarkConfig& config)
 {
     m_Status = "Running benchmark: " + config.sceneName;
@@ -144,7 +169,56 @@ BenchmarkResult RenderingBenchmark::RunCPUDrivenBenchmark(const BenchmarkConfig&
     // Reset performance profiler
     PerformanceProfiler::GetInstance().BeginFrame();
 
-    std::vector<int> visibleObjects; // Declare outside the loop
+    // The objects do not move, so their world boxes are built once, one array per component.
+    // Every test object carries the box of the same model, and the rotation moves it.
+    size_t objectCount = m_TestObjects.size();
+    std::vector<float> transforms[9], boxes[6];
+    for (std::vector<float>& component : transforms)
+    {
+        component.resize(objectCount);
+    }
+    for (std::vector<float>& component : boxes)
+    {
+        component.resize(objectCount);
+    }
+    for (size_t i = 0; i < objectCount; i++)
+    {
+        const auto& obj = m_TestObjects[i];
+        const XMFLOAT3* parts[3] = { &obj.position, &obj.rotation, &obj.scale };
+        for (int part = 0; part < 3; part++)
+        {
+            transforms[part * 3 + 0][i] = parts[part]->x;
+            transforms[part * 3 + 1][i] = parts[part]->y;
+            transforms[part * 3 + 2][i] = parts[part]->z;
+        }
+    }
+    if (objectCount > 0)
+    {
+        const auto& obj = m_TestObjects[0];
+        const float localMin[3] = { obj.boundingBoxMin.x, obj.boundingBoxMin.y, obj.boundingBoxMin.z };
+        const float localMax[3] = { obj.boundingBoxMax.x, obj.boundingBoxMax.y, obj.boundingBoxMax.z };
+        BoundsTransform::Transforms objectTransforms = { transforms[0].data(), transforms[1].data(), transforms[2].data(),
+            transforms[3].data(), transforms[4].data(), transforms[5].data(), transforms[6].data(), transforms[7].data(), transforms[8].data() };
+        std::vector<float> matrices[3][3];
+        BoundsTransform::Matrices objectMatrices;
+        BoundsTransform::Instances objectInstances = { transforms[0].data(), transforms[1].data(), transforms[2].data() };
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                matrices[row][column].resize(objectCount);
+                objectInstances.m[row][column] = objectMatrices.m[row][column] = matrices[row][column].data();
+            }
+        }
+        BoundsTransform::BuildMatrices(objectTransforms, nullptr, objectCount, objectMatrices);
+
+        BoundsTransform::Boxes objectBoxes = { boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data() };
+        BoundsTransform::TransformBoxes(BoundsTransform::MakeBox(localMin, localMax), objectInstances, nullptr, objectCount, objectBoxes,
+            BoundsTransform::Settings());
+    }
+    std::vector<uint32_t> visibility(FrustumCuller::GetMaskWordCount(objectCount));
+
+    std::vector<uint32_t> visibleObjects; // Declare outside the loop
     for (int frame = 0; frame < config.benchmarkDuration; frame++)
     {
         BeginFrame();
@@ -171,30 +245,9 @@ BenchmarkResult RenderingBenchmark::RunCPUDrivenBenchmark(const BenchmarkConfig&
             auto frustum = m_Application->GetFrustum();
             frustum->ConstructFrustum(viewMatrix, projectionMatrix, 1000.0f);
             
-            // Perform real frustum culling like the Application does
-            for (int i = 0; i < m_TestObjects.size(); i++)
-            {
-                const auto& obj = m_TestObjects[i];
-                
-                // Transform bounding box to world space (same as Application)
-                XMFLOAT3 worldMin = {
-                    obj.boundingBoxMin.x * obj.scale.x + obj.position.x,
-                    obj.boundingBoxMin.y * obj.scale.y + obj.position.y,
-                    obj.boundingBoxMin.z * obj.scale.z + obj.position.z
-                };
-                XMFLOAT3 worldMax = {
-                    obj.boundingBoxMax.x * obj.scale.x + obj.position.x,
-                    obj.boundingBoxMax.y * obj.scale.y + obj.position.y,
-                    obj.boundingBoxMax.z * obj.scale.z + obj.position.z
-                };
-
-                // Use real frustum culling (same as Application)
-                bool renderModel = frustum->CheckAABB(worldMin, worldMax);
-                
-                if (renderModel) {
-                    visibleObjects.push_back(i);
-                }
-            }
+            // Perform real frustum culling like the Application does, in chunks on the job system
+            frustum->CheckAABBs(boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data(),
+                objectCount, visibility.data(), visibleObjects);
         } else {
             // Fallback to simplified culling if no Application access
             LOG_WARNING("No Application access - using fallback distance culling");
@@ -221,7 +274,7 @@ BenchmarkResult RenderingBenchmark::RunCPUDrivenBenchmark(const BenchmarkConfig&
                 float distance = sqrt(toCamera.x * toCamera.x + toCamera.y * toCamera.y + toCamera.z * toCamera.z);
 
                 if (distance < 500.0f) {
-                    visibleObjects.push_back(i);
+                    visibleObjects.push_back((uint32_t)i);
                 }
             }
         }
@@ -245,25 +298,38 @@ BenchmarkResult RenderingBenchmark::RunCPUDrivenBenchmark(const BenchmarkConfig&
 
                     // Render the actual model buffers
                     model->Render(direct3D->GetDeviceContext());
+
+                    // Distant objects draw a simplified level from the same buffers
+                    int lod = 0;
+                    if (config.enableLOD && m_Application->GetCamera()) {
+                        XMFLOAT3 cameraPosition = m_Application->GetCamera()->GetPosition();
+                        float dx = (obj.boundingBoxMin.x + obj.boundingBoxMax.x) * 0.5f * obj.scale.x + obj.position.x - cameraPosition.x;
+                        float dy = (obj.boundingBoxMin.y + obj.boundingBoxMax.y) * 0.5f * obj.scale.y + obj.position.y - cameraPosition.y;
+                        float dz = (obj.boundingBoxMin.z + obj.boundingBoxMax.z) * 0.5f * obj.scale.z + obj.position.z - cameraPosition.z;
+                        float worldScale = fmaxf(obj.scale.x, fmaxf(obj.scale.y, obj.scale.z));
+                        lod = model->SelectLOD(sqrt(dx * dx + dy * dy + dz * dz), worldScale, m_LODProjectionScale, AppConfig::LOD_MAX_SCREEN_ERROR);
+                    }
+                    int lodIndexCount = model->GetIndexCount(lod);
+                    int lodStartIndex = lod < model->GetLODCount() ? (int)model->GetLOD(lod).indexOffset : 0;
                     
                     // Use real shader rendering
                     if (model->HasFBXMaterial()) {
                         auto light = m_Application->GetLight();
                         auto camera = m_Application->GetCamera();
                         if (light && camera) {
-                            shaderManager->RenderPBRShader(direct3D->GetDeviceContext(), model->GetIndexCount(), 
+                            shaderManager->RenderPBRShader(direct3D->GetDeviceContext(), lodIndexCount, 
                                 worldMatrix, viewMatrix, projectionMatrix,
                                 model->GetDiffuseTexture(), model->GetNormalTexture(), model->GetMetallicTexture(),
                                 model->GetRoughnessTexture(), model->GetEmissionTexture(), model->GetAOTexture(),
                                 light->GetDirection(), light->GetAmbientColor(), light->GetDiffuseColor(), 
                                 model->GetBaseColor(), model->GetMetallic(), model->GetRoughness(), 
-                                model->GetAO(), model->GetEmissionStrength(), camera->GetPosition(), false);
+                                model->GetAO(), model->GetEmissionStrength(), camera->GetPosition(), false, lodStartIndex, model->GetVertexQuantization());
                         }
                     }
                     
                     // Track real rendering stats
                     PerformanceProfiler::GetInstance().IncrementDrawCalls();
-                    PerformanceProfiler::GetInstance().AddTriangles(model->GetIndexCount() / 3); // Real triangle count
+                    PerformanceProfiler::GetInstance().AddTriangles(lodIndexCount / 3); // Real triangle count
                     PerformanceProfiler::GetInstance().AddInstances(1);
                 }
             } else {
@@ -636,9 +702,96 @@ BenchmarkResult RenderingBenchmark::RunHybridBenchmark(const BenchmarkConfig& co
     return result;
 }
 
+bool RenderingBenchmark::RunTextureCacheCheck()
+{
+    // The textures the spaceship's materials are loaded from, uncooked so the pixels compare.
+    std::vector<std::string> filenames;
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator("../Engine/assets/models/spaceship/low-poly/textures", error))
+    {
+        std::string extension = file.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga")
+        {
+            filenames.push_back(file.path().string());
+        }
+    }
+    if (filenames.empty())
+    {
+        LOG_WARNING("Texture cache check skipped, no textures found");
+        return true;
+    }
+
+    ImageDecoder::Settings serial;
+    serial.parallel = false;
+    std::vector<ImageDecoder::Image> images;
+    ImageDecoder::Stats serialStats;
+    bool decoded = ImageDecoder::DecodeBatch(filenames, images, serial, &serialStats);
+
+    ResourceCache& cache = ResourceCache::GetInstance();
+    ResourceCache::Stats statsBefore = cache.GetStats();
+    std::vector<Texture*> textures;
+    auto start = std::chrono::high_resolution_clock::now();
+    cache.AcquireTextures(filenames, std::vector<ImageTypes::TextureRole>(), textures);
+    double batchMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // A second user of the same files only takes references.
+    ResourceCache::Stats statsBetween = cache.GetStats();
+    std::vector<Texture*> repeated;
+    cache.AcquireTextures(filenames, std::vector<ImageTypes::TextureRole>(), repeated);
+    bool shared = repeated == textures && cache.GetStats().pathHits - statsBetween.pathHits == filenames.size();
+
+    // Textures another user created already have handed their pixels to the device.
+    bool allMatch = decoded;
+    bool created = true;
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        Texture* texture = textures[i];
+        if (!texture || !images[i].pixels)
+        {
+            allMatch = false;
+            continue;
+        }
+
+        if (texture->IsDecoded())
+        {
+            size_t byteCount = (size_t)images[i].info.width * images[i].info.height * 4;
+            allMatch &= texture->GetWidth() == images[i].info.width && texture->GetHeight() == images[i].info.height &&
+                texture->GetImageDataSize() == byteCount && std::memcmp(texture->GetImageData(), images[i].pixels.get(), byteCount) == 0;
+        }
+        created &= cache.CreateTexture(texture, m_Device, m_Context) && texture->GetTexture() != nullptr;
+    }
+
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        cache.ReleaseTexture(textures[i]);
+        cache.ReleaseTexture(repeated[i]);
+    }
+    bool released = cache.GetStats().liveTextures == statsBefore.liveTextures;
+
+    bool passed = allMatch && shared && created && released;
+    std::string details = "Texture cache check: " + std::to_string(filenames.size()) + " files, serial decode " +
+        std::to_string(serialStats.decodeTimeMs) + " ms, AcquireTextures " + std::to_string(batchMs) + " ms" +
+        (allMatch ? "" : ", PIXELS DIFFER") + (shared ? "" : ", REPEAT NOT SHARED") + (created ? "" : ", CREATE FAILED") +
+        (released ? "" : ", TEXTURES LEAKED");
+    if (passed)
+    {
+        LOG(details);
+    }
+    else
+    {
+        LOG_ERROR(details);
+    }
+
+    return passed;
+}
+
 std::vector<BenchmarkResult> RenderingBenchmark::RunBenchmarkSuite()
 {
     std::vector<BenchmarkResult> results;
+    m_Status = "Checking the texture cache";
+    RunTextureCacheCheck();
+
     std::vector<int> objectCounts = { 100, 500, 1000, 5000, 10000 };
     std::vector<BenchmarkConfig::RenderingApproach> approaches = {
         BenchmarkConfig::RenderingApproach::CPU_DRIVEN,
@@ -1174,7 +1327,7 @@ void RenderingBenchmark::RunBenchmarkFrame(const BenchmarkConfig& config, Benchm
         PerformanceProfiler::GetInstance().ResetFrameCounters();
         
         // Optimized CPU benchmark - simplified simulation without application overhead
-        int visibleCount = 0;
+        std::vector<int> visibleObjects;
         auto cpuCullingStart = std::chrono::high_resolution_clock::now();
         auto cpuSimulationStart = std::chrono::high_resolution_clock::now(); // Pure simulation timing
         
@@ -1213,42 +1366,48 @@ void RenderingBenchmark::RunBenchmarkFrame(const BenchmarkConfig& config, Benchm
             bool isVisible = (distance < 400.0f) || (distance < 600.0f && (i % 20) < 19); // 95% visible at medium distance
             if (isVisible)
             {
-                visibleCount++;
-                PerformanceProfiler::GetInstance().IncrementDrawCalls();
-                
-                // Use real model triangle count if available
-                if (m_Application && m_Application->GetModel()) {
-                    int realTriangleCount = m_Application->GetModel()->GetIndexCount() / 3;
-                    PerformanceProfiler::GetInstance().AddTriangles(realTriangleCount);
-                } else {
-                    PerformanceProfiler::GetInstance().AddTriangles(20420); // Realistic spaceship triangle count
-                }
-                PerformanceProfiler::GetInstance().AddInstances(1);
-                
-                // Simulate realistic CPU draw call overhead
-                // Based on real-world measurements: ~70 FPS with 1500 objects, ~50 FPS with 2500 objects, ~30 FPS with 4000+ objects
-                // Scale workload based on object count to match real-time performance
-                volatile int dummy = 0;
-                int workloadIterations;
-                if (m_TestObjects.size() <= 1000) {
-                    workloadIterations = 20000; // Higher workload for fewer objects to reduce FPS
-                } else if (m_TestObjects.size() <= 2500) {
-                    workloadIterations = 15000; // Medium workload for medium object count
-                } else {
-                    workloadIterations = 8000; // Lower workload for many objects to increase FPS
-                }
-                for (int j = 0; j < workloadIterations; ++j) {
-                    dummy += j * j; // Scaled work to match real-time performance
-                }
+                visibleObjects.push_back(i);
             }
         }
-        
+
+        // The culling ends with the visible list, the simulated draws below are not part of its time.
         auto cpuCullingEnd = std::chrono::high_resolution_clock::now();
         auto cpuCullingDuration = std::chrono::duration_cast<std::chrono::microseconds>(cpuCullingEnd - cpuCullingStart);
-        
+        int visibleCount = static_cast<int>(visibleObjects.size());
+
         // Set frustum culling data for efficiency metrics
         PerformanceProfiler::GetInstance().SetCPUFrustumCullingTime(static_cast<double>(cpuCullingDuration.count()));
         PerformanceProfiler::GetInstance().SetFrustumCullingObjects(static_cast<uint32_t>(m_TestObjects.size()), static_cast<uint32_t>(visibleCount));
+
+        for (size_t visible = 0; visible < visibleObjects.size(); visible++)
+        {
+            PerformanceProfiler::GetInstance().IncrementDrawCalls();
+            
+            // Use real model triangle count if available
+            if (m_Application && m_Application->GetModel()) {
+                int realTriangleCount = m_Application->GetModel()->GetIndexCount() / 3;
+                PerformanceProfiler::GetInstance().AddTriangles(realTriangleCount);
+            } else {
+                PerformanceProfiler::GetInstance().AddTriangles(20420); // Realistic spaceship triangle count
+            }
+            PerformanceProfiler::GetInstance().AddInstances(1);
+            
+            // Simulate realistic CPU draw call overhead
+            // Based on real-world measurements: ~70 FPS with 1500 objects, ~50 FPS with 2500 objects, ~30 FPS with 4000+ objects
+            // Scale workload based on object count to match real-time performance
+            volatile int dummy = 0;
+            int workloadIterations;
+            if (m_TestObjects.size() <= 1000) {
+                workloadIterations = 20000; // Higher workload for fewer objects to reduce FPS
+            } else if (m_TestObjects.size() <= 2500) {
+                workloadIterations = 15000; // Medium workload for medium object count
+            } else {
+                workloadIterations = 8000; // Lower workload for many objects to increase FPS
+            }
+            for (int j = 0; j < workloadIterations; ++j) {
+                dummy += j * j; // Scaled work to match real-time performance
+            }
+        }
         
         auto cpuSimulationEnd = std::chrono::high_resolution_clock::now(); // End pure simulation timing
         auto cpuSimulationDuration = std::chrono::duration_cast<std::chrono::microseconds>(cpuSimulationEnd - cpuSimulationStart);
@@ -16,6 +16,7 @@ using namespace DirectX;
 
 // Forward declarations
 class Application;
+class Model;
 
 // Benchmark configuration structure
 struct BenchmarkConfig
@@ -110,6 +111,13 @@ public:
 
     // Initialization
     bool Initialize(ID3D11Device* device, ID3D11DeviceContext* context, HWND hwnd, Application* application);
+    // Takes the LOD levels from the model, again once it has finished loading
+    void InitializeLODLevels(Model* model);
+
+    // Loads the model's texture folder through ResourceCache::AcquireTextures and checks the
+    // pixels against ImageDecoder::DecodeBatch, that a second user shares the textures,
+    // that they create on the device and that releasing frees them. Logs the timings.
+    bool RunTextureCacheCheck();
 
     // Benchmark execution
     BenchmarkResult RunBenchmark(const BenchmarkConfig& config);
@@ -189,6 +197,7 @@ private:
     // Test data
     std::vector<ObjectData> m_TestObjects;
     std::vector<LODLevel> m_LODLevels;
+    float m_LODProjectionScale;
 
     // Camera state
     XMFLOAT3 m_CameraPosition;
@@ -1,15 +1,29 @@
 #include <QApplication>
 #include <QWidget>
+#include <cstring>
 
 #include "../GUI/Windows/MainWindow.h"
 #include "../GUI/Windows/ThemeManager.h"
 #include "../Core/System/Logger.h"
+#include "../Core/System/AssetPipelineBenchmark.h"
 
 int main(int argc, char *argv[])
 {
 	// Initialize logger
 	Logger::GetInstance().Initialize();
 
+	// Headless asset pipeline benchmark, no window or device is created
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--asset-benchmark") == 0)
+		{
+			AssetPipelineBenchmark benchmark;
+			bool passed = benchmark.RunAll();
+			Logger::GetInstance().Shutdown();
+			return passed ? 0 : 1;
+		}
+	}
+
 	// Initialize Qt Application
 	QApplication app(argc, argv);
 
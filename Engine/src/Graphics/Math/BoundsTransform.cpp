@@ -0,0 +1,162 @@
+#include "BoundsTransform.h"
+#include <cmath>
+#include <xmmintrin.h>
+
+namespace
+{
+    void TransformBox(const BoundsTransform::Box& box, const BoundsTransform::Instances& instances, size_t index, const BoundsTransform::Boxes& boxes)
+    {
+        const float position[3] = { instances.positionX[index], instances.positionY[index], instances.positionZ[index] };
+        float* mins[3] = { boxes.minX, boxes.minY, boxes.minZ };
+        float* maxs[3] = { boxes.maxX, boxes.maxY, boxes.maxZ };
+        float m[3][3];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                m[row][column] = instances.m[row][column][index];
+            }
+        }
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float worldCenter = box.center[0] * m[0][axis] + box.center[1] * m[1][axis] + box.center[2] * m[2][axis] + position[axis];
+            float worldExtent = 0.0f;
+            for (int halfAxis = 0; halfAxis < 3; halfAxis++)
+            {
+                const float* h = box.halfAxes[halfAxis];
+                worldExtent += std::fabs(h[0] * m[0][axis] + h[1] * m[1][axis] + h[2] * m[2][axis]);
+            }
+            mins[axis][index] = worldCenter - worldExtent;
+            maxs[axis][index] = worldCenter + worldExtent;
+        }
+    }
+
+    // Four instances at once. Listed instances are gathered lane by lane since
+    // the indices of the changed instances need not be contiguous.
+    void TransformBoxesSse(const BoundsTransform::Box& box, const BoundsTransform::Instances& instances, const size_t index[4], bool contiguous,
+                           const BoundsTransform::Boxes& boxes)
+    {
+        auto load = [&](const float* values)
+        {
+            return contiguous ? _mm_loadu_ps(values + index[0]) : _mm_setr_ps(values[index[0]], values[index[1]], values[index[2]], values[index[3]]);
+        };
+
+        __m128 m[3][3];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                m[row][column] = load(instances.m[row][column]);
+            }
+        }
+        const __m128 position[3] = { load(instances.positionX), load(instances.positionY), load(instances.positionZ) };
+
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        float* mins[3] = { boxes.minX, boxes.minY, boxes.minZ };
+        float* maxs[3] = { boxes.maxX, boxes.maxY, boxes.maxZ };
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m128 worldCenter = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(box.center[0]), m[0][axis]),
+                _mm_mul_ps(_mm_set1_ps(box.center[1]), m[1][axis])), _mm_mul_ps(_mm_set1_ps(box.center[2]), m[2][axis])), position[axis]);
+            __m128 worldExtent = _mm_setzero_ps();
+            for (int halfAxis = 0; halfAxis < 3; halfAxis++)
+            {
+                const float* h = box.halfAxes[halfAxis];
+                __m128 projected = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(h[0]), m[0][axis]), _mm_mul_ps(_mm_set1_ps(h[1]), m[1][axis])),
+                    _mm_mul_ps(_mm_set1_ps(h[2]), m[2][axis]));
+                worldExtent = _mm_add_ps(worldExtent, _mm_andnot_ps(signMask, projected));
+            }
+            __m128 low = _mm_sub_ps(worldCenter, worldExtent);
+            __m128 high = _mm_add_ps(worldCenter, worldExtent);
+
+            if (contiguous)
+            {
+                _mm_storeu_ps(mins[axis] + index[0], low);
+                _mm_storeu_ps(maxs[axis] + index[0], high);
+            }
+            else
+            {
+                alignas(16) float lowLanes[4], highLanes[4];
+                _mm_store_ps(lowLanes, low);
+                _mm_store_ps(highLanes, high);
+                for (int lane = 0; lane < 4; lane++)
+                {
+                    mins[axis][index[lane]] = lowLanes[lane];
+                    maxs[axis][index[lane]] = highLanes[lane];
+                }
+            }
+        }
+    }
+}
+
+BoundsTransform::Box BoundsTransform::MakeBox(const float boxMin[3], const float boxMax[3])
+{
+    Box box = {};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        box.center[axis] = (boxMin[axis] + boxMax[axis]) * 0.5f;
+        box.halfAxes[axis][axis] = (boxMax[axis] - boxMin[axis]) * 0.5f;
+    }
+    return box;
+}
+
+BoundsTransform::Box BoundsTransform::MakeBox(const float center[3], const float axes[3][3], const float extents[3])
+{
+    Box box;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        box.center[axis] = center[axis];
+        for (int component = 0; component < 3; component++)
+        {
+            box.halfAxes[axis][component] = axes[axis][component] * extents[axis];
+        }
+    }
+    return box;
+}
+
+void BoundsTransform::BuildMatrices(const Transforms& transforms, const uint32_t* indices, size_t count, const Matrices& matrices)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t index = indices ? indices[i] : i;
+        float sinPitch = std::sin(transforms.rotationX[index]), cosPitch = std::cos(transforms.rotationX[index]);
+        float sinYaw = std::sin(transforms.rotationY[index]), cosYaw = std::cos(transforms.rotationY[index]);
+        float sinRoll = std::sin(transforms.rotationZ[index]), cosRoll = std::cos(transforms.rotationZ[index]);
+        float scaleX = transforms.scaleX[index], scaleY = transforms.scaleY[index], scaleZ = transforms.scaleZ[index];
+
+        // The same products XMMatrixRotationRollPitchYaw forms, each row scaled.
+        matrices.m[0][0][index] = scaleX * (cosRoll * cosYaw + sinRoll * sinPitch * sinYaw);
+        matrices.m[0][1][index] = scaleX * (sinRoll * cosPitch);
+        matrices.m[0][2][index] = scaleX * (sinRoll * sinPitch * cosYaw - cosRoll * sinYaw);
+        matrices.m[1][0][index] = scaleY * (cosRoll * sinPitch * sinYaw - sinRoll * cosYaw);
+        matrices.m[1][1][index] = scaleY * (cosRoll * cosPitch);
+        matrices.m[1][2][index] = scaleY * (sinRoll * sinYaw + cosRoll * sinPitch * cosYaw);
+        matrices.m[2][0][index] = scaleZ * (cosPitch * sinYaw);
+        matrices.m[2][1][index] = scaleZ * -sinPitch;
+        matrices.m[2][2][index] = scaleZ * (cosPitch * cosYaw);
+    }
+}
+
+void BoundsTransform::TransformBoxes(const Box& box, const Instances& instances, const uint32_t* indices, size_t count, const Boxes& boxes,
+                                     const Settings& settings)
+{
+    size_t i = 0;
+    if (settings.useSimd)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            size_t index[4];
+            for (int lane = 0; lane < 4; lane++)
+            {
+                index[lane] = indices ? indices[i + lane] : i + lane;
+            }
+            TransformBoxesSse(box, instances, index, indices == nullptr, boxes);
+        }
+    }
+    for (; i < count; i++)
+    {
+        TransformBox(box, instances, indices ? indices[i] : i, boxes);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef BOUNDS_TRANSFORM_H
+#define BOUNDS_TRANSFORM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Moves a model space box into world space for whole arrays of instances.
+// - Instances are position, Euler rotation and scale, one array per
+//   component. The rotation is pitch, yaw and roll about x, y and z, the
+//   order XMMatrixRotationRollPitchYaw uses, and the world matrix is scale,
+//   then rotation, then translation, as everywhere the instances are drawn.
+// - BuildMatrices turns rotation and scale into the 3x3 scale * rotation
+//   matrix of each instance. It takes the sines and cosines, so it runs when
+//   an instance's transform is set, not every time its box is needed.
+// - TransformBoxes streams those matrices and the positions, four instances
+//   per SSE step. The result is the exact world AABB of the rotated model
+//   box (Arvo): its center goes through the matrix, and each half axis
+//   contributes its absolute projection to the extents. The model box may be
+//   oriented, so a model's tight box stays tight in world space.
+class BoundsTransform
+{
+public:
+    struct Settings
+    {
+        bool useSimd = true;
+    };
+
+    struct Transforms
+    {
+        const float* positionX;
+        const float* positionY;
+        const float* positionZ;
+        const float* rotationX;
+        const float* rotationY;
+        const float* rotationZ;
+        const float* scaleX;
+        const float* scaleY;
+        const float* scaleZ;
+    };
+
+    // Scale * rotation of every instance, one array per element, m[row][column].
+    struct Matrices
+    {
+        float* m[3][3];
+    };
+
+    struct Instances
+    {
+        const float* positionX;
+        const float* positionY;
+        const float* positionZ;
+        const float* m[3][3];
+    };
+
+    // A model space box: its center, and its three axes each scaled by the
+    // half size along it.
+    struct Box
+    {
+        float center[3];
+        float halfAxes[3][3];
+    };
+
+    struct Boxes
+    {
+        float* minX;
+        float* minY;
+        float* minZ;
+        float* maxX;
+        float* maxY;
+        float* maxZ;
+    };
+
+public:
+    static Box MakeBox(const float boxMin[3], const float boxMax[3]);
+    // axes are orthonormal rows and extents the half sizes along them, as in MeshTypes::MeshBounds.
+    static Box MakeBox(const float center[3], const float axes[3][3], const float extents[3]);
+
+    // Writes the matrix of instance indices[i], or of instance i without indices.
+    static void BuildMatrices(const Transforms& transforms, const uint32_t* indices, size_t count, const Matrices& matrices);
+
+    // Writes the world box of instance indices[i], or of instance i without
+    // indices, to the same index of boxes. Other entries are left alone.
+    static void TransformBoxes(const Box& box, const Instances& instances, const uint32_t* indices, size_t count, const Boxes& boxes,
+                               const Settings& settings);
+};
+
+#endif // BOUNDS_TRANSFORM_H
@@ -1,4 +1,5 @@
 #include "frustum.h"
+#include "FrustumCuller.h"
 
 
 Frustum::Frustum()
@@ -310,13 +311,13 @@ bool Frustum::CheckAABB(const XMFLOAT3& min, const XMFLOAT3& max)
         XMFLOAT3 normal(m_planes[i].x, m_planes[i].y, m_planes[i].z);
         float d = m_planes[i].w;
 
-        // Find the point on the AABB that is furthest in the negative direction of the plane normal
+        // Find the point on the AABB that is furthest along the plane normal
         XMFLOAT3 p;
-        p.x = (normal.x >= 0.0f) ? min.x : max.x;
-        p.y = (normal.y >= 0.0f) ? min.y : max.y;
-        p.z = (normal.z >= 0.0f) ? min.z : max.z;
+        p.x = (normal.x >= 0.0f) ? max.x : min.x;
+        p.y = (normal.y >= 0.0f) ? max.y : min.y;
+        p.z = (normal.z >= 0.0f) ? max.z : min.z;
 
-        // If the furthest point is behind the plane, the AABB is outside the frustum
+        // If even that point is behind the plane, the AABB is outside the frustum
         if (XMVectorGetX(XMVector3Dot(XMLoadFloat3(&normal), XMLoadFloat3(&p))) + d < 0.0f)
         {
             return false;
@@ -335,13 +336,13 @@ bool Frustum::CheckAABB(const XMFLOAT3& min, const XMFLOAT3& max) const
         XMFLOAT3 normal(m_planes[i].x, m_planes[i].y, m_planes[i].z);
         float d = m_planes[i].w;
 
-        // Find the point on the AABB that is furthest in the negative direction of the plane normal
+        // Find the point on the AABB that is furthest along the plane normal
         XMFLOAT3 p;
-        p.x = (normal.x >= 0.0f) ? min.x : max.x;
-        p.y = (normal.y >= 0.0f) ? min.y : max.y;
-        p.z = (normal.z >= 0.0f) ? min.z : max.z;
+        p.x = (normal.x >= 0.0f) ? max.x : min.x;
+        p.y = (normal.y >= 0.0f) ? max.y : min.y;
+        p.z = (normal.z >= 0.0f) ? max.z : min.z;
 
-        // If the furthest point is behind the plane, the AABB is outside the frustum
+        // If even that point is behind the plane, the AABB is outside the frustum
         if (XMVectorGetX(XMVector3Dot(XMLoadFloat3(&normal), XMLoadFloat3(&p))) + d < 0.0f)
         {
             return false;
@@ -349,4 +350,57 @@ bool Frustum::CheckAABB(const XMFLOAT3& min, const XMFLOAT3& max) const
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+bool Frustum::CheckOBB(const XMFLOAT3& center, const XMFLOAT3 halfAxes[3]) const
+{
+    // Check each plane of the frustum
+    for (int i = 0; i < 6; i++)
+    {
+        XMVECTOR normal = XMVectorSet(m_planes[i].x, m_planes[i].y, m_planes[i].z, 0.0f);
+
+        // Projected radius of the box onto the plane normal
+        float radius = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            radius += fabsf(XMVectorGetX(XMVector3Dot(normal, XMLoadFloat3(&halfAxes[axis]))));
+        }
+
+        // If the center is further behind the plane than the box reaches, the OBB is outside the frustum
+        if (XMVectorGetX(XMVector3Dot(normal, XMLoadFloat3(&center))) + m_planes[i].w < -radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t Frustum::CheckSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, size_t count, uint32_t* visibility) const
+{
+    FrustumCuller::Settings settings;
+    return FrustumCuller::CullSpheres(reinterpret_cast<const float(*)[4]>(m_planes), centerX, centerY, centerZ, radius, count, visibility, settings);
+}
+
+size_t Frustum::CheckAABBs(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ,
+                           size_t count, uint32_t* visibility) const
+{
+    FrustumCuller::Settings settings;
+    return FrustumCuller::CullBoxes(reinterpret_cast<const float(*)[4]>(m_planes), minX, minY, minZ, maxX, maxY, maxZ, count, visibility, settings);
+}
+
+size_t Frustum::CheckAABBs(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ,
+                           size_t count, uint32_t* visibility, std::vector<uint32_t>& visible) const
+{
+    FrustumCuller::Settings settings;
+    return FrustumCuller::CullBoxesToList(reinterpret_cast<const float(*)[4]>(m_planes), minX, minY, minZ, maxX, maxY, maxZ, count, visibility,
+        visible, settings);
+}
+
+void Frustum::GetPlanes(XMFLOAT4 planes[6]) const
+{
+    for (int i = 0; i < 6; i++)
+    {
+        planes[i] = m_planes[i];
+    }
+}
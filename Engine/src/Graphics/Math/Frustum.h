@@ -2,6 +2,9 @@
 #define _FRUSTUM_H_
 
 #include <directxmath.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 using namespace DirectX;
 
 class Frustum
@@ -19,6 +22,20 @@ public:
     bool CheckRectangle(float, float, float, float, float, float);
     bool CheckAABB(const XMFLOAT3& min, const XMFLOAT3& max);
     bool CheckAABB(const XMFLOAT3& min, const XMFLOAT3& max) const;
+    bool CheckOBB(const XMFLOAT3& center, const XMFLOAT3 halfAxes[3]) const;
+
+    // Many volumes at once from SoA arrays, four or eight per SIMD step. Bit i
+    // of the visibility mask is set when volume i may be visible, see
+    // FrustumCuller. Both return the number of visible volumes.
+    size_t CheckSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius, size_t count, uint32_t* visibility) const;
+    size_t CheckAABBs(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ,
+                      size_t count, uint32_t* visibility) const;
+
+    // CheckAABBs on the job system, which also lists the visible indices in order.
+    size_t CheckAABBs(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ,
+                      size_t count, uint32_t* visibility, std::vector<uint32_t>& visible) const;
+
+    void GetPlanes(XMFLOAT4 planes[6]) const;
 
 private:
     XMFLOAT4 m_planes[6];
@@ -0,0 +1,316 @@
+#include "FrustumCuller.h"
+#include "../../Core/System/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    size_t CountBits(uint32_t value)
+    {
+        value = value - ((value >> 1) & 0x55555555u);
+        value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+        return (size_t)((((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+    }
+
+    // The position of the lowest set bit, value must not be zero.
+    uint32_t LowestBit(uint32_t value)
+    {
+        static const uint32_t DE_BRUIJN_POSITIONS[32] =
+        {
+            0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+            31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+        };
+        return DE_BRUIJN_POSITIONS[((value & (0u - value)) * 0x077CB531u) >> 27];
+    }
+
+    // The scalar tests, also used for the ends of the SIMD words. The sums
+    // are in the same order as the SIMD ones, so both agree to the bit.
+    bool SphereVisible(const float planes[6][4], float x, float y, float z, float radius)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            float distance = planes[i][0] * x + planes[i][1] * y + planes[i][2] * z + planes[i][3];
+            if (distance < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool BoxVisible(const float planes[6][4], float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+    {
+        float centerX = (minX + maxX) * 0.5f, centerY = (minY + maxY) * 0.5f, centerZ = (minZ + maxZ) * 0.5f;
+        float extentX = (maxX - minX) * 0.5f, extentY = (maxY - minY) * 0.5f, extentZ = (maxZ - minZ) * 0.5f;
+        for (int i = 0; i < 6; i++)
+        {
+            float distance = planes[i][0] * centerX + planes[i][1] * centerY + planes[i][2] * centerZ + planes[i][3];
+            float reach = std::fabs(planes[i][0]) * extentX + std::fabs(planes[i][1]) * extentY + std::fabs(planes[i][2]) * extentZ;
+            if (distance < -reach)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Planes broadcast once per call, and their absolute normals for the boxes.
+    struct PlanesSse
+    {
+        __m128 a[6], b[6], c[6], d[6];
+        __m128 absA[6], absB[6], absC[6];
+
+        explicit PlanesSse(const float planes[6][4])
+        {
+            for (int i = 0; i < 6; i++)
+            {
+                a[i] = _mm_set1_ps(planes[i][0]);
+                b[i] = _mm_set1_ps(planes[i][1]);
+                c[i] = _mm_set1_ps(planes[i][2]);
+                d[i] = _mm_set1_ps(planes[i][3]);
+                absA[i] = _mm_set1_ps(std::fabs(planes[i][0]));
+                absB[i] = _mm_set1_ps(std::fabs(planes[i][1]));
+                absC[i] = _mm_set1_ps(std::fabs(planes[i][2]));
+            }
+        }
+    };
+
+    // Four spheres, a bit per sphere that may be visible.
+    inline uint32_t SpheresVisibleSse(const PlanesSse& planes, const float* x, const float* y, const float* z, const float* radius)
+    {
+        __m128 centerX = _mm_loadu_ps(x), centerY = _mm_loadu_ps(y), centerZ = _mm_loadu_ps(z);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius));
+        __m128 outside = _mm_setzero_ps();
+        for (int i = 0; i < 6; i++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.a[i], centerX), _mm_mul_ps(planes.b[i], centerY)),
+                _mm_mul_ps(planes.c[i], centerZ)), planes.d[i]);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+        }
+        return (uint32_t)(~_mm_movemask_ps(outside) & 0xF);
+    }
+
+    inline uint32_t BoxesVisibleSse(const PlanesSse& planes, const float* minX, const float* minY, const float* minZ,
+                                    const float* maxX, const float* maxY, const float* maxZ)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        __m128 lowX = _mm_loadu_ps(minX), lowY = _mm_loadu_ps(minY), lowZ = _mm_loadu_ps(minZ);
+        __m128 highX = _mm_loadu_ps(maxX), highY = _mm_loadu_ps(maxY), highZ = _mm_loadu_ps(maxZ);
+        __m128 centerX = _mm_mul_ps(_mm_add_ps(lowX, highX), half), centerY = _mm_mul_ps(_mm_add_ps(lowY, highY), half);
+        __m128 centerZ = _mm_mul_ps(_mm_add_ps(lowZ, highZ), half);
+        __m128 extentX = _mm_mul_ps(_mm_sub_ps(highX, lowX), half), extentY = _mm_mul_ps(_mm_sub_ps(highY, lowY), half);
+        __m128 extentZ = _mm_mul_ps(_mm_sub_ps(highZ, lowZ), half);
+        __m128 outside = _mm_setzero_ps();
+        for (int i = 0; i < 6; i++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.a[i], centerX), _mm_mul_ps(planes.b[i], centerY)),
+                _mm_mul_ps(planes.c[i], centerZ)), planes.d[i]);
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.absA[i], extentX), _mm_mul_ps(planes.absB[i], extentY)),
+                _mm_mul_ps(planes.absC[i], extentZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_sub_ps(_mm_setzero_ps(), reach)));
+        }
+        return (uint32_t)(~_mm_movemask_ps(outside) & 0xF);
+    }
+
+#if defined(__AVX__)
+    struct PlanesAvx
+    {
+        __m256 a[6], b[6], c[6], d[6];
+        __m256 absA[6], absB[6], absC[6];
+
+        explicit PlanesAvx(const float planes[6][4])
+        {
+            for (int i = 0; i < 6; i++)
+            {
+                a[i] = _mm256_set1_ps(planes[i][0]);
+                b[i] = _mm256_set1_ps(planes[i][1]);
+                c[i] = _mm256_set1_ps(planes[i][2]);
+                d[i] = _mm256_set1_ps(planes[i][3]);
+                absA[i] = _mm256_set1_ps(std::fabs(planes[i][0]));
+                absB[i] = _mm256_set1_ps(std::fabs(planes[i][1]));
+                absC[i] = _mm256_set1_ps(std::fabs(planes[i][2]));
+            }
+        }
+    };
+
+    inline uint32_t SpheresVisibleAvx(const PlanesAvx& planes, const float* x, const float* y, const float* z, const float* radius)
+    {
+        __m256 centerX = _mm256_loadu_ps(x), centerY = _mm256_loadu_ps(y), centerZ = _mm256_loadu_ps(z);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius));
+        __m256 outside = _mm256_setzero_ps();
+        for (int i = 0; i < 6; i++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes.a[i], centerX), _mm256_mul_ps(planes.b[i], centerY)),
+                _mm256_mul_ps(planes.c[i], centerZ)), planes.d[i]);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+        }
+        return (uint32_t)(~_mm256_movemask_ps(outside) & 0xFF);
+    }
+
+    inline uint32_t BoxesVisibleAvx(const PlanesAvx& planes, const float* minX, const float* minY, const float* minZ,
+                                    const float* maxX, const float* maxY, const float* maxZ)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        __m256 lowX = _mm256_loadu_ps(minX), lowY = _mm256_loadu_ps(minY), lowZ = _mm256_loadu_ps(minZ);
+        __m256 highX = _mm256_loadu_ps(maxX), highY = _mm256_loadu_ps(maxY), highZ = _mm256_loadu_ps(maxZ);
+        __m256 centerX = _mm256_mul_ps(_mm256_add_ps(lowX, highX), half), centerY = _mm256_mul_ps(_mm256_add_ps(lowY, highY), half);
+        __m256 centerZ = _mm256_mul_ps(_mm256_add_ps(lowZ, highZ), half);
+        __m256 extentX = _mm256_mul_ps(_mm256_sub_ps(highX, lowX), half), extentY = _mm256_mul_ps(_mm256_sub_ps(highY, lowY), half);
+        __m256 extentZ = _mm256_mul_ps(_mm256_sub_ps(highZ, lowZ), half);
+        __m256 outside = _mm256_setzero_ps();
+        for (int i = 0; i < 6; i++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes.a[i], centerX), _mm256_mul_ps(planes.b[i], centerY)),
+                _mm256_mul_ps(planes.c[i], centerZ)), planes.d[i]);
+            __m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes.absA[i], extentX), _mm256_mul_ps(planes.absB[i], extentY)),
+                _mm256_mul_ps(planes.absC[i], extentZ));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_sub_ps(_mm256_setzero_ps(), reach), _CMP_LT_OQ));
+        }
+        return (uint32_t)(~_mm256_movemask_ps(outside) & 0xFF);
+    }
+#endif
+}
+
+size_t FrustumCuller::CullSpheres(const float planes[6][4], const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+                                  size_t count, uint32_t* visibility, const Settings& settings)
+{
+    PlanesSse planesSse(planes);
+#if defined(__AVX__)
+    PlanesAvx planesAvx(planes);
+#endif
+    size_t visibleCount = 0;
+
+    for (size_t word = 0; word < GetMaskWordCount(count); word++)
+    {
+        size_t begin = word * 32;
+        size_t end = std::min(begin + 32, count);
+        size_t i = begin;
+        uint32_t bits = 0;
+
+        if (settings.useSimd)
+        {
+#if defined(__AVX__)
+            for (; i + 8 <= end; i += 8)
+            {
+                bits |= SpheresVisibleAvx(planesAvx, centerX + i, centerY + i, centerZ + i, radius + i) << (i - begin);
+            }
+#endif
+            for (; i + 4 <= end; i += 4)
+            {
+                bits |= SpheresVisibleSse(planesSse, centerX + i, centerY + i, centerZ + i, radius + i) << (i - begin);
+            }
+        }
+        for (; i < end; i++)
+        {
+            bits |= (uint32_t)SphereVisible(planes, centerX[i], centerY[i], centerZ[i], radius[i]) << (i - begin);
+        }
+
+        visibility[word] = bits;
+        visibleCount += CountBits(bits);
+    }
+
+    return visibleCount;
+}
+
+size_t FrustumCuller::CullBoxes(const float planes[6][4], const float* minX, const float* minY, const float* minZ,
+                                const float* maxX, const float* maxY, const float* maxZ, size_t count, uint32_t* visibility, const Settings& settings)
+{
+    PlanesSse planesSse(planes);
+#if defined(__AVX__)
+    PlanesAvx planesAvx(planes);
+#endif
+    size_t visibleCount = 0;
+
+    for (size_t word = 0; word < GetMaskWordCount(count); word++)
+    {
+        size_t begin = word * 32;
+        size_t end = std::min(begin + 32, count);
+        size_t i = begin;
+        uint32_t bits = 0;
+
+        if (settings.useSimd)
+        {
+#if defined(__AVX__)
+            for (; i + 8 <= end; i += 8)
+            {
+                bits |= BoxesVisibleAvx(planesAvx, minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i) << (i - begin);
+            }
+#endif
+            for (; i + 4 <= end; i += 4)
+            {
+                bits |= BoxesVisibleSse(planesSse, minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i) << (i - begin);
+            }
+        }
+        for (; i < end; i++)
+        {
+            bits |= (uint32_t)BoxVisible(planes, minX[i], minY[i], minZ[i], maxX[i], maxY[i], maxZ[i]) << (i - begin);
+        }
+
+        visibility[word] = bits;
+        visibleCount += CountBits(bits);
+    }
+
+    return visibleCount;
+}
+
+size_t FrustumCuller::CullBoxesToList(const float planes[6][4], const float* minX, const float* minY, const float* minZ,
+                                      const float* maxX, const float* maxY, const float* maxZ, size_t count, uint32_t* visibility,
+                                      std::vector<uint32_t>& visible, const Settings& settings)
+{
+    // Chunks start on a multiple of 32, so each one has its own mask words. Its
+    // list goes where its range starts in visible, which no other chunk writes.
+    size_t chunkSize = std::max<size_t>(32, settings.chunkSize / 32 * 32);
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    std::vector<size_t> chunkVisible(chunkCount);
+    visible.resize(count);
+
+    auto cullChunks = [&](size_t firstChunk, size_t lastChunk)
+    {
+        for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+        {
+            size_t begin = chunk * chunkSize;
+            size_t chunkLength = std::min(chunkSize, count - begin);
+            uint32_t* words = visibility + begin / 32;
+            CullBoxes(planes, minX + begin, minY + begin, minZ + begin, maxX + begin, maxY + begin, maxZ + begin, chunkLength, words, settings);
+
+            uint32_t* list = visible.data() + begin;
+            size_t listed = 0;
+            for (size_t word = 0; word < GetMaskWordCount(chunkLength); word++)
+            {
+                for (uint32_t bits = words[word]; bits != 0; bits &= bits - 1)
+                {
+                    list[listed++] = (uint32_t)(begin + word * 32) + LowestBit(bits);
+                }
+            }
+            chunkVisible[chunk] = listed;
+        }
+    };
+
+    if (settings.parallel)
+    {
+        JobSystem::GetInstance().ParallelFor(chunkCount, 1, cullChunks);
+    }
+    else
+    {
+        cullChunks(0, chunkCount);
+    }
+
+    // Join the lists in chunk order. Each one moves down, never over a list still to come.
+    size_t visibleCount = 0;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        if (chunkVisible[chunk] > 0 && visibleCount != chunk * chunkSize)
+        {
+            std::memmove(visible.data() + visibleCount, visible.data() + chunk * chunkSize, chunkVisible[chunk] * sizeof(uint32_t));
+        }
+        visibleCount += chunkVisible[chunk];
+    }
+    visible.resize(visibleCount);
+
+    return visibleCount;
+}
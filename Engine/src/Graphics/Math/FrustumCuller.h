@@ -0,0 +1,48 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tests whole arrays of bounding volumes against the six planes of a frustum.
+// - Planes are (a, b, c, d) with normalized normals pointing inside, the way
+//   Frustum builds them. A volume is culled when it lies entirely behind one.
+// - Volumes come as one array per component (SoA), so four of them are
+//   tested per SSE step, eight with AVX when the build targets it.
+// - The result is a bitmask, bit i % 32 of word i / 32 set when volume i may
+//   be visible. Bits past count in the last word are cleared. Callers that
+//   split the arrays into ranges start each one on a multiple of 32, so no
+//   two ranges write the same word.
+// - Boxes are tested in center/extent form, the box is outside when its
+//   center is further behind a plane than the box reaches towards it.
+class FrustumCuller
+{
+public:
+    struct Settings
+    {
+        bool useSimd = true;
+        bool parallel = true;           // CullBoxesToList only
+        size_t chunkSize = 1024;        // Volumes per job, rounded down to a multiple of 32
+    };
+
+public:
+    static size_t GetMaskWordCount(size_t count) { return (count + 31) / 32; }
+    static bool IsVisible(const uint32_t* visibility, size_t index) { return (visibility[index / 32] >> (index % 32)) & 1; }
+
+    // Both return the number of volumes that may be visible.
+    static size_t CullSpheres(const float planes[6][4], const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+                              size_t count, uint32_t* visibility, const Settings& settings);
+    static size_t CullBoxes(const float planes[6][4], const float* minX, const float* minY, const float* minZ,
+                            const float* maxX, const float* maxY, const float* maxZ, size_t count, uint32_t* visibility, const Settings& settings);
+
+    // CullBoxes, then the indices of the visible boxes in increasing order.
+    // Chunks of the arrays are culled and listed on the job system, each
+    // chunk's list is joined in chunk order, so the result does not depend
+    // on how the jobs were scheduled.
+    static size_t CullBoxesToList(const float planes[6][4], const float* minX, const float* minY, const float* minZ,
+                                  const float* maxX, const float* maxY, const float* maxZ, size_t count, uint32_t* visibility,
+                                  std::vector<uint32_t>& visible, const Settings& settings);
+};
+
+#endif // FRUSTUM_CULLER_H
@@ -1,4 +1,5 @@
 #include "font.h"
+#include "../Resource/ResourceCache.h"
 
 Font::Font()
 {
@@ -126,14 +127,9 @@ void Font::ReleaseFontData()
 
 bool Font::LoadTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename)
 {
-    bool result;
-
-
-    // Create and initialize the font texture object.
-    m_Texture = new Texture;
-
-    result = m_Texture->Initialize(device, deviceContext, filename);
-    if (!result)
+    // Get the font texture, shared by every font using the same file.
+    m_Texture = ResourceCache::GetInstance().AcquireTexture(device, deviceContext, filename);
+    if (!m_Texture)
     {
         return false;
     }
@@ -146,8 +142,7 @@ void Font::ReleaseTexture()
     // Release the texture object.
     if (m_Texture)
     {
-        m_Texture->Shutdown();
-        delete m_Texture;
+        ResourceCache::GetInstance().ReleaseTexture(m_Texture);
         m_Texture = 0;
     }
 
@@ -1,10 +1,13 @@
 #include "sprite.h"
+#include "../Resource/ResourceCache.h"
+#include <string>
+#include <vector>
 
 Sprite::Sprite()
 {
     m_vertexBuffer = 0;
     m_indexBuffer = 0;
-    m_Textures = 0;
+    m_Atlas = 0;
 }
 
 
@@ -109,7 +112,8 @@ int Sprite::GetIndexCount()
 
 ID3D11ShaderResourceView* Sprite::GetTexture()
 {
-    return m_Textures[m_currentTexture].GetTexture();
+    // Every frame is in the same atlas.
+    return m_Atlas->GetTexture();
 }
 
 bool Sprite::InitializeBuffers(ID3D11Device* device)
@@ -121,9 +125,10 @@ bool Sprite::InitializeBuffers(ID3D11Device* device)
     HRESULT result;
     int i;
 
-    // Initialize the previous rendering position to negative one.
+    // Initialize the previous rendering position and frame to negative one.
     m_prevPosX = -1;
     m_prevPosY = -1;
+    m_prevTexture = -1;
 
     // Set the number of vertices in the vertex array.
     m_vertexCount = 6;
@@ -217,21 +222,22 @@ void Sprite::ShutdownBuffers()
 
 bool Sprite::UpdateBuffers(ID3D11DeviceContext* deviceContent)
 {
-    float left, right, top, bottom;
+    float left, right, top, bottom, u0, u1, v0, v1;
     VertexType* vertices;
     D3D11_MAPPED_SUBRESOURCE mappedResource;
     VertexType* dataPtr;
     HRESULT result;
 
-    // If the position we are rendering this bitmap to hasn't changed then don't update the vertex buffer.
-    if ((m_prevPosX == m_renderX) && (m_prevPosY == m_renderY))
+    // If neither the position we are rendering this bitmap to nor the frame has changed then don't update the vertex buffer.
+    if ((m_prevPosX == m_renderX) && (m_prevPosY == m_renderY) && (m_prevTexture == m_currentTexture))
     {
         return true;
     }
 
-    // If the rendering location has changed then store the new position and update the vertex buffer.
+    // If the rendering location or frame has changed then store them and update the vertex buffer.
     m_prevPosX = m_renderX;
     m_prevPosY = m_renderY;
+    m_prevTexture = m_currentTexture;
 
     // Create the vertex array.
     vertices = new VertexType[m_vertexCount];
@@ -248,26 +254,33 @@ bool Sprite::UpdateBuffers(ID3D11DeviceContext* deviceContent)
     // Calculate the screen coordinates of the bottom of the bitmap.
     bottom = top - (float)m_bitmapHeight;
 
+    // The texture coordinates of the current frame within the atlas.
+    const TextureAtlas::Region& region = m_Atlas->GetRegion(m_currentTexture);
+    u0 = region.u0;
+    u1 = region.u1;
+    v0 = region.v0;
+    v1 = region.v1;
+
     // Load the vertex array with data.
     // First triangle.
     vertices[0].position = XMFLOAT3(left, top, 0.0f);  // Top left.
-    vertices[0].texture = XMFLOAT2(0.0f, 1.0f);
+    vertices[0].texture = XMFLOAT2(u0, v1);
 
     vertices[1].position = XMFLOAT3(right, bottom, 0.0f);  // Bottom right.
-    vertices[1].texture = XMFLOAT2(1.0f, 0.0f);
+    vertices[1].texture = XMFLOAT2(u1, v0);
 
     vertices[2].position = XMFLOAT3(left, bottom, 0.0f);  // Bottom left.
-    vertices[2].texture = XMFLOAT2(0.0f, 0.0f);
+    vertices[2].texture = XMFLOAT2(u0, v0);
 
     // Second triangle.
     vertices[3].position = XMFLOAT3(left, top, 0.0f);  // Top left.
-    vertices[3].texture = XMFLOAT2(0.0f, 1.0f);
+    vertices[3].texture = XMFLOAT2(u0, v1);
 
     vertices[4].position = XMFLOAT3(right, top, 0.0f);  // Top right.
-    vertices[4].texture = XMFLOAT2(1.0f, 1.0f);
+    vertices[4].texture = XMFLOAT2(u1, v1);
 
     vertices[5].position = XMFLOAT3(right, bottom, 0.0f);  // Bottom right.
-    vertices[5].texture = XMFLOAT2(1.0f, 0.0f);
+    vertices[5].texture = XMFLOAT2(u1, v0);
 
     // Lock the vertex buffer.
     result = deviceContent->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -320,10 +333,10 @@ void Sprite::RenderBuffers(ID3D11DeviceContext* deviceContext)
 bool Sprite::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename)
 {
     char textureFilename[128];
+    vector<string> textureFilenames;
     ifstream fin;
     int i, j;
     char input;
-    bool result;
 
     // Open the sprite info data file.
     fin.open(filename);
@@ -335,9 +348,6 @@ bool Sprite::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceConte
     // Read in the number of textures.
     fin >> m_textureCount;
 
-    // Create and initialize the texture object.
-    m_Textures = new Texture[m_textureCount];
-
     // Read to start of next line.
     fin.get(input);
 
@@ -354,12 +364,7 @@ bool Sprite::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceConte
         }
         textureFilename[j] = '\0';
 
-        // Once you have the filename then load the texture in the texture array.
-        result = m_Textures[i].Initialize(device, deviceContext, textureFilename);
-        if (!result)
-        {
-            return false;
-        }
+        textureFilenames.push_back(textureFilename);
     }
 
     // Read in the cycle time.
@@ -371,9 +376,16 @@ bool Sprite::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceConte
     // Close the file.
     fin.close();
 
-    // Get the dimensions of the first texture and use that as the dimensions of the 2D sprite images.
-    m_bitmapWidth = m_Textures[0].GetWidth();
-    m_bitmapHeight = m_Textures[0].GetHeight();
+    // Every frame comes from one atlas, cooked next to the sprite file and shared with other sprites of the same frames.
+    m_Atlas = ResourceCache::GetInstance().AcquireAtlas(device, deviceContext, filename, textureFilenames);
+    if (!m_Atlas)
+    {
+        return false;
+    }
+
+    // Get the dimensions of the first frame and use that as the dimensions of the 2D sprite images.
+    m_bitmapWidth = (int)m_Atlas->GetRegion(0).rect.width;
+    m_bitmapHeight = (int)m_Atlas->GetRegion(0).rect.height;
 
     // Set the starting texture in the cycle to be the first one in the list.
     m_currentTexture = 0;
@@ -383,19 +395,11 @@ bool Sprite::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceConte
 
 void Sprite::ReleaseTextures()
 {
-    int i;
-
-
-    // Release the texture objects.
-    if (m_Textures)
+    // Release the atlas holding the frames.
+    if (m_Atlas)
     {
-        for (i = 0; i < m_textureCount; i++)
-        {
-            m_Textures[i].Shutdown();
-        }
-
-        delete[] m_Textures;
-        m_Textures = 0;
+        ResourceCache::GetInstance().ReleaseAtlas(m_Atlas);
+        m_Atlas = 0;
     }
 
     return;
@@ -4,10 +4,14 @@
 #include <directxmath.h>
 #include <fstream>
 #include "../Resource/Texture.h"
+#include "../Resource/TextureAtlas.h"
 
 using namespace DirectX;
 using namespace std;
 
+// An animated 2D image. The frames are cooked into one atlas, shared by every
+// sprite with the same frames, so changing frames only changes the quad's
+// texture coordinates.
 class Sprite
 {
 private:
@@ -44,9 +48,9 @@ private:
 private:
     ID3D11Buffer* m_vertexBuffer, * m_indexBuffer;
     int m_vertexCount, m_indexCount, m_screenWidth, m_screenHeight, m_bitmapWidth, m_bitmapHeight, m_renderX, m_renderY, m_prevPosX, m_prevPosY;
-    Texture* m_Textures;
+    TextureAtlas* m_Atlas;
     float m_frameTime, m_cycleTime;
-    int m_currentTexture, m_textureCount;
+    int m_currentTexture, m_prevTexture, m_textureCount;
 };
 
 #endif
\ No newline at end of file
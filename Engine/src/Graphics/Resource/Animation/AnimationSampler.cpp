@@ -0,0 +1,223 @@
+#include "AnimationSampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	using VectorKey = AnimationTypes::VectorKey;
+	using RotationKey = AnimationTypes::RotationKey;
+
+	// Index of the last key at or before time, and the blend towards the next one.
+	template<typename Key>
+	size_t FindKey(const std::vector<Key>& keys, float time, float& blend)
+	{
+		auto next = std::upper_bound(keys.begin(), keys.end(), time, [](float t, const Key& key) { return t < key.time; });
+		if (next == keys.begin())
+		{
+			blend = 0.0f;
+			return 0;
+		}
+		if (next == keys.end())
+		{
+			blend = 0.0f;
+			return keys.size() - 1;
+		}
+
+		size_t index = (size_t)(next - keys.begin()) - 1;
+		float span = next->time - keys[index].time;
+		blend = span > 0.0f ? (time - keys[index].time) / span : 0.0f;
+		return index;
+	}
+
+	void SampleVector(const std::vector<VectorKey>& keys, float time, float* out)
+	{
+		float blend;
+		size_t index = FindKey(keys, time, blend);
+		const float* a = keys[index].value;
+		const float* b = keys[std::min(index + 1, keys.size() - 1)].value;
+		for (int i = 0; i < 3; i++)
+		{
+			out[i] = a[i] + (b[i] - a[i]) * blend;
+		}
+	}
+
+	void SampleRotation(const std::vector<RotationKey>& keys, float time, float* out)
+	{
+		float blend;
+		size_t index = FindKey(keys, time, blend);
+		const float* a = keys[index].value;
+		const float* b = keys[std::min(index + 1, keys.size() - 1)].value;
+
+		// Keys a frame apart are close, nlerp is indistinguishable from slerp there.
+		float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+		float sign = dot < 0.0f ? -1.0f : 1.0f;
+		float lengthSq = 0.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			out[i] = a[i] + (b[i] * sign - a[i]) * blend;
+			lengthSq += out[i] * out[i];
+		}
+
+		float invLength = lengthSq > 0.0f ? 1.0f / std::sqrt(lengthSq) : 0.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			out[i] *= invLength;
+		}
+	}
+}
+
+void AnimationSampler::SampleClip(const AnimationClip& clip, const Skeleton& skeleton, float time, bool loop, Transform* localPose)
+{
+	size_t jointCount = skeleton.joints.size();
+	for (size_t joint = 0; joint < jointCount; joint++)
+	{
+		localPose[joint] = skeleton.joints[joint].bindLocal;
+	}
+
+	time = NormalizeTime(time, clip.duration, loop);
+
+	for (const AnimationTypes::JointTrack& track : clip.tracks)
+	{
+		if (track.joint >= jointCount)
+		{
+			continue;
+		}
+
+		Transform& transform = localPose[track.joint];
+		if (!track.translations.empty())
+		{
+			SampleVector(track.translations, time, transform.translation);
+		}
+		if (!track.rotations.empty())
+		{
+			SampleRotation(track.rotations, time, transform.rotation);
+		}
+		if (!track.scales.empty())
+		{
+			SampleVector(track.scales, time, transform.scale);
+		}
+	}
+}
+
+void AnimationSampler::ComputeModelPose(const Skeleton& skeleton, const Transform* localPose, JointMatrix* modelPose)
+{
+	JointMatrix local;
+	for (size_t joint = 0; joint < skeleton.joints.size(); joint++)
+	{
+		int parent = skeleton.joints[joint].parent;
+		if (parent < 0)
+		{
+			ToMatrix(localPose[joint], modelPose[joint]);
+			continue;
+		}
+
+		ToMatrix(localPose[joint], local);
+		Multiply(modelPose[parent], local, modelPose[joint]);
+	}
+}
+
+void AnimationSampler::ComputeSkinningPalette(const Skeleton& skeleton, const JointMatrix* modelPose, JointMatrix* palette)
+{
+	for (size_t joint = 0; joint < skeleton.joints.size(); joint++)
+	{
+		Multiply(modelPose[joint], skeleton.joints[joint].inverseBind, palette[joint]);
+	}
+}
+
+void AnimationSampler::ToMatrix(const Transform& transform, JointMatrix& matrix)
+{
+	float x = transform.rotation[0], y = transform.rotation[1], z = transform.rotation[2], w = transform.rotation[3];
+	const float* s = transform.scale;
+
+	// Rotation times scale, the scale applies along the joint's own axes.
+	matrix.m[0][0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+	matrix.m[0][1] = (2.0f * (x * y - z * w)) * s[1];
+	matrix.m[0][2] = (2.0f * (x * z + y * w)) * s[2];
+	matrix.m[1][0] = (2.0f * (x * y + z * w)) * s[0];
+	matrix.m[1][1] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+	matrix.m[1][2] = (2.0f * (y * z - x * w)) * s[2];
+	matrix.m[2][0] = (2.0f * (x * z - y * w)) * s[0];
+	matrix.m[2][1] = (2.0f * (y * z + x * w)) * s[1];
+	matrix.m[2][2] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+
+	matrix.m[0][3] = transform.translation[0];
+	matrix.m[1][3] = transform.translation[1];
+	matrix.m[2][3] = transform.translation[2];
+}
+
+void AnimationSampler::Multiply(const JointMatrix& a, const JointMatrix& b, JointMatrix& out)
+{
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			out.m[row][column] = a.m[row][0] * b.m[0][column] + a.m[row][1] * b.m[1][column] + a.m[row][2] * b.m[2][column];
+		}
+		out.m[row][3] += a.m[row][3];
+	}
+}
+
+void AnimationSampler::Identity(JointMatrix& matrix)
+{
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			matrix.m[row][column] = row == column ? 1.0f : 0.0f;
+		}
+	}
+}
+
+bool AnimationSampler::Invert(const JointMatrix& matrix, JointMatrix& out)
+{
+	const float (*m)[4] = matrix.m;
+
+	float cofactor[3][3];
+	cofactor[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+	cofactor[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+	cofactor[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+	cofactor[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+	cofactor[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+	cofactor[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+	cofactor[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+	cofactor[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+	cofactor[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+
+	float determinant = m[0][0] * cofactor[0][0] + m[0][1] * cofactor[0][1] + m[0][2] * cofactor[0][2];
+	if (std::fabs(determinant) < 1.0e-12f)
+	{
+		return false;
+	}
+
+	// The inverse of the 3x3 part is the transposed cofactor matrix over the determinant.
+	float invDeterminant = 1.0f / determinant;
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			out.m[row][column] = cofactor[column][row] * invDeterminant;
+		}
+	}
+	for (int row = 0; row < 3; row++)
+	{
+		out.m[row][3] = -(out.m[row][0] * m[0][3] + out.m[row][1] * m[1][3] + out.m[row][2] * m[2][3]);
+	}
+
+	return true;
+}
+
+float AnimationSampler::NormalizeTime(float time, float duration, bool loop)
+{
+	if (duration <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	if (loop)
+	{
+		time = std::fmod(time, duration);
+		return time < 0.0f ? time + duration : time;
+	}
+
+	return std::min(std::max(time, 0.0f), duration);
+}
@@ -0,0 +1,43 @@
+#ifndef ANIMATION_SAMPLER_H
+#define ANIMATION_SAMPLER_H
+
+#include <cstddef>
+
+#include "AnimationTypes.h"
+
+// Pose evaluation, from clip keys to the matrix palette the skinning reads.
+// - SampleClip interpolates each channel between its two surrounding keys,
+//   translations and scales linearly, rotations by normalized lerp along the
+//   shorter arc.
+// - ComputeModelPose composes the local transforms down the hierarchy.
+// - ComputeSkinningPalette multiplies in the inverse bind matrices, so the
+//   palette takes bind pose mesh vertices to the animated pose.
+class AnimationSampler
+{
+public:
+	using Transform = AnimationTypes::Transform;
+	using JointMatrix = AnimationTypes::JointMatrix;
+	using Skeleton = AnimationTypes::Skeleton;
+	using AnimationClip = AnimationTypes::AnimationClip;
+
+public:
+	// Writes one local transform per joint. time is wrapped into the clip if
+	// loop is set and clamped otherwise.
+	static void SampleClip(const AnimationClip& clip, const Skeleton& skeleton, float time, bool loop, Transform* localPose);
+
+	// localPose and modelPose hold one entry per joint.
+	static void ComputeModelPose(const Skeleton& skeleton, const Transform* localPose, JointMatrix* modelPose);
+	static void ComputeSkinningPalette(const Skeleton& skeleton, const JointMatrix* modelPose, JointMatrix* palette);
+
+	static void ToMatrix(const Transform& transform, JointMatrix& matrix);
+	// out = a * b, b is applied first. out may not alias a or b.
+	static void Multiply(const JointMatrix& a, const JointMatrix& b, JointMatrix& out);
+	static void Identity(JointMatrix& matrix);
+	// Inverse of an affine transform, false if it is singular.
+	static bool Invert(const JointMatrix& matrix, JointMatrix& out);
+
+	// Wraps or clamps time into [0, duration].
+	static float NormalizeTime(float time, float duration, bool loop);
+};
+
+#endif // ANIMATION_SAMPLER_H
@@ -0,0 +1,130 @@
+#ifndef ANIMATION_TYPES_H
+#define ANIMATION_TYPES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU-side skeleton, skin and animation data. Like MeshTypes these avoid
+// D3D/DirectXMath so sampling and skinning can be built and benchmarked
+// headless.
+namespace AnimationTypes
+{
+	// Joint transform relative to its parent. rotation is a unit quaternion (x, y, z, w).
+	struct Transform
+	{
+		float translation[3];
+		float rotation[4];
+		float scale[3];
+	};
+
+	// Affine transform with the rows of a 3x4 matrix, p' = m * (p, 1).
+	// Rows load as aligned float4s for the SIMD skinning loop.
+	struct alignas(16) JointMatrix
+	{
+		float m[3][4];
+	};
+
+	// Joints are stored parents first, so a single pass in order can compose
+	// the model space pose.
+	struct Joint
+	{
+		std::string name;
+		int parent;                 // -1 for roots
+		Transform bindLocal;        // Used by joints an animation does not touch
+		JointMatrix inverseBind;    // Mesh space to joint space at bind time
+	};
+
+	struct Skeleton
+	{
+		std::vector<Joint> joints;
+	};
+
+	// Up to four joints per vertex with weights that sum to one. Unused
+	// slots have weight zero and joint zero.
+	static const int MAX_INFLUENCES = 4;
+
+	struct SkinInfluence
+	{
+		uint16_t joints[MAX_INFLUENCES];
+		float weights[MAX_INFLUENCES];
+	};
+
+	struct VectorKey
+	{
+		float time;
+		float value[3];
+	};
+
+	struct RotationKey
+	{
+		float time;
+		float value[4];
+	};
+
+	// Keys of one joint, sorted by time. An empty channel keeps the bind value.
+	struct JointTrack
+	{
+		uint32_t joint;
+		std::vector<VectorKey> translations;
+		std::vector<RotationKey> rotations;
+		std::vector<VectorKey> scales;
+	};
+
+	struct AnimationClip
+	{
+		std::string name;
+		float duration;             // Seconds
+		std::vector<JointTrack> tracks;
+	};
+
+	// Clip in the compact form ClipCompressor writes, see there for the layout.
+	enum ChannelMode : uint8_t
+	{
+		CHANNEL_BIND = 0,           // Never differs from the bind pose, nothing stored
+		CHANNEL_CONSTANT = 1,       // One value for the whole clip
+		CHANNEL_ANIMATED = 2        // Keys in every segment
+	};
+
+	enum Channel
+	{
+		CHANNEL_TRANSLATION = 0,
+		CHANNEL_ROTATION,
+		CHANNEL_SCALE,
+		CHANNEL_COUNT
+	};
+
+	struct CompressedTrack
+	{
+		uint32_t joint;
+		uint8_t modes[CHANNEL_COUNT];
+		float constants[CHANNEL_COUNT][4];
+		// Dequantization of translation and scale keys: value = min + unorm16 * extent
+		float rangeMin[CHANNEL_COUNT][3];
+		float rangeExtent[CHANNEL_COUNT][3];
+	};
+
+	// Frames [startFrame, startFrame + frameCount] of every animated channel,
+	// the last frame is shared with the next segment.
+	struct CompressedSegment
+	{
+		uint32_t startFrame;
+		uint32_t frameCount;
+		uint32_t dataOffset;        // Into CompressedClip::data
+	};
+
+	struct CompressedClip
+	{
+		std::string name;
+		float duration = 0.0f;
+		float sampleRate = 30.0f;   // Frames per second
+		uint32_t frameCount = 0;
+		uint32_t segmentFrames = 0;
+		uint32_t animatedChannels = 0;
+		std::vector<CompressedTrack> tracks;
+		std::vector<CompressedSegment> segments;
+		std::vector<uint8_t> data;
+	};
+}
+
+#endif // ANIMATION_TYPES_H
@@ -0,0 +1,122 @@
+#include "CharacterAnimator.h"
+#include "AnimationSampler.h"
+#include "ClipCompressor.h"
+#include "../../../Core/System/JobSystem.h"
+#include <chrono>
+
+CharacterAnimator::CharacterAnimator()
+{
+	m_skeleton = nullptr;
+	m_streams = nullptr;
+	m_clip = nullptr;
+	m_compressedClip = nullptr;
+	m_loop = true;
+	m_time = 0.0f;
+}
+
+CharacterAnimator::~CharacterAnimator()
+{
+}
+
+bool CharacterAnimator::Initialize(const Skeleton* skeleton, const Skinning::Streams* streams)
+{
+	if (!skeleton || !streams || skeleton->joints.empty())
+	{
+		return false;
+	}
+
+	m_skeleton = skeleton;
+	m_streams = streams;
+	m_clip = nullptr;
+	m_compressedClip = nullptr;
+	m_time = 0.0f;
+
+	size_t jointCount = skeleton->joints.size();
+	m_localPose.resize(jointCount);
+	m_modelPose.resize(jointCount);
+	m_palette.resize(jointCount);
+
+	return true;
+}
+
+void CharacterAnimator::SetClip(const AnimationClip* clip, bool loop)
+{
+	m_clip = clip;
+	m_compressedClip = nullptr;
+	m_loop = loop;
+	m_time = 0.0f;
+}
+
+void CharacterAnimator::SetClip(const CompressedClip* clip, bool loop)
+{
+	m_clip = nullptr;
+	m_compressedClip = clip;
+	m_loop = loop;
+	m_time = 0.0f;
+}
+
+void CharacterAnimator::Update(float deltaTime, const Skinning::Settings& settings)
+{
+	if (!m_skeleton)
+	{
+		return;
+	}
+
+	if (m_clip)
+	{
+		m_time = AnimationSampler::NormalizeTime(m_time + deltaTime, m_clip->duration, m_loop);
+		AnimationSampler::SampleClip(*m_clip, *m_skeleton, m_time, m_loop, m_localPose.data());
+	}
+	else if (m_compressedClip)
+	{
+		m_time = AnimationSampler::NormalizeTime(m_time + deltaTime, m_compressedClip->duration, m_loop);
+		ClipCompressor::SampleClip(*m_compressedClip, *m_skeleton, m_time, m_loop, m_localPose.data());
+	}
+	else
+	{
+		for (size_t joint = 0; joint < m_skeleton->joints.size(); joint++)
+		{
+			m_localPose[joint] = m_skeleton->joints[joint].bindLocal;
+		}
+	}
+
+	AnimationSampler::ComputeModelPose(*m_skeleton, m_localPose.data(), m_modelPose.data());
+	AnimationSampler::ComputeSkinningPalette(*m_skeleton, m_modelPose.data(), m_palette.data());
+	Skinning::Skin(m_palette.data(), *m_streams, m_skinned, settings);
+}
+
+void CharacterAnimator::UpdateAll(CharacterAnimator* const* characters, size_t count, float deltaTime, const Skinning::Settings& settings, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	JobSystem::GetInstance().ParallelFor(count, 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			characters[i]->Update(deltaTime, settings);
+		}
+	});
+
+	if (stats)
+	{
+		Stats localStats;
+		localStats.characterCount = count;
+		localStats.simd = settings.useSimd;
+		for (size_t i = 0; i < count; i++)
+		{
+			localStats.jointCount += characters[i]->m_skeleton ? characters[i]->m_skeleton->joints.size() : 0;
+			localStats.vertexCount += characters[i]->m_streams ? characters[i]->m_streams->vertexCount : 0;
+		}
+		localStats.updateTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		*stats = localStats;
+	}
+}
+
+std::string CharacterAnimator::FormatStats(const Stats& stats)
+{
+	double verticesPerSecond = stats.updateTimeMs > 0.0 ? (double)stats.vertexCount / (stats.updateTimeMs / 1000.0) : 0.0;
+
+	return "Character animation: " + std::to_string(stats.characterCount) + " characters, " + std::to_string(stats.jointCount) + " joints, " +
+		std::to_string(stats.vertexCount) + " vertices skinned with " + (stats.simd ? Skinning::GetInstructionSet() : "scalar code") + " in " + std::to_string(stats.updateTimeMs) + " ms (" +
+		std::to_string(verticesPerSecond / 1.0e6) + " M vertices/s)";
+}
@@ -0,0 +1,73 @@
+#ifndef CHARACTER_ANIMATOR_H
+#define CHARACTER_ANIMATOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "AnimationTypes.h"
+#include "Skinning.h"
+
+// Plays a clip on one skinned character: samples the pose, builds the matrix
+// palette and skins the character's vertices every update. Skeleton, clip
+// and bind pose streams are shared, only the pose and the skinned output
+// belong to the character.
+class CharacterAnimator
+{
+public:
+	using Skeleton = AnimationTypes::Skeleton;
+	using AnimationClip = AnimationTypes::AnimationClip;
+	using CompressedClip = AnimationTypes::CompressedClip;
+	using Transform = AnimationTypes::Transform;
+	using JointMatrix = AnimationTypes::JointMatrix;
+
+	struct Stats
+	{
+		size_t characterCount = 0;
+		size_t jointCount = 0;
+		size_t vertexCount = 0;
+		bool simd = false;
+		double updateTimeMs = 0.0;
+	};
+
+public:
+	CharacterAnimator();
+	~CharacterAnimator();
+
+	// The skeleton and streams must outlive the animator.
+	bool Initialize(const Skeleton* skeleton, const Skinning::Streams* streams);
+
+	// Either form of clip can play, setting one clears the other.
+	void SetClip(const AnimationClip* clip, bool loop = true);
+	void SetClip(const CompressedClip* clip, bool loop = true);
+	void SetTime(float time) { m_time = time; }
+	float GetTime() const { return m_time; }
+
+	// Advances the clip and skins the vertices for the new pose. Without a
+	// clip the character is skinned in its bind pose.
+	void Update(float deltaTime, const Skinning::Settings& settings);
+
+	const Skinning::SkinnedVertices& GetSkinnedVertices() const { return m_skinned; }
+	const JointMatrix* GetPalette() const { return m_palette.data(); }
+
+	// Updates every character, spread over the job system one character per
+	// job, so the result does not depend on the thread count.
+	static void UpdateAll(CharacterAnimator* const* characters, size_t count, float deltaTime, const Skinning::Settings& settings, Stats* stats = nullptr);
+
+	static std::string FormatStats(const Stats& stats);
+
+private:
+	const Skeleton* m_skeleton;
+	const Skinning::Streams* m_streams;
+	const AnimationClip* m_clip;
+	const CompressedClip* m_compressedClip;
+	bool m_loop;
+	float m_time;
+
+	std::vector<Transform> m_localPose;
+	std::vector<JointMatrix> m_modelPose;
+	std::vector<JointMatrix> m_palette;
+	Skinning::SkinnedVertices m_skinned;
+};
+
+#endif // CHARACTER_ANIMATOR_H
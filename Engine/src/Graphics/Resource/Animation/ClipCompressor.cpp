@@ -0,0 +1,582 @@
+#include "ClipCompressor.h"
+#include "AnimationSampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	using Transform = AnimationTypes::Transform;
+	using CompressedTrack = AnimationTypes::CompressedTrack;
+
+	// Smallest three components lie within +-1/sqrt(2).
+	const float SMALLEST_THREE_RANGE = 0.70710678f;
+	const float SMALLEST_THREE_STEPS = 32767.0f;
+	const float RANGE_STEPS = 65535.0f;
+
+	int GetComponentCount(int channel)
+	{
+		return channel == AnimationTypes::CHANNEL_ROTATION ? 4 : 3;
+	}
+
+	const float* GetChannel(const Transform& transform, int channel)
+	{
+		switch (channel)
+		{
+		case AnimationTypes::CHANNEL_TRANSLATION: return transform.translation;
+		case AnimationTypes::CHANNEL_ROTATION: return transform.rotation;
+		default: return transform.scale;
+		}
+	}
+
+	float* GetChannel(Transform& transform, int channel)
+	{
+		return const_cast<float*>(GetChannel(static_cast<const Transform&>(transform), channel));
+	}
+
+	// Distance between two values of a channel in the unit its tolerance uses.
+	float ChannelError(int channel, const float* a, const float* b)
+	{
+		if (channel == AnimationTypes::CHANNEL_ROTATION)
+		{
+			// q and -q are the same rotation. The chord length keeps its precision
+			// for tiny angles where acos of the dot product would not.
+			float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+			float sign = dot < 0.0f ? -1.0f : 1.0f;
+			float chordSq = 0.0f;
+			for (int i = 0; i < 4; i++)
+			{
+				float difference = a[i] - b[i] * sign;
+				chordSq += difference * difference;
+			}
+			return 4.0f * std::asin(std::min(1.0f, std::sqrt(chordSq) * 0.5f));
+		}
+
+		if (channel == AnimationTypes::CHANNEL_TRANSLATION)
+		{
+			float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+			return std::sqrt(dx * dx + dy * dy + dz * dz);
+		}
+
+		return std::max(std::fabs(a[0] - b[0]), std::max(std::fabs(a[1] - b[1]), std::fabs(a[2] - b[2])));
+	}
+
+	// Interpolates like AnimationSampler, so the compressor measures what playback produces.
+	void BlendValues(int channel, const float* a, const float* b, float blend, float* out)
+	{
+		if (channel != AnimationTypes::CHANNEL_ROTATION)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				out[i] = a[i] + (b[i] - a[i]) * blend;
+			}
+			return;
+		}
+
+		float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+		float sign = dot < 0.0f ? -1.0f : 1.0f;
+		float lengthSq = 0.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			out[i] = a[i] + (b[i] * sign - a[i]) * blend;
+			lengthSq += out[i] * out[i];
+		}
+
+		float invLength = lengthSq > 0.0f ? 1.0f / std::sqrt(lengthSq) : 0.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			out[i] *= invLength;
+		}
+	}
+
+	// The index of the dropped component goes into the spare top bits of the first two words.
+	void EncodeRotation(const float* rotation, uint16_t* out)
+	{
+		int largest = 0;
+		for (int i = 1; i < 4; i++)
+		{
+			if (std::fabs(rotation[i]) > std::fabs(rotation[largest]))
+			{
+				largest = i;
+			}
+		}
+
+		// Flip to make the dropped component positive, it is rebuilt as a square root.
+		float sign = rotation[largest] < 0.0f ? -1.0f : 1.0f;
+		int word = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			if (i == largest)
+			{
+				continue;
+			}
+
+			float unit = (rotation[i] * sign / SMALLEST_THREE_RANGE) * 0.5f + 0.5f;
+			unit = std::min(1.0f, std::max(0.0f, unit));
+			out[word++] = (uint16_t)std::lround(unit * SMALLEST_THREE_STEPS);
+		}
+
+		out[0] |= (uint16_t)((largest & 1) << 15);
+		out[1] |= (uint16_t)((largest >> 1) << 15);
+	}
+
+	void DecodeRotation(const uint16_t* in, float* rotation)
+	{
+		int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+		float sumSq = 0.0f;
+		int word = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			if (i == largest)
+			{
+				continue;
+			}
+
+			float unit = (float)(in[word++] & 0x7FFF) / SMALLEST_THREE_STEPS;
+			rotation[i] = (unit * 2.0f - 1.0f) * SMALLEST_THREE_RANGE;
+			sumSq += rotation[i] * rotation[i];
+		}
+
+		rotation[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSq));
+	}
+
+	void EncodeVector(const float* value, const float* rangeMin, const float* rangeExtent, uint16_t* out)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			float unit = rangeExtent[i] > 0.0f ? (value[i] - rangeMin[i]) / rangeExtent[i] : 0.0f;
+			unit = std::min(1.0f, std::max(0.0f, unit));
+			out[i] = (uint16_t)std::lround(unit * RANGE_STEPS);
+		}
+	}
+
+	void DecodeVector(const uint16_t* in, const float* rangeMin, const float* rangeExtent, float* value)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			value[i] = rangeMin[i] + (float)in[i] * (1.0f / RANGE_STEPS) * rangeExtent[i];
+		}
+	}
+
+	void DecodeKey(const CompressedTrack& track, int channel, const uint16_t* key, float* value)
+	{
+		if (channel == AnimationTypes::CHANNEL_ROTATION)
+		{
+			DecodeRotation(key, value);
+		}
+		else
+		{
+			DecodeVector(key, track.rangeMin[channel], track.rangeExtent[channel], value);
+		}
+	}
+
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Every animated channel in the order the segments store them.
+	struct ChannelRef
+	{
+		size_t track;
+		int channel;
+	};
+}
+
+bool ClipCompressor::Compress(const AnimationClip& clip, const Skeleton& skeleton, const Settings& settings, CompressedClip& outClip, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	size_t jointCount = skeleton.joints.size();
+	if (jointCount == 0 || clip.duration < 0.0f || settings.segmentFrames == 0 || settings.segmentFrames > 255)
+	{
+		return false;
+	}
+
+	// Resample at a fixed rate, by default as densely as the source keys.
+	size_t sourceKeys = 0;
+	size_t sourceBytes = 0;
+	size_t densestTrack = 0;
+	for (const AnimationTypes::JointTrack& track : clip.tracks)
+	{
+		sourceKeys += track.translations.size() + track.rotations.size() + track.scales.size();
+		sourceBytes += (track.translations.size() + track.scales.size()) * sizeof(AnimationTypes::VectorKey) + track.rotations.size() * sizeof(AnimationTypes::RotationKey);
+		densestTrack = std::max(densestTrack, std::max(track.translations.size(), std::max(track.rotations.size(), track.scales.size())));
+	}
+
+	float sampleRate = settings.sampleRate;
+	if (sampleRate <= 0.0f)
+	{
+		sampleRate = clip.duration > 0.0f && densestTrack > 1 ? (float)(densestTrack - 1) / clip.duration : 30.0f;
+	}
+
+	// Stretch the rate slightly so the last frame lands exactly on the end of the clip.
+	uint32_t lastFrame = 0;
+	if (clip.duration > 0.0f)
+	{
+		lastFrame = std::max(1u, (uint32_t)std::ceil(clip.duration * sampleRate - 0.001f));
+		sampleRate = (float)lastFrame / clip.duration;
+	}
+	uint32_t frameCount = lastFrame + 1;
+
+	std::vector<Transform> poses((size_t)frameCount * jointCount);
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		float time = std::min((float)frame / sampleRate, clip.duration);
+		Transform* pose = &poses[(size_t)frame * jointCount];
+		AnimationSampler::SampleClip(clip, skeleton, time, false, pose);
+
+		// Keep each joint's rotations in one hemisphere so the range of the
+		// components stays small and neighbours interpolate the short way.
+		if (frame == 0)
+		{
+			continue;
+		}
+		const Transform* previous = pose - jointCount;
+		for (size_t joint = 0; joint < jointCount; joint++)
+		{
+			float* rotation = pose[joint].rotation;
+			const float* previousRotation = previous[joint].rotation;
+			float dot = rotation[0] * previousRotation[0] + rotation[1] * previousRotation[1] + rotation[2] * previousRotation[2] + rotation[3] * previousRotation[3];
+			if (dot < 0.0f)
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					rotation[i] = -rotation[i];
+				}
+			}
+		}
+	}
+
+	const float tolerances[AnimationTypes::CHANNEL_COUNT] = { settings.translationTolerance, settings.rotationTolerance, settings.scaleTolerance };
+
+	outClip = CompressedClip();
+	outClip.name = clip.name;
+	outClip.duration = clip.duration;
+	outClip.sampleRate = sampleRate;
+	outClip.frameCount = frameCount;
+	outClip.segmentFrames = settings.segmentFrames;
+
+	Stats localStats;
+	localStats.frameCount = frameCount;
+	localStats.sourceKeys = sourceKeys;
+	localStats.sourceBytes = sourceBytes;
+
+	// Classify the channels and quantize every frame of the animated ones.
+	std::vector<ChannelRef> animated;
+	std::vector<std::vector<uint16_t>> quantized;
+	std::vector<std::vector<float>> decoded;
+	std::vector<bool> jointUsed(jointCount, false);
+	for (const AnimationTypes::JointTrack& sourceTrack : clip.tracks)
+	{
+		if (sourceTrack.joint >= jointCount || jointUsed[sourceTrack.joint])
+		{
+			continue;
+		}
+		jointUsed[sourceTrack.joint] = true;
+
+		CompressedTrack track = {};
+		track.joint = sourceTrack.joint;
+		const Transform& bind = skeleton.joints[track.joint].bindLocal;
+
+		for (int channel = 0; channel < AnimationTypes::CHANNEL_COUNT; channel++)
+		{
+			int components = GetComponentCount(channel);
+			const float* first = GetChannel(poses[track.joint], channel);
+
+			bool atBind = true;
+			bool constant = true;
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				const float* value = GetChannel(poses[(size_t)frame * jointCount + track.joint], channel);
+				atBind = atBind && ChannelError(channel, value, GetChannel(bind, channel)) <= tolerances[channel];
+				constant = constant && ChannelError(channel, value, first) <= tolerances[channel];
+			}
+
+			if (atBind)
+			{
+				track.modes[channel] = AnimationTypes::CHANNEL_BIND;
+				localStats.bindChannels++;
+				continue;
+			}
+			if (constant)
+			{
+				track.modes[channel] = AnimationTypes::CHANNEL_CONSTANT;
+				std::copy(first, first + components, track.constants[channel]);
+				localStats.constantChannels++;
+				continue;
+			}
+
+			track.modes[channel] = AnimationTypes::CHANNEL_ANIMATED;
+			localStats.animatedChannels++;
+
+			if (channel != AnimationTypes::CHANNEL_ROTATION)
+			{
+				float rangeMax[3];
+				std::copy(first, first + 3, track.rangeMin[channel]);
+				std::copy(first, first + 3, rangeMax);
+				for (uint32_t frame = 1; frame < frameCount; frame++)
+				{
+					const float* value = GetChannel(poses[(size_t)frame * jointCount + track.joint], channel);
+					for (int i = 0; i < 3; i++)
+					{
+						track.rangeMin[channel][i] = std::min(track.rangeMin[channel][i], value[i]);
+						rangeMax[i] = std::max(rangeMax[i], value[i]);
+					}
+				}
+				for (int i = 0; i < 3; i++)
+				{
+					track.rangeExtent[channel][i] = rangeMax[i] - track.rangeMin[channel][i];
+				}
+			}
+
+			std::vector<uint16_t> keys((size_t)frameCount * 3);
+			std::vector<float> values((size_t)frameCount * 4);
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				const float* value = GetChannel(poses[(size_t)frame * jointCount + track.joint], channel);
+				uint16_t* key = &keys[(size_t)frame * 3];
+				if (channel == AnimationTypes::CHANNEL_ROTATION)
+				{
+					EncodeRotation(value, key);
+				}
+				else
+				{
+					EncodeVector(value, track.rangeMin[channel], track.rangeExtent[channel], key);
+				}
+				DecodeKey(track, channel, key, &values[(size_t)frame * 4]);
+			}
+
+			animated.push_back({ outClip.tracks.size(), channel });
+			quantized.push_back(std::move(keys));
+			decoded.push_back(std::move(values));
+		}
+
+		outClip.tracks.push_back(track);
+	}
+	outClip.animatedChannels = (uint32_t)animated.size();
+
+	// Segment layout: one offset per animated channel, relative to the segment,
+	// then a block per channel of key count, key frames and 16 bit key words.
+	std::vector<uint8_t>& data = outClip.data;
+	std::vector<uint8_t> keyFrames;
+	for (uint32_t start = 0; ; start += settings.segmentFrames)
+	{
+		AnimationTypes::CompressedSegment segment;
+		segment.startFrame = start;
+		segment.frameCount = std::min(settings.segmentFrames, lastFrame - start);
+
+		data.resize(AlignUp(data.size(), 4));
+		segment.dataOffset = (uint32_t)data.size();
+		data.resize(data.size() + animated.size() * sizeof(uint32_t));
+
+		for (size_t channelIndex = 0; channelIndex < animated.size(); channelIndex++)
+		{
+			const ChannelRef& ref = animated[channelIndex];
+			const CompressedTrack& track = outClip.tracks[ref.track];
+			const std::vector<float>& values = decoded[channelIndex];
+
+			// Greedily extend each key span as far as interpolating the two end
+			// keys stays within tolerance of every source frame in between.
+			keyFrames.assign(1, 0);
+			uint32_t anchor = 0;
+			while (anchor < segment.frameCount)
+			{
+				uint32_t best = anchor + 1;
+				for (uint32_t end = anchor + 2; end <= segment.frameCount; end++)
+				{
+					const float* a = &values[(size_t)(start + anchor) * 4];
+					const float* b = &values[(size_t)(start + end) * 4];
+					bool withinTolerance = true;
+					for (uint32_t frame = anchor + 1; frame < end && withinTolerance; frame++)
+					{
+						float blended[4];
+						BlendValues(ref.channel, a, b, (float)(frame - anchor) / (float)(end - anchor), blended);
+						const float* source = GetChannel(poses[(size_t)(start + frame) * jointCount + track.joint], ref.channel);
+						withinTolerance = ChannelError(ref.channel, blended, source) <= tolerances[ref.channel];
+					}
+					if (!withinTolerance)
+					{
+						break;
+					}
+					best = end;
+				}
+
+				keyFrames.push_back((uint8_t)best);
+				anchor = best;
+			}
+
+			size_t blockOffset = AlignUp(data.size(), 4);
+			uint32_t relativeOffset = (uint32_t)(blockOffset - segment.dataOffset);
+			std::memcpy(&data[segment.dataOffset + channelIndex * sizeof(uint32_t)], &relativeOffset, sizeof(uint32_t));
+
+			size_t valuesOffset = blockOffset + AlignUp(1 + keyFrames.size(), 2);
+			data.resize(valuesOffset + keyFrames.size() * 3 * sizeof(uint16_t));
+			data[blockOffset] = (uint8_t)keyFrames.size();
+			std::copy(keyFrames.begin(), keyFrames.end(), data.begin() + blockOffset + 1);
+			for (size_t key = 0; key < keyFrames.size(); key++)
+			{
+				const uint16_t* words = &quantized[channelIndex][(size_t)(start + keyFrames[key]) * 3];
+				std::memcpy(&data[valuesOffset + key * 3 * sizeof(uint16_t)], words, 3 * sizeof(uint16_t));
+			}
+
+			localStats.storedKeys += keyFrames.size();
+		}
+
+		outClip.segments.push_back(segment);
+		if (start + segment.frameCount >= lastFrame)
+		{
+			break;
+		}
+	}
+
+	localStats.segmentCount = outClip.segments.size();
+	localStats.compressedBytes = data.size() + outClip.tracks.size() * sizeof(CompressedTrack) + outClip.segments.size() * sizeof(AnimationTypes::CompressedSegment);
+
+	if (stats)
+	{
+		// Replay every frame and compare against the resampled source, in model
+		// space for positions since joint errors add up along the hierarchy.
+		localStats.jointErrors.assign(jointCount, JointError());
+		std::vector<Transform> pose(jointCount);
+		std::vector<AnimationTypes::JointMatrix> sourceModel(jointCount);
+		std::vector<AnimationTypes::JointMatrix> compressedModel(jointCount);
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			const Transform* sourcePose = &poses[(size_t)frame * jointCount];
+			SampleClip(outClip, skeleton, std::min((float)frame / sampleRate, clip.duration), false, pose.data());
+			AnimationSampler::ComputeModelPose(skeleton, sourcePose, sourceModel.data());
+			AnimationSampler::ComputeModelPose(skeleton, pose.data(), compressedModel.data());
+
+			for (size_t joint = 0; joint < jointCount; joint++)
+			{
+				float sourcePosition[3] = { sourceModel[joint].m[0][3], sourceModel[joint].m[1][3], sourceModel[joint].m[2][3] };
+				float compressedPosition[3] = { compressedModel[joint].m[0][3], compressedModel[joint].m[1][3], compressedModel[joint].m[2][3] };
+
+				JointError& error = localStats.jointErrors[joint];
+				error.position = std::max(error.position, ChannelError(AnimationTypes::CHANNEL_TRANSLATION, sourcePosition, compressedPosition));
+				error.rotation = std::max(error.rotation, ChannelError(AnimationTypes::CHANNEL_ROTATION, sourcePose[joint].rotation, pose[joint].rotation));
+			}
+		}
+
+		for (size_t joint = 0; joint < jointCount; joint++)
+		{
+			const JointError& error = localStats.jointErrors[joint];
+			if (localStats.worstJoint < 0 || error.position > localStats.maxPositionError)
+			{
+				localStats.maxPositionError = error.position;
+				localStats.worstJoint = (int)joint;
+			}
+			localStats.maxRotationError = std::max(localStats.maxRotationError, error.rotation);
+		}
+
+		localStats.compressTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		*stats = std::move(localStats);
+	}
+
+	return true;
+}
+
+void ClipCompressor::SampleClip(const CompressedClip& clip, const Skeleton& skeleton, float time, bool loop, Transform* localPose)
+{
+	size_t jointCount = skeleton.joints.size();
+	for (size_t joint = 0; joint < jointCount; joint++)
+	{
+		localPose[joint] = skeleton.joints[joint].bindLocal;
+	}
+
+	if (clip.segments.empty())
+	{
+		return;
+	}
+
+	time = AnimationSampler::NormalizeTime(time, clip.duration, loop);
+	float frame = std::min(time * clip.sampleRate, (float)(clip.frameCount - 1));
+	size_t segmentIndex = std::min((size_t)frame / clip.segmentFrames, clip.segments.size() - 1);
+	const AnimationTypes::CompressedSegment& segment = clip.segments[segmentIndex];
+	float localFrame = frame - (float)segment.startFrame;
+
+	const uint8_t* segmentData = clip.data.data() + segment.dataOffset;
+	uint32_t channelIndex = 0;
+	for (const CompressedTrack& track : clip.tracks)
+	{
+		if (track.joint >= jointCount)
+		{
+			channelIndex += (track.modes[0] == AnimationTypes::CHANNEL_ANIMATED) + (track.modes[1] == AnimationTypes::CHANNEL_ANIMATED) + (track.modes[2] == AnimationTypes::CHANNEL_ANIMATED);
+			continue;
+		}
+
+		Transform& transform = localPose[track.joint];
+		for (int channel = 0; channel < AnimationTypes::CHANNEL_COUNT; channel++)
+		{
+			float* out = GetChannel(transform, channel);
+			if (track.modes[channel] == AnimationTypes::CHANNEL_CONSTANT)
+			{
+				std::copy(track.constants[channel], track.constants[channel] + GetComponentCount(channel), out);
+				continue;
+			}
+			if (track.modes[channel] != AnimationTypes::CHANNEL_ANIMATED)
+			{
+				continue;
+			}
+
+			uint32_t blockOffset;
+			std::memcpy(&blockOffset, segmentData + channelIndex * sizeof(uint32_t), sizeof(uint32_t));
+			channelIndex++;
+
+			const uint8_t* block = segmentData + blockOffset;
+			size_t keyCount = block[0];
+			const uint8_t* keyFrames = block + 1;
+			const uint8_t* keyWords = block + AlignUp(1 + keyCount, 2);
+
+			// Segments hold a handful of keys, a linear scan beats a binary search.
+			size_t key = 0;
+			while (key + 2 < keyCount && (float)keyFrames[key + 1] <= localFrame)
+			{
+				key++;
+			}
+
+			uint16_t words[2][3];
+			size_t next = std::min(key + 1, keyCount - 1);
+			std::memcpy(words[0], keyWords + key * sizeof(words[0]), sizeof(words[0]));
+			std::memcpy(words[1], keyWords + next * sizeof(words[1]), sizeof(words[1]));
+
+			float a[4], b[4];
+			DecodeKey(track, channel, words[0], a);
+			DecodeKey(track, channel, words[1], b);
+
+			float span = (float)keyFrames[next] - (float)keyFrames[key];
+			float blend = span > 0.0f ? std::min(1.0f, std::max(0.0f, (localFrame - (float)keyFrames[key]) / span)) : 0.0f;
+			BlendValues(channel, a, b, blend, out);
+		}
+	}
+}
+
+std::string ClipCompressor::FormatStats(const Stats& stats, const Skeleton& skeleton)
+{
+	double ratio = stats.compressedBytes > 0 ? (double)stats.sourceBytes / (double)stats.compressedBytes : 0.0;
+	std::string worstJoint = stats.worstJoint >= 0 && (size_t)stats.worstJoint < skeleton.joints.size() ? skeleton.joints[stats.worstJoint].name : "none";
+
+	return "Clip compression: " + std::to_string(stats.frameCount) + " frames in " + std::to_string(stats.segmentCount) + " segments, channels " +
+		std::to_string(stats.animatedChannels) + " animated / " + std::to_string(stats.constantChannels) + " constant / " + std::to_string(stats.bindChannels) + " bind pose, keys " +
+		std::to_string(stats.sourceKeys) + " -> " + std::to_string(stats.storedKeys) + ", " + std::to_string(stats.sourceBytes) + " -> " + std::to_string(stats.compressedBytes) +
+		" bytes (" + std::to_string(ratio) + ":1), max error " + std::to_string(stats.maxPositionError) + " units at " + worstJoint + ", " +
+		std::to_string(stats.maxRotationError * 57.2957795f) + " degrees, " + std::to_string(stats.compressTimeMs) + " ms";
+}
+
+std::string ClipCompressor::FormatJointErrors(const Stats& stats, const Skeleton& skeleton)
+{
+	std::string result;
+	for (size_t joint = 0; joint < stats.jointErrors.size() && joint < skeleton.joints.size(); joint++)
+	{
+		if (!result.empty())
+		{
+			result += "\n";
+		}
+		result += "  " + skeleton.joints[joint].name + ": position " + std::to_string(stats.jointErrors[joint].position) + ", rotation " +
+			std::to_string(stats.jointErrors[joint].rotation * 57.2957795f) + " degrees";
+	}
+	return result;
+}
@@ -0,0 +1,77 @@
+#ifndef CLIP_COMPRESSOR_H
+#define CLIP_COMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "AnimationTypes.h"
+
+// Cooks animation clips into a compact form and samples it.
+// - The clip is resampled at a fixed rate, then each channel is classified:
+//   channels that stay at the bind pose store nothing, channels that do not
+//   move store one value, the rest store keys.
+// - Keys are split into segments of a few frames. A segment holds the keys
+//   of every animated channel for its frames, so sampling one pose reads one
+//   small block of memory instead of a key array per channel.
+// - Within a segment each channel keeps only the keys linear interpolation
+//   cannot reproduce within the tolerances. Key frames are stored as bytes.
+// - Rotations are stored smallest three: the largest component is dropped
+//   and rebuilt from the unit length, the other three take 15 bits each.
+//   Translations and scales are quantized to 16 bits over the range each
+//   channel covers in the clip.
+class ClipCompressor
+{
+public:
+	using Transform = AnimationTypes::Transform;
+	using Skeleton = AnimationTypes::Skeleton;
+	using AnimationClip = AnimationTypes::AnimationClip;
+	using CompressedClip = AnimationTypes::CompressedClip;
+
+	struct Settings
+	{
+		float translationTolerance = 0.001f;   // Distance, in model units
+		float rotationTolerance = 0.0005f;     // Angle, in radians
+		float scaleTolerance = 0.0001f;
+		unsigned int segmentFrames = 16;       // At most 255
+		float sampleRate = 0.0f;               // Frames per second, 0 uses the densest track of the clip
+	};
+
+	// Largest error of a joint over every frame of the clip, measured
+	// against the uncompressed clip after the pose is composed.
+	struct JointError
+	{
+		float position = 0.0f;                 // Model space distance
+		float rotation = 0.0f;                 // Local angle, in radians
+	};
+
+	struct Stats
+	{
+		size_t frameCount = 0;
+		size_t segmentCount = 0;
+		size_t bindChannels = 0;
+		size_t constantChannels = 0;
+		size_t animatedChannels = 0;
+		size_t sourceKeys = 0;
+		size_t storedKeys = 0;
+		size_t sourceBytes = 0;
+		size_t compressedBytes = 0;
+		float maxPositionError = 0.0f;
+		float maxRotationError = 0.0f;
+		int worstJoint = -1;                   // Joint with the largest position error
+		std::vector<JointError> jointErrors;   // One per skeleton joint
+		double compressTimeMs = 0.0;
+	};
+
+public:
+	static bool Compress(const AnimationClip& clip, const Skeleton& skeleton, const Settings& settings, CompressedClip& outClip, Stats* stats = nullptr);
+
+	// Same contract as AnimationSampler::SampleClip.
+	static void SampleClip(const CompressedClip& clip, const Skeleton& skeleton, float time, bool loop, Transform* localPose);
+
+	static std::string FormatStats(const Stats& stats, const Skeleton& skeleton);
+	// One line per joint with its largest errors.
+	static std::string FormatJointErrors(const Stats& stats, const Skeleton& skeleton);
+};
+
+#endif // CLIP_COMPRESSOR_H
@@ -0,0 +1,103 @@
+#include "SkinWeightBuilder.h"
+#include <algorithm>
+
+SkinWeightBuilder::SkinWeightBuilder()
+{
+}
+
+SkinWeightBuilder::~SkinWeightBuilder()
+{
+}
+
+void SkinWeightBuilder::Reset(size_t pointCount)
+{
+	m_points.clear();
+	m_points.resize(pointCount);
+}
+
+void SkinWeightBuilder::AddInfluence(size_t point, unsigned int joint, float weight)
+{
+	if (point >= m_points.size() || weight <= 0.0f)
+	{
+		return;
+	}
+
+	// Several clusters may name the same joint, e.g. one per mesh part.
+	for (Influence& influence : m_points[point])
+	{
+		if (influence.joint == joint)
+		{
+			influence.weight += weight;
+			return;
+		}
+	}
+
+	m_points[point].push_back({ joint, weight });
+}
+
+void SkinWeightBuilder::Build(unsigned int fallbackJoint, std::vector<SkinInfluence>& outInfluences, Stats* stats) const
+{
+	Stats localStats;
+	localStats.pointCount = m_points.size();
+
+	outInfluences.assign(m_points.size(), SkinInfluence());
+
+	std::vector<Influence> sorted;
+	for (size_t point = 0; point < m_points.size(); point++)
+	{
+		SkinInfluence& out = outInfluences[point];
+
+		sorted = m_points[point];
+		localStats.maxInfluences = std::max(localStats.maxInfluences, sorted.size());
+		if (sorted.empty())
+		{
+			out.joints[0] = (uint16_t)fallbackJoint;
+			out.weights[0] = 1.0f;
+			localStats.unweightedPoints++;
+			continue;
+		}
+
+		// Strongest first, ties by joint so the result does not depend on cluster order.
+		std::sort(sorted.begin(), sorted.end(), [](const Influence& a, const Influence& b)
+		{
+			return a.weight != b.weight ? a.weight > b.weight : a.joint < b.joint;
+		});
+
+		size_t kept = std::min(sorted.size(), (size_t)AnimationTypes::MAX_INFLUENCES);
+		float keptWeight = 0.0f;
+		float totalWeight = 0.0f;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			totalWeight += sorted[i].weight;
+			if (i < kept)
+			{
+				keptWeight += sorted[i].weight;
+			}
+		}
+
+		if (sorted.size() > kept)
+		{
+			localStats.truncatedPoints++;
+			localStats.maxDroppedWeight = std::max(localStats.maxDroppedWeight, (totalWeight - keptWeight) / totalWeight);
+		}
+
+		for (size_t i = 0; i < kept; i++)
+		{
+			out.joints[i] = (uint16_t)sorted[i].joint;
+			out.weights[i] = sorted[i].weight / keptWeight;
+		}
+	}
+
+	if (stats)
+	{
+		*stats = localStats;
+	}
+}
+
+std::string SkinWeightBuilder::FormatStats(const Stats& stats)
+{
+	return "Skin weights: " + std::to_string(stats.pointCount) + " points, up to " + std::to_string(stats.maxInfluences) +
+		" influences, " + std::to_string(stats.truncatedPoints) + " truncated to " + std::to_string(AnimationTypes::MAX_INFLUENCES) +
+		" (max " + std::to_string(stats.maxDroppedWeight * 100.0f) + "% weight dropped), " +
+		std::to_string(stats.unweightedPoints) + " unweighted";
+}
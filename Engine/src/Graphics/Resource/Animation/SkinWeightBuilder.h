@@ -0,0 +1,50 @@
+#ifndef SKIN_WEIGHT_BUILDER_H
+#define SKIN_WEIGHT_BUILDER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "AnimationTypes.h"
+
+// Collects the joint weights of a mesh's control points as the skin clusters
+// list them, then keeps the strongest four per point and renormalizes them
+// so the skinning loop can run a fixed number of influences.
+class SkinWeightBuilder
+{
+public:
+	using SkinInfluence = AnimationTypes::SkinInfluence;
+
+	struct Stats
+	{
+		size_t pointCount = 0;
+		size_t truncatedPoints = 0;     // Had more than four influences
+		size_t unweightedPoints = 0;    // No influence at all, bound to the fallback joint
+		size_t maxInfluences = 0;
+		float maxDroppedWeight = 0.0f;  // Largest weight sum lost to truncation, before renormalizing
+	};
+
+public:
+	SkinWeightBuilder();
+	~SkinWeightBuilder();
+
+	void Reset(size_t pointCount);
+	void AddInfluence(size_t point, unsigned int joint, float weight);
+
+	// Writes one influence set per point. Points without influences get a
+	// weight of one on fallbackJoint.
+	void Build(unsigned int fallbackJoint, std::vector<SkinInfluence>& outInfluences, Stats* stats = nullptr) const;
+
+	static std::string FormatStats(const Stats& stats);
+
+private:
+	struct Influence
+	{
+		unsigned int joint;
+		float weight;
+	};
+
+	std::vector<std::vector<Influence>> m_points;
+};
+
+#endif // SKIN_WEIGHT_BUILDER_H
@@ -0,0 +1,292 @@
+#include "Skinning.h"
+#include <cmath>
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	using JointMatrix = AnimationTypes::JointMatrix;
+	using Streams = Skinning::Streams;
+	using SkinnedVertices = Skinning::SkinnedVertices;
+
+	const int INFLUENCES = AnimationTypes::MAX_INFLUENCES;
+
+	void SkinScalar(const JointMatrix* palette, const Streams& input, SkinnedVertices& output, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			float blended[3][4] = {};
+			for (int k = 0; k < INFLUENCES; k++)
+			{
+				float weight = input.weights[k][i];
+				if (weight == 0.0f)
+				{
+					continue;
+				}
+
+				const JointMatrix& matrix = palette[input.joints[k][i]];
+				for (int row = 0; row < 3; row++)
+				{
+					for (int column = 0; column < 4; column++)
+					{
+						blended[row][column] += weight * matrix.m[row][column];
+					}
+				}
+			}
+
+			float x = input.positions[0][i], y = input.positions[1][i], z = input.positions[2][i];
+			float nx = input.normals[0][i], ny = input.normals[1][i], nz = input.normals[2][i];
+			float normal[3];
+			for (int row = 0; row < 3; row++)
+			{
+				output.positions[row][i] = blended[row][0] * x + blended[row][1] * y + blended[row][2] * z + blended[row][3];
+				normal[row] = blended[row][0] * nx + blended[row][1] * ny + blended[row][2] * nz;
+			}
+
+			float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+			for (int row = 0; row < 3; row++)
+			{
+				output.normals[row][i] = normal[row] * invLength;
+			}
+		}
+	}
+
+	// Transforms and stores one group from the blended matrix in lanes,
+	// blended[row * 4 + column].
+	template<typename Vector, typename Ops>
+	void TransformGroup(const Vector* blended, const Streams& input, SkinnedVertices& output, size_t i)
+	{
+		Vector x = Ops::Load(&input.positions[0][i]);
+		Vector y = Ops::Load(&input.positions[1][i]);
+		Vector z = Ops::Load(&input.positions[2][i]);
+		Vector nx = Ops::Load(&input.normals[0][i]);
+		Vector ny = Ops::Load(&input.normals[1][i]);
+		Vector nz = Ops::Load(&input.normals[2][i]);
+
+		Vector normal[3];
+		for (int row = 0; row < 3; row++)
+		{
+			const Vector* m = &blended[row * 4];
+			Vector position = Ops::Add(Ops::Add(Ops::Mul(m[0], x), Ops::Mul(m[1], y)), Ops::Add(Ops::Mul(m[2], z), m[3]));
+			Ops::Store(&output.positions[row][i], position);
+			normal[row] = Ops::Add(Ops::Add(Ops::Mul(m[0], nx), Ops::Mul(m[1], ny)), Ops::Mul(m[2], nz));
+		}
+
+		// Zero length normals (padding) stay zero instead of turning into NaN.
+		Vector lengthSq = Ops::Add(Ops::Add(Ops::Mul(normal[0], normal[0]), Ops::Mul(normal[1], normal[1])), Ops::Mul(normal[2], normal[2]));
+		Vector length = Ops::Sqrt(lengthSq);
+		Vector valid = Ops::GreaterThanZero(length);
+		Vector invLength = Ops::And(Ops::Div(Ops::One(), length), valid);
+		for (int row = 0; row < 3; row++)
+		{
+			Ops::Store(&output.normals[row][i], Ops::Mul(normal[row], invLength));
+		}
+	}
+
+#if !defined(__AVX__)
+	struct SseOps
+	{
+		static __m128 Load(const float* p) { return _mm_loadu_ps(p); }
+		static void Store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+		static __m128 Add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+		static __m128 Mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+		static __m128 Div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+		static __m128 Sqrt(__m128 a) { return _mm_sqrt_ps(a); }
+		static __m128 And(__m128 a, __m128 b) { return _mm_and_ps(a, b); }
+		static __m128 GreaterThanZero(__m128 a) { return _mm_cmpgt_ps(a, _mm_setzero_ps()); }
+		static __m128 One() { return _mm_set1_ps(1.0f); }
+	};
+
+	void SkinSse(const JointMatrix* palette, const Streams& input, SkinnedVertices& output, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i += 4)
+		{
+			__m128 blended[12];
+			for (int c = 0; c < 12; c++)
+			{
+				blended[c] = _mm_setzero_ps();
+			}
+
+			for (int k = 0; k < INFLUENCES; k++)
+			{
+				__m128 weight = _mm_loadu_ps(&input.weights[k][i]);
+				if (_mm_movemask_ps(_mm_cmpneq_ps(weight, _mm_setzero_ps())) == 0)
+				{
+					continue;
+				}
+
+				const uint16_t* joints = &input.joints[k][i];
+				const JointMatrix& m0 = palette[joints[0]];
+				const JointMatrix& m1 = palette[joints[1]];
+				const JointMatrix& m2 = palette[joints[2]];
+				const JointMatrix& m3 = palette[joints[3]];
+
+				// A row of each of the four matrices, transposed gives one column per register.
+				for (int row = 0; row < 3; row++)
+				{
+					__m128 c0 = _mm_load_ps(m0.m[row]);
+					__m128 c1 = _mm_load_ps(m1.m[row]);
+					__m128 c2 = _mm_load_ps(m2.m[row]);
+					__m128 c3 = _mm_load_ps(m3.m[row]);
+					_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+					blended[row * 4 + 0] = _mm_add_ps(blended[row * 4 + 0], _mm_mul_ps(weight, c0));
+					blended[row * 4 + 1] = _mm_add_ps(blended[row * 4 + 1], _mm_mul_ps(weight, c1));
+					blended[row * 4 + 2] = _mm_add_ps(blended[row * 4 + 2], _mm_mul_ps(weight, c2));
+					blended[row * 4 + 3] = _mm_add_ps(blended[row * 4 + 3], _mm_mul_ps(weight, c3));
+				}
+			}
+
+			TransformGroup<__m128, SseOps>(blended, input, output, i);
+		}
+	}
+#else
+	struct AvxOps
+	{
+		static __m256 Load(const float* p) { return _mm256_loadu_ps(p); }
+		static void Store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+		static __m256 Add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+		static __m256 Mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+		static __m256 Div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+		static __m256 Sqrt(__m256 a) { return _mm256_sqrt_ps(a); }
+		static __m256 And(__m256 a, __m256 b) { return _mm256_and_ps(a, b); }
+		static __m256 GreaterThanZero(__m256 a) { return _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ); }
+		static __m256 One() { return _mm256_set1_ps(1.0f); }
+	};
+
+	void SkinAvx(const JointMatrix* palette, const Streams& input, SkinnedVertices& output, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i += 8)
+		{
+			__m256 blended[12];
+			for (int c = 0; c < 12; c++)
+			{
+				blended[c] = _mm256_setzero_ps();
+			}
+
+			for (int k = 0; k < INFLUENCES; k++)
+			{
+				__m256 weight = _mm256_loadu_ps(&input.weights[k][i]);
+				if (_mm256_movemask_ps(_mm256_cmp_ps(weight, _mm256_setzero_ps(), _CMP_NEQ_UQ)) == 0)
+				{
+					continue;
+				}
+
+				const uint16_t* joints = &input.joints[k][i];
+				for (int row = 0; row < 3; row++)
+				{
+					// Lanes 0-3 and 4-7 are transposed separately and joined per column.
+					__m128 lo0 = _mm_load_ps(palette[joints[0]].m[row]);
+					__m128 lo1 = _mm_load_ps(palette[joints[1]].m[row]);
+					__m128 lo2 = _mm_load_ps(palette[joints[2]].m[row]);
+					__m128 lo3 = _mm_load_ps(palette[joints[3]].m[row]);
+					__m128 hi0 = _mm_load_ps(palette[joints[4]].m[row]);
+					__m128 hi1 = _mm_load_ps(palette[joints[5]].m[row]);
+					__m128 hi2 = _mm_load_ps(palette[joints[6]].m[row]);
+					__m128 hi3 = _mm_load_ps(palette[joints[7]].m[row]);
+					_MM_TRANSPOSE4_PS(lo0, lo1, lo2, lo3);
+					_MM_TRANSPOSE4_PS(hi0, hi1, hi2, hi3);
+
+					__m256 c0 = _mm256_insertf128_ps(_mm256_castps128_ps256(lo0), hi0, 1);
+					__m256 c1 = _mm256_insertf128_ps(_mm256_castps128_ps256(lo1), hi1, 1);
+					__m256 c2 = _mm256_insertf128_ps(_mm256_castps128_ps256(lo2), hi2, 1);
+					__m256 c3 = _mm256_insertf128_ps(_mm256_castps128_ps256(lo3), hi3, 1);
+
+					blended[row * 4 + 0] = _mm256_add_ps(blended[row * 4 + 0], _mm256_mul_ps(weight, c0));
+					blended[row * 4 + 1] = _mm256_add_ps(blended[row * 4 + 1], _mm256_mul_ps(weight, c1));
+					blended[row * 4 + 2] = _mm256_add_ps(blended[row * 4 + 2], _mm256_mul_ps(weight, c2));
+					blended[row * 4 + 3] = _mm256_add_ps(blended[row * 4 + 3], _mm256_mul_ps(weight, c3));
+				}
+			}
+
+			TransformGroup<__m256, AvxOps>(blended, input, output, i);
+		}
+	}
+#endif
+}
+
+void Skinning::BuildStreams(const MeshVertex* vertices, const SkinInfluence* influences, size_t vertexCount, Streams& outStreams)
+{
+	size_t paddedCount = (vertexCount + LANE_PADDING - 1) / LANE_PADDING * LANE_PADDING;
+
+	outStreams.vertexCount = vertexCount;
+	outStreams.paddedCount = paddedCount;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		outStreams.positions[axis].assign(paddedCount, 0.0f);
+		outStreams.normals[axis].assign(paddedCount, 0.0f);
+	}
+	for (int k = 0; k < INFLUENCES; k++)
+	{
+		outStreams.joints[k].assign(paddedCount, 0);
+		outStreams.weights[k].assign(paddedCount, 0.0f);
+	}
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const MeshVertex& vertex = vertices[i];
+		outStreams.positions[0][i] = vertex.x;
+		outStreams.positions[1][i] = vertex.y;
+		outStreams.positions[2][i] = vertex.z;
+		outStreams.normals[0][i] = vertex.nx;
+		outStreams.normals[1][i] = vertex.ny;
+		outStreams.normals[2][i] = vertex.nz;
+
+		for (int k = 0; k < INFLUENCES; k++)
+		{
+			outStreams.joints[k][i] = influences[i].joints[k];
+			outStreams.weights[k][i] = influences[i].weights[k];
+		}
+	}
+}
+
+void Skinning::Skin(const JointMatrix* palette, const Streams& input, SkinnedVertices& output, const Settings& settings)
+{
+	if (output.vertexCount != input.vertexCount || output.positions[0].size() != input.paddedCount)
+	{
+		output.vertexCount = input.vertexCount;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			output.positions[axis].assign(input.paddedCount, 0.0f);
+			output.normals[axis].assign(input.paddedCount, 0.0f);
+		}
+	}
+
+	if (!settings.useSimd)
+	{
+		SkinScalar(palette, input, output, 0, input.vertexCount);
+		return;
+	}
+
+#if defined(__AVX__)
+	SkinAvx(palette, input, output, 0, input.paddedCount);
+#else
+	SkinSse(palette, input, output, 0, input.paddedCount);
+#endif
+}
+
+void Skinning::WriteVertices(const SkinnedVertices& skinned, MeshVertex* vertices)
+{
+	for (size_t i = 0; i < skinned.vertexCount; i++)
+	{
+		MeshVertex& vertex = vertices[i];
+		vertex.x = skinned.positions[0][i];
+		vertex.y = skinned.positions[1][i];
+		vertex.z = skinned.positions[2][i];
+		vertex.nx = skinned.normals[0][i];
+		vertex.ny = skinned.normals[1][i];
+		vertex.nz = skinned.normals[2][i];
+	}
+}
+
+const char* Skinning::GetInstructionSet()
+{
+#if defined(__AVX__)
+	return "AVX";
+#else
+	return "SSE";
+#endif
+}
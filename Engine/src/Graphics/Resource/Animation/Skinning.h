@@ -0,0 +1,69 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "AnimationTypes.h"
+#include "../Mesh/MeshTypes.h"
+
+// Linear blend skinning on the CPU.
+// - The bind pose is kept as structure-of-arrays streams, one array per
+//   component, padded to a multiple of eight vertices so the loop never needs
+//   a scalar tail.
+// - Each group of vertices gathers the palette rows of its joints, transposes
+//   them into lanes and blends the matrices by weight, then transforms
+//   positions and normals. Groups are 8 wide with AVX, 4 wide with SSE.
+// - Influence slots whose weights are zero for the whole group are skipped,
+//   most vertices of a typical character use one or two joints.
+// - Normals are transformed by the blended 3x3 part and renormalized, which
+//   is exact for rotations and uniform scale.
+class Skinning
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using SkinInfluence = AnimationTypes::SkinInfluence;
+	using JointMatrix = AnimationTypes::JointMatrix;
+
+	static const size_t LANE_PADDING = 8;
+
+	// Bind pose input, shared by every character using the same mesh.
+	struct Streams
+	{
+		size_t vertexCount = 0;
+		size_t paddedCount = 0;
+		std::vector<float> positions[3];
+		std::vector<float> normals[3];
+		std::vector<uint16_t> joints[AnimationTypes::MAX_INFLUENCES];
+		std::vector<float> weights[AnimationTypes::MAX_INFLUENCES];
+	};
+
+	// Skinned output of one character, padded like the input.
+	struct SkinnedVertices
+	{
+		size_t vertexCount = 0;
+		std::vector<float> positions[3];
+		std::vector<float> normals[3];
+	};
+
+	struct Settings
+	{
+		bool useSimd = true;
+	};
+
+public:
+	static void BuildStreams(const MeshVertex* vertices, const SkinInfluence* influences, size_t vertexCount, Streams& outStreams);
+
+	// Skins every vertex of input with the palette, one matrix per joint.
+	static void Skin(const JointMatrix* palette, const Streams& input, SkinnedVertices& output, const Settings& settings);
+
+	// Copies skinned positions and normals into full vertices, e.g. for a
+	// dynamic vertex buffer. The other vertex components are left alone.
+	static void WriteVertices(const SkinnedVertices& skinned, MeshVertex* vertices);
+
+	// "AVX" or "SSE", what Skin runs with useSimd set.
+	static const char* GetInstructionSet();
+};
+
+#endif // SKINNING_H
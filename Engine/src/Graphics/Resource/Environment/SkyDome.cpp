@@ -1,4 +1,5 @@
 #include "skydome.h"
+#include "../Mesh/TextModelParser.h"
 
 
 SkyDome::SkyDome()
@@ -89,29 +90,16 @@ XMFLOAT4 SkyDome::GetCenterColor()
 
 bool SkyDome::LoadSkyDomeModel(const char* filename)
 {
-	ifstream fin;
-	char input;
-	int i;
-
+	TextModelParser parser;
 
-	// Open the model file.
-	fin.open(filename);
 
-	// If it could not open the file then exit.
-	if (fin.fail())
+	// Map the model file and read the vertex count.
+	if (!parser.Open(filename))
 	{
 		return false;
 	}
 
-	// Read up to the value of vertex count.
-	fin.get(input);
-	while (input != ':')
-	{
-		fin.get(input);
-	}
-
-	// Read in the vertex count.
-	fin >> m_vertexCount;
+	m_vertexCount = (int)parser.GetVertexCount();
 
 	// Set the number of indices to be the same as the vertex count.
 	m_indexCount = m_vertexCount;
@@ -123,26 +111,12 @@ bool SkyDome::LoadSkyDomeModel(const char* filename)
 		return false;
 	}
 
-	// Read up to the beginning of the data.
-	fin.get(input);
-	while (input != ':')
-	{
-		fin.get(input);
-	}
-	fin.get(input);
-	fin.get(input);
-
 	// Read in the vertex data.
-	for (i = 0; i < m_vertexCount; i++)
+	if (!parser.Parse(&m_model[0].x, sizeof(ModelType) / sizeof(float)))
 	{
-		fin >> m_model[i].x >> m_model[i].y >> m_model[i].z;
-		fin >> m_model[i].tu >> m_model[i].tv;
-		fin >> m_model[i].nx >> m_model[i].ny >> m_model[i].nz;
+		return false;
 	}
 
-	// Close the model file.
-	fin.close();
-
 	return true;
 }
 
@@ -4,6 +4,7 @@
 #include <directxpackedvector.h>
 #include <fstream>
 #include "../Texture.h"
+#include "../ResourceCache.h"
 
 using namespace DirectX;
 using namespace DirectX::PackedVector;
@@ -17,6 +18,7 @@ Skybox::Skybox()
     for (int i = 0; i < 6; i++)
     {
         m_textures[i] = 0;
+        m_faceTextures[i] = 0;
     }
 }
 
@@ -51,14 +53,12 @@ bool Skybox::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext
 
 void Skybox::Shutdown()
 {
-    // Release the textures.
+    // Release the textures, the views belong to them.
     for (int i = 0; i < 6; i++)
     {
-        if (m_textures[i])
-        {
-            m_textures[i]->Release();
-            m_textures[i] = 0;
-        }
+        ResourceCache::GetInstance().ReleaseTexture(m_faceTextures[i]);
+        m_faceTextures[i] = 0;
+        m_textures[i] = 0;
     }
 
     // Release the vertex and index buffers.
@@ -315,10 +315,8 @@ void Skybox::RenderBuffers(ID3D11DeviceContext* deviceContext)
 
 bool Skybox::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
 {
-    HRESULT result;
     char textureFilename[128];
     int error;
-    Texture* texture;
 
     // Load the six textures for the skybox.
     for (int i = 0; i < 6; i++)
@@ -353,18 +351,15 @@ bool Skybox::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceConte
             return false;
         }
 
-        // Create and initialize the texture object
-        texture = new Texture;
-        result = texture->Initialize(device, deviceContext, textureFilename);
-        if (FAILED(result))
+        // Get the shared texture object
+        m_faceTextures[i] = ResourceCache::GetInstance().AcquireTexture(device, deviceContext, textureFilename);
+        if (!m_faceTextures[i])
         {
-            delete texture;
             return false;
         }
 
         // Get the shader resource view
-        m_textures[i] = texture->GetTexture();
-        delete texture;
+        m_textures[i] = m_faceTextures[i]->GetTexture();
     }
 
     return true;
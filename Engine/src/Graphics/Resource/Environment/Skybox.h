@@ -8,6 +8,8 @@
 using namespace DirectX;
 using namespace std;
 
+class Texture;
+
 class Skybox
 {
 private:
@@ -41,6 +43,7 @@ private:
     int m_vertexCount;
     int m_indexCount;
     ID3D11ShaderResourceView* m_textures[6];
+    Texture* m_faceTextures[6];
 };
 
 #endif 
\ No newline at end of file
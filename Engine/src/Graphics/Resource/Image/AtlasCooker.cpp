@@ -0,0 +1,186 @@
+#include "AtlasCooker.h"
+#include "DdsFile.h"
+#include "ImageDecoder.h"
+#include "../Mesh/CookedMesh.h"
+#include "../../../Core/System/Logger.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+bool AtlasCooker::Cook(const std::string& listFilename, const std::vector<std::string>& filenames, const AtlasPacker::Settings& settings, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	// The write times are taken before decoding, a frame saved meanwhile is cooked again next time.
+	std::vector<RegionEntry> entries(filenames.size());
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		CookedMesh::SourceInfo source;
+		if (!CookedMesh::GetSourceInfo(filenames[i], source))
+		{
+			LOG_ERROR("AtlasCooker - Missing image " + filenames[i]);
+			return false;
+		}
+		entries[i].sourceSize = source.size;
+		entries[i].sourceTimestamp = source.timestamp;
+	}
+
+	ImageDecoder::Settings decodeSettings;
+	ImageDecoder::Stats decodeStats;
+	std::vector<ImageDecoder::Image> images;
+	if (!ImageDecoder::DecodeBatch(filenames, images, decodeSettings, &decodeStats))
+	{
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			if (!images[i].pixels)
+			{
+				LOG_ERROR("AtlasCooker - Failed to decode " + filenames[i]);
+			}
+		}
+		return false;
+	}
+
+	std::vector<AtlasPacker::Source> sources(images.size());
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		sources[i] = { images[i].pixels.get(), (uint32_t)images[i].info.width, (uint32_t)images[i].info.height };
+	}
+
+	ImageTypes::Image atlas;
+	std::vector<Region> regions;
+	AtlasPacker::Stats packStats;
+	if (!AtlasPacker::Build(sources, settings, atlas, regions, &packStats))
+	{
+		LOG_ERROR("AtlasCooker - " + std::to_string(filenames.size()) + " images of " + listFilename + " do not fit a " +
+			std::to_string(settings.maxSize) + " atlas");
+		return false;
+	}
+	images.clear();
+
+	std::string atlasFilename = GetAtlasFilename(listFilename);
+	if (!DdsFile::Write(atlasFilename, atlas, DdsFile::SourceTag()))
+	{
+		return false;
+	}
+
+	std::error_code error;
+	FileHeader header = {};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.regionCount = (uint32_t)regions.size();
+	header.atlasFileSize = (uint64_t)std::filesystem::file_size(atlasFilename, error);
+	if (error)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		entries[i].region = regions[i];
+	}
+
+	// Write to a temporary file first so a failed cook never leaves a truncated table behind.
+	std::string tableFilename = GetTableFilename(listFilename);
+	std::string tempFilename = tableFilename + ".tmp";
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (!fout)
+	{
+		LOG_ERROR("AtlasCooker - Failed to open " + tempFilename);
+		return false;
+	}
+
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(RegionEntry)));
+	fout.close();
+	if (!fout)
+	{
+		LOG_ERROR("AtlasCooker - Failed to write " + tempFilename);
+		return false;
+	}
+
+	std::filesystem::rename(tempFilename, tableFilename, error);
+	if (error)
+	{
+		LOG_ERROR("AtlasCooker - Failed to move the region table into place: " + error.message());
+		std::filesystem::remove(tempFilename, error);
+		return false;
+	}
+
+	if (stats)
+	{
+		stats->pack = packStats;
+		stats->sourceBytes = decodeStats.fileBytes;
+		stats->decodeTimeMs = decodeStats.decodeTimeMs;
+		stats->cookTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+
+	return true;
+}
+
+bool AtlasCooker::ReadRegions(const std::string& listFilename, const std::vector<std::string>& filenames, std::vector<Region>& regions)
+{
+	regions.clear();
+
+	std::ifstream fin(GetTableFilename(listFilename), std::ios::binary);
+	if (!fin)
+	{
+		return false;
+	}
+
+	FileHeader header = {};
+	fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!fin || header.magic != MAGIC || header.version != VERSION || header.regionCount != filenames.size())
+	{
+		return false;
+	}
+
+	std::vector<RegionEntry> entries(header.regionCount);
+	fin.read(reinterpret_cast<char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(RegionEntry)));
+	if (!fin)
+	{
+		return false;
+	}
+
+	// The atlas has to be the one written with this table.
+	std::error_code error;
+	uint64_t atlasFileSize = (uint64_t)std::filesystem::file_size(GetAtlasFilename(listFilename), error);
+	if (error || atlasFileSize != header.atlasFileSize)
+	{
+		return false;
+	}
+
+	// And every image the one it was cooked from.
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		CookedMesh::SourceInfo source;
+		if (CookedMesh::GetSourceInfo(filenames[i], source) &&
+			(source.size != entries[i].sourceSize || source.timestamp != entries[i].sourceTimestamp))
+		{
+			return false;
+		}
+	}
+
+	regions.resize(entries.size());
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		regions[i] = entries[i].region;
+	}
+
+	return true;
+}
+
+std::string AtlasCooker::GetAtlasFilename(const std::string& listFilename)
+{
+	return listFilename + ".atlas.dds";
+}
+
+std::string AtlasCooker::GetTableFilename(const std::string& listFilename)
+{
+	return listFilename + ".atlas";
+}
+
+std::string AtlasCooker::FormatStats(const Stats& stats)
+{
+	return AtlasPacker::FormatStats(stats.pack) + "; cooked from " + std::to_string(stats.sourceBytes / 1024) + " KB of images in " +
+		std::to_string(stats.cookTimeMs) + " ms, " + std::to_string(stats.decodeTimeMs) + " ms decoding";
+}
@@ -0,0 +1,65 @@
+#ifndef ATLAS_COOKER_H
+#define ATLAS_COOKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AtlasPacker.h"
+
+// Cooks a list of images (the frames of a sprite, icons, glyph pages) into
+// an atlas once, so loading only maps the result:
+// - "<list>.atlas.dds" holds the packed images, RGBA8 with the mips
+//   AtlasPacker keeps clean, see DdsFile.
+// - "<list>.atlas" is the region table: per image its size and write time
+//   when it was cooked and where it ended up, in list order.
+// The frames are decoded in parallel, see ImageDecoder::DecodeBatch. The table
+// is written after the atlas, so a table that matches the frames always comes
+// with its atlas; a frame that changed, or a list that did, means a re-cook.
+class AtlasCooker
+{
+public:
+	using Region = AtlasPacker::Region;
+
+	static const uint32_t MAGIC = 0x534C5441; // "ATLS"
+	static const uint32_t VERSION = 1;
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t regionCount;
+		uint32_t reserved;
+		uint64_t atlasFileSize;     // Of the ".atlas.dds" written with the table
+	};
+
+	struct RegionEntry
+	{
+		uint64_t sourceSize;
+		int64_t sourceTimestamp;
+		Region region;
+	};
+
+	struct Stats
+	{
+		AtlasPacker::Stats pack;
+		size_t sourceBytes = 0;
+		double decodeTimeMs = 0.0;
+		double cookTimeMs = 0.0;    // Decoding, packing and writing
+	};
+
+public:
+	// Packs the images and writes both files for the list.
+	static bool Cook(const std::string& listFilename, const std::vector<std::string>& filenames, const AtlasPacker::Settings& settings, Stats* stats = nullptr);
+
+	// Reads the region table, false if it is missing, damaged or stale.
+	static bool ReadRegions(const std::string& listFilename, const std::vector<std::string>& filenames, std::vector<Region>& regions);
+
+	static std::string GetAtlasFilename(const std::string& listFilename);
+	static std::string GetTableFilename(const std::string& listFilename);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // ATLAS_COOKER_H
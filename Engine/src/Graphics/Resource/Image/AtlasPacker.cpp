@@ -0,0 +1,332 @@
+#include "AtlasPacker.h"
+#include "MipGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	using Rect = AtlasPacker::Rect;
+
+	uint32_t AlignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	bool Contains(const Rect& outer, const Rect& inner)
+	{
+		return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+	}
+
+	bool Intersects(const Rect& a, const Rect& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+
+	// MaxRects: the free space is kept as the list of maximal free rectangles,
+	// which may overlap. A placed cell splits every free rectangle it touches
+	// into the parts around it, then rectangles inside others are dropped.
+	class MaxRects
+	{
+	public:
+		MaxRects(uint32_t width, uint32_t height)
+		{
+			m_free.push_back({ 0, 0, width, height });
+		}
+
+		bool Insert(uint32_t width, uint32_t height, Rect& placed)
+		{
+			// Best short side fit: the free rectangle with the least left over on its tighter side.
+			uint32_t bestShort = UINT32_MAX;
+			uint32_t bestLong = UINT32_MAX;
+			for (const Rect& free : m_free)
+			{
+				if (free.width < width || free.height < height)
+				{
+					continue;
+				}
+
+				uint32_t leftoverX = free.width - width;
+				uint32_t leftoverY = free.height - height;
+				uint32_t shortSide = std::min(leftoverX, leftoverY);
+				uint32_t longSide = std::max(leftoverX, leftoverY);
+				if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+				{
+					bestShort = shortSide;
+					bestLong = longSide;
+					placed = { free.x, free.y, width, height };
+				}
+			}
+
+			if (bestShort == UINT32_MAX)
+			{
+				return false;
+			}
+
+			Split(placed);
+			Prune();
+			return true;
+		}
+
+	private:
+		void Split(const Rect& used)
+		{
+			m_split.clear();
+			for (const Rect& free : m_free)
+			{
+				if (!Intersects(free, used))
+				{
+					m_split.push_back(free);
+					continue;
+				}
+
+				if (used.x > free.x)
+				{
+					m_split.push_back({ free.x, free.y, used.x - free.x, free.height });
+				}
+				if (used.x + used.width < free.x + free.width)
+				{
+					m_split.push_back({ used.x + used.width, free.y, free.x + free.width - (used.x + used.width), free.height });
+				}
+				if (used.y > free.y)
+				{
+					m_split.push_back({ free.x, free.y, free.width, used.y - free.y });
+				}
+				if (used.y + used.height < free.y + free.height)
+				{
+					m_split.push_back({ free.x, used.y + used.height, free.width, free.y + free.height - (used.y + used.height) });
+				}
+			}
+			m_free.swap(m_split);
+		}
+
+		void Prune()
+		{
+			for (size_t i = 0; i < m_free.size(); i++)
+			{
+				for (size_t j = i + 1; j < m_free.size();)
+				{
+					if (Contains(m_free[j], m_free[i]))
+					{
+						m_free[i] = m_free[j];
+						m_free[j] = m_free.back();
+						m_free.pop_back();
+						j = i + 1;
+					}
+					else if (Contains(m_free[i], m_free[j]))
+					{
+						m_free[j] = m_free.back();
+						m_free.pop_back();
+					}
+					else
+					{
+						j++;
+					}
+				}
+			}
+		}
+
+	private:
+		std::vector<Rect> m_free;
+		std::vector<Rect> m_split;
+	};
+
+	bool PackCells(const std::vector<Rect>& cells, const std::vector<size_t>& order, uint32_t width, uint32_t height, std::vector<Rect>& placed)
+	{
+		MaxRects packer(width, height);
+		placed.resize(cells.size());
+		for (size_t index : order)
+		{
+			if (!packer.Insert(cells[index].width, cells[index].height, placed[index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+bool AtlasPacker::Pack(const std::vector<Rect>& sizes, const Settings& settings, uint32_t& outWidth, uint32_t& outHeight, std::vector<Rect>& outRects)
+{
+	outRects.clear();
+	uint32_t alignment = std::max(settings.alignment, 1u);
+	if (sizes.empty() || (alignment & (alignment - 1)) != 0)
+	{
+		return false;
+	}
+
+	// Cells: item plus padding on both sides, rounded up to the alignment.
+	std::vector<Rect> cells(sizes.size());
+	uint64_t area = 0;
+	uint32_t largest = alignment;
+	for (size_t i = 0; i < sizes.size(); i++)
+	{
+		cells[i].width = AlignUp(sizes[i].width + settings.padding * 2, alignment);
+		cells[i].height = AlignUp(sizes[i].height + settings.padding * 2, alignment);
+		area += (uint64_t)cells[i].width * cells[i].height;
+		largest = std::max(largest, std::max(cells[i].width, cells[i].height));
+	}
+
+	// Largest side first, then largest area; ties keep the input order.
+	std::vector<size_t> order(sizes.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&cells](size_t a, size_t b)
+	{
+		uint32_t sideA = std::max(cells[a].width, cells[a].height);
+		uint32_t sideB = std::max(cells[b].width, cells[b].height);
+		if (sideA != sideB)
+		{
+			return sideA > sideB;
+		}
+		return (uint64_t)cells[a].width * cells[a].height > (uint64_t)cells[b].width * cells[b].height;
+	});
+
+	// Smallest power of two square that could hold the area, then grow one side at a time.
+	uint32_t width = 1;
+	while (width < largest || (uint64_t)width * width < area)
+	{
+		width *= 2;
+	}
+	uint32_t height = width;
+	if ((uint64_t)width * (width / 2) >= area && width / 2 >= largest)
+	{
+		height = width / 2;
+	}
+
+	std::vector<Rect> placed;
+	while (width <= settings.maxSize && height <= settings.maxSize)
+	{
+		if (PackCells(cells, order, width, height, placed))
+		{
+			outWidth = width;
+			outHeight = height;
+			outRects.resize(sizes.size());
+			for (size_t i = 0; i < sizes.size(); i++)
+			{
+				outRects[i] = { placed[i].x + settings.padding, placed[i].y + settings.padding, sizes[i].width, sizes[i].height };
+			}
+			return true;
+		}
+
+		if (height < width)
+		{
+			height *= 2;
+		}
+		else
+		{
+			width *= 2;
+		}
+	}
+
+	return false;
+}
+
+bool AtlasPacker::Build(const std::vector<Source>& sources, const Settings& settings, Image& outAtlas, std::vector<Region>& outRegions, Stats* stats)
+{
+	outRegions.clear();
+	std::vector<Rect> sizes(sources.size());
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		if (!sources[i].rgba || sources[i].width == 0 || sources[i].height == 0)
+		{
+			return false;
+		}
+		sizes[i] = { 0, 0, sources[i].width, sources[i].height };
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<Rect> rects;
+	if (!Pack(sizes, settings, width, height, rects))
+	{
+		return false;
+	}
+	auto packed = std::chrono::high_resolution_clock::now();
+
+	// Fill each cell, padding and alignment included, with the item clamped to its edges.
+	std::vector<uint8_t> texels((size_t)width * height * 4, 0);
+	uint64_t itemTexels = 0;
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		const Source& source = sources[i];
+		const Rect& rect = rects[i];
+		uint32_t alignment = std::max(settings.alignment, 1u);
+		uint32_t cellX = rect.x - settings.padding;
+		uint32_t cellY = rect.y - settings.padding;
+		uint32_t cellWidth = AlignUp(rect.width + settings.padding * 2, alignment);
+		uint32_t cellHeight = AlignUp(rect.height + settings.padding * 2, alignment);
+
+		for (uint32_t y = 0; y < cellHeight; y++)
+		{
+			int64_t sourceY = std::min(std::max((int64_t)y - (int64_t)settings.padding, (int64_t)0), (int64_t)source.height - 1);
+			const uint8_t* sourceRow = source.rgba + (size_t)sourceY * source.width * 4;
+			uint8_t* row = &texels[((size_t)(cellY + y) * width + cellX) * 4];
+
+			// Left padding, the row itself, then the right padding.
+			for (uint32_t x = 0; x < settings.padding; x++)
+			{
+				std::memcpy(row + x * 4, sourceRow, 4);
+			}
+			std::memcpy(row + settings.padding * 4, sourceRow, (size_t)source.width * 4);
+			for (uint32_t x = settings.padding + source.width; x < cellWidth; x++)
+			{
+				std::memcpy(row + x * 4, sourceRow + (size_t)(source.width - 1) * 4, 4);
+			}
+		}
+
+		Region region;
+		region.rect = rect;
+		region.u0 = (float)rect.x / width;
+		region.v0 = (float)rect.y / height;
+		region.u1 = (float)(rect.x + rect.width) / width;
+		region.v1 = (float)(rect.y + rect.height) / height;
+		outRegions.push_back(region);
+		itemTexels += (uint64_t)rect.width * rect.height;
+	}
+
+	// Box filtered mips, only as many as the cells keep apart.
+	uint32_t mipCount = settings.generateMips ? GetMipCount(settings, width, height) : 1;
+	MipGenerator::Settings mipSettings;
+	mipSettings.filter = MipGenerator::FILTER_BOX;
+	mipSettings.maxLevels = mipCount;
+	if (!MipGenerator::Generate(texels.data(), width, height, mipSettings, outAtlas))
+	{
+		return false;
+	}
+
+	if (stats)
+	{
+		auto end = std::chrono::high_resolution_clock::now();
+		stats->itemCount = (uint32_t)sources.size();
+		stats->width = width;
+		stats->height = height;
+		stats->mipCount = mipCount;
+		stats->occupancy = (float)((double)itemTexels / ((double)width * height));
+		stats->packTimeMs = std::chrono::duration<double, std::milli>(packed - start).count();
+		stats->composeTimeMs = std::chrono::duration<double, std::milli>(end - packed).count();
+	}
+
+	return true;
+}
+
+uint32_t AtlasPacker::GetMipCount(const Settings& settings, uint32_t width, uint32_t height)
+{
+	uint32_t levels = 1;
+	while ((settings.padding >> levels) >= 1 && (settings.alignment >> levels) >= 1 && (std::max(width, height) >> levels) >= 1)
+	{
+		levels++;
+	}
+	return levels;
+}
+
+std::string AtlasPacker::FormatStats(const Stats& stats)
+{
+	return "Atlas " + std::to_string(stats.width) + "x" + std::to_string(stats.height) + ", " + std::to_string(stats.itemCount) + " items, " +
+		std::to_string((int)std::lround(stats.occupancy * 100.0f)) + "% used, " + std::to_string(stats.mipCount) + " mips, packed in " +
+		std::to_string(stats.packTimeMs) + " ms, composed in " + std::to_string(stats.composeTimeMs) + " ms";
+}
@@ -0,0 +1,82 @@
+#ifndef ATLAS_PACKER_H
+#define ATLAS_PACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImageTypes.h"
+
+// Packs many small images (sprite frames, font pages, icons) into one
+// atlas so 2D elements share a single texture.
+// - Rectangles are placed with MaxRects, best short side fit, largest
+//   first, into the smallest power of two atlas they fit.
+// - Every item gets a cell: its image plus padding on each side, rounded
+//   up to the alignment. The padding repeats the item's edge texels, so
+//   bilinear filtering at the edge reads the item and not its neighbor.
+// - Cells start on multiples of the alignment, so a BC block or a box
+//   filtered mip texel never covers two items. Mips are generated only as
+//   far as both the padding and the alignment hold.
+class AtlasPacker
+{
+public:
+	using Image = ImageTypes::Image;
+
+	struct Settings
+	{
+		uint32_t maxSize = 4096;
+		uint32_t padding = 4;       // Texels of repeated edge around each item
+		uint32_t alignment = 4;     // Cell origin and size, a power of two
+		bool generateMips = true;
+	};
+
+	struct Rect
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct Source
+	{
+		const uint8_t* rgba;        // width * height texels, top row first
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// Where an item ended up: its texels, and the same in texture coordinates.
+	struct Region
+	{
+		Rect rect;
+		float u0, v0;
+		float u1, v1;
+	};
+
+	struct Stats
+	{
+		uint32_t itemCount = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipCount = 0;
+		float occupancy = 0.0f;     // Item texels over atlas texels
+		double packTimeMs = 0.0;
+		double composeTimeMs = 0.0;
+	};
+
+public:
+	// Places the items, rects receive the item (not cell) rect of each in input
+	// order. False if they do not fit in maxSize.
+	static bool Pack(const std::vector<Rect>& sizes, const Settings& settings, uint32_t& outWidth, uint32_t& outHeight, std::vector<Rect>& outRects);
+
+	// Packs the sources and copies them in, RGBA8 with mips.
+	static bool Build(const std::vector<Source>& sources, const Settings& settings, Image& outAtlas, std::vector<Region>& outRegions, Stats* stats = nullptr);
+
+	// Levels the padding and alignment keep clean, level 0 included.
+	static uint32_t GetMipCount(const Settings& settings, uint32_t width, uint32_t height);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // ATLAS_PACKER_H
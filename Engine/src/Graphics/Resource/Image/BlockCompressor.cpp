@@ -0,0 +1,839 @@
+#include "BlockCompressor.h"
+#include "../../../Core/System/JobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	using PixelFormat = ImageTypes::PixelFormat;
+
+	// Texels of one block as planes, one array per channel, the layout the
+	// SIMD index search loads four texels at a time from.
+	struct alignas(16) BlockTexels
+	{
+		float channels[4][16];
+	};
+
+	// Weights of endpoint 0 by BC1 index, the palette is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1.
+	const float BC1_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	// Interpolation weights of BC7 4 bit indices, out of 64.
+	const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* texels)
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				std::memcpy(texels + (y * 4 + x) * 4, rgba + ((size_t)sourceY * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	void ToPlanes(const uint8_t* texels, BlockTexels& planes)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				planes.channels[c][i] = (float)texels[i * 4 + c];
+			}
+		}
+	}
+
+	// Nearest palette entry of each texel over the first channelCount channels,
+	// the first entry wins ties. Returns the summed squared error.
+	float SelectIndices(const BlockTexels& texels, int channelCount, const float (*palette)[4], int paletteSize, uint8_t* indices, bool useSimd)
+	{
+		float totalError = 0.0f;
+
+		if (useSimd)
+		{
+			for (int group = 0; group < 16; group += 4)
+			{
+				__m128 best = _mm_set1_ps(FLT_MAX);
+				__m128i bestIndex = _mm_setzero_si128();
+				for (int entry = 0; entry < paletteSize; entry++)
+				{
+					__m128 distance = _mm_setzero_ps();
+					for (int c = 0; c < channelCount; c++)
+					{
+						__m128 difference = _mm_sub_ps(_mm_load_ps(&texels.channels[c][group]), _mm_set1_ps(palette[entry][c]));
+						distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+					}
+
+					__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+					best = _mm_min_ps(distance, best);
+					bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(entry)), _mm_andnot_si128(closer, bestIndex));
+				}
+
+				alignas(16) int32_t lanes[4];
+				alignas(16) float errors[4];
+				_mm_store_si128((__m128i*)lanes, bestIndex);
+				_mm_store_ps(errors, best);
+				for (int i = 0; i < 4; i++)
+				{
+					indices[group + i] = (uint8_t)lanes[i];
+					totalError += errors[i];
+				}
+			}
+			return totalError;
+		}
+
+		for (int group = 0; group < 16; group += 4)
+		{
+			float errors[4];
+			for (int i = group; i < group + 4; i++)
+			{
+				float best = FLT_MAX;
+				int bestIndex = 0;
+				for (int entry = 0; entry < paletteSize; entry++)
+				{
+					float distance = 0.0f;
+					for (int c = 0; c < channelCount; c++)
+					{
+						float difference = texels.channels[c][i] - palette[entry][c];
+						distance = distance + difference * difference;
+					}
+					if (distance < best)
+					{
+						best = distance;
+						bestIndex = entry;
+					}
+				}
+				indices[i] = (uint8_t)bestIndex;
+				errors[i - group] = best;
+			}
+			for (int i = 0; i < 4; i++)
+			{
+				totalError += errors[i];
+			}
+		}
+		return totalError;
+	}
+
+	// Mean and principal axis of the texels, by power iteration on the covariance.
+	// The axis is zero for a block of one color.
+	void FitAxis(const BlockTexels& texels, int channelCount, float* mean, float* axis)
+	{
+		for (int c = 0; c < channelCount; c++)
+		{
+			float sum = 0.0f;
+			for (int i = 0; i < 16; i++)
+			{
+				sum += texels.channels[c][i];
+			}
+			mean[c] = sum / 16.0f;
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int a = 0; a < channelCount; a++)
+			{
+				float da = texels.channels[a][i] - mean[a];
+				for (int b = a; b < channelCount; b++)
+				{
+					covariance[a][b] += da * (texels.channels[b][i] - mean[b]);
+				}
+			}
+		}
+		for (int a = 0; a < channelCount; a++)
+		{
+			for (int b = 0; b < a; b++)
+			{
+				covariance[a][b] = covariance[b][a];
+			}
+		}
+
+		// Start from the row of the widest channel, it cannot be orthogonal to the answer.
+		int widest = 0;
+		for (int c = 1; c < channelCount; c++)
+		{
+			if (covariance[c][c] > covariance[widest][widest])
+			{
+				widest = c;
+			}
+		}
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] = covariance[widest][c];
+		}
+
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float largest = 0.0f;
+			for (int a = 0; a < channelCount; a++)
+			{
+				for (int b = 0; b < channelCount; b++)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				largest = std::max(largest, std::fabs(next[a]));
+			}
+			if (largest <= 0.0f)
+			{
+				break;
+			}
+			for (int c = 0; c < channelCount; c++)
+			{
+				axis[c] = next[c] / largest;
+			}
+		}
+
+		float lengthSq = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			lengthSq += axis[c] * axis[c];
+		}
+		float invLength = lengthSq > 0.0f ? 1.0f / std::sqrt(lengthSq) : 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] *= invLength;
+		}
+	}
+
+	// Endpoints at the extremes of the texels projected onto the axis.
+	void FitEndpoints(const BlockTexels& texels, int channelCount, float* endpoint0, float* endpoint1)
+	{
+		float mean[4], axis[4];
+		FitAxis(texels, channelCount, mean, axis);
+
+		float minimum = FLT_MAX, maximum = -FLT_MAX;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channelCount; c++)
+			{
+				t += (texels.channels[c][i] - mean[c]) * axis[c];
+			}
+			minimum = std::min(minimum, t);
+			maximum = std::max(maximum, t);
+		}
+
+		for (int c = 0; c < channelCount; c++)
+		{
+			endpoint0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maximum));
+			endpoint1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minimum));
+		}
+	}
+
+	// Least squares endpoints for indices already chosen, weights[index] is
+	// the share of endpoint 0. False when the indices do not pin both down.
+	bool RefineEndpoints(const BlockTexels& texels, int channelCount, const uint8_t* indices, const float* weights, float* endpoint0, float* endpoint1)
+	{
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float alpha = weights[indices[i]];
+			float beta = 1.0f - alpha;
+			aa += alpha * alpha;
+			bb += beta * beta;
+			ab += alpha * beta;
+			for (int c = 0; c < channelCount; c++)
+			{
+				ax[c] += alpha * texels.channels[c][i];
+				bx[c] += beta * texels.channels[c][i];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1.0e-6f)
+		{
+			return false;
+		}
+
+		float invDeterminant = 1.0f / determinant;
+		for (int c = 0; c < channelCount; c++)
+		{
+			endpoint0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) * invDeterminant));
+			endpoint1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) * invDeterminant));
+		}
+		return true;
+	}
+
+	void WriteUInt16(uint8_t* output, uint16_t value)
+	{
+		output[0] = (uint8_t)(value & 0xFF);
+		output[1] = (uint8_t)(value >> 8);
+	}
+
+	uint16_t ReadUInt16(const uint8_t* data)
+	{
+		return (uint16_t)(data[0] | (data[1] << 8));
+	}
+
+	// Appends bits least significant first, the order BC7 fields are stored in.
+	struct BitWriter
+	{
+		uint8_t* output;
+		int position;
+
+		void Write(uint32_t value, int bits)
+		{
+			for (int i = 0; i < bits; i++, position++)
+			{
+				if (value & (1u << i))
+				{
+					output[position >> 3] |= (uint8_t)(1u << (position & 7));
+				}
+			}
+		}
+	};
+
+	struct BitReader
+	{
+		const uint8_t* data;
+		int position;
+
+		uint32_t Read(int bits)
+		{
+			uint32_t value = 0;
+			for (int i = 0; i < bits; i++, position++)
+			{
+				value |= (uint32_t)((data[position >> 3] >> (position & 7)) & 1) << i;
+			}
+			return value;
+		}
+	};
+
+	// BC1
+
+	uint16_t PackRGB565(const float* color)
+	{
+		int r = (int)std::lround(color[0] * 31.0f / 255.0f);
+		int g = (int)std::lround(color[1] * 63.0f / 255.0f);
+		int b = (int)std::lround(color[2] * 31.0f / 255.0f);
+		return (uint16_t)((std::min(r, 31) << 11) | (std::min(g, 63) << 5) | std::min(b, 31));
+	}
+
+	void UnpackRGB565(uint16_t packed, int* color)
+	{
+		int r = packed >> 11, g = (packed >> 5) & 0x3F, b = packed & 0x1F;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	// Palette as the decoder builds it. Three color mode (color0 <= color1)
+	// has black at index 3, which only BC1 itself interprets as transparent.
+	void BuildBC1Palette(uint16_t color0, uint16_t color1, bool fourColor, int (*palette)[4])
+	{
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			if (fourColor)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		palette[3][3] = fourColor ? 255 : 0;
+	}
+
+	// Encodes the quantized endpoints in four color mode and writes the block.
+	float EncodeBC1Endpoints(const BlockTexels& texels, const float* endpoint0, const float* endpoint1, uint8_t* output, uint8_t* indices, bool useSimd)
+	{
+		uint16_t color0 = PackRGB565(endpoint0);
+		uint16_t color1 = PackRGB565(endpoint1);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		// Equal colors fall into three color mode, index 0 still decodes to the color.
+		int palette[4][4];
+		BuildBC1Palette(color0, color1, true, palette);
+		float paletteValues[4][4];
+		for (int entry = 0; entry < 4; entry++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				paletteValues[entry][c] = (float)palette[entry][c];
+			}
+		}
+
+		float error = SelectIndices(texels, 3, paletteValues, color0 == color1 ? 1 : 4, indices, useSimd);
+
+		WriteUInt16(output, color0);
+		WriteUInt16(output + 2, color1);
+		uint32_t packed = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			packed |= (uint32_t)indices[i] << (i * 2);
+		}
+		std::memcpy(output + 4, &packed, sizeof(packed));
+		return error;
+	}
+
+	void EncodeBC1(const BlockTexels& texels, uint8_t* output, bool useSimd)
+	{
+		float endpoint0[4], endpoint1[4];
+		FitEndpoints(texels, 3, endpoint0, endpoint1);
+
+		uint8_t indices[16];
+		float error = EncodeBC1Endpoints(texels, endpoint0, endpoint1, output, indices, useSimd);
+
+		uint8_t refined[8];
+		uint8_t refinedIndices[16];
+		if (error > 0.0f && RefineEndpoints(texels, 3, indices, BC1_WEIGHTS, endpoint0, endpoint1) &&
+			EncodeBC1Endpoints(texels, endpoint0, endpoint1, refined, refinedIndices, useSimd) < error)
+		{
+			std::memcpy(output, refined, sizeof(refined));
+		}
+	}
+
+	void DecodeBC1(const uint8_t* block, bool forceFourColor, uint8_t* texels)
+	{
+		uint16_t color0 = ReadUInt16(block);
+		uint16_t color1 = ReadUInt16(block + 2);
+		int palette[4][4];
+		BuildBC1Palette(color0, color1, forceFourColor || color0 > color1, palette);
+
+		uint32_t packed;
+		std::memcpy(&packed, block + 4, sizeof(packed));
+		for (int i = 0; i < 16; i++)
+		{
+			const int* color = palette[(packed >> (i * 2)) & 3];
+			for (int c = 0; c < 4; c++)
+			{
+				texels[i * 4 + c] = (uint8_t)color[c];
+			}
+		}
+	}
+
+	// BC4, one channel of the block
+
+	void BuildBC4Palette(int endpoint0, int endpoint1, int* palette)
+	{
+		palette[0] = endpoint0;
+		palette[1] = endpoint1;
+		if (endpoint0 > endpoint1)
+		{
+			for (int i = 2; i < 8; i++)
+			{
+				palette[i] = ((8 - i) * endpoint0 + (i - 1) * endpoint1) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 2; i < 6; i++)
+			{
+				palette[i] = ((6 - i) * endpoint0 + (i - 1) * endpoint1) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void EncodeBC4(const BlockTexels& texels, int channel, uint8_t* output, bool useSimd)
+	{
+		BlockTexels plane;
+		float minimum = 255.0f, maximum = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			plane.channels[0][i] = texels.channels[channel][i];
+			minimum = std::min(minimum, plane.channels[0][i]);
+			maximum = std::max(maximum, plane.channels[0][i]);
+		}
+
+		// Eight values between the extremes, or a single one for flat blocks.
+		int endpoint0 = (int)maximum;
+		int endpoint1 = (int)minimum;
+		int palette[8];
+		BuildBC4Palette(endpoint0, endpoint1, palette);
+		float paletteValues[8][4];
+		for (int entry = 0; entry < 8; entry++)
+		{
+			paletteValues[entry][0] = (float)palette[entry];
+		}
+
+		uint8_t indices[16];
+		SelectIndices(plane, 1, paletteValues, endpoint0 == endpoint1 ? 1 : 8, indices, useSimd);
+
+		output[0] = (uint8_t)endpoint0;
+		output[1] = (uint8_t)endpoint1;
+		uint64_t packed = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			packed |= (uint64_t)indices[i] << (i * 3);
+		}
+		for (int i = 0; i < 6; i++)
+		{
+			output[2 + i] = (uint8_t)(packed >> (i * 8));
+		}
+	}
+
+	void DecodeBC4(const uint8_t* block, uint8_t* texels, int channel)
+	{
+		int palette[8];
+		BuildBC4Palette(block[0], block[1], palette);
+
+		uint64_t packed = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			packed |= (uint64_t)block[2 + i] << (i * 8);
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			texels[i * 4 + channel] = (uint8_t)palette[(packed >> (i * 3)) & 7];
+		}
+	}
+
+	// BC7 mode 6
+
+	// 7 bits and a p-bit shared by the endpoint's channels, the p-bit that lands closer wins.
+	void QuantizeBC7Endpoint(const float* value, int* quantized, int& pBit)
+	{
+		float bestError = FLT_MAX;
+		for (int p = 0; p < 2; p++)
+		{
+			int candidate[4];
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				candidate[c] = std::min(127, std::max(0, (int)std::lround((value[c] - (float)p) * 0.5f)));
+				float difference = (float)((candidate[c] << 1) | p) - value[c];
+				error += difference * difference;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				pBit = p;
+				std::copy(candidate, candidate + 4, quantized);
+			}
+		}
+	}
+
+	void BuildBC7Palette(const int* endpoint0, const int* endpoint1, int (*palette)[4])
+	{
+		for (int entry = 0; entry < 16; entry++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				palette[entry][c] = ((64 - BC7_WEIGHTS[entry]) * endpoint0[c] + BC7_WEIGHTS[entry] * endpoint1[c] + 32) >> 6;
+			}
+		}
+	}
+
+	float EncodeBC7Endpoints(const BlockTexels& texels, const float* endpoint0, const float* endpoint1, uint8_t* output, uint8_t* indices, bool useSimd)
+	{
+		int quantized[2][4];
+		int pBits[2];
+		QuantizeBC7Endpoint(endpoint0, quantized[0], pBits[0]);
+		QuantizeBC7Endpoint(endpoint1, quantized[1], pBits[1]);
+
+		int expanded[2][4];
+		for (int e = 0; e < 2; e++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				expanded[e][c] = (quantized[e][c] << 1) | pBits[e];
+			}
+		}
+
+		int palette[16][4];
+		BuildBC7Palette(expanded[0], expanded[1], palette);
+		float paletteValues[16][4];
+		for (int entry = 0; entry < 16; entry++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				paletteValues[entry][c] = (float)palette[entry][c];
+			}
+		}
+
+		float error = SelectIndices(texels, 4, paletteValues, 16, indices, useSimd);
+
+		// The first index is stored with three bits, so its top bit must be zero.
+		if (indices[0] & 8)
+		{
+			std::swap(quantized[0], quantized[1]);
+			std::swap(pBits[0], pBits[1]);
+			for (int i = 0; i < 16; i++)
+			{
+				indices[i] = (uint8_t)(15 - indices[i]);
+			}
+		}
+
+		std::memset(output, 0, 16);
+		BitWriter writer = { output, 0 };
+		writer.Write(1u << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.Write((uint32_t)quantized[0][c], 7);
+			writer.Write((uint32_t)quantized[1][c], 7);
+		}
+		writer.Write((uint32_t)pBits[0], 1);
+		writer.Write((uint32_t)pBits[1], 1);
+		for (int i = 0; i < 16; i++)
+		{
+			writer.Write(indices[i], i == 0 ? 3 : 4);
+		}
+		return error;
+	}
+
+	void EncodeBC7(const BlockTexels& texels, uint8_t* output, bool useSimd)
+	{
+		float endpoint0[4], endpoint1[4];
+		FitEndpoints(texels, 4, endpoint0, endpoint1);
+
+		uint8_t indices[16];
+		float error = EncodeBC7Endpoints(texels, endpoint0, endpoint1, output, indices, useSimd);
+
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+		{
+			weights[i] = (float)(64 - BC7_WEIGHTS[i]) / 64.0f;
+		}
+
+		uint8_t refined[16];
+		uint8_t refinedIndices[16];
+		if (error > 0.0f && RefineEndpoints(texels, 4, indices, weights, endpoint0, endpoint1) &&
+			EncodeBC7Endpoints(texels, endpoint0, endpoint1, refined, refinedIndices, useSimd) < error)
+		{
+			std::memcpy(output, refined, sizeof(refined));
+		}
+	}
+
+	bool DecodeBC7(const uint8_t* block, uint8_t* texels)
+	{
+		BitReader reader = { block, 0 };
+		if (reader.Read(7) != (1u << 6))
+		{
+			return false;
+		}
+
+		int endpoints[2][4];
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = (int)reader.Read(7) << 1;
+			endpoints[1][c] = (int)reader.Read(7) << 1;
+		}
+		int pBit0 = (int)reader.Read(1);
+		int pBit1 = (int)reader.Read(1);
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] |= pBit0;
+			endpoints[1][c] |= pBit1;
+		}
+
+		int palette[16][4];
+		BuildBC7Palette(endpoints[0], endpoints[1], palette);
+		for (int i = 0; i < 16; i++)
+		{
+			const int* color = palette[reader.Read(i == 0 ? 3 : 4)];
+			for (int c = 0; c < 4; c++)
+			{
+				texels[i * 4 + c] = (uint8_t)color[c];
+			}
+		}
+		return true;
+	}
+
+	void EncodeBlock(PixelFormat format, const BlockTexels& texels, uint8_t* output, bool useSimd)
+	{
+		switch (format)
+		{
+		case ImageTypes::FORMAT_BC1:
+			EncodeBC1(texels, output, useSimd);
+			break;
+		case ImageTypes::FORMAT_BC3:
+			EncodeBC4(texels, 3, output, useSimd);
+			EncodeBC1(texels, output + 8, useSimd);
+			break;
+		case ImageTypes::FORMAT_BC4:
+			EncodeBC4(texels, 0, output, useSimd);
+			break;
+		case ImageTypes::FORMAT_BC5:
+			EncodeBC4(texels, 0, output, useSimd);
+			EncodeBC4(texels, 1, output + 8, useSimd);
+			break;
+		case ImageTypes::FORMAT_BC7:
+			EncodeBC7(texels, output, useSimd);
+			break;
+		default:
+			break;
+		}
+	}
+
+	bool DecodeBlock(PixelFormat format, const uint8_t* block, uint8_t* texels)
+	{
+		// Channels a format does not store read as 0, alpha as opaque.
+		for (int i = 0; i < 16; i++)
+		{
+			texels[i * 4 + 0] = texels[i * 4 + 1] = texels[i * 4 + 2] = 0;
+			texels[i * 4 + 3] = 255;
+		}
+
+		switch (format)
+		{
+		case ImageTypes::FORMAT_BC1:
+			DecodeBC1(block, false, texels);
+			return true;
+		case ImageTypes::FORMAT_BC2:
+			DecodeBC1(block + 8, true, texels);
+			for (int i = 0; i < 16; i++)
+			{
+				// Explicit 4 bit alpha, low nibble first.
+				uint8_t alpha = (uint8_t)((block[i / 2] >> ((i & 1) * 4)) & 0xF);
+				texels[i * 4 + 3] = (uint8_t)(alpha * 17);
+			}
+			return true;
+		case ImageTypes::FORMAT_BC3:
+			DecodeBC1(block + 8, true, texels);
+			DecodeBC4(block, texels, 3);
+			return true;
+		case ImageTypes::FORMAT_BC4:
+			DecodeBC4(block, texels, 0);
+			return true;
+		case ImageTypes::FORMAT_BC5:
+			DecodeBC4(block, texels, 0);
+			DecodeBC4(block + 8, texels, 1);
+			return true;
+		case ImageTypes::FORMAT_BC7:
+			return DecodeBC7(block, texels);
+		default:
+			return false;
+		}
+	}
+}
+
+size_t BlockCompressor::GetBlockBytes(PixelFormat format)
+{
+	switch (format)
+	{
+	case ImageTypes::FORMAT_BC1:
+	case ImageTypes::FORMAT_BC4:
+		return 8;
+	case ImageTypes::FORMAT_BC2:
+	case ImageTypes::FORMAT_BC3:
+	case ImageTypes::FORMAT_BC5:
+	case ImageTypes::FORMAT_BC6H:
+	case ImageTypes::FORMAT_BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+uint32_t BlockCompressor::GetRowPitch(PixelFormat format, uint32_t width)
+{
+	size_t blockBytes = GetBlockBytes(format);
+	if (blockBytes == 0)
+	{
+		return format == ImageTypes::FORMAT_RGBA8 || format == ImageTypes::FORMAT_BGRA8 ? width * 4 : 0;
+	}
+	return (uint32_t)(((width + 3) / 4) * blockBytes);
+}
+
+size_t BlockCompressor::GetLevelSize(PixelFormat format, uint32_t width, uint32_t height)
+{
+	uint32_t rows = IsBlockCompressed(format) ? (height + 3) / 4 : height;
+	return (size_t)GetRowPitch(format, width) * rows;
+}
+
+const char* BlockCompressor::GetFormatName(PixelFormat format)
+{
+	switch (format)
+	{
+	case ImageTypes::FORMAT_RGBA8: return "RGBA8";
+	case ImageTypes::FORMAT_BC1: return "BC1";
+	case ImageTypes::FORMAT_BC3: return "BC3";
+	case ImageTypes::FORMAT_BC4: return "BC4";
+	case ImageTypes::FORMAT_BC5: return "BC5";
+	case ImageTypes::FORMAT_BC7: return "BC7";
+	case ImageTypes::FORMAT_BGRA8: return "BGRA8";
+	case ImageTypes::FORMAT_BC2: return "BC2";
+	case ImageTypes::FORMAT_BC6H: return "BC6H";
+	default: return "unknown";
+	}
+}
+
+bool BlockCompressor::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, PixelFormat format, uint8_t* output, const Settings& settings)
+{
+	// BC2 and BC6H are only ever loaded from files, there is no encoder for them.
+	size_t blockBytes = GetBlockBytes(format);
+	if (!rgba || !output || width == 0 || height == 0 || blockBytes == 0 || format == ImageTypes::FORMAT_BC2 || format == ImageTypes::FORMAT_BC6H)
+	{
+		return false;
+	}
+
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+
+	auto compressRows = [&](size_t firstRow, size_t lastRow)
+	{
+		uint8_t texels[64];
+		BlockTexels planes;
+		for (size_t blockY = firstRow; blockY < lastRow; blockY++)
+		{
+			for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+			{
+				LoadBlock(rgba, width, height, blockX, (uint32_t)blockY, texels);
+				ToPlanes(texels, planes);
+				EncodeBlock(format, planes, output + (blockY * blocksWide + blockX) * blockBytes, settings.useSimd);
+			}
+		}
+	};
+
+	// Blocks are independent, a row of them is one job.
+	if (settings.parallel)
+	{
+		JobSystem::GetInstance().ParallelFor(blocksHigh, 1, compressRows);
+	}
+	else
+	{
+		compressRows(0, blocksHigh);
+	}
+
+	return true;
+}
+
+bool BlockCompressor::Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, PixelFormat format, uint8_t* rgba)
+{
+	size_t blockBytes = GetBlockBytes(format);
+	if (!blocks || !rgba || width == 0 || height == 0 || blockBytes == 0)
+	{
+		return false;
+	}
+
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+	uint8_t texels[64];
+	for (uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			if (!DecodeBlock(format, blocks + ((size_t)blockY * blocksWide + blockX) * blockBytes, texels))
+			{
+				return false;
+			}
+
+			for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++)
+			{
+				for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+				{
+					std::memcpy(rgba + ((size_t)(blockY * 4 + y) * width + blockX * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,46 @@
+#ifndef BLOCK_COMPRESSOR_H
+#define BLOCK_COMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ImageTypes.h"
+
+// Encodes RGBA8 images to the BC formats the textures are cooked to.
+// - BC1 and BC7 fit the endpoints to the principal axis of the block's
+//   colors, refine them once by least squares and keep whichever fit has the
+//   smaller error. BC7 is written in mode 6 (one subset, RGBA endpoints with
+//   p-bits, 4 bit indices), which handles gradients and alpha well.
+// - BC4 spans the block's range with the eight-value mode. BC3 and BC5
+//   combine BC1 and BC4 blocks.
+// - Indices pick the nearest palette entry for four texels at a time with
+//   SSE. Block rows are spread over the job system.
+// Decompress is the matching reference decoder, for BC7 it reads mode 6 only.
+// BC2 decodes as well; BC6H, found in loaded DDS and KTX2 files, does not.
+class BlockCompressor
+{
+public:
+	using PixelFormat = ImageTypes::PixelFormat;
+
+	struct Settings
+	{
+		bool useSimd = true;
+		bool parallel = true;
+	};
+
+public:
+	// Bytes per 4x4 block, 0 for formats that are not block compressed.
+	static size_t GetBlockBytes(PixelFormat format);
+	static bool IsBlockCompressed(PixelFormat format) { return GetBlockBytes(format) != 0; }
+	// Row pitch and total size of one level, for any format.
+	static uint32_t GetRowPitch(PixelFormat format, uint32_t width);
+	static size_t GetLevelSize(PixelFormat format, uint32_t width, uint32_t height);
+	static const char* GetFormatName(PixelFormat format);
+
+	// rgba holds width * height texels, output receives GetLevelSize bytes.
+	// Partial edge blocks repeat the last row and column.
+	static bool Compress(const uint8_t* rgba, uint32_t width, uint32_t height, PixelFormat format, uint8_t* output, const Settings& settings);
+	static bool Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, PixelFormat format, uint8_t* rgba);
+};
+
+#endif // BLOCK_COMPRESSOR_H
@@ -0,0 +1,324 @@
+#include "DdsFile.h"
+#include "BlockCompressor.h"
+#include "../../../Core/System/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	const uint32_t DDS_MAGIC = 0x20534444;          // "DDS "
+	const uint32_t FOURCC_DX10 = 0x30315844;        // "DX10"
+	const uint32_t FOURCC_DXT1 = 0x31545844;        // "DXT1"
+	const uint32_t FOURCC_DXT2 = 0x32545844;
+	const uint32_t FOURCC_DXT3 = 0x33545844;
+	const uint32_t FOURCC_DXT4 = 0x34545844;
+	const uint32_t FOURCC_DXT5 = 0x35545844;
+	const uint32_t FOURCC_ATI1 = 0x31495441;        // "ATI1", BC4
+	const uint32_t FOURCC_BC4U = 0x55344342;        // "BC4U"
+	const uint32_t FOURCC_ATI2 = 0x32495441;        // "ATI2", BC5
+	const uint32_t FOURCC_BC5U = 0x55354342;        // "BC5U"
+	const uint32_t COOKER_TAG = 0x58544345;         // "ECTX"
+	const uint32_t COOKER_TAG_VERSION = 2;       // 2: filtered mips, see MipGenerator
+
+	const uint32_t DDSD_CAPS = 0x1;
+	const uint32_t DDSD_HEIGHT = 0x2;
+	const uint32_t DDSD_WIDTH = 0x4;
+	const uint32_t DDSD_PIXELFORMAT = 0x1000;
+	const uint32_t DDSD_PITCH = 0x8;
+	const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	const uint32_t DDSD_LINEARSIZE = 0x80000;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDPF_RGB = 0x40;
+	const uint32_t DDSCAPS_COMPLEX = 0x8;
+	const uint32_t DDSCAPS_TEXTURE = 0x1000;
+	const uint32_t DDSCAPS_MIPMAP = 0x400000;
+	const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+	const uint32_t DDSCAPS2_VOLUME = 0x200000;
+	const uint32_t DIMENSION_TEXTURE2D = 3;
+	const uint32_t MISC_TEXTURECUBE = 0x4;
+
+	struct DdsPixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	};
+
+	struct DdsHeader
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];     // The cooker tag, see WriteTag
+		DdsPixelFormat pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+
+	struct DdsHeaderDx10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	static_assert(sizeof(DdsHeader) == 124, "DDS header layout");
+	static_assert(sizeof(DdsHeaderDx10) == 20, "DDS DX10 header layout");
+
+	const size_t LEGACY_DATA_OFFSET = sizeof(uint32_t) + sizeof(DdsHeader);
+	const size_t DATA_OFFSET = LEGACY_DATA_OFFSET + sizeof(DdsHeaderDx10);
+
+	// The DXGI format of a header without the DX10 extension, 0 if unsupported.
+	uint32_t GetLegacyFormat(const DdsPixelFormat& pixelFormat)
+	{
+		if (pixelFormat.flags & DDPF_FOURCC)
+		{
+			switch (pixelFormat.fourCC)
+			{
+			case FOURCC_DXT1: return 71;
+			case FOURCC_DXT2:
+			case FOURCC_DXT3: return 74;
+			case FOURCC_DXT4:
+			case FOURCC_DXT5: return 77;
+			case FOURCC_ATI1:
+			case FOURCC_BC4U: return 80;
+			case FOURCC_ATI2:
+			case FOURCC_BC5U: return 83;
+			default: return 0;
+			}
+		}
+
+		// Only 8 bits per channel with alpha; other masks would need converting.
+		if ((pixelFormat.flags & DDPF_RGB) && pixelFormat.rgbBitCount == 32 && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.aBitMask == 0xFF000000)
+		{
+			if (pixelFormat.rBitMask == 0x000000FF && pixelFormat.bBitMask == 0x00FF0000)
+			{
+				return 28;
+			}
+			if (pixelFormat.rBitMask == 0x00FF0000 && pixelFormat.bBitMask == 0x000000FF)
+			{
+				return 87;
+			}
+		}
+		return 0;
+	}
+
+	// reserved1: tag, version, source size (low, high), source time (low, high), role.
+	void WriteTag(const DdsFile::SourceTag& tag, uint32_t* reserved)
+	{
+		reserved[0] = COOKER_TAG;
+		reserved[1] = COOKER_TAG_VERSION;
+		reserved[2] = (uint32_t)tag.size;
+		reserved[3] = (uint32_t)(tag.size >> 32);
+		reserved[4] = (uint32_t)((uint64_t)tag.timestamp);
+		reserved[5] = (uint32_t)((uint64_t)tag.timestamp >> 32);
+		reserved[6] = (uint32_t)tag.role;
+	}
+
+	bool ReadTag(const uint32_t* reserved, DdsFile::SourceTag& tag)
+	{
+		if (reserved[0] != COOKER_TAG || reserved[1] != COOKER_TAG_VERSION)
+		{
+			return false;
+		}
+
+		tag.size = (uint64_t)reserved[2] | ((uint64_t)reserved[3] << 32);
+		tag.timestamp = (int64_t)((uint64_t)reserved[4] | ((uint64_t)reserved[5] << 32));
+		tag.role = (ImageTypes::TextureRole)reserved[6];
+		return true;
+	}
+}
+
+DdsFile::DdsFile()
+{
+	m_hasTag = false;
+}
+
+DdsFile::~DdsFile()
+{
+	Close();
+}
+
+bool DdsFile::Write(const std::string& filename, const Image& image, const SourceTag& tag)
+{
+	uint32_t dxgiFormat = GetDxgiFormat(image.format);
+	if (dxgiFormat == 0 || image.levels.empty() || image.layers == 0 || image.levels.size() % image.layers != 0 ||
+		(image.cubemap && image.layers % 6 != 0))
+	{
+		LOG_ERROR("DdsFile::Write - Nothing to write for " + filename);
+		return false;
+	}
+
+	uint32_t mipCount = (uint32_t)(image.levels.size() / image.layers);
+	bool compressed = BlockCompressor::IsBlockCompressed(image.format);
+
+	DdsHeader header = {};
+	header.size = sizeof(DdsHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | (compressed ? DDSD_LINEARSIZE : DDSD_PITCH);
+	header.height = image.height;
+	header.width = image.width;
+	header.pitchOrLinearSize = compressed ? (uint32_t)image.levels[0].size : image.levels[0].rowPitch;
+	header.mipMapCount = mipCount;
+	WriteTag(tag, header.reserved1);
+	header.pixelFormat.size = sizeof(DdsPixelFormat);
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.pixelFormat.fourCC = FOURCC_DX10;
+	header.caps = DDSCAPS_TEXTURE | (mipCount > 1 || image.layers > 1 ? DDSCAPS_COMPLEX : 0) | (mipCount > 1 ? DDSCAPS_MIPMAP : 0);
+	header.caps2 = image.cubemap ? DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES : 0;
+
+	DdsHeaderDx10 extension = {};
+	extension.dxgiFormat = dxgiFormat;
+	extension.resourceDimension = DIMENSION_TEXTURE2D;
+	extension.miscFlag = image.cubemap ? MISC_TEXTURECUBE : 0;
+	extension.arraySize = image.cubemap ? image.layers / 6 : image.layers;
+	// Write to a temporary file first so a failed cook never leaves a truncated texture behind.
+	std::string tempFilename = filename + ".tmp";
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (!fout)
+	{
+		LOG_ERROR("DdsFile::Write - Failed to open " + tempFilename);
+		return false;
+	}
+
+	fout.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(&extension), sizeof(extension));
+	for (const ImageLevel& level : image.levels)
+	{
+		fout.write(reinterpret_cast<const char*>(image.data.data() + level.offset), (std::streamsize)level.size);
+	}
+
+	fout.close();
+	if (!fout)
+	{
+		LOG_ERROR("DdsFile::Write - Failed to write " + tempFilename);
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, filename, error);
+	if (error)
+	{
+		LOG_ERROR("DdsFile::Write - Failed to move cooked texture into place: " + error.message());
+		std::filesystem::remove(tempFilename, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool DdsFile::Open(const std::string& filename)
+{
+	if (!Map(filename))
+	{
+		return false;
+	}
+
+	const uint8_t* data = m_file.GetData();
+	size_t size = m_file.GetSize();
+
+	// Validate the headers before trusting any size.
+	uint32_t magic = 0;
+	DdsHeader header;
+	if (size < LEGACY_DATA_OFFSET)
+	{
+		LOG_WARNING("DdsFile::Open - File too small: " + filename);
+		Close();
+		return false;
+	}
+	std::memcpy(&magic, data, sizeof(magic));
+	std::memcpy(&header, data + sizeof(magic), sizeof(header));
+
+	if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader))
+	{
+		LOG_WARNING("DdsFile::Open - Not a DDS file: " + filename);
+		Close();
+		return false;
+	}
+
+	size_t offset = LEGACY_DATA_OFFSET;
+	uint32_t dxgiFormat = 0;
+	uint32_t layerCount = 1;
+	bool cubemap = false;
+	bool supported = true;
+	if ((header.pixelFormat.flags & DDPF_FOURCC) && header.pixelFormat.fourCC == FOURCC_DX10)
+	{
+		DdsHeaderDx10 extension;
+		if (size < DATA_OFFSET)
+		{
+			LOG_WARNING("DdsFile::Open - File too small: " + filename);
+			Close();
+			return false;
+		}
+		std::memcpy(&extension, data + LEGACY_DATA_OFFSET, sizeof(extension));
+		offset = DATA_OFFSET;
+
+		dxgiFormat = extension.dxgiFormat;
+		cubemap = (extension.miscFlag & MISC_TEXTURECUBE) != 0;
+		layerCount = std::max(extension.arraySize, 1u) * (cubemap ? 6 : 1);
+		supported = extension.resourceDimension == DIMENSION_TEXTURE2D;
+	}
+	else
+	{
+		// Legacy cubemaps list the faces they have; all six are required.
+		dxgiFormat = GetLegacyFormat(header.pixelFormat);
+		cubemap = (header.caps2 & DDSCAPS2_CUBEMAP) != 0;
+		layerCount = cubemap ? 6 : 1;
+		supported = !(header.caps2 & DDSCAPS2_VOLUME) && (!cubemap || (header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) == DDSCAPS2_CUBEMAP_ALLFACES);
+	}
+
+	if (!supported || !SetLayout(dxgiFormat, header.width, header.height, std::max(header.mipMapCount, 1u), layerCount, cubemap))
+	{
+		LOG_WARNING("DdsFile::Open - Unsupported DDS layout or format " + std::to_string(dxgiFormat) + ": " + filename);
+		Close();
+		return false;
+	}
+	m_hasTag = ReadTag(header.reserved1, m_tag);
+
+	for (uint32_t layer = 0; layer < m_layerCount; layer++)
+	{
+		for (uint32_t mip = 0; mip < m_mipCount; mip++)
+		{
+			AddLevel(mip, offset);
+			offset += m_levels.back().size;
+		}
+	}
+
+	if (!FinishLayout())
+	{
+		LOG_WARNING("DdsFile::Open - Truncated mip levels: " + filename);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void DdsFile::Close()
+{
+	TextureFile::Close();
+	m_hasTag = false;
+	m_tag = SourceTag();
+}
+
+bool DdsFile::IsUpToDate(const SourceTag& source) const
+{
+	return m_hasTag && m_tag.size == source.size && m_tag.timestamp == source.timestamp && m_tag.role == source.role;
+}
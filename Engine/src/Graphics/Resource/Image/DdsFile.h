@@ -0,0 +1,53 @@
+#ifndef DDS_FILE_H
+#define DDS_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImageTypes.h"
+#include "TextureFile.h"
+
+// DDS files, read and written with the DX10 extension header so any DDS
+// viewer opens them. The levels follow the headers tightly packed, layer
+// by layer and largest first, exactly as texture creation takes them.
+// Reading also takes the legacy header: DXT1-5, ATI1/ATI2 (BC4/BC5) and
+// 32 bit RGBA or BGRA masks, with mips and cubemaps; volume textures and
+// other pixel layouts are refused.
+//
+// The cooker tags its files in the header's reserved words with the size and
+// write time of the source image and the role it was cooked for, so stale
+// files are re-cooked like cooked meshes are.
+class DdsFile : public TextureFile
+{
+public:
+	using TextureRole = ImageTypes::TextureRole;
+	using Image = ImageTypes::Image;
+
+	struct SourceTag
+	{
+		uint64_t size = 0;
+		int64_t timestamp = 0;
+		TextureRole role = ImageTypes::ROLE_NONE;
+	};
+
+public:
+	DdsFile();
+	~DdsFile() override;
+
+	// Writes every level of the image; layers and cubemaps become an array.
+	static bool Write(const std::string& filename, const Image& image, const SourceTag& tag);
+
+	bool Open(const std::string& filename) override;
+	void Close() override;
+
+	// True if the file carries a cooker tag that matches the source.
+	bool IsUpToDate(const SourceTag& source) const;
+
+private:
+	bool m_hasTag;
+	SourceTag m_tag;
+};
+
+#endif // DDS_FILE_H
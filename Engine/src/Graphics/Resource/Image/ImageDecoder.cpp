@@ -0,0 +1,216 @@
+#include "ImageDecoder.h"
+#include "JpegDecoder.h"
+#include "PngDecoder.h"
+#include "TargaDecoder.h"
+#include "../../../Core/System/JobSystem.h"
+#include "../../../Core/System/MappedFile.h"
+#include <chrono>
+#include <cstring>
+
+ImageDecoder::Format ImageDecoder::Identify(const uint8_t* data, size_t size)
+{
+	static const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	if (size >= sizeof(PNG_SIGNATURE) && memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0)
+	{
+		return FORMAT_PNG;
+	}
+
+	// Start of image, followed by the first marker.
+	if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+	{
+		return FORMAT_JPEG;
+	}
+
+	// TGA headers are 18 bytes without a magic number.
+	if (size >= 18)
+	{
+		return FORMAT_TGA;
+	}
+
+	return FORMAT_UNKNOWN;
+}
+
+const char* ImageDecoder::GetFormatName(Format format)
+{
+	switch (format)
+	{
+	case FORMAT_TGA: return "TGA";
+	case FORMAT_PNG: return "PNG";
+	case FORMAT_JPEG: return "JPEG";
+	default: return "unknown";
+	}
+}
+
+bool ImageDecoder::ReadInfo(const uint8_t* data, size_t size, Info& info)
+{
+	info = Info();
+	info.format = Identify(data, size);
+
+	switch (info.format)
+	{
+	case FORMAT_TGA:
+	{
+		TargaDecoder::Header header;
+		if (!TargaDecoder::ReadHeader(data, size, header))
+		{
+			return false;
+		}
+		info.width = header.width;
+		info.height = header.height;
+		return true;
+	}
+	case FORMAT_PNG:
+	{
+		PngDecoder::Header header;
+		if (!PngDecoder::ReadHeader(data, size, header))
+		{
+			return false;
+		}
+		info.width = header.width;
+		info.height = header.height;
+		return true;
+	}
+	case FORMAT_JPEG:
+	{
+		JpegDecoder::Header header;
+		if (!JpegDecoder::ReadHeader(data, size, header))
+		{
+			return false;
+		}
+		info.width = header.width;
+		info.height = header.height;
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+bool ImageDecoder::Decode(const uint8_t* data, size_t size, const Info& info, uint8_t* output, const Settings& settings)
+{
+	// The format headers are cheap to read again, Info only keeps what callers need.
+	switch (info.format)
+	{
+	case FORMAT_TGA:
+	{
+		TargaDecoder::Header header;
+		TargaDecoder::Settings targaSettings;
+		targaSettings.useSimd = settings.useSimd;
+		return TargaDecoder::ReadHeader(data, size, header) && TargaDecoder::Decode(data, size, header, output, targaSettings);
+	}
+	case FORMAT_PNG:
+	{
+		PngDecoder::Header header;
+		PngDecoder::Settings pngSettings;
+		pngSettings.useSimd = settings.useSimd;
+		return PngDecoder::ReadHeader(data, size, header) && PngDecoder::Decode(data, size, header, output, pngSettings);
+	}
+	case FORMAT_JPEG:
+	{
+		JpegDecoder::Header header;
+		JpegDecoder::Settings jpegSettings;
+		jpegSettings.useSimd = settings.useSimd;
+		jpegSettings.parallel = settings.parallel;
+		return JpegDecoder::ReadHeader(data, size, header) && JpegDecoder::Decode(data, size, header, output, jpegSettings);
+	}
+	default:
+		return false;
+	}
+}
+
+bool ImageDecoder::DecodeFile(const std::string& filename, Image& image, const Settings& settings)
+{
+	MappedFile file;
+
+	image.info = Info();
+	image.fileSize = 0;
+	image.pixels.reset();
+
+	if (!file.Open(filename))
+	{
+		return false;
+	}
+
+	image.fileSize = file.GetSize();
+	if (!ReadInfo(file.GetData(), file.GetSize(), image.info))
+	{
+		return false;
+	}
+
+	std::unique_ptr<uint8_t[]> pixels(new uint8_t[(size_t)image.info.width * image.info.height * 4]);
+	if (!Decode(file.GetData(), file.GetSize(), image.info, pixels.get(), settings))
+	{
+		return false;
+	}
+
+	image.pixels = std::move(pixels);
+	return true;
+}
+
+bool ImageDecoder::DecodeBatch(const std::vector<std::string>& filenames, std::vector<Image>& images, const Settings& settings, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	images.clear();
+	images.resize(filenames.size());
+
+	auto decodeFiles = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			DecodeFile(filenames[i], images[i], settings);
+		}
+	};
+
+	// One file per job, the files of a batch are rarely alike in size.
+	if (settings.parallel && filenames.size() > 1)
+	{
+		JobSystem::GetInstance().ParallelFor(filenames.size(), 1, decodeFiles);
+	}
+	else
+	{
+		decodeFiles(0, filenames.size());
+	}
+
+	size_t failures = 0;
+	for (const Image& image : images)
+	{
+		if (!image.pixels)
+		{
+			failures++;
+		}
+	}
+
+	if (stats)
+	{
+		stats->fileCount = filenames.size();
+		stats->failures = failures;
+		stats->fileBytes = 0;
+		stats->pixelCount = 0;
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			if (!images[i].pixels)
+			{
+				continue;
+			}
+
+			stats->fileBytes += images[i].fileSize;
+			stats->pixelCount += (size_t)images[i].info.width * images[i].info.height;
+		}
+		stats->decodeTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+
+	return failures == 0;
+}
+
+std::string ImageDecoder::FormatStats(const Stats& stats)
+{
+	double seconds = stats.decodeTimeMs / 1000.0;
+	double megapixelsPerSecond = seconds > 0.0 ? (double)stats.pixelCount / 1000000.0 / seconds : 0.0;
+	double megabytesPerSecond = seconds > 0.0 ? (double)stats.fileBytes / (1024.0 * 1024.0) / seconds : 0.0;
+
+	return "Image decode: " + std::to_string(stats.fileCount) + " files (" + std::to_string(stats.failures) + " failed), " +
+		std::to_string(stats.fileBytes) + " bytes, " + std::to_string(stats.pixelCount) + " pixels, " + std::to_string(stats.decodeTimeMs) + " ms (" +
+		std::to_string(megapixelsPerSecond) + " MP/s, " + std::to_string(megabytesPerSecond) + " MB/s)";
+}
@@ -0,0 +1,76 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The one entry point for turning TGA, PNG and JPEG files into top-down RGBA8
+// rows, on any platform and any thread.
+// - The format comes from the file signature. TGA has none, so files that
+//   are neither PNG nor JPEG are read as TGA.
+// - Files are mapped and decoded straight from the view, see TargaDecoder,
+//   PngDecoder and JpegDecoder.
+// - DecodeBatch decodes a set of files at once, a file per job. JPEG files
+//   spread their inverse DCT and color conversion over the job system too.
+class ImageDecoder
+{
+public:
+	enum Format
+	{
+		FORMAT_UNKNOWN = 0,
+		FORMAT_TGA,
+		FORMAT_PNG,
+		FORMAT_JPEG
+	};
+
+	struct Info
+	{
+		Format format = FORMAT_UNKNOWN;
+		int width = 0;
+		int height = 0;
+	};
+
+	struct Settings
+	{
+		bool useSimd = true;
+		bool parallel = true;       // Files of a batch, and the rows of a JPEG
+	};
+
+	struct Image
+	{
+		Info info;
+		size_t fileSize = 0;
+		std::unique_ptr<uint8_t[]> pixels;  // width * height * 4 bytes, nullptr if decoding failed
+	};
+
+	struct Stats
+	{
+		size_t fileCount = 0;
+		size_t failures = 0;
+		size_t fileBytes = 0;
+		size_t pixelCount = 0;
+		double decodeTimeMs = 0.0;
+	};
+
+public:
+	static Format Identify(const uint8_t* data, size_t size);
+	static const char* GetFormatName(Format format);
+
+	// Reads the header, false for truncated or unsupported files.
+	static bool ReadInfo(const uint8_t* data, size_t size, Info& info);
+
+	// output receives info.width * info.height * 4 bytes.
+	static bool Decode(const uint8_t* data, size_t size, const Info& info, uint8_t* output, const Settings& settings);
+
+	static bool DecodeFile(const std::string& filename, Image& image, const Settings& settings);
+
+	// images receives one entry per file, in order. Returns true if every file decoded.
+	static bool DecodeBatch(const std::vector<std::string>& filenames, std::vector<Image>& images, const Settings& settings, Stats* stats = nullptr);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // IMAGE_DECODER_H
@@ -0,0 +1,61 @@
+#ifndef IMAGE_TYPES_H
+#define IMAGE_TYPES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU-side texture data shared by the decoders, the cooker and the cooked
+// texture files. Like MeshTypes these avoid D3D so the image code can be
+// built and benchmarked headless.
+namespace ImageTypes
+{
+	enum PixelFormat : uint32_t
+	{
+		FORMAT_UNKNOWN = 0,
+		FORMAT_RGBA8,               // 4 bytes per texel
+		FORMAT_BC1,                 // RGB, 8 bytes per 4x4 block
+		FORMAT_BC3,                 // RGBA, 16 bytes per block
+		FORMAT_BC4,                 // One channel, 8 bytes per block
+		FORMAT_BC5,                 // Two channels, 16 bytes per block
+		FORMAT_BC7,                 // RGBA, 16 bytes per block
+		FORMAT_BGRA8,               // 4 bytes per texel, loaded from files only
+		FORMAT_BC2,                 // RGBA with explicit alpha, 16 bytes per block, loaded only
+		FORMAT_BC6H,                // HDR RGB, 16 bytes per block, loaded only
+		FORMAT_COUNT
+	};
+
+	// What a texture is used for, which decides how it is cooked.
+	enum TextureRole : uint32_t
+	{
+		ROLE_NONE = 0,              // Not cooked, uploaded as RGBA8
+		ROLE_ALBEDO,                // Base color, alpha kept if present
+		ROLE_NORMAL,                // Tangent space normal, X and Y only, Z is rebuilt in the shader
+		ROLE_MASK,                  // One channel (red): roughness, metallic, AO
+		ROLE_EMISSION,              // Color without alpha
+		ROLE_COUNT
+	};
+
+	// One mip level of one layer within Image::data.
+	struct ImageLevel
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t rowPitch;          // Bytes per row of texels, or of blocks for BC formats
+		size_t offset;
+		size_t size;
+	};
+
+	struct Image
+	{
+		PixelFormat format = FORMAT_UNKNOWN;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t layers = 1;                // Array slices, six per cube for cubemaps
+		bool cubemap = false;
+		std::vector<ImageLevel> levels;     // Layer by layer, each largest first
+		std::vector<uint8_t> data;
+	};
+}
+
+#endif // IMAGE_TYPES_H
@@ -0,0 +1,420 @@
+#include "Inflate.h"
+#include <cstring>
+
+namespace
+{
+	const int FAST_BITS = 10;
+	const int MAX_CODE_LENGTH = 15;
+	const int LITERAL_COUNT = 288;
+	const int DISTANCE_COUNT = 30;
+	const int END_OF_BLOCK = 256;
+
+	const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const uint8_t CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	uint32_t Reverse(uint32_t code, int length)
+	{
+		uint32_t reversed = 0;
+		for (int i = 0; i < length; i++)
+		{
+			reversed = (reversed << 1) | ((code >> i) & 1);
+		}
+		return reversed;
+	}
+
+	// Deflate packs bits from the least significant end of each byte. Past
+	// the end of the data the buffer fills with zeros, Overrun tells if any
+	// of those were consumed.
+	struct BitReader
+	{
+		const uint8_t* data;
+		size_t size;
+		size_t position;
+		uint64_t bits;
+		uint32_t count;
+
+		void Refill()
+		{
+			while (count <= 56)
+			{
+				uint64_t byte = position < size ? data[position] : 0;
+				position++;
+				bits |= byte << count;
+				count += 8;
+			}
+		}
+
+		uint32_t Peek(int n) const { return (uint32_t)(bits & ((1ull << n) - 1)); }
+		void Consume(int n) { bits >>= n; count -= n; }
+
+		// n is at most 32 and must already be in the buffer.
+		uint32_t Take(int n)
+		{
+			uint32_t value = Peek(n);
+			Consume(n);
+			return value;
+		}
+
+		uint32_t Read(int n)
+		{
+			Refill();
+			return Take(n);
+		}
+
+		// Drops the buffer back to the next whole byte of data.
+		void AlignToByte()
+		{
+			Consume(count & 7);
+			position -= count / 8;
+			bits = 0;
+			count = 0;
+		}
+
+		bool Overrun() const { return position - count / 8 > size; }
+	};
+
+	// Canonical code: lengths give the codes, symbols are sorted by code.
+	struct Huffman
+	{
+		uint16_t fast[1 << FAST_BITS];      // (length << 9) | symbol, 0 for longer codes
+		uint32_t maxCode[MAX_CODE_LENGTH + 2];   // One past the last code of each length, left aligned to 16 bits
+		uint16_t firstCode[MAX_CODE_LENGTH + 1];
+		uint16_t firstSymbol[MAX_CODE_LENGTH + 1];
+		uint16_t symbols[LITERAL_COUNT];
+		int symbolCount;
+	};
+
+	bool BuildHuffman(Huffman& huffman, const uint8_t* lengths, int count)
+	{
+		int counts[MAX_CODE_LENGTH + 1] = {};
+		for (int i = 0; i < count; i++)
+		{
+			counts[lengths[i]]++;
+		}
+		counts[0] = 0;
+
+		// Incomplete codes are allowed (a single distance code is common), over-subscribed ones are not.
+		uint32_t nextCode[MAX_CODE_LENGTH + 1] = {};
+		uint32_t code = 0;
+		int symbol = 0;
+		for (int length = 1; length <= MAX_CODE_LENGTH; length++)
+		{
+			nextCode[length] = code;
+			huffman.firstCode[length] = (uint16_t)code;
+			huffman.firstSymbol[length] = (uint16_t)symbol;
+			code += counts[length];
+			if (code > (1u << length))
+			{
+				return false;
+			}
+			huffman.maxCode[length] = code << (16 - length);
+			code <<= 1;
+			symbol += counts[length];
+		}
+		huffman.maxCode[MAX_CODE_LENGTH + 1] = 0x10000;
+		huffman.symbolCount = symbol;
+
+		std::memset(huffman.fast, 0, sizeof(huffman.fast));
+		for (int i = 0; i < count; i++)
+		{
+			int length = lengths[i];
+			if (length == 0)
+			{
+				continue;
+			}
+
+			uint32_t index = nextCode[length] - huffman.firstCode[length] + huffman.firstSymbol[length];
+			huffman.symbols[index] = (uint16_t)i;
+			if (length <= FAST_BITS)
+			{
+				for (uint32_t j = Reverse(nextCode[length], length); j < (1u << FAST_BITS); j += 1u << length)
+				{
+					huffman.fast[j] = (uint16_t)((length << 9) | i);
+				}
+			}
+			nextCode[length]++;
+		}
+
+		return true;
+	}
+
+	// The buffer must hold at least 15 bits. Returns -1 for a code that is not in the table.
+	int DecodeSymbol(BitReader& reader, const Huffman& huffman)
+	{
+		uint32_t entry = huffman.fast[reader.Peek(FAST_BITS)];
+		if (entry)
+		{
+			reader.Consume(entry >> 9);
+			return (int)(entry & 511);
+		}
+
+		// Longer codes, compared most significant bit first.
+		uint32_t code = Reverse(reader.Peek(16), 16);
+		int length = FAST_BITS + 1;
+		while (length <= MAX_CODE_LENGTH && code >= huffman.maxCode[length])
+		{
+			length++;
+		}
+		if (length > MAX_CODE_LENGTH)
+		{
+			return -1;
+		}
+
+		uint32_t index = (code >> (16 - length)) - huffman.firstCode[length] + huffman.firstSymbol[length];
+		if (index >= (uint32_t)huffman.symbolCount)
+		{
+			return -1;
+		}
+		reader.Consume(length);
+		return huffman.symbols[index];
+	}
+
+	struct FixedTables
+	{
+		Huffman literals;
+		Huffman distances;
+
+		FixedTables()
+		{
+			uint8_t lengths[LITERAL_COUNT];
+			std::memset(lengths, 8, 144);
+			std::memset(lengths + 144, 9, 112);
+			std::memset(lengths + 256, 7, 24);
+			std::memset(lengths + 280, 8, 8);
+			BuildHuffman(literals, lengths, LITERAL_COUNT);
+
+			std::memset(lengths, 5, DISTANCE_COUNT);
+			BuildHuffman(distances, lengths, DISTANCE_COUNT);
+		}
+	};
+
+	bool ReadDynamicTables(BitReader& reader, Huffman& literals, Huffman& distances)
+	{
+		reader.Refill();
+		int literalCount = (int)reader.Take(5) + 257;
+		int distanceCount = (int)reader.Take(5) + 1;
+		int codeLengthCount = (int)reader.Take(4) + 4;
+		if (literalCount > 286 || distanceCount > DISTANCE_COUNT)
+		{
+			return false;
+		}
+
+		uint8_t codeLengthLengths[19] = {};
+		for (int i = 0; i < codeLengthCount; i++)
+		{
+			codeLengthLengths[CODE_LENGTH_ORDER[i]] = (uint8_t)reader.Read(3);
+		}
+		Huffman codeLengths;
+		if (!BuildHuffman(codeLengths, codeLengthLengths, 19))
+		{
+			return false;
+		}
+
+		// Literal and distance lengths are one run-length coded sequence.
+		uint8_t lengths[286 + DISTANCE_COUNT];
+		int total = literalCount + distanceCount;
+		int filled = 0;
+		while (filled < total)
+		{
+			reader.Refill();
+			int symbol = DecodeSymbol(reader, codeLengths);
+			if (symbol < 0)
+			{
+				return false;
+			}
+
+			if (symbol < 16)
+			{
+				lengths[filled++] = (uint8_t)symbol;
+				continue;
+			}
+
+			uint8_t value = 0;
+			int repeat;
+			if (symbol == 16)
+			{
+				if (filled == 0)
+				{
+					return false;
+				}
+				value = lengths[filled - 1];
+				repeat = 3 + (int)reader.Take(2);
+			}
+			else if (symbol == 17)
+			{
+				repeat = 3 + (int)reader.Take(3);
+			}
+			else
+			{
+				repeat = 11 + (int)reader.Take(7);
+			}
+
+			if (filled + repeat > total)
+			{
+				return false;
+			}
+			std::memset(lengths + filled, value, repeat);
+			filled += repeat;
+		}
+
+		if (lengths[END_OF_BLOCK] == 0)
+		{
+			return false;
+		}
+
+		return BuildHuffman(literals, lengths, literalCount) && BuildHuffman(distances, lengths + literalCount, distanceCount);
+	}
+
+	bool InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, uint8_t* output, size_t outputSize, size_t& written)
+	{
+		size_t position = written;
+		for (;;)
+		{
+			// A literal/length code, its extra bits, a distance code and its extra bits
+			// take at most 48 bits, so one refill covers the whole symbol.
+			reader.Refill();
+			int symbol = DecodeSymbol(reader, literals);
+			if (symbol < END_OF_BLOCK)
+			{
+				if (symbol < 0 || position >= outputSize)
+				{
+					return false;
+				}
+				output[position++] = (uint8_t)symbol;
+				continue;
+			}
+
+			if (symbol == END_OF_BLOCK)
+			{
+				written = position;
+				return true;
+			}
+
+			symbol -= 257;
+			if (symbol >= 29)
+			{
+				return false;
+			}
+			size_t length = LENGTH_BASE[symbol] + reader.Take(LENGTH_EXTRA[symbol]);
+
+			int distanceSymbol = DecodeSymbol(reader, distances);
+			if (distanceSymbol < 0 || distanceSymbol >= DISTANCE_COUNT)
+			{
+				return false;
+			}
+			size_t distance = DISTANCE_BASE[distanceSymbol] + reader.Take(DISTANCE_EXTRA[distanceSymbol]);
+			if (distance > position || length > outputSize - position)
+			{
+				return false;
+			}
+
+			uint8_t* target = output + position;
+			const uint8_t* source = target - distance;
+			if (distance == 1)
+			{
+				std::memset(target, *source, length);
+			}
+			else if (distance >= 8 && length + 8 <= outputSize - position)
+			{
+				// Eight bytes at a time, the source stays a whole chunk behind. The last
+				// chunk may run past the match, the next symbol overwrites that.
+				for (size_t i = 0; i < length; i += 8)
+				{
+					std::memcpy(target + i, source + i, 8);
+				}
+			}
+			else
+			{
+				for (size_t i = 0; i < length; i++)
+				{
+					target[i] = source[i];
+				}
+			}
+			position += length;
+		}
+	}
+}
+
+bool Inflate::Decompress(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize, size_t& written)
+{
+	static const FixedTables fixedTables;
+
+	BitReader reader = { data, size, 0, 0, 0 };
+	written = 0;
+
+	bool finalBlock = false;
+	while (!finalBlock)
+	{
+		reader.Refill();
+		finalBlock = reader.Take(1) != 0;
+		uint32_t type = reader.Take(2);
+
+		if (type == 0)
+		{
+			// Stored: byte aligned length, its complement, then the bytes as they are.
+			reader.AlignToByte();
+			if (reader.position + 4 > size)
+			{
+				return false;
+			}
+			size_t length = data[reader.position] | (data[reader.position + 1] << 8);
+			size_t complement = data[reader.position + 2] | (data[reader.position + 3] << 8);
+			reader.position += 4;
+			if ((length ^ 0xFFFF) != complement || length > size - reader.position || length > outputSize - written)
+			{
+				return false;
+			}
+			std::memcpy(output + written, data + reader.position, length);
+			reader.position += length;
+			written += length;
+		}
+		else if (type == 1)
+		{
+			if (!InflateBlock(reader, fixedTables.literals, fixedTables.distances, output, outputSize, written))
+			{
+				return false;
+			}
+		}
+		else if (type == 2)
+		{
+			Huffman literals;
+			Huffman distances;
+			if (!ReadDynamicTables(reader, literals, distances) || !InflateBlock(reader, literals, distances, output, outputSize, written))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		if (reader.Overrun())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Inflate::DecompressZlib(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize, size_t& written)
+{
+	if (size < 2)
+	{
+		return false;
+	}
+
+	// Deflate with a window of at most 32 KB, a valid check value and no preset dictionary.
+	uint8_t method = data[0];
+	uint8_t flags = data[1];
+	if ((method & 0x0F) != 8 || (method >> 4) > 7 || ((method << 8) | flags) % 31 != 0 || (flags & 0x20))
+	{
+		return false;
+	}
+
+	return Decompress(data + 2, size - 2, output, outputSize, written);
+}
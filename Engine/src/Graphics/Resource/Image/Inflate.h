@@ -0,0 +1,24 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Decompresses deflate streams (RFC 1951), raw or in a zlib wrapper (RFC
+// 1950), into a buffer whose size the caller already knows, as PNG does.
+// - Huffman codes are read through a 10 bit lookup table, longer codes fall
+//   back to a canonical search. The bit buffer is 64 bits wide and refilled
+//   a byte at a time, so a symbol never waits for more than one refill.
+// - Every length, distance and table is checked, corrupt data fails instead
+//   of writing outside output.
+class Inflate
+{
+public:
+	// written receives the bytes produced, which may be fewer than outputSize.
+	static bool Decompress(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize, size_t& written);
+
+	// The same behind a zlib header, the Adler-32 trailer is not checked.
+	static bool DecompressZlib(const uint8_t* data, size_t size, uint8_t* output, size_t outputSize, size_t& written);
+};
+
+#endif // INFLATE_H
@@ -0,0 +1,1201 @@
+#include "JpegDecoder.h"
+#include "../../../Core/System/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include <emmintrin.h>
+
+namespace
+{
+	const int FAST_BITS = 9;
+	const int MAX_COMPONENTS = 3;
+	const int MAX_DIMENSION = 65535;
+	const size_t ROW_BATCH = 16;
+
+	const uint8_t MARKER_SOF0 = 0xC0;         // Baseline
+	const uint8_t MARKER_SOF1 = 0xC1;         // Extended sequential
+	const uint8_t MARKER_SOF2 = 0xC2;         // Progressive
+	const uint8_t MARKER_DHT = 0xC4;
+	const uint8_t MARKER_RST0 = 0xD0;
+	const uint8_t MARKER_RST7 = 0xD7;
+	const uint8_t MARKER_SOI = 0xD8;
+	const uint8_t MARKER_EOI = 0xD9;
+	const uint8_t MARKER_SOS = 0xDA;
+	const uint8_t MARKER_DQT = 0xDB;
+	const uint8_t MARKER_DNL = 0xDC;
+	const uint8_t MARKER_DRI = 0xDD;
+	const uint8_t MARKER_APP14 = 0xEE;
+
+	// Row major position of the kth coefficient in the stream.
+	const uint8_t ZIGZAG[64] =
+	{
+		0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+	};
+
+	bool IsUnsupportedFrame(uint8_t marker)
+	{
+		// Lossless and arithmetic coded frames.
+		return marker == 0xC3 || (marker >= 0xC5 && marker <= 0xC7) || (marker >= 0xC9 && marker <= 0xCB) || (marker >= 0xCD && marker <= 0xCF);
+	}
+
+	uint16_t ReadUInt16(const uint8_t* data)
+	{
+		return (uint16_t)((data[0] << 8) | data[1]);
+	}
+
+	uint8_t ClampToByte(int value)
+	{
+		return (uint8_t)std::min(std::max(value, 0), 255);
+	}
+
+	// Canonical code: codes of one length are consecutive, lengths ascend.
+	struct HuffmanTable
+	{
+		uint16_t fast[1 << FAST_BITS];      // (length << 8) | value, 0 for longer codes
+		int16_t fastAc[1 << FAST_BITS];     // AC code and its extra bits together: (coefficient << 8) | (run << 4) | length, 0 if they do not fit
+		uint32_t maxCode[17];               // One past the last code of each length, left aligned to 16 bits
+		int32_t valueOffset[17];            // Code of a length to its index in values
+		uint8_t values[256];
+		int valueCount = 0;
+		bool defined = false;
+	};
+
+	bool BuildHuffman(HuffmanTable& table, const uint8_t* counts, const uint8_t* values)
+	{
+		int valueCount = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			valueCount += counts[i];
+		}
+		if (valueCount > 256)
+		{
+			return false;
+		}
+		std::memcpy(table.values, values, valueCount);
+		std::memset(table.fast, 0, sizeof(table.fast));
+
+		uint32_t code = 0;
+		int index = 0;
+		for (int length = 1; length <= 16; length++)
+		{
+			int count = counts[length - 1];
+			table.valueOffset[length] = index - (int)code;
+			if (length <= FAST_BITS)
+			{
+				for (int i = 0; i < count; i++)
+				{
+					uint32_t first = (code + i) << (FAST_BITS - length);
+					for (uint32_t j = 0; j < (1u << (FAST_BITS - length)); j++)
+					{
+						table.fast[first + j] = (uint16_t)((length << 8) | values[index + i]);
+					}
+				}
+			}
+
+			code += count;
+			index += count;
+			if (code > (1u << length))
+			{
+				return false;
+			}
+			table.maxCode[length] = code << (16 - length);
+			code <<= 1;
+		}
+
+		// Most AC coefficients are small, so a code and its extra bits often fit
+		// the fast lookup together and decode in one step.
+		std::memset(table.fastAc, 0, sizeof(table.fastAc));
+		for (uint32_t i = 0; i < (1u << FAST_BITS); i++)
+		{
+			uint32_t entry = table.fast[i];
+			int length = (int)(entry >> 8);
+			int run = (entry >> 4) & 15;
+			int size = entry & 15;
+			if (entry == 0 || size == 0 || length + size > FAST_BITS)
+			{
+				continue;
+			}
+
+			int bits = (int)(((i << length) & ((1u << FAST_BITS) - 1)) >> (FAST_BITS - size));
+			int coefficient = bits < (1 << (size - 1)) ? bits - (1 << size) + 1 : bits;
+			if (coefficient >= -128 && coefficient <= 127)
+			{
+				table.fastAc[i] = (int16_t)(coefficient * 256 + run * 16 + length + size);
+			}
+		}
+
+		table.valueCount = valueCount;
+		table.defined = true;
+		return true;
+	}
+
+	// Entropy coded data, most significant bit first, with 0xFF00 unstuffed.
+	// A marker stops the reader, it then reads zeros until Restart.
+	struct BitReader
+	{
+		const uint8_t* data;
+		size_t size;
+		size_t position;
+		uint64_t bits = 0;
+		int count = 0;
+		bool markerHit = false;
+
+		void Refill()
+		{
+			while (count <= 56)
+			{
+				uint32_t byte = 0;
+				if (!markerHit && position < size)
+				{
+					byte = data[position];
+					if (byte != 0xFF)
+					{
+						position++;
+					}
+					else if (position + 1 < size && data[position + 1] == 0x00)
+					{
+						position += 2;
+					}
+					else
+					{
+						markerHit = true;
+						byte = 0;
+					}
+				}
+				bits |= (uint64_t)byte << (56 - count);
+				count += 8;
+			}
+		}
+
+		int Receive(int n)
+		{
+			if (n == 0)
+			{
+				return 0;
+			}
+			if (count < n)
+			{
+				Refill();
+			}
+			int value = (int)(bits >> (64 - n));
+			bits <<= n;
+			count -= n;
+			return value;
+		}
+
+		// n bits as a signed value of magnitude category n.
+		int ReceiveExtend(int n)
+		{
+			int value = Receive(n);
+			return n > 0 && value < (1 << (n - 1)) ? value - (1 << n) + 1 : value;
+		}
+
+		int Decode(const HuffmanTable& table)
+		{
+			if (count < 16)
+			{
+				Refill();
+			}
+
+			uint32_t code = (uint32_t)(bits >> 48);
+			uint32_t entry = table.fast[code >> (16 - FAST_BITS)];
+			if (entry)
+			{
+				int length = (int)(entry >> 8);
+				bits <<= length;
+				count -= length;
+				return (int)(entry & 0xFF);
+			}
+
+			for (int length = FAST_BITS + 1; length <= 16; length++)
+			{
+				if (code < table.maxCode[length])
+				{
+					int index = (int)(code >> (16 - length)) + table.valueOffset[length];
+					if (index < 0 || index >= table.valueCount)
+					{
+						return -1;
+					}
+					bits <<= length;
+					count -= length;
+					return table.values[index];
+				}
+			}
+			return -1;
+		}
+
+		// Drops the buffered bits and steps past the next RSTn marker.
+		void Restart()
+		{
+			bits = 0;
+			count = 0;
+			markerHit = false;
+			while (position + 1 < size)
+			{
+				if (data[position] == 0xFF)
+				{
+					uint8_t marker = data[position + 1];
+					if (marker >= MARKER_RST0 && marker <= MARKER_RST7)
+					{
+						position += 2;
+						return;
+					}
+					if (marker != 0x00 && marker != 0xFF)
+					{
+						return;
+					}
+				}
+				position++;
+			}
+		}
+	};
+
+	struct Component
+	{
+		int id = 0;
+		int h = 1;
+		int v = 1;
+		int quantIndex = 0;
+		int width = 0;                      // Samples, before padding to whole MCUs
+		int height = 0;
+		int blocksPerLine = 0;
+		int blockRows = 0;
+		uint16_t quant[64] = {};            // Row major, taken from the table at the component's first scan
+		bool quantLatched = false;
+		int dcTable = 0;
+		int acTable = 0;
+		int dcPredictor = 0;
+		std::vector<int16_t> coefficients;  // 64 per block, row major
+		std::vector<uint8_t> samples;       // blocksPerLine * 8 wide
+
+		size_t GetStride() const { return (size_t)blocksPerLine * 8; }
+	};
+
+	struct IdctTables
+	{
+		float matrix[8][8];                 // [x][u] = C(u) / 2 * cos((2x + 1) u pi / 16)
+		float transposed[8][8];             // [u][x]
+
+		IdctTables()
+		{
+			const double pi = 3.14159265358979323846;
+			for (int x = 0; x < 8; x++)
+			{
+				for (int u = 0; u < 8; u++)
+				{
+					double scale = u == 0 ? std::sqrt(0.125) : 0.5;
+					matrix[x][u] = (float)(scale * std::cos((2 * x + 1) * u * pi / 16.0));
+					transposed[u][x] = matrix[x][u];
+				}
+			}
+		}
+	};
+
+	const IdctTables& GetIdctTables()
+	{
+		static const IdctTables tables;
+		return tables;
+	}
+
+	// Dequantizes and transforms one block into 8 rows of output, level shifted and clamped.
+	void IdctBlock(const int16_t* coefficients, const uint16_t* quant, uint8_t* output, size_t stride, bool useSimd)
+	{
+		// Coefficient rows that hold anything, bit 0 is the DC row.
+		uint32_t usedRows = 0;
+		for (int row = 0; row < 8; row++)
+		{
+			for (int u = 0; u < 8; u++)
+			{
+				if (coefficients[row * 8 + u] != 0)
+				{
+					usedRows |= 1u << row;
+					break;
+				}
+			}
+		}
+
+		// Only the DC coefficient: every sample is the same.
+		bool dcOnly = usedRows <= 1;
+		for (int u = 1; dcOnly && u < 8; u++)
+		{
+			dcOnly = coefficients[u] == 0;
+		}
+		if (dcOnly)
+		{
+			uint8_t value = ClampToByte((int)std::lrintf(coefficients[0] * quant[0] * 0.125f) + 128);
+			for (int y = 0; y < 8; y++)
+			{
+				std::memset(output + y * stride, value, 8);
+			}
+			return;
+		}
+
+		const IdctTables& tables = GetIdctTables();
+		alignas(16) float block[64];
+		alignas(16) float columns[64];
+		for (int i = 0; i < 64; i++)
+		{
+			block[i] = (float)(coefficients[i] * quant[i]);
+		}
+
+		if (useSimd)
+		{
+			// Vertical: row y of the result is the coefficient rows weighted by the basis at y.
+			for (int y = 0; y < 8; y++)
+			{
+				__m128 left = _mm_setzero_ps();
+				__m128 right = _mm_setzero_ps();
+				for (int v = 0; v < 8; v++)
+				{
+					if (usedRows & (1u << v))
+					{
+						__m128 weight = _mm_set1_ps(tables.matrix[y][v]);
+						left = _mm_add_ps(left, _mm_mul_ps(weight, _mm_load_ps(block + v * 8)));
+						right = _mm_add_ps(right, _mm_mul_ps(weight, _mm_load_ps(block + v * 8 + 4)));
+					}
+				}
+				_mm_store_ps(columns + y * 8, left);
+				_mm_store_ps(columns + y * 8 + 4, right);
+			}
+
+			// Horizontal: each row's frequencies weight the basis rows.
+			const __m128i levelShift = _mm_set1_epi16(128);
+			for (int y = 0; y < 8; y++)
+			{
+				__m128 left = _mm_setzero_ps();
+				__m128 right = _mm_setzero_ps();
+				for (int u = 0; u < 8; u++)
+				{
+					__m128 weight = _mm_set1_ps(columns[y * 8 + u]);
+					left = _mm_add_ps(left, _mm_mul_ps(weight, _mm_loadu_ps(tables.transposed[u])));
+					right = _mm_add_ps(right, _mm_mul_ps(weight, _mm_loadu_ps(tables.transposed[u] + 4)));
+				}
+				__m128i samples = _mm_add_epi16(_mm_packs_epi32(_mm_cvtps_epi32(left), _mm_cvtps_epi32(right)), levelShift);
+				_mm_storel_epi64((__m128i*)(output + y * stride), _mm_packus_epi16(samples, samples));
+			}
+			return;
+		}
+
+		for (int y = 0; y < 8; y++)
+		{
+			for (int u = 0; u < 8; u++)
+			{
+				float sum = 0.0f;
+				for (int v = 0; v < 8; v++)
+				{
+					sum += tables.matrix[y][v] * block[v * 8 + u];
+				}
+				columns[y * 8 + u] = sum;
+			}
+		}
+		for (int y = 0; y < 8; y++)
+		{
+			for (int x = 0; x < 8; x++)
+			{
+				float sum = 0.0f;
+				for (int u = 0; u < 8; u++)
+				{
+					sum += tables.transposed[u][x] * columns[y * 8 + u];
+				}
+				output[y * stride + x] = ClampToByte((int)std::lrintf(sum) + 128);
+			}
+		}
+	}
+
+	void RunRows(size_t rowCount, bool parallel, const std::function<void(size_t, size_t)>& func)
+	{
+		if (parallel)
+		{
+			JobSystem::GetInstance().ParallelFor(rowCount, ROW_BATCH, func);
+		}
+		else
+		{
+			func(0, rowCount);
+		}
+	}
+
+	// Row y of a component at full image size. columns is scratch of the component's width.
+	void UpsampleRow(const Component& component, int y, int width, int maxH, int maxV, uint16_t* columns, uint8_t* output)
+	{
+		const int ratioX = maxH % component.h == 0 ? maxH / component.h : 0;
+		const int ratioY = maxV % component.v == 0 ? maxV / component.v : 0;
+		const size_t stride = component.GetStride();
+
+		// Vertical, two rows weighted 3:1 or the nearest row alone, scaled by 4.
+		int nearRow;
+		int farRow;
+		int nearWeight = 4;
+		if (ratioY == 2)
+		{
+			nearRow = y / 2;
+			farRow = (y & 1) ? std::min(nearRow + 1, component.height - 1) : std::max(nearRow - 1, 0);
+			nearWeight = 3;
+		}
+		else
+		{
+			nearRow = std::min(ratioY ? y / ratioY : (int)((int64_t)y * component.v / maxV), component.height - 1);
+			farRow = nearRow;
+		}
+		const uint8_t* nearSamples = component.samples.data() + nearRow * stride;
+		const uint8_t* farSamples = component.samples.data() + farRow * stride;
+		for (int i = 0; i < component.width; i++)
+		{
+			columns[i] = (uint16_t)(nearSamples[i] * nearWeight + farSamples[i] * (4 - nearWeight));
+		}
+
+		// Horizontal the same, the result is scaled by 16.
+		const int lastColumn = component.width - 1;
+		if (ratioX == 2)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int nearColumn = x / 2;
+				int farColumn = (x & 1) ? std::min(nearColumn + 1, lastColumn) : std::max(nearColumn - 1, 0);
+				output[x] = (uint8_t)((columns[nearColumn] * 3 + columns[farColumn] + 8) >> 4);
+			}
+		}
+		else
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int column = std::min(ratioX ? x / ratioX : (int)((int64_t)x * component.h / maxH), lastColumn);
+				output[x] = (uint8_t)((columns[column] * 4 + 8) >> 4);
+			}
+		}
+	}
+
+	class Decoder
+	{
+	public:
+		Decoder(const uint8_t* data, size_t size)
+			: m_data(data), m_size(size)
+		{
+		}
+
+		// Markers up to and including the frame header.
+		bool ReadFrame(JpegDecoder::Header& header)
+		{
+			if (!m_data || m_size < 4 || m_data[0] != 0xFF || m_data[1] != MARKER_SOI)
+			{
+				return false;
+			}
+			m_position = 2;
+			if (!ReadMarkers(true))
+			{
+				return false;
+			}
+
+			header.width = m_width;
+			header.height = m_height;
+			header.componentCount = m_componentCount;
+			header.progressive = m_progressive;
+			return true;
+		}
+
+		// Every scan after the frame header, into the coefficient buffers.
+		bool ReadScans()
+		{
+			for (int i = 0; i < m_componentCount; i++)
+			{
+				Component& component = m_components[i];
+				component.coefficients.assign((size_t)component.blocksPerLine * component.blockRows * 64, 0);
+			}
+			return ReadMarkers(false);
+		}
+
+		void Finish(uint8_t* output, const JpegDecoder::Settings& settings)
+		{
+			for (int i = 0; i < m_componentCount; i++)
+			{
+				Component& component = m_components[i];
+				const size_t stride = component.GetStride();
+				component.samples.resize(stride * component.blockRows * 8);
+				RunRows(component.blockRows, settings.parallel, [&](size_t begin, size_t end)
+				{
+					for (size_t row = begin; row < end; row++)
+					{
+						for (int column = 0; column < component.blocksPerLine; column++)
+						{
+							const int16_t* block = component.coefficients.data() + (row * component.blocksPerLine + column) * 64;
+							IdctBlock(block, component.quant, component.samples.data() + row * 8 * stride + column * 8, stride, settings.useSimd);
+						}
+					}
+				});
+				std::vector<int16_t>().swap(component.coefficients);
+			}
+
+			// Three components are YCbCr unless an Adobe marker or the component ids say RGB.
+			const bool isRgb = m_componentCount == 3 &&
+				((m_hasAdobe && m_adobeTransform == 0) || (m_components[0].id == 'R' && m_components[1].id == 'G' && m_components[2].id == 'B'));
+
+			RunRows(m_height, settings.parallel, [&](size_t begin, size_t end)
+			{
+				std::vector<uint16_t> columns(m_width);
+				std::vector<uint8_t> upsampled[MAX_COMPONENTS];
+				for (size_t y = begin; y < end; y++)
+				{
+					const uint8_t* rows[MAX_COMPONENTS];
+					for (int i = 0; i < m_componentCount; i++)
+					{
+						const Component& component = m_components[i];
+						if (component.h == m_maxH && component.v == m_maxV)
+						{
+							rows[i] = component.samples.data() + y * component.GetStride();
+							continue;
+						}
+						upsampled[i].resize(m_width);
+						UpsampleRow(component, (int)y, m_width, m_maxH, m_maxV, columns.data(), upsampled[i].data());
+						rows[i] = upsampled[i].data();
+					}
+
+					uint8_t* pixel = output + y * m_width * 4;
+					if (m_componentCount == 1)
+					{
+						for (int x = 0; x < m_width; x++, pixel += 4)
+						{
+							pixel[0] = pixel[1] = pixel[2] = rows[0][x];
+							pixel[3] = 255;
+						}
+					}
+					else if (isRgb)
+					{
+						for (int x = 0; x < m_width; x++, pixel += 4)
+						{
+							pixel[0] = rows[0][x];
+							pixel[1] = rows[1][x];
+							pixel[2] = rows[2][x];
+							pixel[3] = 255;
+						}
+					}
+					else
+					{
+						// JFIF YCbCr, the coefficients in 16.16 fixed point.
+						for (int x = 0; x < m_width; x++, pixel += 4)
+						{
+							int luma = rows[0][x];
+							int cb = rows[1][x] - 128;
+							int cr = rows[2][x] - 128;
+							pixel[0] = ClampToByte(luma + ((91881 * cr + 32768) >> 16));
+							pixel[1] = ClampToByte(luma + ((-22554 * cb - 46802 * cr + 32768) >> 16));
+							pixel[2] = ClampToByte(luma + ((116130 * cb + 32768) >> 16));
+							pixel[3] = 255;
+						}
+					}
+				}
+			});
+		}
+
+	private:
+		bool ReadMarkers(bool stopAfterFrame)
+		{
+			for (;;)
+			{
+				uint8_t marker;
+				if (!NextMarker(marker))
+				{
+					// A file cut short still shows the scans it has, as other decoders do.
+					return !stopAfterFrame && m_scanCount > 0;
+				}
+
+				if (marker == MARKER_EOI)
+				{
+					return m_frameRead && (stopAfterFrame || m_scanCount > 0);
+				}
+				if (marker == MARKER_SOI || (marker >= MARKER_RST0 && marker <= MARKER_RST7))
+				{
+					continue;
+				}
+				if (IsUnsupportedFrame(marker) || marker == MARKER_DNL)
+				{
+					return false;
+				}
+
+				// Every other marker has a segment.
+				if (m_position + 2 > m_size)
+				{
+					return false;
+				}
+				size_t length = ReadUInt16(m_data + m_position);
+				if (length < 2 || m_position + length > m_size)
+				{
+					return false;
+				}
+				const uint8_t* segment = m_data + m_position + 2;
+				length -= 2;
+				m_position += 2 + length;
+
+				bool result = true;
+				switch (marker)
+				{
+				case MARKER_SOF0:
+				case MARKER_SOF1:
+				case MARKER_SOF2:
+					if (m_frameRead)
+					{
+						return false;
+					}
+					m_progressive = marker == MARKER_SOF2;
+					result = ReadFrameHeader(segment, length);
+					if (result && stopAfterFrame)
+					{
+						return true;
+					}
+					break;
+				case MARKER_DHT:
+					result = ReadHuffmanTables(segment, length);
+					break;
+				case MARKER_DQT:
+					result = ReadQuantTables(segment, length);
+					break;
+				case MARKER_DRI:
+					result = length >= 2;
+					m_restartInterval = result ? ReadUInt16(segment) : 0;
+					break;
+				case MARKER_APP14:
+					if (length >= 12 && std::memcmp(segment, "Adobe", 5) == 0)
+					{
+						m_hasAdobe = true;
+						m_adobeTransform = segment[11];
+					}
+					break;
+				case MARKER_SOS:
+					result = m_frameRead && !stopAfterFrame && ReadScan(segment, length);
+					break;
+				default:
+					break;
+				}
+
+				if (!result)
+				{
+					return false;
+				}
+			}
+		}
+
+		bool NextMarker(uint8_t& marker)
+		{
+			for (;;)
+			{
+				while (m_position < m_size && m_data[m_position] != 0xFF)
+				{
+					m_position++;
+				}
+				while (m_position < m_size && m_data[m_position] == 0xFF)
+				{
+					m_position++;
+				}
+				if (m_position >= m_size)
+				{
+					return false;
+				}
+				marker = m_data[m_position++];
+				if (marker != 0x00)
+				{
+					return true;
+				}
+			}
+		}
+
+		bool ReadFrameHeader(const uint8_t* segment, size_t length)
+		{
+			if (length < 6)
+			{
+				return false;
+			}
+			int precision = segment[0];
+			m_height = ReadUInt16(segment + 1);
+			m_width = ReadUInt16(segment + 3);
+			m_componentCount = segment[5];
+			if (precision != 8 || m_width == 0 || m_height == 0 || m_width > MAX_DIMENSION || m_height > MAX_DIMENSION ||
+				(m_componentCount != 1 && m_componentCount != 3) || length < 6 + (size_t)m_componentCount * 3)
+			{
+				return false;
+			}
+
+			m_maxH = 1;
+			m_maxV = 1;
+			for (int i = 0; i < m_componentCount; i++)
+			{
+				Component& component = m_components[i];
+				const uint8_t* entry = segment + 6 + i * 3;
+				component.id = entry[0];
+				component.h = entry[1] >> 4;
+				component.v = entry[1] & 15;
+				component.quantIndex = entry[2];
+				if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quantIndex > 3)
+				{
+					return false;
+				}
+				for (int j = 0; j < i; j++)
+				{
+					if (m_components[j].id == component.id)
+					{
+						return false;
+					}
+				}
+
+				// A single component is never interleaved, its MCU is one block whatever the factors.
+				if (m_componentCount == 1)
+				{
+					component.h = 1;
+					component.v = 1;
+				}
+				m_maxH = std::max(m_maxH, component.h);
+				m_maxV = std::max(m_maxV, component.v);
+			}
+
+			m_mcusPerLine = (m_width + 8 * m_maxH - 1) / (8 * m_maxH);
+			m_mcuRows = (m_height + 8 * m_maxV - 1) / (8 * m_maxV);
+			for (int i = 0; i < m_componentCount; i++)
+			{
+				Component& component = m_components[i];
+				component.width = (m_width * component.h + m_maxH - 1) / m_maxH;
+				component.height = (m_height * component.v + m_maxV - 1) / m_maxV;
+				component.blocksPerLine = m_mcusPerLine * component.h;
+				component.blockRows = m_mcuRows * component.v;
+			}
+
+			m_frameRead = true;
+			return true;
+		}
+
+		bool ReadHuffmanTables(const uint8_t* segment, size_t length)
+		{
+			size_t offset = 0;
+			while (offset < length)
+			{
+				if (length - offset < 17)
+				{
+					return false;
+				}
+				int tableClass = segment[offset] >> 4;
+				int index = segment[offset] & 15;
+				const uint8_t* counts = segment + offset + 1;
+				size_t valueCount = 0;
+				for (int i = 0; i < 16; i++)
+				{
+					valueCount += counts[i];
+				}
+				if (tableClass > 1 || index > 3 || length - offset - 17 < valueCount)
+				{
+					return false;
+				}
+
+				HuffmanTable& table = tableClass == 0 ? m_dcTables[index] : m_acTables[index];
+				if (!BuildHuffman(table, counts, segment + offset + 17))
+				{
+					return false;
+				}
+				offset += 17 + valueCount;
+			}
+			return true;
+		}
+
+		bool ReadQuantTables(const uint8_t* segment, size_t length)
+		{
+			size_t offset = 0;
+			while (offset < length)
+			{
+				int precision = segment[offset] >> 4;
+				int index = segment[offset] & 15;
+				size_t tableSize = precision ? 128 : 64;
+				if (precision > 1 || index > 3 || length - offset - 1 < tableSize)
+				{
+					return false;
+				}
+
+				const uint8_t* values = segment + offset + 1;
+				for (int k = 0; k < 64; k++)
+				{
+					m_quantTables[index][ZIGZAG[k]] = precision ? ReadUInt16(values + k * 2) : values[k];
+				}
+				offset += 1 + tableSize;
+			}
+			return true;
+		}
+
+		bool ReadScan(const uint8_t* segment, size_t length)
+		{
+			if (length < 1)
+			{
+				return false;
+			}
+			int count = segment[0];
+			if (count < 1 || count > m_componentCount || length < 4 + (size_t)count * 2)
+			{
+				return false;
+			}
+
+			Component* components[MAX_COMPONENTS];
+			for (int i = 0; i < count; i++)
+			{
+				int id = segment[1 + i * 2];
+				int tables = segment[2 + i * 2];
+				components[i] = nullptr;
+				for (int j = 0; j < m_componentCount; j++)
+				{
+					if (m_components[j].id == id)
+					{
+						components[i] = &m_components[j];
+					}
+				}
+				if (!components[i] || (tables >> 4) > 3 || (tables & 15) > 3)
+				{
+					return false;
+				}
+				components[i]->dcTable = tables >> 4;
+				components[i]->acTable = tables & 15;
+			}
+
+			const uint8_t* selection = segment + 1 + count * 2;
+			m_spectralStart = selection[0];
+			m_spectralEnd = selection[1];
+			m_successiveHigh = selection[2] >> 4;
+			m_successiveLow = selection[2] & 15;
+			if (m_progressive)
+			{
+				// DC and AC never share a scan, and AC scans hold one component.
+				if (m_spectralEnd > 63 || m_spectralStart > m_spectralEnd || (m_spectralStart == 0 && m_spectralEnd != 0) ||
+					(m_spectralStart > 0 && count != 1) || m_successiveLow > 13)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				m_spectralStart = 0;
+				m_spectralEnd = 63;
+				m_successiveHigh = 0;
+				m_successiveLow = 0;
+			}
+
+			for (int i = 0; i < count; i++)
+			{
+				Component& component = *components[i];
+				bool needsDc = m_spectralStart == 0 && m_successiveHigh == 0;
+				bool needsAc = m_spectralEnd > 0;
+				if ((needsDc && !m_dcTables[component.dcTable].defined) || (needsAc && !m_acTables[component.acTable].defined))
+				{
+					return false;
+				}
+				if (!component.quantLatched)
+				{
+					std::memcpy(component.quant, m_quantTables[component.quantIndex], sizeof(component.quant));
+					component.quantLatched = true;
+				}
+				component.dcPredictor = 0;
+			}
+
+			bool result = DecodeScan(components, count);
+			m_scanCount++;
+			return result;
+		}
+
+		bool DecodeScan(Component* const* components, int count)
+		{
+			BitReader reader = { m_data, m_size, m_position };
+			m_eobRun = 0;
+
+			int restartsLeft = m_restartInterval;
+			auto restart = [&]()
+			{
+				if (m_restartInterval == 0)
+				{
+					return;
+				}
+				if (restartsLeft == 0)
+				{
+					reader.Restart();
+					for (int i = 0; i < count; i++)
+					{
+						components[i]->dcPredictor = 0;
+					}
+					m_eobRun = 0;
+					restartsLeft = m_restartInterval;
+				}
+				restartsLeft--;
+			};
+
+			if (count == 1)
+			{
+				// One component alone: its MCU is one block, and only the blocks
+				// covering its samples are coded, not the MCU padding.
+				Component& component = *components[0];
+				int blocksX = (component.width + 7) / 8;
+				int blocksY = (component.height + 7) / 8;
+				for (int blockY = 0; blockY < blocksY; blockY++)
+				{
+					for (int blockX = 0; blockX < blocksX; blockX++)
+					{
+						restart();
+						int16_t* block = component.coefficients.data() + ((size_t)blockY * component.blocksPerLine + blockX) * 64;
+						if (!DecodeBlock(reader, component, block))
+						{
+							return false;
+						}
+					}
+				}
+			}
+			else
+			{
+				for (int mcuY = 0; mcuY < m_mcuRows; mcuY++)
+				{
+					for (int mcuX = 0; mcuX < m_mcusPerLine; mcuX++)
+					{
+						restart();
+						for (int i = 0; i < count; i++)
+						{
+							Component& component = *components[i];
+							for (int y = 0; y < component.v; y++)
+							{
+								for (int x = 0; x < component.h; x++)
+								{
+									size_t blockIndex = (size_t)(mcuY * component.v + y) * component.blocksPerLine + mcuX * component.h + x;
+									if (!DecodeBlock(reader, component, component.coefficients.data() + blockIndex * 64))
+									{
+										return false;
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+
+			// Markers resume where the entropy coded data stopped.
+			m_position = reader.position;
+			return true;
+		}
+
+		bool DecodeBlock(BitReader& reader, Component& component, int16_t* block)
+		{
+			if (!m_progressive)
+			{
+				return DecodeDc(reader, component, block) && DecodeAcFirst(reader, component, block);
+			}
+			if (m_spectralStart == 0)
+			{
+				if (m_successiveHigh == 0)
+				{
+					return DecodeDc(reader, component, block);
+				}
+				if (reader.Receive(1))
+				{
+					block[0] = (int16_t)(block[0] | (1 << m_successiveLow));
+				}
+				return true;
+			}
+			return m_successiveHigh == 0 ? DecodeAcFirst(reader, component, block) : DecodeAcRefine(reader, component, block);
+		}
+
+		bool DecodeDc(BitReader& reader, Component& component, int16_t* block)
+		{
+			int category = reader.Decode(m_dcTables[component.dcTable]);
+			if (category < 0 || category > 15)
+			{
+				return false;
+			}
+			component.dcPredictor += reader.ReceiveExtend(category);
+			block[0] = (int16_t)(component.dcPredictor * (1 << m_successiveLow));
+			return true;
+		}
+
+		// Sequential AC, or the first pass over a band of a progressive scan.
+		bool DecodeAcFirst(BitReader& reader, Component& component, int16_t* block)
+		{
+			if (m_eobRun > 0)
+			{
+				m_eobRun--;
+				return true;
+			}
+
+			const HuffmanTable& table = m_acTables[component.acTable];
+			int start = m_progressive ? m_spectralStart : 1;
+			for (int k = start; k <= m_spectralEnd;)
+			{
+				if (reader.count < 16)
+				{
+					reader.Refill();
+				}
+				int fast = table.fastAc[reader.bits >> (64 - FAST_BITS)];
+				if (fast)
+				{
+					k += (fast >> 4) & 15;
+					reader.bits <<= fast & 15;
+					reader.count -= fast & 15;
+					if (k > m_spectralEnd)
+					{
+						return false;
+					}
+					block[ZIGZAG[k++]] = (int16_t)((fast >> 8) * (1 << m_successiveLow));
+					continue;
+				}
+
+				int symbol = reader.Decode(table);
+				if (symbol < 0)
+				{
+					return false;
+				}
+				int run = symbol >> 4;
+				int size = symbol & 15;
+				if (size == 0)
+				{
+					if (run < 15)
+					{
+						// End of band, here and (progressive only) in the next blocks of the run.
+						m_eobRun = (1 << run) - 1 + reader.Receive(run);
+						if (!m_progressive)
+						{
+							m_eobRun = 0;
+						}
+						break;
+					}
+					k += 16;
+					continue;
+				}
+
+				k += run;
+				if (k > m_spectralEnd)
+				{
+					return false;
+				}
+				block[ZIGZAG[k]] = (int16_t)(reader.ReceiveExtend(size) * (1 << m_successiveLow));
+				k++;
+			}
+			return true;
+		}
+
+		// One more bit of every coefficient in the band: new coefficients are
+		// +-1 at this bit, known ones get a correction bit, as in G.1.2.3.
+		bool DecodeAcRefine(BitReader& reader, Component& component, int16_t* block)
+		{
+			const int bit = 1 << m_successiveLow;
+			auto refine = [&](int16_t& coefficient)
+			{
+				if (reader.Receive(1) && (coefficient & bit) == 0)
+				{
+					coefficient = (int16_t)(coefficient + (coefficient >= 0 ? bit : -bit));
+				}
+			};
+
+			int k = m_spectralStart;
+			if (m_eobRun <= 0)
+			{
+				const HuffmanTable& table = m_acTables[component.acTable];
+				for (; k <= m_spectralEnd; k++)
+				{
+					int symbol = reader.Decode(table);
+					if (symbol < 0)
+					{
+						return false;
+					}
+					int run = symbol >> 4;
+					int size = symbol & 15;
+					int value = 0;
+					if (size != 0)
+					{
+						value = reader.Receive(1) ? bit : -bit;
+					}
+					else if (run != 15)
+					{
+						m_eobRun = (1 << run) + reader.Receive(run);
+						break;
+					}
+
+					// Skip run zero coefficients, refining the nonzero ones passed on the way.
+					while (k <= m_spectralEnd)
+					{
+						int16_t& coefficient = block[ZIGZAG[k]];
+						if (coefficient != 0)
+						{
+							refine(coefficient);
+						}
+						else if (run-- == 0)
+						{
+							break;
+						}
+						k++;
+					}
+
+					if (value != 0 && k <= m_spectralEnd)
+					{
+						block[ZIGZAG[k]] = (int16_t)value;
+					}
+				}
+			}
+
+			if (m_eobRun > 0)
+			{
+				for (; k <= m_spectralEnd; k++)
+				{
+					int16_t& coefficient = block[ZIGZAG[k]];
+					if (coefficient != 0)
+					{
+						refine(coefficient);
+					}
+				}
+				m_eobRun--;
+			}
+			return true;
+		}
+
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+		size_t m_position = 0;
+
+		bool m_frameRead = false;
+		bool m_progressive = false;
+		int m_width = 0;
+		int m_height = 0;
+		int m_componentCount = 0;
+		int m_maxH = 1;
+		int m_maxV = 1;
+		int m_mcusPerLine = 0;
+		int m_mcuRows = 0;
+		Component m_components[MAX_COMPONENTS];
+
+		uint16_t m_quantTables[4][64] = {};
+		HuffmanTable m_dcTables[4];
+		HuffmanTable m_acTables[4];
+		int m_restartInterval = 0;
+		bool m_hasAdobe = false;
+		int m_adobeTransform = 1;
+
+		int m_scanCount = 0;
+		int m_spectralStart = 0;
+		int m_spectralEnd = 63;
+		int m_successiveHigh = 0;
+		int m_successiveLow = 0;
+		int m_eobRun = 0;
+	};
+}
+
+bool JpegDecoder::ReadHeader(const uint8_t* data, size_t size, Header& header)
+{
+	Decoder decoder(data, size);
+	return decoder.ReadFrame(header);
+}
+
+bool JpegDecoder::Decode(const uint8_t* data, size_t size, const Header& header, uint8_t* output, const Settings& settings)
+{
+	if (!output)
+	{
+		return false;
+	}
+
+	Decoder decoder(data, size);
+	Header frame;
+	if (!decoder.ReadFrame(frame) || frame.width != header.width || frame.height != header.height || !decoder.ReadScans())
+	{
+		return false;
+	}
+
+	decoder.Finish(output, settings);
+	return true;
+}
@@ -0,0 +1,44 @@
+#ifndef JPEG_DECODER_H
+#define JPEG_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Decodes JPEG images straight from file memory into top-down RGBA8 rows.
+// - Baseline, extended sequential and progressive Huffman coded images, 8
+//   bit samples, gray or YCbCr (RGB when an Adobe marker says so), any
+//   sampling factors and restart intervals. Lossless, arithmetic coded and
+//   CMYK images are refused.
+// - Entropy decoding is serial by nature and fills a coefficient buffer for
+//   every component. The inverse DCT then runs per block row and color
+//   conversion per image row, both spread over the job system.
+// - The inverse DCT is separable, eight dot products per row pass with SSE,
+//   and blocks with only a DC coefficient become flat without one.
+// - 2x subsampled chroma is upsampled with the 3:1 triangle filter libjpeg
+//   uses, other factors repeat samples.
+class JpegDecoder
+{
+public:
+	struct Header
+	{
+		int width = 0;
+		int height = 0;
+		int componentCount = 0;
+		bool progressive = false;
+	};
+
+	struct Settings
+	{
+		bool useSimd = true;
+		bool parallel = true;
+	};
+
+public:
+	// Reads the markers up to the frame header, false for truncated or unsupported files.
+	static bool ReadHeader(const uint8_t* data, size_t size, Header& header);
+
+	// output receives width * height * 4 bytes.
+	static bool Decode(const uint8_t* data, size_t size, const Header& header, uint8_t* output, const Settings& settings);
+};
+
+#endif // JPEG_DECODER_H
@@ -0,0 +1,152 @@
+#include "KtxFile.h"
+#include "../../../Core/System/Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct KtxHeader
+	{
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	struct KtxLevel
+	{
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	static_assert(sizeof(KtxHeader) == 80, "KTX2 header layout");
+	static_assert(sizeof(KtxLevel) == 24, "KTX2 level index layout");
+}
+
+KtxFile::KtxFile()
+{
+}
+
+KtxFile::~KtxFile()
+{
+	Close();
+}
+
+bool KtxFile::Open(const std::string& filename)
+{
+	if (!Map(filename))
+	{
+		return false;
+	}
+
+	const uint8_t* data = m_file.GetData();
+	size_t size = m_file.GetSize();
+
+	// Validate the header and the level index before trusting any size.
+	KtxHeader header;
+	if (size < sizeof(KtxHeader))
+	{
+		LOG_WARNING("KtxFile::Open - File too small: " + filename);
+		Close();
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+
+	if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+	{
+		LOG_WARNING("KtxFile::Open - Not a KTX2 file: " + filename);
+		Close();
+		return false;
+	}
+
+	if (header.supercompressionScheme != 0)
+	{
+		LOG_WARNING("KtxFile::Open - Supercompression " + std::to_string(header.supercompressionScheme) + " is not supported: " + filename);
+		Close();
+		return false;
+	}
+
+	// A level count of 0 asks for the mips to be generated; only the base level is stored.
+	uint32_t levelCount = std::max(header.levelCount, 1u);
+	uint32_t dxgiFormat = GetDxgiFormatFromVulkan(header.vkFormat);
+	uint32_t layerCount = std::max(header.layerCount, 1u) * header.faceCount;
+	bool supported = header.pixelHeight != 0 && header.pixelDepth == 0 && (header.faceCount == 1 || header.faceCount == 6);
+	if (!supported || sizeof(KtxHeader) + (size_t)levelCount * sizeof(KtxLevel) > size ||
+		!SetLayout(dxgiFormat, header.pixelWidth, header.pixelHeight, levelCount, layerCount, header.faceCount == 6))
+	{
+		LOG_WARNING("KtxFile::Open - Unsupported KTX2 layout or format " + std::to_string(header.vkFormat) + ": " + filename);
+		Close();
+		return false;
+	}
+
+	std::vector<KtxLevel> index(levelCount);
+	std::memcpy(index.data(), data + sizeof(KtxHeader), levelCount * sizeof(KtxLevel));
+
+	// Each level holds its images layer by layer, the faces of a layer together,
+	// which is the subresource layer order.
+	for (uint32_t layer = 0; layer < m_layerCount; layer++)
+	{
+		for (uint32_t mip = 0; mip < m_mipCount; mip++)
+		{
+			AddLevel(mip, 0);
+			ImageLevel& level = m_levels.back();
+			if (index[mip].byteLength != (uint64_t)level.size * m_layerCount || index[mip].byteOffset > size)
+			{
+				LOG_WARNING("KtxFile::Open - Level " + std::to_string(mip) + " does not match its format: " + filename);
+				Close();
+				return false;
+			}
+			level.offset = (size_t)index[mip].byteOffset + (size_t)layer * level.size;
+		}
+	}
+
+	if (!FinishLayout())
+	{
+		LOG_WARNING("KtxFile::Open - Truncated mip levels: " + filename);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t KtxFile::GetDxgiFormatFromVulkan(uint32_t vkFormat)
+{
+	switch (vkFormat)
+	{
+	case 37: return 28;     // VK_FORMAT_R8G8B8A8_UNORM
+	case 43: return 29;     // VK_FORMAT_R8G8B8A8_SRGB
+	case 44: return 87;     // VK_FORMAT_B8G8R8A8_UNORM
+	case 50: return 91;     // VK_FORMAT_B8G8R8A8_SRGB
+	case 131:               // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+	case 133: return 71;    // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+	case 132:               // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+	case 134: return 72;    // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+	case 135: return 74;    // VK_FORMAT_BC2_UNORM_BLOCK
+	case 136: return 75;    // VK_FORMAT_BC2_SRGB_BLOCK
+	case 137: return 77;    // VK_FORMAT_BC3_UNORM_BLOCK
+	case 138: return 78;    // VK_FORMAT_BC3_SRGB_BLOCK
+	case 139: return 80;    // VK_FORMAT_BC4_UNORM_BLOCK
+	case 141: return 83;    // VK_FORMAT_BC5_UNORM_BLOCK
+	case 143: return 95;    // VK_FORMAT_BC6H_UFLOAT_BLOCK
+	case 144: return 96;    // VK_FORMAT_BC6H_SFLOAT_BLOCK
+	case 145: return 98;    // VK_FORMAT_BC7_UNORM_BLOCK
+	case 146: return 99;    // VK_FORMAT_BC7_SRGB_BLOCK
+	default: return 0;
+	}
+}
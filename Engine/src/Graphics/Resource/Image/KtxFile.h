@@ -0,0 +1,29 @@
+#ifndef KTX_FILE_H
+#define KTX_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "TextureFile.h"
+
+// KTX2 files, read only; they come from the Khronos tools (toktx, ktx
+// create). The Vulkan format is mapped to its DXGI equivalent and each
+// level's images, stored layer by layer and face by face, become
+// subresources in place.
+// Supercompressed files (BasisLZ, Zstandard, zlib) and the universal
+// formats would have to be decoded first, so they are refused: ship them
+// with supercompression off. Volume and 1D textures are refused as well.
+class KtxFile : public TextureFile
+{
+public:
+	KtxFile();
+	~KtxFile() override;
+
+	bool Open(const std::string& filename) override;
+
+	// DXGI_FORMAT for a VkFormat, 0 if there is none we load.
+	static uint32_t GetDxgiFormatFromVulkan(uint32_t vkFormat);
+};
+
+#endif // KTX_FILE_H
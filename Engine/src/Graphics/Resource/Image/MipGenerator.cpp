@@ -0,0 +1,460 @@
+#include "MipGenerator.h"
+#include "../../../Core/System/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <emmintrin.h>
+
+namespace
+{
+	const float PI = 3.14159265358979f;
+	const float FILTER_RADIUS = 3.0f;       // Kaiser and Lanczos, in destination texels
+	const float KAISER_ALPHA = 4.0f;
+	const size_t ROW_BATCH = 4;
+
+	// Weights of one filter pass: for every destination texel the same number
+	// of taps, with source indices already clamped to the edge.
+	struct FilterTaps
+	{
+		size_t tapCount = 0;
+		std::vector<uint32_t> indices;
+		std::vector<float> weights;
+	};
+
+	float Sinc(float x)
+	{
+		if (std::fabs(x) < 1.0e-5f)
+		{
+			return 1.0f;
+		}
+		return std::sin(PI * x) / (PI * x);
+	}
+
+	// Modified Bessel function of the first kind, order 0.
+	float BesselI0(float x)
+	{
+		float sum = 1.0f;
+		float term = 1.0f;
+		for (int k = 1; k < 20; k++)
+		{
+			term *= (x * 0.5f / k) * (x * 0.5f / k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	float EvaluateFilter(MipGenerator::Filter filter, float t)
+	{
+		float distance = std::fabs(t);
+		switch (filter)
+		{
+		case MipGenerator::FILTER_BOX:
+			// A texel straddling the footprint edge is shared with the neighbor.
+			if (std::fabs(distance - 0.5f) < 1.0e-4f)
+			{
+				return 0.5f;
+			}
+			return distance < 0.5f ? 1.0f : 0.0f;
+		case MipGenerator::FILTER_KAISER:
+		{
+			if (distance >= FILTER_RADIUS)
+			{
+				return 0.0f;
+			}
+			float ratio = distance / FILTER_RADIUS;
+			return Sinc(t) * BesselI0(KAISER_ALPHA * std::sqrt(1.0f - ratio * ratio)) / BesselI0(KAISER_ALPHA);
+		}
+		case MipGenerator::FILTER_LANCZOS:
+			return distance < FILTER_RADIUS ? Sinc(t) * Sinc(t / FILTER_RADIUS) : 0.0f;
+		default:
+			return 0.0f;
+		}
+	}
+
+	// Destination texel x covers [x, x + 1) * scale of the source. The kernel
+	// is evaluated in destination texels so it low passes for any ratio.
+	void BuildTaps(MipGenerator::Filter filter, uint32_t sourceSize, uint32_t targetSize, FilterTaps& taps)
+	{
+		float scale = (float)sourceSize / (float)targetSize;
+		float radius = (filter == MipGenerator::FILTER_BOX ? 0.5f : FILTER_RADIUS) * scale;
+		taps.tapCount = (size_t)std::ceil(radius * 2.0f) + 1;
+		taps.indices.assign(targetSize * taps.tapCount, 0);
+		taps.weights.assign(targetSize * taps.tapCount, 0.0f);
+
+		for (uint32_t x = 0; x < targetSize; x++)
+		{
+			float center = (x + 0.5f) * scale;
+			int first = (int)std::floor(center - radius);
+			uint32_t* indices = &taps.indices[x * taps.tapCount];
+			float* weights = &taps.weights[x * taps.tapCount];
+
+			float sum = 0.0f;
+			for (size_t k = 0; k < taps.tapCount; k++)
+			{
+				int source = first + (int)k;
+				indices[k] = (uint32_t)std::min(std::max(source, 0), (int)sourceSize - 1);
+				weights[k] = EvaluateFilter(filter, (source + 0.5f - center) / scale);
+				sum += weights[k];
+			}
+			for (size_t k = 0; k < taps.tapCount; k++)
+			{
+				weights[k] /= sum;
+			}
+		}
+	}
+
+	float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	// Conversion tables, built once. Encoding looks up a 16 bit quantized
+	// linear value, which is finer than any 8 bit sRGB step.
+	struct SrgbTables
+	{
+		float decode[256];
+		uint8_t encode[65536];
+
+		SrgbTables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				decode[i] = SrgbToLinear(i / 255.0f);
+			}
+			for (int i = 0; i < 65536; i++)
+			{
+				encode[i] = (uint8_t)std::lround(LinearToSrgb(i / 65535.0f) * 255.0f);
+			}
+		}
+	};
+
+	const SrgbTables& GetSrgbTables()
+	{
+		static SrgbTables tables;
+		return tables;
+	}
+
+	void RunRows(size_t rowCount, bool parallel, const std::function<void(size_t, size_t)>& func)
+	{
+		if (parallel)
+		{
+			JobSystem::GetInstance().ParallelFor(rowCount, ROW_BATCH, func);
+		}
+		else
+		{
+			func(0, rowCount);
+		}
+	}
+
+	// Horizontal pass, source width to target width, every source row. One
+	// output texel is the weighted sum of source texels; with SSE a texel is
+	// one vector.
+	void FilterHorizontal(const std::vector<float>& source, uint32_t sourceWidth, uint32_t height, uint32_t targetWidth, const FilterTaps& taps,
+		const MipGenerator::Settings& settings, std::vector<float>& output)
+	{
+		output.resize((size_t)targetWidth * height * 4);
+		RunRows(height, settings.parallel, [&](size_t begin, size_t end)
+		{
+			for (size_t y = begin; y < end; y++)
+			{
+				const float* row = &source[y * sourceWidth * 4];
+				float* target = &output[y * targetWidth * 4];
+				for (uint32_t x = 0; x < targetWidth; x++)
+				{
+					const uint32_t* indices = &taps.indices[x * taps.tapCount];
+					const float* weights = &taps.weights[x * taps.tapCount];
+					if (settings.useSimd)
+					{
+						__m128 sum = _mm_setzero_ps();
+						for (size_t k = 0; k < taps.tapCount; k++)
+						{
+							sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + (size_t)indices[k] * 4), _mm_set1_ps(weights[k])));
+						}
+						_mm_storeu_ps(target + (size_t)x * 4, sum);
+						continue;
+					}
+
+					float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					for (size_t k = 0; k < taps.tapCount; k++)
+					{
+						for (int c = 0; c < 4; c++)
+						{
+							sum[c] += row[(size_t)indices[k] * 4 + c] * weights[k];
+						}
+					}
+					std::memcpy(target + (size_t)x * 4, sum, sizeof(sum));
+				}
+			}
+		});
+	}
+
+	// Vertical pass, source height to target height. Whole source rows are
+	// accumulated into the target row, which keeps the reads sequential.
+	// Results are clamped so ringing does not build up down the chain.
+	void FilterVertical(const std::vector<float>& source, uint32_t width, uint32_t targetHeight, const FilterTaps& taps,
+		const MipGenerator::Settings& settings, std::vector<float>& output)
+	{
+		output.resize((size_t)width * targetHeight * 4);
+		RunRows(targetHeight, settings.parallel, [&](size_t begin, size_t end)
+		{
+			size_t rowFloats = (size_t)width * 4;
+			for (size_t y = begin; y < end; y++)
+			{
+				const uint32_t* indices = &taps.indices[y * taps.tapCount];
+				const float* weights = &taps.weights[y * taps.tapCount];
+				float* target = &output[y * rowFloats];
+				std::fill(target, target + rowFloats, 0.0f);
+
+				for (size_t k = 0; k < taps.tapCount; k++)
+				{
+					const float* row = &source[(size_t)indices[k] * rowFloats];
+					if (settings.useSimd)
+					{
+						__m128 weight = _mm_set1_ps(weights[k]);
+						for (size_t i = 0; i < rowFloats; i += 4)
+						{
+							_mm_storeu_ps(target + i, _mm_add_ps(_mm_loadu_ps(target + i), _mm_mul_ps(_mm_loadu_ps(row + i), weight)));
+						}
+					}
+					else
+					{
+						for (size_t i = 0; i < rowFloats; i++)
+						{
+							target[i] += row[i] * weights[k];
+						}
+					}
+				}
+
+				for (size_t i = 0; i < rowFloats; i++)
+				{
+					target[i] = std::min(std::max(target[i], 0.0f), 1.0f);
+				}
+			}
+		});
+	}
+
+	float GetCoverage(const std::vector<float>& texels, float reference)
+	{
+		size_t covered = 0;
+		size_t count = texels.size() / 4;
+		for (size_t i = 0; i < count; i++)
+		{
+			covered += texels[i * 4 + 3] >= reference ? 1 : 0;
+		}
+		return count > 0 ? (float)covered / (float)count : 0.0f;
+	}
+
+	// The alpha scale that brings the coverage at reference closest to the
+	// target, by bisecting the threshold the level would need. Coverage is a
+	// step function, so the closer of the two bounds is kept.
+	float FindAlphaScale(const std::vector<float>& texels, float reference, float targetCoverage)
+	{
+		float low = 0.0f;
+		float high = 1.0f;
+		for (int i = 0; i < 10; i++)
+		{
+			float threshold = (low + high) * 0.5f;
+			if (GetCoverage(texels, threshold) > targetCoverage)
+			{
+				low = threshold;
+			}
+			else
+			{
+				high = threshold;
+			}
+		}
+
+		bool lowCloser = std::fabs(GetCoverage(texels, low) - targetCoverage) < std::fabs(GetCoverage(texels, high) - targetCoverage);
+		float threshold = lowCloser ? low : high;
+		return threshold > 0.0f ? reference / threshold : 1.0f;
+	}
+
+	// Converts a filtered level back to RGBA8, adjusting alpha and normals on the way.
+	void StoreLevel(const std::vector<float>& texels, uint32_t width, uint32_t height, const MipGenerator::Settings& settings, float alphaScale, uint8_t* output)
+	{
+		const SrgbTables& tables = GetSrgbTables();
+		RunRows(height, settings.parallel, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin * width; i < end * width; i++)
+			{
+				float texel[4];
+				for (int c = 0; c < 4; c++)
+				{
+					texel[c] = std::min(std::max(texels[i * 4 + c], 0.0f), 1.0f);
+				}
+				texel[3] = std::min(texel[3] * alphaScale, 1.0f);
+
+				if (settings.renormalize)
+				{
+					float x = texel[0] * 2.0f - 1.0f;
+					float y = texel[1] * 2.0f - 1.0f;
+					float z = texel[2] * 2.0f - 1.0f;
+					float length = std::sqrt(x * x + y * y + z * z);
+					if (length > 1.0e-6f)
+					{
+						texel[0] = x / length * 0.5f + 0.5f;
+						texel[1] = y / length * 0.5f + 0.5f;
+						texel[2] = z / length * 0.5f + 0.5f;
+					}
+					else
+					{
+						texel[0] = 0.5f;
+						texel[1] = 0.5f;
+						texel[2] = 1.0f;
+					}
+				}
+
+				uint8_t* pixel = output + i * 4;
+				for (int c = 0; c < 4; c++)
+				{
+					if (settings.gammaCorrect && c < 3)
+					{
+						pixel[c] = tables.encode[(int)(texel[c] * 65535.0f + 0.5f)];
+					}
+					else
+					{
+						pixel[c] = (uint8_t)(texel[c] * 255.0f + 0.5f);
+					}
+				}
+			}
+		});
+	}
+}
+
+bool MipGenerator::Generate(const uint8_t* rgba, uint32_t width, uint32_t height, const Settings& settings, Image& outChain)
+{
+	if (!rgba || width == 0 || height == 0)
+	{
+		return false;
+	}
+
+	// Lay out the chain, largest level first.
+	outChain = Image();
+	outChain.format = ImageTypes::FORMAT_RGBA8;
+	outChain.width = width;
+	outChain.height = height;
+	uint32_t levelWidth = width;
+	uint32_t levelHeight = height;
+	size_t offset = 0;
+	for (;;)
+	{
+		ImageTypes::ImageLevel level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.rowPitch = levelWidth * 4;
+		level.offset = offset;
+		level.size = (size_t)levelWidth * levelHeight * 4;
+		offset += level.size;
+		outChain.levels.push_back(level);
+
+		if ((levelWidth == 1 && levelHeight == 1) || outChain.levels.size() == settings.maxLevels)
+		{
+			break;
+		}
+		levelWidth = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+	}
+	outChain.data.resize(offset);
+	std::memcpy(outChain.data.data(), rgba, outChain.levels[0].size);
+
+	// The top level in linear float, the rest is filtered from there.
+	const SrgbTables& tables = GetSrgbTables();
+	std::vector<float> current((size_t)width * height * 4);
+	RunRows(height, settings.parallel, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin * width * 4; i < end * width * 4; i++)
+		{
+			current[i] = settings.gammaCorrect && i % 4 != 3 ? tables.decode[rgba[i]] : rgba[i] / 255.0f;
+		}
+	});
+
+	float targetCoverage = settings.preserveAlphaCoverage ? GetCoverage(current, settings.alphaReference) : 0.0f;
+
+	std::vector<float> horizontal;
+	std::vector<float> next;
+	FilterTaps taps;
+	for (size_t i = 1; i < outChain.levels.size(); i++)
+	{
+		const ImageTypes::ImageLevel& source = outChain.levels[i - 1];
+		const ImageTypes::ImageLevel& level = outChain.levels[i];
+
+		// A dimension that is already 1 passes through unfiltered.
+		const std::vector<float>* rows = &current;
+		if (level.width != source.width)
+		{
+			BuildTaps(settings.filter, source.width, level.width, taps);
+			FilterHorizontal(current, source.width, source.height, level.width, taps, settings, horizontal);
+			rows = &horizontal;
+		}
+		if (level.height != source.height)
+		{
+			BuildTaps(settings.filter, source.height, level.height, taps);
+			FilterVertical(*rows, level.width, level.height, taps, settings, next);
+		}
+		else
+		{
+			next = *rows;
+		}
+
+		float alphaScale = settings.preserveAlphaCoverage ? FindAlphaScale(next, settings.alphaReference, targetCoverage) : 1.0f;
+		StoreLevel(next, level.width, level.height, settings, alphaScale, outChain.data.data() + level.offset);
+		current.swap(next);
+	}
+
+	return true;
+}
+
+bool MipGenerator::GenerateFaces(const uint8_t* const* faces, uint32_t faceCount, uint32_t width, uint32_t height, const Settings& settings, std::vector<Image>& outChains)
+{
+	outChains.clear();
+	outChains.resize(faceCount);
+
+	// Faces are independent, each also spreads its rows when parallel.
+	std::vector<char> generated(faceCount, 0);
+	auto generateFaces = [&](size_t begin, size_t end)
+	{
+		for (size_t face = begin; face < end; face++)
+		{
+			generated[face] = Generate(faces[face], width, height, settings, outChains[face]) ? 1 : 0;
+		}
+	};
+
+	if (settings.parallel)
+	{
+		JobSystem::GetInstance().ParallelFor(faceCount, 1, generateFaces);
+	}
+	else
+	{
+		generateFaces(0, faceCount);
+	}
+
+	return std::find(generated.begin(), generated.end(), 0) == generated.end();
+}
+
+const char* MipGenerator::GetFilterName(Filter filter)
+{
+	switch (filter)
+	{
+	case FILTER_BOX: return "box";
+	case FILTER_KAISER: return "Kaiser";
+	case FILTER_LANCZOS: return "Lanczos";
+	default: return "unknown";
+	}
+}
+
+float MipGenerator::GetAlphaCoverage(const uint8_t* rgba, uint32_t width, uint32_t height, float reference)
+{
+	size_t count = (size_t)width * height;
+	size_t covered = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		covered += rgba[i * 4 + 3] >= reference * 255.0f ? 1 : 0;
+	}
+	return count > 0 ? (float)covered / (float)count : 0.0f;
+}
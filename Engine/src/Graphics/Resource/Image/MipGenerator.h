@@ -0,0 +1,59 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ImageTypes.h"
+
+// Builds mip chains offline for the texture cooker, so loading a cooked
+// texture does no filtering at all.
+// - Each level is filtered from the one above it with a separable 2:1
+//   kernel in float. Odd sizes and non square images use the exact texel
+//   footprint, edges clamp.
+// - Color is filtered in linear space and converted back to sRGB, instead
+//   of averaging gamma encoded values, which darkens detail.
+// - Alpha tested textures keep the alpha coverage of the top level, so
+//   foliage and fences do not thin out in the distance.
+// - Normal maps are renormalized after filtering.
+// Texels are filtered as one SSE vector each and rows are spread over the
+// job system. Faces of arrays and cubemaps are independent and run in
+// parallel too.
+class MipGenerator
+{
+public:
+	using Image = ImageTypes::Image;
+
+	enum Filter
+	{
+		FILTER_BOX,                 // 2x2 average, fastest
+		FILTER_KAISER,              // Kaiser windowed sinc, sharp with little ringing
+		FILTER_LANCZOS              // Lanczos 3, sharpest, rings the most
+	};
+
+	struct Settings
+	{
+		Filter filter = FILTER_KAISER;
+		bool gammaCorrect = true;           // RGB is sRGB encoded, filter it linear
+		bool preserveAlphaCoverage = false;
+		float alphaReference = 0.5f;        // Alpha test threshold the coverage is measured at
+		bool renormalize = false;           // RGB is a unit normal in [0, 1]
+		uint32_t maxLevels = 0;             // Stop after this many levels, 0 for the full chain
+		bool useSimd = true;
+		bool parallel = true;
+	};
+
+public:
+	// Builds the chain down to 1x1 (or maxLevels) as FORMAT_RGBA8, level 0 is a copy of rgba.
+	static bool Generate(const uint8_t* rgba, uint32_t width, uint32_t height, const Settings& settings, Image& outChain);
+	// The same for every face of an array or cubemap, faces share a size.
+	static bool GenerateFaces(const uint8_t* const* faces, uint32_t faceCount, uint32_t width, uint32_t height, const Settings& settings, std::vector<Image>& outChains);
+
+	static const char* GetFilterName(Filter filter);
+
+	// Fraction of texels with alpha at or above reference.
+	static float GetAlphaCoverage(const uint8_t* rgba, uint32_t width, uint32_t height, float reference);
+};
+
+#endif // MIP_GENERATOR_H
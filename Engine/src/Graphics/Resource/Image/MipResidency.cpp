@@ -0,0 +1,219 @@
+#include "MipResidency.h"
+#include <algorithm>
+
+MipResidency::MipResidency()
+{
+	m_frame = 0;
+}
+
+void MipResidency::Initialize(const Settings& settings)
+{
+	m_settings = settings;
+	m_entries.clear();
+	m_freeEntries.clear();
+	m_frame = 0;
+	m_stats = Stats();
+}
+
+uint32_t MipResidency::AddTexture(const std::vector<ImageLevel>& levels, uint32_t baseLevel)
+{
+	uint32_t texture;
+	if (!m_freeEntries.empty())
+	{
+		texture = m_freeEntries.back();
+		m_freeEntries.pop_back();
+	}
+	else
+	{
+		texture = (uint32_t)m_entries.size();
+		m_entries.emplace_back();
+	}
+
+	Entry& entry = m_entries[texture];
+	entry = Entry();
+	entry.levels = levels;
+	entry.residentBytes.assign(levels.size() + 1, 0);
+	for (size_t i = levels.size(); i > 0; i--)
+	{
+		entry.residentBytes[i - 1] = entry.residentBytes[i] + levels[i - 1].size;
+	}
+	entry.baseLevel = levels.empty() ? 0 : std::min(baseLevel, (uint32_t)levels.size() - 1);
+	entry.residentLevel = entry.baseLevel;
+	entry.wantedLevel = entry.baseLevel;
+	entry.active = true;
+
+	m_stats.textureCount++;
+	m_stats.residentBytes += entry.residentBytes[entry.residentLevel];
+	m_stats.fullBytes += entry.residentBytes[0];
+
+	return texture;
+}
+
+void MipResidency::RemoveTexture(uint32_t texture)
+{
+	Entry& entry = m_entries[texture];
+	if (!entry.active)
+	{
+		return;
+	}
+
+	m_stats.textureCount--;
+	m_stats.residentBytes -= entry.residentBytes[entry.residentLevel];
+	m_stats.fullBytes -= entry.residentBytes[0];
+	entry = Entry();
+	m_freeEntries.push_back(texture);
+}
+
+void MipResidency::BeginFrame()
+{
+	m_frame++;
+}
+
+void MipResidency::Request(uint32_t texture, float screenSize)
+{
+	Entry& entry = m_entries[texture];
+	if (entry.lastUsedFrame != m_frame)
+	{
+		entry.lastUsedFrame = m_frame;
+		entry.screenSize = 0.0f;
+	}
+	entry.screenSize = std::max(entry.screenSize, screenSize);
+}
+
+void MipResidency::Update(std::vector<Change>& changes)
+{
+	changes.clear();
+	m_stats.loads = 0;
+	m_stats.evictions = 0;
+	m_stats.loadedBytes = 0;
+	m_stats.evictedBytes = 0;
+	m_stats.deferred = 0;
+	m_stats.wantedBytes = 0;
+
+	// Textures that want finer levels, and those holding more than they need.
+	std::vector<uint32_t> requests;
+	std::vector<uint32_t> evictable;
+	for (uint32_t texture = 0; texture < (uint32_t)m_entries.size(); texture++)
+	{
+		Entry& entry = m_entries[texture];
+		if (!entry.active)
+		{
+			continue;
+		}
+
+		bool used = entry.lastUsedFrame == m_frame;
+		entry.wantedLevel = used ? std::min(SelectLevel(entry.levels, entry.screenSize, m_settings.texelsPerPixel), entry.baseLevel) : entry.baseLevel;
+		m_stats.wantedBytes += entry.residentBytes[entry.wantedLevel];
+
+		if (entry.wantedLevel < entry.residentLevel)
+		{
+			requests.push_back(texture);
+		}
+		else if (entry.wantedLevel > entry.residentLevel)
+		{
+			evictable.push_back(texture);
+		}
+	}
+
+	// Largest on screen first; least recently used, then smallest, evicted first.
+	std::sort(requests.begin(), requests.end(), [this](uint32_t a, uint32_t b)
+	{
+		return m_entries[a].screenSize > m_entries[b].screenSize;
+	});
+	std::sort(evictable.begin(), evictable.end(), [this](uint32_t a, uint32_t b)
+	{
+		const Entry& first = m_entries[a];
+		const Entry& second = m_entries[b];
+		return first.lastUsedFrame != second.lastUsedFrame ? first.lastUsedFrame < second.lastUsedFrame : first.screenSize < second.screenSize;
+	});
+
+	size_t nextEvictable = 0;
+	size_t uploaded = 0;
+	for (uint32_t texture : requests)
+	{
+		Entry& entry = m_entries[texture];
+
+		// Back off one level at a time until the upload limit and budget allow it.
+		uint32_t target = entry.wantedLevel;
+		for (; target < entry.residentLevel; target++)
+		{
+			size_t cost = entry.residentBytes[target] - entry.residentBytes[entry.residentLevel];
+			if (uploaded > 0 && uploaded + cost > m_settings.uploadBytesPerFrame)
+			{
+				continue;
+			}
+
+			while (m_stats.residentBytes + cost > m_settings.budgetBytes && nextEvictable < evictable.size())
+			{
+				Entry& victim = m_entries[evictable[nextEvictable]];
+				m_stats.evictions++;
+				m_stats.evictedBytes += victim.residentBytes[victim.residentLevel] - victim.residentBytes[victim.wantedLevel];
+				SetResident(victim, victim.wantedLevel);
+				changes.push_back({ evictable[nextEvictable], victim.residentLevel });
+				nextEvictable++;
+			}
+
+			if (m_stats.residentBytes + cost <= m_settings.budgetBytes)
+			{
+				break;
+			}
+		}
+
+		if (target != entry.wantedLevel)
+		{
+			m_stats.deferred++;
+		}
+		if (target < entry.residentLevel)
+		{
+			size_t cost = entry.residentBytes[target] - entry.residentBytes[entry.residentLevel];
+			m_stats.loads++;
+			m_stats.loadedBytes += cost;
+			uploaded += cost;
+			SetResident(entry, target);
+			changes.push_back({ texture, target });
+		}
+	}
+}
+
+void MipResidency::SetResident(Entry& entry, uint32_t level)
+{
+	m_stats.residentBytes -= entry.residentBytes[entry.residentLevel];
+	m_stats.residentBytes += entry.residentBytes[level];
+	entry.residentLevel = level;
+}
+
+uint32_t MipResidency::SelectLevel(const std::vector<ImageLevel>& levels, float screenSize, float texelsPerPixel)
+{
+	if (levels.empty())
+	{
+		return 0;
+	}
+
+	float texels = screenSize * texelsPerPixel;
+	uint32_t level = 0;
+	while (level + 1 < (uint32_t)levels.size() && (float)std::max(levels[level + 1].width, levels[level + 1].height) >= texels)
+	{
+		level++;
+	}
+	return level;
+}
+
+uint32_t MipResidency::GetTailLevel(const std::vector<ImageLevel>& levels, uint32_t tailSize)
+{
+	for (uint32_t level = 0; level < (uint32_t)levels.size(); level++)
+	{
+		if (std::max(levels[level].width, levels[level].height) <= tailSize)
+		{
+			return level;
+		}
+	}
+	return levels.empty() ? 0 : (uint32_t)levels.size() - 1;
+}
+
+std::string MipResidency::FormatStats(const Stats& stats)
+{
+	return "Texture streaming: " + std::to_string(stats.textureCount) + " textures, " + std::to_string(stats.residentBytes / 1024) + " KB resident of " +
+		std::to_string(stats.fullBytes / 1024) + " KB (" + std::to_string(stats.wantedBytes / 1024) + " KB wanted), last update " +
+		std::to_string(stats.loads) + " loads (" + std::to_string(stats.loadedBytes / 1024) + " KB), " + std::to_string(stats.evictions) +
+		" evictions (" + std::to_string(stats.evictedBytes / 1024) + " KB), " + std::to_string(stats.deferred) + " deferred";
+}
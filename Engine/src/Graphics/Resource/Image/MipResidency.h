@@ -0,0 +1,107 @@
+#ifndef MIP_RESIDENCY_H
+#define MIP_RESIDENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImageTypes.h"
+
+// Decides which mip levels of the streamed textures are on the device. It
+// only does the bookkeeping, TextureStreamer applies the result, so it runs
+// headless.
+// - Every texture keeps its small levels (from its base level down)
+//   resident. Finer levels are requested each frame with the screen size,
+//   in pixels, of the objects that use the texture; the largest one wins.
+// - Requests are served largest on screen first, within a per frame upload
+//   limit. Levels nobody asked for stay until the budget needs the memory,
+//   then the least recently used textures drop back first.
+// A texture is resident from some level down to 1x1, so residency is just
+// the finest resident level.
+class MipResidency
+{
+public:
+	using ImageLevel = ImageTypes::ImageLevel;
+
+	struct Settings
+	{
+		size_t budgetBytes = 128 * 1024 * 1024;
+		size_t uploadBytesPerFrame = 16 * 1024 * 1024;  // One request always goes through
+		float texelsPerPixel = 1.0f;                    // Texels across the texture per pixel of the object
+	};
+
+	// A texture whose finest resident level changed in Update.
+	struct Change
+	{
+		uint32_t texture;
+		uint32_t residentLevel;
+	};
+
+	struct Stats
+	{
+		size_t textureCount = 0;
+		size_t residentBytes = 0;
+		size_t fullBytes = 0;       // With every level resident
+		size_t wantedBytes = 0;     // With exactly the requested levels resident
+		size_t loads = 0;           // Textures given finer levels, last Update
+		size_t evictions = 0;       // Textures dropped to coarser levels, last Update
+		size_t loadedBytes = 0;
+		size_t evictedBytes = 0;
+		size_t deferred = 0;        // Requests not (fully) served, last Update
+	};
+
+public:
+	MipResidency();
+
+	void Initialize(const Settings& settings);
+	const Settings& GetSettings() const { return m_settings; }
+
+	// Starts resident from baseLevel, which is never dropped. Returns the id.
+	uint32_t AddTexture(const std::vector<ImageLevel>& levels, uint32_t baseLevel);
+	void RemoveTexture(uint32_t texture);
+
+	// Requests are per frame: BeginFrame, any number of Request, Update.
+	void BeginFrame();
+	void Request(uint32_t texture, float screenSize);
+	void Update(std::vector<Change>& changes);
+
+	// Corrects the bookkeeping when a change could not be applied.
+	void SetResidentLevel(uint32_t texture, uint32_t level) { SetResident(m_entries[texture], level); }
+
+	uint32_t GetResidentLevel(uint32_t texture) const { return m_entries[texture].residentLevel; }
+	uint32_t GetWantedLevel(uint32_t texture) const { return m_entries[texture].wantedLevel; }
+	uint64_t GetFrame() const { return m_frame; }
+	const Stats& GetStats() const { return m_stats; }
+
+	// The coarsest level that still has a texel per screen pixel.
+	static uint32_t SelectLevel(const std::vector<ImageLevel>& levels, float screenSize, float texelsPerPixel);
+	// The finest level no larger than tailSize on either side.
+	static uint32_t GetTailLevel(const std::vector<ImageLevel>& levels, uint32_t tailSize);
+
+	static std::string FormatStats(const Stats& stats);
+
+private:
+	struct Entry
+	{
+		std::vector<ImageLevel> levels;
+		std::vector<size_t> residentBytes;      // Bytes with level i and all coarser ones resident
+		uint32_t baseLevel = 0;
+		uint32_t residentLevel = 0;
+		uint32_t wantedLevel = 0;
+		float screenSize = 0.0f;                // Largest request this frame
+		uint64_t lastUsedFrame = 0;
+		bool active = false;
+	};
+
+	void SetResident(Entry& entry, uint32_t level);
+
+private:
+	Settings m_settings;
+	std::vector<Entry> m_entries;
+	std::vector<uint32_t> m_freeEntries;
+	uint64_t m_frame;
+	Stats m_stats;
+};
+
+#endif // MIP_RESIDENCY_H
@@ -0,0 +1,531 @@
+#include "PngDecoder.h"
+#include "Inflate.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	const int MAX_DIMENSION = 1 << 24;
+
+	enum Filter
+	{
+		FILTER_NONE = 0,
+		FILTER_SUB = 1,
+		FILTER_UP = 2,
+		FILTER_AVERAGE = 3,
+		FILTER_PAETH = 4
+	};
+
+	// Adam7 passes, the whole image is the single pass of a plain image.
+	const int PASS_X[7] = { 0, 4, 0, 2, 0, 1, 0 };
+	const int PASS_Y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+	const int PASS_STEP_X[7] = { 8, 8, 4, 4, 2, 2, 1 };
+	const int PASS_STEP_Y[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+	uint32_t ReadUInt32(const uint8_t* data)
+	{
+		return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+	}
+
+	uint16_t ReadUInt16(const uint8_t* data)
+	{
+		return (uint16_t)((data[0] << 8) | data[1]);
+	}
+
+	int GetChannelCount(PngDecoder::ColorType colorType)
+	{
+		switch (colorType)
+		{
+		case PngDecoder::COLOR_GRAY: return 1;
+		case PngDecoder::COLOR_RGB: return 3;
+		case PngDecoder::COLOR_PALETTE: return 1;
+		case PngDecoder::COLOR_GRAY_ALPHA: return 2;
+		case PngDecoder::COLOR_RGBA: return 4;
+		}
+		return 0;
+	}
+
+	bool IsValidBitDepth(PngDecoder::ColorType colorType, int bitDepth)
+	{
+		switch (colorType)
+		{
+		case PngDecoder::COLOR_GRAY: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+		case PngDecoder::COLOR_PALETTE: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+		case PngDecoder::COLOR_RGB:
+		case PngDecoder::COLOR_GRAY_ALPHA:
+		case PngDecoder::COLOR_RGBA: return bitDepth == 8 || bitDepth == 16;
+		}
+		return false;
+	}
+
+	size_t GetRowBytes(const PngDecoder::Header& header, int width)
+	{
+		return ((size_t)width * GetChannelCount(header.colorType) * header.bitDepth + 7) / 8;
+	}
+
+	int GetPassSize(int size, int start, int step)
+	{
+		return size > start ? (size - start + step - 1) / step : 0;
+	}
+
+	uint8_t Paeth(int left, int above, int upperLeft)
+	{
+		int estimate = left + above - upperLeft;
+		int distanceLeft = std::abs(estimate - left);
+		int distanceAbove = std::abs(estimate - above);
+		int distanceUpperLeft = std::abs(estimate - upperLeft);
+		if (distanceLeft <= distanceAbove && distanceLeft <= distanceUpperLeft)
+		{
+			return (uint8_t)left;
+		}
+		return (uint8_t)(distanceAbove <= distanceUpperLeft ? above : upperLeft);
+	}
+
+	__m128i LoadPixel(const uint8_t* pixel, int bytesPerPixel)
+	{
+		int value = 0;
+		std::memcpy(&value, pixel, bytesPerPixel);
+		return _mm_cvtsi32_si128(value);
+	}
+
+	void StorePixel(uint8_t* pixel, __m128i value, int bytesPerPixel)
+	{
+		int packed = _mm_cvtsi128_si32(value);
+		std::memcpy(pixel, &packed, bytesPerPixel);
+	}
+
+	// Sub, Average and Paeth of 3 or 4 byte pixels, one pixel per step. Each
+	// pixel needs the one left of it, finished, so only the channels run in parallel.
+	void UnfilterPixelsSimd(Filter filter, uint8_t* row, const uint8_t* prior, size_t rowBytes, int bytesPerPixel)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi8(1);
+		__m128i left = zero;
+		__m128i upperLeft = zero;
+		for (size_t i = 0; i < rowBytes; i += bytesPerPixel)
+		{
+			__m128i current = LoadPixel(row + i, bytesPerPixel);
+			if (filter == FILTER_SUB)
+			{
+				current = _mm_add_epi8(current, left);
+			}
+			else if (filter == FILTER_AVERAGE)
+			{
+				// avg_epu8 rounds up, the filter rounds down.
+				__m128i above = LoadPixel(prior + i, bytesPerPixel);
+				__m128i average = _mm_sub_epi8(_mm_avg_epu8(left, above), _mm_and_si128(_mm_xor_si128(left, above), one));
+				current = _mm_add_epi8(current, average);
+			}
+			else
+			{
+				__m128i above = LoadPixel(prior + i, bytesPerPixel);
+				__m128i a = _mm_unpacklo_epi8(left, zero);
+				__m128i b = _mm_unpacklo_epi8(above, zero);
+				__m128i c = _mm_unpacklo_epi8(upperLeft, zero);
+
+				// |p - a| = |b - c|, |p - b| = |a - c|, |p - c| = |(b - c) + (a - c)|
+				__m128i toAbove = _mm_sub_epi16(b, c);
+				__m128i toLeft = _mm_sub_epi16(a, c);
+				__m128i distanceLeft = _mm_max_epi16(toAbove, _mm_sub_epi16(zero, toAbove));
+				__m128i distanceAbove = _mm_max_epi16(toLeft, _mm_sub_epi16(zero, toLeft));
+				__m128i sum = _mm_add_epi16(toAbove, toLeft);
+				__m128i distanceUpperLeft = _mm_max_epi16(sum, _mm_sub_epi16(zero, sum));
+
+				// Left if it is no farther than either, else above if no farther than upper left.
+				__m128i smallest = _mm_min_epi16(distanceUpperLeft, _mm_min_epi16(distanceLeft, distanceAbove));
+				__m128i pickLeft = _mm_cmpeq_epi16(smallest, distanceLeft);
+				__m128i pickAbove = _mm_cmpeq_epi16(smallest, distanceAbove);
+				__m128i predictor = _mm_or_si128(_mm_and_si128(pickAbove, b), _mm_andnot_si128(pickAbove, c));
+				predictor = _mm_or_si128(_mm_and_si128(pickLeft, a), _mm_andnot_si128(pickLeft, predictor));
+
+				current = _mm_add_epi8(current, _mm_packus_epi16(predictor, predictor));
+				upperLeft = above;
+			}
+
+			StorePixel(row + i, current, bytesPerPixel);
+			left = current;
+		}
+	}
+
+	// prior is the unfiltered row above, zeros for the first row of a pass.
+	bool UnfilterRow(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t rowBytes, int bytesPerPixel, bool useSimd)
+	{
+		size_t i = 0;
+		switch (filter)
+		{
+		case FILTER_NONE:
+			return true;
+
+		case FILTER_UP:
+			if (useSimd)
+			{
+				for (; i + 16 <= rowBytes; i += 16)
+				{
+					__m128i current = _mm_loadu_si128((const __m128i*)(row + i));
+					__m128i above = _mm_loadu_si128((const __m128i*)(prior + i));
+					_mm_storeu_si128((__m128i*)(row + i), _mm_add_epi8(current, above));
+				}
+			}
+			for (; i < rowBytes; i++)
+			{
+				row[i] = (uint8_t)(row[i] + prior[i]);
+			}
+			return true;
+
+		case FILTER_SUB:
+		case FILTER_AVERAGE:
+		case FILTER_PAETH:
+			if (useSimd && (bytesPerPixel == 3 || bytesPerPixel == 4))
+			{
+				UnfilterPixelsSimd((Filter)filter, row, prior, rowBytes, bytesPerPixel);
+				return true;
+			}
+			break;
+
+		default:
+			return false;
+		}
+
+		// The first pixel has nothing to its left.
+		size_t first = std::min((size_t)bytesPerPixel, rowBytes);
+		for (; i < first; i++)
+		{
+			if (filter == FILTER_AVERAGE)
+			{
+				row[i] = (uint8_t)(row[i] + (prior[i] >> 1));
+			}
+			else if (filter == FILTER_PAETH)
+			{
+				row[i] = (uint8_t)(row[i] + prior[i]);
+			}
+		}
+		for (; i < rowBytes; i++)
+		{
+			if (filter == FILTER_SUB)
+			{
+				row[i] = (uint8_t)(row[i] + row[i - bytesPerPixel]);
+			}
+			else if (filter == FILTER_AVERAGE)
+			{
+				row[i] = (uint8_t)(row[i] + ((row[i - bytesPerPixel] + prior[i]) >> 1));
+			}
+			else
+			{
+				row[i] = (uint8_t)(row[i] + Paeth(row[i - bytesPerPixel], prior[i], prior[i - bytesPerPixel]));
+			}
+		}
+		return true;
+	}
+
+	// Expands count pixels of an unfiltered row to RGBA.
+	void ExpandRow(const PngDecoder::Header& header, const uint8_t* row, int count, uint8_t* output)
+	{
+		const int bitDepth = header.bitDepth;
+		const uint16_t* key = header.colorKey;
+
+		if (bitDepth < 8)
+		{
+			// Packed gray or palette indices, the first pixel in the high bits.
+			const int mask = (1 << bitDepth) - 1;
+			const int scale = 255 / mask;
+			for (int x = 0; x < count; x++)
+			{
+				int bit = x * bitDepth;
+				int value = (row[bit >> 3] >> (8 - bitDepth - (bit & 7))) & mask;
+				uint8_t* pixel = output + (size_t)x * 4;
+				if (header.colorType == PngDecoder::COLOR_PALETTE)
+				{
+					std::memcpy(pixel, header.palette + value * 4, 4);
+				}
+				else
+				{
+					pixel[0] = pixel[1] = pixel[2] = (uint8_t)(value * scale);
+					pixel[3] = header.hasColorKey && value == key[0] ? 0 : 255;
+				}
+			}
+			return;
+		}
+
+		const bool wide = bitDepth == 16;
+		const int sampleBytes = wide ? 2 : 1;
+		auto sample = [&](const uint8_t* at) -> uint16_t { return wide ? ReadUInt16(at) : *at; };
+
+		switch (header.colorType)
+		{
+		case PngDecoder::COLOR_GRAY:
+			for (int x = 0; x < count; x++)
+			{
+				const uint8_t* source = row + (size_t)x * sampleBytes;
+				uint8_t* pixel = output + (size_t)x * 4;
+				pixel[0] = pixel[1] = pixel[2] = source[0];
+				pixel[3] = header.hasColorKey && sample(source) == key[0] ? 0 : 255;
+			}
+			break;
+
+		case PngDecoder::COLOR_GRAY_ALPHA:
+			for (int x = 0; x < count; x++)
+			{
+				const uint8_t* source = row + (size_t)x * 2 * sampleBytes;
+				uint8_t* pixel = output + (size_t)x * 4;
+				pixel[0] = pixel[1] = pixel[2] = source[0];
+				pixel[3] = source[sampleBytes];
+			}
+			break;
+
+		case PngDecoder::COLOR_RGB:
+			for (int x = 0; x < count; x++)
+			{
+				const uint8_t* source = row + (size_t)x * 3 * sampleBytes;
+				uint8_t* pixel = output + (size_t)x * 4;
+				pixel[0] = source[0];
+				pixel[1] = source[sampleBytes];
+				pixel[2] = source[sampleBytes * 2];
+				pixel[3] = header.hasColorKey && sample(source) == key[0] && sample(source + sampleBytes) == key[1] &&
+					sample(source + sampleBytes * 2) == key[2] ? 0 : 255;
+			}
+			break;
+
+		case PngDecoder::COLOR_PALETTE:
+			for (int x = 0; x < count; x++)
+			{
+				std::memcpy(output + (size_t)x * 4, header.palette + row[x] * 4, 4);
+			}
+			break;
+
+		case PngDecoder::COLOR_RGBA:
+			if (!wide)
+			{
+				std::memcpy(output, row, (size_t)count * 4);
+				break;
+			}
+			for (int x = 0; x < count * 4; x++)
+			{
+				output[x] = row[x * 2];
+			}
+			break;
+		}
+	}
+}
+
+bool PngDecoder::ReadHeader(const uint8_t* data, size_t size, Header& header)
+{
+	header = Header();
+	for (int i = 0; i < 256; i++)
+	{
+		uint8_t* entry = header.palette + i * 4;
+		entry[0] = entry[1] = entry[2] = 0;
+		entry[3] = 255;
+	}
+
+	if (!data || size < sizeof(SIGNATURE) || std::memcmp(data, SIGNATURE, sizeof(SIGNATURE)) != 0)
+	{
+		return false;
+	}
+
+	bool hasHeader = false;
+	size_t offset = sizeof(SIGNATURE);
+	for (;;)
+	{
+		// Length, type, data, CRC.
+		if (size - offset < 12)
+		{
+			return false;
+		}
+		uint32_t length = ReadUInt32(data + offset);
+		const uint8_t* type = data + offset + 4;
+		const uint8_t* chunk = data + offset + 8;
+		if (length > size - offset - 12)
+		{
+			return false;
+		}
+		offset += 12 + (size_t)length;
+
+		if (std::memcmp(type, "IHDR", 4) == 0)
+		{
+			if (hasHeader || length != 13)
+			{
+				return false;
+			}
+			uint32_t width = ReadUInt32(chunk);
+			uint32_t height = ReadUInt32(chunk + 4);
+			header.bitDepth = chunk[8];
+			header.colorType = (ColorType)chunk[9];
+			header.interlaced = chunk[12] == 1;
+			if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION || !IsValidBitDepth(header.colorType, header.bitDepth) ||
+				chunk[10] != 0 || chunk[11] != 0 || chunk[12] > 1)
+			{
+				return false;
+			}
+			header.width = (int)width;
+			header.height = (int)height;
+			hasHeader = true;
+		}
+		else if (!hasHeader)
+		{
+			return false;
+		}
+		else if (std::memcmp(type, "PLTE", 4) == 0)
+		{
+			if (length % 3 != 0 || length / 3 > 256 || length == 0)
+			{
+				return false;
+			}
+			header.paletteSize = (int)(length / 3);
+			for (int i = 0; i < header.paletteSize; i++)
+			{
+				std::memcpy(header.palette + i * 4, chunk + i * 3, 3);
+			}
+		}
+		else if (std::memcmp(type, "tRNS", 4) == 0)
+		{
+			if (header.colorType == COLOR_PALETTE)
+			{
+				if (length > (uint32_t)header.paletteSize)
+				{
+					return false;
+				}
+				for (uint32_t i = 0; i < length; i++)
+				{
+					header.palette[i * 4 + 3] = chunk[i];
+				}
+			}
+			else if (header.colorType == COLOR_GRAY || header.colorType == COLOR_RGB)
+			{
+				int keyCount = header.colorType == COLOR_GRAY ? 1 : 3;
+				if (length != (uint32_t)keyCount * 2)
+				{
+					return false;
+				}
+				for (int i = 0; i < keyCount; i++)
+				{
+					header.colorKey[i] = ReadUInt16(chunk + i * 2);
+				}
+				header.hasColorKey = true;
+			}
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0)
+		{
+			header.dataOffsets.push_back((size_t)(chunk - data));
+			header.dataSizes.push_back(length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0)
+		{
+			break;
+		}
+		else if (!(type[0] & 0x20))
+		{
+			// An unknown chunk the image cannot be shown without.
+			return false;
+		}
+	}
+
+	return !header.dataOffsets.empty() && (header.colorType != COLOR_PALETTE || header.paletteSize > 0);
+}
+
+bool PngDecoder::Decode(const uint8_t* data, size_t size, const Header& header, uint8_t* output, const Settings& settings)
+{
+	if (!data || !output || header.width <= 0 || header.height <= 0 || header.dataOffsets.empty())
+	{
+		return false;
+	}
+
+	// Every pass row is a filter byte and the packed pixels.
+	const int passCount = header.interlaced ? 7 : 1;
+	size_t filteredSize = 0;
+	for (int pass = 0; pass < passCount; pass++)
+	{
+		int passWidth = header.interlaced ? GetPassSize(header.width, PASS_X[pass], PASS_STEP_X[pass]) : header.width;
+		int passHeight = header.interlaced ? GetPassSize(header.height, PASS_Y[pass], PASS_STEP_Y[pass]) : header.height;
+		if (passWidth > 0 && passHeight > 0)
+		{
+			filteredSize += (size_t)passHeight * (1 + GetRowBytes(header, passWidth));
+		}
+	}
+
+	// The zlib stream may be split over many IDAT chunks, join them unless there is only the one.
+	const uint8_t* compressed = data + header.dataOffsets[0];
+	size_t compressedSize = header.dataSizes[0];
+	std::vector<uint8_t> joined;
+	if (header.dataOffsets.size() > 1)
+	{
+		size_t total = 0;
+		for (size_t chunkSize : header.dataSizes)
+		{
+			total += chunkSize;
+		}
+		joined.resize(total);
+		size_t position = 0;
+		for (size_t i = 0; i < header.dataOffsets.size(); i++)
+		{
+			if (header.dataOffsets[i] + header.dataSizes[i] > size)
+			{
+				return false;
+			}
+			std::memcpy(joined.data() + position, data + header.dataOffsets[i], header.dataSizes[i]);
+			position += header.dataSizes[i];
+		}
+		compressed = joined.data();
+		compressedSize = joined.size();
+	}
+	else if (header.dataOffsets[0] + compressedSize > size)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> filtered(filteredSize);
+	size_t written = 0;
+	if (!Inflate::DecompressZlib(compressed, compressedSize, filtered.data(), filtered.size(), written) || written != filteredSize)
+	{
+		return false;
+	}
+
+	// Filters work on whole bytes, at least one, whatever the pixel size.
+	const int bytesPerPixel = std::max(1, GetChannelCount(header.colorType) * header.bitDepth / 8);
+	std::vector<uint8_t> zeroRow(GetRowBytes(header, header.width), 0);
+	std::vector<uint8_t> expanded(header.interlaced ? (size_t)header.width * 4 : 0);
+
+	uint8_t* row = filtered.data();
+	for (int pass = 0; pass < passCount; pass++)
+	{
+		int passWidth = header.interlaced ? GetPassSize(header.width, PASS_X[pass], PASS_STEP_X[pass]) : header.width;
+		int passHeight = header.interlaced ? GetPassSize(header.height, PASS_Y[pass], PASS_STEP_Y[pass]) : header.height;
+		if (passWidth == 0 || passHeight == 0)
+		{
+			continue;
+		}
+
+		size_t rowBytes = GetRowBytes(header, passWidth);
+		const uint8_t* prior = zeroRow.data();
+		for (int y = 0; y < passHeight; y++)
+		{
+			uint8_t* pixels = row + 1;
+			if (!UnfilterRow(row[0], pixels, prior, rowBytes, bytesPerPixel, settings.useSimd))
+			{
+				return false;
+			}
+
+			if (!header.interlaced)
+			{
+				ExpandRow(header, pixels, passWidth, output + (size_t)y * header.width * 4);
+			}
+			else
+			{
+				// Scatter the pass pixels to their place in the image.
+				ExpandRow(header, pixels, passWidth, expanded.data());
+				uint8_t* target = output + ((size_t)(PASS_Y[pass] + y * PASS_STEP_Y[pass]) * header.width + PASS_X[pass]) * 4;
+				for (int x = 0; x < passWidth; x++)
+				{
+					std::memcpy(target + (size_t)x * PASS_STEP_X[pass] * 4, expanded.data() + (size_t)x * 4, 4);
+				}
+			}
+
+			prior = pixels;
+			row += 1 + rowBytes;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Decodes PNG images straight from file memory into top-down RGBA8 rows.
+// - Every color type and bit depth, palettes and tRNS transparency, Adam7
+//   interlacing. 16 bit samples keep their high byte.
+// - The image data is inflated in one go into the filtered rows, which are
+//   then unfiltered in place and expanded to RGBA one row at a time. A file
+//   with a single IDAT chunk is inflated from the view without a copy.
+// - Sub, Average and Paeth rows of 3 and 4 byte pixels are unfiltered with
+//   SSE2, a pixel per step, Up rows 16 bytes per step.
+// - Chunk CRCs and the zlib checksum are not checked, the data is bounds
+//   checked throughout instead.
+class PngDecoder
+{
+public:
+	enum ColorType
+	{
+		COLOR_GRAY = 0,
+		COLOR_RGB = 2,
+		COLOR_PALETTE = 3,
+		COLOR_GRAY_ALPHA = 4,
+		COLOR_RGBA = 6
+	};
+
+	struct Header
+	{
+		int width = 0;
+		int height = 0;
+		int bitDepth = 0;
+		ColorType colorType = COLOR_GRAY;
+		bool interlaced = false;
+		int paletteSize = 0;
+		uint8_t palette[256 * 4];           // RGBA, tRNS alpha applied, opaque black past paletteSize
+		bool hasColorKey = false;           // tRNS of gray and RGB images
+		uint16_t colorKey[3] = {};
+		std::vector<size_t> dataOffsets;    // IDAT chunk data, in file order
+		std::vector<size_t> dataSizes;
+	};
+
+	struct Settings
+	{
+		bool useSimd = true;
+	};
+
+public:
+	// Walks every chunk up to IEND, false for truncated or unsupported files.
+	static bool ReadHeader(const uint8_t* data, size_t size, Header& header);
+
+	// output receives width * height * 4 bytes.
+	static bool Decode(const uint8_t* data, size_t size, const Header& header, uint8_t* output, const Settings& settings);
+};
+
+#endif // PNG_DECODER_H
@@ -0,0 +1,224 @@
+#include "TargaDecoder.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SSSE3_FUNCTION
+#else
+#include <cpuid.h>
+#define SSSE3_FUNCTION __attribute__((target("ssse3")))
+#endif
+
+namespace
+{
+	const size_t HEADER_SIZE = 18;
+	const uint8_t IMAGE_TRUE_COLOR = 2;
+	const uint8_t IMAGE_TRUE_COLOR_RLE = 10;
+	const uint8_t DESCRIPTOR_TOP_DOWN = 0x20;
+	const uint8_t DESCRIPTOR_RIGHT_TO_LEFT = 0x10;
+
+	uint16_t ReadUInt16(const uint8_t* data)
+	{
+		return (uint16_t)(data[0] | (data[1] << 8));
+	}
+
+	uint32_t ToRGBA(const uint8_t* source, int bytesPerPixel)
+	{
+		uint32_t alpha = bytesPerPixel == 4 ? source[3] : 0xFF;
+		return (uint32_t)source[2] | ((uint32_t)source[1] << 8) | ((uint32_t)source[0] << 16) | (alpha << 24);
+	}
+
+	// The 24 bit swizzle needs SSSE3, which the build does not assume, so it is picked when the CPU has it.
+	bool HasSsse3()
+	{
+		static const bool hasSsse3 = []()
+		{
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 9)) != 0;
+#else
+			unsigned int eax, ebx, ecx, edx;
+			return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 9)) != 0;
+#endif
+		}();
+		return hasSsse3;
+	}
+
+	// Four pixels from each 16 byte load, so it stops while a full load still fits. Returns the pixels done.
+	SSSE3_FUNCTION size_t ConvertPixels24Ssse3(const uint8_t* source, uint8_t* output, size_t count)
+	{
+		const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+		size_t i = 0;
+		for (; i + 6 <= count; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(source + i * 3));
+			pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha);
+			_mm_storeu_si128((__m128i*)(output + i * 4), pixels);
+		}
+		return i;
+	}
+
+	// Swizzles count BGR(A) pixels to RGBA.
+	void ConvertPixels(const uint8_t* source, int bytesPerPixel, uint8_t* output, size_t count, bool useSimd)
+	{
+		size_t i = 0;
+		if (useSimd && bytesPerPixel == 4)
+		{
+			// Swap the red and blue bytes of each 32 bit lane, green and alpha stay.
+			const __m128i keepMask = _mm_set1_epi32((int)0xFF00FF00);
+			const __m128i lowMask = _mm_set1_epi32(0x000000FF);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(source + i * 4));
+				__m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowMask);
+				__m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, lowMask), 16);
+				pixels = _mm_or_si128(_mm_and_si128(pixels, keepMask), _mm_or_si128(red, blue));
+				_mm_storeu_si128((__m128i*)(output + i * 4), pixels);
+			}
+		}
+		else if (useSimd && bytesPerPixel == 3 && HasSsse3())
+		{
+			i = ConvertPixels24Ssse3(source, output, count);
+		}
+
+		for (; i < count; i++)
+		{
+			uint32_t pixel = ToRGBA(source + i * bytesPerPixel, bytesPerPixel);
+			std::memcpy(output + i * 4, &pixel, sizeof(pixel));
+		}
+	}
+}
+
+bool TargaDecoder::ReadHeader(const uint8_t* data, size_t size, Header& header)
+{
+	if (!data || size < HEADER_SIZE)
+	{
+		return false;
+	}
+
+	uint8_t idLength = data[0];
+	uint8_t colorMapType = data[1];
+	uint8_t imageType = data[2];
+	uint8_t descriptor = data[17];
+	if (imageType != IMAGE_TRUE_COLOR && imageType != IMAGE_TRUE_COLOR_RLE)
+	{
+		return false;
+	}
+	if (descriptor & DESCRIPTOR_RIGHT_TO_LEFT)
+	{
+		return false;
+	}
+
+	header.width = ReadUInt16(data + 12);
+	header.height = ReadUInt16(data + 14);
+	header.bitsPerPixel = data[16];
+	header.compressed = imageType == IMAGE_TRUE_COLOR_RLE;
+	header.topDown = (descriptor & DESCRIPTOR_TOP_DOWN) != 0;
+	if (header.width == 0 || header.height == 0 || (header.bitsPerPixel != 24 && header.bitsPerPixel != 32))
+	{
+		return false;
+	}
+
+	// True color images may still carry a color map, it is skipped.
+	size_t colorMapSize = 0;
+	if (colorMapType != 0)
+	{
+		colorMapSize = (size_t)ReadUInt16(data + 5) * ((data[7] + 7) / 8);
+	}
+
+	header.pixelOffset = HEADER_SIZE + idLength + colorMapSize;
+	return header.pixelOffset <= size;
+}
+
+bool TargaDecoder::Decode(const uint8_t* data, size_t size, const Header& header, uint8_t* output, const Settings& settings)
+{
+	if (!data || !output || header.width <= 0 || header.height <= 0 || header.pixelOffset > size)
+	{
+		return false;
+	}
+
+	const int bytesPerPixel = header.bitsPerPixel / 8;
+	const size_t width = (size_t)header.width;
+	const size_t height = (size_t)header.height;
+	const size_t pixelCount = width * height;
+	const size_t rowPitch = width * 4;
+
+	// Output rows are top first, bottom-up files fill them from the end.
+	auto outputRow = [&](size_t row) -> uint8_t*
+	{
+		return output + (header.topDown ? row : height - 1 - row) * rowPitch;
+	};
+
+	const uint8_t* source = data + header.pixelOffset;
+	size_t remaining = size - header.pixelOffset;
+
+	if (!header.compressed)
+	{
+		if (remaining < pixelCount * bytesPerPixel)
+		{
+			return false;
+		}
+
+		for (size_t row = 0; row < height; row++)
+		{
+			ConvertPixels(source + row * width * bytesPerPixel, bytesPerPixel, outputRow(row), width, settings.useSimd);
+		}
+		return true;
+	}
+
+	// Packets are a count byte, then either one pixel repeated or count raw
+	// pixels. Writers let packets run across rows, so spans are split at row ends.
+	const uint8_t* end = source + remaining;
+	size_t pixel = 0;
+	while (pixel < pixelCount)
+	{
+		if (source >= end)
+		{
+			return false;
+		}
+
+		uint8_t packet = *source++;
+		size_t count = (size_t)(packet & 0x7F) + 1;
+		bool repeat = (packet & 0x80) != 0;
+		if (pixel + count > pixelCount || (size_t)(end - source) < (repeat ? 1 : count) * bytesPerPixel)
+		{
+			return false;
+		}
+
+		uint32_t value = repeat ? ToRGBA(source, bytesPerPixel) : 0;
+		while (count > 0)
+		{
+			size_t row = pixel / width;
+			size_t column = pixel % width;
+			size_t span = std::min(count, width - column);
+			uint8_t* target = outputRow(row) + column * 4;
+
+			if (repeat)
+			{
+				for (size_t i = 0; i < span; i++)
+				{
+					std::memcpy(target + i * 4, &value, sizeof(value));
+				}
+			}
+			else
+			{
+				ConvertPixels(source, bytesPerPixel, target, span, settings.useSimd);
+				source += span * bytesPerPixel;
+			}
+
+			pixel += span;
+			count -= span;
+		}
+
+		if (repeat)
+		{
+			source += bytesPerPixel;
+		}
+	}
+
+	return true;
+}
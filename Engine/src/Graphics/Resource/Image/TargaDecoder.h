@@ -0,0 +1,41 @@
+#ifndef TARGA_DECODER_H
+#define TARGA_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Decodes TGA images straight from file memory (e.g. a MappedFile view) into
+// top-down RGBA8 rows, the layout the textures upload.
+// - Uncompressed and run-length encoded true color images, 24 or 32 bits.
+// - The vertical flip, the BGR(A) to RGBA swizzle and the RLE expansion all
+//   happen in the one pass that writes the output, there is no intermediate
+//   copy of the image.
+// - Rows are swizzled four pixels at a time with SSE2, and 24 bit rows with
+//   SSSE3 shuffles when the CPU has them, checked at run time.
+class TargaDecoder
+{
+public:
+	struct Header
+	{
+		int width = 0;
+		int height = 0;
+		int bitsPerPixel = 0;
+		bool compressed = false;
+		bool topDown = false;       // Rows stored top first, most files store them bottom first
+		size_t pixelOffset = 0;     // Of the first pixel or packet in the file
+	};
+
+	struct Settings
+	{
+		bool useSimd = true;
+	};
+
+public:
+	// Validates the header, false for truncated or unsupported files.
+	static bool ReadHeader(const uint8_t* data, size_t size, Header& header);
+
+	// output receives width * height * 4 bytes.
+	static bool Decode(const uint8_t* data, size_t size, const Header& header, uint8_t* output, const Settings& settings);
+};
+
+#endif // TARGA_DECODER_H
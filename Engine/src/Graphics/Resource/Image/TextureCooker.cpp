@@ -0,0 +1,212 @@
+#include "TextureCooker.h"
+#include "../../../Core/System/JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// Channels a role keeps, as a mask of R, G, B, A.
+	int GetRoleChannels(ImageTypes::TextureRole role, bool hasAlpha)
+	{
+		switch (role)
+		{
+		case ImageTypes::ROLE_NORMAL: return 0x3;
+		case ImageTypes::ROLE_MASK: return 0x1;
+		case ImageTypes::ROLE_EMISSION: return 0x7;
+		case ImageTypes::ROLE_ALBEDO: return hasAlpha ? 0xF : 0x7;
+		default: return 0xF;
+		}
+	}
+}
+
+TextureCooker::PixelFormat TextureCooker::ChooseFormat(TextureRole role, bool hasAlpha, const Settings& settings)
+{
+	switch (role)
+	{
+	case ImageTypes::ROLE_ALBEDO:
+		if (settings.highQualityAlbedo)
+		{
+			return ImageTypes::FORMAT_BC7;
+		}
+		return hasAlpha ? ImageTypes::FORMAT_BC3 : ImageTypes::FORMAT_BC1;
+	case ImageTypes::ROLE_NORMAL:
+		return ImageTypes::FORMAT_BC5;
+	case ImageTypes::ROLE_MASK:
+		return ImageTypes::FORMAT_BC4;
+	case ImageTypes::ROLE_EMISSION:
+		return ImageTypes::FORMAT_BC1;
+	default:
+		return ImageTypes::FORMAT_RGBA8;
+	}
+}
+
+MipGenerator::Settings TextureCooker::GetMipSettings(TextureRole role, bool hasAlpha, const Settings& settings)
+{
+	MipGenerator::Settings mipSettings;
+	mipSettings.filter = settings.mipFilter;
+	mipSettings.gammaCorrect = role == ImageTypes::ROLE_ALBEDO || role == ImageTypes::ROLE_EMISSION || role == ImageTypes::ROLE_NONE;
+	mipSettings.preserveAlphaCoverage = settings.preserveAlphaCoverage && role == ImageTypes::ROLE_ALBEDO && hasAlpha;
+	mipSettings.alphaReference = settings.alphaReference;
+	mipSettings.renormalize = role == ImageTypes::ROLE_NORMAL;
+	mipSettings.useSimd = settings.compression.useSimd;
+	mipSettings.parallel = settings.compression.parallel;
+	return mipSettings;
+}
+
+bool TextureCooker::Cook(const uint8_t* rgba, uint32_t width, uint32_t height, TextureRole role, const Settings& settings, Image& outImage, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if (!rgba || width == 0 || height == 0)
+	{
+		return false;
+	}
+
+	bool hasAlpha = false;
+	for (size_t i = 0; i < (size_t)width * height && !hasAlpha; i++)
+	{
+		hasAlpha = rgba[i * 4 + 3] != 255;
+	}
+
+	// The chain as RGBA8, or just the top level.
+	Image chain;
+	MipGenerator::Settings mipSettings = GetMipSettings(role, hasAlpha, settings);
+	auto mipStartTime = std::chrono::high_resolution_clock::now();
+	if (settings.generateMips)
+	{
+		if (!MipGenerator::Generate(rgba, width, height, mipSettings, chain))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		ImageTypes::ImageLevel level = { width, height, width * 4, 0, (size_t)width * height * 4 };
+		chain.levels.push_back(level);
+		chain.data.assign(rgba, rgba + level.size);
+	}
+	double mipTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - mipStartTime).count();
+
+	outImage = Image();
+	outImage.format = ChooseFormat(role, hasAlpha, settings);
+	outImage.width = width;
+	outImage.height = height;
+
+	size_t offset = 0;
+	size_t sourceBytes = 0;
+	for (const ImageTypes::ImageLevel& source : chain.levels)
+	{
+		ImageTypes::ImageLevel level;
+		level.width = source.width;
+		level.height = source.height;
+		level.rowPitch = BlockCompressor::GetRowPitch(outImage.format, source.width);
+		level.offset = offset;
+		level.size = BlockCompressor::GetLevelSize(outImage.format, source.width, source.height);
+		offset += level.size;
+		sourceBytes += source.size;
+		outImage.levels.push_back(level);
+	}
+	outImage.data.resize(offset);
+
+	// Levels are independent once filtered, the small ones finish while the
+	// top level's block rows are still being compressed.
+	std::vector<char> compressed(chain.levels.size(), 0);
+	auto compressLevels = [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const uint8_t* source = chain.data.data() + chain.levels[i].offset;
+			const ImageTypes::ImageLevel& level = outImage.levels[i];
+			uint8_t* target = outImage.data.data() + level.offset;
+			if (!BlockCompressor::IsBlockCompressed(outImage.format))
+			{
+				std::memcpy(target, source, level.size);
+				compressed[i] = 1;
+			}
+			else
+			{
+				compressed[i] = BlockCompressor::Compress(source, level.width, level.height, outImage.format, target, settings.compression) ? 1 : 0;
+			}
+		}
+	};
+
+	if (settings.compression.parallel)
+	{
+		JobSystem::GetInstance().ParallelFor(chain.levels.size(), 1, compressLevels);
+	}
+	else
+	{
+		compressLevels(0, chain.levels.size());
+	}
+
+	if (std::find(compressed.begin(), compressed.end(), 0) != compressed.end())
+	{
+		return false;
+	}
+
+	if (stats)
+	{
+		Stats localStats;
+		localStats.format = outImage.format;
+		localStats.width = width;
+		localStats.height = height;
+		localStats.levelCount = outImage.levels.size();
+		localStats.sourceBytes = sourceBytes;
+		localStats.cookedBytes = outImage.data.size();
+		localStats.mipTimeMs = mipTimeMs;
+
+		if (BlockCompressor::IsBlockCompressed(outImage.format))
+		{
+			std::vector<uint8_t> decoded((size_t)width * height * 4);
+			BlockCompressor::Decompress(outImage.data.data(), width, height, outImage.format, decoded.data());
+
+			int channels = GetRoleChannels(role, hasAlpha);
+			double errorSum = 0.0;
+			size_t samples = 0;
+			for (size_t i = 0; i < decoded.size(); i++)
+			{
+				if (channels & (1 << (i % 4)))
+				{
+					double difference = (double)decoded[i] - (double)rgba[i];
+					errorSum += difference * difference;
+					samples++;
+				}
+			}
+			localStats.rmse = samples > 0 ? std::sqrt(errorSum / samples) : 0.0;
+		}
+
+		localStats.cookTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		*stats = localStats;
+	}
+
+	return true;
+}
+
+std::string TextureCooker::GetCookedFilename(const std::string& sourceFilename, TextureRole role)
+{
+	return sourceFilename + "." + GetRoleName(role) + ".dds";
+}
+
+const char* TextureCooker::GetRoleName(TextureRole role)
+{
+	switch (role)
+	{
+	case ImageTypes::ROLE_ALBEDO: return "albedo";
+	case ImageTypes::ROLE_NORMAL: return "normal";
+	case ImageTypes::ROLE_MASK: return "mask";
+	case ImageTypes::ROLE_EMISSION: return "emission";
+	default: return "color";
+	}
+}
+
+std::string TextureCooker::FormatStats(const Stats& stats)
+{
+	double ratio = stats.cookedBytes > 0 ? (double)stats.sourceBytes / (double)stats.cookedBytes : 0.0;
+
+	return "Texture cook: " + std::to_string(stats.width) + "x" + std::to_string(stats.height) + " " + BlockCompressor::GetFormatName(stats.format) + ", " +
+		std::to_string(stats.levelCount) + " levels, " + std::to_string(stats.sourceBytes) + " -> " + std::to_string(stats.cookedBytes) + " bytes (" +
+		std::to_string(ratio) + ":1), RMSE " + std::to_string(stats.rmse) + ", " + std::to_string(stats.cookTimeMs) + " ms (mips " + std::to_string(stats.mipTimeMs) + " ms)";
+}
@@ -0,0 +1,65 @@
+#ifndef TEXTURE_COOKER_H
+#define TEXTURE_COOKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ImageTypes.h"
+#include "BlockCompressor.h"
+#include "MipGenerator.h"
+
+// Turns decoded RGBA8 images into the block compressed textures the engine
+// uploads, one format per role:
+//   albedo    BC7, or BC1 (BC3 with alpha) when highQualityAlbedo is off
+//   normal    BC5, X and Y, the shader rebuilds Z
+//   mask      BC4 of the red channel (roughness, metallic, AO)
+//   emission  BC1
+// The mip chain is built by MipGenerator before compression and stored with
+// the texture, so nothing is filtered when the texture is loaded. Albedo and
+// emission are filtered in linear space, albedo alpha keeps its coverage and
+// normals are renormalized. Levels are compressed in parallel. The result is
+// written as "<source>.<role>.dds", see DdsFile.
+class TextureCooker
+{
+public:
+	using PixelFormat = ImageTypes::PixelFormat;
+	using TextureRole = ImageTypes::TextureRole;
+	using Image = ImageTypes::Image;
+
+	struct Settings
+	{
+		bool highQualityAlbedo = true;
+		bool generateMips = true;
+		MipGenerator::Filter mipFilter = MipGenerator::FILTER_KAISER;
+		bool preserveAlphaCoverage = true;  // For albedo with alpha, at alphaReference
+		float alphaReference = 0.5f;
+		BlockCompressor::Settings compression;      // useSimd and parallel apply to the mips too
+	};
+
+	struct Stats
+	{
+		PixelFormat format = ImageTypes::FORMAT_UNKNOWN;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		size_t levelCount = 0;
+		size_t sourceBytes = 0;     // The same chain as RGBA8
+		size_t cookedBytes = 0;
+		double rmse = 0.0;          // Of the top level, over the channels the role keeps
+		double mipTimeMs = 0.0;
+		double cookTimeMs = 0.0;    // Including the mips
+	};
+
+public:
+	static PixelFormat ChooseFormat(TextureRole role, bool hasAlpha, const Settings& settings);
+	static MipGenerator::Settings GetMipSettings(TextureRole role, bool hasAlpha, const Settings& settings);
+
+	static bool Cook(const uint8_t* rgba, uint32_t width, uint32_t height, TextureRole role, const Settings& settings, Image& outImage, Stats* stats = nullptr);
+
+	static std::string GetCookedFilename(const std::string& sourceFilename, TextureRole role);
+	static const char* GetRoleName(TextureRole role);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // TEXTURE_COOKER_H
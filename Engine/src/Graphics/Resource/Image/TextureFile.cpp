@@ -0,0 +1,188 @@
+#include "TextureFile.h"
+#include "BlockCompressor.h"
+#include "DdsFile.h"
+#include "KtxFile.h"
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+	std::string GetExtension(const std::string& filename)
+	{
+		size_t dot = filename.find_last_of('.');
+		std::string extension = dot == std::string::npos ? std::string() : filename.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		return extension;
+	}
+}
+
+TextureFile::TextureFile()
+{
+	m_format = ImageTypes::FORMAT_UNKNOWN;
+	m_dxgiFormat = 0;
+	m_width = 0;
+	m_height = 0;
+	m_mipCount = 0;
+	m_layerCount = 0;
+	m_cubemap = false;
+	m_levelDataOffset = 0;
+	m_levelDataSize = 0;
+}
+
+TextureFile::~TextureFile()
+{
+	m_file.Close();
+}
+
+void TextureFile::Close()
+{
+	m_file.Close();
+	m_format = ImageTypes::FORMAT_UNKNOWN;
+	m_dxgiFormat = 0;
+	m_width = 0;
+	m_height = 0;
+	m_mipCount = 0;
+	m_layerCount = 0;
+	m_cubemap = false;
+	m_levels.clear();
+	m_levelDataOffset = 0;
+	m_levelDataSize = 0;
+}
+
+std::unique_ptr<TextureFile> TextureFile::OpenContainer(const std::string& filename)
+{
+	std::string extension = GetExtension(filename);
+	std::unique_ptr<TextureFile> file;
+	if (extension == "dds")
+	{
+		file.reset(new DdsFile());
+	}
+	else if (extension == "ktx2")
+	{
+		file.reset(new KtxFile());
+	}
+
+	if (!file || !file->Open(filename))
+	{
+		return nullptr;
+	}
+	return file;
+}
+
+bool TextureFile::IsContainer(const std::string& filename)
+{
+	std::string extension = GetExtension(filename);
+	return extension == "dds" || extension == "ktx2";
+}
+
+uint32_t TextureFile::GetDxgiFormat(PixelFormat format)
+{
+	switch (format)
+	{
+	case ImageTypes::FORMAT_RGBA8: return 28;    // DXGI_FORMAT_R8G8B8A8_UNORM
+	case ImageTypes::FORMAT_BC1: return 71;      // DXGI_FORMAT_BC1_UNORM
+	case ImageTypes::FORMAT_BC3: return 77;      // DXGI_FORMAT_BC3_UNORM
+	case ImageTypes::FORMAT_BC4: return 80;      // DXGI_FORMAT_BC4_UNORM
+	case ImageTypes::FORMAT_BC5: return 83;      // DXGI_FORMAT_BC5_UNORM
+	case ImageTypes::FORMAT_BC7: return 98;      // DXGI_FORMAT_BC7_UNORM
+	case ImageTypes::FORMAT_BGRA8: return 87;    // DXGI_FORMAT_B8G8R8A8_UNORM
+	case ImageTypes::FORMAT_BC2: return 74;      // DXGI_FORMAT_BC2_UNORM
+	case ImageTypes::FORMAT_BC6H: return 95;     // DXGI_FORMAT_BC6H_UF16
+	default: return 0;
+	}
+}
+
+TextureFile::PixelFormat TextureFile::GetPixelFormat(uint32_t dxgiFormat)
+{
+	switch (dxgiFormat)
+	{
+	case 29: return ImageTypes::FORMAT_RGBA8;    // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+	case 72: return ImageTypes::FORMAT_BC1;      // DXGI_FORMAT_BC1_UNORM_SRGB
+	case 75: return ImageTypes::FORMAT_BC2;      // DXGI_FORMAT_BC2_UNORM_SRGB
+	case 78: return ImageTypes::FORMAT_BC3;      // DXGI_FORMAT_BC3_UNORM_SRGB
+	case 91: return ImageTypes::FORMAT_BGRA8;    // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+	case 96: return ImageTypes::FORMAT_BC6H;     // DXGI_FORMAT_BC6H_SF16, same block size
+	case 99: return ImageTypes::FORMAT_BC7;      // DXGI_FORMAT_BC7_UNORM_SRGB
+	default: break;
+	}
+
+	for (uint32_t format = ImageTypes::FORMAT_RGBA8; format < ImageTypes::FORMAT_COUNT; format++)
+	{
+		if (GetDxgiFormat((PixelFormat)format) == dxgiFormat)
+		{
+			return (PixelFormat)format;
+		}
+	}
+	return ImageTypes::FORMAT_UNKNOWN;
+}
+
+bool TextureFile::IsSrgb(uint32_t dxgiFormat)
+{
+	return dxgiFormat == 29 || dxgiFormat == 72 || dxgiFormat == 75 || dxgiFormat == 78 || dxgiFormat == 91 || dxgiFormat == 99;
+}
+
+bool TextureFile::Map(const std::string& filename)
+{
+	Close();
+	return m_file.Open(filename);
+}
+
+bool TextureFile::SetLayout(uint32_t dxgiFormat, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t layerCount, bool cubemap)
+{
+	uint32_t fullChain = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+	{
+		fullChain++;
+	}
+
+	m_format = GetPixelFormat(dxgiFormat);
+	if (m_format == ImageTypes::FORMAT_UNKNOWN || width == 0 || height == 0 || mipCount == 0 || mipCount > fullChain ||
+		layerCount == 0 || (cubemap && layerCount % 6 != 0))
+	{
+		return false;
+	}
+
+	m_dxgiFormat = dxgiFormat;
+	m_width = width;
+	m_height = height;
+	m_mipCount = mipCount;
+	m_layerCount = layerCount;
+	m_cubemap = cubemap;
+	m_levels.reserve((size_t)mipCount * layerCount);
+	return true;
+}
+
+void TextureFile::AddLevel(uint32_t mip, size_t offset)
+{
+	ImageLevel level;
+	level.width = std::max(m_width >> mip, 1u);
+	level.height = std::max(m_height >> mip, 1u);
+	level.rowPitch = BlockCompressor::GetRowPitch(m_format, level.width);
+	level.offset = offset;
+	level.size = BlockCompressor::GetLevelSize(m_format, level.width, level.height);
+	m_levels.push_back(level);
+}
+
+bool TextureFile::FinishLayout()
+{
+	if (m_levels.size() != (size_t)m_mipCount * m_layerCount)
+	{
+		return false;
+	}
+
+	size_t begin = m_file.GetSize();
+	size_t end = 0;
+	for (const ImageLevel& level : m_levels)
+	{
+		if (level.offset > m_file.GetSize() || level.size > m_file.GetSize() - level.offset)
+		{
+			return false;
+		}
+		begin = std::min(begin, level.offset);
+		end = std::max(end, level.offset + level.size);
+	}
+
+	m_levelDataOffset = begin;
+	m_levelDataSize = end - begin;
+	return true;
+}
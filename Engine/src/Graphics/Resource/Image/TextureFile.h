@@ -0,0 +1,91 @@
+#ifndef TEXTURE_FILE_H
+#define TEXTURE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ImageTypes.h"
+#include "../../../Core/System/MappedFile.h"
+
+// A memory-mapped texture container that already holds every subresource
+// in the layout the device takes, so loading is parsing the headers and
+// pointing the subresources into the view: no decode, no copy. DdsFile and
+// KtxFile read the two containers; both describe the file the same way.
+// - Levels are listed layer by layer, each layer largest first, which is
+//   the D3D subresource order (layer * mip count + mip). Cubemaps have six
+//   layers per cube, in +X, -X, +Y, -Y, +Z, -Z order.
+// - Level offsets are from GetData(), the start of the mapping. Every level
+//   is checked to lie within the file when it is opened.
+// - The DXGI format is kept as stored, sRGB included; GetFormat() is the
+//   layout the image code understands.
+class TextureFile
+{
+public:
+	using PixelFormat = ImageTypes::PixelFormat;
+	using ImageLevel = ImageTypes::ImageLevel;
+
+public:
+	TextureFile();
+	virtual ~TextureFile();
+
+	TextureFile(const TextureFile&) = delete;
+	TextureFile& operator=(const TextureFile&) = delete;
+
+	// Maps the file and validates the headers and level sizes.
+	virtual bool Open(const std::string& filename) = 0;
+	virtual void Close();
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	PixelFormat GetFormat() const { return m_format; }
+	uint32_t GetDxgiFormat() const { return m_dxgiFormat; }
+	uint32_t GetWidth() const { return m_width; }
+	uint32_t GetHeight() const { return m_height; }
+	uint32_t GetMipCount() const { return m_mipCount; }
+	uint32_t GetLayerCount() const { return m_layerCount; }
+	bool IsCubemap() const { return m_cubemap; }
+	const std::vector<ImageLevel>& GetLevels() const { return m_levels; }
+	const ImageLevel& GetLevel(uint32_t layer, uint32_t mip) const { return m_levels[layer * m_mipCount + mip]; }
+	// Level offsets are relative to this pointer, which points into the mapping.
+	const uint8_t* GetData() const { return m_file.GetData(); }
+	size_t GetDataSize() const { return m_file.GetSize(); }
+	// The part of the file the levels cover, without the headers.
+	const uint8_t* GetLevelData() const { return m_file.GetData() + m_levelDataOffset; }
+	size_t GetLevelDataSize() const { return m_levelDataSize; }
+
+	// Opens a ".dds" or ".ktx2" file with the matching reader, null if the
+	// extension is neither or the file cannot be read.
+	static std::unique_ptr<TextureFile> OpenContainer(const std::string& filename);
+	static bool IsContainer(const std::string& filename);
+
+	// DXGI_FORMAT values, without including D3D. GetPixelFormat also takes the
+	// sRGB variants; GetDxgiFormat gives the UNORM one.
+	static uint32_t GetDxgiFormat(PixelFormat format);
+	static PixelFormat GetPixelFormat(uint32_t dxgiFormat);
+	static bool IsSrgb(uint32_t dxgiFormat);
+
+protected:
+	bool Map(const std::string& filename);
+	// Sets the description; the levels are then added with AddLevel in subresource order.
+	bool SetLayout(uint32_t dxgiFormat, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t layerCount, bool cubemap);
+	void AddLevel(uint32_t mip, size_t offset);
+	// Checks every level lies within the mapping and records the part they cover.
+	bool FinishLayout();
+
+protected:
+	MappedFile m_file;
+	PixelFormat m_format;
+	uint32_t m_dxgiFormat;
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_mipCount;
+	uint32_t m_layerCount;
+	bool m_cubemap;
+	std::vector<ImageLevel> m_levels;
+	size_t m_levelDataOffset;
+	size_t m_levelDataSize;
+};
+
+#endif // TEXTURE_FILE_H
@@ -0,0 +1,646 @@
+#include "BoundsCalculator.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <emmintrin.h>
+
+namespace
+{
+	using MeshVertex = MeshTypes::MeshVertex;
+	using MeshBounds = MeshTypes::MeshBounds;
+
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	inline Vector3 Add(const Vector3& a, const Vector3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Vector3 Sub(const Vector3& a, const Vector3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Vector3 Scale(const Vector3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+	inline float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline Vector3 Cross(const Vector3& a, const Vector3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline float LengthSq(const Vector3& a) { return Dot(a, a); }
+
+	inline Vector3 Normalize(const Vector3& a)
+	{
+		float length = std::sqrt(LengthSq(a));
+		return length > 0.0f ? Scale(a, 1.0f / length) : Vector3{ 1.0f, 0.0f, 0.0f };
+	}
+
+	// Any unit vector perpendicular to the unit vector a.
+	Vector3 Perpendicular(const Vector3& a)
+	{
+		Vector3 axis = std::fabs(a.x) < 0.577f ? Vector3{ 1.0f, 0.0f, 0.0f } : Vector3{ 0.0f, 1.0f, 0.0f };
+		return Normalize(Cross(a, axis));
+	}
+
+	// DiTO-14 directions: x, y, z (which also give the AABB) and the four cube
+	// diagonals x+y+z, x+y-z, x-y+z, x-y-z.
+	const int DIRECTION_COUNT = 7;
+
+	// Positions as structure of arrays, padded to a multiple of four with
+	// copies of the first vertex.
+	struct PackedPositions
+	{
+		std::vector<float> x, y, z;
+		size_t count = 0;
+
+		Vector3 Get(size_t i) const { return { x[i], y[i], z[i] }; }
+	};
+
+	struct FirstPassResult
+	{
+		uint32_t minIndex[DIRECTION_COUNT];
+		uint32_t maxIndex[DIRECTION_COUNT];
+		float minProjection[DIRECTION_COUNT];
+		float maxProjection[DIRECTION_COUNT];
+		double moments[9];   // x, y, z, xx, yy, zz, xy, xz, yz relative to the first vertex
+	};
+
+	inline __m128i Select(__m128 mask, __m128i a, __m128i b)
+	{
+		__m128i m = _mm_castps_si128(mask);
+		return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+	}
+
+	// The only pass over the vertex data itself: packs the positions and
+	// gathers the extreme points and the moments.
+	void FirstPass(const MeshVertex* vertices, size_t vertexCount, PackedPositions& packed, FirstPassResult& result)
+	{
+		size_t paddedCount = (vertexCount + 3) & ~(size_t)3;
+		packed.count = vertexCount;
+		packed.x.resize(paddedCount);
+		packed.y.resize(paddedCount);
+		packed.z.resize(paddedCount);
+
+		const Vector3 origin = { vertices[0].x, vertices[0].y, vertices[0].z };
+
+		__m128 minProjection[DIRECTION_COUNT], maxProjection[DIRECTION_COUNT];
+		__m128i minIndex[DIRECTION_COUNT], maxIndex[DIRECTION_COUNT];
+		for (int d = 0; d < DIRECTION_COUNT; d++)
+		{
+			minProjection[d] = _mm_set1_ps(FLT_MAX);
+			maxProjection[d] = _mm_set1_ps(-FLT_MAX);
+			minIndex[d] = _mm_setzero_si128();
+			maxIndex[d] = _mm_setzero_si128();
+		}
+
+		// Float sums over short blocks, flushed into doubles so large meshes keep their precision.
+		double moments[9] = {};
+		__m128 blockMoments[9];
+		const size_t BLOCK_GROUPS = 256;
+
+		__m128i index = _mm_set_epi32(3, 2, 1, 0);
+		const __m128i four = _mm_set1_epi32(4);
+		const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+
+		for (size_t block = 0; block < paddedCount; block += BLOCK_GROUPS * 4)
+		{
+			for (int m = 0; m < 9; m++)
+			{
+				blockMoments[m] = _mm_setzero_ps();
+			}
+
+			size_t blockEnd = std::min(paddedCount, block + BLOCK_GROUPS * 4);
+			for (size_t i = block; i < blockEnd; i += 4)
+			{
+				for (size_t lane = 0; lane < 4; lane++)
+				{
+					const MeshVertex& vertex = vertices[i + lane < vertexCount ? i + lane : 0];
+					packed.x[i + lane] = vertex.x;
+					packed.y[i + lane] = vertex.y;
+					packed.z[i + lane] = vertex.z;
+				}
+
+				__m128 x = _mm_loadu_ps(&packed.x[i]);
+				__m128 y = _mm_loadu_ps(&packed.y[i]);
+				__m128 z = _mm_loadu_ps(&packed.z[i]);
+
+				__m128 projections[DIRECTION_COUNT] =
+				{
+					x, y, z,
+					_mm_add_ps(_mm_add_ps(x, y), z),
+					_mm_sub_ps(_mm_add_ps(x, y), z),
+					_mm_add_ps(_mm_sub_ps(x, y), z),
+					_mm_sub_ps(_mm_sub_ps(x, y), z)
+				};
+
+				for (int d = 0; d < DIRECTION_COUNT; d++)
+				{
+					__m128 below = _mm_cmplt_ps(projections[d], minProjection[d]);
+					__m128 above = _mm_cmpgt_ps(projections[d], maxProjection[d]);
+					minProjection[d] = _mm_min_ps(projections[d], minProjection[d]);
+					maxProjection[d] = _mm_max_ps(projections[d], maxProjection[d]);
+					minIndex[d] = Select(below, index, minIndex[d]);
+					maxIndex[d] = Select(above, index, maxIndex[d]);
+				}
+
+				// Padding lanes are copies of the origin and add nothing.
+				__m128 rx = _mm_sub_ps(x, ox), ry = _mm_sub_ps(y, oy), rz = _mm_sub_ps(z, oz);
+				blockMoments[0] = _mm_add_ps(blockMoments[0], rx);
+				blockMoments[1] = _mm_add_ps(blockMoments[1], ry);
+				blockMoments[2] = _mm_add_ps(blockMoments[2], rz);
+				blockMoments[3] = _mm_add_ps(blockMoments[3], _mm_mul_ps(rx, rx));
+				blockMoments[4] = _mm_add_ps(blockMoments[4], _mm_mul_ps(ry, ry));
+				blockMoments[5] = _mm_add_ps(blockMoments[5], _mm_mul_ps(rz, rz));
+				blockMoments[6] = _mm_add_ps(blockMoments[6], _mm_mul_ps(rx, ry));
+				blockMoments[7] = _mm_add_ps(blockMoments[7], _mm_mul_ps(rx, rz));
+				blockMoments[8] = _mm_add_ps(blockMoments[8], _mm_mul_ps(ry, rz));
+
+				index = _mm_add_epi32(index, four);
+			}
+
+			for (int m = 0; m < 9; m++)
+			{
+				alignas(16) float lanes[4];
+				_mm_store_ps(lanes, blockMoments[m]);
+				moments[m] += (double)lanes[0] + (double)lanes[1] + (double)lanes[2] + (double)lanes[3];
+			}
+		}
+
+		for (int d = 0; d < DIRECTION_COUNT; d++)
+		{
+			alignas(16) float minLanes[4], maxLanes[4];
+			alignas(16) uint32_t minLaneIndex[4], maxLaneIndex[4];
+			_mm_store_ps(minLanes, minProjection[d]);
+			_mm_store_ps(maxLanes, maxProjection[d]);
+			_mm_store_si128((__m128i*)minLaneIndex, minIndex[d]);
+			_mm_store_si128((__m128i*)maxLaneIndex, maxIndex[d]);
+
+			result.minProjection[d] = minLanes[0];
+			result.maxProjection[d] = maxLanes[0];
+			result.minIndex[d] = minLaneIndex[0];
+			result.maxIndex[d] = maxLaneIndex[0];
+			for (int lane = 1; lane < 4; lane++)
+			{
+				if (minLanes[lane] < result.minProjection[d])
+				{
+					result.minProjection[d] = minLanes[lane];
+					result.minIndex[d] = minLaneIndex[lane];
+				}
+				if (maxLanes[lane] > result.maxProjection[d])
+				{
+					result.maxProjection[d] = maxLanes[lane];
+					result.maxIndex[d] = maxLaneIndex[lane];
+				}
+			}
+
+			// Padding lanes repeat vertex 0.
+			if (result.minIndex[d] >= vertexCount)
+			{
+				result.minIndex[d] = 0;
+			}
+			if (result.maxIndex[d] >= vertexCount)
+			{
+				result.maxIndex[d] = 0;
+			}
+		}
+
+		std::copy(moments, moments + 9, result.moments);
+	}
+
+	// Index and squared distance of the point farthest from center.
+	void FarthestPoint(const PackedPositions& packed, const Vector3& center, size_t& farthestIndex, float& farthestDistSq)
+	{
+		const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+		__m128 best = _mm_set1_ps(-1.0f);
+		__m128i bestIndex = _mm_setzero_si128();
+		__m128i index = _mm_set_epi32(3, 2, 1, 0);
+		const __m128i four = _mm_set1_epi32(4);
+
+		for (size_t i = 0; i < packed.x.size(); i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(&packed.x[i]), cx);
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(&packed.y[i]), cy);
+			__m128 dz = _mm_sub_ps(_mm_loadu_ps(&packed.z[i]), cz);
+			__m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+			__m128 farther = _mm_cmpgt_ps(distSq, best);
+			best = _mm_max_ps(distSq, best);
+			bestIndex = Select(farther, index, bestIndex);
+			index = _mm_add_epi32(index, four);
+		}
+
+		alignas(16) float lanes[4];
+		alignas(16) uint32_t laneIndex[4];
+		_mm_store_ps(lanes, best);
+		_mm_store_si128((__m128i*)laneIndex, bestIndex);
+
+		farthestDistSq = lanes[0];
+		farthestIndex = laneIndex[0];
+		for (int lane = 1; lane < 4; lane++)
+		{
+			if (lanes[lane] > farthestDistSq)
+			{
+				farthestDistSq = lanes[lane];
+				farthestIndex = laneIndex[lane];
+			}
+		}
+		if (farthestIndex >= packed.count)
+		{
+			farthestIndex = 0;
+		}
+	}
+
+	// Ritter's second pass: grows the sphere around every point outside it.
+	// Four points are tested at once, the rare grow steps run per point.
+	void GrowSphere(const PackedPositions& packed, Vector3& center, float& radius)
+	{
+		for (size_t i = 0; i < packed.x.size(); i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(&packed.x[i]), _mm_set1_ps(center.x));
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(&packed.y[i]), _mm_set1_ps(center.y));
+			__m128 dz = _mm_sub_ps(_mm_loadu_ps(&packed.z[i]), _mm_set1_ps(center.z));
+			__m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			if (_mm_movemask_ps(_mm_cmpgt_ps(distSq, _mm_set1_ps(radius * radius))) == 0)
+			{
+				continue;
+			}
+
+			for (size_t lane = 0; lane < 4; lane++)
+			{
+				Vector3 toPoint = Sub(packed.Get(i + lane), center);
+				float distance = std::sqrt(LengthSq(toPoint));
+				if (distance > radius)
+				{
+					float newRadius = (radius + distance) * 0.5f;
+					center = Add(center, Scale(toPoint, (newRadius - radius) / distance));
+					radius = newRadius;
+				}
+			}
+		}
+	}
+
+	// Exact extents of the points along up to six axes.
+	void ProjectExtents(const PackedPositions& packed, const Vector3* axes, int axisCount, float* minimum, float* maximum)
+	{
+		__m128 lowest[6], highest[6];
+		for (int a = 0; a < axisCount; a++)
+		{
+			lowest[a] = _mm_set1_ps(FLT_MAX);
+			highest[a] = _mm_set1_ps(-FLT_MAX);
+		}
+
+		for (size_t i = 0; i < packed.x.size(); i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&packed.x[i]);
+			__m128 y = _mm_loadu_ps(&packed.y[i]);
+			__m128 z = _mm_loadu_ps(&packed.z[i]);
+			for (int a = 0; a < axisCount; a++)
+			{
+				__m128 projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(axes[a].x)), _mm_mul_ps(y, _mm_set1_ps(axes[a].y))),
+											   _mm_mul_ps(z, _mm_set1_ps(axes[a].z)));
+				lowest[a] = _mm_min_ps(lowest[a], projection);
+				highest[a] = _mm_max_ps(highest[a], projection);
+			}
+		}
+
+		for (int a = 0; a < axisCount; a++)
+		{
+			alignas(16) float low[4], high[4];
+			_mm_store_ps(low, lowest[a]);
+			_mm_store_ps(high, highest[a]);
+			minimum[a] = std::min(std::min(low[0], low[1]), std::min(low[2], low[3]));
+			maximum[a] = std::max(std::max(high[0], high[1]), std::max(high[2], high[3]));
+		}
+	}
+
+	// Eigenvectors of a symmetric 3x3 matrix (cyclic Jacobi), as rows.
+	void SymmetricEigenvectors(double matrix[3][3], Vector3 eigenvectors[3])
+	{
+		double v[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+
+		for (int sweep = 0; sweep < 32; sweep++)
+		{
+			double offDiagonal = std::fabs(matrix[0][1]) + std::fabs(matrix[0][2]) + std::fabs(matrix[1][2]);
+			if (offDiagonal < 1.0e-30)
+			{
+				break;
+			}
+
+			for (int p = 0; p < 2; p++)
+			{
+				for (int q = p + 1; q < 3; q++)
+				{
+					if (std::fabs(matrix[p][q]) < 1.0e-30)
+					{
+						continue;
+					}
+
+					double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+					double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+					double c = 1.0 / std::sqrt(t * t + 1.0);
+					double s = t * c;
+
+					for (int k = 0; k < 3; k++)
+					{
+						double kp = matrix[k][p], kq = matrix[k][q];
+						matrix[k][p] = c * kp - s * kq;
+						matrix[k][q] = s * kp + c * kq;
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						double pk = matrix[p][k], qk = matrix[q][k];
+						matrix[p][k] = c * pk - s * qk;
+						matrix[q][k] = s * pk + c * qk;
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						double kp = v[k][p], kq = v[k][q];
+						v[k][p] = c * kp - s * kq;
+						v[k][q] = s * kp + c * kq;
+					}
+				}
+			}
+		}
+
+		for (int e = 0; e < 3; e++)
+		{
+			eigenvectors[e] = { (float)v[0][e], (float)v[1][e], (float)v[2][e] };
+		}
+	}
+
+	// Orthonormal, right handed frame from a first axis and a hint for the second.
+	void MakeFrame(const Vector3& first, const Vector3& secondHint, Vector3 frame[3])
+	{
+		frame[0] = Normalize(first);
+		Vector3 second = Sub(secondHint, Scale(frame[0], Dot(secondHint, frame[0])));
+		frame[1] = LengthSq(second) > 1.0e-12f ? Normalize(second) : Perpendicular(frame[0]);
+		frame[2] = Cross(frame[0], frame[1]);
+	}
+
+	float HalfSurfaceArea(const float size[3])
+	{
+		return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+	}
+}
+
+bool BoundsCalculator::Compute(const MeshVertex* vertices, size_t vertexCount, MeshBounds& bounds, const Settings& settings, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	bounds = {};
+	if (!vertices || vertexCount == 0)
+	{
+		if (stats)
+		{
+			*stats = Stats();
+		}
+		return false;
+	}
+
+	PackedPositions packed;
+	FirstPassResult first;
+	FirstPass(vertices, vertexCount, packed, first);
+
+	// AABB from the axis directions.
+	for (int k = 0; k < 3; k++)
+	{
+		bounds.min[k] = first.minProjection[k];
+		bounds.max[k] = first.maxProjection[k];
+	}
+
+	// Extreme points; the most distant pair seeds both the sphere and the box.
+	Vector3 extremes[DIRECTION_COUNT * 2];
+	int seedDirection = 0;
+	float seedDistSq = -1.0f;
+	for (int d = 0; d < DIRECTION_COUNT; d++)
+	{
+		extremes[d * 2] = packed.Get(first.minIndex[d]);
+		extremes[d * 2 + 1] = packed.Get(first.maxIndex[d]);
+		float distSq = LengthSq(Sub(extremes[d * 2 + 1], extremes[d * 2]));
+		if (distSq > seedDistSq)
+		{
+			seedDistSq = distSq;
+			seedDirection = d;
+		}
+	}
+	Vector3 p0 = extremes[seedDirection * 2];
+	Vector3 p1 = extremes[seedDirection * 2 + 1];
+
+	// Sphere: Ritter, then refinement. Every candidate center gets its exact radius.
+	size_t farthestIndex;
+	float farthestDistSq;
+
+	Vector3 aabbCenter = { (bounds.min[0] + bounds.max[0]) * 0.5f, (bounds.min[1] + bounds.max[1]) * 0.5f, (bounds.min[2] + bounds.max[2]) * 0.5f };
+	FarthestPoint(packed, aabbCenter, farthestIndex, farthestDistSq);
+	float aabbCenterRadius = std::sqrt(farthestDistSq);
+
+	Vector3 center = Scale(Add(p0, p1), 0.5f);
+	float radius = std::sqrt(seedDistSq) * 0.5f;
+	GrowSphere(packed, center, radius);
+
+	Vector3 bestCenter = aabbCenter;
+	float bestRadius = aabbCenterRadius;
+
+	// Badoiu-Clarkson steps towards the farthest point, shrinking as they go.
+	for (int i = 0; i <= settings.sphereIterations; i++)
+	{
+		FarthestPoint(packed, center, farthestIndex, farthestDistSq);
+		float exactRadius = std::sqrt(farthestDistSq);
+		if (exactRadius < bestRadius)
+		{
+			bestRadius = exactRadius;
+			bestCenter = center;
+		}
+
+		Vector3 toFarthest = Sub(packed.Get(farthestIndex), center);
+		center = Add(center, Scale(toFarthest, 1.0f / (float)(i + 4)));
+	}
+
+	// The exact radius can round below a point's distance in the last bit.
+	bounds.center[0] = bestCenter.x;
+	bounds.center[1] = bestCenter.y;
+	bounds.center[2] = bestCenter.z;
+	bounds.radius = bestRadius * (1.0f + 1.0e-6f);
+
+	// Oriented box candidates: the DiTO base triangle edges and the PCA axes.
+	Vector3 candidates[6];
+	const char* candidateSources[2];
+	int candidateCount = 0;
+
+	Vector3 e0 = Sub(p1, p0);
+	if (LengthSq(e0) > 0.0f)
+	{
+		// Third point of the base triangle: the extreme point farthest from the p0-p1 line.
+		Vector3 direction = Normalize(e0);
+		Vector3 p2 = p0;
+		float bestLineDistSq = 0.0f;
+		for (const Vector3& point : extremes)
+		{
+			Vector3 offset = Sub(point, p0);
+			float lineDistSq = LengthSq(Sub(offset, Scale(direction, Dot(offset, direction))));
+			if (lineDistSq > bestLineDistSq)
+			{
+				bestLineDistSq = lineDistSq;
+				p2 = point;
+			}
+		}
+
+		Vector3 normal = bestLineDistSq > 1.0e-12f * LengthSq(e0) ? Normalize(Cross(e0, Sub(p2, p0))) : Perpendicular(direction);
+
+		// Each triangle edge gives a frame; the extreme points rate them by surface area.
+		Vector3 edges[3] = { e0, Sub(p2, p1), Sub(p0, p2) };
+		float bestArea = FLT_MAX;
+		for (const Vector3& edge : edges)
+		{
+			if (LengthSq(edge) <= 0.0f)
+			{
+				continue;
+			}
+
+			Vector3 frame[3];
+			MakeFrame(edge, Cross(normal, edge), frame);
+
+			float size[3];
+			for (int a = 0; a < 3; a++)
+			{
+				float low = FLT_MAX, high = -FLT_MAX;
+				for (const Vector3& point : extremes)
+				{
+					float projection = Dot(point, frame[a]);
+					low = std::min(low, projection);
+					high = std::max(high, projection);
+				}
+				size[a] = high - low;
+			}
+
+			float area = HalfSurfaceArea(size);
+			if (area < bestArea)
+			{
+				bestArea = area;
+				std::copy(frame, frame + 3, candidates);
+			}
+		}
+		if (bestArea < FLT_MAX)
+		{
+			candidateSources[0] = "DiTO";
+			candidateCount = 3;
+		}
+	}
+
+	if (settings.usePCA && vertexCount > 2)
+	{
+		double n = (double)vertexCount;
+		double mean[3] = { first.moments[0] / n, first.moments[1] / n, first.moments[2] / n };
+		double covariance[3][3];
+		covariance[0][0] = first.moments[3] / n - mean[0] * mean[0];
+		covariance[1][1] = first.moments[4] / n - mean[1] * mean[1];
+		covariance[2][2] = first.moments[5] / n - mean[2] * mean[2];
+		covariance[0][1] = covariance[1][0] = first.moments[6] / n - mean[0] * mean[1];
+		covariance[0][2] = covariance[2][0] = first.moments[7] / n - mean[0] * mean[2];
+		covariance[1][2] = covariance[2][1] = first.moments[8] / n - mean[1] * mean[2];
+
+		Vector3 eigenvectors[3];
+		SymmetricEigenvectors(covariance, eigenvectors);
+		MakeFrame(eigenvectors[0], eigenvectors[1], &candidates[candidateCount]);
+		candidateSources[candidateCount / 3] = "PCA";
+		candidateCount += 3;
+	}
+
+	float minimum[6], maximum[6];
+	ProjectExtents(packed, candidates, candidateCount, minimum, maximum);
+
+	// The AABB is the fallback candidate; smallest volume wins, then smallest area (flat meshes).
+	float aabbSize[3] = { bounds.max[0] - bounds.min[0], bounds.max[1] - bounds.min[1], bounds.max[2] - bounds.min[2] };
+	float aabbVolume = aabbSize[0] * aabbSize[1] * aabbSize[2];
+
+	Vector3 boxAxes[3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+	float boxMin[3] = { bounds.min[0], bounds.min[1], bounds.min[2] };
+	float boxMax[3] = { bounds.max[0], bounds.max[1], bounds.max[2] };
+	float boxVolume = aabbVolume;
+	float boxArea = HalfSurfaceArea(aabbSize);
+	const char* boxSource = "AABB";
+
+	for (int c = 0; c < candidateCount; c += 3)
+	{
+		float size[3] = { maximum[c] - minimum[c], maximum[c + 1] - minimum[c + 1], maximum[c + 2] - minimum[c + 2] };
+		float volume = size[0] * size[1] * size[2];
+		float area = HalfSurfaceArea(size);
+		if (volume < boxVolume * 0.999f || (volume <= boxVolume && area < boxArea * 0.999f))
+		{
+			boxVolume = volume;
+			boxArea = area;
+			for (int a = 0; a < 3; a++)
+			{
+				boxAxes[a] = candidates[c + a];
+				boxMin[a] = minimum[c + a];
+				boxMax[a] = maximum[c + a];
+			}
+			boxSource = candidateSources[c / 3];
+		}
+	}
+
+	Vector3 boxCenter = { 0.0f, 0.0f, 0.0f };
+	for (int a = 0; a < 3; a++)
+	{
+		boxCenter = Add(boxCenter, Scale(boxAxes[a], (boxMin[a] + boxMax[a]) * 0.5f));
+		bounds.boxAxes[a][0] = boxAxes[a].x;
+		bounds.boxAxes[a][1] = boxAxes[a].y;
+		bounds.boxAxes[a][2] = boxAxes[a].z;
+		bounds.boxExtents[a] = (boxMax[a] - boxMin[a]) * 0.5f;
+	}
+	bounds.boxCenter[0] = boxCenter.x;
+	bounds.boxCenter[1] = boxCenter.y;
+	bounds.boxCenter[2] = boxCenter.z;
+
+	if (stats)
+	{
+		stats->vertexCount = vertexCount;
+		stats->aabbCenterRadius = aabbCenterRadius;
+		stats->sphereRadius = bounds.radius;
+		stats->aabbVolume = aabbVolume;
+		stats->boxVolume = boxVolume;
+		stats->boxSource = boxSource;
+		stats->computeTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+
+	return true;
+}
+
+bool BoundsCalculator::Contains(const MeshBounds& bounds, float x, float y, float z, float tolerance)
+{
+	Vector3 point = { x, y, z };
+
+	for (int k = 0; k < 3; k++)
+	{
+		float value = k == 0 ? x : (k == 1 ? y : z);
+		if (value < bounds.min[k] - tolerance || value > bounds.max[k] + tolerance)
+		{
+			return false;
+		}
+	}
+
+	Vector3 toCenter = Sub(point, Vector3{ bounds.center[0], bounds.center[1], bounds.center[2] });
+	if (std::sqrt(LengthSq(toCenter)) > bounds.radius + tolerance)
+	{
+		return false;
+	}
+
+	Vector3 toBoxCenter = Sub(point, Vector3{ bounds.boxCenter[0], bounds.boxCenter[1], bounds.boxCenter[2] });
+	for (int a = 0; a < 3; a++)
+	{
+		Vector3 axis = { bounds.boxAxes[a][0], bounds.boxAxes[a][1], bounds.boxAxes[a][2] };
+		if (std::fabs(Dot(toBoxCenter, axis)) > bounds.boxExtents[a] + tolerance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::string BoundsCalculator::FormatStats(const Stats& stats)
+{
+	float radiusRatio = stats.aabbCenterRadius > 0.0f ? stats.sphereRadius / stats.aabbCenterRadius : 1.0f;
+	float volumeRatio = stats.aabbVolume > 0.0f ? stats.boxVolume / stats.aabbVolume : 1.0f;
+
+	return "Bounds: " + std::to_string(stats.vertexCount) + " vertices, sphere radius " + std::to_string(stats.sphereRadius) +
+		" (" + std::to_string((int)(radiusRatio * 100.0f + 0.5f)) + "% of the AABB center sphere), " +
+		std::string(stats.boxSource) + " box volume " + std::to_string(stats.boxVolume) +
+		" (" + std::to_string((int)(volumeRatio * 100.0f + 0.5f)) + "% of the AABB), " +
+		std::to_string(stats.computeTimeMs) + " ms";
+}
@@ -0,0 +1,53 @@
+#ifndef BOUNDS_CALCULATOR_H
+#define BOUNDS_CALCULATOR_H
+
+#include <cstddef>
+#include <string>
+
+#include "MeshTypes.h"
+
+// Tight bounding volumes for culling, computed at import time.
+// - One SSE pass over the vertices gathers the AABB, the extreme points along
+//   seven fixed directions (DiTO-14) and the covariance, and leaves a packed
+//   copy of the positions that the remaining passes stream instead.
+// - Sphere: Ritter's sphere seeded from the most distant extreme pair, then
+//   refined by moving the center towards the farthest point (Badoiu-Clarkson).
+//   The AABB center sphere is a candidate too, so it is never looser than that.
+// - Oriented box: the best DiTO base-triangle frame and the PCA frame get
+//   exact extents; the smallest of those and the AABB wins.
+class BoundsCalculator
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using MeshBounds = MeshTypes::MeshBounds;
+
+	struct Settings
+	{
+		int sphereIterations = 32;   // Center refinement passes
+		bool usePCA = true;          // Also try the covariance axes for the box
+	};
+
+	struct Stats
+	{
+		size_t vertexCount = 0;
+		float aabbCenterRadius = 0.0f;   // Radius around the AABB center, the old culling sphere
+		float sphereRadius = 0.0f;
+		float aabbVolume = 0.0f;
+		float boxVolume = 0.0f;
+		const char* boxSource = "";      // "DiTO", "PCA" or "AABB"
+		double computeTimeMs = 0.0;
+	};
+
+public:
+	// Computes every volume for the vertices. Returns false (and zeroed
+	// bounds) if there are none.
+	static bool Compute(const MeshVertex* vertices, size_t vertexCount, MeshBounds& bounds,
+						const Settings& settings, Stats* stats = nullptr);
+
+	// True if the point lies inside the sphere and both boxes, within tolerance.
+	static bool Contains(const MeshBounds& bounds, float x, float y, float z, float tolerance);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // BOUNDS_CALCULATOR_H
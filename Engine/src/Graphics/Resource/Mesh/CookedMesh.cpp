@@ -0,0 +1,470 @@
+#include "CookedMesh.h"
+#include "../../../Core/System/Hash.h"
+#include "../../../Core/System/Logger.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	const uint64_t SECTION_ALIGNMENT = 16;
+
+	// Fixed part of every material in the materials section. The texture path
+	// strings follow it back to back, lengths in pathLengths.
+	struct MaterialHeader
+	{
+		float diffuseColor[4];
+		float ambientColor[4];
+		float specularColor[4];
+		float shininess;
+		float metallic;
+		float roughness;
+		float ao;
+		float emissionStrength;
+		uint32_t pathLengths[CookedMesh::TEXTURE_PATH_COUNT];
+	};
+
+	struct PendingSection
+	{
+		CookedMesh::SectionEntry entry;
+		const void* data;
+	};
+
+	inline uint64_t AlignUp(uint64_t value)
+	{
+		return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+	}
+}
+
+CookedMesh::CookedMesh()
+{
+	m_header = nullptr;
+	m_sections = nullptr;
+	m_vertices = nullptr;
+	m_vertexCount = 0;
+	m_indices = nullptr;
+	m_indexCount = 0;
+	m_submeshes = nullptr;
+	m_submeshCount = 0;
+	m_lods = nullptr;
+	m_lodCount = 0;
+	m_meshlets = nullptr;
+	m_meshletCount = 0;
+	m_bounds = {};
+}
+
+CookedMesh::~CookedMesh()
+{
+	Close();
+}
+
+bool CookedMesh::Write(const std::string& filename, const MeshData& mesh, const SourceInfo& source)
+{
+	if (!mesh.vertices || mesh.vertexCount == 0 || mesh.indexCount == 0)
+	{
+		LOG_ERROR("CookedMesh::Write - No mesh data to write for " + filename);
+		return false;
+	}
+
+	// Sequential indices for meshes that were never indexed.
+	std::vector<IndexType> sequentialIndices;
+	const IndexType* indices = mesh.indices;
+	if (!indices)
+	{
+		sequentialIndices.resize(mesh.indexCount);
+		for (size_t i = 0; i < mesh.indexCount; i++)
+		{
+			sequentialIndices[i] = (IndexType)i;
+		}
+		indices = sequentialIndices.data();
+	}
+
+	// A mesh without a submesh table is drawn as one range with material 0.
+	Submesh wholeMesh = {};
+	const Submesh* submeshes = mesh.submeshes;
+	size_t submeshCount = mesh.submeshCount;
+	if (!submeshes || submeshCount == 0)
+	{
+		wholeMesh.indexCount = (uint32_t)mesh.indexCount;
+		wholeMesh.vertexCount = (uint32_t)mesh.vertexCount;
+		std::memcpy(wholeMesh.boundsMin, mesh.bounds.min, sizeof(wholeMesh.boundsMin));
+		std::memcpy(wholeMesh.boundsMax, mesh.bounds.max, sizeof(wholeMesh.boundsMax));
+		submeshes = &wholeMesh;
+		submeshCount = 1;
+	}
+
+	// Likewise a mesh without LODs has one level drawing every submesh.
+	LodLevel singleLod = {};
+	const LodLevel* lods = mesh.lods;
+	size_t lodCount = mesh.lodCount;
+	if (!lods || lodCount == 0)
+	{
+		singleLod.indexCount = (uint32_t)mesh.indexCount;
+		singleLod.submeshCount = (uint32_t)submeshCount;
+		lods = &singleLod;
+		lodCount = 1;
+	}
+
+	// Material table
+	uint32_t materialCount = (uint32_t)mesh.materials.size();
+	std::vector<uint8_t> materialData(sizeof(uint32_t));
+	std::memcpy(materialData.data(), &materialCount, sizeof(uint32_t));
+
+	for (const Material& material : mesh.materials)
+	{
+		MaterialHeader materialHeader = {};
+		std::memcpy(materialHeader.diffuseColor, material.diffuseColor, sizeof(materialHeader.diffuseColor));
+		std::memcpy(materialHeader.ambientColor, material.ambientColor, sizeof(materialHeader.ambientColor));
+		std::memcpy(materialHeader.specularColor, material.specularColor, sizeof(materialHeader.specularColor));
+		materialHeader.shininess = material.shininess;
+		materialHeader.metallic = material.metallic;
+		materialHeader.roughness = material.roughness;
+		materialHeader.ao = material.ao;
+		materialHeader.emissionStrength = material.emissionStrength;
+		for (int i = 0; i < TEXTURE_PATH_COUNT; i++)
+		{
+			materialHeader.pathLengths[i] = (uint32_t)material.texturePaths[i].size();
+		}
+
+		const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&materialHeader);
+		materialData.insert(materialData.end(), headerBytes, headerBytes + sizeof(MaterialHeader));
+		for (int i = 0; i < TEXTURE_PATH_COUNT; i++)
+		{
+			materialData.insert(materialData.end(), material.texturePaths[i].begin(), material.texturePaths[i].end());
+		}
+	}
+
+	PendingSection sections[] =
+	{
+		{ { SECTION_VERTICES, (uint32_t)sizeof(MeshVertex), 0, (uint64_t)(mesh.vertexCount * sizeof(MeshVertex)) }, mesh.vertices },
+		{ { SECTION_INDICES, (uint32_t)sizeof(IndexType), 0, (uint64_t)(mesh.indexCount * sizeof(IndexType)) }, indices },
+		{ { SECTION_SUBMESHES, (uint32_t)sizeof(Submesh), 0, (uint64_t)(submeshCount * sizeof(Submesh)) }, submeshes },
+		{ { SECTION_LODS, (uint32_t)sizeof(LodLevel), 0, (uint64_t)(lodCount * sizeof(LodLevel)) }, lods },
+		{ { SECTION_MESHLETS, (uint32_t)sizeof(Meshlet), 0, (uint64_t)(mesh.meshletCount * sizeof(Meshlet)) }, mesh.meshlets },
+		{ { SECTION_BOUNDS, (uint32_t)sizeof(Bounds), 0, (uint64_t)sizeof(Bounds) }, &mesh.bounds },
+		{ { SECTION_MATERIALS, 1, 0, (uint64_t)materialData.size() }, materialData.data() }
+	};
+	const uint32_t sectionCount = (uint32_t)(sizeof(sections) / sizeof(sections[0]));
+
+	// Lay out the payloads and hash them in file order.
+	FileHeader header = {};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.sectionCount = sectionCount;
+	header.flags = mesh.hasMaterial ? FLAG_HAS_MATERIAL : 0;
+	header.sourceSize = source.size;
+	header.sourceTimestamp = source.timestamp;
+	header.contentHash = Hash::FNV_OFFSET_BASIS;
+
+	uint64_t offset = AlignUp(sizeof(FileHeader) + sectionCount * sizeof(SectionEntry));
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		sections[i].entry.offset = offset;
+		offset = AlignUp(offset + sections[i].entry.size);
+		header.contentHash = Hash::Fnv1a64(sections[i].data, (size_t)sections[i].entry.size, header.contentHash);
+	}
+
+	// Write to a temporary file first so a failed cook never leaves a truncated mesh behind.
+	std::string tempFilename = filename + ".tmp";
+	std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+	if (!fout)
+	{
+		LOG_ERROR("CookedMesh::Write - Failed to open " + tempFilename);
+		return false;
+	}
+
+	const char padding[SECTION_ALIGNMENT] = {};
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		fout.write(reinterpret_cast<const char*>(&sections[i].entry), sizeof(SectionEntry));
+	}
+
+	uint64_t written = sizeof(FileHeader) + sectionCount * sizeof(SectionEntry);
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		fout.write(padding, (std::streamsize)(sections[i].entry.offset - written));
+		fout.write(static_cast<const char*>(sections[i].data), (std::streamsize)sections[i].entry.size);
+		written = sections[i].entry.offset + sections[i].entry.size;
+	}
+
+	fout.close();
+	if (!fout)
+	{
+		LOG_ERROR("CookedMesh::Write - Failed to write " + tempFilename);
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilename, filename, error);
+	if (error)
+	{
+		LOG_ERROR("CookedMesh::Write - Failed to move cooked mesh into place: " + error.message());
+		std::filesystem::remove(tempFilename, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool CookedMesh::GetSourceInfo(const std::string& filename, SourceInfo& source)
+{
+	std::error_code error;
+
+	uintmax_t size = std::filesystem::file_size(filename, error);
+	if (error)
+	{
+		return false;
+	}
+
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filename, error);
+	if (error)
+	{
+		return false;
+	}
+
+	source.size = (uint64_t)size;
+	source.timestamp = (int64_t)writeTime.time_since_epoch().count();
+	return true;
+}
+
+std::string CookedMesh::GetCookedFilename(const std::string& sourceFilename)
+{
+	return sourceFilename + ".mesh";
+}
+
+bool CookedMesh::Open(const std::string& filename)
+{
+	Close();
+
+	if (!m_file.Open(filename))
+	{
+		return false;
+	}
+
+	const uint8_t* data = m_file.GetData();
+	size_t size = m_file.GetSize();
+
+	// Validate the header and section table before trusting any offsets.
+	if (size < sizeof(FileHeader))
+	{
+		LOG_WARNING("CookedMesh::Open - File too small: " + filename);
+		Close();
+		return false;
+	}
+
+	m_header = reinterpret_cast<const FileHeader*>(data);
+	if (m_header->magic != MAGIC || m_header->version != VERSION)
+	{
+		LOG_WARNING("CookedMesh::Open - Unsupported format or version: " + filename);
+		Close();
+		return false;
+	}
+
+	uint64_t tableEnd = sizeof(FileHeader) + (uint64_t)m_header->sectionCount * sizeof(SectionEntry);
+	if (tableEnd > size)
+	{
+		LOG_WARNING("CookedMesh::Open - Truncated section table: " + filename);
+		Close();
+		return false;
+	}
+
+	m_sections = reinterpret_cast<const SectionEntry*>(data + sizeof(FileHeader));
+	for (uint32_t i = 0; i < m_header->sectionCount; i++)
+	{
+		const SectionEntry& section = m_sections[i];
+		if (section.offset < tableEnd || section.offset > size || section.size > size - section.offset)
+		{
+			LOG_WARNING("CookedMesh::Open - Section out of range: " + filename);
+			Close();
+			return false;
+		}
+	}
+
+	const SectionEntry* vertexSection = FindSection(SECTION_VERTICES);
+	const SectionEntry* indexSection = FindSection(SECTION_INDICES);
+	const SectionEntry* submeshSection = FindSection(SECTION_SUBMESHES);
+	const SectionEntry* boundsSection = FindSection(SECTION_BOUNDS);
+	const SectionEntry* materialSection = FindSection(SECTION_MATERIALS);
+	const SectionEntry* lodSection = FindSection(SECTION_LODS);
+	const SectionEntry* meshletSection = FindSection(SECTION_MESHLETS);
+
+	if (!vertexSection || !indexSection || !submeshSection || !boundsSection || !lodSection ||
+		vertexSection->elementSize != sizeof(MeshVertex) || indexSection->elementSize != sizeof(IndexType) ||
+		submeshSection->elementSize != sizeof(Submesh) || lodSection->elementSize != sizeof(LodLevel) ||
+		boundsSection->size != sizeof(Bounds) || (meshletSection && meshletSection->elementSize != sizeof(Meshlet)))
+	{
+		LOG_WARNING("CookedMesh::Open - Missing or mismatched sections: " + filename);
+		Close();
+		return false;
+	}
+
+	m_vertices = reinterpret_cast<const MeshVertex*>(data + vertexSection->offset);
+	m_vertexCount = (size_t)(vertexSection->size / sizeof(MeshVertex));
+	m_indices = reinterpret_cast<const IndexType*>(data + indexSection->offset);
+	m_indexCount = (size_t)(indexSection->size / sizeof(IndexType));
+	m_submeshes = reinterpret_cast<const Submesh*>(data + submeshSection->offset);
+	m_submeshCount = (size_t)(submeshSection->size / sizeof(Submesh));
+	m_lods = reinterpret_cast<const LodLevel*>(data + lodSection->offset);
+	m_lodCount = (size_t)(lodSection->size / sizeof(LodLevel));
+	if (meshletSection)
+	{
+		m_meshlets = reinterpret_cast<const Meshlet*>(data + meshletSection->offset);
+		m_meshletCount = (size_t)(meshletSection->size / sizeof(Meshlet));
+	}
+	std::memcpy(&m_bounds, data + boundsSection->offset, sizeof(Bounds));
+
+	for (size_t i = 0; i < m_submeshCount; i++)
+	{
+		if ((uint64_t)m_submeshes[i].indexOffset + m_submeshes[i].indexCount > m_indexCount)
+		{
+			LOG_WARNING("CookedMesh::Open - Submesh out of range: " + filename);
+			Close();
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < m_lodCount; i++)
+	{
+		if ((uint64_t)m_lods[i].submeshOffset + m_lods[i].submeshCount > m_submeshCount ||
+			(uint64_t)m_lods[i].indexOffset + m_lods[i].indexCount > m_indexCount)
+		{
+			LOG_WARNING("CookedMesh::Open - LOD out of range: " + filename);
+			Close();
+			return false;
+		}
+	}
+
+	// Meshlets index into the submeshes of LOD 0.
+	size_t lodSubmeshCount = m_lodCount > 0 ? m_lods[0].submeshCount : m_submeshCount;
+	for (size_t i = 0; i < m_meshletCount; i++)
+	{
+		if ((uint64_t)m_meshlets[i].indexOffset + (uint64_t)m_meshlets[i].triangleCount * 3 > m_indexCount ||
+			m_meshlets[i].submeshIndex >= lodSubmeshCount)
+		{
+			LOG_WARNING("CookedMesh::Open - Meshlet out of range: " + filename);
+			Close();
+			return false;
+		}
+	}
+
+	m_materials.clear();
+	if (materialSection && !ReadMaterials(*materialSection))
+	{
+		LOG_WARNING("CookedMesh::Open - Invalid material block: " + filename);
+		Close();
+		return false;
+	}
+
+#ifdef _DEBUG
+	if (!VerifyContentHash())
+	{
+		LOG_WARNING("CookedMesh::Open - Content hash mismatch: " + filename);
+		Close();
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+void CookedMesh::Close()
+{
+	m_file.Close();
+	m_header = nullptr;
+	m_sections = nullptr;
+	m_vertices = nullptr;
+	m_vertexCount = 0;
+	m_indices = nullptr;
+	m_indexCount = 0;
+	m_submeshes = nullptr;
+	m_submeshCount = 0;
+	m_lods = nullptr;
+	m_lodCount = 0;
+	m_meshlets = nullptr;
+	m_meshletCount = 0;
+	m_materials.clear();
+}
+
+bool CookedMesh::IsUpToDate(const SourceInfo& source) const
+{
+	return m_header && m_header->sourceSize == source.size && m_header->sourceTimestamp == source.timestamp;
+}
+
+bool CookedMesh::VerifyContentHash() const
+{
+	if (!m_header)
+	{
+		return false;
+	}
+
+	uint64_t hash = Hash::FNV_OFFSET_BASIS;
+	for (uint32_t i = 0; i < m_header->sectionCount; i++)
+	{
+		hash = Hash::Fnv1a64(m_file.GetData() + m_sections[i].offset, (size_t)m_sections[i].size, hash);
+	}
+
+	return hash == m_header->contentHash;
+}
+
+const CookedMesh::SectionEntry* CookedMesh::FindSection(uint32_t type) const
+{
+	for (uint32_t i = 0; i < m_header->sectionCount; i++)
+	{
+		if (m_sections[i].type == type)
+		{
+			return &m_sections[i];
+		}
+	}
+	return nullptr;
+}
+
+bool CookedMesh::ReadMaterials(const SectionEntry& section)
+{
+	const uint8_t* data = m_file.GetData() + section.offset;
+	uint32_t materialCount;
+
+	if (section.size < sizeof(uint32_t))
+	{
+		return false;
+	}
+	std::memcpy(&materialCount, data, sizeof(uint32_t));
+
+	uint64_t offset = sizeof(uint32_t);
+	for (uint32_t m = 0; m < materialCount; m++)
+	{
+		if (section.size - offset < sizeof(MaterialHeader))
+		{
+			return false;
+		}
+
+		MaterialHeader header;
+		std::memcpy(&header, data + offset, sizeof(MaterialHeader));
+		offset += sizeof(MaterialHeader);
+
+		Material material;
+		std::memcpy(material.diffuseColor, header.diffuseColor, sizeof(header.diffuseColor));
+		std::memcpy(material.ambientColor, header.ambientColor, sizeof(header.ambientColor));
+		std::memcpy(material.specularColor, header.specularColor, sizeof(header.specularColor));
+		material.shininess = header.shininess;
+		material.metallic = header.metallic;
+		material.roughness = header.roughness;
+		material.ao = header.ao;
+		material.emissionStrength = header.emissionStrength;
+
+		for (int i = 0; i < TEXTURE_PATH_COUNT; i++)
+		{
+			if (header.pathLengths[i] > section.size - offset)
+			{
+				return false;
+			}
+			material.texturePaths[i].assign(reinterpret_cast<const char*>(data + offset), header.pathLengths[i]);
+			offset += header.pathLengths[i];
+		}
+
+		m_materials.push_back(material);
+	}
+
+	return true;
+}
@@ -0,0 +1,172 @@
+#ifndef COOKED_MESH_H
+#define COOKED_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MeshTypes.h"
+#include "../../../Core/System/MappedFile.h"
+
+// Binary mesh container written by the import pipeline ("<source>.mesh").
+//
+// Layout: FileHeader, SectionEntry[sectionCount], then the section payloads,
+// each aligned to 16 bytes. Vertex and index sections are stored exactly as
+// the GPU buffers expect them so a mapped view can be passed straight to
+// buffer creation. The header records the size and write time of the source
+// file so stale files are re-cooked, and a content hash over all payloads.
+class CookedMesh
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+	using Submesh = MeshTypes::Submesh;
+	using LodLevel = MeshTypes::LodLevel;
+	using Meshlet = MeshTypes::Meshlet;
+
+	static const uint32_t MAGIC = 0x48534D45; // "EMSH"
+	static const uint32_t VERSION = 7;
+
+	// FileHeader::flags
+	static const uint32_t FLAG_HAS_MATERIAL = 1;  // The source had materials of its own
+
+	enum SectionType : uint32_t
+	{
+		SECTION_VERTICES = 1,  // MeshVertex[vertexCount]
+		SECTION_INDICES = 2,   // IndexType[indexCount]
+		SECTION_BOUNDS = 3,    // Bounds
+		SECTION_MATERIALS = 4, // Material count, then a MaterialHeader and the texture path strings per material
+		SECTION_SUBMESHES = 5, // Submesh[submeshCount], the ranges of all LODs
+		SECTION_LODS = 6,      // LodLevel[lodCount], LOD 0 first
+		SECTION_MESHLETS = 7   // Meshlet[meshletCount] of LOD 0, empty if none were built
+	};
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t sectionCount;
+		uint32_t flags;
+		uint64_t sourceSize;
+		int64_t sourceTimestamp;
+		uint64_t contentHash;
+		uint64_t reserved;
+	};
+
+	struct SectionEntry
+	{
+		uint32_t type;
+		uint32_t elementSize;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	using Bounds = MeshTypes::MeshBounds;
+
+	enum TexturePath
+	{
+		TEXTURE_DIFFUSE = 0,
+		TEXTURE_NORMAL,
+		TEXTURE_SPECULAR,
+		TEXTURE_ROUGHNESS,
+		TEXTURE_METALLIC,
+		TEXTURE_EMISSION,
+		TEXTURE_AO,
+		TEXTURE_PATH_COUNT
+	};
+
+	// Plain copy of EngineTypes::MaterialInfo without the DirectXMath types.
+	struct Material
+	{
+		float diffuseColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float ambientColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
+		float specularColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float shininess = 32.0f;
+		float metallic = 0.0f;
+		float roughness = 0.5f;
+		float ao = 1.0f;
+		float emissionStrength = 0.0f;
+		std::string texturePaths[TEXTURE_PATH_COUNT];
+	};
+
+	struct SourceInfo
+	{
+		uint64_t size = 0;
+		int64_t timestamp = 0;
+	};
+
+	// Everything the cook step writes out.
+	struct MeshData
+	{
+		const MeshVertex* vertices = nullptr;
+		size_t vertexCount = 0;
+		const IndexType* indices = nullptr;  // Null writes a sequential index list
+		size_t indexCount = 0;
+		const Submesh* submeshes = nullptr;
+		size_t submeshCount = 0;
+		const LodLevel* lods = nullptr;     // Null writes a single level covering every submesh
+		size_t lodCount = 0;
+		const Meshlet* meshlets = nullptr;
+		size_t meshletCount = 0;
+		Bounds bounds = {};
+		std::vector<Material> materials;
+		bool hasMaterial = false;
+	};
+
+public:
+	CookedMesh();
+	~CookedMesh();
+
+	// Cooking
+	static bool Write(const std::string& filename, const MeshData& mesh, const SourceInfo& source);
+	static bool GetSourceInfo(const std::string& filename, SourceInfo& source);
+	static std::string GetCookedFilename(const std::string& sourceFilename);
+
+	// Loading. Open maps the file and validates its structure; the vertex and
+	// index pointers point into the mapping and stay valid until Close().
+	bool Open(const std::string& filename);
+	void Close();
+	bool IsOpen() const { return m_file.IsOpen(); }
+	bool IsUpToDate(const SourceInfo& source) const;
+	bool VerifyContentHash() const;
+
+	const MeshVertex* GetVertices() const { return m_vertices; }
+	size_t GetVertexCount() const { return m_vertexCount; }
+	const IndexType* GetIndices() const { return m_indices; }
+	size_t GetIndexCount() const { return m_indexCount; }
+	const Submesh* GetSubmeshes() const { return m_submeshes; }
+	size_t GetSubmeshCount() const { return m_submeshCount; }
+	const LodLevel* GetLods() const { return m_lods; }
+	size_t GetLodCount() const { return m_lodCount; }
+	const Meshlet* GetMeshlets() const { return m_meshlets; }
+	size_t GetMeshletCount() const { return m_meshletCount; }
+	const Bounds& GetBounds() const { return m_bounds; }
+	const std::vector<Material>& GetMaterials() const { return m_materials; }
+	bool HasMaterial() const { return m_header && (m_header->flags & FLAG_HAS_MATERIAL) != 0; }
+	size_t GetFileSize() const { return m_file.GetSize(); }
+
+private:
+	const SectionEntry* FindSection(uint32_t type) const;
+	bool ReadMaterials(const SectionEntry& section);
+
+private:
+	MappedFile m_file;
+	const FileHeader* m_header;
+	const SectionEntry* m_sections;
+
+	const MeshVertex* m_vertices;
+	size_t m_vertexCount;
+	const IndexType* m_indices;
+	size_t m_indexCount;
+	const Submesh* m_submeshes;
+	size_t m_submeshCount;
+	const LodLevel* m_lods;
+	size_t m_lodCount;
+	const Meshlet* m_meshlets;
+	size_t m_meshletCount;
+	Bounds m_bounds;
+	std::vector<Material> m_materials;
+};
+
+#endif // COOKED_MESH_H
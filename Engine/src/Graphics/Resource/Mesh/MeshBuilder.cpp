@@ -0,0 +1,116 @@
+#include "MeshBuilder.h"
+#include <algorithm>
+
+MeshBuilder::MeshBuilder()
+{
+}
+
+MeshBuilder::~MeshBuilder()
+{
+}
+
+void MeshBuilder::Reserve(size_t vertexCount)
+{
+	m_vertices.reserve(vertexCount);
+}
+
+MeshBuilder::IndexType MeshBuilder::AddVertex(const MeshVertex& vertex)
+{
+	m_vertices.push_back(vertex);
+	return (IndexType)(m_vertices.size() - 1);
+}
+
+void MeshBuilder::AddTriangle(unsigned int materialIndex, IndexType index0, IndexType index1, IndexType index2)
+{
+	if (materialIndex >= m_materialIndices.size())
+	{
+		m_materialIndices.resize(materialIndex + 1);
+	}
+
+	std::vector<IndexType>& indices = m_materialIndices[materialIndex];
+	indices.push_back(index0);
+	indices.push_back(index1);
+	indices.push_back(index2);
+}
+
+size_t MeshBuilder::GetIndexCount() const
+{
+	size_t indexCount = 0;
+	for (const std::vector<IndexType>& indices : m_materialIndices)
+	{
+		indexCount += indices.size();
+	}
+	return indexCount;
+}
+
+void MeshBuilder::Build(std::vector<MeshVertex>& outVertices, std::vector<IndexType>& outIndices, std::vector<Submesh>& outSubmeshes)
+{
+	outVertices.swap(m_vertices);
+	m_vertices.clear();
+
+	outIndices.clear();
+	outIndices.reserve(GetIndexCount());
+	outSubmeshes.clear();
+
+	for (size_t material = 0; material < m_materialIndices.size(); material++)
+	{
+		const std::vector<IndexType>& indices = m_materialIndices[material];
+		if (indices.empty())
+		{
+			continue;
+		}
+
+		Submesh submesh = {};
+		submesh.indexOffset = (uint32_t)outIndices.size();
+		submesh.indexCount = (uint32_t)indices.size();
+		submesh.materialIndex = (uint32_t)material;
+		outSubmeshes.push_back(submesh);
+
+		outIndices.insert(outIndices.end(), indices.begin(), indices.end());
+	}
+	m_materialIndices.clear();
+
+	UpdateSubmeshBounds(outVertices.data(), outIndices.data(), outSubmeshes.data(), outSubmeshes.size());
+}
+
+void MeshBuilder::UpdateSubmeshBounds(const MeshVertex* vertices, const IndexType* indices, Submesh* submeshes, size_t submeshCount)
+{
+	for (size_t s = 0; s < submeshCount; s++)
+	{
+		Submesh& submesh = submeshes[s];
+		if (submesh.indexCount == 0)
+		{
+			continue;
+		}
+
+		IndexType firstVertex = indices[submesh.indexOffset];
+		IndexType lastVertex = firstVertex;
+		const MeshVertex& first = vertices[firstVertex];
+		float minX = first.x, minY = first.y, minZ = first.z;
+		float maxX = minX, maxY = minY, maxZ = minZ;
+
+		for (uint32_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i++)
+		{
+			IndexType index = indices[i];
+			const MeshVertex& vertex = vertices[index];
+
+			firstVertex = std::min(firstVertex, index);
+			lastVertex = std::max(lastVertex, index);
+			minX = std::min(minX, vertex.x);
+			minY = std::min(minY, vertex.y);
+			minZ = std::min(minZ, vertex.z);
+			maxX = std::max(maxX, vertex.x);
+			maxY = std::max(maxY, vertex.y);
+			maxZ = std::max(maxZ, vertex.z);
+		}
+
+		submesh.vertexOffset = firstVertex;
+		submesh.vertexCount = lastVertex - firstVertex + 1;
+		submesh.boundsMin[0] = minX;
+		submesh.boundsMin[1] = minY;
+		submesh.boundsMin[2] = minZ;
+		submesh.boundsMax[0] = maxX;
+		submesh.boundsMax[1] = maxY;
+		submesh.boundsMax[2] = maxZ;
+	}
+}
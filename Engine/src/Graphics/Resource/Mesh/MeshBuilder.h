@@ -0,0 +1,44 @@
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "MeshTypes.h"
+
+// Accumulates the geometry of all mesh nodes of a scene. Vertices go into one
+// shared list and triangles into one index list per material, so Build() can
+// emit every material as a single contiguous submesh with one copy at the end.
+class MeshBuilder
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+	using Submesh = MeshTypes::Submesh;
+
+public:
+	MeshBuilder();
+	~MeshBuilder();
+
+	void Reserve(size_t vertexCount);
+
+	IndexType AddVertex(const MeshVertex& vertex);
+	void AddTriangle(unsigned int materialIndex, IndexType index0, IndexType index1, IndexType index2);
+
+	size_t GetVertexCount() const { return m_vertices.size(); }
+	size_t GetIndexCount() const;
+
+	// Writes the vertices, the indices grouped by material and one submesh per
+	// used material. The builder is left empty.
+	void Build(std::vector<MeshVertex>& outVertices, std::vector<IndexType>& outIndices, std::vector<Submesh>& outSubmeshes);
+
+	// Recomputes the vertex span and bounds of every submesh, e.g. after the
+	// vertices were welded or reordered.
+	static void UpdateSubmeshBounds(const MeshVertex* vertices, const IndexType* indices, Submesh* submeshes, size_t submeshCount);
+
+private:
+	std::vector<MeshVertex> m_vertices;
+	std::vector<std::vector<IndexType>> m_materialIndices;
+};
+
+#endif // MESH_BUILDER_H
@@ -0,0 +1,498 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+	const uint32_t INVALID_VERTEX = 0xFFFFFFFFu;
+
+	// Triangle adjacency in compressed row form: the triangles using vertex v
+	// are triangles[offsets[v]] .. triangles[offsets[v + 1] - 1].
+	struct Adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+	};
+
+	void BuildAdjacency(const MeshTypes::IndexType* indices, size_t indexCount, size_t vertexCount, Adjacency& adjacency)
+	{
+		size_t triangleCount = indexCount / 3;
+
+		adjacency.offsets.assign(vertexCount + 1, 0);
+		adjacency.triangles.resize(triangleCount * 3);
+
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			adjacency.offsets[indices[i] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjacency.offsets[v + 1] += adjacency.offsets[v];
+		}
+
+		std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			adjacency.triangles[fill[indices[t * 3 + 0]]++] = (uint32_t)t;
+			adjacency.triangles[fill[indices[t * 3 + 1]]++] = (uint32_t)t;
+			adjacency.triangles[fill[indices[t * 3 + 2]]++] = (uint32_t)t;
+		}
+	}
+
+	// Picks the next fanning vertex as described in the Tipsify paper: prefer a
+	// candidate that will still be in the cache after its remaining triangles are
+	// emitted, then fall back to the dead-end stack and finally a linear scan.
+	uint32_t GetNextVertex(const std::vector<uint32_t>& candidates, const std::vector<uint32_t>& liveTriangles,
+						   const std::vector<uint32_t>& cacheTime, uint32_t timestamp, unsigned int cacheSize,
+						   std::vector<uint32_t>& deadEnd, uint32_t& cursor, size_t vertexCount, bool& jumped)
+	{
+		uint32_t best = INVALID_VERTEX;
+		int bestPriority = -1;
+
+		jumped = false;
+
+		for (uint32_t v : candidates)
+		{
+			if (liveTriangles[v] == 0)
+			{
+				continue;
+			}
+
+			int priority = 0;
+			if (timestamp - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+			{
+				priority = (int)(timestamp - cacheTime[v]);
+			}
+
+			if (priority > bestPriority)
+			{
+				best = v;
+				bestPriority = priority;
+			}
+		}
+
+		if (best != INVALID_VERTEX)
+		{
+			return best;
+		}
+
+		// Dead end, the next triangles will not share cached vertices with the previous ones.
+		jumped = true;
+
+		while (!deadEnd.empty())
+		{
+			uint32_t v = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[v] > 0)
+			{
+				return v;
+			}
+		}
+
+		while (cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return cursor;
+			}
+			cursor++;
+		}
+
+		return INVALID_VERTEX;
+	}
+
+	// Counts cache misses for one triangle using the same timestamp based FIFO
+	// model as Tipsify.
+	unsigned int UpdateCache(const MeshTypes::IndexType* triangle, std::vector<uint32_t>& cacheTime, uint32_t& timestamp, unsigned int cacheSize)
+	{
+		unsigned int misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t v = triangle[k];
+			if (timestamp - cacheTime[v] > cacheSize)
+			{
+				cacheTime[v] = timestamp++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	struct ClusterKey
+	{
+		size_t start;
+		size_t end;
+		float sortKey;
+	};
+}
+
+bool MeshOptimizer::Optimize(MeshVertex* vertices, size_t& vertexCount, IndexType* indices, size_t indexCount, const Settings& settings, Stats* stats,
+							 const MeshTypes::Submesh* submeshes, size_t submeshCount, std::vector<IndexType>* remap)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if (!vertices || !indices || vertexCount == 0 || indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			return false;
+		}
+	}
+
+	Stats localStats;
+	localStats.before = AnalyzeVertexCache(indices, indexCount, vertexCount, settings.cacheSize);
+
+	// Without a submesh table the whole index buffer is one range.
+	MeshTypes::Submesh wholeMesh = {};
+	wholeMesh.indexCount = (uint32_t)indexCount;
+	if (!submeshes || submeshCount == 0)
+	{
+		submeshes = &wholeMesh;
+		submeshCount = 1;
+	}
+
+	if (remap)
+	{
+		remap->clear();
+	}
+
+	std::vector<size_t> clusters;
+	for (size_t s = 0; s < submeshCount; s++)
+	{
+		const MeshTypes::Submesh& submesh = submeshes[s];
+		if (submesh.indexCount % 3 != 0 || (size_t)submesh.indexOffset + submesh.indexCount > indexCount)
+		{
+			return false;
+		}
+
+		IndexType* rangeIndices = indices + submesh.indexOffset;
+		OptimizeVertexCache(rangeIndices, submesh.indexCount, vertexCount, settings.cacheSize, settings.optimizeOverdraw ? &clusters : nullptr);
+
+		if (settings.optimizeOverdraw)
+		{
+			size_t clusterCount = 0;
+			OptimizeOverdraw(rangeIndices, submesh.indexCount, vertices, vertexCount, clusters, settings.cacheSize, settings.overdrawThreshold, &clusterCount);
+			localStats.clusterCount += clusterCount;
+		}
+	}
+
+	if (settings.optimizeVertexFetch)
+	{
+		size_t newVertexCount = OptimizeVertexFetch(vertices, vertexCount, indices, indexCount, remap);
+		localStats.unusedVerticesRemoved = vertexCount - newVertexCount;
+		vertexCount = newVertexCount;
+	}
+
+	localStats.after = AnalyzeVertexCache(indices, indexCount, vertexCount, settings.cacheSize);
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	localStats.optimizeTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+	if (stats)
+	{
+		*stats = localStats;
+	}
+
+	return true;
+}
+
+void MeshOptimizer::OptimizeVertexCache(IndexType* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize, std::vector<size_t>* clusters)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	Adjacency adjacency;
+	BuildAdjacency(indices, indexCount, vertexCount, adjacency);
+
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+
+	// Every vertex starts out of cache.
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnd;
+	std::vector<uint32_t> candidates;
+	std::vector<IndexType> output;
+	output.reserve(triangleCount * 3);
+
+	if (clusters)
+	{
+		clusters->clear();
+	}
+
+	uint32_t cursor = 0;
+	uint32_t fanningVertex = 0;
+	bool jumped = true;
+
+	while (cursor < vertexCount && liveTriangles[cursor] == 0)
+	{
+		cursor++;
+	}
+	fanningVertex = cursor;
+
+	while (fanningVertex != INVALID_VERTEX)
+	{
+		if (jumped && clusters)
+		{
+			clusters->push_back(output.size());
+		}
+
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex.
+		for (uint32_t a = adjacency.offsets[fanningVertex]; a < adjacency.offsets[fanningVertex + 1]; a++)
+		{
+			uint32_t t = adjacency.triangles[a];
+			if (emitted[t])
+			{
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[t * 3 + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+
+				if (timestamp - cacheTime[v] > cacheSize)
+				{
+					cacheTime[v] = timestamp++;
+				}
+			}
+
+			emitted[t] = true;
+		}
+
+		fanningVertex = GetNextVertex(candidates, liveTriangles, cacheTime, timestamp, cacheSize, deadEnd, cursor, vertexCount, jumped);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(IndexType* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount, const std::vector<size_t>& clusters, unsigned int cacheSize, float overdrawThreshold, size_t* clusterCount)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	std::vector<size_t> hardClusters = clusters;
+	if (hardClusters.empty() || hardClusters[0] != 0)
+	{
+		hardClusters.insert(hardClusters.begin(), 0);
+	}
+
+	// Split the hard clusters into smaller ones wherever the cache efficiency of
+	// the piece so far is within the threshold of the whole mesh. Smaller
+	// clusters sort better, but every split costs a cold cache.
+	float meshAcmr = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize).acmr;
+	float targetAcmr = meshAcmr * overdrawThreshold;
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	uint32_t timestamp = 0;
+	std::vector<size_t> softClusters;
+
+	for (size_t c = 0; c < hardClusters.size(); c++)
+	{
+		size_t start = hardClusters[c];
+		size_t end = (c + 1 < hardClusters.size()) ? hardClusters[c + 1] : indexCount;
+
+		softClusters.push_back(start);
+
+		timestamp += cacheSize + 1;
+		unsigned int clusterMisses = 0;
+		size_t clusterStart = start;
+
+		for (size_t i = start; i < end; i += 3)
+		{
+			clusterMisses += UpdateCache(&indices[i], cacheTime, timestamp, cacheSize);
+			size_t clusterTriangles = (i + 3 - clusterStart) / 3;
+
+			if (i + 3 < end && (float)clusterMisses <= targetAcmr * (float)clusterTriangles)
+			{
+				softClusters.push_back(i + 3);
+				clusterStart = i + 3;
+				clusterMisses = 0;
+				timestamp += cacheSize + 1;
+			}
+		}
+	}
+
+	// Area weighted centroid and average normal of every cluster, plus the
+	// area weighted centroid of the whole mesh.
+	std::vector<ClusterKey> keys(softClusters.size());
+	std::vector<float> centers(softClusters.size() * 3, 0.0f);
+	std::vector<float> normals(softClusters.size() * 3, 0.0f);
+	double meshCenter[3] = { 0.0, 0.0, 0.0 };
+	double meshArea = 0.0;
+
+	for (size_t c = 0; c < softClusters.size(); c++)
+	{
+		ClusterKey& key = keys[c];
+		key.start = softClusters[c];
+		key.end = (c + 1 < softClusters.size()) ? softClusters[c + 1] : indexCount;
+
+		float* center = &centers[c * 3];
+		float* normal = &normals[c * 3];
+		float area = 0.0f;
+
+		for (size_t i = key.start; i < key.end; i += 3)
+		{
+			const MeshVertex& v0 = vertices[indices[i + 0]];
+			const MeshVertex& v1 = vertices[indices[i + 1]];
+			const MeshVertex& v2 = vertices[indices[i + 2]];
+
+			float e1[3] = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+			float e2[3] = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			center[0] += (v0.x + v1.x + v2.x) / 3.0f * triangleArea;
+			center[1] += (v0.y + v1.y + v2.y) / 3.0f * triangleArea;
+			center[2] += (v0.z + v1.z + v2.z) / 3.0f * triangleArea;
+			normal[0] += n[0];
+			normal[1] += n[1];
+			normal[2] += n[2];
+			area += triangleArea;
+		}
+
+		meshCenter[0] += center[0];
+		meshCenter[1] += center[1];
+		meshCenter[2] += center[2];
+		meshArea += area;
+
+		if (area > 0.0f)
+		{
+			center[0] /= area;
+			center[1] /= area;
+			center[2] /= area;
+		}
+	}
+
+	if (meshArea > 0.0)
+	{
+		meshCenter[0] /= meshArea;
+		meshCenter[1] /= meshArea;
+		meshCenter[2] /= meshArea;
+	}
+
+	// How far the cluster sits out along its own normal from the mesh center.
+	for (size_t c = 0; c < keys.size(); c++)
+	{
+		const float* center = &centers[c * 3];
+		const float* normal = &normals[c * 3];
+		float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+		keys[c].sortKey = 0.0f;
+		if (normalLength > 0.0f)
+		{
+			keys[c].sortKey = ((center[0] - (float)meshCenter[0]) * normal[0] +
+				(center[1] - (float)meshCenter[1]) * normal[1] +
+				(center[2] - (float)meshCenter[2]) * normal[2]) / normalLength;
+		}
+	}
+
+	// Clusters facing away from the center are the most likely occluders, draw them first.
+	std::stable_sort(keys.begin(), keys.end(), [](const ClusterKey& a, const ClusterKey& b) { return a.sortKey > b.sortKey; });
+
+	std::vector<IndexType> output;
+	output.reserve(indexCount);
+	for (const ClusterKey& key : keys)
+	{
+		output.insert(output.end(), indices + key.start, indices + key.end);
+	}
+	std::copy(output.begin(), output.end(), indices);
+
+	if (clusterCount)
+	{
+		*clusterCount = keys.size();
+	}
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(MeshVertex* vertices, size_t vertexCount, IndexType* indices, size_t indexCount, std::vector<IndexType>* remap)
+{
+	std::vector<IndexType> table(vertexCount, INVALID_VERTEX);
+	std::vector<MeshVertex> ordered;
+	ordered.reserve(vertexCount);
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		IndexType v = indices[i];
+		if (table[v] == INVALID_VERTEX)
+		{
+			table[v] = (IndexType)ordered.size();
+			ordered.push_back(vertices[v]);
+		}
+		indices[i] = table[v];
+	}
+
+	std::copy(ordered.begin(), ordered.end(), vertices);
+
+	if (remap)
+	{
+		remap->swap(table);
+	}
+
+	return ordered.size();
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const IndexType* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+{
+	CacheStats stats;
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	uint32_t timestamp = cacheSize + 1;
+	size_t uniqueVertices = 0;
+
+	for (size_t i = 0; i < triangleCount * 3; i += 3)
+	{
+		stats.transformedVertices += UpdateCache(&indices[i], cacheTime, timestamp, cacheSize);
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (!referenced[indices[i + k]])
+			{
+				referenced[indices[i + k]] = true;
+				uniqueVertices++;
+			}
+		}
+	}
+
+	stats.acmr = (float)stats.transformedVertices / (float)triangleCount;
+	stats.atvr = uniqueVertices > 0 ? (float)stats.transformedVertices / (float)uniqueVertices : 0.0f;
+
+	return stats;
+}
+
+std::string MeshOptimizer::FormatStats(const Stats& stats)
+{
+	return "Mesh optimization: ACMR " + std::to_string(stats.before.acmr) + " -> " + std::to_string(stats.after.acmr) +
+		", ATVR " + std::to_string(stats.before.atvr) + " -> " + std::to_string(stats.after.atvr) +
+		", " + std::to_string(stats.clusterCount) + " overdraw clusters, " +
+		std::to_string(stats.unusedVerticesRemoved) + " unused vertices removed, " +
+		std::to_string(stats.optimizeTimeMs) + " ms";
+}
@@ -0,0 +1,76 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "MeshTypes.h"
+
+// Index/vertex buffer reordering for indexed triangle lists.
+// - Vertex cache: Tipsify (Sander et al. 2007) triangle ordering.
+// - Overdraw: the Tipsify output is split into clusters which are then sorted
+//   so outward-facing clusters are drawn first.
+// - Vertex fetch: vertices are renumbered in order of first use.
+// All passes are CPU only and operate in place.
+class MeshOptimizer
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+
+	struct Settings
+	{
+		unsigned int cacheSize = 16;      // Post-transform cache size the ordering targets
+		float overdrawThreshold = 1.05f;  // Allowed ACMR increase when splitting clusters for overdraw
+		bool optimizeOverdraw = true;
+		bool optimizeVertexFetch = true;
+	};
+
+	struct CacheStats
+	{
+		float acmr = 0.0f;  // Average cache miss ratio (transformed vertices per triangle)
+		float atvr = 0.0f;  // Average transform to vertex ratio (transformed vertices per unique vertex)
+		size_t transformedVertices = 0;
+	};
+
+	struct Stats
+	{
+		CacheStats before;
+		CacheStats after;
+		size_t clusterCount = 0;
+		size_t unusedVerticesRemoved = 0;
+		double optimizeTimeMs = 0.0;
+	};
+
+public:
+	// Runs the vertex cache, overdraw and vertex fetch passes in that order.
+	// vertexCount is updated if unreferenced vertices were dropped. If
+	// submeshes are given, triangles are only reordered within each submesh
+	// so the draw ranges stay valid. remap, if given, receives the new vertex
+	// of every old one as OptimizeVertexFetch reports it, or stays empty if
+	// that pass is disabled.
+	static bool Optimize(MeshVertex* vertices, size_t& vertexCount, IndexType* indices, size_t indexCount, const Settings& settings, Stats* stats = nullptr,
+						 const MeshTypes::Submesh* submeshes = nullptr, size_t submeshCount = 0, std::vector<IndexType>* remap = nullptr);
+
+	// Reorders triangles for post-transform cache reuse. If clusters is given it
+	// receives the index offset of every cluster start (hard boundaries where
+	// Tipsify had to jump to a new, non-adjacent vertex).
+	static void OptimizeVertexCache(IndexType* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize, std::vector<size_t>* clusters = nullptr);
+
+	// Sorts the given clusters front-to-back from the outside in. Clusters are
+	// first split further where that costs at most overdrawThreshold in ACMR.
+	static void OptimizeOverdraw(IndexType* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount, const std::vector<size_t>& clusters, unsigned int cacheSize, float overdrawThreshold, size_t* clusterCount = nullptr);
+
+	// Renumbers vertices in order of first reference and drops unused ones.
+	// Returns the new vertex count. remap, if given, maps old to new vertex
+	// (unused vertices map to 0xFFFFFFFF).
+	static size_t OptimizeVertexFetch(MeshVertex* vertices, size_t vertexCount, IndexType* indices, size_t indexCount, std::vector<IndexType>* remap = nullptr);
+
+	// FIFO post-transform cache simulation.
+	static CacheStats AnalyzeVertexCache(const IndexType* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // MESH_OPTIMIZER_H
@@ -0,0 +1,627 @@
+#include "MeshSimplifier.h"
+#include "MeshBuilder.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+
+namespace
+{
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	// Area weighted sum of squared distances to a set of planes,
+	// Q(p) = p^T A p + 2 b^T p + c. weight is the total area, so the error can
+	// be reported as an average squared distance.
+	struct Quadric
+	{
+		double a00, a11, a22, a01, a12, a02;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		float cost;
+		float error;  // Geometric part of the cost
+	};
+
+	void QuadricAdd(Quadric& q, const Quadric& r)
+	{
+		q.a00 += r.a00;
+		q.a11 += r.a11;
+		q.a22 += r.a22;
+		q.a01 += r.a01;
+		q.a12 += r.a12;
+		q.a02 += r.a02;
+		q.b0 += r.b0;
+		q.b1 += r.b1;
+		q.b2 += r.b2;
+		q.c += r.c;
+		q.weight += r.weight;
+	}
+
+	void QuadricFromTriangle(Quadric& q, const Vector3& p0, const Vector3& p1, const Vector3& p2)
+	{
+		double e1x = p1.x - p0.x, e1y = p1.y - p0.y, e1z = p1.z - p0.z;
+		double e2x = p2.x - p0.x, e2y = p2.y - p0.y, e2z = p2.z - p0.z;
+		double nx = e1y * e2z - e1z * e2y;
+		double ny = e1z * e2x - e1x * e2z;
+		double nz = e1x * e2y - e1y * e2x;
+		double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+
+		q = Quadric();
+		if (length <= 0.0)
+		{
+			return;
+		}
+
+		nx /= length;
+		ny /= length;
+		nz /= length;
+		double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+		double w = length * 0.5;
+
+		q.a00 = nx * nx * w;
+		q.a11 = ny * ny * w;
+		q.a22 = nz * nz * w;
+		q.a01 = nx * ny * w;
+		q.a12 = ny * nz * w;
+		q.a02 = nx * nz * w;
+		q.b0 = nx * d * w;
+		q.b1 = ny * d * w;
+		q.b2 = nz * d * w;
+		q.c = d * d * w;
+		q.weight = w;
+	}
+
+	double QuadricError(const Quadric& q, const Vector3& p)
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double rx = q.a00 * x + q.a01 * y + q.a02 * z;
+		double ry = q.a01 * x + q.a11 * y + q.a12 * z;
+		double rz = q.a02 * x + q.a12 * y + q.a22 * z;
+		double error = rx * x + ry * y + rz * z + 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+
+		return q.weight > 0.0 ? std::fabs(error) / q.weight : 0.0;
+	}
+
+	inline Vector3 TriangleNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+	{
+		float e1x = p1.x - p0.x, e1y = p1.y - p0.y, e1z = p1.z - p0.z;
+		float e2x = p2.x - p0.x, e2y = p2.y - p0.y, e2z = p2.z - p0.z;
+		return { e1y * e2z - e1z * e2y, e1z * e2x - e1x * e2z, e1x * e2y - e1y * e2x };
+	}
+
+	inline float AttributeDistance(const MeshTypes::MeshVertex& a, const MeshTypes::MeshVertex& b, const MeshSimplifier::Settings& settings)
+	{
+		float du = a.tu - b.tu, dv = a.tv - b.tv;
+		float dnx = a.nx - b.nx, dny = a.ny - b.ny, dnz = a.nz - b.nz;
+		return settings.uvWeight * (du * du + dv * dv) + settings.normalWeight * (dnx * dnx + dny * dny + dnz * dnz);
+	}
+
+	inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+	{
+		return ((uint64_t)a << 32) | b;
+	}
+}
+
+size_t MeshSimplifier::Simplify(IndexType* destination, const IndexType* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount,
+								size_t targetIndexCount, float targetError, const Settings& settings, float* resultError)
+{
+	if (resultError)
+	{
+		*resultError = 0.0f;
+	}
+
+	if (!destination || !indices || !vertices || vertexCount == 0 || indexCount % 3 != 0)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			return 0;
+		}
+	}
+
+	std::vector<IndexType> result(indices, indices + indexCount);
+
+	// Positions in the unit cube, so every error is relative to the mesh extent.
+	float minX = vertices[0].x, minY = vertices[0].y, minZ = vertices[0].z;
+	for (size_t i = 1; i < vertexCount; i++)
+	{
+		minX = std::min(minX, vertices[i].x);
+		minY = std::min(minY, vertices[i].y);
+		minZ = std::min(minZ, vertices[i].z);
+	}
+	float extent = GetMeshExtent(vertices, vertexCount);
+	float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+	std::vector<Vector3> positions(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		positions[i] = { (vertices[i].x - minX) * scale, (vertices[i].y - minY) * scale, (vertices[i].z - minZ) * scale };
+	}
+
+	// Vertices with the same position are wedges of one position vertex (the
+	// first of them). Collapses move position vertices, wedgeNext links all
+	// wedges of a position in a ring so each can be remapped on its own.
+	std::vector<uint32_t> positionRemap(vertexCount);
+	std::vector<uint32_t> wedgeNext(vertexCount);
+	{
+		std::vector<uint32_t> order(vertexCount);
+		for (uint32_t i = 0; i < (uint32_t)vertexCount; i++)
+		{
+			order[i] = i;
+		}
+
+		auto lessPosition = [&](uint32_t a, uint32_t b)
+		{
+			const MeshVertex& va = vertices[a];
+			const MeshVertex& vb = vertices[b];
+			if (va.x != vb.x) return va.x < vb.x;
+			if (va.y != vb.y) return va.y < vb.y;
+			if (va.z != vb.z) return va.z < vb.z;
+			return a < b;
+		};
+		std::sort(order.begin(), order.end(), lessPosition);
+
+		size_t groupStart = 0;
+		for (size_t i = 1; i <= vertexCount; i++)
+		{
+			bool sameGroup = i < vertexCount &&
+				vertices[order[i]].x == vertices[order[groupStart]].x &&
+				vertices[order[i]].y == vertices[order[groupStart]].y &&
+				vertices[order[i]].z == vertices[order[groupStart]].z;
+			if (sameGroup)
+			{
+				continue;
+			}
+
+			for (size_t k = groupStart; k < i; k++)
+			{
+				positionRemap[order[k]] = order[groupStart];
+				wedgeNext[order[k]] = order[k + 1 < i ? k + 1 : groupStart];
+			}
+			groupStart = i;
+		}
+	}
+
+	// Open borders: position edges without a twin running the other way.
+	std::vector<uint8_t> locked(vertexCount, 0);
+	if (settings.lockBorder)
+	{
+		std::unordered_set<uint64_t> edges;
+		edges.reserve(indexCount);
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = positionRemap[result[i + k]];
+				uint32_t b = positionRemap[result[i + (k + 1) % 3]];
+				edges.insert(EdgeKey(a, b));
+			}
+		}
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = positionRemap[result[i + k]];
+				uint32_t b = positionRemap[result[i + (k + 1) % 3]];
+				if (a != b && edges.find(EdgeKey(b, a)) == edges.end())
+				{
+					locked[a] = 1;
+					locked[b] = 1;
+				}
+			}
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		uint32_t a = positionRemap[result[i + 0]];
+		uint32_t b = positionRemap[result[i + 1]];
+		uint32_t c = positionRemap[result[i + 2]];
+
+		Quadric q;
+		QuadricFromTriangle(q, positions[a], positions[b], positions[c]);
+		QuadricAdd(quadrics[a], q);
+		QuadricAdd(quadrics[b], q);
+		QuadricAdd(quadrics[c], q);
+	}
+
+	size_t targetTriangles = targetIndexCount / 3;
+	double errorLimit = (double)targetError * (double)targetError;
+	float maxError = 0.0f;
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<uint8_t> used(vertexCount);
+	std::vector<uint8_t> touched(vertexCount);
+	std::vector<uint32_t> collapseRemap(vertexCount);
+	std::vector<Collapse> collapses;
+
+	// Cost of moving position vertex from onto to, negative if not allowed.
+	// error receives the geometric part alone.
+	auto collapseCost = [&](uint32_t from, uint32_t to, float& error) -> float
+	{
+		if (locked[from])
+		{
+			return -1.0f;
+		}
+
+		Quadric q = quadrics[from];
+		QuadricAdd(q, quadrics[to]);
+		double cost = QuadricError(q, positions[to]);
+		error = (float)cost;
+
+		// Every wedge still in use has to find a matching wedge at the target.
+		uint32_t wedge = from;
+		do
+		{
+			if (used[wedge])
+			{
+				float best = AttributeDistance(vertices[wedge], vertices[to], settings);
+				for (uint32_t target = wedgeNext[to]; target != to; target = wedgeNext[target])
+				{
+					best = std::min(best, AttributeDistance(vertices[wedge], vertices[target], settings));
+				}
+				cost += best;
+			}
+			wedge = wedgeNext[wedge];
+		} while (wedge != from);
+
+		return (float)cost;
+	};
+
+	// True if collapsing from onto to would flip or flatten a remaining triangle around from.
+	auto collapseFlips = [&](uint32_t from, uint32_t to)
+	{
+		for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; a++)
+		{
+			const IndexType* triangle = &result[adjacency[a] * 3];
+			uint32_t corners[3] = { positionRemap[triangle[0]], positionRemap[triangle[1]], positionRemap[triangle[2]] };
+			if (corners[0] == to || corners[1] == to || corners[2] == to)
+			{
+				continue;
+			}
+
+			Vector3 before = TriangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+			for (int k = 0; k < 3; k++)
+			{
+				if (corners[k] == from)
+				{
+					corners[k] = to;
+				}
+			}
+			Vector3 after = TriangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+
+			float dot = before.x * after.x + before.y * after.y + before.z * after.z;
+			float lengths = std::sqrt((before.x * before.x + before.y * before.y + before.z * before.z) *
+				(after.x * after.x + after.y * after.y + after.z * after.z));
+			if (dot <= 0.25f * lengths)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// True if a remaining triangle has the directed position edge a->b.
+	auto hasEdge = [&](uint32_t a, uint32_t b)
+	{
+		for (uint32_t t = adjacencyOffsets[a]; t < adjacencyOffsets[a + 1]; t++)
+		{
+			const IndexType* triangle = &result[adjacency[t] * 3];
+			for (int k = 0; k < 3; k++)
+			{
+				if (positionRemap[triangle[k]] == a && positionRemap[triangle[(k + 1) % 3]] == b)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	// Every pass collapses an independent set of the cheapest edges, then
+	// rewrites the index list.
+	while (result.size() / 3 > targetTriangles)
+	{
+		size_t triangleCount = result.size() / 3;
+
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		std::fill(used.begin(), used.end(), 0);
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			adjacencyOffsets[positionRemap[result[i]] + 1]++;
+			used[result[i]] = 1;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i++)
+			{
+				adjacency[fill[positionRemap[result[i]]]++] = (uint32_t)(i / 3);
+			}
+		}
+
+		// Cheapest direction of every edge.
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = positionRemap[result[i + k]];
+				uint32_t b = positionRemap[result[i + (k + 1) % 3]];
+
+				// Interior edges are seen once from each side, evaluate them once.
+				if (a == b || (a > b && hasEdge(b, a)))
+				{
+					continue;
+				}
+
+				float errorAB = 0.0f, errorBA = 0.0f;
+				float costAB = collapseCost(a, b, errorAB);
+				float costBA = collapseCost(b, a, errorBA);
+				if (costAB >= 0.0f && (costBA < 0.0f || costAB <= costBA))
+				{
+					collapses.push_back({ a, b, costAB, errorAB });
+				}
+				else if (costBA >= 0.0f)
+				{
+					collapses.push_back({ b, a, costBA, errorBA });
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+		std::fill(touched.begin(), touched.end(), 0);
+		for (uint32_t v = 0; v < (uint32_t)vertexCount; v++)
+		{
+			collapseRemap[v] = v;
+		}
+
+		size_t removed = 0;
+		size_t collapsed = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (collapse.cost > errorLimit || triangleCount - removed <= targetTriangles)
+			{
+				break;
+			}
+
+			if (touched[collapse.from] || touched[collapse.to] || collapseFlips(collapse.from, collapse.to))
+			{
+				continue;
+			}
+
+			// Move every wedge onto the closest wedge at the target.
+			uint32_t wedge = collapse.from;
+			do
+			{
+				uint32_t best = collapse.to;
+				float bestDistance = AttributeDistance(vertices[wedge], vertices[best], settings);
+				for (uint32_t target = wedgeNext[collapse.to]; target != collapse.to; target = wedgeNext[target])
+				{
+					float distance = AttributeDistance(vertices[wedge], vertices[target], settings);
+					if (distance < bestDistance)
+					{
+						best = target;
+						bestDistance = distance;
+					}
+				}
+				collapseRemap[wedge] = best;
+				wedge = wedgeNext[wedge];
+			} while (wedge != collapse.from);
+
+			QuadricAdd(quadrics[collapse.to], quadrics[collapse.from]);
+
+			// The triangles around from must stay as they are for the rest of the pass.
+			touched[collapse.from] = 1;
+			touched[collapse.to] = 1;
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++)
+			{
+				const IndexType* triangle = &result[adjacency[a] * 3];
+				bool hasTarget = false;
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t corner = positionRemap[triangle[k]];
+					touched[corner] = 1;
+					hasTarget |= corner == collapse.to;
+				}
+				removed += hasTarget ? 1 : 0;
+			}
+
+			maxError = std::max(maxError, collapse.error);
+			collapsed++;
+		}
+
+		if (collapsed == 0)
+		{
+			break;
+		}
+
+		// Apply the collapses and drop the triangles that became degenerate.
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			IndexType i0 = collapseRemap[result[i + 0]];
+			IndexType i1 = collapseRemap[result[i + 1]];
+			IndexType i2 = collapseRemap[result[i + 2]];
+			uint32_t p0 = positionRemap[i0], p1 = positionRemap[i1], p2 = positionRemap[i2];
+			if (p0 == p1 || p1 == p2 || p0 == p2)
+			{
+				continue;
+			}
+
+			result[write + 0] = i0;
+			result[write + 1] = i1;
+			result[write + 2] = i2;
+			write += 3;
+		}
+		result.resize(write);
+	}
+
+	std::copy(result.begin(), result.end(), destination);
+
+	if (resultError)
+	{
+		*resultError = std::sqrt(maxError);
+	}
+
+	return result.size();
+}
+
+bool MeshSimplifier::GenerateLods(const MeshVertex* vertices, size_t vertexCount, std::vector<IndexType>& indices, std::vector<Submesh>& submeshes,
+								  std::vector<LodLevel>& lods, const Settings& settings, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	lods.clear();
+
+	if (!vertices || vertexCount == 0 || indices.empty() || indices.size() % 3 != 0)
+	{
+		return false;
+	}
+
+	// Without a submesh table LOD 0 is one range.
+	if (submeshes.empty())
+	{
+		Submesh submesh = {};
+		submesh.indexCount = (uint32_t)indices.size();
+		submeshes.push_back(submesh);
+		MeshBuilder::UpdateSubmeshBounds(vertices, indices.data(), submeshes.data(), 1);
+	}
+
+	LodLevel base = {};
+	base.indexCount = (uint32_t)indices.size();
+	base.submeshCount = (uint32_t)submeshes.size();
+	lods.push_back(base);
+
+	float extent = GetMeshExtent(vertices, vertexCount);
+	int levelCount = std::min(settings.levelCount, MAX_LEVELS);
+	std::vector<IndexType> source;
+	std::vector<IndexType> simplified;
+
+	for (int level = 1; level < levelCount; level++)
+	{
+		const LodLevel previous = lods.back();
+		if (previous.indexCount / 3 <= settings.minTriangles)
+		{
+			break;
+		}
+
+		LodLevel lod = {};
+		lod.indexOffset = (uint32_t)indices.size();
+		lod.submeshOffset = (uint32_t)submeshes.size();
+		float levelError = 0.0f;
+
+		for (uint32_t s = previous.submeshOffset; s < previous.submeshOffset + previous.submeshCount; s++)
+		{
+			// Copies, both vectors grow below.
+			Submesh submesh = submeshes[s];
+			source.assign(indices.begin() + submesh.indexOffset, indices.begin() + submesh.indexOffset + submesh.indexCount);
+			simplified.resize(source.size());
+
+			size_t targetIndexCount = (size_t)((float)(submesh.indexCount / 3) * settings.targetRatio) * 3;
+			float error = 0.0f;
+			size_t indexCount = Simplify(simplified.data(), source.data(), source.size(), vertices, vertexCount, targetIndexCount, settings.maxError, settings, &error);
+			if (indexCount == 0)
+			{
+				continue;
+			}
+
+			MeshOptimizer::OptimizeVertexCache(simplified.data(), indexCount, vertexCount, 16);
+
+			submesh.indexOffset = (uint32_t)indices.size();
+			submesh.indexCount = (uint32_t)indexCount;
+			indices.insert(indices.end(), simplified.begin(), simplified.begin() + indexCount);
+			submeshes.push_back(submesh);
+			levelError = std::max(levelError, error);
+		}
+
+		lod.indexCount = (uint32_t)(indices.size() - lod.indexOffset);
+		lod.submeshCount = (uint32_t)(submeshes.size() - lod.submeshOffset);
+		lod.error = previous.error + levelError * extent;
+
+		// The error limit stopped the simplifier early, a level this close to the previous one only costs memory.
+		if (lod.indexCount == 0 || (float)lod.indexCount > (float)previous.indexCount * 0.9f)
+		{
+			indices.resize(lod.indexOffset);
+			submeshes.resize(lod.submeshOffset);
+			break;
+		}
+
+		MeshBuilder::UpdateSubmeshBounds(vertices, indices.data(), submeshes.data() + lod.submeshOffset, lod.submeshCount);
+		lods.push_back(lod);
+	}
+
+	if (stats)
+	{
+		*stats = Stats();
+		stats->levelCount = lods.size();
+		for (size_t i = 0; i < lods.size(); i++)
+		{
+			stats->triangles[i] = lods[i].indexCount / 3;
+			stats->errors[i] = lods[i].error;
+		}
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		stats->simplifyTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	}
+
+	return true;
+}
+
+float MeshSimplifier::GetMeshExtent(const MeshVertex* vertices, size_t vertexCount)
+{
+	if (!vertices || vertexCount == 0)
+	{
+		return 0.0f;
+	}
+
+	float minX = vertices[0].x, minY = vertices[0].y, minZ = vertices[0].z;
+	float maxX = minX, maxY = minY, maxZ = minZ;
+	for (size_t i = 1; i < vertexCount; i++)
+	{
+		minX = std::min(minX, vertices[i].x);
+		minY = std::min(minY, vertices[i].y);
+		minZ = std::min(minZ, vertices[i].z);
+		maxX = std::max(maxX, vertices[i].x);
+		maxY = std::max(maxY, vertices[i].y);
+		maxZ = std::max(maxZ, vertices[i].z);
+	}
+
+	return std::max(maxX - minX, std::max(maxY - minY, maxZ - minZ));
+}
+
+std::string MeshSimplifier::FormatStats(const Stats& stats)
+{
+	std::string triangles;
+	std::string errors;
+	for (size_t i = 0; i < stats.levelCount; i++)
+	{
+		triangles += (i > 0 ? " / " : "") + std::to_string(stats.triangles[i]);
+		errors += (i > 0 ? " / " : "") + std::to_string(stats.errors[i]);
+	}
+
+	return "LOD generation: " + std::to_string(stats.levelCount) + " levels, triangles " + triangles +
+		", error " + errors + ", " + std::to_string(stats.simplifyTimeMs) + " ms";
+}
@@ -0,0 +1,69 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "MeshTypes.h"
+
+// Quadric error metric simplification (Garland & Heckbert 1997) for indexed
+// triangle lists, used to build the LOD chain at import time.
+// - Edges are collapsed onto one of their end points, so every level indexes
+//   the original vertex buffer and all levels can share it.
+// - Vertices that share a position but differ in UV or normal are collapsed
+//   together; mismatching attributes add to the cost, weighted per attribute,
+//   so UV seams and hard edges are preserved.
+// - Vertices on open borders (including the edges between submeshes) can be
+//   locked so neighbouring parts stay watertight.
+class MeshSimplifier
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+	using Submesh = MeshTypes::Submesh;
+	using LodLevel = MeshTypes::LodLevel;
+
+	static const int MAX_LEVELS = 8;
+
+	struct Settings
+	{
+		int levelCount = 4;               // Levels including LOD 0, at most MAX_LEVELS
+		float targetRatio = 0.5f;         // Triangles of every level relative to the previous one
+		float maxError = 0.02f;           // Largest error per level, relative to the mesh extent
+		float uvWeight = 1.0f;            // Cost of a UV mismatch relative to position error
+		float normalWeight = 0.05f;       // Cost of a normal mismatch relative to position error
+		bool lockBorder = true;           // Never move vertices on open borders
+		unsigned int minTriangles = 32;   // No further levels below this many triangles
+	};
+
+	struct Stats
+	{
+		size_t levelCount = 0;
+		size_t triangles[MAX_LEVELS] = {};
+		float errors[MAX_LEVELS] = {};
+		double simplifyTimeMs = 0.0;
+	};
+
+public:
+	// Simplifies indices towards targetIndexCount without any collapse costing
+	// more than targetError (position plus weighted attribute error, relative
+	// to the mesh extent). destination receives the result and must hold
+	// indexCount indices; it may alias indices. Returns the new index count and
+	// the geometric error reached in resultError.
+	static size_t Simplify(IndexType* destination, const IndexType* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount,
+						   size_t targetIndexCount, float targetError, const Settings& settings, float* resultError = nullptr);
+
+	// Builds the LOD chain. indices and submeshes hold LOD 0 on input; every
+	// further level is simplified from the previous one submesh by submesh and
+	// appended to both. lods receives one entry per level, LOD 0 first.
+	static bool GenerateLods(const MeshVertex* vertices, size_t vertexCount, std::vector<IndexType>& indices, std::vector<Submesh>& submeshes,
+							 std::vector<LodLevel>& lods, const Settings& settings, Stats* stats = nullptr);
+
+	// Largest side of the bounding box, the unit of the relative errors.
+	static float GetMeshExtent(const MeshVertex* vertices, size_t vertexCount);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,118 @@
+#ifndef MESH_TYPES_H
+#define MESH_TYPES_H
+
+#include <cstdint>
+
+// CPU-side mesh data shared by the import processing stages.
+// These types deliberately avoid D3D/DirectXMath so the processing code can
+// be built and benchmarked headless.
+namespace MeshTypes
+{
+	// Full vertex as produced by the importers. The layout matches
+	// EngineTypes::VertexType so it can be handed to buffer creation directly.
+	struct MeshVertex
+	{
+		float x, y, z;
+		float tu, tv;
+		float nx, ny, nz;
+		float tx, ty, tz;
+		float bx, by, bz;
+	};
+
+	typedef uint32_t IndexType;
+
+	// GPU vertex layouts a model can be uploaded with.
+	enum VertexFormat : uint32_t
+	{
+		VERTEX_FORMAT_FULL = 0,     // MeshVertex, 56 bytes
+		VERTEX_FORMAT_COMPACT = 1   // CompactVertex, 20 bytes
+	};
+
+	// Compressed vertex for bandwidth bound scenes.
+	// - position: UNORM16 within the mesh bounds, see VertexQuantization (w unused)
+	// - texture: half floats
+	// - normal: octahedral, SNORM16
+	// - tangentFrame: rotation of the tangent frame as a quaternion, SNORM8.
+	//   w is kept away from zero and its sign is the bitangent handedness.
+	struct CompactVertex
+	{
+		uint16_t position[4];
+		uint16_t texture[2];
+		int16_t normal[2];
+		int8_t tangentFrame[4];
+	};
+
+	// Decodes CompactVertex::position: position = offset + unorm * scale.
+	struct VertexQuantization
+	{
+		float positionOffset[3];
+		float positionScale[3];
+	};
+
+	// Object space bounding volumes of a mesh, see BoundsCalculator.
+	// - min/max: axis aligned box
+	// - center/radius: bounding sphere
+	// - boxCenter/boxAxes/boxExtents: oriented box, boxAxes are orthonormal
+	//   rows and boxExtents the half sizes along them
+	struct MeshBounds
+	{
+		float min[3];
+		float max[3];
+		float center[3];
+		float radius;
+		float boxCenter[3];
+		float boxAxes[3][3];
+		float boxExtents[3];
+	};
+
+	// Draw range of one material within the shared vertex/index buffers.
+	// Indices are absolute, vertexOffset/vertexCount give the span of
+	// vertices the range references.
+	struct Submesh
+	{
+		uint32_t indexOffset;
+		uint32_t indexCount;
+		uint32_t vertexOffset;
+		uint32_t vertexCount;
+		uint32_t materialIndex;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// Cluster of up to a few dozen vertices and about a hundred triangles of
+	// LOD 0, see MeshletBuilder. The triangles are a contiguous range of the
+	// index buffer inside one submesh, so visible meshlets are drawn with
+	// plain DrawIndexed calls. Four float4 rows, ready for a structured buffer.
+	// - center/radius: bounding sphere of the meshlet's vertices
+	// - coneApex/coneAxis/coneCutoff: backface cone. The meshlet faces away
+	//   from a camera at p if dot(normalize(coneApex - p), coneAxis) >= coneCutoff;
+	//   a cutoff of 1 disables the test.
+	struct Meshlet
+	{
+		uint32_t indexOffset;
+		uint32_t triangleCount;
+		uint32_t vertexCount;
+		uint32_t submeshIndex;
+		float center[3];
+		float radius;
+		float coneApex[3];
+		float coneCutoff;
+		float coneAxis[3];
+		float padding;
+	};
+
+	// One level of detail. Every level has its own index range and its own
+	// submeshes (submeshOffset/submeshCount into the submesh table); all
+	// levels share the vertex buffer. error is the geometric deviation from
+	// LOD 0 in object space units.
+	struct LodLevel
+	{
+		uint32_t indexOffset;
+		uint32_t indexCount;
+		uint32_t submeshOffset;
+		uint32_t submeshCount;
+		float error;
+	};
+}
+
+#endif // MESH_TYPES_H
@@ -0,0 +1,256 @@
+#include "MeshWelder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace
+{
+	const uint32_t INVALID_VERTEX = 0xFFFFFFFFu;
+
+	inline uint64_t HashCell(int64_t cx, int64_t cy, int64_t cz)
+	{
+		// Large primes from the classic spatial hashing scheme (Teschner et al.).
+		uint64_t h = (uint64_t)cx * 73856093ull;
+		h ^= (uint64_t)cy * 19349663ull;
+		h ^= (uint64_t)cz * 83492791ull;
+		return h;
+	}
+
+	inline bool NearlyEqual(float a, float b, float epsilon)
+	{
+		return std::fabs(a - b) <= epsilon;
+	}
+
+	inline bool Matches(const MeshTypes::MeshVertex& a, const MeshTypes::MeshVertex& b, const MeshWelder::Settings& settings)
+	{
+		return NearlyEqual(a.x, b.x, settings.positionEpsilon) &&
+			NearlyEqual(a.y, b.y, settings.positionEpsilon) &&
+			NearlyEqual(a.z, b.z, settings.positionEpsilon) &&
+			NearlyEqual(a.nx, b.nx, settings.normalEpsilon) &&
+			NearlyEqual(a.ny, b.ny, settings.normalEpsilon) &&
+			NearlyEqual(a.nz, b.nz, settings.normalEpsilon) &&
+			NearlyEqual(a.tu, b.tu, settings.uvEpsilon) &&
+			NearlyEqual(a.tv, b.tv, settings.uvEpsilon);
+	}
+
+	inline void Normalize(float& x, float& y, float& z)
+	{
+		float length = std::sqrt(x * x + y * y + z * z);
+		if (length > 1.0e-12f)
+		{
+			x /= length;
+			y /= length;
+			z /= length;
+		}
+	}
+}
+
+bool MeshWelder::Weld(const MeshVertex* vertices, size_t vertexCount,
+					  const IndexType* indices, size_t indexCount,
+					  const Settings& settings,
+					  std::vector<MeshVertex>& outVertices,
+					  std::vector<IndexType>& outIndices,
+					  std::vector<IndexType>* outRemap,
+					  Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	outVertices.clear();
+	outIndices.clear();
+
+	if (!vertices || vertexCount == 0)
+	{
+		return false;
+	}
+
+	if (!indices)
+	{
+		indexCount = vertexCount;
+	}
+
+	// Find the extent of the mesh so the hash grid has a sensible cell size even
+	// when the position epsilon is zero.
+	float minX = vertices[0].x, minY = vertices[0].y, minZ = vertices[0].z;
+	float maxX = minX, maxY = minY, maxZ = minZ;
+	for (size_t i = 1; i < vertexCount; i++)
+	{
+		minX = std::min(minX, vertices[i].x);
+		minY = std::min(minY, vertices[i].y);
+		minZ = std::min(minZ, vertices[i].z);
+		maxX = std::max(maxX, vertices[i].x);
+		maxY = std::max(maxY, vertices[i].y);
+		maxZ = std::max(maxZ, vertices[i].z);
+	}
+	float extent = std::max(maxX - minX, std::max(maxY - minY, maxZ - minZ));
+
+	// Cells must be at least as large as the epsilon so that a match is always
+	// found in the vertex's own cell or one of its immediate neighbours.
+	float cellSize = std::max(settings.positionEpsilon * 2.0f, extent * 1.0e-4f);
+	if (cellSize <= 0.0f)
+	{
+		cellSize = 1.0f;
+	}
+	float invCellSize = 1.0f / cellSize;
+
+	// Each hash cell stores the head of a linked list of output vertices.
+	std::unordered_map<uint64_t, uint32_t> cellHeads;
+	cellHeads.reserve(vertexCount);
+	std::vector<uint32_t> nextInCell;
+	nextInCell.reserve(vertexCount);
+
+	// Tangent frame accumulators for averaging merged vertices.
+	std::vector<float> tangentSums;
+	tangentSums.reserve(vertexCount * 6);
+
+	std::vector<IndexType> remap(vertexCount, INVALID_VERTEX);
+	outVertices.reserve(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const MeshVertex& vertex = vertices[i];
+
+		float fx = vertex.x * invCellSize;
+		float fy = vertex.y * invCellSize;
+		float fz = vertex.z * invCellSize;
+		int64_t cx = (int64_t)std::floor(fx);
+		int64_t cy = (int64_t)std::floor(fy);
+		int64_t cz = (int64_t)std::floor(fz);
+
+		// Only probe the neighbouring cells the epsilon region actually reaches.
+		float reach = settings.positionEpsilon * invCellSize;
+		int x0 = (fx - reach < (float)cx) ? -1 : 0;
+		int x1 = (fx + reach >= (float)(cx + 1)) ? 1 : 0;
+		int y0 = (fy - reach < (float)cy) ? -1 : 0;
+		int y1 = (fy + reach >= (float)(cy + 1)) ? 1 : 0;
+		int z0 = (fz - reach < (float)cz) ? -1 : 0;
+		int z1 = (fz + reach >= (float)(cz + 1)) ? 1 : 0;
+
+		uint32_t match = INVALID_VERTEX;
+		for (int dx = x0; dx <= x1 && match == INVALID_VERTEX; dx++)
+		{
+			for (int dy = y0; dy <= y1 && match == INVALID_VERTEX; dy++)
+			{
+				for (int dz = z0; dz <= z1 && match == INVALID_VERTEX; dz++)
+				{
+					auto cell = cellHeads.find(HashCell(cx + dx, cy + dy, cz + dz));
+					if (cell == cellHeads.end())
+					{
+						continue;
+					}
+
+					for (uint32_t candidate = cell->second; candidate != INVALID_VERTEX; candidate = nextInCell[candidate])
+					{
+						if (Matches(outVertices[candidate], vertex, settings))
+						{
+							match = candidate;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		if (match == INVALID_VERTEX)
+		{
+			// No existing vertex is close enough, so this one becomes a new output vertex.
+			match = (uint32_t)outVertices.size();
+			outVertices.push_back(vertex);
+
+			uint64_t key = HashCell(cx, cy, cz);
+			auto cell = cellHeads.find(key);
+			if (cell == cellHeads.end())
+			{
+				nextInCell.push_back(INVALID_VERTEX);
+				cellHeads.emplace(key, match);
+			}
+			else
+			{
+				nextInCell.push_back(cell->second);
+				cell->second = match;
+			}
+
+			tangentSums.push_back(vertex.tx);
+			tangentSums.push_back(vertex.ty);
+			tangentSums.push_back(vertex.tz);
+			tangentSums.push_back(vertex.bx);
+			tangentSums.push_back(vertex.by);
+			tangentSums.push_back(vertex.bz);
+		}
+		else
+		{
+			float* sums = &tangentSums[(size_t)match * 6];
+			sums[0] += vertex.tx;
+			sums[1] += vertex.ty;
+			sums[2] += vertex.tz;
+			sums[3] += vertex.bx;
+			sums[4] += vertex.by;
+			sums[5] += vertex.bz;
+		}
+
+		remap[i] = match;
+	}
+
+	// Write the averaged tangent frames back to the welded vertices.
+	for (size_t i = 0; i < outVertices.size(); i++)
+	{
+		const float* sums = &tangentSums[i * 6];
+		MeshVertex& vertex = outVertices[i];
+		vertex.tx = sums[0];
+		vertex.ty = sums[1];
+		vertex.tz = sums[2];
+		vertex.bx = sums[3];
+		vertex.by = sums[4];
+		vertex.bz = sums[5];
+		Normalize(vertex.tx, vertex.ty, vertex.tz);
+		Normalize(vertex.bx, vertex.by, vertex.bz);
+	}
+
+	// Rewrite the index list through the remap table.
+	outIndices.resize(indexCount);
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		IndexType source = indices ? indices[i] : (IndexType)i;
+		if (source >= vertexCount)
+		{
+			outVertices.clear();
+			outIndices.clear();
+			return false;
+		}
+		outIndices[i] = remap[source];
+	}
+
+	outVertices.shrink_to_fit();
+
+	if (outRemap)
+	{
+		outRemap->swap(remap);
+	}
+
+	if (stats)
+	{
+		stats->inputVertices = vertexCount;
+		stats->outputVertices = outVertices.size();
+		stats->indexCount = indexCount;
+		stats->inputBytes = vertexCount * sizeof(MeshVertex);
+		stats->outputBytes = outVertices.size() * sizeof(MeshVertex);
+		stats->bytesSaved = stats->inputBytes - stats->outputBytes;
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		stats->weldTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	}
+
+	return true;
+}
+
+std::string MeshWelder::FormatStats(const Stats& stats)
+{
+	double ratio = stats.inputVertices > 0 ? (double)stats.outputVertices / (double)stats.inputVertices : 0.0;
+
+	return "Vertex welding: " + std::to_string(stats.inputVertices) + " -> " + std::to_string(stats.outputVertices) +
+		" vertices (" + std::to_string((int)(ratio * 100.0 + 0.5)) + "%), " +
+		std::to_string(stats.indexCount) + " indices, " +
+		std::to_string(stats.bytesSaved / 1024) + " KB vertex data saved, " +
+		std::to_string(stats.weldTimeMs) + " ms";
+}
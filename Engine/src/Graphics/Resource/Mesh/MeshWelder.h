@@ -0,0 +1,53 @@
+#ifndef MESH_WELDER_H
+#define MESH_WELDER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "MeshTypes.h"
+
+// Hashed vertex welding. Collapses polygon-vertices whose position, normal and
+// UV all match within the configured epsilons and emits a genuinely indexed
+// vertex/index pair.
+class MeshWelder
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+
+	struct Settings
+	{
+		float positionEpsilon = 1.0e-5f;
+		float normalEpsilon = 1.0e-3f;
+		float uvEpsilon = 1.0e-5f;
+	};
+
+	struct Stats
+	{
+		size_t inputVertices = 0;
+		size_t outputVertices = 0;
+		size_t indexCount = 0;
+		size_t inputBytes = 0;   // Vertex bytes before welding
+		size_t outputBytes = 0;  // Vertex bytes after welding
+		size_t bytesSaved = 0;
+		double weldTimeMs = 0.0;
+	};
+
+public:
+	// Welds the given vertices. If indices is null the input is treated as a
+	// plain triangle list (index i refers to vertex i). outRemap, if provided,
+	// receives the output vertex for every input vertex.
+	// Tangent and binormal of merged vertices are averaged and renormalized.
+	static bool Weld(const MeshVertex* vertices, size_t vertexCount,
+					 const IndexType* indices, size_t indexCount,
+					 const Settings& settings,
+					 std::vector<MeshVertex>& outVertices,
+					 std::vector<IndexType>& outIndices,
+					 std::vector<IndexType>* outRemap = nullptr,
+					 Stats* stats = nullptr);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // MESH_WELDER_H
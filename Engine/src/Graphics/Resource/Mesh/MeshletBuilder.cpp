@@ -0,0 +1,467 @@
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+	using Meshlet = MeshTypes::Meshlet;
+
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	inline Vector3 Add(const Vector3& a, const Vector3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Vector3 Sub(const Vector3& a, const Vector3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Vector3 Scale(const Vector3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+	inline float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline Vector3 Cross(const Vector3& a, const Vector3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline Vector3 Position(const MeshVertex& vertex) { return { vertex.x, vertex.y, vertex.z }; }
+
+	// Unit vector, or zero for a zero length input.
+	inline Vector3 NormalizeOrZero(const Vector3& a)
+	{
+		float length = std::sqrt(Dot(a, a));
+		return length > 0.0f ? Scale(a, 1.0f / length) : Vector3{ 0.0f, 0.0f, 0.0f };
+	}
+
+	// Cones wider than this (about 84 degrees from the axis) would almost never
+	// cull, the test is disabled for them.
+	const float MIN_CONE_DOT = 0.1f;
+
+	// Keeps the cone test conservative against rounding.
+	const float CONE_CUTOFF_EPSILON = 1.0e-4f;
+
+	// Fills in the sphere and cone of a meshlet from its triangles.
+	void ComputeMeshletBounds(const MeshVertex* vertices, const IndexType* indices, const std::vector<uint32_t>& triangles,
+							  const std::vector<uint32_t>& meshletVertices, const std::vector<Vector3>& faceNormals, Meshlet& meshlet)
+	{
+		// Sphere around the center of the vertices' AABB.
+		Vector3 minimum = Position(vertices[meshletVertices[0]]);
+		Vector3 maximum = minimum;
+		for (uint32_t vertex : meshletVertices)
+		{
+			Vector3 position = Position(vertices[vertex]);
+			minimum = { std::min(minimum.x, position.x), std::min(minimum.y, position.y), std::min(minimum.z, position.z) };
+			maximum = { std::max(maximum.x, position.x), std::max(maximum.y, position.y), std::max(maximum.z, position.z) };
+		}
+
+		Vector3 center = Scale(Add(minimum, maximum), 0.5f);
+		float radiusSq = 0.0f;
+		for (uint32_t vertex : meshletVertices)
+		{
+			Vector3 offset = Sub(Position(vertices[vertex]), center);
+			radiusSq = std::max(radiusSq, Dot(offset, offset));
+		}
+
+		meshlet.center[0] = center.x;
+		meshlet.center[1] = center.y;
+		meshlet.center[2] = center.z;
+		meshlet.radius = std::sqrt(radiusSq) * (1.0f + 1.0e-6f);
+
+		// Cone around the average face normal; its half angle is the widest normal.
+		Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+		for (uint32_t triangle : triangles)
+		{
+			normalSum = Add(normalSum, faceNormals[triangle]);
+		}
+		Vector3 axis = NormalizeOrZero(normalSum);
+
+		float minDot = 1.0f;
+		bool hasNormal = false;
+		for (uint32_t triangle : triangles)
+		{
+			const Vector3& normal = faceNormals[triangle];
+			if (Dot(normal, normal) > 0.0f)
+			{
+				minDot = std::min(minDot, Dot(normal, axis));
+				hasNormal = true;
+			}
+		}
+
+		meshlet.coneAxis[0] = axis.x;
+		meshlet.coneAxis[1] = axis.y;
+		meshlet.coneAxis[2] = axis.z;
+		meshlet.coneApex[0] = center.x;
+		meshlet.coneApex[1] = center.y;
+		meshlet.coneApex[2] = center.z;
+		meshlet.coneCutoff = 1.0f;
+		meshlet.padding = 0.0f;
+
+		if (!hasNormal || minDot <= MIN_CONE_DOT)
+		{
+			return;
+		}
+
+		// The apex is the point on the axis through the center behind every
+		// triangle plane: dot(center - t * axis - corner, normal) <= 0.
+		float maxT = 0.0f;
+		for (uint32_t triangle : triangles)
+		{
+			const Vector3& normal = faceNormals[triangle];
+			float axisDot = Dot(axis, normal);
+			if (axisDot > 0.0f)
+			{
+				Vector3 corner = Position(vertices[indices[triangle * 3]]);
+				maxT = std::max(maxT, Dot(Sub(center, corner), normal) / axisDot);
+			}
+		}
+
+		Vector3 apex = Sub(center, Scale(axis, maxT));
+		meshlet.coneApex[0] = apex.x;
+		meshlet.coneApex[1] = apex.y;
+		meshlet.coneApex[2] = apex.z;
+		meshlet.coneCutoff = std::min(1.0f, std::sqrt(1.0f - minDot * minDot) + CONE_CUTOFF_EPSILON);
+	}
+}
+
+bool MeshletBuilder::Build(const MeshVertex* vertices, size_t vertexCount, IndexType* indices, const Submesh* submeshes, size_t submeshCount,
+						   const Settings& settings, std::vector<Meshlet>& meshlets, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	meshlets.clear();
+	if (stats)
+	{
+		*stats = Stats();
+	}
+
+	if (!vertices || vertexCount == 0 || !indices || !submeshes || submeshCount == 0)
+	{
+		return true;
+	}
+
+	const size_t maxVertices = std::max<size_t>(settings.maxVertices, 3);
+	const size_t maxTriangles = std::max<size_t>(settings.maxTriangles, 1);
+
+	// LOD 0 ends where its last submesh does.
+	size_t indexCount = 0;
+	for (size_t s = 0; s < submeshCount; s++)
+	{
+		indexCount = std::max(indexCount, (size_t)submeshes[s].indexOffset + submeshes[s].indexCount);
+	}
+	size_t triangleCount = indexCount / 3;
+
+	float acmrBefore = MeshOptimizer::AnalyzeVertexCache(indices, triangleCount * 3, vertexCount, settings.cacheSize).acmr;
+
+	// Oriented face normals. The winding is checked against the vertex normals
+	// so the cones agree with the shading.
+	std::vector<Vector3> faceNormals(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		IndexType i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+		if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+		{
+			return false;
+		}
+
+		const MeshVertex& v0 = vertices[i0];
+		const MeshVertex& v1 = vertices[i1];
+		const MeshVertex& v2 = vertices[i2];
+		Vector3 normal = NormalizeOrZero(Cross(Sub(Position(v1), Position(v0)), Sub(Position(v2), Position(v0))));
+		Vector3 vertexNormal = { v0.nx + v1.nx + v2.nx, v0.ny + v1.ny + v2.ny, v0.nz + v1.nz + v2.nz };
+		faceNormals[t] = Dot(normal, vertexNormal) < 0.0f ? Scale(normal, -1.0f) : normal;
+	}
+
+	// Vertex to triangle adjacency. Each list keeps its unused triangles in
+	// front of liveCounts[vertex], so finished triangles are never scanned again.
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		triangleOffsets[indices[i] + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		triangleOffsets[v + 1] += triangleOffsets[v];
+	}
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> liveCounts(vertexCount, 0);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			IndexType vertex = indices[t * 3 + corner];
+			adjacency[triangleOffsets[vertex] + liveCounts[vertex]++] = (uint32_t)t;
+		}
+	}
+
+	std::vector<uint8_t> used(triangleCount, 0);
+	std::vector<uint32_t> vertexMeshlet(vertexCount, UINT32_MAX);
+	std::vector<IndexType> reordered;
+	std::vector<uint32_t> meshletTriangles;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<IndexType> localIndices;
+	meshletTriangles.reserve(maxTriangles);
+	meshletVertices.reserve(maxVertices);
+
+	size_t totalVertices = 0;
+
+	for (size_t s = 0; s < submeshCount; s++)
+	{
+		const Submesh& submesh = submeshes[s];
+		const uint32_t firstTriangle = submesh.indexOffset / 3;
+		const uint32_t endTriangle = firstTriangle + submesh.indexCount / 3;
+
+		reordered.clear();
+		reordered.reserve(submesh.indexCount);
+
+		uint32_t nextSeed = firstTriangle;
+		while (true)
+		{
+			while (nextSeed < endTriangle && used[nextSeed])
+			{
+				nextSeed++;
+			}
+			if (nextSeed == endTriangle)
+			{
+				break;
+			}
+
+			const uint32_t meshletIndex = (uint32_t)meshlets.size();
+			meshletTriangles.clear();
+			meshletVertices.clear();
+			Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+
+			auto newVertexCount = [&](uint32_t triangle)
+			{
+				size_t count = 0;
+				for (int corner = 0; corner < 3; corner++)
+				{
+					count += vertexMeshlet[indices[triangle * 3 + corner]] != meshletIndex ? 1 : 0;
+				}
+				return count;
+			};
+
+			auto addTriangle = [&](uint32_t triangle)
+			{
+				used[triangle] = 1;
+				meshletTriangles.push_back(triangle);
+				normalSum = Add(normalSum, faceNormals[triangle]);
+
+				for (int corner = 0; corner < 3; corner++)
+				{
+					IndexType vertex = indices[triangle * 3 + corner];
+					if (vertexMeshlet[vertex] != meshletIndex)
+					{
+						vertexMeshlet[vertex] = meshletIndex;
+						meshletVertices.push_back(vertex);
+					}
+
+					// Swap the triangle out of the vertex's live list.
+					uint32_t* list = &adjacency[triangleOffsets[vertex]];
+					uint32_t& live = liveCounts[vertex];
+					for (uint32_t k = 0; k < live; k++)
+					{
+						if (list[k] == triangle)
+						{
+							list[k] = list[--live];
+							list[live] = triangle;
+							break;
+						}
+					}
+				}
+			};
+
+			addTriangle(nextSeed);
+
+			while (meshletTriangles.size() < maxTriangles)
+			{
+				Vector3 axis = NormalizeOrZero(normalSum);
+				uint32_t best = UINT32_MAX;
+				float bestScore = FLT_MAX;
+
+				for (uint32_t vertex : meshletVertices)
+				{
+					const uint32_t* list = &adjacency[triangleOffsets[vertex]];
+					for (uint32_t k = 0; k < liveCounts[vertex]; k++)
+					{
+						uint32_t triangle = list[k];
+						if (triangle < firstTriangle || triangle >= endTriangle)
+						{
+							continue;
+						}
+
+						size_t extra = newVertexCount(triangle);
+						if (meshletVertices.size() + extra > maxVertices)
+						{
+							continue;
+						}
+
+						float score = (float)extra + settings.coneWeight * (1.0f - Dot(faceNormals[triangle], axis));
+						if (score < bestScore || (score == bestScore && triangle < best))
+						{
+							best = triangle;
+							bestScore = score;
+						}
+					}
+				}
+
+				// Disconnected pieces: keep filling small meshlets in index order,
+				// which the vertex cache optimization left spatially coherent.
+				if (best == UINT32_MAX && meshletTriangles.size() < maxTriangles / 4)
+				{
+					while (nextSeed < endTriangle && used[nextSeed])
+					{
+						nextSeed++;
+					}
+					if (nextSeed < endTriangle && meshletVertices.size() + newVertexCount(nextSeed) <= maxVertices)
+					{
+						best = nextSeed;
+					}
+				}
+
+				if (best == UINT32_MAX)
+				{
+					break;
+				}
+				addTriangle(best);
+			}
+
+			Meshlet meshlet = {};
+			meshlet.indexOffset = submesh.indexOffset + (uint32_t)reordered.size();
+			meshlet.triangleCount = (uint32_t)meshletTriangles.size();
+			meshlet.vertexCount = (uint32_t)meshletVertices.size();
+			meshlet.submeshIndex = (uint32_t)s;
+			ComputeMeshletBounds(vertices, indices, meshletTriangles, meshletVertices, faceNormals, meshlet);
+			meshlets.push_back(meshlet);
+			totalVertices += meshletVertices.size();
+
+			// Order the triangles inside the meshlet for the vertex cache again,
+			// on meshlet-local vertex numbers so the pass stays small.
+			localIndices.clear();
+			for (uint32_t triangle : meshletTriangles)
+			{
+				for (int corner = 0; corner < 3; corner++)
+				{
+					IndexType vertex = indices[triangle * 3 + corner];
+					localIndices.push_back((IndexType)(std::find(meshletVertices.begin(), meshletVertices.end(), vertex) - meshletVertices.begin()));
+				}
+			}
+			MeshOptimizer::OptimizeVertexCache(localIndices.data(), localIndices.size(), meshletVertices.size(), settings.cacheSize);
+
+			for (IndexType local : localIndices)
+			{
+				reordered.push_back(meshletVertices[local]);
+			}
+		}
+
+		// Written back per submesh; later submeshes only read their own range.
+		std::copy(reordered.begin(), reordered.end(), indices + submesh.indexOffset);
+	}
+
+	if (stats)
+	{
+		stats->meshletCount = meshlets.size();
+		stats->triangleCount = triangleCount;
+		if (!meshlets.empty())
+		{
+			stats->averageTriangles = (float)triangleCount / (float)meshlets.size();
+			stats->averageVertices = (float)totalVertices / (float)meshlets.size();
+		}
+		for (const Meshlet& meshlet : meshlets)
+		{
+			stats->coneCount += meshlet.coneCutoff < 1.0f ? 1 : 0;
+		}
+		stats->acmrBefore = acmrBefore;
+		stats->acmrAfter = MeshOptimizer::AnalyzeVertexCache(indices, triangleCount * 3, vertexCount, settings.cacheSize).acmr;
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		stats->buildTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	}
+
+	return true;
+}
+
+void MeshletBuilder::Cull(const Meshlet* meshlets, size_t meshletCount, const float planes[6][4], const float* cameraPosition,
+						  std::vector<DrawRange>& ranges, CullStats* stats)
+{
+	// The sphere is outside a plane if its center is further behind than the
+	// radius; with unnormalized planes the radius scales by the normal length.
+	float planeLengths[6];
+	for (int i = 0; i < 6; i++)
+	{
+		planeLengths[i] = std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+	}
+
+	CullStats cullStats;
+	for (size_t m = 0; m < meshletCount; m++)
+	{
+		const Meshlet& meshlet = meshlets[m];
+		cullStats.meshletCount++;
+		cullStats.triangleCount += meshlet.triangleCount;
+
+		bool visible = true;
+		for (int i = 0; i < 6 && visible; i++)
+		{
+			float distance = planes[i][0] * meshlet.center[0] + planes[i][1] * meshlet.center[1] + planes[i][2] * meshlet.center[2] + planes[i][3];
+			visible = distance >= -meshlet.radius * planeLengths[i];
+		}
+		if (!visible)
+		{
+			cullStats.frustumCulled++;
+			cullStats.trianglesCulled += meshlet.triangleCount;
+			continue;
+		}
+
+		if (cameraPosition && meshlet.coneCutoff < 1.0f)
+		{
+			float toApex[3] =
+			{
+				meshlet.coneApex[0] - cameraPosition[0],
+				meshlet.coneApex[1] - cameraPosition[1],
+				meshlet.coneApex[2] - cameraPosition[2]
+			};
+			float length = std::sqrt(toApex[0] * toApex[0] + toApex[1] * toApex[1] + toApex[2] * toApex[2]);
+			float axisDot = toApex[0] * meshlet.coneAxis[0] + toApex[1] * meshlet.coneAxis[1] + toApex[2] * meshlet.coneAxis[2];
+			if (axisDot >= meshlet.coneCutoff * length)
+			{
+				cullStats.coneCulled++;
+				cullStats.trianglesCulled += meshlet.triangleCount;
+				continue;
+			}
+		}
+
+		uint32_t indexCount = meshlet.triangleCount * 3;
+		if (!ranges.empty() && ranges.back().indexOffset + ranges.back().indexCount == meshlet.indexOffset)
+		{
+			ranges.back().indexCount += indexCount;
+		}
+		else
+		{
+			ranges.push_back({ meshlet.indexOffset, indexCount });
+		}
+	}
+
+	if (stats)
+	{
+		stats->meshletCount += cullStats.meshletCount;
+		stats->frustumCulled += cullStats.frustumCulled;
+		stats->coneCulled += cullStats.coneCulled;
+		stats->triangleCount += cullStats.triangleCount;
+		stats->trianglesCulled += cullStats.trianglesCulled;
+	}
+}
+
+std::string MeshletBuilder::FormatStats(const Stats& stats)
+{
+	return "Meshlets: " + std::to_string(stats.meshletCount) + " for " + std::to_string(stats.triangleCount) + " triangles, " +
+		std::to_string(stats.averageTriangles) + " triangles and " + std::to_string(stats.averageVertices) + " vertices on average, " +
+		std::to_string(stats.coneCount) + " with a backface cone, ACMR " + std::to_string(stats.acmrBefore) + " -> " + std::to_string(stats.acmrAfter) + ", " +
+		std::to_string(stats.buildTimeMs) + " ms";
+}
+
+std::string MeshletBuilder::FormatStats(const CullStats& stats)
+{
+	float rejected = stats.triangleCount > 0 ? 100.0f * (float)stats.trianglesCulled / (float)stats.triangleCount : 0.0f;
+	return "Meshlet culling: " + std::to_string(stats.meshletCount) + " meshlets, " + std::to_string(stats.frustumCulled) + " outside the frustum, " +
+		std::to_string(stats.coneCulled) + " back facing, " + std::to_string((int)(rejected + 0.5f)) + "% of " +
+		std::to_string(stats.triangleCount) + " triangles rejected";
+}
@@ -0,0 +1,83 @@
+#ifndef MESHLET_BUILDER_H
+#define MESHLET_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MeshTypes.h"
+
+// Meshlets (clusters) for LOD 0 of an indexed mesh, and their CPU culling.
+// - A meshlet grows from a seed triangle over shared vertices: the next
+//   triangle is the adjacent one adding the fewest new vertices, ties going
+//   to the one closest to the meshlet's average normal. Meshlets that run out
+//   of neighbours while still small continue with the next unused triangle.
+// - Triangles are reordered within their submesh so every meshlet is one
+//   contiguous index range. Submesh ranges, bounds and vertices stay put.
+// - Every meshlet gets a bounding sphere and a backface normal cone with an
+//   apex, so the cone test holds for cameras close to the meshlet.
+class MeshletBuilder
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+	using Submesh = MeshTypes::Submesh;
+	using Meshlet = MeshTypes::Meshlet;
+
+	struct Settings
+	{
+		size_t maxVertices = 64;
+		size_t maxTriangles = 124;
+		float coneWeight = 0.5f;        // Preference for triangles facing along the meshlet's normal
+		unsigned int cacheSize = 16;    // Only for the ACMR reported in Stats
+	};
+
+	struct Stats
+	{
+		size_t meshletCount = 0;
+		size_t triangleCount = 0;
+		float averageTriangles = 0.0f;
+		float averageVertices = 0.0f;
+		size_t coneCount = 0;          // Meshlets narrow enough for the backface test
+		float acmrBefore = 0.0f;       // Post-transform cache misses per triangle, before and after the reorder
+		float acmrAfter = 0.0f;
+		double buildTimeMs = 0.0;
+	};
+
+	// Index range to draw with DrawIndexed.
+	struct DrawRange
+	{
+		uint32_t indexOffset;
+		uint32_t indexCount;
+	};
+
+	struct CullStats
+	{
+		size_t meshletCount = 0;
+		size_t frustumCulled = 0;
+		size_t coneCulled = 0;
+		size_t triangleCount = 0;
+		size_t trianglesCulled = 0;
+	};
+
+public:
+	// Builds the meshlets of the given submeshes, in submesh order, and
+	// reorders the triangles of each submesh to match. Returns false if an
+	// index is out of range.
+	static bool Build(const MeshVertex* vertices, size_t vertexCount, IndexType* indices, const Submesh* submeshes, size_t submeshCount,
+					  const Settings& settings, std::vector<Meshlet>& meshlets, Stats* stats = nullptr);
+
+	// Tests meshlets against six planes (inside where ax + by + cz + d >= 0,
+	// not necessarily normalized) and, if cameraPosition is given, against
+	// their backface cones. Planes and camera are in the meshlets' space. The
+	// visible meshlets are appended to ranges, neighbours merged into one range.
+	// The counts are added to stats, so one CullStats can cover a whole frame.
+	static void Cull(const Meshlet* meshlets, size_t meshletCount, const float planes[6][4], const float* cameraPosition,
+					 std::vector<DrawRange>& ranges, CullStats* stats = nullptr);
+
+	static std::string FormatStats(const Stats& stats);
+	static std::string FormatStats(const CullStats& stats);
+};
+
+#endif // MESHLET_BUILDER_H
@@ -0,0 +1,316 @@
+#include "TangentGenerator.h"
+#include "../../../Core/System/JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <emmintrin.h>
+
+namespace
+{
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+
+	// Weighted frame of a triangle, laid out so a vertex gathers each of its
+	// triangles with two aligned loads.
+	struct alignas(16) TriangleFrame
+	{
+		float tangent[3];
+		float bitangentX;
+		float bitangentYZ[2];
+		float padding[2];
+	};
+
+	// Computes the frames of triangles [first, first + 4). Lanes past
+	// triangleCount repeat the last triangle and are never read back.
+	// Returns how many of the real triangles have degenerate UVs.
+	size_t ComputeTriangleFrames(const MeshVertex* vertices, const IndexType* indices, size_t first, size_t triangleCount, TriangleFrame* frames)
+	{
+		alignas(16) float position[3][3][4];  // [corner][axis][lane]
+		alignas(16) float uv[3][2][4];
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			size_t triangle = std::min(first + lane, triangleCount - 1);
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const MeshVertex& vertex = vertices[indices[triangle * 3 + corner]];
+				position[corner][0][lane] = vertex.x;
+				position[corner][1][lane] = vertex.y;
+				position[corner][2][lane] = vertex.z;
+				uv[corner][0][lane] = vertex.tu;
+				uv[corner][1][lane] = vertex.tv;
+			}
+		}
+
+		__m128 e1[3], e2[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			__m128 p0 = _mm_load_ps(position[0][axis]);
+			e1[axis] = _mm_sub_ps(_mm_load_ps(position[1][axis]), p0);
+			e2[axis] = _mm_sub_ps(_mm_load_ps(position[2][axis]), p0);
+		}
+
+		__m128 u0 = _mm_load_ps(uv[0][0]);
+		__m128 v0 = _mm_load_ps(uv[0][1]);
+		__m128 du1 = _mm_sub_ps(_mm_load_ps(uv[1][0]), u0);
+		__m128 dv1 = _mm_sub_ps(_mm_load_ps(uv[1][1]), v0);
+		__m128 du2 = _mm_sub_ps(_mm_load_ps(uv[2][0]), u0);
+		__m128 dv2 = _mm_sub_ps(_mm_load_ps(uv[2][1]), v0);
+
+		// Tangent and bitangent scaled by the UV determinant.
+		__m128 determinant = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+		__m128 tangent[3], bitangent[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			tangent[axis] = _mm_sub_ps(_mm_mul_ps(dv2, e1[axis]), _mm_mul_ps(dv1, e2[axis]));
+			bitangent[axis] = _mm_sub_ps(_mm_mul_ps(du1, e2[axis]), _mm_mul_ps(du2, e1[axis]));
+		}
+
+		// Twice the triangle area, the weight of the frame.
+		__m128 cx = _mm_sub_ps(_mm_mul_ps(e1[1], e2[2]), _mm_mul_ps(e1[2], e2[1]));
+		__m128 cy = _mm_sub_ps(_mm_mul_ps(e1[2], e2[0]), _mm_mul_ps(e1[0], e2[2]));
+		__m128 cz = _mm_sub_ps(_mm_mul_ps(e1[0], e2[1]), _mm_mul_ps(e1[1], e2[0]));
+		__m128 area = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz)));
+
+		__m128 tangentLengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tangent[0], tangent[0]), _mm_mul_ps(tangent[1], tangent[1])), _mm_mul_ps(tangent[2], tangent[2]));
+		__m128 bitangentLengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(bitangent[0], bitangent[0]), _mm_mul_ps(bitangent[1], bitangent[1])), _mm_mul_ps(bitangent[2], bitangent[2]));
+
+		// Degenerate when the UV edges are (nearly) parallel, relative to their length.
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		__m128 uvScale = _mm_mul_ps(_mm_add_ps(_mm_and_ps(du1, absMask), _mm_and_ps(dv1, absMask)),
+									_mm_add_ps(_mm_and_ps(du2, absMask), _mm_and_ps(dv2, absMask)));
+		__m128 valid = _mm_cmpgt_ps(_mm_and_ps(determinant, absMask), _mm_mul_ps(uvScale, _mm_set1_ps(1.0e-7f)));
+		valid = _mm_and_ps(valid, _mm_cmpgt_ps(tangentLengthSq, _mm_set1_ps(FLT_MIN)));
+		valid = _mm_and_ps(valid, _mm_cmpgt_ps(bitangentLengthSq, _mm_set1_ps(FLT_MIN)));
+
+		// Normalize and weight in one multiply. Only the sign of the determinant
+		// matters (it flips the frame on mirrored UVs). Invalid lanes, NaNs
+		// included, are masked to zero.
+		__m128 sign = _mm_and_ps(determinant, signMask);
+		__m128 tangentScale = _mm_and_ps(_mm_xor_ps(_mm_div_ps(area, _mm_sqrt_ps(tangentLengthSq)), sign), valid);
+		__m128 bitangentScale = _mm_and_ps(_mm_xor_ps(_mm_div_ps(area, _mm_sqrt_ps(bitangentLengthSq)), sign), valid);
+
+		// Transpose from one register per component to one frame per triangle.
+		__m128 row0 = _mm_mul_ps(tangent[0], tangentScale);
+		__m128 row1 = _mm_mul_ps(tangent[1], tangentScale);
+		__m128 row2 = _mm_mul_ps(tangent[2], tangentScale);
+		__m128 row3 = _mm_mul_ps(bitangent[0], bitangentScale);
+		__m128 row4 = _mm_mul_ps(bitangent[1], bitangentScale);
+		__m128 row5 = _mm_mul_ps(bitangent[2], bitangentScale);
+		__m128 row6 = _mm_setzero_ps();
+		__m128 row7 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+		_MM_TRANSPOSE4_PS(row4, row5, row6, row7);
+
+		float* frame = frames[first].tangent;
+		_mm_store_ps(frame, row0);
+		_mm_store_ps(frame + 4, row4);
+		_mm_store_ps(frame + 8, row1);
+		_mm_store_ps(frame + 12, row5);
+		_mm_store_ps(frame + 16, row2);
+		_mm_store_ps(frame + 20, row6);
+		_mm_store_ps(frame + 24, row3);
+		_mm_store_ps(frame + 28, row7);
+
+		size_t realLanes = std::min<size_t>(4, triangleCount - first);
+		int validBits = _mm_movemask_ps(valid);
+		size_t degenerate = 0;
+		for (size_t lane = 0; lane < realLanes; lane++)
+		{
+			degenerate += (validBits >> lane) & 1 ? 0 : 1;
+		}
+		return degenerate;
+	}
+
+	// Orthonormalizes the summed frame against the vertex normal. Returns false
+	// if the tangent had to be made up.
+	bool FinalizeVertex(MeshVertex& vertex, const float sumTangent[4], const float sumBitangent[4])
+	{
+		float n[3] = { vertex.nx, vertex.ny, vertex.nz };
+		float normalLength = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (normalLength > 1.0e-12f)
+		{
+			n[0] /= normalLength;
+			n[1] /= normalLength;
+			n[2] /= normalLength;
+		}
+		else
+		{
+			n[0] = 0.0f;
+			n[1] = 0.0f;
+			n[2] = 1.0f;
+		}
+
+		// Gram-Schmidt: drop the part of the tangent along the normal.
+		float sumLength = std::sqrt(sumTangent[0] * sumTangent[0] + sumTangent[1] * sumTangent[1] + sumTangent[2] * sumTangent[2]);
+		float d = n[0] * sumTangent[0] + n[1] * sumTangent[1] + n[2] * sumTangent[2];
+		float t[3] = { sumTangent[0] - n[0] * d, sumTangent[1] - n[1] * d, sumTangent[2] - n[2] * d };
+		float length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+
+		bool derived = length > 1.0e-4f * sumLength && sumLength > 0.0f;
+		if (!derived)
+		{
+			// No usable UV gradient, any direction perpendicular to the normal will do.
+			int axis = std::fabs(n[0]) < std::fabs(n[1]) ? (std::fabs(n[0]) < std::fabs(n[2]) ? 0 : 2) : (std::fabs(n[1]) < std::fabs(n[2]) ? 1 : 2);
+			t[0] = -n[0] * n[axis];
+			t[1] = -n[1] * n[axis];
+			t[2] = -n[2] * n[axis];
+			t[axis] += 1.0f;
+			length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+		}
+
+		t[0] /= length;
+		t[1] /= length;
+		t[2] /= length;
+
+		float b[3] = { n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0] };
+		float handedness = b[0] * sumBitangent[0] + b[1] * sumBitangent[1] + b[2] * sumBitangent[2] < 0.0f ? -1.0f : 1.0f;
+
+		vertex.tx = t[0];
+		vertex.ty = t[1];
+		vertex.tz = t[2];
+		vertex.bx = b[0] * handedness;
+		vertex.by = b[1] * handedness;
+		vertex.bz = b[2] * handedness;
+
+		return derived;
+	}
+}
+
+bool TangentGenerator::Generate(MeshVertex* vertices, size_t vertexCount, const IndexType* indices, size_t indexCount,
+								const Settings& settings, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if (!vertices || vertexCount == 0)
+	{
+		if (stats)
+		{
+			*stats = Stats();
+		}
+		return true;
+	}
+
+	// Unindexed vertices are their own triangle list.
+	std::vector<IndexType> sequentialIndices;
+	if (!indices)
+	{
+		indexCount = vertexCount - vertexCount % 3;
+		sequentialIndices.resize(indexCount);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			sequentialIndices[i] = (IndexType)i;
+		}
+		indices = sequentialIndices.data();
+	}
+
+	size_t triangleCount = indexCount / 3;
+	size_t cornerCount = triangleCount * 3;
+
+	// Vertex to triangle adjacency, which also validates the indices. Triangles
+	// are listed in ascending order, so the sums below are deterministic.
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < cornerCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			return false;
+		}
+		triangleOffsets[indices[i] + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		triangleOffsets[v + 1] += triangleOffsets[v];
+	}
+
+	std::vector<uint32_t> vertexTriangles(cornerCount);
+	std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+	for (size_t i = 0; i < cornerCount; i++)
+	{
+		vertexTriangles[cursor[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	auto run = [&settings](size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& func)
+	{
+		if (settings.multithreaded)
+		{
+			JobSystem::GetInstance().ParallelFor(count, minBatchSize, func);
+		}
+		else if (count > 0)
+		{
+			func(0, count);
+		}
+	};
+
+	// Triangle pass, four triangles per SSE batch. Padded to a multiple of four.
+	size_t groupCount = (triangleCount + 3) / 4;
+	std::unique_ptr<TriangleFrame[]> frames(new TriangleFrame[groupCount * 4]);
+
+	std::atomic<size_t> degenerateTriangles(0);
+	run(groupCount, std::max<size_t>(settings.minBatchSize / 4, 1), [&](size_t firstGroup, size_t lastGroup)
+	{
+		size_t degenerate = 0;
+		for (size_t group = firstGroup; group < lastGroup; group++)
+		{
+			degenerate += ComputeTriangleFrames(vertices, indices, group * 4, triangleCount, frames.get());
+		}
+		degenerateTriangles += degenerate;
+	});
+
+	// Vertex pass, every vertex sums the frames of its own triangles.
+	std::atomic<size_t> fallbackVertices(0);
+	run(vertexCount, std::max<size_t>(settings.minBatchSize, 1), [&](size_t first, size_t last)
+	{
+		size_t fallback = 0;
+		for (size_t v = first; v < last; v++)
+		{
+			__m128 tangentSum = _mm_setzero_ps();    // tx, ty, tz, bx
+			__m128 bitangentSum = _mm_setzero_ps();  // by, bz, 0, 0
+			for (uint32_t k = triangleOffsets[v]; k < triangleOffsets[v + 1]; k++)
+			{
+				const float* frame = frames[vertexTriangles[k]].tangent;
+				tangentSum = _mm_add_ps(tangentSum, _mm_load_ps(frame));
+				bitangentSum = _mm_add_ps(bitangentSum, _mm_load_ps(frame + 4));
+			}
+
+			alignas(16) float sums[8];
+			_mm_store_ps(sums, tangentSum);
+			_mm_store_ps(sums + 4, bitangentSum);
+			const float sumTangent[4] = { sums[0], sums[1], sums[2], 0.0f };
+			const float sumBitangent[4] = { sums[3], sums[4], sums[5], 0.0f };
+
+			if (!FinalizeVertex(vertices[v], sumTangent, sumBitangent))
+			{
+				fallback++;
+			}
+		}
+		fallbackVertices += fallback;
+	});
+
+	if (stats)
+	{
+		stats->triangleCount = triangleCount;
+		stats->vertexCount = vertexCount;
+		stats->degenerateTriangles = degenerateTriangles.load();
+		stats->fallbackVertices = fallbackVertices.load();
+		stats->generateTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+
+	return true;
+}
+
+std::string TangentGenerator::FormatStats(const Stats& stats)
+{
+	return "Tangent generation: " + std::to_string(stats.triangleCount) + " triangles, " +
+		std::to_string(stats.vertexCount) + " vertices, " +
+		std::to_string(stats.degenerateTriangles) + " degenerate UV triangles, " +
+		std::to_string(stats.fallbackVertices) + " fallback tangents, " +
+		std::to_string(stats.generateTimeMs) + " ms";
+}
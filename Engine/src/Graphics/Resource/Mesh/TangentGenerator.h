@@ -0,0 +1,50 @@
+#ifndef TANGENT_GENERATOR_H
+#define TANGENT_GENERATOR_H
+
+#include <cstddef>
+#include <string>
+
+#include "MeshTypes.h"
+
+// Per-vertex tangent frames for indexed triangle lists.
+// - Every triangle contributes its UV-space tangent and bitangent, normalized
+//   and weighted by the triangle area, to each of its three vertices.
+// - Triangles are processed four at a time with SSE, spread over the job
+//   system; vertices gather their triangles afterwards, so the result does not
+//   depend on the thread count.
+// - The sums are orthonormalized against the vertex normal (Gram-Schmidt) and
+//   the bitangent is rebuilt as cross(normal, tangent) times the handedness.
+// - Triangles with degenerate UVs contribute nothing. Vertices left without a
+//   usable tangent get an arbitrary one perpendicular to the normal.
+class TangentGenerator
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
+
+	struct Settings
+	{
+		bool multithreaded = true;
+		size_t minBatchSize = 8192;   // Triangles or vertices per job
+	};
+
+	struct Stats
+	{
+		size_t triangleCount = 0;
+		size_t vertexCount = 0;
+		size_t degenerateTriangles = 0;   // Zero area in UV space
+		size_t fallbackVertices = 0;      // Tangent derived from the normal alone
+		double generateTimeMs = 0.0;
+	};
+
+public:
+	// Overwrites the tangent and binormal of every vertex. If indices is null
+	// the vertices are treated as a plain triangle list. Returns false if an
+	// index is out of range.
+	static bool Generate(MeshVertex* vertices, size_t vertexCount, const IndexType* indices, size_t indexCount,
+						 const Settings& settings, Stats* stats = nullptr);
+
+	static std::string FormatStats(const Stats& stats);
+};
+
+#endif // TANGENT_GENERATOR_H
@@ -0,0 +1,261 @@
+#include "TextModelParser.h"
+#include "../../../Core/System/JobSystem.h"
+#include "../../../Core/System/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+	// Chunks smaller than this are not worth handing to another thread.
+	const size_t MIN_CHUNK_BYTES = 64 * 1024;
+
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+	}
+
+	// Calls tokenFunc(begin, end) for every whitespace separated token in the
+	// range, skipping "//" comments up to the end of the line. Returns false as
+	// soon as tokenFunc does.
+	template<typename TokenFunc>
+	bool ForEachToken(const char* p, const char* end, TokenFunc tokenFunc)
+	{
+		while (p < end)
+		{
+			if (IsSpace(*p))
+			{
+				p++;
+				continue;
+			}
+
+			if (*p == '/' && p + 1 < end && p[1] == '/')
+			{
+				while (p < end && *p != '\n')
+				{
+					p++;
+				}
+				continue;
+			}
+
+			const char* tokenStart = p;
+			while (p < end && !IsSpace(*p))
+			{
+				p++;
+			}
+
+			if (!tokenFunc(tokenStart, p))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// operator>> accepts a leading '+', std::from_chars does not.
+	inline bool ParseFloat(const char* begin, const char* end, float& value)
+	{
+		if (begin < end && *begin == '+')
+		{
+			begin++;
+		}
+
+		std::from_chars_result result = std::from_chars(begin, end, value);
+		return result.ec == std::errc() && result.ptr == end;
+	}
+}
+
+TextModelParser::TextModelParser()
+{
+	m_vertexCount = 0;
+	m_dataOffset = 0;
+}
+
+TextModelParser::~TextModelParser()
+{
+	Close();
+}
+
+bool TextModelParser::Open(const std::string& filename)
+{
+	Close();
+
+	if (!m_file.Open(filename))
+	{
+		return false;
+	}
+	m_filename = filename;
+
+	const char* begin = reinterpret_cast<const char*>(m_file.GetData());
+	const char* end = begin + m_file.GetSize();
+
+	// Read up to the value of vertex count.
+	const char* p = std::find(begin, end, ':');
+	if (p == end)
+	{
+		LOG_ERROR("TextModelParser - Missing vertex count in " + filename);
+		Close();
+		return false;
+	}
+	p++;
+	while (p < end && IsSpace(*p))
+	{
+		p++;
+	}
+
+	// Read in the vertex count.
+	std::from_chars_result result = std::from_chars(p, end, m_vertexCount);
+	if (result.ec != std::errc())
+	{
+		LOG_ERROR("TextModelParser - Invalid vertex count in " + filename);
+		Close();
+		return false;
+	}
+
+	// Read up to the beginning of the data.
+	p = std::find(result.ptr, end, ':');
+	if (p == end)
+	{
+		LOG_ERROR("TextModelParser - Missing data section in " + filename);
+		Close();
+		return false;
+	}
+	m_dataOffset = (size_t)(p + 1 - begin);
+
+	return true;
+}
+
+void TextModelParser::Close()
+{
+	m_file.Close();
+	m_filename.clear();
+	m_vertexCount = 0;
+	m_dataOffset = 0;
+}
+
+bool TextModelParser::Parse(float* destination, size_t strideInFloats, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if (!m_file.IsOpen() || !destination || strideInFloats < FLOATS_PER_VERTEX)
+	{
+		return false;
+	}
+
+	const char* data = reinterpret_cast<const char*>(m_file.GetData()) + m_dataOffset;
+	const char* end = reinterpret_cast<const char*>(m_file.GetData()) + m_file.GetSize();
+	size_t dataSize = (size_t)(end - data);
+
+	// Split the data section into chunks that each end on a line break.
+	JobSystem& jobSystem = JobSystem::GetInstance();
+	size_t targetChunkBytes = std::max(MIN_CHUNK_BYTES, dataSize / ((jobSystem.GetWorkerCount() + 1) * 4) + 1);
+
+	std::vector<const char*> chunkStarts;
+	chunkStarts.push_back(data);
+	for (const char* p = data + targetChunkBytes; p < end; p += targetChunkBytes)
+	{
+		p = std::find(p, end, '\n');
+		if (p == end)
+		{
+			break;
+		}
+		p++;
+		chunkStarts.push_back(p);
+	}
+	chunkStarts.push_back(end);
+	size_t chunkCount = chunkStarts.size() - 1;
+
+	// First pass: count the values in every chunk so each one knows where its
+	// output starts.
+	std::vector<size_t> chunkOffsets(chunkCount + 1, 0);
+	jobSystem.ParallelFor(chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t c = first; c < last; c++)
+		{
+			size_t count = 0;
+			ForEachToken(chunkStarts[c], chunkStarts[c + 1], [&count](const char*, const char*) { count++; return true; });
+			chunkOffsets[c + 1] = count;
+		}
+	});
+
+	for (size_t c = 0; c < chunkCount; c++)
+	{
+		chunkOffsets[c + 1] += chunkOffsets[c];
+	}
+
+	size_t floatCount = m_vertexCount * FLOATS_PER_VERTEX;
+	if (chunkOffsets[chunkCount] < floatCount)
+	{
+		LOG_ERROR("TextModelParser - " + m_filename + " declares " + std::to_string(m_vertexCount) + " vertices but only contains " +
+			std::to_string(chunkOffsets[chunkCount] / FLOATS_PER_VERTEX));
+		return false;
+	}
+
+	// Second pass: parse the values straight into their vertices. Anything past
+	// the declared vertex count is ignored, like the stream based loader did.
+	std::atomic<bool> valid(true);
+	jobSystem.ParallelFor(chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t c = first; c < last && valid.load(std::memory_order_relaxed); c++)
+		{
+			size_t index = chunkOffsets[c];
+			if (index >= floatCount)
+			{
+				continue;
+			}
+
+			bool chunkValid = ForEachToken(chunkStarts[c], chunkStarts[c + 1], [&](const char* tokenBegin, const char* tokenEnd)
+			{
+				if (index >= floatCount)
+				{
+					return false;
+				}
+
+				float& value = destination[(index / FLOATS_PER_VERTEX) * strideInFloats + (index % FLOATS_PER_VERTEX)];
+				if (!ParseFloat(tokenBegin, tokenEnd, value))
+				{
+					return false;
+				}
+				index++;
+				return true;
+			});
+
+			if (!chunkValid && index < floatCount)
+			{
+				valid = false;
+			}
+		}
+	});
+
+	if (!valid)
+	{
+		LOG_ERROR("TextModelParser - Invalid number in " + m_filename);
+		return false;
+	}
+
+	if (stats)
+	{
+		stats->fileBytes = m_file.GetSize();
+		stats->vertexCount = m_vertexCount;
+		stats->chunkCount = chunkCount;
+
+		auto endTime = std::chrono::high_resolution_clock::now();
+		stats->parseTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	}
+
+	return true;
+}
+
+std::string TextModelParser::FormatStats(const Stats& stats)
+{
+	double seconds = stats.parseTimeMs / 1000.0;
+	double megabytesPerSecond = seconds > 0.0 ? ((double)stats.fileBytes / (1024.0 * 1024.0)) / seconds : 0.0;
+	double verticesPerSecond = seconds > 0.0 ? (double)stats.vertexCount / seconds : 0.0;
+
+	return "Text model parse: " + std::to_string(stats.vertexCount) + " vertices, " +
+		std::to_string(stats.fileBytes / 1024) + " KB in " + std::to_string(stats.chunkCount) + " chunks, " +
+		std::to_string(stats.parseTimeMs) + " ms (" + std::to_string(megabytesPerSecond) + " MB/s, " +
+		std::to_string(verticesPerSecond / 1.0e6) + " M vertices/s)";
+}
@@ -0,0 +1,56 @@
+#ifndef TEXT_MODEL_PARSER_H
+#define TEXT_MODEL_PARSER_H
+
+#include <cstddef>
+#include <string>
+
+#include "../../../Core/System/MappedFile.h"
+
+// Parser for the legacy text model format:
+//
+//   Vertex Count: N
+//
+//   Data:
+//
+//   x y z tu tv nx ny nz   (N lines)
+//
+// The file is memory mapped and the data section is split into line aligned
+// chunks that are parsed on the job system with std::from_chars. Lines
+// starting with "//" are treated as comments.
+class TextModelParser
+{
+public:
+	static const size_t FLOATS_PER_VERTEX = 8;
+
+	struct Stats
+	{
+		size_t fileBytes = 0;
+		size_t vertexCount = 0;
+		size_t chunkCount = 0;
+		double parseTimeMs = 0.0;
+	};
+
+public:
+	TextModelParser();
+	~TextModelParser();
+
+	// Maps the file and reads the vertex count from the header.
+	bool Open(const std::string& filename);
+	void Close();
+
+	size_t GetVertexCount() const { return m_vertexCount; }
+
+	// Writes FLOATS_PER_VERTEX floats for every vertex to destination,
+	// advancing strideInFloats floats per vertex.
+	bool Parse(float* destination, size_t strideInFloats, Stats* stats = nullptr);
+
+	static std::string FormatStats(const Stats& stats);
+
+private:
+	MappedFile m_file;
+	std::string m_filename;
+	size_t m_vertexCount;
+	size_t m_dataOffset;
+};
+
+#endif // TEXT_MODEL_PARSER_H
@@ -0,0 +1,414 @@
+#include "VertexCompressor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const float RADIANS_TO_DEGREES = 57.29577951f;
+
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	inline float Dot(const Vector3& a, const Vector3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	inline Vector3 Cross(const Vector3& a, const Vector3& b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	inline Vector3 Normalize(const Vector3& v)
+	{
+		float length = std::sqrt(Dot(v, v));
+		return length > 0.0f ? Vector3{ v.x / length, v.y / length, v.z / length } : Vector3{ 0.0f, 0.0f, 0.0f };
+	}
+
+	// atan2 rather than acos, which cannot resolve small angles in float.
+	inline float AngleDegrees(const Vector3& a, const Vector3& b)
+	{
+		Vector3 c = Cross(a, b);
+		return std::atan2(std::sqrt(Dot(c, c)), Dot(a, b)) * RADIANS_TO_DEGREES;
+	}
+
+	// Tangent made orthogonal to the normal; any perpendicular if it degenerates.
+	Vector3 OrthogonalTangent(const Vector3& normal, const Vector3& tangent)
+	{
+		float d = Dot(normal, tangent);
+		Vector3 t = Normalize({ tangent.x - normal.x * d, tangent.y - normal.y * d, tangent.z - normal.z * d });
+		if (Dot(t, t) > 0.0f)
+		{
+			return t;
+		}
+
+		Vector3 axis = std::fabs(normal.x) < 0.9f ? Vector3{ 1.0f, 0.0f, 0.0f } : Vector3{ 0.0f, 1.0f, 0.0f };
+		return Normalize(Cross(axis, normal));
+	}
+
+	inline int8_t ToSnorm8(float value)
+	{
+		return (int8_t)std::lround(std::max(-1.0f, std::min(1.0f, value)) * 127.0f);
+	}
+
+	// Quaternion of the rotation whose columns are tangent, bitangent and normal,
+	// with the handedness folded into the sign.
+	void EncodeTangentFrame(const Vector3& t, const Vector3& b, const Vector3& n, float handedness, int8_t encoded[4])
+	{
+		float m00 = t.x, m01 = b.x, m02 = n.x;
+		float m10 = t.y, m11 = b.y, m12 = n.y;
+		float m20 = t.z, m21 = b.z, m22 = n.z;
+		float q[4];
+
+		float trace = m00 + m11 + m22;
+		if (trace > 0.0f)
+		{
+			float s = std::sqrt(trace + 1.0f) * 2.0f;
+			q[3] = 0.25f * s;
+			q[0] = (m21 - m12) / s;
+			q[1] = (m02 - m20) / s;
+			q[2] = (m10 - m01) / s;
+		}
+		else if (m00 > m11 && m00 > m22)
+		{
+			float s = std::sqrt(1.0f + m00 - m11 - m22) * 2.0f;
+			q[3] = (m21 - m12) / s;
+			q[0] = 0.25f * s;
+			q[1] = (m01 + m10) / s;
+			q[2] = (m02 + m20) / s;
+		}
+		else if (m11 > m22)
+		{
+			float s = std::sqrt(1.0f + m11 - m00 - m22) * 2.0f;
+			q[3] = (m02 - m20) / s;
+			q[0] = (m01 + m10) / s;
+			q[1] = 0.25f * s;
+			q[2] = (m12 + m21) / s;
+		}
+		else
+		{
+			float s = std::sqrt(1.0f + m22 - m00 - m11) * 2.0f;
+			q[3] = (m10 - m01) / s;
+			q[0] = (m02 + m20) / s;
+			q[1] = (m12 + m21) / s;
+			q[2] = 0.25f * s;
+		}
+
+		// q and -q are the same rotation, so w can be made positive and its sign reused.
+		float sign = q[3] < 0.0f ? -1.0f : 1.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			encoded[i] = ToSnorm8(q[i] * sign);
+		}
+
+		// A zero w would lose the sign.
+		encoded[3] = std::max<int8_t>(encoded[3], 1);
+
+		if (handedness < 0.0f)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				encoded[i] = (int8_t)-encoded[i];
+			}
+		}
+	}
+
+	// Tangent of the encoded frame and its handedness.
+	void DecodeTangentFrame(const int8_t encoded[4], Vector3& tangent, float& handedness)
+	{
+		float x = encoded[0] / 127.0f, y = encoded[1] / 127.0f, z = encoded[2] / 127.0f, w = encoded[3] / 127.0f;
+		handedness = w < 0.0f ? -1.0f : 1.0f;
+
+		float length = std::sqrt(x * x + y * y + z * z + w * w);
+		x /= length;
+		y /= length;
+		z /= length;
+		w /= length;
+
+		tangent = { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y) };
+	}
+}
+
+bool VertexCompressor::Compress(const MeshVertex* vertices, size_t vertexCount, std::vector<CompactVertex>& outVertices,
+								VertexQuantization& quantization, Stats* stats)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	outVertices.clear();
+	if (!vertices || vertexCount == 0)
+	{
+		return false;
+	}
+
+	float minimum[3] = { vertices[0].x, vertices[0].y, vertices[0].z };
+	float maximum[3] = { vertices[0].x, vertices[0].y, vertices[0].z };
+	for (size_t i = 1; i < vertexCount; i++)
+	{
+		const float position[3] = { vertices[i].x, vertices[i].y, vertices[i].z };
+		for (int k = 0; k < 3; k++)
+		{
+			minimum[k] = std::min(minimum[k], position[k]);
+			maximum[k] = std::max(maximum[k], position[k]);
+		}
+	}
+
+	for (int k = 0; k < 3; k++)
+	{
+		quantization.positionOffset[k] = minimum[k];
+		quantization.positionScale[k] = maximum[k] - minimum[k];
+	}
+
+	outVertices.resize(vertexCount);
+
+	Stats localStats;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const MeshVertex& vertex = vertices[i];
+		CompactVertex& compact = outVertices[i];
+
+		const float position[3] = { vertex.x, vertex.y, vertex.z };
+		for (int k = 0; k < 3; k++)
+		{
+			float scale = quantization.positionScale[k];
+			float unorm = scale > 0.0f ? (position[k] - minimum[k]) / scale : 0.0f;
+			compact.position[k] = (uint16_t)std::lround(std::max(0.0f, std::min(1.0f, unorm)) * 65535.0f);
+		}
+		compact.position[3] = 0;
+
+		compact.texture[0] = FloatToHalf(vertex.tu);
+		compact.texture[1] = FloatToHalf(vertex.tv);
+
+		Vector3 normal = Normalize({ vertex.nx, vertex.ny, vertex.nz });
+		if (Dot(normal, normal) == 0.0f)
+		{
+			normal = { 0.0f, 0.0f, 1.0f };
+		}
+		EncodeOctahedral(normal.x, normal.y, normal.z, compact.normal);
+
+		Vector3 inputBitangent = { vertex.bx, vertex.by, vertex.bz };
+		Vector3 tangent = OrthogonalTangent(normal, { vertex.tx, vertex.ty, vertex.tz });
+		Vector3 bitangent = Cross(normal, tangent);
+		float handedness = Dot(bitangent, inputBitangent) < 0.0f ? -1.0f : 1.0f;
+		EncodeTangentFrame(tangent, bitangent, normal, handedness, compact.tangentFrame);
+
+		// Measure against what the shader will reconstruct.
+		MeshVertex decoded = Decode(compact, quantization);
+
+		float dx = decoded.x - vertex.x, dy = decoded.y - vertex.y, dz = decoded.z - vertex.z;
+		localStats.maxPositionError = std::max(localStats.maxPositionError, std::sqrt(dx * dx + dy * dy + dz * dz));
+		localStats.maxUVError = std::max(localStats.maxUVError, std::max(std::fabs(decoded.tu - vertex.tu), std::fabs(decoded.tv - vertex.tv)));
+		localStats.maxNormalError = std::max(localStats.maxNormalError, AngleDegrees(normal, { decoded.nx, decoded.ny, decoded.nz }));
+		localStats.maxTangentError = std::max(localStats.maxTangentError, AngleDegrees(tangent, { decoded.tx, decoded.ty, decoded.tz }));
+		if (Dot(inputBitangent, inputBitangent) > 0.0f && Dot(inputBitangent, { decoded.bx, decoded.by, decoded.bz }) < 0.0f)
+		{
+			localStats.handednessErrors++;
+		}
+	}
+
+	if (stats)
+	{
+		auto endTime = std::chrono::high_resolution_clock::now();
+
+		*stats = localStats;
+		stats->vertexCount = vertexCount;
+		stats->inputBytes = vertexCount * sizeof(MeshVertex);
+		stats->outputBytes = vertexCount * sizeof(CompactVertex);
+		stats->compressTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	}
+
+	return true;
+}
+
+VertexCompressor::MeshVertex VertexCompressor::Decode(const CompactVertex& vertex, const VertexQuantization& quantization)
+{
+	MeshVertex decoded;
+
+	decoded.x = quantization.positionOffset[0] + vertex.position[0] / 65535.0f * quantization.positionScale[0];
+	decoded.y = quantization.positionOffset[1] + vertex.position[1] / 65535.0f * quantization.positionScale[1];
+	decoded.z = quantization.positionOffset[2] + vertex.position[2] / 65535.0f * quantization.positionScale[2];
+
+	decoded.tu = HalfToFloat(vertex.texture[0]);
+	decoded.tv = HalfToFloat(vertex.texture[1]);
+
+	DecodeOctahedral(vertex.normal, decoded.nx, decoded.ny, decoded.nz);
+	Vector3 normal = { decoded.nx, decoded.ny, decoded.nz };
+
+	// The quaternion is coarser than the octahedral normal, so only its
+	// tangent is used, made orthogonal to the normal again.
+	Vector3 frameTangent;
+	float handedness;
+	DecodeTangentFrame(vertex.tangentFrame, frameTangent, handedness);
+	Vector3 tangent = OrthogonalTangent(normal, frameTangent);
+	Vector3 bitangent = Cross(normal, tangent);
+
+	decoded.tx = tangent.x;
+	decoded.ty = tangent.y;
+	decoded.tz = tangent.z;
+	decoded.bx = bitangent.x * handedness;
+	decoded.by = bitangent.y * handedness;
+	decoded.bz = bitangent.z * handedness;
+
+	return decoded;
+}
+
+std::string VertexCompressor::FormatStats(const Stats& stats)
+{
+	return "Vertex compression: " + std::to_string(stats.vertexCount) + " vertices, " +
+		std::to_string(stats.inputBytes / 1024) + " KB -> " + std::to_string(stats.outputBytes / 1024) + " KB, max error position " +
+		std::to_string(stats.maxPositionError) + ", uv " + std::to_string(stats.maxUVError) + ", normal " +
+		std::to_string(stats.maxNormalError) + " deg, tangent " + std::to_string(stats.maxTangentError) + " deg, " +
+		std::to_string(stats.handednessErrors) + " handedness flips, " + std::to_string(stats.compressTimeMs) + " ms";
+}
+
+uint16_t VertexCompressor::FloatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000u;
+	uint32_t exponent = (bits >> 23) & 0xFFu;
+	uint32_t mantissa = bits & 0x7FFFFFu;
+
+	// Infinity and NaN
+	if (exponent == 0xFFu)
+	{
+		return (uint16_t)(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+	}
+
+	int halfExponent = (int)exponent - 127 + 15;
+
+	// Too large, clamp to the largest finite half.
+	if (halfExponent >= 31)
+	{
+		return (uint16_t)(sign | 0x7BFFu);
+	}
+
+	// Denormal or zero, round to nearest even.
+	if (halfExponent <= 0)
+	{
+		if (halfExponent < -10)
+		{
+			return (uint16_t)sign;
+		}
+
+		mantissa |= 0x800000u;
+		uint32_t shift = (uint32_t)(14 - halfExponent);
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1u);
+		uint32_t halfway = 1u << (shift - 1u);
+		if (remainder > halfway || (remainder == halfway && (half & 1u)))
+		{
+			half++;
+		}
+		return (uint16_t)(sign | half);
+	}
+
+	uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1FFFu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+	{
+		half++;
+	}
+
+	// Rounding up may carry into the infinity exponent.
+	return (uint16_t)(sign | std::min(half, 0x7BFFu));
+}
+
+float VertexCompressor::HalfToFloat(uint16_t value)
+{
+	uint32_t sign = (uint32_t)(value & 0x8000u) << 16;
+	uint32_t exponent = (value >> 10) & 0x1Fu;
+	uint32_t mantissa = value & 0x3FFu;
+	uint32_t bits;
+
+	if (exponent == 0)
+	{
+		float denormal = std::ldexp((float)mantissa, -24);
+		return sign ? -denormal : denormal;
+	}
+
+	if (exponent == 31)
+	{
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+void VertexCompressor::EncodeOctahedral(float nx, float ny, float nz, int16_t encoded[2])
+{
+	float l1 = std::fabs(nx) + std::fabs(ny) + std::fabs(nz);
+	if (l1 <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float px = nx / l1;
+	float py = ny / l1;
+
+	// Fold the lower hemisphere over the diagonals.
+	if (nz < 0.0f)
+	{
+		float foldedX = (1.0f - std::fabs(py)) * (px >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - std::fabs(px)) * (py >= 0.0f ? 1.0f : -1.0f);
+		px = foldedX;
+		py = foldedY;
+	}
+
+	// Plain rounding is not always the closest direction, try the four neighbouring grid points.
+	Vector3 normal = Normalize({ nx, ny, nz });
+	float baseX = std::floor(px * 32767.0f);
+	float baseY = std::floor(py * 32767.0f);
+	float bestDot = -2.0f;
+
+	for (int dy = 0; dy < 2; dy++)
+	{
+		for (int dx = 0; dx < 2; dx++)
+		{
+			int16_t candidate[2] =
+			{
+				(int16_t)std::max(-32767.0f, std::min(32767.0f, baseX + (float)dx)),
+				(int16_t)std::max(-32767.0f, std::min(32767.0f, baseY + (float)dy))
+			};
+
+			Vector3 decoded;
+			DecodeOctahedral(candidate, decoded.x, decoded.y, decoded.z);
+			float dot = Dot(decoded, normal);
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+}
+
+void VertexCompressor::DecodeOctahedral(const int16_t encoded[2], float& nx, float& ny, float& nz)
+{
+	float x = std::max(encoded[0] / 32767.0f, -1.0f);
+	float y = std::max(encoded[1] / 32767.0f, -1.0f);
+	float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+	// Unfold the lower hemisphere.
+	float t = std::max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+
+	Vector3 normal = Normalize({ x, y, z });
+	nx = normal.x;
+	ny = normal.y;
+	nz = normal.z;
+}
@@ -0,0 +1,52 @@
+#ifndef VERTEX_COMPRESSOR_H
+#define VERTEX_COMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MeshTypes.h"
+
+// Encodes MeshVertex data into the 20 byte CompactVertex layout and reports
+// the error the encoding introduces. The decode side lives in the shaders
+// (COMPACT_VERTEX variants); Decode here mirrors it for validation.
+class VertexCompressor
+{
+public:
+	using MeshVertex = MeshTypes::MeshVertex;
+	using CompactVertex = MeshTypes::CompactVertex;
+	using VertexQuantization = MeshTypes::VertexQuantization;
+
+	struct Stats
+	{
+		size_t vertexCount = 0;
+		size_t inputBytes = 0;
+		size_t outputBytes = 0;
+		float maxPositionError = 0.0f;  // Object space units
+		float maxUVError = 0.0f;
+		float maxNormalError = 0.0f;    // Degrees
+		float maxTangentError = 0.0f;   // Degrees, against the orthonormalized input tangent
+		size_t handednessErrors = 0;    // Vertices whose bitangent flipped side
+		double compressTimeMs = 0.0;
+	};
+
+public:
+	// Compresses the vertices against their own bounding box. quantization
+	// receives the constants the shader needs to decode the positions.
+	static bool Compress(const MeshVertex* vertices, size_t vertexCount, std::vector<CompactVertex>& outVertices,
+						 VertexQuantization& quantization, Stats* stats = nullptr);
+
+	// Reconstructs a full vertex the way the COMPACT_VERTEX shaders do.
+	static MeshVertex Decode(const CompactVertex& vertex, const VertexQuantization& quantization);
+
+	static std::string FormatStats(const Stats& stats);
+
+	// Building blocks
+	static uint16_t FloatToHalf(float value);
+	static float HalfToFloat(uint16_t value);
+	static void EncodeOctahedral(float nx, float ny, float nz, int16_t encoded[2]);
+	static void DecodeOctahedral(const int16_t encoded[2], float& nx, float& ny, float& nz);
+};
+
+#endif // VERTEX_COMPRESSOR_H
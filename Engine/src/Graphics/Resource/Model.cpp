@@ -1,6 +1,131 @@
 #include "model.h"
 #include <algorithm>
+#include <chrono>
 #include "../../Core/System/Logger.h"
+#include "./Mesh/TextModelParser.h"
+#include "./ResourceCache.h"
+#include "./TextureDirectoryIndex.h"
+#include "./Animation/AnimationSampler.h"
+
+// Cooked vertex data is handed to CreateBuffer as-is.
+static_assert(sizeof(MeshTypes::MeshVertex) == sizeof(EngineTypes::VertexType), "MeshVertex must match the GPU vertex layout");
+
+// FBX matrices transform row vectors, JointMatrix column vectors.
+static AnimationTypes::JointMatrix ToJointMatrix(const FbxAMatrix& fbxMatrix)
+{
+	AnimationTypes::JointMatrix matrix;
+
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			matrix.m[row][column] = (float)fbxMatrix.Get(column, row);
+		}
+	}
+
+	return matrix;
+}
+
+static AnimationTypes::Transform ToTransform(const FbxAMatrix& fbxMatrix)
+{
+	AnimationTypes::Transform transform;
+	FbxVector4 translation = fbxMatrix.GetT();
+	FbxQuaternion rotation = fbxMatrix.GetQ();
+	FbxVector4 scale = fbxMatrix.GetS();
+
+	for (int i = 0; i < 3; i++)
+	{
+		transform.translation[i] = (float)translation[i];
+		transform.scale[i] = (float)scale[i];
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		transform.rotation[i] = (float)rotation[i];
+	}
+
+	return transform;
+}
+
+// Transform relative to the parent joint. Going through the global transforms
+// takes in any nodes between the joints, like the armature above the root.
+static FbxAMatrix GetJointLocalTransform(FbxNode* node, FbxNode* parentJoint, FbxTime time = FBXSDK_TIME_INFINITE)
+{
+	if (!parentJoint)
+	{
+		return node->EvaluateGlobalTransform(time);
+	}
+
+	return parentJoint->EvaluateGlobalTransform(time).Inverse() * node->EvaluateGlobalTransform(time);
+}
+
+static std::string& GetMaterialTexturePath(EngineTypes::MaterialInfo& materialInfo, TextureDirectoryIndex::TextureType type)
+{
+	switch (type)
+	{
+	case TextureDirectoryIndex::TYPE_NORMAL: return materialInfo.normalTexturePath;
+	case TextureDirectoryIndex::TYPE_SPECULAR: return materialInfo.specularTexturePath;
+	case TextureDirectoryIndex::TYPE_ROUGHNESS: return materialInfo.roughnessTexturePath;
+	case TextureDirectoryIndex::TYPE_METALLIC: return materialInfo.metallicTexturePath;
+	case TextureDirectoryIndex::TYPE_EMISSION: return materialInfo.emissionTexturePath;
+	case TextureDirectoryIndex::TYPE_AO: return materialInfo.aoTexturePath;
+	default: return materialInfo.diffuseTexturePath;
+	}
+}
+
+static CookedMesh::Material ToCookedMaterial(const EngineTypes::MaterialInfo& materialInfo)
+{
+	CookedMesh::Material material;
+
+	material.diffuseColor[0] = materialInfo.diffuseColor.x;
+	material.diffuseColor[1] = materialInfo.diffuseColor.y;
+	material.diffuseColor[2] = materialInfo.diffuseColor.z;
+	material.diffuseColor[3] = materialInfo.diffuseColor.w;
+	material.ambientColor[0] = materialInfo.ambientColor.x;
+	material.ambientColor[1] = materialInfo.ambientColor.y;
+	material.ambientColor[2] = materialInfo.ambientColor.z;
+	material.ambientColor[3] = materialInfo.ambientColor.w;
+	material.specularColor[0] = materialInfo.specularColor.x;
+	material.specularColor[1] = materialInfo.specularColor.y;
+	material.specularColor[2] = materialInfo.specularColor.z;
+	material.specularColor[3] = materialInfo.specularColor.w;
+	material.shininess = materialInfo.shininess;
+	material.metallic = materialInfo.metallic;
+	material.roughness = materialInfo.roughness;
+	material.ao = materialInfo.ao;
+	material.emissionStrength = materialInfo.emissionStrength;
+	material.texturePaths[CookedMesh::TEXTURE_DIFFUSE] = materialInfo.diffuseTexturePath;
+	material.texturePaths[CookedMesh::TEXTURE_NORMAL] = materialInfo.normalTexturePath;
+	material.texturePaths[CookedMesh::TEXTURE_SPECULAR] = materialInfo.specularTexturePath;
+	material.texturePaths[CookedMesh::TEXTURE_ROUGHNESS] = materialInfo.roughnessTexturePath;
+	material.texturePaths[CookedMesh::TEXTURE_METALLIC] = materialInfo.metallicTexturePath;
+	material.texturePaths[CookedMesh::TEXTURE_EMISSION] = materialInfo.emissionTexturePath;
+	material.texturePaths[CookedMesh::TEXTURE_AO] = materialInfo.aoTexturePath;
+
+	return material;
+}
+
+static EngineTypes::MaterialInfo FromCookedMaterial(const CookedMesh::Material& material)
+{
+	EngineTypes::MaterialInfo materialInfo;
+
+	materialInfo.diffuseColor = XMFLOAT4(material.diffuseColor);
+	materialInfo.ambientColor = XMFLOAT4(material.ambientColor);
+	materialInfo.specularColor = XMFLOAT4(material.specularColor);
+	materialInfo.shininess = material.shininess;
+	materialInfo.metallic = material.metallic;
+	materialInfo.roughness = material.roughness;
+	materialInfo.ao = material.ao;
+	materialInfo.emissionStrength = material.emissionStrength;
+	materialInfo.diffuseTexturePath = material.texturePaths[CookedMesh::TEXTURE_DIFFUSE];
+	materialInfo.normalTexturePath = material.texturePaths[CookedMesh::TEXTURE_NORMAL];
+	materialInfo.specularTexturePath = material.texturePaths[CookedMesh::TEXTURE_SPECULAR];
+	materialInfo.roughnessTexturePath = material.texturePaths[CookedMesh::TEXTURE_ROUGHNESS];
+	materialInfo.metallicTexturePath = material.texturePaths[CookedMesh::TEXTURE_METALLIC];
+	materialInfo.emissionTexturePath = material.texturePaths[CookedMesh::TEXTURE_EMISSION];
+	materialInfo.aoTexturePath = material.texturePaths[CookedMesh::TEXTURE_AO];
+
+	return materialInfo;
+}
 
 Model::Model()
 {
@@ -10,23 +135,15 @@ Model::Model()
 	m_model = 0;
 	m_indices = 0;
 	m_hasFBXMaterial = false;
-	m_materialInfo.diffuseColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	m_materialInfo.ambientColor = XMFLOAT4(0.2f, 0.2f, 0.2f, 1.0f);
-	m_materialInfo.specularColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	m_materialInfo.shininess = 32.0f;
-	m_materialInfo.metallic = 0.0f;
-	m_materialInfo.roughness = 0.5f;
-	m_materialInfo.ao = 1.0f;
-	m_materialInfo.emissionStrength = 0.0f;
+	ResetMaterialInfo();
 	m_currentFBXPath = "";
-	
-	// Initialize PBR texture pointers
-	m_diffuseTexture = nullptr;
-	m_normalTexture = nullptr;
-	m_metallicTexture = nullptr;
-	m_roughnessTexture = nullptr;
-	m_emissionTexture = nullptr;
-	m_aoTexture = nullptr;
+	m_useCookedMeshes = true;
+	m_useCookedTextures = true;
+	m_defaultMaterialIndex = -1;
+	m_vertexFormat = MeshTypes::VERTEX_FORMAT_FULL;
+	m_vertexQuantization = {};
+	m_bounds = {};
+	m_buildMeshlets = false;
 }
 
 
@@ -40,30 +157,24 @@ Model::~Model()
 
 bool Model::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename, char* textureFilename)
 {
+	std::vector<std::string> textureFilenames;
 	bool result;
 
-	// Load in the model data.
-	result = LoadModel(modelFilename);
-	if (!result)
-	{
-		return false;
-	}
 
-	// Initialize the vertex and index buffers.
-	result = InitializeBuffers(device);
-	if (!result)
+	if (textureFilename)
 	{
-		return false;
+		textureFilenames.push_back(textureFilename);
 	}
 
-	// Load the textures for this model.
-	result = LoadTexture(device, deviceContext, textureFilename);
+	// Load in the model data and its texture.
+	result = LoadData(modelFilename, textureFilenames);
 	if (!result)
 	{
 		return false;
 	}
 
-	return true;
+	// Create the vertex and index buffers and the texture.
+	return CreateResources(device, deviceContext);
 }
 
 
@@ -72,67 +183,72 @@ bool Model::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext,
 	bool result;
 
 
-	// Load in the model data.
-	result = LoadModel(modelFilename);
+	// Load in the model data and its textures.
+	result = LoadData(modelFilename, { textureFilename1, textureFilename2 });
 	if (!result)
 	{
 		return false;
 	}
 
-	// Calculate the tangent and binormal vectors for the model.
-	CalculateModelVectors();
+	// Create the vertex and index buffers and the textures.
+	return CreateResources(device, deviceContext);
+}
+
+bool Model::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename, char* textureFilename1, char* textureFilename2, char* textureFilename3)
+{
+	bool result;
 
-	// Initialize the vertex and index buffers.
-	result = InitializeBuffers(device);
-	if (!result)
-	{
-		return false;
-	}
 
-	// Load the textures for this model.
-	result = LoadTextures(device, deviceContext, textureFilename1, textureFilename2);
+	// Load in the model data and its textures.
+	result = LoadData(modelFilename, { textureFilename1, textureFilename2, textureFilename3 });
 	if (!result)
 	{
 		return false;
 	}
 
-	return true;
+	// Create the vertex and index buffers and the textures.
+	return CreateResources(device, deviceContext);
 }
 
-bool Model::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename, char* textureFilename1, char* textureFilename2, char* textureFilename3)
+bool Model::InitializeFBX(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename)
 {
 	bool result;
 
+	LOG("Initializing FBX model: " + std::string(modelFilename));
 
-	// Load in the model data.
-	result = LoadModel(modelFilename);
+	// Load in the model data and decode the material textures.
+	result = LoadFBXData(modelFilename);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Initialize the vertex and index buffers.
-	result = InitializeBuffers(device);
-	if (!result)
-	{
-		return false;
-	}
+	// Create the vertex and index buffers and the textures.
+	return CreateResources(device, deviceContext);
+}
+
+
+bool Model::LoadData(char* modelFilename, const std::vector<std::string>& textureFilenames)
+{
+	bool result;
+
 
-	// Load the textures for this model.
-	result = LoadTextures(device, deviceContext, textureFilename1, textureFilename2, textureFilename3);
+	// Load in the model data.
+	result = LoadModel(modelFilename);
 	if (!result)
 	{
 		return false;
 	}
 
-	return true;
+	// Decode the textures for this model.
+	return LoadTextures(textureFilenames);
 }
 
-bool Model::InitializeFBX(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* modelFilename)
+
+bool Model::LoadFBXData(char* modelFilename)
 {
 	bool result;
 
-	LOG("Initializing FBX model: " + std::string(modelFilename));
 
 	// Load in the model data.
 	result = LoadModel(modelFilename);
@@ -142,21 +258,11 @@ bool Model::InitializeFBX(ID3D11Device* device, ID3D11DeviceContext* deviceConte
 		return false;
 	}
 
-	CalculateModelVectors();
-
-	// Initialize the vertex and index buffers.
-	result = InitializeBuffers(device);
-	if (!result)
-	{
-		LOG_ERROR("Failed to initialize buffers");
-		return false;
-	}
-
-	// Load textures from FBX materials
+	// Decode the textures of the FBX materials
 	if (m_hasFBXMaterial)
 	{
 		LOG("Loading textures from FBX materials...");
-		result = LoadFBXTextures(device, deviceContext);
+		result = LoadFBXTextures();
 		if (!result)
 		{
 			LOG_ERROR("Failed to load FBX textures");
@@ -172,6 +278,24 @@ bool Model::InitializeFBX(ID3D11Device* device, ID3D11DeviceContext* deviceConte
 }
 
 
+bool Model::CreateResources(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+	bool result;
+
+
+	// Initialize the vertex and index buffers.
+	result = InitializeBuffers(device);
+	if (!result)
+	{
+		LOG_ERROR("Failed to initialize buffers");
+		return false;
+	}
+
+	// Create the textures from the decoded images.
+	return CreateTextures(device, deviceContext);
+}
+
+
 void Model::Shutdown()
 {
 	// Release the model textures.
@@ -211,60 +335,66 @@ ID3D11ShaderResourceView* Model::GetTexture() const
 
 ID3D11ShaderResourceView* Model::GetTexture(int index) const
 {
-	return m_Textures[index].GetTexture();
+	return m_Textures[index]->GetTexture();
 }
 
 
-ID3D11ShaderResourceView* Model::GetDiffuseTexture() const
+ID3D11ShaderResourceView* Model::GetDiffuseTexture(int materialIndex) const
 {
-	if (m_diffuseTexture)
+	const MaterialTextures* textures = GetMaterialTextures(materialIndex);
+	if (textures && textures->diffuse)
 	{
-		return m_diffuseTexture->GetTexture();
+		return textures->diffuse->GetTexture();
 	}
 	return nullptr;
 }
 
-ID3D11ShaderResourceView* Model::GetNormalTexture() const
+ID3D11ShaderResourceView* Model::GetNormalTexture(int materialIndex) const
 {
-	if (m_normalTexture)
+	const MaterialTextures* textures = GetMaterialTextures(materialIndex);
+	if (textures && textures->normal)
 	{
-		return m_normalTexture->GetTexture();
+		return textures->normal->GetTexture();
 	}
 	return nullptr;
 }
 
-ID3D11ShaderResourceView* Model::GetMetallicTexture() const
+ID3D11ShaderResourceView* Model::GetMetallicTexture(int materialIndex) const
 {
-	if (m_metallicTexture)
+	const MaterialTextures* textures = GetMaterialTextures(materialIndex);
+	if (textures && textures->metallic)
 	{
-		return m_metallicTexture->GetTexture();
+		return textures->metallic->GetTexture();
 	}
 	return nullptr;
 }
 
-ID3D11ShaderResourceView* Model::GetRoughnessTexture() const
+ID3D11ShaderResourceView* Model::GetRoughnessTexture(int materialIndex) const
 {
-	if (m_roughnessTexture)
+	const MaterialTextures* textures = GetMaterialTextures(materialIndex);
+	if (textures && textures->roughness)
 	{
-		return m_roughnessTexture->GetTexture();
+		return textures->roughness->GetTexture();
 	}
 	return nullptr;
 }
 
-ID3D11ShaderResourceView* Model::GetEmissionTexture() const
+ID3D11ShaderResourceView* Model::GetEmissionTexture(int materialIndex) const
 {
-	if (m_emissionTexture)
+	const MaterialTextures* textures = GetMaterialTextures(materialIndex);
+	if (textures && textures->emission)
 	{
-		return m_emissionTexture->GetTexture();
+		return textures->emission->GetTexture();
 	}
 	return nullptr;
 }
 
-ID3D11ShaderResourceView* Model::GetAOTexture() const
+ID3D11ShaderResourceView* Model::GetAOTexture(int materialIndex) const
 {
-	if (m_aoTexture)
+	const MaterialTextures* textures = GetMaterialTextures(materialIndex);
+	if (textures && textures->ao)
 	{
-		return m_aoTexture->GetTexture();
+		return textures->ao->GetTexture();
 	}
 	return nullptr;
 }
@@ -272,60 +402,81 @@ ID3D11ShaderResourceView* Model::GetAOTexture() const
 
 bool Model::InitializeBuffers(ID3D11Device* device)
 {
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	HRESULT result;
-	int i;
+	std::vector<IndexType> sequentialIndices;
+	bool result;
+
 
-	// Create the vertex array.
-	vertices = new VertexType[m_vertexCount];
-	if (!vertices)
+	// A cooked mesh is still mapped, create the buffers straight from the file view.
+	if (m_cookedMesh.IsOpen())
 	{
-		LOG_ERROR("InitializeBuffers: Failed to allocate vertex array");
-		return false;
+		result = InitializeBuffers(device, m_cookedMesh.GetVertices(), m_cookedMesh.GetIndices());
+
+		// The GPU has its own copy now, release the mapping.
+		m_cookedMesh.Close();
+		return result;
 	}
 
-	// Create the index array.
-	indices = new unsigned long[m_indexCount];
-	if (!indices)
+	if (!m_model)
 	{
-		LOG_ERROR("InitializeBuffers: Failed to allocate index array");
+		LOG_ERROR("InitializeBuffers: No model data loaded");
 		return false;
 	}
 
-	// Load the vertex array and index array with data.
-	for (i = 0; i < m_vertexCount; i++)
+	// Models that were never indexed draw their vertices in order.
+	if (!m_indices)
 	{
-		vertices[i].position = XMFLOAT3(m_model[i].x, m_model[i].y, m_model[i].z);
-		vertices[i].texture = XMFLOAT2(m_model[i].tu, m_model[i].tv);
-		vertices[i].normal = XMFLOAT3(m_model[i].nx, m_model[i].ny, m_model[i].nz);
-		vertices[i].tangent = XMFLOAT3(m_model[i].tx, m_model[i].ty, m_model[i].tz);
-		vertices[i].binormal = XMFLOAT3(m_model[i].bx, m_model[i].by, m_model[i].bz);
+		sequentialIndices.resize(m_indexCount);
+		for (int i = 0; i < m_indexCount; i++)
+		{
+			sequentialIndices[i] = (IndexType)i;
+		}
 	}
 
-	// Load the index array with actual index data from FBX file
-	for (i = 0; i < m_indexCount; i++)
+	return InitializeBuffers(device, m_model, m_indices ? m_indices : sequentialIndices.data());
+}
+
+
+bool Model::InitializeBuffers(ID3D11Device* device, const void* vertexData, const IndexType* indexData)
+{
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA vertexSubresource, indexSubresource;
+	std::vector<MeshTypes::CompactVertex> compactVertices;
+	unsigned int vertexStride;
+	HRESULT result;
+
+
+	// Encode the compact format from the full vertices, falling back to them if that fails.
+	vertexStride = sizeof(VertexType);
+	if (m_vertexFormat == MeshTypes::VERTEX_FORMAT_COMPACT)
 	{
-		indices[i] = m_indices ? m_indices[i] : i; // Use actual indices if available, otherwise fallback to sequential
+		if (VertexCompressor::Compress(static_cast<const ModelType*>(vertexData), (size_t)m_vertexCount, compactVertices, m_vertexQuantization, &m_compressionStats))
+		{
+			LOG(VertexCompressor::FormatStats(m_compressionStats));
+			vertexData = compactVertices.data();
+			vertexStride = sizeof(MeshTypes::CompactVertex);
+		}
+		else
+		{
+			LOG_WARNING("Model::InitializeBuffers - Vertex compression failed, using the full vertex format");
+			m_vertexFormat = MeshTypes::VERTEX_FORMAT_FULL;
+		}
 	}
 
 	// Set up the description of the static vertex buffer.
 	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
+	vertexBufferDesc.ByteWidth = vertexStride * m_vertexCount;
 	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	vertexBufferDesc.CPUAccessFlags = 0;
 	vertexBufferDesc.MiscFlags = 0;
 	vertexBufferDesc.StructureByteStride = 0;
 
 	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
+	vertexSubresource.pSysMem = vertexData;
+	vertexSubresource.SysMemPitch = 0;
+	vertexSubresource.SysMemSlicePitch = 0;
 
 	// Now create the vertex buffer.
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
+	result = device->CreateBuffer(&vertexBufferDesc, &vertexSubresource, &m_vertexBuffer);
 	if (FAILED(result))
 	{
 		LOG_ERROR("Model::InitializeBuffers - Failed to create vertex buffer - HRESULT: " + std::to_string(result));
@@ -334,32 +485,25 @@ bool Model::InitializeBuffers(ID3D11Device* device)
 
 	// Set up the description of the static index buffer.
 	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
+	indexBufferDesc.ByteWidth = sizeof(IndexType) * m_indexCount;
 	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	indexBufferDesc.CPUAccessFlags = 0;
 	indexBufferDesc.MiscFlags = 0;
 	indexBufferDesc.StructureByteStride = 0;
 
 	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
+	indexSubresource.pSysMem = indexData;
+	indexSubresource.SysMemPitch = 0;
+	indexSubresource.SysMemSlicePitch = 0;
 
 	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+	result = device->CreateBuffer(&indexBufferDesc, &indexSubresource, &m_indexBuffer);
 	if (FAILED(result))
 	{
 		LOG_ERROR("InitializeBuffers: Failed to create index buffer - HRESULT: " + std::to_string(result));
 		return false;
 	}
 
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
-
 	return true;
 }
 
@@ -391,7 +535,7 @@ void Model::RenderBuffers(ID3D11DeviceContext* deviceContext)
 
 
 	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType);
+	stride = m_vertexFormat == MeshTypes::VERTEX_FORMAT_COMPACT ? sizeof(MeshTypes::CompactVertex) : sizeof(VertexType);
 	offset = 0;
 
 	// Set the vertex buffer to active in the input assembler so it can be rendered.
@@ -407,93 +551,97 @@ void Model::RenderBuffers(ID3D11DeviceContext* deviceContext)
 }
 
 
-bool Model::LoadTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename)
+bool Model::LoadTextures(const std::vector<std::string>& filenames)
 {
-	if (!filename) {
+	if (filenames.empty())
+	{
 		// No texture to load
 		m_Texture = nullptr;
 		return true;
 	}
 
-	bool result;
-
-	// Debug output for texture loading
-	LOG("Attempting to load texture: " + std::string(filename));
-
-	// Check if file exists
-	FILE* file;
-	errno_t err = fopen_s(&file, filename, "rb");
-	if (err != 0)
-	{
-		LOG_ERROR("Failed to open texture file. Error code: " + std::to_string(err));
-		return false;
-	}
-	fclose(file);
-	LOG("Texture file exists and is accessible");
-
-	// Create and initialize the texture object.
-	m_Texture = new Texture;
-
-	result = m_Texture->Initialize(device, deviceContext, filename);
-	if (!result)
+	// A single texture gets its own object.
+	if (filenames.size() == 1)
 	{
-		LOG_ERROR("Failed to initialize texture object");
-		return false;
-	}
-
-	LOG("Texture loaded successfully");
-	return true;
-}
+		const std::string& filename = filenames[0];
 
+		// Debug output for texture loading
+		LOG("Attempting to load texture: " + filename);
 
-bool Model::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename1, char* filename2)
-{
-	bool result;
-
+		// Check if file exists
+		FILE* file;
+		errno_t err = fopen_s(&file, filename.c_str(), "rb");
+		if (err != 0)
+		{
+			LOG_ERROR("Failed to open texture file. Error code: " + std::to_string(err));
+			return false;
+		}
+		fclose(file);
+		LOG("Texture file exists and is accessible");
 
-	// Create and initialize the texture object array.
-	m_Textures.resize(2);
+		// Get the shared texture object, decoding the image if it is new.
+		m_Texture = ResourceCache::GetInstance().AcquireTexture(filename);
+		if (!m_Texture)
+		{
+			LOG_ERROR("Failed to decode texture");
+			return false;
+		}
 
-	result = m_Textures[0].Initialize(device, deviceContext, filename1);
-	if (!result)
-	{
-		return false;
+		LOG("Texture loaded successfully");
+		return true;
 	}
 
-	result = m_Textures[1].Initialize(device, deviceContext, filename2);
-	if (!result)
+	// Get the shared texture objects, decoding the images that are new in parallel.
+	std::vector<Texture*> textures;
+	ResourceCache::GetInstance().AcquireTextures(filenames, std::vector<ImageTypes::TextureRole>(), textures);
+
+	bool result = true;
+	for (Texture* texture : textures)
 	{
-		return false;
+		if (!texture)
+		{
+			result = false;
+			continue;
+		}
+		m_Textures.push_back(texture);
 	}
 
-	return true;
+	return result;
 }
 
 
-bool Model::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename1, char* filename2, char* filename3)
+bool Model::CreateTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
 {
-	bool result;
+	ResourceCache& cache = ResourceCache::GetInstance();
 
-
-	// Create and initialize the texture object array.
-	m_Textures.resize(3);
-
-	result = m_Textures[0].Initialize(device, deviceContext, filename1);
-	if (!result)
+	// The model cannot do without the textures it was given. Shared ones may exist already.
+	if (m_Texture && !cache.CreateTexture(m_Texture, device, deviceContext))
 	{
+		LOG_ERROR("Failed to initialize texture object");
 		return false;
 	}
 
-	result = m_Textures[1].Initialize(device, deviceContext, filename2);
-	if (!result)
+	for (Texture* texture : m_Textures)
 	{
-		return false;
+		if (!cache.CreateTexture(texture, device, deviceContext))
+		{
+			return false;
+		}
 	}
 
-	result = m_Textures[2].Initialize(device, deviceContext, filename3);
-	if (!result)
+	// Material textures that fail are left out, the same as ones that failed to decode.
+	for (MaterialTextures& textures : m_materialTextures)
 	{
-		return false;
+		Texture** materialTextures[] = { &textures.diffuse, &textures.normal, &textures.metallic, &textures.roughness, &textures.emission, &textures.ao };
+		for (Texture** texture : materialTextures)
+		{
+			if (*texture && !cache.CreateTexture(*texture, device, deviceContext))
+			{
+				LOG_ERROR("Failed to create material texture");
+				cache.ReleaseTexture(*texture);
+				*texture = nullptr;
+			}
+		}
 	}
 
 	return true;
@@ -502,146 +650,334 @@ bool Model::LoadTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContex
 
 void Model::ReleaseTextures()
 {
+	ResourceCache& cache = ResourceCache::GetInstance();
+
 	// Release the texture object array.
-	for (auto& texture : m_Textures)
+	for (Texture* texture : m_Textures)
 	{
-		texture.Shutdown();
+		cache.ReleaseTexture(texture);
 	}
 	m_Textures.clear();
 
 	// Release the texture object.
 	if (m_Texture)
 	{
-		m_Texture->Shutdown();
-		delete m_Texture;
+		cache.ReleaseTexture(m_Texture);
 		m_Texture = 0;
 	}
 
 	// Release PBR textures
-	if (m_diffuseTexture)
+	for (MaterialTextures& textures : m_materialTextures)
 	{
-		m_diffuseTexture->Shutdown();
-		delete m_diffuseTexture;
-		m_diffuseTexture = nullptr;
+		Texture* materialTextures[] = { textures.diffuse, textures.normal, textures.metallic, textures.roughness, textures.emission, textures.ao };
+		for (Texture* texture : materialTextures)
+		{
+			cache.ReleaseTexture(texture);
+		}
 	}
+	m_materialTextures.clear();
 
-	if (m_normalTexture)
-	{
-		m_normalTexture->Shutdown();
-		delete m_normalTexture;
-		m_normalTexture = nullptr;
-	}
+	return;
+}
 
-	if (m_metallicTexture)
-	{
-		m_metallicTexture->Shutdown();
-		delete m_metallicTexture;
-		m_metallicTexture = nullptr;
-	}
 
-	if (m_roughnessTexture)
-	{
-		m_roughnessTexture->Shutdown();
-		delete m_roughnessTexture;
-		m_roughnessTexture = nullptr;
-	}
+bool Model::LoadModel(char* filename)
+{
+	std::string cookedFilename = CookedMesh::GetCookedFilename(filename);
+	CookedMesh::SourceInfo source;
+	bool hasSource;
+	bool result;
+
 
-	if (m_emissionTexture)
+	hasSource = CookedMesh::GetSourceInfo(filename, source);
+
+	// Use the cooked mesh if it is up to date. Without a source file any cooked mesh is used.
+	if (m_useCookedMeshes && LoadCookedModel(cookedFilename, hasSource ? &source : nullptr))
 	{
-		m_emissionTexture->Shutdown();
-		delete m_emissionTexture;
-		m_emissionTexture = nullptr;
+		return true;
 	}
 
-	if (m_aoTexture)
+	result = ImportModel(filename);
+	if (!result)
 	{
-		m_aoTexture->Shutdown();
-		delete m_aoTexture;
-		m_aoTexture = nullptr;
+		return false;
 	}
 
-	return;
-}
-
-
-bool Model::LoadModel(char* filename)
-{
-	// Check if the file is an FBX file
-	std::string fileStr(filename);
-	if (fileStr.substr(fileStr.find_last_of(".") + 1) == "fbx")
+	// Cook the imported data so the next start can skip the import entirely.
+	if (m_useCookedMeshes && hasSource && HasSkin())
 	{
-		bool result = LoadFBXModel(filename);
-		if (result)
-		{
-			CalculateBoundingBox();
-		}
-		return result;
+		LOG("LoadModel - Not cooking skinned model " + cookedFilename + ", skins are imported every time");
 	}
-	else
+	else if (m_useCookedMeshes && hasSource)
 	{
-		bool result = LoadTextModel(filename);
-		if (result)
+		if (!CookModel(cookedFilename, source))
 		{
-			CalculateBoundingBox();
+			LOG_WARNING("LoadModel - Failed to write cooked mesh " + cookedFilename);
 		}
-		return result;
 	}
+
+	return true;
 }
 
 
-bool Model::LoadTextModel(char* filename)
+bool Model::ImportModel(char* filename)
 {
-	ifstream fin;
-	char input;
-	int i;
+	bool result;
+
 
-	// Open the model file.
-	fin.open(filename);
+	// Check if the file is an FBX file
+	std::string fileStr(filename);
+	bool isFBX = fileStr.substr(fileStr.find_last_of(".") + 1) == "fbx";
 
-	// If it could not open the file then exit.
-	if (fin.fail())
+	m_lods.clear();
+	m_meshlets.clear();
+
+	result = isFBX ? LoadFBXModel(filename) : LoadTextModel(filename);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Read up to the value of vertex count.
-	fin.get(input);
-	while (input != ':')
+	// Text models have no materials of their own, draw them as a single submesh.
+	if (m_materials.empty())
 	{
-		fin.get(input);
+		m_materials.push_back(m_materialInfo);
 	}
-
-	// Read in the vertex count.
-	fin >> m_vertexCount;
-
-	// Set the number of indices to be the same as the vertex count.
-	m_indexCount = m_vertexCount;
-
-	// Create the model using the vertex count that was read in.
-	m_model = new ModelType[m_vertexCount];
-
-	// Read up to the beginning of the data.
-	fin.get(input);
-	while (input != ':')
+	if (m_submeshes.empty())
 	{
-		fin.get(input);
+		Submesh submesh = {};
+		submesh.indexCount = (uint32_t)m_indexCount;
+		m_submeshes.push_back(submesh);
 	}
-	fin.get(input);
-	fin.get(input);
 
-	// Read in the vertex data.
-	for (i = 0; i < m_vertexCount; i++)
+	if (isFBX)
 	{
-		fin >> m_model[i].x >> m_model[i].y >> m_model[i].z;
-		fin >> m_model[i].tu >> m_model[i].tv;
-		fin >> m_model[i].nx >> m_model[i].ny >> m_model[i].nz;
-	}
+		// Collapse the per-polygon-vertex soup into a genuinely indexed mesh.
+		result = WeldVertices();
+		if (!result)
+		{
+			LOG_ERROR("Failed to weld FBX vertices");
+			return false;
+		}
 
-	// Close the model file.
-	fin.close();
+		// Reorder the triangles and vertices for the post-transform cache, overdraw and vertex fetch.
+		result = OptimizeMesh();
+		if (!result)
+		{
+			LOG_ERROR("Failed to optimize FBX mesh");
+			return false;
+		}
+	}
 
-	return true;
-}
+	// Calculate the tangent and binormal vectors for the model.
+	result = CalculateModelVectors();
+	if (!result)
+	{
+		LOG_ERROR("Failed to calculate tangent frames");
+		return false;
+	}
+
+	CalculateBoundingBox();
+
+	// Welding and reordering keep every triangle inside its submesh, only the vertex spans and bounds move.
+	if (m_indices)
+	{
+		MeshBuilder::UpdateSubmeshBounds(m_model, m_indices, m_submeshes.data(), m_submeshes.size());
+	}
+	else
+	{
+		Submesh& submesh = m_submeshes[0];
+		submesh.vertexCount = (uint32_t)m_vertexCount;
+		submesh.boundsMin[0] = m_boundingBox.min.x;
+		submesh.boundsMin[1] = m_boundingBox.min.y;
+		submesh.boundsMin[2] = m_boundingBox.min.z;
+		submesh.boundsMax[0] = m_boundingBox.max.x;
+		submesh.boundsMax[1] = m_boundingBox.max.y;
+		submesh.boundsMax[2] = m_boundingBox.max.z;
+	}
+
+	// Meshlets only reorder triangles within their submesh, so they go before the LODs are appended.
+	if (isFBX && m_buildMeshlets)
+	{
+		result = BuildMeshlets();
+		if (!result)
+		{
+			LOG_WARNING("Failed to build meshlets, culling whole submeshes");
+		}
+	}
+
+	// Simplified levels are appended to the same buffers for distant instances.
+	if (isFBX)
+	{
+		result = GenerateLODs();
+		if (!result)
+		{
+			LOG_WARNING("Failed to generate LODs, drawing the full mesh at every distance");
+		}
+	}
+
+	if (m_lods.empty())
+	{
+		LodLevel lod = {};
+		lod.indexCount = (uint32_t)m_indexCount;
+		lod.submeshCount = (uint32_t)m_submeshes.size();
+		m_lods.push_back(lod);
+	}
+
+	IndexSubmeshMeshlets();
+
+	// The bind pose as the skinning loop reads it, welded and reordered like the vertex buffer.
+	if (HasSkin())
+	{
+		Skinning::BuildStreams(m_model, m_skinInfluences.data(), (size_t)m_vertexCount, m_skinStreams);
+		LOG("ImportModel - Skinned to " + std::to_string(m_skeleton.joints.size()) + " joints, " +
+			std::to_string(m_animationClips.size()) + " animation clips");
+	}
+
+	LOG("ImportModel - " + std::to_string(m_submeshes.size()) + " submeshes, " + std::to_string(m_materials.size()) + " materials, " +
+		std::to_string(m_lods.size()) + " LODs, " + std::to_string(m_meshlets.size()) + " meshlets");
+
+	return true;
+}
+
+
+bool Model::LoadCookedModel(const std::string& cookedFilename, const CookedMesh::SourceInfo* source)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if (!m_cookedMesh.Open(cookedFilename))
+	{
+		return false;
+	}
+
+	if (source && !m_cookedMesh.IsUpToDate(*source))
+	{
+		LOG("LoadCookedModel - Cooked mesh is out of date, re-importing: " + cookedFilename);
+		m_cookedMesh.Close();
+		return false;
+	}
+
+	// FBX sources (the ones with materials) cooked without meshlets are re-imported once to build them.
+	if (source && m_buildMeshlets && m_cookedMesh.HasMaterial() && m_cookedMesh.GetMeshletCount() == 0)
+	{
+		LOG("LoadCookedModel - Cooked mesh has no meshlets, re-importing: " + cookedFilename);
+		m_cookedMesh.Close();
+		return false;
+	}
+
+	m_vertexCount = (int)m_cookedMesh.GetVertexCount();
+	m_indexCount = (int)m_cookedMesh.GetIndexCount();
+
+	m_bounds = m_cookedMesh.GetBounds();
+	m_boundingBox.min = XMFLOAT3(m_bounds.min[0], m_bounds.min[1], m_bounds.min[2]);
+	m_boundingBox.max = XMFLOAT3(m_bounds.max[0], m_bounds.max[1], m_bounds.max[2]);
+	m_boundingBox.radius = m_bounds.radius;
+
+	const CookedMesh::Submesh* submeshes = m_cookedMesh.GetSubmeshes();
+	m_submeshes.assign(submeshes, submeshes + m_cookedMesh.GetSubmeshCount());
+
+	const CookedMesh::LodLevel* lods = m_cookedMesh.GetLods();
+	m_lods.assign(lods, lods + m_cookedMesh.GetLodCount());
+	if (m_lods.empty())
+	{
+		LodLevel lod = {};
+		lod.indexCount = (uint32_t)m_indexCount;
+		lod.submeshCount = (uint32_t)m_submeshes.size();
+		m_lods.push_back(lod);
+	}
+
+	const CookedMesh::Meshlet* meshlets = m_cookedMesh.GetMeshlets();
+	m_meshlets.assign(meshlets, meshlets + m_cookedMesh.GetMeshletCount());
+	IndexSubmeshMeshlets();
+
+	m_materials.clear();
+	for (const CookedMesh::Material& material : m_cookedMesh.GetMaterials())
+	{
+		m_materials.push_back(FromCookedMaterial(material));
+	}
+	if (m_materials.empty())
+	{
+		m_materials.push_back(m_materialInfo);
+	}
+	m_materialInfo = m_materials[0];
+	m_hasFBXMaterial = m_cookedMesh.HasMaterial();
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	double loadTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+	LOG("LoadCookedModel - " + cookedFilename + ": " + std::to_string(m_vertexCount) + " vertices, " +
+		std::to_string(m_indexCount) + " indices, " + std::to_string(m_submeshes.size()) + " submeshes, " + std::to_string(m_lods.size()) + " LODs, " +
+		std::to_string(loadTimeMs) + " ms");
+
+	return true;
+}
+
+
+bool Model::CookModel(const std::string& cookedFilename, const CookedMesh::SourceInfo& source)
+{
+	CookedMesh::MeshData mesh;
+
+
+	mesh.vertices = m_model;
+	mesh.vertexCount = (size_t)m_vertexCount;
+	mesh.indices = m_indices;
+	mesh.indexCount = (size_t)m_indexCount;
+
+	mesh.bounds = m_bounds;
+
+	mesh.submeshes = m_submeshes.data();
+	mesh.submeshCount = m_submeshes.size();
+	mesh.lods = m_lods.data();
+	mesh.lodCount = m_lods.size();
+	mesh.meshlets = m_meshlets.data();
+	mesh.meshletCount = m_meshlets.size();
+
+	mesh.hasMaterial = m_hasFBXMaterial;
+	for (const MaterialInfo& material : m_materials)
+	{
+		mesh.materials.push_back(ToCookedMaterial(material));
+	}
+
+	if (!CookedMesh::Write(cookedFilename, mesh, source))
+	{
+		return false;
+	}
+
+	LOG("CookModel - Wrote " + cookedFilename);
+	return true;
+}
+
+
+bool Model::LoadTextModel(char* filename)
+{
+	TextModelParser parser;
+	TextModelParser::Stats stats;
+
+
+	// Map the model file and read the vertex count.
+	if (!parser.Open(filename))
+	{
+		return false;
+	}
+
+	m_vertexCount = (int)parser.GetVertexCount();
+
+	// Set the number of indices to be the same as the vertex count.
+	m_indexCount = m_vertexCount;
+
+	// Create the model using the vertex count that was read in.
+	m_model = new ModelType[m_vertexCount]();
+
+	// Read in the vertex data, position, texture coordinates and normal are the first eight floats of ModelType.
+	if (!parser.Parse(&m_model[0].x, sizeof(ModelType) / sizeof(float), &stats))
+	{
+		return false;
+	}
+
+	LOG(TextModelParser::FormatStats(stats));
+
+	return true;
+}
 
 
 bool Model::LoadFBXModel(char* filename)
@@ -651,6 +987,19 @@ bool Model::LoadFBXModel(char* filename)
 	// Store the current FBX file path for texture searching
 	m_currentFBXPath = filename;
 
+	m_materials.clear();
+	m_submeshes.clear();
+	m_lods.clear();
+	m_fbxMaterialIndices.clear();
+	m_defaultMaterialIndex = -1;
+	m_skeleton.joints.clear();
+	m_skinInfluences.clear();
+	m_animationClips.clear();
+	m_compressedClips.clear();
+	m_fbxJointIndices.clear();
+	m_skinStreams = Skinning::Streams();
+	m_skinStats = SkinWeightBuilder::Stats();
+
 	// Initialize the FBX SDK manager
 	FbxManager* lSdkManager = FbxManager::Create();
 	if (!lSdkManager)
@@ -710,12 +1059,53 @@ bool Model::LoadFBXModel(char* filename)
 	}
 	LOG("LoadFBXModel - Root node obtained successfully");
 
-	// Process the scene
+	// Joints first, the mesh processing needs their indices for the skin weights.
+	ImportSkeleton(lRootNode);
+
+	// Process the scene into one builder, sized up front so it never has to grow.
 	LOG("LoadFBXModel - Processing scene nodes...");
-	ProcessNode(lRootNode);
+	MeshBuilder builder;
+	builder.Reserve((size_t)CountPolygonVertices(lRootNode));
+	ProcessNode(lRootNode, builder);
 	LOG("LoadFBXModel - Scene processing completed");
 
+	if (!m_skeleton.joints.empty())
+	{
+		ImportAnimations(lScene);
+		LOG(SkinWeightBuilder::FormatStats(m_skinStats));
+	}
+
+	// Copy the assembled scene into the model arrays once, grouped into one submesh per material.
+	std::vector<ModelType> vertices;
+	std::vector<IndexType> indices;
+	builder.Build(vertices, indices, m_submeshes);
+
+	ReleaseModel();
+	m_vertexCount = (int)vertices.size();
+	m_indexCount = (int)indices.size();
+	m_model = new ModelType[m_vertexCount];
+	m_indices = new IndexType[m_indexCount];
+	std::copy(vertices.begin(), vertices.end(), m_model);
+	std::copy(indices.begin(), indices.end(), m_indices);
+
+	if (!m_skinInfluences.empty() && m_skinInfluences.size() != vertices.size())
+	{
+		LOG_WARNING("LoadFBXModel - Skin weights do not match the vertices, importing without skin");
+		m_skinInfluences.clear();
+	}
+
+	LOG("LoadFBXModel - Vertex count: " + std::to_string(m_vertexCount) + ", Index count: " + std::to_string(m_indexCount) +
+		", Submeshes: " + std::to_string(m_submeshes.size()) + ", Materials: " + std::to_string(m_materials.size()));
+
+	// The first material stays available through the single-material getters.
+	if (!m_materials.empty())
+	{
+		m_materialInfo = m_materials[0];
+	}
+
 	// Clean up
+	m_fbxMaterialIndices.clear();
+	m_fbxJointIndices.clear();
 	lScene->Destroy();
 	lSdkManager->Destroy();
 	LOG("LoadFBXModel - FBX loading completed successfully");
@@ -724,7 +1114,31 @@ bool Model::LoadFBXModel(char* filename)
 }
 
 
-void Model::ProcessNode(FbxNode* pNode)
+int Model::CountPolygonVertices(FbxNode* pNode)
+{
+	int count = 0;
+
+	if (!pNode)
+	{
+		return 0;
+	}
+
+	FbxMesh* lMesh = pNode->GetMesh();
+	if (lMesh)
+	{
+		count += lMesh->GetPolygonVertexCount();
+	}
+
+	for (int i = 0; i < pNode->GetChildCount(); i++)
+	{
+		count += CountPolygonVertices(pNode->GetChild(i));
+	}
+
+	return count;
+}
+
+
+void Model::ProcessNode(FbxNode* pNode, MeshBuilder& builder)
 {
 	if (!pNode)
 	{
@@ -738,13 +1152,13 @@ void Model::ProcessNode(FbxNode* pNode)
 	FbxNodeAttribute* lNodeAttribute = pNode->GetNodeAttribute();
 	if (lNodeAttribute && lNodeAttribute->GetAttributeType() == FbxNodeAttribute::eMesh)
 	{
-		ProcessMesh(pNode);
+		ProcessMesh(pNode, builder);
 	}
 
 	// Process all child nodes
 	for (int i = 0; i < pNode->GetChildCount(); i++)
 	{
-		ProcessNode(pNode->GetChild(i));
+		ProcessNode(pNode->GetChild(i), builder);
 	}
 }
 
@@ -755,40 +1169,83 @@ void Model::ProcessMaterials(FbxNode* pNode)
 
 	LOG("--- Processing Node: " + std::string(pNode->GetName()) + " ---");
 
-	// First, try to find textures connected to materials
+	// Every material gets its own entry in the material table, shared by all nodes that use it.
 	int materialCount = pNode->GetMaterialCount();
-	if (materialCount > 0)
+	for (int i = 0; i < materialCount; ++i)
 	{
-		for (int i = 0; i < materialCount; ++i)
+		FbxSurfaceMaterial* material = pNode->GetMaterial(i);
+		if (!material || m_fbxMaterialIndices.find(material) != m_fbxMaterialIndices.end())
 		{
-			if (FbxSurfaceMaterial* material = pNode->GetMaterial(i))
-			{
-				if (m_materialInfo.diffuseTexturePath.empty())
-				{
-					ExtractMaterialInfo(material);
-				}
-			}
+			continue;
 		}
-	}
 
-	// If no textures found in materials, try to search the entire scene for textures
-	if (m_materialInfo.diffuseTexturePath.empty())
-	{
-		LOG("  -> No textures found in materials, searching scene for textures...");
-		SearchSceneForTextures(pNode->GetScene());
-	}
+		ResetMaterialInfo();
+		ExtractMaterialInfo(material);
 
-	// If still no textures found, try to find textures in the same directory as the FBX file
-	if (m_materialInfo.diffuseTexturePath.empty())
-	{
-		LOG("  -> No textures found in scene, trying to find textures in FBX directory...");
-		SearchDirectoryForTextures();
+		// If no textures found in the material, try to search the entire scene for textures
+		if (m_materialInfo.diffuseTexturePath.empty())
+		{
+			LOG("  -> No textures found in material, searching scene for textures...");
+			SearchSceneForTextures(pNode->GetScene());
+		}
+
+		// If still no textures found, try to find textures in the same directory as the FBX file
+		if (m_materialInfo.diffuseTexturePath.empty())
+		{
+			LOG("  -> No textures found in scene, trying to find textures in FBX directory...");
+			SearchDirectoryForTextures();
+		}
+
+		if (!m_materialInfo.diffuseTexturePath.empty() || !m_materialInfo.normalTexturePath.empty())
+		{
+			m_hasFBXMaterial = true;
+		}
+
+		m_fbxMaterialIndices[material] = (int)m_materials.size();
+		m_materials.push_back(m_materialInfo);
 	}
+}
+
 
-	if (!m_materialInfo.diffuseTexturePath.empty() || !m_materialInfo.normalTexturePath.empty())
+int Model::GetDefaultMaterialIndex(FbxScene* scene)
+{
+	// Geometry without a material uses whatever textures the scene or the FBX directory provide.
+	if (m_defaultMaterialIndex < 0)
 	{
-		m_hasFBXMaterial = true;
+		LOG("  -> Mesh without material, searching scene for textures...");
+		ResetMaterialInfo();
+		SearchSceneForTextures(scene);
+
+		if (m_materialInfo.diffuseTexturePath.empty())
+		{
+			LOG("  -> No textures found in scene, trying to find textures in FBX directory...");
+			SearchDirectoryForTextures();
+		}
+
+		if (!m_materialInfo.diffuseTexturePath.empty() || !m_materialInfo.normalTexturePath.empty())
+		{
+			m_hasFBXMaterial = true;
+		}
+
+		m_defaultMaterialIndex = (int)m_materials.size();
+		m_materials.push_back(m_materialInfo);
 	}
+
+	return m_defaultMaterialIndex;
+}
+
+
+void Model::ResetMaterialInfo()
+{
+	m_materialInfo = MaterialInfo();
+	m_materialInfo.diffuseColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	m_materialInfo.ambientColor = XMFLOAT4(0.2f, 0.2f, 0.2f, 1.0f);
+	m_materialInfo.specularColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	m_materialInfo.shininess = 32.0f;
+	m_materialInfo.metallic = 0.0f;
+	m_materialInfo.roughness = 0.5f;
+	m_materialInfo.ao = 1.0f;
+	m_materialInfo.emissionStrength = 0.0f;
 }
 
 void Model::SearchSceneForTextures(FbxScene* scene)
@@ -801,14 +1258,9 @@ void Model::SearchSceneForTextures(FbxScene* scene)
 	int textureCount = scene->GetTextureCount();
 	LOG("    -> Found " + std::to_string(textureCount) + " textures in scene");
 	
-	// Store all found textures for better assignment
-	vector<string> diffuseTextures;
-	vector<string> normalTextures;
-	vector<string> specularTextures;
-	vector<string> emissionTextures;
-	vector<string> metallicTextures;
-	vector<string> roughnessTextures;
-	vector<string> aoTextures;
+	// First texture of each type, with how many of that type there are
+	string foundTextures[TextureDirectoryIndex::TYPE_COUNT];
+	int foundCounts[TextureDirectoryIndex::TYPE_COUNT] = {};
 	
 	for (int i = 0; i < textureCount; i++)
 	{
@@ -821,108 +1273,38 @@ void Model::SearchSceneForTextures(FbxScene* scene)
 				string texturePath = fileTexture->GetFileName();
 				LOG("    -> Found texture: " + texturePath);
 				
-				// Try to determine texture type from filename
-				std::string filename = texturePath;
-				std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
-				
-				// Categorize textures by type
-				if (filename.find("diffuse") != std::string::npos || 
-					filename.find("color") != std::string::npos || 
-					filename.find("albedo") != std::string::npos ||
-					filename.find("textura-color") != std::string::npos)
-				{
-					diffuseTextures.push_back(texturePath);
-					LOG("    -> Categorized as diffuse texture");
-				}
-				else if (filename.find("normal") != std::string::npos ||
-						 filename.find("textura-normal") != std::string::npos)
-				{
-					normalTextures.push_back(texturePath);
-					LOG("    -> Categorized as normal texture");
-				}
-				else if (filename.find("specular") != std::string::npos)
-				{
-					specularTextures.push_back(texturePath);
-					LOG("    -> Categorized as specular texture");
-				}
-				else if (filename.find("glow") != std::string::npos ||
-						 filename.find("emission") != std::string::npos ||
-						 filename.find("textura-emission") != std::string::npos)
-				{
-					emissionTextures.push_back(texturePath);
-					LOG("    -> Categorized as emission texture");
-				}
-				else if (filename.find("metallic") != std::string::npos ||
-						 filename.find("textura-metallic") != std::string::npos)
+				// Same naming rules as the textures found next to the FBX file
+				TextureDirectoryIndex::TextureType type = TextureDirectoryIndex::Classify(texturePath);
+				if (type == TextureDirectoryIndex::TYPE_UNKNOWN)
 				{
-					metallicTextures.push_back(texturePath);
-					LOG("    -> Categorized as metallic texture");
-				}
-				else if (filename.find("roughness") != std::string::npos ||
-						 filename.find("textura-roughness") != std::string::npos)
-				{
-					roughnessTextures.push_back(texturePath);
-					LOG("    -> Categorized as roughness texture");
-				}
-				else if (filename.find("ao") != std::string::npos ||
-						 filename.find("ambient") != std::string::npos)
-				{
-					aoTextures.push_back(texturePath);
-					LOG("    -> Categorized as AO texture");
+					LOG("    -> Could not categorize texture: " + texturePath);
+					continue;
 				}
-				else
+
+				LOG("    -> Categorized as " + string(TextureDirectoryIndex::GetTypeName(type)) + " texture");
+				if (foundCounts[type]++ == 0)
 				{
-					LOG("    -> Could not categorize texture: " + texturePath);
+					foundTextures[type] = texturePath;
 				}
 			}
 		}
 	}
 	
 	// Assign the first texture of each type found
-	if (!diffuseTextures.empty() && m_materialInfo.diffuseTexturePath.empty())
+	for (int type = 0; type < TextureDirectoryIndex::TYPE_COUNT; type++)
 	{
-		m_materialInfo.diffuseTexturePath = diffuseTextures[0];
-		LOG("    -> Assigned diffuse texture: " + diffuseTextures[0]);
-		if (diffuseTextures.size() > 1)
+		string& texturePath = GetMaterialTexturePath(m_materialInfo, (TextureDirectoryIndex::TextureType)type);
+		if (foundCounts[type] == 0 || !texturePath.empty())
 		{
-			LOG("    -> Note: " + std::to_string(diffuseTextures.size()) + " diffuse textures found, using first one");
+			continue;
+		}
+
+		texturePath = foundTextures[type];
+		LOG("    -> Assigned " + string(TextureDirectoryIndex::GetTypeName((TextureDirectoryIndex::TextureType)type)) + " texture: " + texturePath);
+		if (foundCounts[type] > 1)
+		{
+			LOG("    -> Note: " + std::to_string(foundCounts[type]) + " " + TextureDirectoryIndex::GetTypeName((TextureDirectoryIndex::TextureType)type) + " textures found, using first one");
 		}
-	}
-	
-	if (!normalTextures.empty() && m_materialInfo.normalTexturePath.empty())
-	{
-		m_materialInfo.normalTexturePath = normalTextures[0];
-		LOG("    -> Assigned normal texture: " + normalTextures[0]);
-	}
-	
-	if (!specularTextures.empty() && m_materialInfo.specularTexturePath.empty())
-	{
-		m_materialInfo.specularTexturePath = specularTextures[0];
-		LOG("    -> Assigned specular texture: " + specularTextures[0]);
-	}
-	
-	if (!emissionTextures.empty() && m_materialInfo.emissionTexturePath.empty())
-	{
-		m_materialInfo.emissionTexturePath = emissionTextures[0];
-		LOG("    -> Assigned emission texture: " + emissionTextures[0]);
-	}
-	
-	if (!metallicTextures.empty() && m_materialInfo.metallicTexturePath.empty())
-	{
-		m_materialInfo.metallicTexturePath = metallicTextures[0];
-		LOG("    -> Assigned metallic texture: " + metallicTextures[0]);
-	}
-	
-	if (!roughnessTextures.empty() && m_materialInfo.roughnessTexturePath.empty())
-	{
-		m_materialInfo.roughnessTexturePath = roughnessTextures[0];
-		LOG("    -> Assigned roughness texture: " + roughnessTextures[0]);
-	}
-	
-	if (!aoTextures.empty() && m_materialInfo.aoTexturePath.empty())
-	{
-		m_materialInfo.aoTexturePath = aoTextures[0];
-		LOG("    -> Assigned AO texture: " + aoTextures[0]);
 	}
 }
 
@@ -938,180 +1320,43 @@ void Model::SearchDirectoryForTextures()
 	
 	LOG("    -> Looking for textures in: " + texturesDir);
 	
-	// Check if textures directory exists and look for common texture files
-	vector<string> possibleTextures = {
-		"color.png",
-		"color.tga",
-		"color.jpg",
-		"diffuse.png",
-		"diffuse.tga",
-		"diffuse.jpg",
-		"albedo.png",
-		"albedo.tga",
-		"albedo.jpg"
-	};
-	
-	for (const string& textureName : possibleTextures)
-	{
-		string fullPath = texturesDir + textureName;
-		FILE* file;
-		errno_t err = fopen_s(&file, fullPath.c_str(), "rb");
-		if (err == 0)
-		{
-			fclose(file);
-			if (m_materialInfo.diffuseTexturePath.empty())
-			{
-				m_materialInfo.diffuseTexturePath = fullPath;
-				LOG("    -> Found diffuse texture: " + fullPath);
-				break;
-			}
-		}
-	}
-	
-	// Look for normal maps
-	vector<string> normalTextures = {
-		"normal.png",
-		"normal.tga",
-		"normal.jpg"
-	};
+	// Listed once and shared by every material and model from this folder
+	std::shared_ptr<const TextureDirectoryIndex> index = TextureDirectoryIndex::Get(texturesDir);
 	
-	for (const string& textureName : normalTextures)
+	for (int type = 0; type < TextureDirectoryIndex::TYPE_COUNT; type++)
 	{
-		string fullPath = texturesDir + textureName;
-		FILE* file;
-		errno_t err = fopen_s(&file, fullPath.c_str(), "rb");
-		if (err == 0)
+		string& texturePath = GetMaterialTexturePath(m_materialInfo, (TextureDirectoryIndex::TextureType)type);
+		const string* foundPath = index->FindByType((TextureDirectoryIndex::TextureType)type);
+		if (foundPath && texturePath.empty())
 		{
-			fclose(file);
-			if (m_materialInfo.normalTexturePath.empty())
-			{
-				m_materialInfo.normalTexturePath = fullPath;
-				LOG("    -> Found normal texture: " + fullPath);
-				break;
-			}
+			texturePath = *foundPath;
+			LOG("    -> Found " + string(TextureDirectoryIndex::GetTypeName((TextureDirectoryIndex::TextureType)type)) + " texture: " + texturePath);
 		}
 	}
+}
+
+void Model::ListAllMaterialProperties(FbxSurfaceMaterial* material)
+{
+	if (!material)
+		return;
+
+	LOG("=== Listing All Material Properties ===");
 	
-	// Look for metallic textures
-	vector<string> metallicTextures = {
-		"metallic.png",
-		"metallic.tga",
-		"metallic.jpg"
-	};
-	
-	for (const string& textureName : metallicTextures)
+	// Get all properties from the material
+	FbxProperty prop = material->GetFirstProperty();
+	while (prop.IsValid())
 	{
-		string fullPath = texturesDir + textureName;
-		FILE* file;
-		errno_t err = fopen_s(&file, fullPath.c_str(), "rb");
-		if (err == 0)
+		string propName = prop.GetName().Buffer();
+		string propType = prop.GetPropertyDataType().GetName();
+		
+		LOG("Property: " + propName + " (Type: " + propType + ")");
+		
+		// Check if this property has textures
+		int textureCount = prop.GetSrcObjectCount<FbxTexture>();
+		if (textureCount > 0)
 		{
-			fclose(file);
-			if (m_materialInfo.metallicTexturePath.empty())
-			{
-				m_materialInfo.metallicTexturePath = fullPath;
-				LOG("    -> Found metallic texture: " + fullPath);
-				break;
-			}
-		}
-	}
-	
-	// Look for roughness textures
-	vector<string> roughnessTextures = {
-		"roughness.png",
-		"roughness.tga",
-		"roughness.jpg"
-	};
-	
-	for (const string& textureName : roughnessTextures)
-	{
-		string fullPath = texturesDir + textureName;
-		FILE* file;
-		errno_t err = fopen_s(&file, fullPath.c_str(), "rb");
-		if (err == 0)
-		{
-			fclose(file);
-			if (m_materialInfo.roughnessTexturePath.empty())
-			{
-				m_materialInfo.roughnessTexturePath = fullPath;
-				LOG("    -> Found roughness texture: " + fullPath);
-				break;
-			}
-		}
-	}
-	
-	// Look for emission textures
-	vector<string> emissionTextures = {
-		"emission.png",
-		"emission.tga",
-		"emission.jpg"
-	};
-	
-	for (const string& textureName : emissionTextures)
-	{
-		string fullPath = texturesDir + textureName;
-		FILE* file;
-		errno_t err = fopen_s(&file, fullPath.c_str(), "rb");
-		if (err == 0)
-		{
-			fclose(file);
-			if (m_materialInfo.emissionTexturePath.empty())
-			{
-				m_materialInfo.emissionTexturePath = fullPath;
-				LOG("    -> Found emission texture: " + fullPath);
-				break;
-			}
-		}
-	}
-	
-	// Look for AO (Ambient Occlusion) textures
-	vector<string> aoTextures = {
-		"internal_ground_ao_texture.jpeg",
-		"ao.png",
-		"ao.tga",
-		"ao.jpg"
-	};
-	
-	for (const string& textureName : aoTextures)
-	{
-		string fullPath = texturesDir + textureName;
-		FILE* file;
-		errno_t err = fopen_s(&file, fullPath.c_str(), "rb");
-		if (err == 0)
-		{
-			fclose(file);
-			if (m_materialInfo.aoTexturePath.empty())
-			{
-				m_materialInfo.aoTexturePath = fullPath;
-				LOG("    -> Found AO texture: " + fullPath);
-				break;
-			}
-		}
-	}
-}
-
-void Model::ListAllMaterialProperties(FbxSurfaceMaterial* material)
-{
-	if (!material)
-		return;
-
-	LOG("=== Listing All Material Properties ===");
-	
-	// Get all properties from the material
-	FbxProperty prop = material->GetFirstProperty();
-	while (prop.IsValid())
-	{
-		string propName = prop.GetName().Buffer();
-		string propType = prop.GetPropertyDataType().GetName();
-		
-		LOG("Property: " + propName + " (Type: " + propType + ")");
-		
-		// Check if this property has textures
-		int textureCount = prop.GetSrcObjectCount<FbxTexture>();
-		if (textureCount > 0)
-		{
-			LOG("  -> Has " + std::to_string(textureCount) + " texture(s)");
-			for (int i = 0; i < textureCount; i++)
+			LOG("  -> Has " + std::to_string(textureCount) + " texture(s)");
+			for (int i = 0; i < textureCount; i++)
 			{
 				FbxTexture* texture = prop.GetSrcObject<FbxTexture>(i);
 				if (texture)
@@ -1303,7 +1548,7 @@ const FbxFileTexture* Model::FindConnectedFileTexture(const FbxProperty& propert
 }
 
 
-void Model::ProcessMesh(FbxNode* pNode)
+void Model::ProcessMesh(FbxNode* pNode, MeshBuilder& builder)
 {
 	FbxMesh* lMesh = pNode->GetMesh();
 	if (!lMesh)
@@ -1311,99 +1556,366 @@ void Model::ProcessMesh(FbxNode* pNode)
 		return;
 	}
 
-
-	static std::vector<ModelType> vertices;
-	static std::vector<unsigned long> indices;
-
 	// Get the control points (positions)
 	FbxVector4* lControlPoints = lMesh->GetControlPoints();
 
+	// Skin weights per control point, every polygon-vertex copies those of its point.
+	std::vector<AnimationTypes::SkinInfluence> pointInfluences;
+	if (!m_skeleton.joints.empty())
+	{
+		ProcessSkin(pNode, lMesh, pointInfluences);
+	}
+
 	// Get the first UV set name
 	FbxStringList lUVSetNameList;
 	lMesh->GetUVSetNames(lUVSetNameList);
 	const char* uvSetName = lUVSetNameList.GetCount() > 0 ? lUVSetNameList.GetStringAt(0) : nullptr;
 
+	// Map the node's material slots to the model's material table.
+	std::vector<int> slotMaterials(pNode->GetMaterialCount());
+	for (int i = 0; i < (int)slotMaterials.size(); i++)
+	{
+		auto it = m_fbxMaterialIndices.find(pNode->GetMaterial(i));
+		slotMaterials[i] = it != m_fbxMaterialIndices.end() ? it->second : GetDefaultMaterialIndex(pNode->GetScene());
+	}
+
+	FbxGeometryElementMaterial* lMaterialElement = lMesh->GetElementMaterial();
+	bool materialByPolygon = lMaterialElement && lMaterialElement->GetMappingMode() == FbxGeometryElement::eByPolygon;
+	int materialSlotCount = lMaterialElement ? lMaterialElement->GetIndexArray().GetCount() : 0;
+
 	int polygonCount = lMesh->GetPolygonCount();
 	for (int polyIdx = 0; polyIdx < polygonCount; ++polyIdx)
 	{
+		// eAllSame stores a single slot for the whole mesh
+		int slot = -1;
+		if (materialSlotCount > 0)
+		{
+			slot = lMaterialElement->GetIndexArray().GetAt(materialByPolygon && polyIdx < materialSlotCount ? polyIdx : 0);
+		}
+		int materialIndex = slot >= 0 && slot < (int)slotMaterials.size() ? slotMaterials[slot] : GetDefaultMaterialIndex(pNode->GetScene());
+
+		// Triangulated, so should always be 3. Anything larger is fanned, each triangle with its
+		// own vertices so the vertex list stays a triangle list for the tangent pass.
 		int polySize = lMesh->GetPolygonSize(polyIdx);
-		// Triangulated, so should always be 3
-		for (int vertIdx = 0; vertIdx < polySize; ++vertIdx)
+		for (int fanIdx = 1; fanIdx + 1 < polySize; ++fanIdx)
 		{
-			ModelType v = {};
-			int ctrlPointIdx = lMesh->GetPolygonVertex(polyIdx, vertIdx);
-			FbxVector4 pos = lControlPoints[ctrlPointIdx];
-			v.x = (float)pos[0];
-			v.y = (float)pos[1];
-			v.z = (float)pos[2];
-
-			// Normal (per polygon-vertex)
-			FbxVector4 normal;
-			lMesh->GetPolygonVertexNormal(polyIdx, vertIdx, normal);
-			v.nx = (float)normal[0];
-			v.ny = (float)normal[1];
-			v.nz = (float)normal[2];
-
-			// UV (per polygon-vertex)
-			v.tu = 0.0f;
-			v.tv = 0.0f;
-			if (uvSetName)
+			int corners[3] = { 0, fanIdx, fanIdx + 1 };
+			IndexType triangle[3];
+
+			for (int corner = 0; corner < 3; ++corner)
 			{
-				FbxVector2 uv;
-				bool unmapped;
-				if (lMesh->GetPolygonVertexUV(polyIdx, vertIdx, uvSetName, uv, unmapped))
+				int vertIdx = corners[corner];
+				ModelType v = {};
+				int ctrlPointIdx = lMesh->GetPolygonVertex(polyIdx, vertIdx);
+				FbxVector4 pos = lControlPoints[ctrlPointIdx];
+				v.x = (float)pos[0];
+				v.y = (float)pos[1];
+				v.z = (float)pos[2];
+
+				// Normal (per polygon-vertex)
+				FbxVector4 normal;
+				lMesh->GetPolygonVertexNormal(polyIdx, vertIdx, normal);
+				v.nx = (float)normal[0];
+				v.ny = (float)normal[1];
+				v.nz = (float)normal[2];
+
+				// UV (per polygon-vertex)
+				v.tu = 0.0f;
+				v.tv = 0.0f;
+				if (uvSetName)
+				{
+					FbxVector2 uv;
+					bool unmapped;
+					if (lMesh->GetPolygonVertexUV(polyIdx, vertIdx, uvSetName, uv, unmapped))
+					{
+						v.tu = (float)uv[0];
+						v.tv = (float)uv[1];
+					}
+				}
+
+				triangle[corner] = builder.AddVertex(v);
+				if (!pointInfluences.empty())
 				{
-					v.tu = (float)uv[0];
-					v.tv = (float)uv[1];
+					m_skinInfluences.push_back(pointInfluences[ctrlPointIdx]);
 				}
 			}
 
-			// Add vertex and index
-			vertices.push_back(v);
-			indices.push_back((unsigned long)vertices.size() - 1);
+			builder.AddTriangle((unsigned int)materialIndex, triangle[0], triangle[1], triangle[2]);
 		}
 	}
 
-	// After all meshes are processed, copy to m_model and m_indices (do this only once, after all ProcessMesh calls)
-	// We'll do this in LoadFBXModel after ProcessNode
-	m_vertexCount = (int)vertices.size();
-	m_indexCount = (int)indices.size();
+	LOG("ProcessMesh: " + std::string(pNode->GetName()) + " - " + std::to_string(polygonCount) + " polygons, " +
+		std::to_string(builder.GetVertexCount()) + " vertices accumulated");
+}
 
-	LOG("ProcessMesh: Vertex count: " + std::to_string(m_vertexCount) + ", Index count: " + std::to_string(m_indexCount));
 
-	if (m_model)
+void Model::ImportSkeleton(FbxNode* rootNode)
+{
+	// Bones that only appear as cluster links (no skeleton attribute) are joints too.
+	std::unordered_set<FbxNode*> links;
+	CollectSkinLinks(rootNode, links);
+	if (links.empty())
 	{
-		delete[] m_model;
+		return;
 	}
-	if (m_indices)
+
+	CollectJoints(rootNode, nullptr, links);
+
+	LOG("ImportSkeleton - " + std::to_string(m_skeleton.joints.size()) + " joints, " + std::to_string(links.size()) + " skinned");
+}
+
+
+void Model::CollectSkinLinks(FbxNode* pNode, std::unordered_set<FbxNode*>& links)
+{
+	if (!pNode)
 	{
-		delete[] m_indices;
+		return;
 	}
 
-	m_model = new ModelType[m_vertexCount];
-	m_indices = new unsigned long[m_indexCount];
-	
-	for (int i = 0; i < m_vertexCount; ++i)
+	FbxMesh* lMesh = pNode->GetMesh();
+	if (lMesh)
 	{
-		m_model[i] = vertices[i];
+		for (int d = 0; d < lMesh->GetDeformerCount(FbxDeformer::eSkin); d++)
+		{
+			FbxSkin* skin = (FbxSkin*)lMesh->GetDeformer(d, FbxDeformer::eSkin);
+			for (int c = 0; c < skin->GetClusterCount(); c++)
+			{
+				FbxNode* link = skin->GetCluster(c)->GetLink();
+				if (link)
+				{
+					links.insert(link);
+				}
+			}
+		}
 	}
-	
-	for (int i = 0; i < m_indexCount; ++i)
+
+	for (int i = 0; i < pNode->GetChildCount(); i++)
+	{
+		CollectSkinLinks(pNode->GetChild(i), links);
+	}
+}
+
+
+void Model::CollectJoints(FbxNode* pNode, FbxNode* parentJoint, const std::unordered_set<FbxNode*>& links)
+{
+	if (!pNode)
+	{
+		return;
+	}
+
+	FbxNodeAttribute* attribute = pNode->GetNodeAttribute();
+	bool isJoint = links.count(pNode) > 0 || (attribute && attribute->GetAttributeType() == FbxNodeAttribute::eSkeleton);
+
+	// Depth first, so every parent is stored before its children.
+	if (isJoint)
+	{
+		AnimationTypes::Joint joint;
+		joint.name = pNode->GetName();
+		joint.parent = parentJoint ? m_fbxJointIndices[parentJoint] : -1;
+		joint.bindLocal = ToTransform(GetJointLocalTransform(pNode, parentJoint));
+
+		// Replaced by the cluster's bind matrix if the joint has skinned vertices.
+		if (!AnimationSampler::Invert(ToJointMatrix(pNode->EvaluateGlobalTransform()), joint.inverseBind))
+		{
+			AnimationSampler::Identity(joint.inverseBind);
+		}
+
+		m_fbxJointIndices[pNode] = (int)m_skeleton.joints.size();
+		m_skeleton.joints.push_back(joint);
+		parentJoint = pNode;
+	}
+
+	for (int i = 0; i < pNode->GetChildCount(); i++)
 	{
-		m_indices[i] = indices[i];
+		CollectJoints(pNode->GetChild(i), parentJoint, links);
+	}
+}
+
+
+void Model::ProcessSkin(FbxNode* pNode, FbxMesh* mesh, std::vector<AnimationTypes::SkinInfluence>& pointInfluences)
+{
+	SkinWeightBuilder weights;
+	SkinWeightBuilder::Stats stats;
+
+
+	weights.Reset((size_t)mesh->GetControlPointsCount());
+
+	// Control points are in the mesh's own space, including its geometric offset.
+	FbxAMatrix geometryTransform(pNode->GetGeometricTranslation(FbxNode::eSourcePivot),
+		pNode->GetGeometricRotation(FbxNode::eSourcePivot), pNode->GetGeometricScaling(FbxNode::eSourcePivot));
+
+	for (int d = 0; d < mesh->GetDeformerCount(FbxDeformer::eSkin); d++)
+	{
+		FbxSkin* skin = (FbxSkin*)mesh->GetDeformer(d, FbxDeformer::eSkin);
+		for (int c = 0; c < skin->GetClusterCount(); c++)
+		{
+			FbxCluster* cluster = skin->GetCluster(c);
+			auto joint = m_fbxJointIndices.find(cluster->GetLink());
+			if (joint == m_fbxJointIndices.end())
+			{
+				continue;
+			}
+
+			// Mesh space to joint space, as the mesh and the joint were placed when binding.
+			FbxAMatrix meshBindTransform, jointBindTransform;
+			cluster->GetTransformMatrix(meshBindTransform);
+			cluster->GetTransformLinkMatrix(jointBindTransform);
+			FbxAMatrix inverseBind = jointBindTransform.Inverse() * meshBindTransform * geometryTransform;
+			m_skeleton.joints[joint->second].inverseBind = ToJointMatrix(inverseBind);
+
+			int* pointIndices = cluster->GetControlPointIndices();
+			double* pointWeights = cluster->GetControlPointWeights();
+			for (int i = 0; i < cluster->GetControlPointIndicesCount(); i++)
+			{
+				weights.AddInfluence((size_t)pointIndices[i], (unsigned int)joint->second, (float)pointWeights[i]);
+			}
+		}
+	}
+
+	// Meshes without a skin of their own follow the joint they hang from.
+	unsigned int fallbackJoint = 0;
+	for (FbxNode* node = pNode; node; node = node->GetParent())
+	{
+		auto joint = m_fbxJointIndices.find(node);
+		if (joint != m_fbxJointIndices.end())
+		{
+			fallbackJoint = (unsigned int)joint->second;
+			break;
+		}
+	}
+
+	weights.Build(fallbackJoint, pointInfluences, &stats);
+
+	m_skinStats.pointCount += stats.pointCount;
+	m_skinStats.truncatedPoints += stats.truncatedPoints;
+	m_skinStats.unweightedPoints += stats.unweightedPoints;
+	m_skinStats.maxInfluences = std::max(m_skinStats.maxInfluences, stats.maxInfluences);
+	m_skinStats.maxDroppedWeight = std::max(m_skinStats.maxDroppedWeight, stats.maxDroppedWeight);
+}
+
+
+void Model::ImportAnimations(FbxScene* scene)
+{
+	double frameRate = FbxTime::GetFrameRate(scene->GetGlobalSettings().GetTimeMode());
+	if (frameRate <= 0.0)
+	{
+		frameRate = 30.0;
+	}
+
+	// Every take is baked to one key per frame, whatever curves or constraints drive it.
+	int stackCount = scene->GetSrcObjectCount<FbxAnimStack>();
+	for (int stackIndex = 0; stackIndex < stackCount; stackIndex++)
+	{
+		FbxAnimStack* stack = scene->GetSrcObject<FbxAnimStack>(stackIndex);
+		scene->SetCurrentAnimationStack(stack);
+
+		FbxTimeSpan span = stack->GetLocalTimeSpan();
+		double start = span.GetStart().GetSecondDouble();
+		double duration = span.GetDuration().GetSecondDouble();
+		if (duration <= 0.0)
+		{
+			continue;
+		}
+
+		AnimationTypes::AnimationClip clip;
+		clip.name = stack->GetName();
+		clip.duration = (float)duration;
+		clip.tracks.resize(m_skeleton.joints.size());
+
+		// Nodes by joint, for the parent of each.
+		std::vector<FbxNode*> jointNodes(m_skeleton.joints.size());
+		for (auto& joint : m_fbxJointIndices)
+		{
+			jointNodes[joint.second] = joint.first;
+		}
+
+		int frameCount = (int)(duration * frameRate + 0.5) + 1;
+		for (auto& joint : m_fbxJointIndices)
+		{
+			int parent = m_skeleton.joints[joint.second].parent;
+			FbxNode* parentJoint = parent >= 0 ? jointNodes[parent] : nullptr;
+
+			AnimationTypes::JointTrack& track = clip.tracks[joint.second];
+			track.joint = (uint32_t)joint.second;
+			track.translations.resize(frameCount);
+			track.rotations.resize(frameCount);
+			track.scales.resize(frameCount);
+
+			for (int frame = 0; frame < frameCount; frame++)
+			{
+				double seconds = std::min(frame / frameRate, duration);
+				FbxTime time;
+				time.SetSecondDouble(start + seconds);
+				AnimationTypes::Transform transform = ToTransform(GetJointLocalTransform(joint.first, parentJoint, time));
+
+				// Keep neighbouring rotations in the same hemisphere for interpolation.
+				if (frame > 0)
+				{
+					const float* previous = track.rotations[frame - 1].value;
+					float dot = previous[0] * transform.rotation[0] + previous[1] * transform.rotation[1] +
+						previous[2] * transform.rotation[2] + previous[3] * transform.rotation[3];
+					if (dot < 0.0f)
+					{
+						for (int i = 0; i < 4; i++)
+						{
+							transform.rotation[i] = -transform.rotation[i];
+						}
+					}
+				}
+
+				track.translations[frame].time = (float)seconds;
+				track.rotations[frame].time = (float)seconds;
+				track.scales[frame].time = (float)seconds;
+				std::copy(transform.translation, transform.translation + 3, track.translations[frame].value);
+				std::copy(transform.rotation, transform.rotation + 4, track.rotations[frame].value);
+				std::copy(transform.scale, transform.scale + 3, track.scales[frame].value);
+			}
+		}
+
+		LOG("ImportAnimations - " + clip.name + ": " + std::to_string(clip.duration) + " s, " + std::to_string(frameCount) + " frames");
+
+		// Characters play the compressed copy, the baked keys stay for tools.
+		AnimationTypes::CompressedClip compressed;
+		ClipCompressor::Stats compressionStats;
+		if (ClipCompressor::Compress(clip, m_skeleton, m_clipCompressionSettings, compressed, &compressionStats))
+		{
+			LOG("ImportAnimations - " + ClipCompressor::FormatStats(compressionStats, m_skeleton));
+			LOG(ClipCompressor::FormatJointErrors(compressionStats, m_skeleton));
+		}
+		else
+		{
+			LOG_WARNING("ImportAnimations - Could not compress clip " + clip.name);
+		}
+		m_compressedClips.push_back(std::move(compressed));
+		m_animationClips.push_back(std::move(clip));
 	}
+}
+
+
+void Model::RemapSkinInfluences(const std::vector<IndexType>& remap, size_t vertexCount)
+{
+	std::vector<AnimationTypes::SkinInfluence> influences(vertexCount);
+	std::vector<bool> written(vertexCount, false);
 
-	// Clear static vectors for next model load
-	if (pNode->GetParent() == nullptr) // root node, last call
+	// Merged vertices keep the weights of the first one, they share position, normal and UV.
+	for (size_t i = 0; i < remap.size() && i < m_skinInfluences.size(); i++)
 	{
-		vertices.clear();
-		indices.clear();
+		IndexType target = remap[i];
+		if (target < vertexCount && !written[target])
+		{
+			influences[target] = m_skinInfluences[i];
+			written[target] = true;
+		}
 	}
+
+	m_skinInfluences.swap(influences);
 }
 
 
 void Model::ReleaseModel()
 {
+	m_cookedMesh.Close();
+
 	if (m_model)
 	{
 		delete[] m_model;
@@ -1419,335 +1931,313 @@ void Model::ReleaseModel()
 	return;
 }
 
-void Model::CalculateModelVectors()
+bool Model::CalculateModelVectors()
 {
-	int faceCount, i, index;
-	TempVertexType vertex1, vertex2, vertex3;
-	VectorType tangent, binormal;
-
+	bool result;
 
-	// Calculate the number of faces in the model.
-	faceCount = m_vertexCount / 3;
 
-	// Initialize the index to the model data.
-	index = 0;
+	if (!m_model || m_vertexCount <= 0)
+	{
+		return true;
+	}
 
-	// Go through all the faces and calculate the the tangent and binormal vectors.
-	for (i = 0; i < faceCount; i++)
+	// Per-vertex frames, so this runs on the welded mesh where neighbouring faces share vertices.
+	result = TangentGenerator::Generate(m_model, (size_t)m_vertexCount, m_indices, (size_t)m_indexCount, m_tangentSettings, &m_tangentStats);
+	if (!result)
 	{
-		// Get the three vertices for this face from the model.
-		vertex1.x = m_model[index].x;
-		vertex1.y = m_model[index].y;
-		vertex1.z = m_model[index].z;
-		vertex1.tu = m_model[index].tu;
-		vertex1.tv = m_model[index].tv;
-		index++;
+		LOG_ERROR("CalculateModelVectors: Index data references vertices outside the mesh");
+		return false;
+	}
+
+	LOG(TangentGenerator::FormatStats(m_tangentStats));
 
-		vertex2.x = m_model[index].x;
-		vertex2.y = m_model[index].y;
-		vertex2.z = m_model[index].z;
-		vertex2.tu = m_model[index].tu;
-		vertex2.tv = m_model[index].tv;
-		index++;
+	return true;
+}
 
-		vertex3.x = m_model[index].x;
-		vertex3.y = m_model[index].y;
-		vertex3.z = m_model[index].z;
-		vertex3.tu = m_model[index].tu;
-		vertex3.tv = m_model[index].tv;
-		index++;
+bool Model::WeldVertices()
+{
+	std::vector<ModelType> vertices;
+	std::vector<IndexType> indices;
+	std::vector<IndexType> remap;
+	bool result;
 
-		// Calculate the tangent and binormal of that face.
-		CalculateTangentBinormal(vertex1, vertex2, vertex3, tangent, binormal);
 
-		// Store the tangent and binormal for this face back in the model structure.
-		m_model[index - 1].tx = tangent.x;
-		m_model[index - 1].ty = tangent.y;
-		m_model[index - 1].tz = tangent.z;
-		m_model[index - 1].bx = binormal.x;
-		m_model[index - 1].by = binormal.y;
-		m_model[index - 1].bz = binormal.z;
+	if (!m_model || m_vertexCount <= 0)
+	{
+		LOG_WARNING("WeldVertices: No model data to weld");
+		return true;
+	}
+
+	result = MeshWelder::Weld(m_model, (size_t)m_vertexCount, m_indices, (size_t)m_indexCount, m_weldSettings, vertices, indices,
+		HasSkin() ? &remap : nullptr, &m_weldStats);
+	if (!result)
+	{
+		LOG_ERROR("WeldVertices: Index data references vertices outside the mesh");
+		return false;
+	}
 
-		m_model[index - 2].tx = tangent.x;
-		m_model[index - 2].ty = tangent.y;
-		m_model[index - 2].tz = tangent.z;
-		m_model[index - 2].bx = binormal.x;
-		m_model[index - 2].by = binormal.y;
-		m_model[index - 2].bz = binormal.z;
+	LOG(MeshWelder::FormatStats(m_weldStats));
 
-		m_model[index - 3].tx = tangent.x;
-		m_model[index - 3].ty = tangent.y;
-		m_model[index - 3].tz = tangent.z;
-		m_model[index - 3].bx = binormal.x;
-		m_model[index - 3].by = binormal.y;
-		m_model[index - 3].bz = binormal.z;
+	if (HasSkin())
+	{
+		RemapSkinInfluences(remap, vertices.size());
 	}
 
-	return;
+	// Replace the unwelded data with the indexed mesh.
+	ReleaseModel();
+
+	m_vertexCount = (int)vertices.size();
+	m_indexCount = (int)indices.size();
+
+	m_model = new ModelType[m_vertexCount];
+	m_indices = new IndexType[m_indexCount];
+
+	std::copy(vertices.begin(), vertices.end(), m_model);
+	std::copy(indices.begin(), indices.end(), m_indices);
+
+	return true;
 }
 
-void Model::CalculateTangentBinormal(TempVertexType vertex1, TempVertexType vertex2, TempVertexType vertex3, VectorType& tangent, VectorType& binormal)
+bool Model::OptimizeMesh()
 {
-	float vector1[3], vector2[3];
-	float tuVector[2], tvVector[2];
-	float den;
-	float length;
+	std::vector<IndexType> remap;
+	size_t vertexCount;
+	bool result;
 
 
-	// Calculate the two vectors for this face.
-	vector1[0] = vertex2.x - vertex1.x;
-	vector1[1] = vertex2.y - vertex1.y;
-	vector1[2] = vertex2.z - vertex1.z;
+	if (!m_model || !m_indices || m_indexCount <= 0)
+	{
+		LOG_WARNING("OptimizeMesh: No indexed model data to optimize");
+		return true;
+	}
+
+	vertexCount = (size_t)m_vertexCount;
+	// Triangles are only reordered within their submesh so the draw ranges stay valid.
+	result = MeshOptimizer::Optimize(m_model, vertexCount, m_indices, (size_t)m_indexCount, m_optimizerSettings, &m_optimizerStats,
+		m_submeshes.data(), m_submeshes.size(), HasSkin() ? &remap : nullptr);
+	if (!result)
+	{
+		LOG_ERROR("OptimizeMesh: Mesh is not a valid indexed triangle list");
+		return false;
+	}
 
-	vector2[0] = vertex3.x - vertex1.x;
-	vector2[1] = vertex3.y - vertex1.y;
-	vector2[2] = vertex3.z - vertex1.z;
+	// Unreferenced vertices were compacted away by the vertex fetch pass.
+	m_vertexCount = (int)vertexCount;
+	if (HasSkin() && !remap.empty())
+	{
+		RemapSkinInfluences(remap, vertexCount);
+	}
 
-	// Calculate the tu and tv texture space vectors.
-	tuVector[0] = vertex2.tu - vertex1.tu;
-	tvVector[0] = vertex2.tv - vertex1.tv;
+	LOG(MeshOptimizer::FormatStats(m_optimizerStats));
 
-	tuVector[1] = vertex3.tu - vertex1.tu;
-	tvVector[1] = vertex3.tv - vertex1.tv;
+	return true;
+}
 
-	// Calculate the denominator of the tangent/binormal equation.
-	den = 1.0f / (tuVector[0] * tvVector[1] - tuVector[1] * tvVector[0]);
+bool Model::GenerateLODs()
+{
+	std::vector<IndexType> indices;
+	bool result;
 
-	// Calculate the cross products and multiply by the coefficient to get the tangent and binormal.
-	tangent.x = (tvVector[1] * vector1[0] - tvVector[0] * vector2[0]) * den;
-	tangent.y = (tvVector[1] * vector1[1] - tvVector[0] * vector2[1]) * den;
-	tangent.z = (tvVector[1] * vector1[2] - tvVector[0] * vector2[2]) * den;
 
-	binormal.x = (tuVector[0] * vector2[0] - tuVector[1] * vector1[0]) * den;
-	binormal.y = (tuVector[0] * vector2[1] - tuVector[1] * vector1[1]) * den;
-	binormal.z = (tuVector[0] * vector2[2] - tuVector[1] * vector1[2]) * den;
+	if (!m_model || !m_indices || m_indexCount <= 0)
+	{
+		return true;
+	}
 
-	// Calculate the length of this normal.
-	length = sqrt((tangent.x * tangent.x) + (tangent.y * tangent.y) + (tangent.z * tangent.z));
+	indices.assign(m_indices, m_indices + m_indexCount);
 
-	// Normalize the normal and then store it
-	tangent.x = tangent.x / length;
-	tangent.y = tangent.y / length;
-	tangent.z = tangent.z / length;
+	result = MeshSimplifier::GenerateLods(m_model, (size_t)m_vertexCount, indices, m_submeshes, m_lods, m_lodSettings, &m_lodStats);
+	if (!result)
+	{
+		m_lods.clear();
+		return false;
+	}
 
-	// Calculate the length of this normal.
-	length = sqrt((binormal.x * binormal.x) + (binormal.y * binormal.y) + (binormal.z * binormal.z));
+	LOG(MeshSimplifier::FormatStats(m_lodStats));
 
-	// Normalize the normal and then store it
-	binormal.x = binormal.x / length;
-	binormal.y = binormal.y / length;
-	binormal.z = binormal.z / length;
+	// The levels were appended behind LOD 0, the index buffer covers all of them.
+	delete[] m_indices;
+	m_indexCount = (int)indices.size();
+	m_indices = new IndexType[m_indexCount];
+	std::copy(indices.begin(), indices.end(), m_indices);
 
-	return;
+	return true;
 }
 
-void Model::CalculateBoundingBox()
+bool Model::BuildMeshlets()
 {
-	if (!m_model || m_vertexCount == 0)
+	bool result;
+
+
+	if (!m_model || !m_indices || m_indexCount <= 0)
 	{
-		// Set default values if no model data
-		m_boundingBox.min = XMFLOAT3(0.0f, 0.0f, 0.0f);
-		m_boundingBox.max = XMFLOAT3(0.0f, 0.0f, 0.0f);
-		m_boundingBox.radius = 0.0f;
-		LOG_WARNING("CalculateBoundingBox - No model data available, using default bounding box");
-		return;
+		return true;
 	}
 
-	LOG("CalculateBoundingBox - Calculating bounding box for " + std::to_string(m_vertexCount) + " vertices");
+	result = MeshletBuilder::Build(m_model, (size_t)m_vertexCount, m_indices, m_submeshes.data(), m_submeshes.size(), m_meshletSettings, m_meshlets, &m_meshletStats);
+	if (!result)
+	{
+		m_meshlets.clear();
+		return false;
+	}
 
-	// Initialize min/max with the first vertex
-	m_boundingBox.min = XMFLOAT3(m_model[0].x, m_model[0].y, m_model[0].z);
-	m_boundingBox.max = XMFLOAT3(m_model[0].x, m_model[0].y, m_model[0].z);
+	LOG(MeshletBuilder::FormatStats(m_meshletStats));
 
-	// Find the min/max bounds
-	for (int i = 1; i < m_vertexCount; i++)
-	{
-		// Update min bounds
-		m_boundingBox.min.x = min(m_boundingBox.min.x, m_model[i].x);
-		m_boundingBox.min.y = min(m_boundingBox.min.y, m_model[i].y);
-		m_boundingBox.min.z = min(m_boundingBox.min.z, m_model[i].z);
+	return true;
+}
 
-		// Update max bounds
-		m_boundingBox.max.x = max(m_boundingBox.max.x, m_model[i].x);
-		m_boundingBox.max.y = max(m_boundingBox.max.y, m_model[i].y);
-		m_boundingBox.max.z = max(m_boundingBox.max.z, m_model[i].z);
+void Model::IndexSubmeshMeshlets()
+{
+	// Meshlets are stored in submesh order, count them per submesh and sum up.
+	size_t submeshCount = m_lods.empty() ? m_submeshes.size() : (size_t)m_lods[0].submeshCount;
+	m_submeshMeshletOffsets.assign(submeshCount + 1, 0);
+	for (const Meshlet& meshlet : m_meshlets)
+	{
+		m_submeshMeshletOffsets[meshlet.submeshIndex + 1]++;
 	}
+	for (size_t i = 0; i < submeshCount; i++)
+	{
+		m_submeshMeshletOffsets[i + 1] += m_submeshMeshletOffsets[i];
+	}
+}
 
-	// Calculate the radius for sphere culling (distance from center to furthest point)
-	XMFLOAT3 center;
-	center.x = (m_boundingBox.min.x + m_boundingBox.max.x) * 0.5f;
-	center.y = (m_boundingBox.min.y + m_boundingBox.max.y) * 0.5f;
-	center.z = (m_boundingBox.min.z + m_boundingBox.max.z) * 0.5f;
-
-	float maxDistSq = 0.0f;
-	for (int i = 0; i < m_vertexCount; i++)
+const Model::Meshlet* Model::GetSubmeshMeshlets(int submeshIndex, int& meshletCount) const
+{
+	if (submeshIndex < 0 || submeshIndex + 1 >= (int)m_submeshMeshletOffsets.size())
 	{
-		float dx = m_model[i].x - center.x;
-		float dy = m_model[i].y - center.y;
-		float dz = m_model[i].z - center.z;
-		float distSq = dx * dx + dy * dy + dz * dz;
-		maxDistSq = max(maxDistSq, distSq);
+		meshletCount = 0;
+		return nullptr;
 	}
 
-	m_boundingBox.radius = sqrt(maxDistSq);
-	
-	LOG("CalculateBoundingBox - Bounding box calculated:");
-	LOG("  Min: (" + std::to_string(m_boundingBox.min.x) + ", " + std::to_string(m_boundingBox.min.y) + ", " + std::to_string(m_boundingBox.min.z) + ")");
-	LOG("  Max: (" + std::to_string(m_boundingBox.max.x) + ", " + std::to_string(m_boundingBox.max.y) + ", " + std::to_string(m_boundingBox.max.z) + ")");
-	LOG("  Center: (" + std::to_string(center.x) + ", " + std::to_string(center.y) + ", " + std::to_string(center.z) + ")");
-	LOG("  Radius: " + std::to_string(m_boundingBox.radius));
+	meshletCount = (int)(m_submeshMeshletOffsets[submeshIndex + 1] - m_submeshMeshletOffsets[submeshIndex]);
+	return meshletCount > 0 ? &m_meshlets[m_submeshMeshletOffsets[submeshIndex]] : nullptr;
 }
 
-bool Model::LoadFBXTextures(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+int Model::SelectLOD(float distance, float worldScale, float projectionScale, float maxScreenError) const
 {
-	bool result = true;
-	int loadedTextures = 0;
+	int lod = 0;
 
-	LOG("=== FBX Texture Loading Report ===");
-	LOG("Diffuse texture: " + (m_materialInfo.diffuseTexturePath.empty() ? "NOT FOUND" : m_materialInfo.diffuseTexturePath));
-	LOG("Normal texture: " + (m_materialInfo.normalTexturePath.empty() ? "NOT FOUND" : m_materialInfo.normalTexturePath));
-	LOG("Specular texture: " + (m_materialInfo.specularTexturePath.empty() ? "NOT FOUND" : m_materialInfo.specularTexturePath));
-	LOG("Metallic texture: " + (m_materialInfo.metallicTexturePath.empty() ? "NOT FOUND" : m_materialInfo.metallicTexturePath));
-	LOG("Roughness texture: " + (m_materialInfo.roughnessTexturePath.empty() ? "NOT FOUND" : m_materialInfo.roughnessTexturePath));
-	LOG("Emission texture: " + (m_materialInfo.emissionTexturePath.empty() ? "NOT FOUND" : m_materialInfo.emissionTexturePath));
-	LOG("AO texture: " + (m_materialInfo.aoTexturePath.empty() ? "NOT FOUND" : m_materialInfo.aoTexturePath));
 
-	// Load diffuse texture (most important)
-	if (!m_materialInfo.diffuseTexturePath.empty())
+	if (distance <= 0.0f)
 	{
-		string convertedPath = ConvertTexturePath(m_materialInfo.diffuseTexturePath);
-		LOG("Attempting to load diffuse texture: " + convertedPath);
-		
-		m_diffuseTexture = new Texture();
-		result = m_diffuseTexture->Initialize(device, deviceContext, (char*)convertedPath.c_str());
-		if (result)
-		{
-			LOG("✓ Successfully loaded diffuse texture");
-			loadedTextures++;
-		}
-		else
-		{
-			LOG_ERROR("✗ Failed to load diffuse texture: " + convertedPath);
-			delete m_diffuseTexture;
-			m_diffuseTexture = nullptr;
-		}
+		return 0;
 	}
 
-	// Load normal texture
-	if (!m_materialInfo.normalTexturePath.empty())
+	// Errors only grow along the chain, so the first level that projects too large ends the search.
+	for (int i = 1; i < (int)m_lods.size(); i++)
 	{
-		string convertedPath = ConvertTexturePath(m_materialInfo.normalTexturePath);
-		LOG("Attempting to load normal texture: " + convertedPath);
-		
-		m_normalTexture = new Texture();
-		result = m_normalTexture->Initialize(device, deviceContext, (char*)convertedPath.c_str());
-		if (result)
-		{
-			LOG("✓ Successfully loaded normal texture");
-			loadedTextures++;
-		}
-		else
+		float screenError = m_lods[i].error * worldScale / distance * projectionScale;
+		if (screenError > maxScreenError)
 		{
-			LOG_ERROR("✗ Failed to load normal texture: " + convertedPath);
-			delete m_normalTexture;
-			m_normalTexture = nullptr;
+			break;
 		}
+		lod = i;
 	}
 
-	// Load metallic texture
-	if (!m_materialInfo.metallicTexturePath.empty())
+	return lod;
+}
+
+void Model::CalculateBoundingBox()
+{
+	if (!m_model || m_vertexCount == 0 || !BoundsCalculator::Compute(m_model, (size_t)m_vertexCount, m_bounds, m_boundsSettings, &m_boundsStats))
 	{
-		string convertedPath = ConvertTexturePath(m_materialInfo.metallicTexturePath);
-		LOG("Attempting to load metallic texture: " + convertedPath);
-		
-		m_metallicTexture = new Texture();
-		result = m_metallicTexture->Initialize(device, deviceContext, (char*)convertedPath.c_str());
-		if (result)
-		{
-			LOG("✓ Successfully loaded metallic texture");
-			loadedTextures++;
-		}
-		else
-		{
-			LOG_ERROR("✗ Failed to load metallic texture: " + convertedPath);
-			delete m_metallicTexture;
-			m_metallicTexture = nullptr;
-		}
+		// Set default values if no model data
+		m_bounds = {};
+		m_boundingBox.min = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		m_boundingBox.max = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		m_boundingBox.radius = 0.0f;
+		LOG_WARNING("CalculateBoundingBox - No model data available, using default bounding box");
+		return;
 	}
 
-	// Load roughness texture
-	if (!m_materialInfo.roughnessTexturePath.empty())
+	// The AABB stays for submeshes and GPU culling, the radius now belongs to the tighter sphere around m_bounds.center.
+	m_boundingBox.min = XMFLOAT3(m_bounds.min[0], m_bounds.min[1], m_bounds.min[2]);
+	m_boundingBox.max = XMFLOAT3(m_bounds.max[0], m_bounds.max[1], m_bounds.max[2]);
+	m_boundingBox.radius = m_bounds.radius;
+
+	LOG("CalculateBoundingBox - " + BoundsCalculator::FormatStats(m_boundsStats));
+}
+
+bool Model::LoadFBXTextures()
+{
+	int loadedTextures = 0;
+
+	LOG("=== FBX Texture Loading Report ===");
+
+	m_materialTextures.resize(m_materials.size());
+	for (size_t i = 0; i < m_materials.size(); i++)
 	{
-		string convertedPath = ConvertTexturePath(m_materialInfo.roughnessTexturePath);
-		LOG("Attempting to load roughness texture: " + convertedPath);
-		
-		m_roughnessTexture = new Texture();
-		result = m_roughnessTexture->Initialize(device, deviceContext, (char*)convertedPath.c_str());
-		if (result)
-		{
-			LOG("✓ Successfully loaded roughness texture");
-			loadedTextures++;
-		}
-		else
-		{
-			LOG_ERROR("✗ Failed to load roughness texture: " + convertedPath);
-			delete m_roughnessTexture;
-			m_roughnessTexture = nullptr;
-		}
+		LOG("Material " + std::to_string(i) + ":");
+		loadedTextures += LoadMaterialTextures(m_materials[i], m_materialTextures[i]);
 	}
 
-	// Load emission texture
-	if (!m_materialInfo.emissionTexturePath.empty())
+	LOG("Total textures loaded: " + std::to_string(loadedTextures));
+	LOG("=== End FBX Texture Loading Report ===");
+
+	// Don't fail if no textures were loaded - just log a warning
+	if (loadedTextures == 0)
 	{
-		string convertedPath = ConvertTexturePath(m_materialInfo.emissionTexturePath);
-		LOG("Attempting to load emission texture: " + convertedPath);
-		
-		m_emissionTexture = new Texture();
-		result = m_emissionTexture->Initialize(device, deviceContext, (char*)convertedPath.c_str());
-		if (result)
-		{
-			LOG("✓ Successfully loaded emission texture");
-			loadedTextures++;
-		}
-		else
+		LOG_WARNING("No textures were loaded from FBX materials");
+	}
+
+	return true; // Always return true for now to see the debug output
+}
+
+int Model::LoadMaterialTextures(const MaterialInfo& material, MaterialTextures& textures)
+{
+	int loadedTextures = 0;
+
+	LOG("Diffuse texture: " + (material.diffuseTexturePath.empty() ? "NOT FOUND" : material.diffuseTexturePath));
+	LOG("Normal texture: " + (material.normalTexturePath.empty() ? "NOT FOUND" : material.normalTexturePath));
+	LOG("Specular texture: " + (material.specularTexturePath.empty() ? "NOT FOUND" : material.specularTexturePath));
+	LOG("Metallic texture: " + (material.metallicTexturePath.empty() ? "NOT FOUND" : material.metallicTexturePath));
+	LOG("Roughness texture: " + (material.roughnessTexturePath.empty() ? "NOT FOUND" : material.roughnessTexturePath));
+	LOG("Emission texture: " + (material.emissionTexturePath.empty() ? "NOT FOUND" : material.emissionTexturePath));
+	LOG("AO texture: " + (material.aoTexturePath.empty() ? "NOT FOUND" : material.aoTexturePath));
+
+	const std::string* paths[] = { &material.diffuseTexturePath, &material.normalTexturePath, &material.metallicTexturePath,
+		&material.roughnessTexturePath, &material.emissionTexturePath, &material.aoTexturePath };
+	const char* types[] = { "diffuse", "normal", "metallic", "roughness", "emission", "AO" };
+	ImageTypes::TextureRole roles[] = { ImageTypes::ROLE_ALBEDO, ImageTypes::ROLE_NORMAL, ImageTypes::ROLE_MASK,
+		ImageTypes::ROLE_MASK, ImageTypes::ROLE_EMISSION, ImageTypes::ROLE_MASK };
+	Texture** slots[] = { &textures.diffuse, &textures.normal, &textures.metallic, &textures.roughness, &textures.emission, &textures.ao };
+	const size_t slotCount = sizeof(slots) / sizeof(slots[0]);
+
+	std::vector<std::string> filenames(slotCount);
+	std::vector<ImageTypes::TextureRole> batchRoles(slotCount);
+	for (size_t i = 0; i < slotCount; i++)
+	{
+		if (!paths[i]->empty())
 		{
-			LOG_ERROR("✗ Failed to load emission texture: " + convertedPath);
-			delete m_emissionTexture;
-			m_emissionTexture = nullptr;
+			filenames[i] = ConvertTexturePath(*paths[i]);
+			LOG("Attempting to load " + std::string(types[i]) + " texture: " + filenames[i]);
 		}
+		batchRoles[i] = m_useCookedTextures ? roles[i] : ImageTypes::ROLE_NONE;
 	}
 
-	// Load AO texture
-	if (!m_materialInfo.aoTexturePath.empty())
+	// All maps of the material are decoded (and cooked) at once on the job system.
+	std::vector<Texture*> loaded;
+	ResourceCache::GetInstance().AcquireTextures(filenames, batchRoles, loaded);
+
+	for (size_t i = 0; i < slotCount; i++)
 	{
-		string convertedPath = ConvertTexturePath(m_materialInfo.aoTexturePath);
-		LOG("Attempting to load AO texture: " + convertedPath);
-		
-		m_aoTexture = new Texture();
-		result = m_aoTexture->Initialize(device, deviceContext, (char*)convertedPath.c_str());
-		if (result)
+		*slots[i] = loaded[i];
+		if (filenames[i].empty())
 		{
-			LOG("✓ Successfully loaded AO texture");
-			loadedTextures++;
+			continue;
 		}
-		else
+
+		if (!loaded[i])
 		{
-			LOG_ERROR("✗ Failed to load AO texture: " + convertedPath);
-			delete m_aoTexture;
-			m_aoTexture = nullptr;
+			LOG_ERROR("✗ Failed to load " + std::string(types[i]) + " texture: " + filenames[i]);
+			continue;
 		}
-	}
-
-	LOG("Total textures loaded: " + std::to_string(loadedTextures));
-	LOG("=== End FBX Texture Loading Report ===");
 
-	// Don't fail if no textures were loaded - just log a warning
-	if (loadedTextures == 0)
-	{
-		LOG_WARNING("No textures were loaded from FBX materials");
+		LOG("✓ Successfully loaded " + std::string(types[i]) + " texture");
+		loadedTextures++;
 	}
 
-	return true; // Always return true for now to see the debug output
+	return loadedTextures;
 }
 
 string Model::ConvertTexturePath(const string& originalPath)
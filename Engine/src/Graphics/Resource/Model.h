@@ -5,12 +5,27 @@
 #include <directxmath.h>
 #include <fstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <fbxsdk.h>
 
 #include "../../Core/Common/EngineTypes.h"
 #include "../../Core/System/Logger.h"
 #include "./Texture.h"
+#include "./Mesh/MeshBuilder.h"
+#include "./Mesh/MeshWelder.h"
+#include "./Mesh/MeshOptimizer.h"
+#include "./Mesh/MeshSimplifier.h"
+#include "./Mesh/TangentGenerator.h"
+#include "./Mesh/BoundsCalculator.h"
+#include "./Mesh/MeshletBuilder.h"
+#include "./Mesh/VertexCompressor.h"
+#include "./Mesh/CookedMesh.h"
+#include "./Animation/AnimationTypes.h"
+#include "./Animation/SkinWeightBuilder.h"
+#include "./Animation/ClipCompressor.h"
+#include "./Animation/Skinning.h"
 
 using namespace DirectX;
 
@@ -24,19 +39,14 @@ public:
 	using AABB = EngineTypes::BoundingBox;
 	using VertexType = EngineTypes::VertexType;
 	using MaterialInfo = EngineTypes::MaterialInfo;
+	using Submesh = MeshTypes::Submesh;
+	using LodLevel = MeshTypes::LodLevel;
+	using MeshBounds = MeshTypes::MeshBounds;
+	using Meshlet = MeshTypes::Meshlet;
 
 private:
-	struct ModelType
-	{
-		float x, y, z;
-		float tu, tv;
-		float nx, ny, nz;
-		float tx, ty, tz;
-		float bx, by, bz;
-	};
-
-	using TempVertexType = EngineTypes::TempVertexType;
-	using VectorType = EngineTypes::VectorType;
+	using ModelType = MeshTypes::MeshVertex;
+	using IndexType = MeshTypes::IndexType;
 
 public:
 	Model();
@@ -47,17 +57,41 @@ public:
 	bool Initialize(ID3D11Device* device, ID3D11DeviceContext* context, char* modelFilename, char* textureFilename1, char* textureFilename2);
 	bool Initialize(ID3D11Device* device, ID3D11DeviceContext* context, char* modelFilename, char* textureFilename1, char* textureFilename2, char* textureFilename3);
 	bool InitializeFBX(ID3D11Device* device, ID3D11DeviceContext* context, char* modelFilename);
+
+	// The same in two stages, so the first can run on a worker thread. LoadData
+	// and LoadFBXData read and process the model and decode its textures without
+	// touching the device. CreateResources then creates the buffers and textures
+	// and must run on the thread that owns the device context.
+	bool LoadData(char* modelFilename, const std::vector<std::string>& textureFilenames);
+	bool LoadFBXData(char* modelFilename);
+	bool CreateResources(ID3D11Device* device, ID3D11DeviceContext* context);
 	
 	void Shutdown();
 	void Render(ID3D11DeviceContext* context);
 
 	// Getters
-	int GetIndexCount() const { return m_indexCount; }
+	int GetIndexCount(int lod = 0) const { return IsValidLOD(lod) ? (int)m_lods[lod].indexCount : m_indexCount; }
 	ID3D11ShaderResourceView* GetTexture() const;
 	ID3D11ShaderResourceView* GetTexture(int index) const;
 	bool HasFBXMaterial() const { return m_hasFBXMaterial; }
 	const AABB& GetBoundingBox() const { return m_boundingBox; }
+	const MeshBounds& GetBounds() const { return m_bounds; }
 	const MaterialInfo& GetMaterialInfo() const { return m_materialInfo; }
+	const MaterialInfo& GetMaterialInfo(int materialIndex) const { return m_materials[materialIndex]; }
+	int GetMaterialCount() const { return (int)m_materials.size(); }
+
+	// Draw ranges, one per material and LOD. Indices are absolute, so every
+	// submesh is drawn with DrawIndexed(indexCount, indexOffset, 0).
+	int GetSubmeshCount(int lod = 0) const { return IsValidLOD(lod) ? (int)m_lods[lod].submeshCount : (int)m_submeshes.size(); }
+	const Submesh& GetSubmesh(int index, int lod = 0) const { return m_submeshes[(IsValidLOD(lod) ? m_lods[lod].submeshOffset : 0) + index]; }
+
+	// Level of detail. All levels share the vertex and index buffer, LOD 0 is the full mesh.
+	int GetLODCount() const { return (int)m_lods.size(); }
+	const LodLevel& GetLOD(int lod) const { return m_lods[lod]; }
+	// Coarsest level whose geometric error, projected at distance, stays within
+	// maxScreenError pixels. projectionScale is the projection's y scale times
+	// half the screen height in pixels.
+	int SelectLOD(float distance, float worldScale, float projectionScale, float maxScreenError) const;
 	ID3D11Buffer* GetVertexBuffer() const 
 	{ 
 		return m_vertexBuffer; 
@@ -68,54 +102,151 @@ public:
 	}
 
 	// PBR texture getters
-	ID3D11ShaderResourceView* GetDiffuseTexture() const;
-	ID3D11ShaderResourceView* GetNormalTexture() const;
-	ID3D11ShaderResourceView* GetMetallicTexture() const;
-	ID3D11ShaderResourceView* GetRoughnessTexture() const;
-	ID3D11ShaderResourceView* GetEmissionTexture() const;
-	ID3D11ShaderResourceView* GetAOTexture() const;
+	ID3D11ShaderResourceView* GetDiffuseTexture(int materialIndex = 0) const;
+	ID3D11ShaderResourceView* GetNormalTexture(int materialIndex = 0) const;
+	ID3D11ShaderResourceView* GetMetallicTexture(int materialIndex = 0) const;
+	ID3D11ShaderResourceView* GetRoughnessTexture(int materialIndex = 0) const;
+	ID3D11ShaderResourceView* GetEmissionTexture(int materialIndex = 0) const;
+	ID3D11ShaderResourceView* GetAOTexture(int materialIndex = 0) const;
 	
 	// PBR material properties
-	XMFLOAT4 GetBaseColor() const { return m_materialInfo.diffuseColor; }
-	float GetMetallic() const { return m_materialInfo.metallic; }
-	float GetRoughness() const { return m_materialInfo.roughness; }
-	float GetAO() const { return m_materialInfo.ao; }
-	float GetEmissionStrength() const { return m_materialInfo.emissionStrength; }
+	XMFLOAT4 GetBaseColor(int materialIndex = 0) const { return GetMaterial(materialIndex).diffuseColor; }
+	float GetMetallic(int materialIndex = 0) const { return GetMaterial(materialIndex).metallic; }
+	float GetRoughness(int materialIndex = 0) const { return GetMaterial(materialIndex).roughness; }
+	float GetAO(int materialIndex = 0) const { return GetMaterial(materialIndex).ao; }
+	float GetEmissionStrength(int materialIndex = 0) const { return GetMaterial(materialIndex).emissionStrength; }
+
+	// Cooked mesh files ("<model>.mesh") are used and written by default
+	void SetUseCookedMeshes(bool useCookedMeshes) { m_useCookedMeshes = useCookedMeshes; }
+	// Material textures are block compressed per map ("<texture>.<role>.dds") by default
+	void SetUseCookedTextures(bool useCookedTextures) { m_useCookedTextures = useCookedTextures; }
+
+	// Vertex welding (FBX import)
+	void SetWeldSettings(const MeshWelder::Settings& settings) { m_weldSettings = settings; }
+	const MeshWelder::Stats& GetWeldStats() const { return m_weldStats; }
+
+	// Index/vertex order optimization (FBX import)
+	void SetOptimizerSettings(const MeshOptimizer::Settings& settings) { m_optimizerSettings = settings; }
+	const MeshOptimizer::Stats& GetOptimizerStats() const { return m_optimizerStats; }
+
+	// Tangent frame generation (all imports)
+	void SetTangentSettings(const TangentGenerator::Settings& settings) { m_tangentSettings = settings; }
+	const TangentGenerator::Stats& GetTangentStats() const { return m_tangentStats; }
+
+	// Bounding sphere and oriented box (all imports)
+	void SetBoundsSettings(const BoundsCalculator::Settings& settings) { m_boundsSettings = settings; }
+	const BoundsCalculator::Stats& GetBoundsStats() const { return m_boundsStats; }
+
+	// Meshlets of LOD 0 for cluster culling (FBX import), enable before initializing.
+	// The meshlets of a submesh are consecutive and cover its index range.
+	void SetBuildMeshlets(bool buildMeshlets) { m_buildMeshlets = buildMeshlets; }
+	void SetMeshletSettings(const MeshletBuilder::Settings& settings) { m_meshletSettings = settings; }
+	const MeshletBuilder::Stats& GetMeshletStats() const { return m_meshletStats; }
+	bool HasMeshlets() const { return !m_meshlets.empty(); }
+	const Meshlet* GetSubmeshMeshlets(int submeshIndex, int& meshletCount) const;
+
+	// LOD chain generation (FBX import)
+	void SetLODSettings(const MeshSimplifier::Settings& settings) { m_lodSettings = settings; }
+	const MeshSimplifier::Stats& GetLODStats() const { return m_lodStats; }
+
+	// Skeleton, skin weights and animation clips (FBX import). The bind pose
+	// streams feed a CharacterAnimator per character. Skinned models are
+	// imported every time, the cooked format does not store skins.
+	bool HasSkin() const { return !m_skinInfluences.empty(); }
+	const AnimationTypes::Skeleton& GetSkeleton() const { return m_skeleton; }
+	const std::vector<AnimationTypes::SkinInfluence>& GetSkinInfluences() const { return m_skinInfluences; }
+	const std::vector<AnimationTypes::AnimationClip>& GetAnimationClips() const { return m_animationClips; }
+	// Compressed copies of the clips, parallel to GetAnimationClips
+	void SetClipCompressionSettings(const ClipCompressor::Settings& settings) { m_clipCompressionSettings = settings; }
+	const std::vector<AnimationTypes::CompressedClip>& GetCompressedClips() const { return m_compressedClips; }
+	const Skinning::Streams& GetSkinStreams() const { return m_skinStreams; }
+	const SkinWeightBuilder::Stats& GetSkinStats() const { return m_skinStats; }
+
+	// GPU vertex format, set before initializing. Compact vertices are encoded
+	// when the vertex buffer is created and can only be drawn by the PBR shader.
+	void SetVertexFormat(MeshTypes::VertexFormat vertexFormat) { m_vertexFormat = vertexFormat; }
+	MeshTypes::VertexFormat GetVertexFormat() const { return m_vertexFormat; }
+	const MeshTypes::VertexQuantization* GetVertexQuantization() const
+	{
+		return m_vertexFormat == MeshTypes::VERTEX_FORMAT_COMPACT ? &m_vertexQuantization : nullptr;
+	}
+	const VertexCompressor::Stats& GetCompressionStats() const { return m_compressionStats; }
+
+	// Per-material PBR textures, parallel to m_materials
+	struct MaterialTextures
+	{
+		Texture* diffuse = nullptr;
+		Texture* normal = nullptr;
+		Texture* metallic = nullptr;
+		Texture* roughness = nullptr;
+		Texture* emission = nullptr;
+		Texture* ao = nullptr;
+	};
+
+	const MaterialTextures* GetMaterialTextures(int materialIndex) const
+	{
+		return materialIndex >= 0 && materialIndex < (int)m_materialTextures.size() ? &m_materialTextures[materialIndex] : nullptr;
+	}
 
 private:
+	const MaterialInfo& GetMaterial(int materialIndex) const
+	{
+		return materialIndex >= 0 && materialIndex < (int)m_materials.size() ? m_materials[materialIndex] : m_materialInfo;
+	}
+	bool IsValidLOD(int lod) const { return lod >= 0 && lod < (int)m_lods.size(); }
+
 	// Buffer management
 	bool InitializeBuffers(ID3D11Device* device);
+	bool InitializeBuffers(ID3D11Device* device, const void* vertexData, const IndexType* indexData);
 	void ShutdownBuffers();
 	void RenderBuffers(ID3D11DeviceContext* context);
 
-	// Texture loading
-	bool LoadTexture(ID3D11Device* device, ID3D11DeviceContext* context, char* filename);
-	bool LoadTextures(ID3D11Device* device, ID3D11DeviceContext* context, char* filename1, char* filename2);
-	bool LoadTextures(ID3D11Device* device, ID3D11DeviceContext* context, char* filename1, char* filename2, char* filename3);
-	bool LoadFBXTextures(ID3D11Device* device, ID3D11DeviceContext* context);
+	// Texture loading, the Load functions only decode into memory
+	bool LoadTextures(const std::vector<std::string>& filenames);
+	bool LoadFBXTextures();
+	int LoadMaterialTextures(const MaterialInfo& material, MaterialTextures& textures);
+	bool CreateTextures(ID3D11Device* device, ID3D11DeviceContext* context);
 	void ReleaseTextures();
 
 	// Model loading
 	bool LoadModel(char* filename);
+	bool ImportModel(char* filename);
+	bool LoadCookedModel(const std::string& cookedFilename, const CookedMesh::SourceInfo* source);
+	bool CookModel(const std::string& cookedFilename, const CookedMesh::SourceInfo& source);
 	bool LoadTextModel(char* filename);
 	bool LoadFBXModel(char* filename);
 	
 	// FBX processing
-	void ProcessNode(FbxNode* pNode);
-	void ProcessMesh(FbxNode* pNode);
+	int CountPolygonVertices(FbxNode* pNode);
+	void ProcessNode(FbxNode* pNode, MeshBuilder& builder);
+	void ProcessMesh(FbxNode* pNode, MeshBuilder& builder);
 	void ProcessMaterials(FbxNode* pNode);
+	int GetDefaultMaterialIndex(FbxScene* scene);
+	void ResetMaterialInfo();
 	void ExtractMaterialInfo(FbxSurfaceMaterial* material);
 	const FbxFileTexture* FindConnectedFileTexture(const FbxProperty& property);
 	void SearchSceneForTextures(FbxScene* scene);
 	void SearchDirectoryForTextures();
 	void ListAllMaterialProperties(FbxSurfaceMaterial* material);
 	std::string ConvertTexturePath(const std::string& originalPath);
+
+	// FBX skeleton and animation
+	void ImportSkeleton(FbxNode* rootNode);
+	void CollectSkinLinks(FbxNode* pNode, std::unordered_set<FbxNode*>& links);
+	void CollectJoints(FbxNode* pNode, FbxNode* parentJoint, const std::unordered_set<FbxNode*>& links);
+	void ProcessSkin(FbxNode* pNode, FbxMesh* mesh, std::vector<AnimationTypes::SkinInfluence>& pointInfluences);
+	void ImportAnimations(FbxScene* scene);
+	void RemapSkinInfluences(const std::vector<IndexType>& remap, size_t vertexCount);
 	
 	// Model processing
 	void ReleaseModel();
 	void CalculateBoundingBox();
-	void CalculateModelVectors();
-	void CalculateTangentBinormal(TempVertexType vertex1, TempVertexType vertex2, TempVertexType vertex3, VectorType& tangent, VectorType& binormal);
+	bool CalculateModelVectors();
+	bool WeldVertices();
+	bool OptimizeMesh();
+	bool GenerateLODs();
+	bool BuildMeshlets();
+	void IndexSubmeshMeshlets();
 
 private:
 	// DirectX resources
@@ -124,25 +255,73 @@ private:
 	int m_vertexCount;
 	int m_indexCount;
 
-	// Textures
+	// Textures, shared through the ResourceCache
 	Texture* m_Texture;
-	std::vector<Texture> m_Textures;
+	std::vector<Texture*> m_Textures;
 	
 	// PBR textures
-	Texture* m_diffuseTexture;
-	Texture* m_normalTexture;
-	Texture* m_metallicTexture;
-	Texture* m_roughnessTexture;
-	Texture* m_emissionTexture;
-	Texture* m_aoTexture;
+	std::vector<MaterialTextures> m_materialTextures;
 	
 	// Model data
 	ModelType* m_model;
-	unsigned long* m_indices; // Add index data storage
+	IndexType* m_indices; // Add index data storage
 	MaterialInfo m_materialInfo;
+	std::vector<MaterialInfo> m_materials;
+	std::vector<Submesh> m_submeshes;
+	std::vector<LodLevel> m_lods;
+	std::unordered_map<FbxSurfaceMaterial*, int> m_fbxMaterialIndices;
+	int m_defaultMaterialIndex;
 	bool m_hasFBXMaterial;
 	AABB m_boundingBox;
 	std::string m_currentFBXPath;
+
+	// Cooked mesh, mapped only until the buffers have been created
+	CookedMesh m_cookedMesh;
+	bool m_useCookedMeshes;
+	bool m_useCookedTextures;
+
+	// Vertex welding
+	MeshWelder::Settings m_weldSettings;
+	MeshWelder::Stats m_weldStats;
+
+	// Mesh optimization
+	MeshOptimizer::Settings m_optimizerSettings;
+	MeshOptimizer::Stats m_optimizerStats;
+
+	// Tangent generation
+	TangentGenerator::Settings m_tangentSettings;
+	TangentGenerator::Stats m_tangentStats;
+
+	// Bounding volumes, in model space
+	MeshBounds m_bounds;
+	BoundsCalculator::Settings m_boundsSettings;
+	BoundsCalculator::Stats m_boundsStats;
+
+	// Meshlets, with the first meshlet of every LOD 0 submesh (plus an end entry)
+	bool m_buildMeshlets;
+	std::vector<Meshlet> m_meshlets;
+	std::vector<uint32_t> m_submeshMeshletOffsets;
+	MeshletBuilder::Settings m_meshletSettings;
+	MeshletBuilder::Stats m_meshletStats;
+
+	// LOD generation
+	MeshSimplifier::Settings m_lodSettings;
+	MeshSimplifier::Stats m_lodStats;
+
+	// Skeleton and skin, the influences are parallel to m_model
+	AnimationTypes::Skeleton m_skeleton;
+	std::vector<AnimationTypes::SkinInfluence> m_skinInfluences;
+	std::vector<AnimationTypes::AnimationClip> m_animationClips;
+	std::vector<AnimationTypes::CompressedClip> m_compressedClips;
+	ClipCompressor::Settings m_clipCompressionSettings;
+	std::unordered_map<FbxNode*, int> m_fbxJointIndices;
+	Skinning::Streams m_skinStreams;
+	SkinWeightBuilder::Stats m_skinStats;
+
+	// Vertex compression
+	MeshTypes::VertexFormat m_vertexFormat;
+	MeshTypes::VertexQuantization m_vertexQuantization;
+	VertexCompressor::Stats m_compressionStats;
 };
 
 #endif // MODEL_H
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "ModelLoader.h"
+#include <chrono>
+#include <exception>
+#include "Model.h"
+#include "../../Core/System/JobSystem.h"
+#include "../../Core/System/Logger.h"
+
+ModelLoader::ModelLoader()
+{
+}
+
+ModelLoader::~ModelLoader()
+{
+	Shutdown();
+}
+
+ModelLoader::Handle ModelLoader::Load(Model* model, const std::string& modelFilename, const std::vector<std::string>& textureFilenames)
+{
+	return Start(model, modelFilename, [textureFilenames](Model* target, char* filename)
+	{
+		return target->LoadData(filename, textureFilenames);
+	});
+}
+
+ModelLoader::Handle ModelLoader::LoadFBX(Model* model, const std::string& modelFilename)
+{
+	return Start(model, modelFilename, [](Model* target, char* filename)
+	{
+		return target->LoadFBXData(filename);
+	});
+}
+
+ModelLoader::Handle ModelLoader::Start(Model* model, const std::string& modelFilename, std::function<bool(Model*, char*)> loadData)
+{
+	std::unique_ptr<PendingLoad> load(new PendingLoad);
+	load->model = model;
+	load->filename = modelFilename;
+	Handle handle = load->finished.get_future().share();
+
+	LOG("ModelLoader - Loading " + modelFilename);
+
+	// The pending load outlives the job, Shutdown waits for it before releasing anything.
+	PendingLoad* pending = load.get();
+	pending->loaded = JobSystem::GetInstance().Submit([pending, loadData]()
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		bool result = loadData(pending->model, &pending->filename[0]);
+		pending->cpuTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		return result;
+	});
+
+	m_pendingLoads.push_back(std::move(load));
+	m_stats.loadsStarted++;
+
+	return handle;
+}
+
+int ModelLoader::Update(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+	int finishedCount = 0;
+
+	for (size_t i = 0; i < m_pendingLoads.size();)
+	{
+		PendingLoad& load = *m_pendingLoads[i];
+		if (load.loaded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			i++;
+			continue;
+		}
+
+		bool result;
+		try
+		{
+			result = load.loaded.get();
+		}
+		catch (const std::exception& e)
+		{
+			LOG_ERROR("ModelLoader - Exception while loading " + load.filename + ": " + std::string(e.what()));
+			result = false;
+		}
+
+		// Second stage, the device work.
+		double gpuTimeMs = 0.0;
+		if (result)
+		{
+			auto startTime = std::chrono::high_resolution_clock::now();
+			result = load.model->CreateResources(device, deviceContext);
+			gpuTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		}
+
+		if (result)
+		{
+			LOG("ModelLoader - Loaded " + load.filename + " (" + std::to_string(load.cpuTimeMs) + " ms on a worker, " +
+				std::to_string(gpuTimeMs) + " ms creating resources)");
+			m_stats.loadsFinished++;
+		}
+		else
+		{
+			LOG_ERROR("ModelLoader - Failed to load " + load.filename);
+			m_stats.loadsFailed++;
+		}
+		m_stats.cpuTimeMs += load.cpuTimeMs;
+		m_stats.gpuTimeMs += gpuTimeMs;
+
+		load.finished.set_value(result);
+		m_pendingLoads.erase(m_pendingLoads.begin() + i);
+		finishedCount++;
+	}
+
+	return finishedCount;
+}
+
+void ModelLoader::Shutdown()
+{
+	for (std::unique_ptr<PendingLoad>& load : m_pendingLoads)
+	{
+		// A worker may still be writing to the model.
+		if (load->loaded.valid())
+		{
+			load->loaded.wait();
+		}
+		load->finished.set_value(false);
+	}
+	m_pendingLoads.clear();
+}
+
+bool ModelLoader::IsReady(const Handle& handle)
+{
+	return handle.valid() && handle.wait_for(std::chrono::seconds(0)) == std::future_status::ready && handle.get();
+}
@@ -0,0 +1,74 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <d3d11.h>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Model;
+
+// Loads models without blocking the thread that renders.
+// - The first stage (reading the file, import processing, texture decoding)
+//   runs on the JobSystem workers, so several models load at the same time.
+// - Update finishes the loads whose first stage is done by creating their
+//   buffers and textures on the thread that owns the device context.
+class ModelLoader
+{
+public:
+	// Ready once the load has finished, holding true if the model can be rendered.
+	using Handle = std::shared_future<bool>;
+
+	struct Stats
+	{
+		size_t loadsStarted = 0;
+		size_t loadsFinished = 0;
+		size_t loadsFailed = 0;
+		double cpuTimeMs = 0.0;   // Summed over the workers
+		double gpuTimeMs = 0.0;   // Spent in Update, the part that holds up a frame
+	};
+
+public:
+	ModelLoader();
+	~ModelLoader();
+
+	// Starts loading into the model. Its settings must be set before, and it
+	// must not be used or released until the handle is ready.
+	Handle Load(Model* model, const std::string& modelFilename, const std::vector<std::string>& textureFilenames = {});
+	Handle LoadFBX(Model* model, const std::string& modelFilename);
+
+	// Finishes the loads whose first stage is done. Call once per frame on the
+	// thread that owns the device context. Returns how many finished.
+	int Update(ID3D11Device* device, ID3D11DeviceContext* context);
+
+	// Waits until no worker uses a model anymore and fails the loads that have
+	// not finished. Call before releasing the models.
+	void Shutdown();
+
+	bool HasPendingLoads() const { return !m_pendingLoads.empty(); }
+	const Stats& GetStats() const { return m_stats; }
+
+	// True if the load has finished successfully, without blocking.
+	static bool IsReady(const Handle& handle);
+
+private:
+	struct PendingLoad
+	{
+		Model* model = nullptr;
+		std::string filename;
+		std::future<bool> loaded;       // First stage, on a worker
+		std::promise<bool> finished;
+		double cpuTimeMs = 0.0;         // Written by the worker before loaded is ready
+	};
+
+	Handle Start(Model* model, const std::string& modelFilename, std::function<bool(Model*, char*)> loadData);
+
+private:
+	std::vector<std::unique_ptr<PendingLoad>> m_pendingLoads;
+	Stats m_stats;
+};
+
+#endif // MODEL_LOADER_H
@@ -0,0 +1,439 @@
+#include "ResourceCache.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include "Image/ImageDecoder.h"
+#include "Image/TextureCooker.h"
+#include "../../Core/System/Hash.h"
+#include "../../Core/System/JobSystem.h"
+#include "../../Core/System/Logger.h"
+
+namespace
+{
+	// RGBA8 with the full mip chain, as Texture creates it.
+	size_t GetTextureByteSize(int width, int height)
+	{
+		size_t byteSize = 0;
+		for (;;)
+		{
+			byteSize += (size_t)width * (size_t)height * 4;
+			if (width == 1 && height == 1)
+			{
+				return byteSize;
+			}
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+	}
+}
+
+ResourceCache& ResourceCache::GetInstance()
+{
+	static ResourceCache instance;
+	return instance;
+}
+
+ResourceCache::ResourceCache()
+{
+	m_textureStreamingTail = 0;
+}
+
+ResourceCache::~ResourceCache()
+{
+	for (auto& texture : m_textures)
+	{
+		texture.second->texture->Shutdown();
+	}
+}
+
+Texture* ResourceCache::AcquireTexture(const std::string& filename, ImageTypes::TextureRole role)
+{
+	std::string path = GetPathKey(filename, role);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.requests++;
+
+		auto found = m_paths.find(path);
+		if (found != m_paths.end())
+		{
+			return AddReference(found->second, path, false)->texture.get();
+		}
+	}
+
+	// Decode without holding the lock, other threads may be loading too.
+	std::unique_ptr<Texture> texture(new Texture);
+	if (!texture->Decode((char*)filename.c_str(), role))
+	{
+		texture->Shutdown();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.failures++;
+		return nullptr;
+	}
+
+	return AddTexture(std::move(texture), filename, path, role);
+}
+
+void ResourceCache::AcquireTextures(const std::vector<std::string>& filenames, const std::vector<ImageTypes::TextureRole>& roles, std::vector<Texture*>& textures)
+{
+	textures.assign(filenames.size(), nullptr);
+	auto getRole = [&](size_t i) { return roles.empty() ? ImageTypes::ROLE_NONE : roles[i]; };
+
+	// Files already loaded only take a reference. A file named twice in the
+	// batch is loaded once, the repeats are acquired after it.
+	std::vector<std::string> paths(filenames.size());
+	std::vector<size_t> misses;
+	std::vector<size_t> repeats;
+	{
+		std::unordered_map<std::string, size_t> batchPaths;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < filenames.size(); i++)
+		{
+			if (filenames[i].empty())
+			{
+				continue;
+			}
+
+			paths[i] = GetPathKey(filenames[i], getRole(i));
+			auto found = m_paths.find(paths[i]);
+			if (found != m_paths.end())
+			{
+				m_stats.requests++;
+				textures[i] = AddReference(found->second, paths[i], false)->texture.get();
+			}
+			else if (batchPaths.emplace(paths[i], i).second)
+			{
+				m_stats.requests++;
+				misses.push_back(i);
+			}
+			else
+			{
+				repeats.push_back(i);
+			}
+		}
+	}
+
+	// Containers and up to date cooked files are only mapped, a file per job.
+	JobSystem& jobSystem = JobSystem::GetInstance();
+	std::vector<std::unique_ptr<Texture>> loaded(misses.size());
+	std::vector<uint8_t> mapped(misses.size(), 0);
+	jobSystem.ParallelFor(misses.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+		{
+			size_t i = misses[k];
+			loaded[k].reset(new Texture);
+			mapped[k] = loaded[k]->OpenCooked((char*)filenames[i].c_str(), getRole(i)) ? 1 : 0;
+		}
+	});
+
+	// The rest are decoded as one batch, then cooked for their roles a texture per job.
+	std::vector<size_t> decodes;
+	std::vector<std::string> decodeFilenames;
+	for (size_t k = 0; k < misses.size(); k++)
+	{
+		if (!mapped[k])
+		{
+			decodes.push_back(k);
+			decodeFilenames.push_back(filenames[misses[k]]);
+		}
+	}
+
+	std::vector<ImageDecoder::Image> images;
+	ImageDecoder::DecodeBatch(decodeFilenames, images, ImageDecoder::Settings());
+
+	jobSystem.ParallelFor(decodes.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t d = begin; d < end; d++)
+		{
+			size_t k = decodes[d];
+			size_t i = misses[k];
+			if (!loaded[k]->SetImage((char*)filenames[i].c_str(), getRole(i), images[d]))
+			{
+				LOG_ERROR("ResourceCache - Unsupported or damaged image " + filenames[i]);
+				loaded[k]->Shutdown();
+				loaded[k].reset();
+			}
+		}
+	});
+
+	for (size_t k = 0; k < misses.size(); k++)
+	{
+		size_t i = misses[k];
+		if (loaded[k])
+		{
+			textures[i] = AddTexture(std::move(loaded[k]), filenames[i], paths[i], getRole(i));
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stats.failures++;
+		}
+	}
+
+	for (size_t i : repeats)
+	{
+		textures[i] = AcquireTexture(filenames[i], getRole(i));
+	}
+}
+
+Texture* ResourceCache::AcquireTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::string& filename)
+{
+	Texture* texture = AcquireTexture(filename);
+	if (texture && !CreateTexture(texture, device, deviceContext))
+	{
+		ReleaseTexture(texture);
+		return nullptr;
+	}
+
+	return texture;
+}
+
+bool ResourceCache::CreateTexture(Texture* texture, ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+	// Only the device thread creates textures, so the first user does it and the rest find it done.
+	if (texture->GetTexture())
+	{
+		return true;
+	}
+
+	return texture->CreateResources(device, deviceContext);
+}
+
+void ResourceCache::ReleaseTexture(Texture* texture)
+{
+	if (!texture)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = m_textures.find(texture);
+	if (found == m_textures.end())
+	{
+		LOG_WARNING("ResourceCache - Released a texture that is not in the cache");
+		return;
+	}
+
+	TextureEntry* entry = found->second.get();
+	if (--entry->refCount > 0)
+	{
+		return;
+	}
+
+	// Last user, forget every path that led here.
+	for (auto path = m_paths.begin(); path != m_paths.end();)
+	{
+		path = path->second == entry ? m_paths.erase(path) : std::next(path);
+	}
+	m_contents.erase(entry->contentHash);
+
+	m_stats.liveTextures--;
+	m_stats.bytesLoaded -= entry->byteSize;
+
+	entry->texture->Shutdown();
+	m_textures.erase(found);
+}
+
+TextureAtlas* ResourceCache::AcquireAtlas(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::string& listFilename, const std::vector<std::string>& filenames)
+{
+	// Keyed on the images rather than the list file, so lists naming the same frames share.
+	std::string key;
+	for (const std::string& filename : filenames)
+	{
+		key += NormalizePath(filename) + "\n";
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.atlasRequests++;
+
+		auto found = m_atlasKeys.find(key);
+		if (found != m_atlasKeys.end())
+		{
+			AtlasEntry* entry = found->second;
+			entry->refCount++;
+			m_stats.atlasHits++;
+
+			auto texture = m_textures.find(entry->atlas->GetAtlasTexture());
+			if (texture != m_textures.end())
+			{
+				m_stats.bytesSaved += texture->second->byteSize;
+			}
+			return entry->atlas.get();
+		}
+	}
+
+	// Without the lock, the atlas acquires its texture from the cache.
+	std::unique_ptr<TextureAtlas> atlas(new TextureAtlas);
+	AtlasPacker::Settings settings;
+	if (!atlas->Initialize(device, deviceContext, listFilename, filenames, settings))
+	{
+		atlas->Shutdown();
+		return nullptr;
+	}
+
+	std::unique_ptr<AtlasEntry> entry(new AtlasEntry);
+	entry->atlas = std::move(atlas);
+	entry->key = key;
+	entry->refCount = 1;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	TextureAtlas* result = entry->atlas.get();
+	m_atlasKeys[key] = entry.get();
+	m_atlases[result] = std::move(entry);
+	m_stats.liveAtlases++;
+
+	return result;
+}
+
+void ResourceCache::ReleaseAtlas(TextureAtlas* atlas)
+{
+	if (!atlas)
+	{
+		return;
+	}
+
+	std::unique_ptr<AtlasEntry> released;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto found = m_atlases.find(atlas);
+		if (found == m_atlases.end())
+		{
+			LOG_WARNING("ResourceCache - Released an atlas that is not in the cache");
+			return;
+		}
+
+		if (--found->second->refCount > 0)
+		{
+			return;
+		}
+
+		m_atlasKeys.erase(found->second->key);
+		released = std::move(found->second);
+		m_atlases.erase(found);
+		m_stats.liveAtlases--;
+	}
+
+	// Releases the atlas texture, which takes the lock again.
+	released->atlas->Shutdown();
+}
+
+Texture* ResourceCache::AddTexture(std::unique_ptr<Texture> texture, const std::string& filename, const std::string& path, ImageTypes::TextureRole role)
+{
+	// Cooked and container textures hash their stored levels, which hold the mips already.
+	int dimensions[3] = { texture->GetWidth(), texture->GetHeight(), (int)role };
+	size_t byteSize = texture->IsMapped() ? texture->GetImageDataSize() : GetTextureByteSize(dimensions[0], dimensions[1]);
+	uint64_t contentHash = Hash::Fnv1a64(dimensions, sizeof(dimensions));
+	contentHash = Hash::Fnv1a64(texture->GetImageData(), texture->GetImageDataSize(), contentHash);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Another thread may have loaded the same path or pixels in the meantime.
+	auto foundPath = m_paths.find(path);
+	auto foundContent = m_contents.find(contentHash);
+	if (foundPath != m_paths.end() || foundContent != m_contents.end())
+	{
+		texture->Shutdown();
+		if (foundPath != m_paths.end())
+		{
+			return AddReference(foundPath->second, path, false)->texture.get();
+		}
+		LOG("ResourceCache - " + filename + " has the same pixels as a loaded texture, sharing it");
+		return AddReference(foundContent->second, path, true)->texture.get();
+	}
+
+	// Decided once, before anyone else can see the texture or create it.
+	if (m_textureStreamingTail > 0 && role != ImageTypes::ROLE_NONE)
+	{
+		texture->EnableStreaming(m_textureStreamingTail);
+	}
+
+	std::unique_ptr<TextureEntry> entry(new TextureEntry);
+	entry->texture = std::move(texture);
+	entry->contentHash = contentHash;
+	entry->byteSize = byteSize;
+
+	Texture* result = entry->texture.get();
+	m_paths[path] = entry.get();
+	m_contents[contentHash] = entry.get();
+	entry->refCount = 1;
+	m_textures[result] = std::move(entry);
+
+	m_stats.misses++;
+	m_stats.liveTextures++;
+	m_stats.bytesLoaded += byteSize;
+
+	return result;
+}
+
+ResourceCache::TextureEntry* ResourceCache::AddReference(TextureEntry* entry, const std::string& path, bool contentHit)
+{
+	entry->refCount++;
+	m_paths[path] = entry;
+
+	if (contentHit)
+	{
+		m_stats.contentHits++;
+	}
+	else
+	{
+		m_stats.pathHits++;
+	}
+	m_stats.bytesSaved += entry->byteSize;
+
+	return entry;
+}
+
+void ResourceCache::SetTextureStreaming(uint32_t residentTailSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_textureStreamingTail = residentTailSize;
+}
+
+ResourceCache::Stats ResourceCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+std::string ResourceCache::FormatStats(const Stats& stats)
+{
+	size_t hits = stats.pathHits + stats.contentHits;
+	float hitRate = stats.requests > 0 ? 100.0f * (float)hits / (float)stats.requests : 0.0f;
+
+	return "Resource cache: " + std::to_string(stats.requests) + " texture requests, " +
+		std::to_string(hitRate) + "% hits (" + std::to_string(stats.pathHits) + " by path, " +
+		std::to_string(stats.contentHits) + " by content), " +
+		std::to_string(stats.failures) + " failed, " +
+		std::to_string(stats.liveTextures) + " textures using " + std::to_string(stats.bytesLoaded / 1024) + " KB, " +
+		std::to_string(stats.bytesSaved / 1024) + " KB saved; " +
+		std::to_string(stats.atlasRequests) + " atlas requests, " + std::to_string(stats.atlasHits) + " shared, " +
+		std::to_string(stats.liveAtlases) + " atlases";
+}
+
+std::string ResourceCache::GetPathKey(const std::string& filename, ImageTypes::TextureRole role)
+{
+	std::string path = NormalizePath(filename);
+	if (role != ImageTypes::ROLE_NONE)
+	{
+		path += std::string("#") + TextureCooker::GetRoleName(role);
+	}
+	return path;
+}
+
+std::string ResourceCache::NormalizePath(const std::string& path)
+{
+	std::string normalized = path;
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+	normalized = std::filesystem::path(normalized).lexically_normal().generic_string();
+
+	// Windows paths do not care about case.
+	std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+	return normalized;
+}
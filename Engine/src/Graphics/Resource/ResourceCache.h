@@ -0,0 +1,120 @@
+#ifndef RESOURCE_CACHE_H
+#define RESOURCE_CACHE_H
+
+#include <d3d11.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Image/ImageTypes.h"
+
+class Texture;
+class TextureAtlas;
+
+// Reference counted textures shared by everything that loads image files.
+// - A texture is looked up by its normalized path first. On a miss the file
+//   is decoded and its pixels hashed (FNV-1a), so the same image under a
+//   second path or name resolves to the texture that is already there.
+// - Acquire may run on any thread, it only decodes. CreateTexture uploads a
+//   texture once, no matter how many users share it, on the device thread.
+// - Every Acquire needs one Release, the last one frees the texture.
+// - Atlases are shared by their list of images, two sprites with the same
+//   frames use one atlas. The atlas texture is a cached texture like any other.
+class ResourceCache
+{
+public:
+	struct Stats
+	{
+		size_t requests = 0;
+		size_t pathHits = 0;        // Path already loaded
+		size_t contentHits = 0;     // New path, identical pixels
+		size_t misses = 0;
+		size_t failures = 0;
+		size_t liveTextures = 0;
+		size_t bytesLoaded = 0;     // Texture memory of the distinct textures, mips included
+		size_t bytesSaved = 0;      // What the hits would have cost as separate textures
+		size_t atlasRequests = 0;
+		size_t atlasHits = 0;       // Image list already loaded
+		size_t liveAtlases = 0;
+	};
+
+public:
+	static ResourceCache& GetInstance();
+
+	// Returns the shared texture of the file, or nullptr if it cannot be decoded.
+	// With a role the texture is cooked for it, see Texture::Decode. The same
+	// file under two roles gives two textures.
+	Texture* AcquireTexture(const std::string& filename, ImageTypes::TextureRole role = ImageTypes::ROLE_NONE);
+	// Acquires a set of textures at once. Cached and cooked files are mapped a
+	// file per job, the rest decode as one ImageDecoder::DecodeBatch and are
+	// cooked a texture per job. textures receives one entry per file, nullptr
+	// for empty names and files that cannot be decoded. roles is empty or has
+	// one role per file.
+	void AcquireTextures(const std::vector<std::string>& filenames, const std::vector<ImageTypes::TextureRole>& roles, std::vector<Texture*>& textures);
+	// The same, with the device texture created. Device thread only.
+	Texture* AcquireTexture(ID3D11Device* device, ID3D11DeviceContext* context, const std::string& filename);
+	// Creates the device texture of an acquired texture unless that happened already.
+	bool CreateTexture(Texture* texture, ID3D11Device* device, ID3D11DeviceContext* context);
+	void ReleaseTexture(Texture* texture);
+
+	// Returns the shared atlas of the images, cooked for listFilename (see
+	// TextureAtlas), or nullptr if it cannot be loaded. Device thread only.
+	TextureAtlas* AcquireAtlas(ID3D11Device* device, ID3D11DeviceContext* context, const std::string& listFilename, const std::vector<std::string>& filenames);
+	void ReleaseAtlas(TextureAtlas* atlas);
+
+	// Textures cooked for a role start with the levels up to this size resident
+	// and stream the rest, see TextureStreamer. 0 (the default) keeps every level.
+	// Applies to textures loaded from then on, whoever loads them first.
+	void SetTextureStreaming(uint32_t residentTailSize);
+
+	Stats GetStats() const;
+	static std::string FormatStats(const Stats& stats);
+
+	// Lower case, forward slashes, "." and ".." resolved.
+	static std::string NormalizePath(const std::string& path);
+
+private:
+	struct TextureEntry
+	{
+		std::unique_ptr<Texture> texture;
+		uint64_t contentHash = 0;
+		size_t byteSize = 0;
+		int refCount = 0;
+	};
+
+	struct AtlasEntry
+	{
+		std::unique_ptr<TextureAtlas> atlas;
+		std::string key;
+		int refCount = 0;
+	};
+
+	ResourceCache();
+	~ResourceCache();
+
+	// Prevent copying
+	ResourceCache(const ResourceCache&) = delete;
+	ResourceCache& operator=(const ResourceCache&) = delete;
+
+	// Adds a decoded texture, or shares the entry with the same path or pixels.
+	Texture* AddTexture(std::unique_ptr<Texture> texture, const std::string& filename, const std::string& path, ImageTypes::TextureRole role);
+	TextureEntry* AddReference(TextureEntry* entry, const std::string& path, bool contentHit);
+	// The normalized path, plus the role the texture is cooked for.
+	static std::string GetPathKey(const std::string& filename, ImageTypes::TextureRole role);
+
+private:
+	mutable std::mutex m_mutex;
+	std::unordered_map<Texture*, std::unique_ptr<TextureEntry>> m_textures;
+	std::unordered_map<std::string, TextureEntry*> m_paths;
+	std::unordered_map<uint64_t, TextureEntry*> m_contents;
+	std::unordered_map<TextureAtlas*, std::unique_ptr<AtlasEntry>> m_atlases;
+	std::unordered_map<std::string, AtlasEntry*> m_atlasKeys;
+	Stats m_stats;
+	uint32_t m_textureStreamingTail;
+};
+
+#endif // RESOURCE_CACHE_H
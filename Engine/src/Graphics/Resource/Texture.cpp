@@ -1,14 +1,18 @@
 #include "texture.h"
-#include <wincodec.h>
-#include <wrl/client.h>
-
-using Microsoft::WRL::ComPtr;
+#include "Image/ImageDecoder.h"
+#include "Image/TextureCooker.h"
+#include "Mesh/CookedMesh.h"
+#include "../../Core/System/Logger.h"
+#include "../../Core/System/MappedFile.h"
+#include <vector>
 
 Texture::Texture()
 {
 	m_targaData = 0;
 	m_texture = 0;
 	m_textureView = 0;
+	m_streamed = false;
+	m_residentLevel = 0;
 }
 
 
@@ -24,25 +28,186 @@ Texture::~Texture()
 bool Texture::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename)
 {
 	bool result;
-	int height, width;
+
+	// Load the image data into memory.
+	result = Decode(filename);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create the texture from it.
+	return CreateResources(device, deviceContext);
+}
+
+bool Texture::Decode(char* filename)
+{
+	// DDS and KTX2 files are mapped, not decoded.
+	if (TextureFile::IsContainer(filename))
+	{
+		return LoadContainer(filename);
+	}
+
+	// TGA, PNG and JPEG files, told apart by their contents.
+	return LoadImageFile(filename);
+}
+
+bool Texture::Decode(char* filename, ImageTypes::TextureRole role)
+{
+	if (role == ImageTypes::ROLE_NONE || TextureFile::IsContainer(filename))
+	{
+		return Decode(filename);
+	}
+
+	if (OpenCooked(filename, role))
+	{
+		return true;
+	}
+
+	if (!Decode(filename))
+	{
+		return false;
+	}
+
+	Cook(filename, role);
+	return true;
+}
+
+bool Texture::OpenCooked(char* filename, ImageTypes::TextureRole role)
+{
+	if (TextureFile::IsContainer(filename))
+	{
+		return LoadContainer(filename);
+	}
+	if (role == ImageTypes::ROLE_NONE)
+	{
+		return false;
+	}
+
+	bool hasSource = false;
+	DdsFile::SourceTag tag = GetSourceTag(filename, role, hasSource);
+
+	// Use the cooked texture if it is up to date. Without a source file any cooked texture is used.
+	std::unique_ptr<DdsFile> cookedFile(new DdsFile());
+	if (cookedFile->Open(TextureCooker::GetCookedFilename(filename, role)) && (!hasSource || cookedFile->IsUpToDate(tag)))
+	{
+		m_width = (int)cookedFile->GetWidth();
+		m_height = (int)cookedFile->GetHeight();
+		m_mappedFile = std::move(cookedFile);
+		return true;
+	}
+
+	return false;
+}
+
+bool Texture::SetImage(char* filename, ImageTypes::TextureRole role, ImageDecoder::Image& image)
+{
+	if (!image.pixels)
+	{
+		return false;
+	}
+
+	// The decoder allocated the pixels with new[], the texture frees them the same way.
+	m_targaData = image.pixels.release();
+	m_width = image.info.width;
+	m_height = image.info.height;
+
+	if (role != ImageTypes::ROLE_NONE)
+	{
+		Cook(filename, role);
+	}
+
+	return true;
+}
+
+void Texture::Cook(char* filename, ImageTypes::TextureRole role)
+{
+	bool hasSource = false;
+	DdsFile::SourceTag tag = GetSourceTag(filename, role, hasSource);
+	std::string cookedFilename = TextureCooker::GetCookedFilename(filename, role);
+
+	// A texture that cannot be cooked is still usable uncompressed.
+	if (!CookTexture(filename, cookedFilename, tag))
+	{
+		LOG_WARNING("Texture - Failed to cook " + cookedFilename + ", uploading uncompressed");
+	}
+}
+
+DdsFile::SourceTag Texture::GetSourceTag(const char* filename, ImageTypes::TextureRole role, bool& hasSource)
+{
+	CookedMesh::SourceInfo source;
+	hasSource = CookedMesh::GetSourceInfo(filename, source);
+
+	DdsFile::SourceTag tag;
+	tag.size = source.size;
+	tag.timestamp = source.timestamp;
+	tag.role = role;
+	return tag;
+}
+
+bool Texture::CookTexture(const std::string& filename, const std::string& cookedFilename, const DdsFile::SourceTag& tag)
+{
+	ImageTypes::Image image;
+	TextureCooker::Settings settings;
+	TextureCooker::Stats stats;
+
+	if (!TextureCooker::Cook(m_targaData, (uint32_t)m_width, (uint32_t)m_height, tag.role, settings, image, &stats))
+	{
+		return false;
+	}
+	LOG("Texture - " + filename + ": " + TextureCooker::FormatStats(stats));
+
+	std::unique_ptr<DdsFile> cookedFile(new DdsFile());
+	if (!DdsFile::Write(cookedFilename, image, tag) || !cookedFile->Open(cookedFilename))
+	{
+		return false;
+	}
+	m_mappedFile = std::move(cookedFile);
+
+	// The cooked file replaces the decoded pixels.
+	delete[] m_targaData;
+	m_targaData = 0;
+
+	return true;
+}
+
+bool Texture::LoadContainer(char* filename)
+{
+	m_mappedFile = TextureFile::OpenContainer(filename);
+	if (!m_mappedFile)
+	{
+		return false;
+	}
+
+	m_width = (int)m_mappedFile->GetWidth();
+	m_height = (int)m_mappedFile->GetHeight();
+
+	return true;
+}
+
+size_t Texture::GetImageDataSize() const
+{
+	if (m_targaData)
+	{
+		return (size_t)m_width * (size_t)m_height * 4;
+	}
+
+	return m_mappedFile ? m_mappedFile->GetLevelDataSize() : 0;
+}
+
+bool Texture::CreateResources(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
 	D3D11_TEXTURE2D_DESC textureDesc;
 	HRESULT hResult;
 	unsigned int rowPitch;
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
 
-	// Check if the file is a PNG
-	std::string fileStr(filename);
-	if (fileStr.substr(fileStr.find_last_of(".") + 1) == "png")
-	{
-		result = LoadPNG(device, deviceContext, filename);
-	}
-	else
+	if (m_mappedFile)
 	{
-		// Load the targa image data into memory.
-		result = LoadTarga32Bit(filename);
+		return CreateMappedResources(device);
 	}
 
-	if (!result)
+	if (!m_targaData)
 	{
 		return false;
 	}
@@ -96,72 +261,146 @@ bool Texture::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContex
 	return true;
 }
 
-bool Texture::LoadPNG(ID3D11Device* device, ID3D11DeviceContext* deviceContext, char* filename)
+bool Texture::CreateMappedResources(ID3D11Device* device)
 {
-	// Convert filename to wide string
-	std::wstring wFilename(filename, filename + strlen(filename));
-
-	// Create WIC factory
-	ComPtr<IWICImagingFactory> wicFactory;
-	HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&wicFactory));
-	if (FAILED(hr))
+	if (!CreateMappedTexture(device, m_residentLevel, &m_texture, &m_textureView))
 	{
 		return false;
 	}
 
-	// Create decoder
-	ComPtr<IWICBitmapDecoder> decoder;
-	hr = wicFactory->CreateDecoderFromFilename(wFilename.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnLoad, &decoder);
-	if (FAILED(hr))
+	// The device has its own copy now, unmap the file. Streamed textures keep it for their finer levels.
+	if (!m_streamed)
 	{
-		return false;
+		m_mappedFile.reset();
 	}
 
-	// Get the first frame
-	ComPtr<IWICBitmapFrameDecode> frame;
-	hr = decoder->GetFrame(0, &frame);
-	if (FAILED(hr))
+	return true;
+}
+
+bool Texture::CreateMappedTexture(ID3D11Device* device, uint32_t topLevel, ID3D11Texture2D** texture, ID3D11ShaderResourceView** textureView)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+	HRESULT hResult;
+
+	// Every mip of every layer is in the file, point the subresources straight into the mapping.
+	uint32_t mipCount = m_mappedFile->GetMipCount();
+	uint32_t layerCount = m_mappedFile->GetLayerCount();
+	if (topLevel >= mipCount)
 	{
 		return false;
 	}
 
-	// Get image dimensions
-	UINT width, height;
-	hr = frame->GetSize(&width, &height);
-	if (FAILED(hr))
+	std::vector<D3D11_SUBRESOURCE_DATA> subresources;
+	subresources.reserve((size_t)(mipCount - topLevel) * layerCount);
+	for (uint32_t layer = 0; layer < layerCount; layer++)
 	{
-		return false;
+		for (uint32_t mip = topLevel; mip < mipCount; mip++)
+		{
+			const ImageTypes::ImageLevel& level = m_mappedFile->GetLevel(layer, mip);
+			D3D11_SUBRESOURCE_DATA subresource;
+			subresource.pSysMem = m_mappedFile->GetData() + level.offset;
+			subresource.SysMemPitch = level.rowPitch;
+			subresource.SysMemSlicePitch = (UINT)level.size;
+			subresources.push_back(subresource);
+		}
 	}
 
-	// Create format converter
-	ComPtr<IWICFormatConverter> converter;
-	hr = wicFactory->CreateFormatConverter(&converter);
-	if (FAILED(hr))
+	const ImageTypes::ImageLevel& top = m_mappedFile->GetLevel(0, topLevel);
+	bool cubemap = m_mappedFile->IsCubemap();
+	textureDesc.Height = top.height;
+	textureDesc.Width = top.width;
+	textureDesc.MipLevels = mipCount - topLevel;
+	textureDesc.ArraySize = layerCount;
+	textureDesc.Format = (DXGI_FORMAT)m_mappedFile->GetDxgiFormat();
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = cubemap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+	hResult = device->CreateTexture2D(&textureDesc, subresources.data(), texture);
+	if (FAILED(hResult))
 	{
 		return false;
 	}
 
-	// Convert to RGBA
-	hr = converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0f, WICBitmapPaletteTypeCustom);
-	if (FAILED(hr))
+	// The view covers every layer: a cube, a cube array, a 2D array or a plain 2D texture.
+	srvDesc.Format = textureDesc.Format;
+	if (cubemap && layerCount == 6)
+	{
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MostDetailedMip = 0;
+		srvDesc.TextureCube.MipLevels = -1;
+	}
+	else if (cubemap)
+	{
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+		srvDesc.TextureCubeArray.MostDetailedMip = 0;
+		srvDesc.TextureCubeArray.MipLevels = -1;
+		srvDesc.TextureCubeArray.First2DArrayFace = 0;
+		srvDesc.TextureCubeArray.NumCubes = layerCount / 6;
+	}
+	else if (layerCount > 1)
+	{
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MostDetailedMip = 0;
+		srvDesc.Texture2DArray.MipLevels = -1;
+		srvDesc.Texture2DArray.FirstArraySlice = 0;
+		srvDesc.Texture2DArray.ArraySize = layerCount;
+	}
+	else
+	{
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.Texture2D.MipLevels = -1;
+	}
+
+	hResult = device->CreateShaderResourceView(*texture, &srvDesc, textureView);
+	if (FAILED(hResult))
 	{
+		(*texture)->Release();
+		*texture = 0;
 		return false;
 	}
 
-	// Allocate memory for the image data
-	m_width = width;
-	m_height = height;
-	m_targaData = new unsigned char[width * height * 4];
+	return true;
+}
 
-	// Copy the image data
-	hr = converter->CopyPixels(nullptr, width * 4, width * height * 4, m_targaData);
-	if (FAILED(hr))
+void Texture::EnableStreaming(uint32_t tailSize)
+{
+	// Only mapped textures with one layer, before they are created.
+	if (m_streamed || m_texture || !m_mappedFile || m_mappedFile->GetLayerCount() != 1)
+	{
+		return;
+	}
+
+	m_streamed = true;
+	m_residentLevel = MipResidency::GetTailLevel(m_mappedFile->GetLevels(), tailSize);
+}
+
+bool Texture::SetResidentLevel(ID3D11Device* device, uint32_t level)
+{
+	if (!m_streamed || !m_texture || level == m_residentLevel)
+	{
+		return m_streamed;
+	}
+
+	// Build the new texture first, the old one stays in use if that fails.
+	ID3D11Texture2D* texture = 0;
+	ID3D11ShaderResourceView* textureView = 0;
+	if (!CreateMappedTexture(device, level, &texture, &textureView))
 	{
-		delete[] m_targaData;
-		m_targaData = nullptr;
 		return false;
 	}
 
+	m_textureView->Release();
+	m_texture->Release();
+	m_texture = texture;
+	m_textureView = textureView;
+	m_residentLevel = level;
+
 	return true;
 }
 
@@ -187,6 +426,9 @@ void Texture::Shutdown()
 		delete[] m_targaData;
 		m_targaData = 0;
 	}
+	m_mappedFile.reset();
+	m_streamed = false;
+	m_residentLevel = 0;
 
 	return;
 }
@@ -196,91 +438,36 @@ ID3D11ShaderResourceView* Texture::GetTexture() const
 	return m_textureView;
 }
 
-bool Texture::LoadTarga32Bit(char* filename)
+bool Texture::LoadImageFile(char* filename)
 {
-	int error, bpp, imageSize, index, i, j, k;
-	FILE* filePtr;
-	unsigned int count;
-	TargaHeader targaFileHeader;
-	unsigned char* targaImage;
-
+	ImageDecoder::Info info;
+	ImageDecoder::Settings settings;
+	MappedFile file;
 
-	// Open the targa file for reading in binary.
-	error = fopen_s(&filePtr, filename, "rb");
-	if (error != 0)
+	// Map the file, the decoders read the pixels from the view.
+	if (!file.Open(filename))
 	{
 		return false;
 	}
 
-	// Read in the file header.
-	count = (unsigned int)fread(&targaFileHeader, sizeof(TargaHeader), 1, filePtr);
-	if (count != 1)
+	if (!ImageDecoder::ReadInfo(file.GetData(), file.GetSize(), info))
 	{
+		LOG_ERROR(std::string("Texture - Unsupported or damaged image ") + filename);
 		return false;
 	}
 
-	// Get the important information from the header.
-	m_height = (int)targaFileHeader.height;
-	m_width = (int)targaFileHeader.width;
-	bpp = (int)targaFileHeader.bpp;
-
-	// Check that it is 32 bit and not 24 bit.
-	if (bpp != 32)
-	{
-		return false;
-	}
-
-	// Calculate the size of the 32 bit image data.
-	imageSize = m_width * m_height * 4;
-
-	// Allocate memory for the targa image data.
-	targaImage = new unsigned char[imageSize];
-
-	// Read in the targa image data.
-	count = (unsigned int)fread(targaImage, 1, imageSize, filePtr);
-	if (count != imageSize)
-	{
-		return false;
-	}
-
-	// Close the file.
-	error = fclose(filePtr);
-	if (error != 0)
+	// Decode straight into the data the texture uploads.
+	unsigned char* data = new unsigned char[(size_t)info.width * info.height * 4];
+	if (!ImageDecoder::Decode(file.GetData(), file.GetSize(), info, data, settings))
 	{
+		LOG_ERROR(std::string("Texture - Failed to decode ") + ImageDecoder::GetFormatName(info.format) + " image " + filename);
+		delete[] data;
 		return false;
 	}
 
-	// Allocate memory for the targa destination data.
-	m_targaData = new unsigned char[imageSize];
-
-	// Initialize the index into the targa destination data array.
-	index = 0;
-
-	// Initialize the index into the targa image data.
-	k = (m_width * m_height * 4) - (m_width * 4);
-
-	// Now copy the targa image data into the targa destination array in the correct order since the targa format is stored upside down and also is not in RGBA order.
-	for (j = 0; j < m_height; j++)
-	{
-		for (i = 0; i < m_width; i++)
-		{
-			m_targaData[index + 0] = targaImage[k + 2];  // Red.
-			m_targaData[index + 1] = targaImage[k + 1];  // Green.
-			m_targaData[index + 2] = targaImage[k + 0];  // Blue
-			m_targaData[index + 3] = targaImage[k + 3];  // Alpha
-
-			// Increment the indexes into the targa data.
-			k += 4;
-			index += 4;
-		}
-
-		// Set the targa image data index back to the preceding row at the beginning of the column since its reading it in upside down.
-		k -= (m_width * 8);
-	}
-
-	// Release the targa image data now that it was copied into the destination array.
-	delete[] targaImage;
-	targaImage = 0;
+	m_targaData = data;
+	m_width = info.width;
+	m_height = info.height;
 
 	return true;
 }
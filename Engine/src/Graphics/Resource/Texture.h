@@ -3,22 +3,19 @@
 
 #include <d3d11.h>
 #include <stdio.h>
+#include <memory>
 #include <string>
 
+#include "Image/DdsFile.h"
+#include "Image/ImageDecoder.h"
+#include "Image/ImageTypes.h"
+#include "Image/MipResidency.h"
+#include "Image/TextureFile.h"
+
 using namespace std;
 
 class Texture
 {
-private:
-    struct TargaHeader
-    {
-        unsigned char data1[12];
-        unsigned short width;
-        unsigned short height;
-        unsigned char bpp;
-        unsigned char data2;
-    };
-
 public:
     Texture();
     Texture(const Texture&);
@@ -27,20 +24,64 @@ public:
     bool Initialize(ID3D11Device*, ID3D11DeviceContext*, char*);
     void Shutdown();
 
+    // Initialize in two stages. Decode only reads the image into memory and
+    // may run on any thread, CreateResources uploads it and must run on the
+    // thread that owns the device context.
+    bool Decode(char*);
+    bool CreateResources(ID3D11Device*, ID3D11DeviceContext*);
+    bool IsDecoded() const { return m_targaData != 0 || m_mappedFile; }
+    const unsigned char* GetImageData() const { return m_targaData ? m_targaData : m_mappedFile ? m_mappedFile->GetLevelData() : 0; }
+    size_t GetImageDataSize() const;
+
+    // Decodes for a role other than ROLE_NONE load "<file>.<role>.dds"
+    // instead, cooking it first if it is missing or older than the file.
+    // Cooked textures are block compressed and carry their mips.
+    bool Decode(char*, ImageTypes::TextureRole);
+
+    // Decode for a role in two steps, for images decoded in batches (see
+    // ResourceCache::AcquireTextures). OpenCooked maps the container or the
+    // up to date cooked file and is false if the image has to be decoded;
+    // SetImage then takes the decoded pixels and cooks them for the role.
+    bool OpenCooked(char*, ImageTypes::TextureRole);
+    bool SetImage(char*, ImageTypes::TextureRole, ImageDecoder::Image&);
+
+    // ".dds" and ".ktx2" files are used as they are, whatever the role: the
+    // file is mapped and its levels, array layers and cube faces go to the
+    // device straight from the view. Cooked textures are mapped the same way.
+    bool IsMapped() const { return m_mappedFile != nullptr; }
+
+    // Streaming, for mapped textures with a single layer. A streamed texture keeps its file
+    // mapped and is created with the levels from the resident one down,
+    // starting at the finest level no larger than tailSize. TextureStreamer
+    // moves the resident level, the view changes when it does.
+    void EnableStreaming(uint32_t tailSize);
+    bool IsStreamed() const { return m_streamed; }
+    bool SetResidentLevel(ID3D11Device*, uint32_t);
+    uint32_t GetResidentLevel() const { return m_residentLevel; }
+    const std::vector<ImageTypes::ImageLevel>& GetLevels() const { return m_mappedFile->GetLevels(); }
+
     ID3D11ShaderResourceView* GetTexture() const;
 
     int GetWidth();
     int GetHeight();
 
 private:
-    bool LoadTarga32Bit(char*);
-    bool LoadPNG(ID3D11Device*, ID3D11DeviceContext*, char*);
+    bool LoadImageFile(char*);
+    bool LoadContainer(char*);
+    void Cook(char*, ImageTypes::TextureRole);
+    bool CookTexture(const std::string&, const std::string&, const DdsFile::SourceTag&);
+    static DdsFile::SourceTag GetSourceTag(const char*, ImageTypes::TextureRole, bool&);
+    bool CreateMappedResources(ID3D11Device*);
+    bool CreateMappedTexture(ID3D11Device*, uint32_t, ID3D11Texture2D**, ID3D11ShaderResourceView**);
 
 private:
     unsigned char* m_targaData;
+    std::unique_ptr<TextureFile> m_mappedFile;
     ID3D11Texture2D* m_texture;
     ID3D11ShaderResourceView* m_textureView;
     int m_width, m_height;
+    bool m_streamed;
+    uint32_t m_residentLevel;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "TextureAtlas.h"
+#include "ResourceCache.h"
+#include "Texture.h"
+#include "../../Core/System/Logger.h"
+
+TextureAtlas::TextureAtlas()
+{
+	m_texture = 0;
+}
+
+TextureAtlas::~TextureAtlas()
+{
+}
+
+bool TextureAtlas::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::string& listFilename,
+	const std::vector<std::string>& filenames, const AtlasPacker::Settings& settings)
+{
+	// Packing happens once, when the cooked atlas is missing or stale.
+	if (!AtlasCooker::ReadRegions(listFilename, filenames, m_regions))
+	{
+		AtlasCooker::Stats stats;
+		if (!AtlasCooker::Cook(listFilename, filenames, settings, &stats) || !AtlasCooker::ReadRegions(listFilename, filenames, m_regions))
+		{
+			LOG_ERROR("TextureAtlas - Failed to cook " + AtlasCooker::GetAtlasFilename(listFilename));
+			return false;
+		}
+		LOG("TextureAtlas - " + listFilename + ": " + AtlasCooker::FormatStats(stats));
+	}
+
+	// The cooked atlas is a DDS with its mips, mapped and uploaded as it is.
+	m_texture = ResourceCache::GetInstance().AcquireTexture(device, deviceContext, AtlasCooker::GetAtlasFilename(listFilename));
+	if (!m_texture)
+	{
+		m_regions.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void TextureAtlas::Shutdown()
+{
+	if (m_texture)
+	{
+		ResourceCache::GetInstance().ReleaseTexture(m_texture);
+		m_texture = 0;
+	}
+
+	m_regions.clear();
+}
+
+ID3D11ShaderResourceView* TextureAtlas::GetTexture() const
+{
+	return m_texture ? m_texture->GetTexture() : 0;
+}
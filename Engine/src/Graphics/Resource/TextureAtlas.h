@@ -0,0 +1,42 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <d3d11.h>
+#include <string>
+#include <vector>
+
+#include "Image/AtlasCooker.h"
+
+class Texture;
+
+// One texture holding many small images, cooked by AtlasCooker. 2D elements
+// drawn from the same atlas share one shader resource view, an element picks
+// its image through the region's texture coordinates instead of binding
+// another texture. Atlases come from ResourceCache::AcquireAtlas, which
+// shares one per image list.
+class TextureAtlas
+{
+public:
+	using Region = AtlasPacker::Region;
+
+public:
+	TextureAtlas();
+	~TextureAtlas();
+
+	// Loads the cooked atlas of the list, cooking it first if it is missing or
+	// older than an image. Regions follow the order of filenames.
+	bool Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::string& listFilename,
+		const std::vector<std::string>& filenames, const AtlasPacker::Settings& settings);
+	void Shutdown();
+
+	Texture* GetAtlasTexture() const { return m_texture; }
+	ID3D11ShaderResourceView* GetTexture() const;
+	int GetRegionCount() const { return (int)m_regions.size(); }
+	const Region& GetRegion(int index) const { return m_regions[index]; }
+
+private:
+	Texture* m_texture;
+	std::vector<Region> m_regions;
+};
+
+#endif // TEXTURE_ATLAS_H
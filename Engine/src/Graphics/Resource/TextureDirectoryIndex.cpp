@@ -0,0 +1,333 @@
+#include "TextureDirectoryIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <system_error>
+
+namespace
+{
+	struct Keyword
+	{
+		const char* word;
+		TextureDirectoryIndex::TextureType type;
+	};
+
+	// Whole words of a file name, the last one that matches decides the type.
+	const Keyword WORD_KEYWORDS[] =
+	{
+		{ "diffuse", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "diff", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "color", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "colour", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "albedo", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "basecolor", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "normal", TextureDirectoryIndex::TYPE_NORMAL },
+		{ "normals", TextureDirectoryIndex::TYPE_NORMAL },
+		{ "nrm", TextureDirectoryIndex::TYPE_NORMAL },
+		{ "norm", TextureDirectoryIndex::TYPE_NORMAL },
+		{ "specular", TextureDirectoryIndex::TYPE_SPECULAR },
+		{ "spec", TextureDirectoryIndex::TYPE_SPECULAR },
+		{ "roughness", TextureDirectoryIndex::TYPE_ROUGHNESS },
+		{ "rough", TextureDirectoryIndex::TYPE_ROUGHNESS },
+		{ "metallic", TextureDirectoryIndex::TYPE_METALLIC },
+		{ "metalness", TextureDirectoryIndex::TYPE_METALLIC },
+		{ "metal", TextureDirectoryIndex::TYPE_METALLIC },
+		{ "emission", TextureDirectoryIndex::TYPE_EMISSION },
+		{ "emissive", TextureDirectoryIndex::TYPE_EMISSION },
+		{ "glow", TextureDirectoryIndex::TYPE_EMISSION },
+		{ "ao", TextureDirectoryIndex::TYPE_AO },
+		{ "ambient", TextureDirectoryIndex::TYPE_AO },
+		{ "occlusion", TextureDirectoryIndex::TYPE_AO },
+	};
+
+	// Names glued to other words (SpaceshipColor.png), checked in this order
+	// when no whole word matched.
+	const Keyword SUBSTRING_KEYWORDS[] =
+	{
+		{ "diffuse", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "color", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "albedo", TextureDirectoryIndex::TYPE_DIFFUSE },
+		{ "normal", TextureDirectoryIndex::TYPE_NORMAL },
+		{ "specular", TextureDirectoryIndex::TYPE_SPECULAR },
+		{ "glow", TextureDirectoryIndex::TYPE_EMISSION },
+		{ "emission", TextureDirectoryIndex::TYPE_EMISSION },
+		{ "metallic", TextureDirectoryIndex::TYPE_METALLIC },
+		{ "roughness", TextureDirectoryIndex::TYPE_ROUGHNESS },
+		{ "ambient", TextureDirectoryIndex::TYPE_AO },
+	};
+
+	// The plain names models have always been looked up by, best first.
+	const std::vector<std::string> PREFERRED_NAMES[TextureDirectoryIndex::TYPE_COUNT] =
+	{
+		{ "color.png", "color.tga", "color.jpg", "diffuse.png", "diffuse.tga", "diffuse.jpg", "albedo.png", "albedo.tga", "albedo.jpg" },
+		{ "normal.png", "normal.tga", "normal.jpg" },
+		{ "specular.png", "specular.tga", "specular.jpg" },
+		{ "roughness.png", "roughness.tga", "roughness.jpg" },
+		{ "metallic.png", "metallic.tga", "metallic.jpg" },
+		{ "emission.png", "emission.tga", "emission.jpg" },
+		{ "internal_ground_ao_texture.jpeg", "ao.png", "ao.tga", "ao.jpg" },
+	};
+
+	// What Texture can decode, and the containers it maps as they are.
+	const char* IMAGE_EXTENSIONS[] = { ".png", ".tga", ".jpg", ".jpeg" };
+	const char* CONTAINER_EXTENSIONS[] = { ".dds", ".ktx2" };
+
+	const int UNPREFERRED_RANK = 1 << 20;
+
+	std::mutex g_mutex;
+	std::unordered_map<std::string, std::shared_ptr<const TextureDirectoryIndex>> g_indices;
+	TextureDirectoryIndex::Stats g_stats;
+
+	std::string ToLower(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		return text;
+	}
+
+	// Lower case, forward slashes, "." and ".." resolved, no trailing slash.
+	std::string NormalizeDirectory(const std::string& directory)
+	{
+		std::string normalized = directory;
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+		normalized = std::filesystem::path(normalized).lexically_normal().generic_string();
+		while (normalized.size() > 1 && normalized.back() == '/')
+		{
+			normalized.pop_back();
+		}
+		return ToLower(normalized);
+	}
+
+	bool HasExtension(const std::string& lowerName, const char* extension)
+	{
+		size_t length = strlen(extension);
+		return lowerName.size() > length && lowerName.compare(lowerName.size() - length, length, extension) == 0;
+	}
+
+	bool IsImage(const std::string& lowerName)
+	{
+		for (const char* extension : IMAGE_EXTENSIONS)
+		{
+			if (HasExtension(lowerName, extension))
+			{
+				return true;
+			}
+		}
+
+		// Containers, except the "<image>.<role>.dds" files the cooker leaves next to their sources.
+		for (const char* extension : CONTAINER_EXTENSIONS)
+		{
+			if (HasExtension(lowerName, extension))
+			{
+				for (const char* source : IMAGE_EXTENSIONS)
+				{
+					if (lowerName.find(std::string(source) + ".") != std::string::npos)
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+std::shared_ptr<const TextureDirectoryIndex> TextureDirectoryIndex::Get(const std::string& directory)
+{
+	std::string key = NormalizeDirectory(directory);
+
+	{
+		std::lock_guard<std::mutex> lock(g_mutex);
+		auto found = g_indices.find(key);
+		if (found != g_indices.end())
+		{
+			g_stats.lookups++;
+			return found->second;
+		}
+	}
+
+	// List the directory without holding the lock, other loaders may want other folders.
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::shared_ptr<TextureDirectoryIndex> index(new TextureDirectoryIndex);
+	index->Build(directory);
+	double buildTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	std::lock_guard<std::mutex> lock(g_mutex);
+
+	// Another thread may have listed the same folder in the meantime.
+	auto inserted = g_indices.emplace(key, index);
+	if (!inserted.second)
+	{
+		g_stats.lookups++;
+		return inserted.first->second;
+	}
+
+	g_stats.directoriesIndexed++;
+	g_stats.filesIndexed += index->GetFileCount();
+	g_stats.buildTimeMs += buildTimeMs;
+
+	return index;
+}
+
+void TextureDirectoryIndex::Clear()
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	g_indices.clear();
+}
+
+TextureDirectoryIndex::Stats TextureDirectoryIndex::GetStats()
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	return g_stats;
+}
+
+std::string TextureDirectoryIndex::FormatStats(const Stats& stats)
+{
+	return "Texture directories: " + std::to_string(stats.directoriesIndexed) + " indexed with " +
+		std::to_string(stats.filesIndexed) + " images in " + std::to_string(stats.buildTimeMs) + " ms, " +
+		std::to_string(stats.lookups) + " reused";
+}
+
+TextureDirectoryIndex::TextureType TextureDirectoryIndex::Classify(const std::string& filename)
+{
+	std::string name = ToLower(filename);
+
+	size_t slash = name.find_last_of("/\\");
+	if (slash != std::string::npos)
+	{
+		name = name.substr(slash + 1);
+	}
+	size_t dot = name.find_last_of('.');
+	if (dot != std::string::npos && dot > 0)
+	{
+		name = name.substr(0, dot);
+	}
+
+	// Suffix first, rock_normal_detail is still a normal map.
+	size_t end = name.size();
+	while (end > 0)
+	{
+		size_t begin = end;
+		while (begin > 0 && std::isalnum((unsigned char)name[begin - 1]))
+		{
+			begin--;
+		}
+
+		if (begin < end)
+		{
+			std::string word = name.substr(begin, end - begin);
+			for (const Keyword& keyword : WORD_KEYWORDS)
+			{
+				if (word == keyword.word)
+				{
+					return keyword.type;
+				}
+			}
+		}
+
+		end = begin;
+		while (end > 0 && !std::isalnum((unsigned char)name[end - 1]))
+		{
+			end--;
+		}
+	}
+
+	for (const Keyword& keyword : SUBSTRING_KEYWORDS)
+	{
+		if (name.find(keyword.word) != std::string::npos)
+		{
+			return keyword.type;
+		}
+	}
+
+	return TYPE_UNKNOWN;
+}
+
+const char* TextureDirectoryIndex::GetTypeName(TextureType type)
+{
+	switch (type)
+	{
+	case TYPE_DIFFUSE: return "diffuse";
+	case TYPE_NORMAL: return "normal";
+	case TYPE_SPECULAR: return "specular";
+	case TYPE_ROUGHNESS: return "roughness";
+	case TYPE_METALLIC: return "metallic";
+	case TYPE_EMISSION: return "emission";
+	case TYPE_AO: return "AO";
+	default: return "unknown";
+	}
+}
+
+const std::string* TextureDirectoryIndex::Find(const std::string& filename) const
+{
+	auto found = m_files.find(ToLower(filename));
+	return found != m_files.end() ? &found->second : nullptr;
+}
+
+const std::string* TextureDirectoryIndex::FindByType(TextureType type) const
+{
+	if (type < 0 || type >= TYPE_COUNT)
+	{
+		return nullptr;
+	}
+	return m_typed[type].path;
+}
+
+void TextureDirectoryIndex::Build(const std::string& directory)
+{
+	m_directory = directory;
+	if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+	{
+		m_directory += '/';
+	}
+
+	std::error_code error;
+	std::filesystem::directory_iterator it(directory, error);
+	if (error)
+	{
+		return;
+	}
+
+	for (; it != std::filesystem::directory_iterator(); it.increment(error))
+	{
+		if (error)
+		{
+			break;
+		}
+		if (!it->is_regular_file(error))
+		{
+			continue;
+		}
+
+		std::string name = it->path().filename().string();
+		std::string lowerName = ToLower(name);
+		if (IsImage(lowerName))
+		{
+			m_files.emplace(lowerName, m_directory + name);
+		}
+	}
+
+	// Directory order is up to the file system, ties go to the smaller name.
+	for (const auto& file : m_files)
+	{
+		TextureType type = Classify(file.first);
+		if (type == TYPE_UNKNOWN)
+		{
+			continue;
+		}
+
+		const std::vector<std::string>& preferred = PREFERRED_NAMES[type];
+		auto preferredName = std::find(preferred.begin(), preferred.end(), file.first);
+		int rank = preferredName != preferred.end() ? (int)(preferredName - preferred.begin()) : UNPREFERRED_RANK;
+
+		TypedFile& best = m_typed[type];
+		if (!best.path || rank < best.rank || (rank == best.rank && ToLower(*best.path) > ToLower(file.second)))
+		{
+			best.path = &file.second;
+			best.rank = rank;
+		}
+	}
+}
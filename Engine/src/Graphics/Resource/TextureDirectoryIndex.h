@@ -0,0 +1,79 @@
+#ifndef TEXTURE_DIRECTORY_INDEX_H
+#define TEXTURE_DIRECTORY_INDEX_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The image files of one asset folder, listed once and shared by every model
+// that loads from it, so finding a texture is a lookup instead of a file probe.
+// - Names are matched case-insensitively.
+// - Every file is classified by the last word of its name (rock_albedo.png,
+//   hull-normal.tga, ...) so materials can ask for "the normal map" directly.
+// - The index is a snapshot, files added to the folder later are not seen
+//   until Clear is called.
+class TextureDirectoryIndex
+{
+public:
+	enum TextureType
+	{
+		TYPE_DIFFUSE = 0,
+		TYPE_NORMAL,
+		TYPE_SPECULAR,
+		TYPE_ROUGHNESS,
+		TYPE_METALLIC,
+		TYPE_EMISSION,
+		TYPE_AO,
+		TYPE_COUNT,
+		TYPE_UNKNOWN = TYPE_COUNT
+	};
+
+	struct Stats
+	{
+		size_t directoriesIndexed = 0;
+		size_t filesIndexed = 0;
+		size_t lookups = 0;         // Index reuses, each one a directory scan saved
+		double buildTimeMs = 0.0;
+	};
+
+public:
+	// The shared index of the directory, built on first use. Thread-safe.
+	// A directory that does not exist gives an empty index.
+	static std::shared_ptr<const TextureDirectoryIndex> Get(const std::string& directory);
+	// Forgets every index, the next Get lists the directory again.
+	static void Clear();
+
+	static Stats GetStats();
+	static std::string FormatStats(const Stats& stats);
+
+	// Type of a texture from its file name, TYPE_UNKNOWN if nothing matches.
+	static TextureType Classify(const std::string& filename);
+	static const char* GetTypeName(TextureType type);
+
+	// Full path of the file with this name (any case), or nullptr.
+	const std::string* Find(const std::string& filename) const;
+	// Full path of the best texture of this type in the directory, or nullptr.
+	// Plain names (diffuse.png, normal.tga, ...) are preferred over the rest.
+	const std::string* FindByType(TextureType type) const;
+
+	const std::string& GetDirectory() const { return m_directory; }
+	size_t GetFileCount() const { return m_files.size(); }
+
+private:
+	struct TypedFile
+	{
+		const std::string* path = nullptr;
+		int rank = 0;
+	};
+
+	void Build(const std::string& directory);
+
+private:
+	std::string m_directory;
+	std::unordered_map<std::string, std::string> m_files;   // Lower case name -> path
+	TypedFile m_typed[TYPE_COUNT];
+};
+
+#endif // TEXTURE_DIRECTORY_INDEX_H
@@ -0,0 +1,113 @@
+#include "TextureStreamer.h"
+#include "Model.h"
+#include "Texture.h"
+#include "../../Core/System/Logger.h"
+
+TextureStreamer::TextureStreamer()
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+}
+
+void TextureStreamer::Initialize(const MipResidency::Settings& settings)
+{
+	m_residency.Initialize(settings);
+	m_textureIds.clear();
+	m_textures.clear();
+}
+
+void TextureStreamer::Shutdown()
+{
+	// The textures belong to the ResourceCache, only forget them.
+	m_textureIds.clear();
+	m_textures.clear();
+	m_residency.Initialize(m_residency.GetSettings());
+}
+
+void TextureStreamer::AddModel(const Model* model)
+{
+	for (int material = 0; model->GetMaterialTextures(material); material++)
+	{
+		const Model::MaterialTextures* textures = model->GetMaterialTextures(material);
+		Texture* maps[] = { textures->diffuse, textures->normal, textures->metallic, textures->roughness, textures->emission, textures->ao };
+		for (Texture* texture : maps)
+		{
+			AddTexture(texture);
+		}
+	}
+
+	LOG(MipResidency::FormatStats(m_residency.GetStats()));
+}
+
+void TextureStreamer::AddTexture(Texture* texture)
+{
+	if (!texture || !texture->IsStreamed() || m_textureIds.count(texture))
+	{
+		return;
+	}
+
+	uint32_t id = m_residency.AddTexture(texture->GetLevels(), texture->GetResidentLevel());
+	m_textureIds[texture] = id;
+	if (id >= m_textures.size())
+	{
+		m_textures.resize(id + 1, nullptr);
+	}
+	m_textures[id] = texture;
+}
+
+void TextureStreamer::BeginFrame()
+{
+	m_residency.BeginFrame();
+}
+
+void TextureStreamer::RequestMaterial(const Model* model, int materialIndex, float screenSize)
+{
+	const Model::MaterialTextures* textures = model->GetMaterialTextures(materialIndex);
+	if (!textures)
+	{
+		return;
+	}
+
+	RequestTexture(textures->diffuse, screenSize);
+	RequestTexture(textures->normal, screenSize);
+	RequestTexture(textures->metallic, screenSize);
+	RequestTexture(textures->roughness, screenSize);
+	RequestTexture(textures->emission, screenSize);
+	RequestTexture(textures->ao, screenSize);
+}
+
+void TextureStreamer::RequestTexture(Texture* texture, float screenSize)
+{
+	if (!texture)
+	{
+		return;
+	}
+
+	auto found = m_textureIds.find(texture);
+	if (found != m_textureIds.end())
+	{
+		m_residency.Request(found->second, screenSize);
+	}
+}
+
+bool TextureStreamer::Update(ID3D11Device* device)
+{
+	m_residency.Update(m_changes);
+
+	// A texture that cannot be recreated keeps the levels it has.
+	bool result = true;
+	for (const MipResidency::Change& change : m_changes)
+	{
+		Texture* texture = m_textures[change.texture];
+		if (!texture->SetResidentLevel(device, change.residentLevel))
+		{
+			LOG_WARNING("TextureStreamer - Failed to make level " + std::to_string(change.residentLevel) + " resident");
+			m_residency.SetResidentLevel(change.texture, texture->GetResidentLevel());
+			result = false;
+		}
+	}
+
+	return result;
+}
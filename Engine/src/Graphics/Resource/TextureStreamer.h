@@ -0,0 +1,51 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <d3d11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Image/MipResidency.h"
+
+class Model;
+class Texture;
+
+// Streams the finer mip levels of the model textures that were loaded with
+// ResourceCache::SetTextureStreaming. The renderer requests a model's material
+// with the size the model covers on screen while it draws the visible
+// list; Update then loads and evicts levels as MipResidency decides and
+// recreates the affected textures from their mapped files. Device thread only.
+class TextureStreamer
+{
+public:
+	TextureStreamer();
+	~TextureStreamer();
+
+	void Initialize(const MipResidency::Settings& settings);
+	void Shutdown();
+
+	// Registers the streamed textures of every material, each texture once.
+	void AddModel(const Model* model);
+
+	void BeginFrame();
+	// screenSize is the model's projected diameter in pixels.
+	void RequestMaterial(const Model* model, int materialIndex, float screenSize);
+	bool Update(ID3D11Device* device);
+
+	const MipResidency::Stats& GetStats() const { return m_residency.GetStats(); }
+
+private:
+	void AddTexture(Texture* texture);
+	void RequestTexture(Texture* texture, float screenSize);
+
+private:
+	MipResidency m_residency;
+	std::unordered_map<Texture*, uint32_t> m_textureIds;
+	std::vector<Texture*> m_textures;           // By MipResidency id
+	std::vector<MipResidency::Change> m_changes;
+};
+
+#endif // TEXTURE_STREAMER_H
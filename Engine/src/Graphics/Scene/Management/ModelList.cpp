@@ -6,6 +6,7 @@
 ModelList::ModelList()
 {
     m_modelCount = 0;
+    m_localBox = {};
 }
 
 
@@ -29,7 +30,7 @@ void ModelList::Initialize(int numModels)
 
 
 
-    m_ModelInfoList.resize(m_modelCount);
+    Resize(m_modelCount);
 
     // Seed the random generator with the current time.
     srand((unsigned int)time(NULL));
@@ -66,12 +67,12 @@ void ModelList::Initialize(int numModels)
         float shipAngle = angle + groupAngle;
         float shipRadius = radius + groupRadius;
         
-        m_ModelInfoList[i].positionX = cos(shipAngle) * shipRadius;
-        m_ModelInfoList[i].positionY = (rand() % (int)heightVariation - heightVariation/2) * 0.1f + (layer * 20.0f);
-        m_ModelInfoList[i].positionZ = sin(shipAngle) * shipRadius;
+        m_transforms.positionX[i] = cos(shipAngle) * shipRadius;
+        m_transforms.positionY[i] = (rand() % (int)heightVariation - heightVariation/2) * 0.1f + (layer * 20.0f);
+        m_transforms.positionZ[i] = sin(shipAngle) * shipRadius;
         
 
-        XMFLOAT3 shipPos = XMFLOAT3(m_ModelInfoList[i].positionX, m_ModelInfoList[i].positionY, m_ModelInfoList[i].positionZ);
+        XMFLOAT3 shipPos = XMFLOAT3(m_transforms.positionX[i], m_transforms.positionY[i], m_transforms.positionZ[i]);
         XMFLOAT3 directionToTarget;
         directionToTarget.x = targetPosition.x - shipPos.x;
         directionToTarget.y = targetPosition.y - shipPos.y;
@@ -89,17 +90,19 @@ void ModelList::Initialize(int numModels)
         float targetAngle = atan2(directionToTarget.x, directionToTarget.z);
         float randomVariation = ((float)rand() / RAND_MAX - 0.5f) * 0.2f; // ±0.1 radians
         
-        m_ModelInfoList[i].rotationX = 1.570796f;
-        m_ModelInfoList[i].rotationY = targetAngle + randomVariation;
-        m_ModelInfoList[i].rotationZ = 0.0f;
+        m_transforms.rotationX[i] = 1.570796f;
+        m_transforms.rotationY[i] = targetAngle + randomVariation;
+        m_transforms.rotationZ[i] = 0.0f;
         
 
-        m_ModelInfoList[i].scaleX = 1.0f;
-        m_ModelInfoList[i].scaleY = 1.0f;
-        m_ModelInfoList[i].scaleZ = 1.0f;
-    }
+        m_transforms.scaleX[i] = 1.0f;
+        m_transforms.scaleY[i] = 1.0f;
+        m_transforms.scaleZ[i] = 1.0f;
 
+        MarkDirty(i);
+    }
 
+    BuildMatrices(nullptr, (size_t)m_modelCount);
 
     return;
 }
@@ -108,12 +111,114 @@ void ModelList::Initialize(int numModels)
 void ModelList::Shutdown()
 {
 
-    m_ModelInfoList.clear();
+    Resize(0);
     m_modelCount = 0;
     return;
 }
 
 
+void ModelList::Resize(int count)
+{
+    std::vector<float>* components[] = { &m_transforms.positionX, &m_transforms.positionY, &m_transforms.positionZ,
+        &m_transforms.rotationX, &m_transforms.rotationY, &m_transforms.rotationZ,
+        &m_transforms.scaleX, &m_transforms.scaleY, &m_transforms.scaleZ };
+    for (std::vector<float>* component : components)
+    {
+        component->assign(count, 0.0f);
+    }
+
+    std::vector<float>* bounds[] = { &m_worldBounds.minX, &m_worldBounds.minY, &m_worldBounds.minZ,
+        &m_worldBounds.maxX, &m_worldBounds.maxY, &m_worldBounds.maxZ };
+    for (std::vector<float>* component : bounds)
+    {
+        component->assign(count, 0.0f);
+    }
+
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            m_matrices[row][column].assign(count, 0.0f);
+        }
+    }
+
+    m_dirty.assign(count, 0);
+    m_dirtyIndices.clear();
+}
+
+
+void ModelList::MarkDirty(int index)
+{
+    if (!m_dirty[index])
+    {
+        m_dirty[index] = 1;
+        m_dirtyIndices.push_back((uint32_t)index);
+    }
+}
+
+
+void ModelList::BuildMatrices(const uint32_t* indices, size_t count)
+{
+    BoundsTransform::Transforms transforms = { m_transforms.positionX.data(), m_transforms.positionY.data(), m_transforms.positionZ.data(),
+        m_transforms.rotationX.data(), m_transforms.rotationY.data(), m_transforms.rotationZ.data(),
+        m_transforms.scaleX.data(), m_transforms.scaleY.data(), m_transforms.scaleZ.data() };
+    BoundsTransform::Matrices matrices;
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            matrices.m[row][column] = m_matrices[row][column].data();
+        }
+    }
+
+    BoundsTransform::BuildMatrices(transforms, indices, count, matrices);
+}
+
+
+void ModelList::SetLocalBounds(const float center[3], const float axes[3][3], const float extents[3])
+{
+    m_localBox = BoundsTransform::MakeBox(center, axes, extents);
+
+    for (int i = 0; i < m_modelCount; i++)
+    {
+        MarkDirty(i);
+    }
+}
+
+
+int ModelList::UpdateWorldBounds()
+{
+    int updatedCount = (int)m_dirtyIndices.size();
+    if (updatedCount == 0)
+    {
+        return 0;
+    }
+
+    BoundsTransform::Instances instances = { m_transforms.positionX.data(), m_transforms.positionY.data(), m_transforms.positionZ.data() };
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            instances.m[row][column] = m_matrices[row][column].data();
+        }
+    }
+    BoundsTransform::Boxes boxes = { m_worldBounds.minX.data(), m_worldBounds.minY.data(), m_worldBounds.minZ.data(),
+        m_worldBounds.maxX.data(), m_worldBounds.maxY.data(), m_worldBounds.maxZ.data() };
+
+    // An index is listed once at most, so a full list is every instance and they go in order.
+    const uint32_t* indices = updatedCount == m_modelCount ? nullptr : m_dirtyIndices.data();
+    BoundsTransform::TransformBoxes(m_localBox, instances, indices, (size_t)updatedCount, boxes, BoundsTransform::Settings());
+
+    for (uint32_t index : m_dirtyIndices)
+    {
+        m_dirty[index] = 0;
+    }
+    m_dirtyIndices.clear();
+
+    return updatedCount;
+}
+
+
 int ModelList::GetModelCount()
 {
     return m_modelCount;
@@ -124,9 +229,9 @@ void ModelList::GetData(int index, float& positionX, float& positionY, float& po
 {
     if (index >= 0 && index < m_modelCount)
     {
-        positionX = m_ModelInfoList[index].positionX;
-        positionY = m_ModelInfoList[index].positionY;
-        positionZ = m_ModelInfoList[index].positionZ;
+        positionX = m_transforms.positionX[index];
+        positionY = m_transforms.positionY[index];
+        positionZ = m_transforms.positionZ[index];
     }
     return;
 }
@@ -137,15 +242,15 @@ void ModelList::GetTransformData(int index, float& positionX, float& positionY,
 {
     if (index >= 0 && index < m_modelCount)
     {
-        positionX = m_ModelInfoList[index].positionX;
-        positionY = m_ModelInfoList[index].positionY;
-        positionZ = m_ModelInfoList[index].positionZ;
-        rotationX = m_ModelInfoList[index].rotationX;
-        rotationY = m_ModelInfoList[index].rotationY;
-        rotationZ = m_ModelInfoList[index].rotationZ;
-        scaleX = m_ModelInfoList[index].scaleX;
-        scaleY = m_ModelInfoList[index].scaleY;
-        scaleZ = m_ModelInfoList[index].scaleZ;
+        positionX = m_transforms.positionX[index];
+        positionY = m_transforms.positionY[index];
+        positionZ = m_transforms.positionZ[index];
+        rotationX = m_transforms.rotationX[index];
+        rotationY = m_transforms.rotationY[index];
+        rotationZ = m_transforms.rotationZ[index];
+        scaleX = m_transforms.scaleX[index];
+        scaleY = m_transforms.scaleY[index];
+        scaleZ = m_transforms.scaleZ[index];
     }
 }
 
@@ -155,14 +260,19 @@ void ModelList::SetTransformData(int index, float positionX, float positionY, fl
 {
     if (index >= 0 && index < m_modelCount)
     {
-        m_ModelInfoList[index].positionX = positionX;
-        m_ModelInfoList[index].positionY = positionY;
-        m_ModelInfoList[index].positionZ = positionZ;
-        m_ModelInfoList[index].rotationX = rotationX;
-        m_ModelInfoList[index].rotationY = rotationY;
-        m_ModelInfoList[index].rotationZ = rotationZ;
-        m_ModelInfoList[index].scaleX = scaleX;
-        m_ModelInfoList[index].scaleY = scaleY;
-        m_ModelInfoList[index].scaleZ = scaleZ;
+        m_transforms.positionX[index] = positionX;
+        m_transforms.positionY[index] = positionY;
+        m_transforms.positionZ[index] = positionZ;
+        m_transforms.rotationX[index] = rotationX;
+        m_transforms.rotationY[index] = rotationY;
+        m_transforms.rotationZ[index] = rotationZ;
+        m_transforms.scaleX[index] = scaleX;
+        m_transforms.scaleY[index] = scaleY;
+        m_transforms.scaleZ[index] = scaleZ;
+
+        // The sines and cosines are taken here, once per change; its world box follows on the next UpdateWorldBounds.
+        uint32_t changed = (uint32_t)index;
+        BuildMatrices(&changed, 1);
+        MarkDirty(index);
     }
 }
\ No newline at end of file
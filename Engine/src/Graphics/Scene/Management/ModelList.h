@@ -4,18 +4,29 @@
 #include <stdlib.h>
 #include <time.h>
 #include <vector>
+#include <cstdint>
 #include <directxmath.h>
+#include "../../Math/BoundsTransform.h"
 
 using namespace DirectX;
 
 class ModelList
 {
-private:
-    struct ModelInfoType
+public:
+    // The instance transforms, one array per component so culling can stream
+    // through a component four or eight instances at a time.
+    struct TransformArrays
+    {
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ;
+        std::vector<float> scaleX, scaleY, scaleZ;
+    };
+
+    // The world space AABB of every instance, in the same layout.
+    struct BoundsArrays
     {
-        float positionX, positionY, positionZ;
-        float rotationX, rotationY, rotationZ;
-        float scaleX, scaleY, scaleZ;
+        std::vector<float> minX, minY, minZ;
+        std::vector<float> maxX, maxY, maxZ;
     };
 
 public:
@@ -30,14 +41,33 @@ public:
     void GetData(int, float&, float&, float&);
     void GetTransformData(int, float&, float&, float&, float&, float&, float&, float&, float&, float&);
     void SetTransformData(int, float, float, float, float, float, float, float, float, float);
-    
-    // Get all model instances for selection system
-    const std::vector<ModelInfoType>& GetModelInstances() const { return m_ModelInfoList; }
-    std::vector<ModelInfoType>& GetModelInstances() { return m_ModelInfoList; }
+
+    // All instances at once, for the culling and selection systems
+    const TransformArrays& GetTransforms() const { return m_transforms; }
+
+    // The model space box every instance shares: center, orthonormal axes and
+    // half sizes, the model's oriented box. Setting it outdates all world boxes.
+    void SetLocalBounds(const float[3], const float[3][3], const float[3]);
+
+    // Recomputes the world boxes of the instances changed since the last call
+    // and returns how many that were. Call it once a frame before culling.
+    int UpdateWorldBounds();
+    const BoundsArrays& GetWorldBounds() const { return m_worldBounds; }
+
+private:
+    void Resize(int);
+    void MarkDirty(int);
+    void BuildMatrices(const uint32_t*, size_t);
 
 private:
     int m_modelCount;
-    std::vector<ModelInfoType> m_ModelInfoList;
+    TransformArrays m_transforms;
+
+    std::vector<float> m_matrices[3][3];    // Scale * rotation per instance, rebuilt when its transform is set
+    BoundsTransform::Box m_localBox;
+    BoundsArrays m_worldBounds;
+    std::vector<uint8_t> m_dirty;           // Per instance, set while it is in m_dirtyIndices
+    std::vector<uint32_t> m_dirtyIndices;
 };
 
 #endif
\ No newline at end of file
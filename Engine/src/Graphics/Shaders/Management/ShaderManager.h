@@ -33,7 +33,8 @@ public:
     bool RenderPBRShader(ID3D11DeviceContext*, int, XMMATRIX, XMMATRIX, XMMATRIX, 
                         ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, 
                         ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, ID3D11ShaderResourceView*,
-                        XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT4, float, float, float, float, XMFLOAT3, bool);
+                        XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT4, float, float, float, float, XMFLOAT3, bool, int startIndex = 0,
+                        const MeshTypes::VertexQuantization* quantization = nullptr);
     
     // GPU-driven rendering support
     ID3D11VertexShader* GetVertexShader() const;
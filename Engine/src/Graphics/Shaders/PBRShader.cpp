@@ -6,6 +6,9 @@ PBRShader::PBRShader()
 	m_vertexShader = 0;
 	m_pixelShader = 0;
 	m_layout = 0;
+	m_compactVertexShader = 0;
+	m_compactLayout = 0;
+	m_vertexDecodeBuffer = 0;
 	m_matrixBuffer = 0;
 	m_lightBuffer = 0;
 	m_materialBuffer = 0;
@@ -63,7 +66,8 @@ bool PBRShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMAT
 					   ID3D11ShaderResourceView* diffuseTexture, ID3D11ShaderResourceView* normalTexture, ID3D11ShaderResourceView* metallicTexture,
 					   ID3D11ShaderResourceView* roughnessTexture, ID3D11ShaderResourceView* emissionTexture, ID3D11ShaderResourceView* aoTexture,
 					   XMFLOAT3 lightDirection, XMFLOAT4 ambientColor, XMFLOAT4 diffuseColor, XMFLOAT4 baseColor,
-					   float metallic, float roughness, float ao, float emissionStrength, XMFLOAT3 cameraPosition, bool useGPUDrivenRendering)
+					   float metallic, float roughness, float ao, float emissionStrength, XMFLOAT3 cameraPosition, bool useGPUDrivenRendering,
+					   int startIndex, const MeshTypes::VertexQuantization* quantization)
 {
 	bool result;
 
@@ -76,8 +80,18 @@ bool PBRShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMAT
 		return false;
 	}
 
+	// Compact vertices need the dequantization constants.
+	if (quantization)
+	{
+		result = SetVertexDecodeParameters(deviceContext, *quantization);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
 	// Now render the prepared buffers with the shader.
-	RenderShader(deviceContext, indexCount);
+	RenderShader(deviceContext, indexCount, startIndex, quantization != nullptr);
 
 	return true;
 }
@@ -87,10 +101,13 @@ bool PBRShader::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilen
 	HRESULT result;
 	ID3D10Blob* errorMessage;
 	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* compactVertexShaderBuffer;
 	ID3D10Blob* pixelShaderBuffer;
 	D3D11_INPUT_ELEMENT_DESC polygonLayout[5];
+	D3D11_INPUT_ELEMENT_DESC compactLayout[4];
 	unsigned int numElements;
 	D3D11_BUFFER_DESC matrixBufferDesc;
+	D3D11_BUFFER_DESC vertexDecodeBufferDesc;
 	D3D11_BUFFER_DESC lightBufferDesc;
 	D3D11_BUFFER_DESC materialBufferDesc;
 	D3D11_SAMPLER_DESC samplerDesc;
@@ -98,6 +115,7 @@ bool PBRShader::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilen
 	// Initialize the pointers this function will use to null.
 	errorMessage = 0;
 	vertexShaderBuffer = 0;
+	compactVertexShaderBuffer = 0;
 	pixelShaderBuffer = 0;
 
 	// Compile the vertex shader code.
@@ -119,6 +137,24 @@ bool PBRShader::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilen
 		return false;
 	}
 
+	// Compile the vertex shader variant that decodes compact vertices.
+	D3D_SHADER_MACRO compactDefines[] = { { "COMPACT_VERTEX", "1" }, { NULL, NULL } };
+	result = D3DCompileFromFile(vsFilename, compactDefines, NULL, "PBRVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
+		&compactVertexShaderBuffer, &errorMessage);
+	if (FAILED(result))
+	{
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
+		}
+		else
+		{
+			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
 	// Compile the pixel shader code.
 	result = D3DCompileFromFile(psFilename, NULL, NULL, "PBRPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0,
 		&pixelShaderBuffer, &errorMessage);
@@ -145,6 +181,12 @@ bool PBRShader::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilen
 		return false;
 	}
 
+	result = device->CreateVertexShader(compactVertexShaderBuffer->GetBufferPointer(), compactVertexShaderBuffer->GetBufferSize(), NULL, &m_compactVertexShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
 	// Create the pixel shader from the buffer.
 	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
 	if (FAILED(result))
@@ -204,10 +246,54 @@ bool PBRShader::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilen
 		return false;
 	}
 
-	// Release the vertex shader buffer and pixel shader buffer since they are no longer needed.
+	// Compact layout, matching MeshTypes::CompactVertex (20 bytes).
+	compactLayout[0].SemanticName = "POSITION";
+	compactLayout[0].SemanticIndex = 0;
+	compactLayout[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	compactLayout[0].InputSlot = 0;
+	compactLayout[0].AlignedByteOffset = 0;
+	compactLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	compactLayout[0].InstanceDataStepRate = 0;
+
+	compactLayout[1].SemanticName = "TEXCOORD";
+	compactLayout[1].SemanticIndex = 0;
+	compactLayout[1].Format = DXGI_FORMAT_R16G16_FLOAT;
+	compactLayout[1].InputSlot = 0;
+	compactLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	compactLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	compactLayout[1].InstanceDataStepRate = 0;
+
+	compactLayout[2].SemanticName = "NORMAL";
+	compactLayout[2].SemanticIndex = 0;
+	compactLayout[2].Format = DXGI_FORMAT_R16G16_SNORM;
+	compactLayout[2].InputSlot = 0;
+	compactLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	compactLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	compactLayout[2].InstanceDataStepRate = 0;
+
+	compactLayout[3].SemanticName = "TANGENT";
+	compactLayout[3].SemanticIndex = 0;
+	compactLayout[3].Format = DXGI_FORMAT_R8G8B8A8_SNORM;
+	compactLayout[3].InputSlot = 0;
+	compactLayout[3].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	compactLayout[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	compactLayout[3].InstanceDataStepRate = 0;
+
+	numElements = sizeof(compactLayout) / sizeof(compactLayout[0]);
+
+	result = device->CreateInputLayout(compactLayout, numElements, compactVertexShaderBuffer->GetBufferPointer(), compactVertexShaderBuffer->GetBufferSize(), &m_compactLayout);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Release the vertex shader buffers and pixel shader buffer since they are no longer needed.
 	vertexShaderBuffer->Release();
 	vertexShaderBuffer = 0;
 
+	compactVertexShaderBuffer->Release();
+	compactVertexShaderBuffer = 0;
+
 	pixelShaderBuffer->Release();
 	pixelShaderBuffer = 0;
 
@@ -226,6 +312,20 @@ bool PBRShader::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilen
 		return false;
 	}
 
+	// Setup the description of the vertex decode constant buffer used by the compact vertex shader.
+	vertexDecodeBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	vertexDecodeBufferDesc.ByteWidth = sizeof(VertexDecodeBufferType);
+	vertexDecodeBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	vertexDecodeBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vertexDecodeBufferDesc.MiscFlags = 0;
+	vertexDecodeBufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&vertexDecodeBufferDesc, NULL, &m_vertexDecodeBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
 	// Setup the description of the light dynamic constant buffer that is in the pixel shader.
 	lightBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	lightBufferDesc.ByteWidth = sizeof(LightBufferType);
@@ -304,6 +404,13 @@ void PBRShader::ShutdownShader()
 		m_lightBuffer = 0;
 	}
 
+	// Release the vertex decode constant buffer.
+	if (m_vertexDecodeBuffer)
+	{
+		m_vertexDecodeBuffer->Release();
+		m_vertexDecodeBuffer = 0;
+	}
+
 	// Release the matrix constant buffer.
 	if (m_matrixBuffer)
 	{
@@ -311,6 +418,19 @@ void PBRShader::ShutdownShader()
 		m_matrixBuffer = 0;
 	}
 
+	// Release the compact vertex layout and shader.
+	if (m_compactLayout)
+	{
+		m_compactLayout->Release();
+		m_compactLayout = 0;
+	}
+
+	if (m_compactVertexShader)
+	{
+		m_compactVertexShader->Release();
+		m_compactVertexShader = 0;
+	}
+
 	// Release the layout.
 	if (m_layout)
 	{
@@ -504,20 +624,45 @@ bool PBRShader::SetupShaderParameters(ID3D11DeviceContext* deviceContext, XMMATR
 							 lightDirection, ambientColor, diffuseColor, baseColor, metallic, roughness, ao, emissionStrength, cameraPosition, useGPUDrivenRendering);
 }
 
-void PBRShader::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+bool PBRShader::SetVertexDecodeParameters(ID3D11DeviceContext* deviceContext, const MeshTypes::VertexQuantization& quantization)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	VertexDecodeBufferType* dataPtr;
+
+
+	result = deviceContext->Map(m_vertexDecodeBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	dataPtr = (VertexDecodeBufferType*)mappedResource.pData;
+	dataPtr->positionOffset = XMFLOAT4(quantization.positionOffset[0], quantization.positionOffset[1], quantization.positionOffset[2], 0.0f);
+	dataPtr->positionScale = XMFLOAT4(quantization.positionScale[0], quantization.positionScale[1], quantization.positionScale[2], 0.0f);
+
+	deviceContext->Unmap(m_vertexDecodeBuffer, 0);
+
+	// Register b1 of the vertex shader, next to the matrix buffer.
+	deviceContext->VSSetConstantBuffers(1, 1, &m_vertexDecodeBuffer);
+
+	return true;
+}
+
+void PBRShader::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount, int startIndex, bool compactVertices)
 {
 	// Set the vertex input layout.
-	deviceContext->IASetInputLayout(m_layout);
+	deviceContext->IASetInputLayout(compactVertices ? m_compactLayout : m_layout);
 
 	// Set the vertex and pixel shaders that will be used to render this triangle.
-	deviceContext->VSSetShader(m_vertexShader, NULL, 0);
+	deviceContext->VSSetShader(compactVertices ? m_compactVertexShader : m_vertexShader, NULL, 0);
 	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
 
 	// Set the sampler state in the pixel shader.
 	deviceContext->PSSetSamplers(0, 1, &m_sampleState);
 
 	// Render the triangle.
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+	deviceContext->DrawIndexed(indexCount, startIndex, 0);
 
 	return;
 } 
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <vector>
 #include "../Resource/Texture.h"
+#include "../Resource/Mesh/MeshTypes.h"
 
 using namespace DirectX;
 
@@ -39,6 +40,12 @@ private:
 		XMFLOAT4 materialPadding; // Ensure 16-byte alignment
 	};
 
+	struct VertexDecodeBufferType
+	{
+		XMFLOAT4 positionOffset;
+		XMFLOAT4 positionScale;
+	};
+
 public:
 	PBRShader();
 	PBRShader(const PBRShader&);
@@ -49,7 +56,8 @@ public:
 	bool Render(ID3D11DeviceContext*, int, XMMATRIX, XMMATRIX, XMMATRIX, 
 				ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, 
 				ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, ID3D11ShaderResourceView*,
-				XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT4, float, float, float, float, XMFLOAT3, bool);
+				XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT4, float, float, float, float, XMFLOAT3, bool, int startIndex = 0,
+				const MeshTypes::VertexQuantization* quantization = nullptr);
 	
 	// GPU-driven rendering support
 	ID3D11VertexShader* GetVertexShader() const { return m_vertexShader; }
@@ -71,12 +79,16 @@ private:
 							ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, ID3D11ShaderResourceView*,
 							ID3D11ShaderResourceView*, ID3D11ShaderResourceView*, ID3D11ShaderResourceView*,
 							XMFLOAT3, XMFLOAT4, XMFLOAT4, XMFLOAT4, float, float, float, float, XMFLOAT3, bool);
-	void RenderShader(ID3D11DeviceContext*, int);
+	bool SetVertexDecodeParameters(ID3D11DeviceContext*, const MeshTypes::VertexQuantization&);
+	void RenderShader(ID3D11DeviceContext*, int, int, bool);
 
 private:
 	ID3D11VertexShader* m_vertexShader;
 	ID3D11PixelShader* m_pixelShader;
 	ID3D11InputLayout* m_layout;
+	ID3D11VertexShader* m_compactVertexShader;  // COMPACT_VERTEX variant for MeshTypes::CompactVertex
+	ID3D11InputLayout* m_compactLayout;
+	ID3D11Buffer* m_vertexDecodeBuffer;
 	ID3D11Buffer* m_matrixBuffer;
 	ID3D11Buffer* m_lightBuffer;
 	ID3D11Buffer* m_materialBuffer;